@@ -51,6 +51,21 @@ License Agreement.
 #include "lookup.h" 
 #include "gpio.h"
 #include "modes.h"
+#include "frame_engine.h"
+#include "eit_stream.h"
+#include "pattern.h"
+#include "adg732.h"
+#include "seq_builder.h"
+#include "calcache.h"
+#include "bench.h"
+#include "zconv.h"
+#include "average.h"
+#include "rx_ring.h"
+#include "ranging.h"
+#include "usb_stream.h"
+#include "command.h"
+#include "mode_manager.h"
+#include "timestamp.h"
 
 #include <ADuCM350_device.h>
 
@@ -67,17 +82,204 @@ License Agreement.
 /* Helper macro for printing strings to UART or Std. Output */
 #define PRINT(s)                    test_print(s)
 
+/* Output formats of the imaging modes, selectable from the main menu, the COMMAND_OUTPUT_* values */
+#define OUTPUT_ASCII                (0)     /* sprintf'd 28.4 magnitudes    */
+#define OUTPUT_BINARY_FIXED32       (1)     /* eit_stream frames, 28.4      */
+#define OUTPUT_BINARY_Q31           (2)     /* eit_stream frames, raw q31   */
+
 /* Size of Tx and Rx buffers */
-#define RX_BUFFER_SIZE     2
-#define TX_BUFFER_SIZE     100
+#define RX_BUFFER_SIZE     256    /* interrupt-fed receive ring, several command frames between two polls */
+#define TX_BUFFER_SIZE     2048   /* DMA transmit ring, sized for a 32 electrode ASCII frame burst */
 
 /* Rx and Tx buffers */
 static uint8_t RxBuffer[RX_BUFFER_SIZE];
 static uint8_t TxBuffer[TX_BUFFER_SIZE];
 
+/* Menu keys and command frames of the receive stream, see command.h, and the bytes taken per read */
+#define COMMAND_RX_CHUNK            (32)
+static COMMAND_PARSER command_parser;
+static uint16_t      command_errors = 0;
+/* Cleared by the STOP command: the main loop only parses the received bytes */
+static bool_t        acquisition_running = true;
+/* Set while a request runs: its outcome is in the response, no text goes on the stream */
+static bool_t        print_muted = false;
+
 /* UART Handle */
 ADI_UART_HANDLE      hUartDevice;
 ADI_AFE_DEV_HANDLE   hDevice; 
+
+/* Electrode pattern compiled into packed mux words, see pattern.h. The plan arrays hold the */
+/* largest pattern run, 32 electrodes with opposition injection                              */
+#define MUX_MAX_QUADS               (PATTERN_MUX_CHANNELS * (PATTERN_MUX_CHANNELS - 4u))
+static uint32_t      mux_plan[MUX_MAX_QUADS];
+static uint32_t      mux_plan_count = 0;
+static PATTERN_CONFIG mux_plan_config;
+
+/* Reduced plans: the quads equal to an earlier one up to reciprocity and polarity are not measured, */
+/* see pattern.h. With PLAN_REDUCED_QA one frame in PLAN_QA_FRAMES measures the full pattern        */
+#define PLAN_FULL                   (0)     /* every quad of the pattern          */
+#define PLAN_REDUCED                (1)     /* the measured quads only            */
+#define PLAN_REDUCED_QA             (2)     /* reduced, with full QA frames       */
+#define PLAN_QA_FRAMES              (16)
+static uint32_t      plan_mode = PLAN_FULL;
+static uint32_t      plan_frames;
+static uint16_t      mux_measured[MUX_MAX_QUADS];
+static int16_t       mux_reduced_plan[MUX_MAX_QUADS];
+static uint32_t      mux_measured_count = 0;
+static bool_t        mux_reduced;
+static bool_t        mux_plan_sent;
+
+/* Delta frames of the binary output: a frame in DELTA_KEY_FRAMES is sent whole, the others as the  */
+/* residuals against the previous frame, see eit_stream.h. The reference holds the 16 electrode    */
+/* frames in any value format, larger frames are always sent whole                                 */
+#define DELTA_KEY_FRAMES            (16)
+#define DELTA_MAX_VALUES            (512)
+static bool_t        delta_frames = false;
+static int32_t       delta_reference[DELTA_MAX_VALUES];
+
+/* Timestamps: every record carries the microsecond tick of timestamp.h at the start of its */
+/* acquisition, one record in TIME_KEY_RECORDS whole and the others as the difference with */
+/* the previous record, as "t=tick;", "t+d;" or "t-d;" in ASCII and in the frame header in */
+/* binary, see eit_stream.h                                                                 */
+#define TIME_KEY_RECORDS            (16)
+static bool_t        timestamps = false;
+static STREAM_TIME_CODER time_coder;
+/* Tick of the imaging frame being measured, and of the first frame of the average */
+static uint32_t      mux_stamp;
+static uint32_t      mux_average_stamp;
+
+/* Multiplexer state handed over between the frame engine stages */
+static uint32_t      mux_word;
+static uint32_t      mux_rtiaAndGain;
+
+/* Long sequences: quads per sequencer program of the imaging modes, 0 for one quad per sequence */
+#define MUX_BLOCK_QUADS             (8)
+static uint32_t      mux_block_quads = 0;
+
+/* Injection settling of the single frequency imaging modes: the quads sharing an injection pair are */
+/* measured in turn, and a quad that only moves the sense muxes runs the imaging sequence with a       */
+/* shorter current settling                                                                           */
+#define MUX_SETTLE_FULL             (0)     /* an injection mux moved          */
+#define MUX_SETTLE_SENSE            (1)     /* only the sense muxes moved      */
+#define MUX_SETTLE_KINDS            (2)
+#define IMAGING_SENSE_SETTLE_US     (50u)
+static bool_t        mux_grouped = false;
+static bool_t        mux_settle;
+static uint16_t      mux_order[MUX_MAX_QUADS];
+static uint32_t      mux_order_key;
+static uint32_t      seq_imaging_sense[SEQ_4WIRE_LENGTH];
+
+/* Excitation ranging of the imaging modes: the level of every quad, learned from the previous frame, */
+/* and one copy of the first sequence of a quad per level, led by the waveform generator amplitude    */
+static bool_t        mux_ranging = false;
+static RANGING_TABLE mux_range;
+static uint8_t       mux_range_levels[MUX_MAX_QUADS];
+static uint8_t       mux_range_next[MUX_MAX_QUADS];
+static uint32_t      mux_range_key;
+static uint32_t      mux_range_seqs;
+static uint32_t      seq_range[MUX_SETTLE_KINDS][RANGING_LEVELS][SEQ_4WIRE_FREQ_LENGTH + 1];
+static SEQ_OBJECT    seqobj_range[MUX_SETTLE_KINDS][RANGING_LEVELS];
+/* Sequences of a quad, by settling and excitation level */
+static const uint32_t *seq_quad_list[MUX_SETTLE_KINDS][RANGING_LEVELS][MULTIFREQ_EIT_MAX_COUNT];
+/* Puts the nominal amplitude back after a ranged frame, for the other sequences */
+static uint32_t      seq_range_restore[3];
+static SEQ_OBJECT    seqobj_range_restore;
+
+/* Excitation of the single frequency 4-wire modes set by command: the highest frequency of the */
+/* spectroscopy sweep                                                                           */
+#define FREQ_MAX_HZ                 (70000u)
+
+/* Benchmark: imaging frames timed stage by stage */
+#define BENCH_FRAMES                (10)
+
+/* Auto-tuning: measurements per candidate timing and accepted magnitude spread */
+#define AUTOTUNE_SAMPLES            (16)
+#define AUTOTUNE_MAX_CV_PPM         (2000)  /* 0.2 % */
+
+/* Settling and DFT times of the 4-wire modes, and the sequences built from them */
+static SEQ_TIMING    timeseries_timing = SEQ_TIMING_4WIRE_DEFAULT(FREQ);
+static SEQ_TIMING    imaging_timing    = SEQ_TIMING_4WIRE_DEFAULT(FREQ);
+static uint32_t      seq_timeseries[SEQ_4WIRE_LENGTH];
+
+/* Continuous time series: the sample sequence repeated TIMESERIES_STREAM_SAMPLES times in one */
+/* program, its results drained TIMESERIES_STREAM_HALF samples at a time through the Rx DMA ring */
+#define TIMESERIES_STREAM_SAMPLES   (16)
+#define TIMESERIES_STREAM_HALF      (4)
+#define TIMESERIES_STREAM_WORDS     (TIMESERIES_STREAM_SAMPLES * (SEQ_4WIRE_LENGTH - 2) + 2)
+/* A program that has not delivered its results TIMESERIES_TIMEOUT_US after its expected end is aborted */
+#define TIMESERIES_TIMEOUT_US       (10000u)
+static uint32_t      seq_timeseries_stream[TIMESERIES_STREAM_WORDS];
+static SEQ_OBJECT    seqobj_timeseries_stream;
+static int16_t       timeseries_ring_buffer[2 * TIMESERIES_STREAM_HALF * DFT_RESULTS_COUNT];
+static RX_RING       timeseries_ring;
+static uint32_t      seq_imaging[SEQ_4WIRE_LENGTH];
+static const uint32_t *const seq_imaging_list[1] = { seq_imaging };
+
+/* Multi-frequency imaging: frequency list and one sequence per frequency */
+static uint32_t      multifreq_list[MULTIFREQ_EIT_MAX_COUNT];
+static uint32_t      multifreq_count = 0;
+static uint32_t      seq_multifreq[MULTIFREQ_EIT_MAX_COUNT][SEQ_4WIRE_FREQ_LENGTH];
+static const uint32_t *seq_multifreq_list[MULTIFREQ_EIT_MAX_COUNT];
+
+/* Sequences patched at run time: the CRC is recomputed once per change, so   */
+/* they run with the hardware CRC check instead of the software CRC          */
+static SEQ_OBJECT    seqobj_poweritup;
+static SEQ_OBJECT    seqobj_poweritup_bipolar;
+static SEQ_OBJECT    seqobj_bipolar;
+static SEQ_OBJECT    seqobj_bioz;
+
+/* The AFE stays powered and calibrated across mode switches: calibration profiles of the */
+/* 4-wire and 2-wire modes, and the power-it-up sequence run the first time each is used */
+static MODEMGR       mode_manager;
+static const MODEMGR_PROFILE mode_profiles[MODEMGR_PROFILES] = {
+    { CALCACHE_CAL_TEMP_SENS | CALCACHE_CAL_AUX,   true,  &seqobj_poweritup         },
+    { CALCACHE_CAL_TIA | CALCACHE_CAL_EXCITE_ATTEN, false, &seqobj_poweritup_bipolar },
+};
+
+/* Current measurement mode and imaging output format */
+static int16_t       mode = 0;
+static uint8_t       output_format = OUTPUT_ASCII;
+
+/* Impedance values of each mode (ZCONV_FORMAT_TYPE), magnitudes until changed from the menu */
+#define VALUE_FORMAT_MODES          (9)
+static uint8_t       value_format[VALUE_FORMAT_MODES] = {0};
+
+/* Imaging frame buffer: the raw DFT results of a frame, 8 bytes per measurement, */
+/* converted in place by one zconv_Batch() call once the frame is measured. The  */
+/* averaged frames, of up to AVERAGE_IMAGING_VALUES raw words, leave the rest of */
+/* the buffer to the imaging accumulator, a larger frame resets the average     */
+#define MUX_FRAME_CAPACITY          (MUX_MAX_QUADS)
+#define AVERAGE_IMAGING_VALUES      (384)
+typedef union {
+    int32_t             frame[MUX_FRAME_CAPACITY * 2];
+    struct {
+        int32_t         frame[AVERAGE_IMAGING_VALUES];
+        int32_t         first[AVERAGE_IMAGING_VALUES];
+        int64_t         sum[AVERAGE_IMAGING_VALUES];
+        uint64_t        sumsq[AVERAGE_IMAGING_VALUES];
+    } averaged;
+} MUX_FRAME_ARENA;
+static MUX_FRAME_ARENA mux_arena;
+static int32_t *const mux_frame = mux_arena.frame;
+static uint32_t      mux_frame_count;
+static ZCONV_CONFIG  mux_zconv;
+static ZCONV_FORMAT_TYPE mux_value_format;
+/* Values per imaging frame */
+static uint32_t      mux_values;
+
+/* Frame averaging: frames per output (1 for none) and variance output, set from the menu */
+static uint32_t      average_frames = 1;
+static bool_t        average_variance = false;
+/* Imaging accumulator, in the frame buffer, sized for a 16 electrode frame of pairs, and the time series one */
+static AVERAGE_ACCUMULATOR mux_average;
+static uint32_t      mux_average_key;
+static bool_t        mux_averaging;
+static int32_t       timeseries_average_first[2];
+static int64_t       timeseries_average_sum[2];
+static uint64_t      timeseries_average_sumsq[2];
+static AVERAGE_ACCUMULATOR timeseries_average;
+static uint32_t      timeseries_average_key;
+static uint32_t      timeseries_average_tick;
     
 /* Custom fixed-point type used for final results,              */
 /* to keep track of the decimal point position.                 */
@@ -92,26 +294,73 @@ typedef union {
 
 
 /* Function prototypes */
-q15_t                   arctan                  (q15_t imag, q15_t real);
 fixed32_t calculate_magnitude(q31_t magnitude_1, q31_t magnitude_2, uint32_t res);
-fixed32_t               calculate_phase         (q15_t phase_rcal, q15_t phase_z);
 void                    convert_dft_results     (int16_t *dft_results, q15_t *dft_results_q15, q31_t *dft_results_q31);
 void                    sprintf_fixed32         (char *out, fixed32_t in);
 void                    print_MagnitudePhase    (char *text, fixed32_t magnitude, fixed32_t phase);
 void                    test_print              (char *pBuffer);
+void                    test_write              (uint8_t *pData, uint16_t size);
+void                    uart_write              (const uint8_t *pData, uint16_t size);
 ADI_UART_RESULT_TYPE    uart_Init               (void);
 ADI_UART_RESULT_TYPE    uart_Init_Simple        (void);
 ADI_UART_RESULT_TYPE    uart_UnInit             (void);
 void                    delay                   (uint32_t counts);
 extern int32_t          adi_initpinmux          (void);
-void                    multiplex_adg732        (ADI_AFE_DEV_HANDLE  hDevice, const uint32_t *const seq,uint32_t n_el);
+void                    multiplex_adg732        (ADI_AFE_DEV_HANDLE  hDevice, const uint32_t *const *seqs,
+                                                 const uint32_t *freqs, uint32_t numFreqs, uint32_t n_el);
+void                    multifreq_build         (const uint32_t *freqs, uint32_t numFreqs);
+uint32_t                mux_select_pattern      (uint32_t n_el);
+void                    mux_benchmark           (void);
+void                    imaging_frame           (void);
+void                    frame_benchmark         (void);
+void                    autotune_timing         (void);
+bool_t                  autotune_measure        (const uint32_t *seq, int32_t *pMagnitude);
+void                    mux_prepare_quad        (uint32_t econf);
+void                    mux_apply_quad          (uint32_t econf);
+void                    mux_switch_quad         (uint32_t econf);
+void                    block_select            (uint32_t quads);
+void                    range_select            (bool_t enable);
+void                    plan_select             (uint32_t planMode);
+bool_t                  plan_begin              (void);
+void                    plan_emit               (uint32_t n_el);
+void                    plan_check              (uint32_t numFreqs);
+uint32_t                plan_ppm                (uint64_t difference, uint64_t reference);
+uint32_t                mux_plan_index          (uint32_t econf);
+uint32_t                mux_plan_source         (uint32_t quad);
+void                    settle_select           (bool_t enable);
+void                    delta_select            (bool_t enable);
+void                    timestamp_select        (bool_t enable);
+void                    timestamp_prefix        (char *pOut, uint32_t tick);
+bool_t                  frequency_select        (uint32_t frequency);
+void                    menu_key                (uint8_t key);
+void                    command_poll            (void);
+void                    command_execute         (const COMMAND_REQUEST *pRequest);
+void                    command_report          (uint8_t *pReport);
+void                    command_respond         (const COMMAND_REQUEST *pRequest, uint8_t status,
+                                                 const uint8_t *pPayload, uint8_t length);
+void                    settle_build            (void);
+void                    mux_quad_build          (const uint32_t *const *seqs, uint32_t numSeqs);
+const uint32_t *const  *mux_quad_seqs           (uint32_t econf);
+uint32_t                mux_slot                (uint32_t econf);
+void                    range_emit              (uint32_t n_el, uint32_t frequency);
+void                    mux_emit_quad           (uint32_t econf, uint32_t freq, int16_t *dft_results);
+void                    mux_emit_frame          (void);
+void                    mux_print               (char *pBuffer);
+void                    mux_put_values          (const int32_t *pValues, uint32_t count);
+void                    mux_frame_begin         (const uint32_t *freqs, uint32_t numFreqs, uint32_t n_el, bool_t variance);
+void                    mux_frame_end           (void);
+void                    average_select          (uint32_t frames, bool_t variance);
+bool_t                  average_collect         (AVERAGE_ACCUMULATOR *pAcc, uint32_t *pKey, uint32_t key,
+                                                 const int32_t *pValues, uint32_t count);
+bool_t                  value_select            (ZCONV_FORMAT_TYPE format);
+const char*             value_label             (ZCONV_FORMAT_TYPE format);
 void                    time_series             (ADI_AFE_DEV_HANDLE  hDevice, const uint32_t *const seq);
-void                    bioimpedance_spectroscopy     (ADI_AFE_DEV_HANDLE  hDevice, const uint32_t *const seq);
-void                    init_GPIO_ports         (void);
+void                    time_series_sample      (int16_t *dft_results, uint32_t tick);
+void                    time_series_rx_callback (void *pCBParam, uint32_t Event, void *pArg);
+void                    bioimpedance_spectroscopy     (ADI_AFE_DEV_HANDLE  hDevice, SEQ_OBJECT *pSeq);
 fixed32_t               calculate_bipolar_magnitude     (q31_t magnitude_rcal, q31_t magnitude_z);
-void                    init_mode_tetramux        (void);
-void                    init_mode_bis             (void);
-void                    init_mode_bipolar       (void);
+bool_t                  mode_switch             (int16_t newMode);
+void                    mode_target             (MODEMGR_TARGET *pTarget);
 void                    time_series_bipolar(ADI_AFE_DEV_HANDLE  hDevice, const uint32_t *const seq);
 fixed32_t               calculate_bipolar_magnitude     (q31_t magnitude_rcal, q31_t magnitude_z);
 void                    bipolar_adg732(ADI_AFE_DEV_HANDLE  hDevice, const uint32_t *const seq,uint32_t n_el);
@@ -120,9 +369,6 @@ int main(void)
 {
   
   ADI_UART_RESULT_TYPE uartResult;
-  int16_t  rxSize;
-  int16_t  txSize;  
-  int16_t  mode = 0; 
   
   /* Flag which indicates whether to stop the program */
   _Bool bStopFlag = false;
@@ -161,124 +407,68 @@ int main(void)
   char msg1[300] = {0};
   strcat(msg1, "OpenEIT\n");  
   PRINT(msg1);
-  uint16_t numbytes = 2; 
+  command_Init(&command_parser);
+  stream_Init(test_write);
+  if (!timestamp_Init()) {
+    PRINT("timestamp: no timer, records stamped 0\n");
+  }
+#if (1 == USE_USB_FOR_DATA)
+  if (!usb_stream_Init()) {
+    PRINT("usb: no device stack, binary frames on the UART\n");
+  }
+#endif
+  seq_Build4Wire(&timeseries_timing, seq_timeseries, SEQ_4WIRE_LENGTH);
+  seq_Build4Wire(&imaging_timing, seq_imaging, SEQ_4WIRE_LENGTH);
+  settle_build();
+  multifreq_build(multifreq_eit, MULTIFREQ_EIT_COUNT);
+  seq_Attach(&seqobj_poweritup, seq_afe_poweritup, sizeof(seq_afe_poweritup) / sizeof(seq_afe_poweritup[0]));
+  seq_Attach(&seqobj_poweritup_bipolar, seq_afe_poweritup_bipolar, sizeof(seq_afe_poweritup_bipolar) / sizeof(seq_afe_poweritup_bipolar[0]));
+  seq_Attach(&seqobj_bipolar, seq_fast_2wire_bipolar, sizeof(seq_fast_2wire_bipolar) / sizeof(seq_fast_2wire_bipolar[0]));
+  seq_Attach(&seqobj_bioz, seq_afe_fast_acmeasBioZ_4wire, sizeof(seq_afe_fast_acmeasBioZ_4wire) / sizeof(seq_afe_fast_acmeasBioZ_4wire[0]));
+  seq_Attach(&seqobj_timeseries_stream, seq_timeseries_stream, TIMESERIES_STREAM_WORDS);
+  rxring_Init(&timeseries_ring, timeseries_ring_buffer, TIMESERIES_STREAM_HALF * DFT_RESULTS_COUNT);
+  average_Init(&mux_average, mux_arena.averaged.first, mux_arena.averaged.sum, mux_arena.averaged.sumsq,
+               AVERAGE_IMAGING_VALUES);
+  average_Init(&timeseries_average, timeseries_average_first, timeseries_average_sum, timeseries_average_sumsq, 2);
+  ranging_Init(&mux_range, mux_range_levels, mux_range_next, MUX_MAX_QUADS);
+  for (uint32_t settle = 0; settle < MUX_SETTLE_KINDS; settle++) {
+    for (uint32_t level = 0; level < RANGING_LEVELS; level++) {
+      seq_Attach(&seqobj_range[settle][level], seq_range[settle][level], SEQ_4WIRE_FREQ_LENGTH + 1);
+    }
+  }
+  seq_Attach(&seqobj_range_restore, seq_range_restore, 3);
+  seq_Reset(&seqobj_range_restore);
+  seq_Append(&seqobj_range_restore, SEQ_MMR_WRITE(REG_AFE_AFE_WG_AMPLITUDE, SINE_AMPLITUDE));
+  seq_Append(&seqobj_range_restore, SEQ_END_COMMAND);
+  modemgr_Init(&mode_manager, mode_profiles, RCAL, RTIA);
   bStopFlag = true;     
-  rxSize = 2;  
-  mode   = 4;
-  init_mode_tetramux();  
+  mode_switch(4);
         
   /* main processing loop */
   while (bStopFlag == true) // running
   {
     
-    // only execute a blocking read buffer if something has been sent. 
-    if (adi_UART_GetNumRxBytes(hUartDevice) > numbytes)
-    {
-      /* Read a character */
-      uartResult = adi_UART_BufRx(hUartDevice, RxBuffer, &rxSize);
-    }
-       
-    /* Select 1,2,3 to enter into a different mode. */
-    if(RxBuffer[0] == 'a' && RxBuffer[1] == '\n' && mode != 1)  // Time-Series
-    {
-      mode = 1;
-      // Reset everything.   
-      //re-initialize uart... 
-      uart_UnInit();
-      adi_GPIO_ResetToPowerUp();
-      adi_initpinmux();      
-      uart_Init();
-      adi_GPIO_UnInit();
-      adi_AFE_UnInit(hDevice);
-      PRINT("mode 1: time series\n");
-      init_mode_tetramux();     
-      adi_UART_BufFlush(hUartDevice);
-    }          
-    else if (RxBuffer[0] == 'b' && RxBuffer[1] == '\n' && mode != 2)  // Bioimpedance Spectroscopy
-    {
-      // Reset everything. 
-      adi_GPIO_UnInit();  
-      adi_AFE_UnInit(hDevice);
-      PRINT("mode 2: bioimpedance spectroscopy\n");
-      mode = 2;
-      init_mode_bis();
-      PRINT("end initialize\n");
-      adi_UART_BufFlush(hUartDevice);
-    }
-    else if (RxBuffer[0] == 'c'  && RxBuffer[1] == '\n' && mode !=3)  // 8 electrode Tetrapolar Imaging 
-    {
-      mode = 3;
-      // Reset everything.  
-      adi_GPIO_UnInit();  
-      adi_AFE_UnInit(hDevice);
-      PRINT("mode 3: 8 electrode imaging\n");
-      init_mode_tetramux();
-      adi_UART_BufFlush(hUartDevice);
-    }
-    else if (RxBuffer[0] == 'd'  && RxBuffer[1] == '\n' && mode !=4)  // 16 electrode Tetrapolar Imaging 
-    {
-      mode = 4;
-      // Reset everything.  
-      adi_GPIO_UnInit();  
-      adi_AFE_UnInit(hDevice);
-      PRINT("mode 4: 16 electrode imaging\n");
-      init_mode_tetramux();
-      adi_UART_BufFlush(hUartDevice);
-    }
-    else if (RxBuffer[0] == 'e'  && RxBuffer[1] == '\n' && mode !=5)  // 32 electrode Tetrapolar Imaging 
-    {
-      mode = 5;
-      // Reset everything.  
-      adi_GPIO_UnInit();  
-      adi_AFE_UnInit(hDevice);
-      PRINT("mode 3: 32 electrode imaging\n");
-      init_mode_tetramux();
-      adi_UART_BufFlush(hUartDevice);
-    }    
-    else if (RxBuffer[0] == 'f'  && RxBuffer[1] == '\n' )  // Bipolar Imaging 
-    {
-      mode = 6;
-      init_mode_bipolar();
-      adi_UART_BufFlush(hUartDevice);
-    }        
-    else if (RxBuffer[0] == 'g'  && RxBuffer[1] == '\n' )  // Bipolar Time series Imaging 
-    {
-      mode = 7;
-      init_mode_bipolar();
-      adi_UART_BufFlush(hUartDevice);
-    }                
-    else {
-      // clears out UART buffer in case user presses random stuff a few times. 
-      adi_UART_BufFlush(hUartDevice);
+    // the received bytes are parsed as they come in, into menu keys and command frames. 
+    command_poll();
+    if (!acquisition_running) {
+      continue;
     }
-
+    
     if (mode == 1) {  // time series
-      time_series(hDevice, seq_afe_fast_meas_4wire);
+      time_series(hDevice, seq_timeseries);
     }
     else if (mode == 2) {  // bioimpedance spectroscopy
-      bioimpedance_spectroscopy(hDevice, seq_afe_fast_acmeasBioZ_4wire);
-    }
-    else if (mode == 3) {  // 8 electrode imaging
-      uint32_t n_el = 8;
-      /* Perform the multiplex adg732 Tetrapolar Impedance measurements */
-      multiplex_adg732(hDevice, seq_afe_fast_meas_4wire, n_el);
+      bioimpedance_spectroscopy(hDevice, &seqobj_bioz);
     }
-    else if (mode == 4) {  // 16 electrode imaging
-      uint32_t n_el = 16;
-      /* Perform the multiplex adg732 Tetrapolar Impedance measurements */
-      multiplex_adg732(hDevice, seq_afe_fast_meas_4wire, n_el);
-    }    
-    else if (mode == 5) {  // 32 electrode imaging
-      uint32_t n_el = 32;
-      /* Perform the multiplex adg732 Tetrapolar Impedance measurements */
-      multiplex_adg732(hDevice, seq_afe_fast_meas_4wire, n_el);
+    else if (((mode >= 3) && (mode <= 5)) || (mode == 8)) {  // 8, 16, 32 electrode and multi-frequency imaging
+      imaging_frame();
     }    
     else if (mode == 6) {
       uint32_t n_el = 16;
-      bipolar_adg732(hDevice, seq_fast_2wire_bipolar, n_el);
+      bipolar_adg732(hDevice, seq_Commit(&seqobj_bipolar), n_el);
     }
     else if (mode == 7) {
-      time_series_bipolar(hDevice, seq_fast_2wire_bipolar);
+      time_series_bipolar(hDevice, seq_Commit(&seqobj_bipolar));
     }
     else {
       PRINT("no mode chosen\n");
@@ -306,102 +496,354 @@ int main(void)
     FAIL("adi_UART_UnInit");
   }
   
-  
+  return 0;
 }
 
 
 
-/* Arctan Implementation                                                                                    */
-/* =====================                                                                                    */
-/* Arctan is calculated using the formula:                                                                  */
-/*                                                                                                          */
-/*      y = arctan(x) = 0.318253 * x + 0.003314 * x^2 - 0.130908 * x^3 + 0.068542 * x^4 - 0.009159 * x^5    */
-/*                                                                                                          */
-/* The angle in radians is given by (y * pi)                                                                */
-/*                                                                                                          */
-/* For the fixed-point implementation below, the coefficients are quantized to 16-bit and                   */
-/* represented as 1.15                                                                                      */
-/* The input vector is rotated until positioned between 0 and pi/4. After the arctan                        */
-/* is calculated for the rotated vector, the initial angle is restored.                                     */
-/* The format of the output is 1.15 and scaled by PI. To find the angle value in radians from the output    */
-/* of this function, a multiplication by PI is needed.                                                      */
-
-const q15_t coeff[5] = {
-    (q15_t)0x28BD,     /*  0.318253 */
-    (q15_t)0x006D,     /*  0.003314 */
-    (q15_t)0xEF3E,     /* -0.130908 */
-    (q15_t)0x08C6,     /*  0.068542 */
-    (q15_t)0xFED4,     /* -0.009159 */
-};
-
-q15_t arctan(q15_t imag, q15_t real) {
-    q15_t       t;
-    q15_t       out;
-    uint8_t     rotation; /* Clockwise, multiples of PI/4 */
-    int8_t      i;
-
-    if ((q15_t)0 == imag) {
-        /* Check the sign*/
-        if (real & (q15_t)0x8000) {
-            /* Negative, return -PI */
-            return (q15_t)0x8000;
-        }
-        else {
-            return (q15_t)0;
-        }
-    }
-    else {
+/* Run a key of the single character menu */
+void menu_key(uint8_t key) {
+  
+  if(key == 'a' && mode != 1)  // Time-Series
+  {
+    PRINT("mode 1: time series\n");
+    mode_switch(1);
+  }          
+  else if (key == 'b' && mode != 2)  // Bioimpedance Spectroscopy
+  {
+    PRINT("mode 2: bioimpedance spectroscopy\n");
+    mode_switch(2);
+    PRINT("end initialize\n");
+  }
+  else if (key == 'c' && mode !=3)  // 8 electrode Tetrapolar Imaging 
+  {
+    PRINT("mode 3: 8 electrode imaging\n");
+    mode_switch(3);
+  }
+  else if (key == 'd' && mode !=4)  // 16 electrode Tetrapolar Imaging 
+  {
+    PRINT("mode 4: 16 electrode imaging\n");
+    mode_switch(4);
+  }
+  else if (key == 'e' && mode !=5)  // 32 electrode Tetrapolar Imaging 
+  {
+    PRINT("mode 5: 32 electrode imaging\n");
+    mode_switch(5);
+  }    
+  else if (key == 'm' && mode !=8)  // Multi-frequency Tetrapolar Imaging 
+  {
+    PRINT("mode 8: multi-frequency imaging\n");
+    mode_switch(8);
+  }    
+  else if (key == 'f')  // Bipolar Imaging 
+  {
+    mode_switch(6);
+    PRINT("FINISHED SET UP \n");
+  }        
+  else if (key == 'g')  // Bipolar Time series Imaging 
+  {
+    mode_switch(7);
+    PRINT("FINISHED SET UP \n");
+  }                
+  else if (key == 'h')  // Binary frames, 28.4 magnitudes 
+  {
+    output_format = OUTPUT_BINARY_FIXED32;
+  }
+  else if (key == 'i')  // Binary frames, raw q31 magnitudes 
+  {
+    output_format = OUTPUT_BINARY_Q31;
+  }
+  else if (key == 'j')  // ASCII output 
+  {
+    output_format = OUTPUT_ASCII;
+  }
+  else if (key == 'k')  // Multiplexer switching benchmark 
+  {
+    mux_benchmark();
+  }
+  else if (key == 'l')  // Auto-tune the DFT windows of the current mode 
+  {
+    autotune_timing();
+  }
+  else if (key == 'n')  // Time the stages of the current imaging mode 
+  {
+    frame_benchmark();
+  }
+  else if (key == 'o')  // Magnitudes in the current mode 
+  {
+    value_select(ZCONV_FORMAT_MAGNITUDE);
+  }
+  else if (key == 'p')  // Magnitude and phase pairs in the current mode 
+  {
+    value_select(ZCONV_FORMAT_MAG_PHASE);
+  }
+  else if (key == 'q')  // Real and imaginary pairs in the current mode 
+  {
+    value_select(ZCONV_FORMAT_REAL_IMAG);
+  }
+  else if (key >= '0' && key <= '6' )  // Average 2^n frames 
+  {
+    average_select(1u << (key - '0'), average_variance);
+  }
+  else if (key == 'r')  // Variance of the averaged frames on 
+  {
+    average_select(average_frames, true);
+  }
+  else if (key == 's')  // Variance of the averaged frames off 
+  {
+    average_select(average_frames, false);
+  }
+  else if (key == 't')  // Several quads per sequencer program 
+  {
+    block_select(MUX_BLOCK_QUADS);
+  }
+  else if (key == 'u')  // One quad per sequencer program 
+  {
+    block_select(0);
+  }
+  else if (key == 'v')  // Excitation amplitude ranged per quad 
+  {
+    range_select(true);
+  }
+  else if (key == 'w')  // Nominal excitation amplitude on every quad 
+  {
+    range_select(false);
+  }
+  else if (key == '7')  // Quads grouped by injection pair, shorter sense settling 
+  {
+    settle_select(true);
+  }
+  else if (key == '8')  // Pattern order, full settling on every quad 
+  {
+    settle_select(false);
+  }
+  else if (key == 'D')  // Binary frames as residuals against the previous frame 
+  {
+    delta_select(true);
+  }
+  else if (key == 'F')  // Every binary frame sent whole 
+  {
+    delta_select(false);
+  }
+  else if (key == 'T')  // Records timestamped with the microsecond tick 
+  {
+    timestamp_select(true);
+  }
+  else if (key == 'N')  // Records without timestamps 
+  {
+    timestamp_select(false);
+  }
+  else if (key == 'x')  // Skip the quads equal to an earlier one 
+  {
+    plan_select(PLAN_REDUCED);
+  }
+  else if (key == 'y')  // Measure every quad of the pattern 
+  {
+    plan_select(PLAN_FULL);
+  }
+  else if (key == 'z')  // Reduced plan, checked by a full frame every PLAN_QA_FRAMES 
+  {
+    plan_select(PLAN_REDUCED_QA);
+  }
+}
 
-        rotation = 0;
-        /* Rotate the vector until it's placed in the first octant (0..PI/4) */
-        if (imag < 0) {
-            imag      = -imag;
-            real      = -real;
-            rotation += 4;
+/* Parse the received bytes: run the menu keys and execute the command frames. A frame */
+/* cut short is waited for up to COMMAND_TIMEOUT_US after its last byte, then dropped. */
+void command_poll(void) {
+  
+    uint8_t             rx[COMMAND_RX_CHUNK];
+    int16_t             rxSize;
+    int16_t             i;
+    uint32_t            last = timestamp_Now();
+    
+    for (;;) {
+      if (0 == adi_UART_GetNumRxBytes(hUartDevice)) {
+        if (!command_Pending(&command_parser)) {
+          return;
         }
-        if (real <= 0) {
-            /* Using 't' as temporary storage before its normal usage */
-            t         = real;
-            real      = imag;
-            imag      = -t;
-            rotation += 2;
+        if ((timestamp_Now() - last) >= COMMAND_TIMEOUT_US) {
+          command_Timeout(&command_parser);
+          command_errors++;
+          return;
         }
-        if (real <= imag) {
-            /* The addition below may overflow, drop 1 LSB precision if needed. */
-            /* The subtraction cannot underflow.                                */
-            t = real + imag;
-            if (t < 0) {
-                /* Overflow */
-                t         = imag - real;
-                real      = (q15_t)(((q31_t)real + (q31_t)imag) >> 1);
-                imag      = t >> 1;
-            }
-            else {
-                t         = imag - real;
-                real      = (real + imag);
-                imag      = t;              
-            }
-            rotation += 1;
+        continue;
+      }
+      rxSize = COMMAND_RX_CHUNK;
+      if (ADI_UART_SUCCESS != adi_UART_BufRx(hUartDevice, rx, &rxSize)) {
+        return;
+      }
+      for (i = 0; i < rxSize; i++) {
+        switch (command_Parse(&command_parser, rx[i])) {
+        case COMMAND_EVENT_KEY:
+          menu_key(command_parser.key);
+          break;
+        case COMMAND_EVENT_REQUEST:
+          command_execute(&command_parser.request);
+          break;
+        case COMMAND_EVENT_ERROR:
+          command_respond(&command_parser.request, command_parser.status, NULL, 0);
+          break;
+        default:
+          break;
         }
+      }
+      last = timestamp_Now();
+    }
+}
 
-        /* Calculate tangent value */
-        t = (q15_t)((q31_t)(imag << 15) / real);
-
-        out = (q15_t)0;
-
-        for (i = 4; i >=0; i--) {
-            out += coeff[i];
-            arm_mult_q15(&out, &t, &out, 1);
-        }
-        
-        /* Rotate back to original position, in multiples of pi/4 */
-        /* We're using 1.15 representation, scaled by pi, so pi/4 = 0x2000 */
-        out += (rotation << 13);
+/* Execute a request of the host and answer it, see command.h */
+void command_execute(const COMMAND_REQUEST *pRequest) {
+  
+    const uint8_t      *pPayload = pRequest->payload;
+    uint8_t             report[COMMAND_REPORT_SIZE];
+    uint8_t             status   = COMMAND_STATUS_OK;
+    uint8_t             length   = 0;
+    uint8_t             value;
+    
+    print_muted = true;
+    switch (pRequest->opcode) {
+    case COMMAND_OPCODE_PING:
+      length = pRequest->length;
+      break;
+    case COMMAND_OPCODE_GET_STATUS:
+      command_report(report);
+      pPayload = report;
+      length   = COMMAND_REPORT_SIZE;
+      break;
+    case COMMAND_OPCODE_SET_MODE:
+      // answered once the new mode is set up, a failed setup step runs again at the next switch. 
+      if ((pPayload[0] < 1) || (pPayload[0] > 8)) {
+        status = COMMAND_STATUS_BAD_VALUE;
+      }
+      else if (!mode_switch(pPayload[0])) {
+        status = COMMAND_STATUS_BAD_STATE;
+      }
+      break;
+    case COMMAND_OPCODE_SET_OUTPUT:
+      if (pPayload[0] > OUTPUT_BINARY_Q31) {
+        status = COMMAND_STATUS_BAD_VALUE;
+      }
+      else {
+        output_format = pPayload[0];
+      }
+      break;
+    case COMMAND_OPCODE_SET_VALUES:
+      if (pPayload[0] > ZCONV_FORMAT_REAL_IMAG) {
+        status = COMMAND_STATUS_BAD_VALUE;
+      }
+      else if (!value_select((ZCONV_FORMAT_TYPE)pPayload[0])) {
+        status = COMMAND_STATUS_BAD_STATE;
+      }
+      break;
+    case COMMAND_OPCODE_SET_AVERAGE:
+      if ((pPayload[0] > 6) || (pPayload[1] > 1)) {
+        status = COMMAND_STATUS_BAD_VALUE;
+      }
+      else {
+        average_select(1u << pPayload[0], pPayload[1]);
+      }
+      break;
+    case COMMAND_OPCODE_SET_OPTION:
+      value = pPayload[1];
+      if (value > ((COMMAND_OPTION_PLAN == pPayload[0]) ? PLAN_REDUCED_QA : 1u)) {
+        status = COMMAND_STATUS_BAD_VALUE;
+      }
+      else if (COMMAND_OPTION_BLOCKS == pPayload[0]) {
+        block_select(value ? MUX_BLOCK_QUADS : 0);
+      }
+      else if (COMMAND_OPTION_RANGING == pPayload[0]) {
+        range_select(value);
+      }
+      else if (COMMAND_OPTION_GROUPED == pPayload[0]) {
+        settle_select(value);
+      }
+      else if (COMMAND_OPTION_DELTA == pPayload[0]) {
+        delta_select(value);
+      }
+      else if (COMMAND_OPTION_PLAN == pPayload[0]) {
+        plan_select(value);
+      }
+      else if (COMMAND_OPTION_TIMESTAMPS == pPayload[0]) {
+        timestamp_select(value);
+      }
+      else {
+        status = COMMAND_STATUS_BAD_VALUE;
+      }
+      break;
+    case COMMAND_OPCODE_SET_FREQUENCY:
+      if (!frequency_select(command_GetU32(pPayload))) {
+        status = COMMAND_STATUS_BAD_VALUE;
+      }
+      break;
+    case COMMAND_OPCODE_START:
+      acquisition_running = true;
+      break;
+    case COMMAND_OPCODE_STOP:
+      acquisition_running = false;
+      break;
+    default:
+      status = COMMAND_STATUS_BAD_OPCODE;
+      break;
+    }
+    print_muted = false;
+    
+    command_respond(pRequest, status, pPayload, length);
+}
 
-        return out;
+/* GET_STATUS payload, see command.h */
+void command_report(uint8_t *pReport) {
+  
+    uint8_t             options = 0;
+    
+    if (average_variance) {
+      options |= COMMAND_REPORT_VARIANCE;
+    }
+    if (mux_block_quads > 0) {
+      options |= COMMAND_REPORT_BLOCKS;
+    }
+    if (mux_ranging) {
+      options |= COMMAND_REPORT_RANGING;
     }
+    if (mux_grouped) {
+      options |= COMMAND_REPORT_GROUPED;
+    }
+    if (delta_frames) {
+      options |= COMMAND_REPORT_DELTA;
+    }
+    if (timestamps) {
+      options |= COMMAND_REPORT_TIMESTAMPS;
+    }
+#if (1 == USE_USB_FOR_DATA)
+    if (usb_stream_IsConnected()) {
+      options |= COMMAND_REPORT_USB;
+    }
+#endif /* USE_USB_FOR_DATA */
+    
+    pReport[0]  = (uint8_t)mode;
+    pReport[1]  = acquisition_running ? 1 : 0;
+    pReport[2]  = output_format;
+    pReport[3]  = ((mode > 0) && (mode < VALUE_FORMAT_MODES)) ? value_format[mode] : 0;
+    command_PutU32(&pReport[4], imaging_timing.frequency);
+    command_PutU16(&pReport[8], (uint16_t)average_frames);
+    pReport[10] = options;
+    pReport[11] = (uint8_t)plan_mode;
+    command_PutU16(&pReport[12], adi_UART_GetNumRxDropped(hUartDevice));
+    command_PutU16(&pReport[14], command_errors);
+    command_PutU16(&pReport[16], adi_UART_GetNumTxDropped(hUartDevice));
 }
 
+/* Answer a request on the UART, queued after the output before it and never truncated */
+void command_respond(const COMMAND_REQUEST *pRequest, uint8_t status, const uint8_t *pPayload, uint8_t length) {
+  
+    uint8_t             response[COMMAND_RESPONSE_MAX_SIZE];
+    int16_t             size;
+    
+    if (COMMAND_STATUS_OK != status) {
+      command_errors++;
+    }
+    size = (int16_t)command_Response(response, pRequest->opcode, pRequest->tag, status, pPayload, length);
+    uart_write(response, (uint16_t)size);
+}
 /* This function performs dual functionality:                                           */
 /* - open circuit check: the real and imaginary parts can be non-zero but very small    */
 /*   due to noise. If they are within the defined thresholds, overwrite them with 0s,   */
@@ -492,23 +934,6 @@ fixed32_t calculate_bipolar_magnitude(q31_t magnitude_rcal, q31_t magnitude_z) {
         
     return out;
 }
-/* Calculates phase.                                        */                     
-/* performs the calculation:                                */
-/*      phase = (phase_2 - phase_1) * PI / (2 * PI) * 180   */
-/*            = (phase_2 - phase_1) * 180                   */
-/* Output in custom fixed-point format (28.4).              */
-fixed32_t calculate_phase(q15_t phase_1, q15_t phase_2) {
-    q63_t       phase;
-    fixed32_t   out;
-
-    /* Multiply by 180 to convert to degrees */
-    phase = ((q63_t)(phase_2 - phase_1) * (q63_t)180);                  
-    /* Round and convert to fixed32_t */
-    out.full = ((phase + (q63_t)0x400) >> 11) & 0xFFFFFFFF;
-
-    return out;
-}
-
 
 /* Simple conversion of a fixed32_t variable to string format. */
 void sprintf_fixed32(char *out, fixed32_t in) {
@@ -556,17 +981,52 @@ void print_MagnitudePhase(char *text, fixed32_t magnitude, fixed32_t phase) {
 void test_print (char *pBuffer) {
 #if (1 == USE_UART_FOR_DATA)
     int16_t size;
+    if (print_muted) {
+        return;
+    }
     /* Print to UART */
     size = strlen(pBuffer);
-    adi_UART_BufTx(hUartDevice, pBuffer, &size);
+    uart_write((uint8_t *)pBuffer, (uint16_t)size);
 
 #elif (0 == USE_UART_FOR_DATA)
     /* Print  to console */
-    printf(pBuffer);
+    printf("%s", pBuffer);
 #endif /* USE_UART_FOR_DATA */
 }
 
 
+/* Helper function for writing binary data to USB when a host has it open, or to the UART. */
+void test_write (uint8_t *pData, uint16_t size) {
+#if (1 == USE_USB_FOR_DATA)
+    if (usb_stream_IsConnected()) {
+        usb_stream_Write(pData, size);
+        return;
+    }
+#endif /* USE_USB_FOR_DATA */
+    uart_write(pData, size);
+}
+
+
+/* Queue bytes on the UART Tx ring, drained by DMA, and return at once. Only when the */
+/* ring is full does it wait, for the room the DMA frees, so nothing is truncated.    */
+void uart_write (const uint8_t *pData, uint16_t size) {
+    int16_t txSize;
+    uint16_t room;
+
+    while (size > 0) {
+        while (0 == (room = adi_UART_GetNumTxBytes(hUartDevice))) {
+            /* backpressure: the ring is full */
+        }
+        txSize = (int16_t)((size > room) ? room : size);
+        if ((ADI_UART_SUCCESS != adi_UART_BufTx(hUartDevice, pData, &txSize)) || (txSize <= 0)) {
+            break;
+        }
+        pData += txSize;
+        size  -= (uint16_t)txSize;
+    }
+}
+
+
 /* Initialize the UART, set the baud rate and enable */
 ADI_UART_RESULT_TYPE uart_Init_Simple (void) {
     ADI_UART_RESULT_TYPE    result = ADI_UART_SUCCESS;
@@ -615,12 +1075,16 @@ ADI_UART_RESULT_TYPE uart_Init (void) {
         test_Fail("adi_UART_Init() failed");
     }
 
+    /* Transmit is queued in TxBuffer and drained by DMA, so measurement   */
+    /* output overlaps the next acquisition. Bytes that do not fit are     */
+    /* dropped and counted (adi_UART_GetNumTxDropped): uart_write() waits  */
+    /* for room instead, only while the ring is full.                      */
     Settings.BaudRate = ADI_UART_BAUD_115200; //ADI_UART_BAUD_115200;
-    Settings.bBlockingMode = true;
+    Settings.bBlockingMode = false;
     Settings.bInterruptMode = true;
     Settings.Parity = ADI_UART_PARITY_NONE;
     Settings.WordLength = ADI_UART_WLS_8;
-    Settings.bDmaMode = false;
+    Settings.bDmaMode = true;
           
     /* config UART */
     uartResult =  adi_UART_SetGenericSettings(hUartDevice, &Settings);
@@ -664,14 +1128,18 @@ void delay(uint32_t count)
     Main loop for tetrapolar bioimpedance spectroscopy 
 
 *****************************************************************************/
-void bioimpedance_spectroscopy(ADI_AFE_DEV_HANDLE  hDevice, const uint32_t *const seq) {
+void bioimpedance_spectroscopy(ADI_AFE_DEV_HANDLE  hDevice, SEQ_OBJECT *pSeq) {
   
-  int16_t             dft_results[DFT_RESULTS_COUNT];
-  q15_t               dft_results_q15[DFT_RESULTS_COUNT];
-  q31_t               dft_results_q31[DFT_RESULTS_COUNT];
-  q31_t               magnitude[DFT_RESULTS_COUNT / 2];
-  int8_t              j,k;    
-  uint32_t            rtiaAndGain;  
+  int16_t             dft_results[MULTIFREQUENCY_ARRAY_SIZE * DFT_RESULTS_COUNT] = {0};
+  int32_t             values[MULTIFREQUENCY_ARRAY_SIZE * 2];
+  ZCONV_FORMAT_TYPE   format = (ZCONV_FORMAT_TYPE)value_format[mode];
+  ZCONV_CONFIG        config;
+  fixed32_t           value;
+  char                msg[MSG_MAXLEN_M3];
+  char                tmp[MSG_MAXLEN_M1];
+  uint32_t            ticks[MULTIFREQUENCY_ARRAY_SIZE];
+  uint32_t            i, n;
+  int8_t              j;    
 
   for (j = 0; j < MULTIFREQUENCY_ARRAY_SIZE; j++)   /* Here we start an outer frequency loop. */ 
   {    
@@ -680,55 +1148,43 @@ void bioimpedance_spectroscopy(ADI_AFE_DEV_HANDLE  hDevice, const uint32_t *cons
     uint64_t FREQ_MOD = multifrequency[j];
     uint32_t FCW_MOD  = ((uint32_t)(((uint64_t)FREQ_MOD << 26) / 16000000 + 0.5));
     
-    char                stringfrequency[MSG_MAXLEN_M2];
-    sprintf(stringfrequency, "%s;", stringfreqs[j]);
-    char                msg[MSG_MAXLEN_M2] = {0};
-    
-    if (j >= MULTIFREQUENCY_ARRAY_SIZE) {  // reset J 
-      j = 0;
-    }
-    
     /* Update FCW in the sequence */
-    seq_afe_fast_acmeasBioZ_4wire[3] = SEQ_MMR_WRITE(REG_AFE_AFE_WG_FCW, FCW_MOD);
+    seq_Patch(pSeq, 3, SEQ_MMR_WRITE(REG_AFE_AFE_WG_FCW, FCW_MOD));
     /* Update sine amplitude in the sequence */
-    seq_afe_fast_acmeasBioZ_4wire[4] = SEQ_MMR_WRITE(REG_AFE_AFE_WG_AMPLITUDE, SINE_AMPLITUDE);
+    seq_Patch(pSeq, 4, SEQ_MMR_WRITE(REG_AFE_AFE_WG_AMPLITUDE, SINE_AMPLITUDE));
     
-    /* Recalculate CRC in software for the AC measurement, because we changed   */
-    /* FCW and sine amplitude settings                                          */
-    adi_AFE_EnableSoftwareCRC(hDevice, true);
+    /* Recalculate the CRC once for this frequency, the runs below use the      */
+    /* hardware CRC check                                                       */
+    const uint32_t *const seq = seq_Commit(pSeq);
     
-    int max = 1; // do only 5  runs of each frequency. I am not successfully changing frequency. 
-
-    for (k = 0; k < max ; k++)  
-    {   
-      
-      fixed32_t           magnitude_result[DFT_RESULTS_COUNT / 2 - 1]={0};
-      if (ADI_AFE_SUCCESS != adi_AFE_RunSequence(hDevice, seq, (uint16_t *)dft_results, DFT_RESULTS_COUNT)) 
-      {
-        PRINT("Impedance Measurement FAILED");
-      }         
-      
-      /* Convert DFT results to 1.15 and 1.31 formats.  */
-      convert_dft_results(dft_results, dft_results_q15, dft_results_q31);
-      
-      /* Magnitude calculation */
-      /* Use CMSIS function */
-      arm_cmplx_mag_q31(dft_results_q31, magnitude, DFT_RESULTS_COUNT / 2);
-      
-      /* Calculate final magnitude value, calibrated with RTIA the gain of the instrumenation amplifier */
-      rtiaAndGain = (uint32_t)((RTIA * 1.5) / INST_AMP_GAIN);
-      magnitude_result[0] = calculate_magnitude(magnitude[1], magnitude[0], rtiaAndGain);
-      
-      char                tmp[300] = {0};  
-      sprintf(msg, "%s:", "magnitudes");
-      strcat(msg,stringfrequency);  
-      sprintf_fixed32(tmp, magnitude_result[0]);
-      strcat(msg,tmp);
+    ticks[j] = timestamp_Now();
+    if (ADI_AFE_SUCCESS != adi_AFE_RunSequence(hDevice, seq, (uint16_t *)&dft_results[j * DFT_RESULTS_COUNT], DFT_RESULTS_COUNT)) 
+    {
+      PRINT("Impedance Measurement FAILED");
+    }         
+  }  
+  
+  /* Convert the whole sweep at once, calibrated with RTIA the gain of the instrumenation amplifier */
+  config.rtiaAndGain   = (uint32_t)((RTIA * 1.5) / INST_AMP_GAIN);
+  config.openThreshold = DFT_RESULTS_OPEN_MAX_THR;
+  zconv_Batch(&config, format, dft_results, MULTIFREQUENCY_ARRAY_SIZE, values);
+  
+  // one line per frequency: label:frequency;value[,value], stamped as its measurement started. 
+  for (j = 0; j < MULTIFREQUENCY_ARRAY_SIZE; j++) 
+  {
+    timestamp_prefix(msg, ticks[j]);
+    sprintf(&msg[strlen(msg)], "%s:%s;", value_label(format), stringfreqs[j]);
+    for (i = 0, n = ZCONV_VALUES(format); i < n; i++) {
+      value.full = values[j * n + i];
+      sprintf_fixed32(tmp, value);
+      if (i > 0) {
+        strcat(msg, ",");
+      }
+      strcat(msg, tmp);
     }
-    
     strcat(msg," \r\n");       
     PRINT(msg);
-  }  
+  }
 }
 
 /******************************************************************************
@@ -744,10 +1200,11 @@ void time_series_bipolar(ADI_AFE_DEV_HANDLE  hDevice, const uint32_t *const seq)
       fixed32_t           magnitude_result[DFT_RESULTS_COUNT / 2 - 1]={0};      
       char                msg[MSG_MAXLEN_M1] = {0};
       char                tmp[300] = {0};        
+      uint32_t            tick = timestamp_Now();
       int8_t              i;
           
       /* Perform the Impedance measurement */
-      if (adi_AFE_RunSequence(hDevice, seq_fast_2wire_bipolar, (uint16_t *)dft_results, DFT_RESULTS_COUNT)) 
+      if (adi_AFE_RunSequence(hDevice, seq, (uint16_t *)dft_results, DFT_RESULTS_COUNT)) 
       {
         PRINT("Impedance Measurement");
       }
@@ -764,6 +1221,7 @@ void time_series_bipolar(ADI_AFE_DEV_HANDLE  hDevice, const uint32_t *const seq)
         magnitude_result[i] = calculate_bipolar_magnitude(magnitude[0], magnitude[i + 1]);
       }
       
+      timestamp_prefix(msg, tick);
       sprintf_fixed32(tmp, magnitude_result[0]);
       strcat(msg,tmp);
       strcat(msg," \r\n");       
@@ -771,40 +1229,154 @@ void time_series_bipolar(ADI_AFE_DEV_HANDLE  hDevice, const uint32_t *const seq)
 }
 
 /******************************************************************************
-    Main loop for tetrapolar time series measurements. 
+    Main loop for tetrapolar time series measurements. The sample sequence is 
+    repeated TIMESERIES_STREAM_SAMPLES times in one program, so the samples are 
+    evenly spaced and the sequencer only restarts once per TIMESERIES_STREAM_SAMPLES. 
+    Each half of the Rx DMA ring is printed while the DMA fills the other one. 
+    The stream is not continuous: there is a gap between two programs, while the 
+    last half is printed and the sequencer is stopped, checked and restarted. 
+    Halves overwritten before they were printed are reported as lost samples. 
 
 *****************************************************************************/
 void time_series(ADI_AFE_DEV_HANDLE  hDevice, const uint32_t *const seq) {
   
-    int16_t             dft_results[DFT_RESULTS_COUNT];
-    q15_t               dft_results_q15[DFT_RESULTS_COUNT];
-    q31_t               dft_results_q31[DFT_RESULTS_COUNT];
-    q31_t               magnitude[DFT_RESULTS_COUNT / 2];
-    fixed32_t           magnitude_result[DFT_RESULTS_COUNT / 2 - 1]={0};
-    uint32_t            rtiaAndGain;
+    const uint32_t *const seqs[1] = { seq };
+    const uint32_t*     stream;
+    const int16_t*      pHalf;
+    int16_t             dft_results[TIMESERIES_STREAM_HALF * DFT_RESULTS_COUNT];
+    ADI_AFE_RESULT_TYPE result;
+    bool_t              bFinished = false;
+    uint32_t            start, period, limit, half, i;
+    char                msg[MSG_MAXLEN_M1] = {0};
     
-    /* Calculate final magnitude value, calibrated with RTIA the gain of the instrumenation amplifier */
-    rtiaAndGain = (uint32_t)((RTIA * 1.5) / INST_AMP_GAIN);      
+    // the repeated sequence is patched in place, its CRC only changes with the timing. 
+    seq_BuildBlock(&seqobj_timeseries_stream, seqs, 1, TIMESERIES_STREAM_SAMPLES, 0);
+    stream = seq_Commit(&seqobj_timeseries_stream);
+    // the samples are spaced by the sequencer, in HFOSC cycles, from the start of the program. 
+    period = seq_Cycles(stream) / TIMESERIES_STREAM_SAMPLES;
+    // the waits below give up TIMESERIES_TIMEOUT_US after the expected end of the program. 
+    limit  = seq_Cycles(stream) / TIMESTAMP_CYCLES_PER_TICK + TIMESERIES_TIMEOUT_US;
     
-    char                msg[MSG_MAXLEN_M1] = {0};
-    char                tmp[300] = {0};  
-    if (ADI_AFE_SUCCESS != adi_AFE_RunSequence(hDevice, seq, (uint16_t *)dft_results, DFT_RESULTS_COUNT)) 
+    // one DMA cycle, and one callback, per half of the ring. 
+    rxring_Reset(&timeseries_ring);
+    adi_AFE_RegisterCallbackOnReceiveDMA(hDevice, time_series_rx_callback, 0);
+    adi_AFE_SetDmaRxBufferMaxSize(hDevice, TIMESERIES_STREAM_HALF * DFT_RESULTS_COUNT,
+                                  TIMESERIES_STREAM_HALF * DFT_RESULTS_COUNT);
+    adi_AFE_SetRunSequenceBlockingMode(hDevice, false);
+    
+    start  = timestamp_Now();
+    result = adi_AFE_RunSequence(hDevice, stream, (uint16_t *)timeseries_ring_buffer,
+                                 TIMESERIES_STREAM_SAMPLES * DFT_RESULTS_COUNT);
+    
+    while ((ADI_AFE_SUCCESS == result) &&
+           (timeseries_ring.consumed < (TIMESERIES_STREAM_SAMPLES / TIMESERIES_STREAM_HALF))) {
+      if (ADI_AFE_SUCCESS != (result = adi_AFE_GetSeqError(hDevice))) {
+        break;
+      }
+      if (NULL == (pHalf = rxring_Peek(&timeseries_ring))) {
+        if ((timestamp_Now() - start) > limit) {
+          result = ADI_AFE_ERR_SEQ;
+        }
+        continue;
+      }
+      // copied out first, a half overwritten while it was read is dropped. 
+      memcpy(dft_results, pHalf, sizeof(dft_results));
+      half = timeseries_ring.consumed;
+      if (rxring_Release(&timeseries_ring)) {
+        for (i = 0; i < TIMESERIES_STREAM_HALF; i++) {
+          time_series_sample(&dft_results[i * DFT_RESULTS_COUNT],
+                             start + (half * TIMESERIES_STREAM_HALF + i) * period / TIMESTAMP_CYCLES_PER_TICK);
+        }
+      }
+    }
+    
+    while ((ADI_AFE_SUCCESS == result) && !bFinished) {
+      adi_AFE_GetSeqFinished(hDevice, &bFinished);
+      if (!bFinished && ((timestamp_Now() - start) > limit)) {
+        result = ADI_AFE_ERR_SEQ;
+      }
+    }
+    if (ADI_AFE_SUCCESS == result) {
+      adi_AFE_SetSeqState(hDevice, ADI_AFE_SEQ_STATE_FINISHED);
+      result = adi_AFE_SeqStop(hDevice);
+    }
+    if (ADI_AFE_SUCCESS != result) {
+      adi_AFE_SeqAbort(hDevice);
+    }
+    adi_AFE_SetSeqState(hDevice, ADI_AFE_SEQ_STATE_IDLE);
+    if (ADI_AFE_SUCCESS == result) {
+      result = adi_AFE_SeqCheck(hDevice, stream);
+    }
+    
+    adi_AFE_SetRunSequenceBlockingMode(hDevice, true);
+    adi_AFE_SetDmaRxBufferMaxSize(hDevice, FRAME_RX_DMA_MAX_SIZE, 0);
+    adi_AFE_RegisterCallbackOnReceiveDMA(hDevice, NULL, 0);
+    
+    if (timeseries_ring.lost > 0) 
+    {
+      sprintf(msg, "time series: %u samples lost\n", (unsigned int)(timeseries_ring.lost * TIMESERIES_STREAM_HALF));
+      PRINT(msg);
+    }
+    if (ADI_AFE_SUCCESS != result) 
     {
       PRINT("Impedance Measurement FAILED");
-    }         
+    }
+}
+
+/* Continuous time series: a half of the Rx DMA ring is complete */
+void time_series_rx_callback(void *pCBParam, uint32_t Event, void *pArg) {
+      rxring_Complete(&timeseries_ring);
+}
+
+/* Print one time series sample, or add it to the average, stamped with the tick it was measured at */
+void time_series_sample(int16_t *dft_results, uint32_t tick) {
+  
+    int32_t             values[2];
+    ZCONV_CONFIG        config;
+    fixed32_t           value;
+    uint32_t            i, n;
+    char                msg[MSG_MAXLEN_M3] = {0};
+    char                tmp[MSG_MAXLEN_M1] = {0};  
     
-    /* Convert DFT results to 1.15 and 1.31 formats.  */
-    convert_dft_results(dft_results, dft_results_q15, dft_results_q31);
+    /* Calculate final values, calibrated with RTIA the gain of the instrumenation amplifier */
+    config.rtiaAndGain   = (uint32_t)((RTIA * 1.5) / INST_AMP_GAIN);
+    config.openThreshold = DFT_RESULTS_OPEN_MAX_THR;
     
-    /* Magnitude calculation */
-    /* Use CMSIS function */
-    arm_cmplx_mag_q31(dft_results_q31, magnitude, DFT_RESULTS_COUNT / 2);
+    n = zconv_Batch(&config, (ZCONV_FORMAT_TYPE)value_format[mode], dft_results, 1, values);
     
-    /* Calculate final magnitude value, calibrated with RTIA the gain of the instrumenation amplifier */
-    rtiaAndGain = (uint32_t)((RTIA * 1.5) / INST_AMP_GAIN);
-    magnitude_result[0] = calculate_magnitude(magnitude[1], magnitude[0], rtiaAndGain);
-    sprintf_fixed32(tmp, magnitude_result[0]);
-    strcat(msg,tmp);
+    // averaging: one line every average_frames measurements, mean[;variance], stamped with the first. 
+    if (average_frames > 1) {
+      if ((timeseries_average.frames == 0) || (timeseries_average_key != value_format[mode])) {
+        timeseries_average_tick = tick;
+        average_Wrap(&timeseries_average, 2, (ZCONV_FORMAT_MAG_PHASE == value_format[mode]) ? ZCONV_PHASE_PERIOD : 0);
+      }
+      if (!average_collect(&timeseries_average, &timeseries_average_key, value_format[mode], values, n)) {
+        return;
+      }
+      average_Mean(&timeseries_average, values);
+      tick = timeseries_average_tick;
+    }
+    timestamp_prefix(msg, tick);
+    for (i = 0; i < n; i++) {
+      value.full = values[i];
+      sprintf_fixed32(tmp, value);
+      if (i > 0) {
+        strcat(msg, ",");
+      }
+      strcat(msg,tmp);
+    }
+    if ((average_frames > 1) && average_variance) {
+      average_Variance(&timeseries_average, 4, values);
+      for (i = 0; i < n; i++) {
+        value.full = values[i];
+        sprintf_fixed32(tmp, value);
+        strcat(msg, (i > 0) ? "," : ";");
+        strcat(msg,tmp);
+      }
+    }
+    if (average_frames > 1) {
+      average_Reset(&timeseries_average);
+    }
     strcat(msg," \r\n");       
     PRINT(msg);  
   
@@ -812,152 +1384,916 @@ void time_series(ADI_AFE_DEV_HANDLE  hDevice, const uint32_t *const seq) {
 
 
 /******************************************************************************
-    Main code for the imaging function with 32 electrodes. 
+    Auto-tuning of the DFT windows: the quad is measured repeatedly while the 
+    windows get shorter, until the magnitude spread crosses AUTOTUNE_MAX_CV_PPM. 
   
 *****************************************************************************/
-void multiplex_adg732(ADI_AFE_DEV_HANDLE  hDevice, const uint32_t *const seq,uint32_t n_el) {
+void autotune_timing(void) {
   
-   // int 32 of the sequence, no of measures based on the sequence entered. 
-   // i.e. n_el if 8, 16, 32, we can pick which sequence. 
-   //   32, 192, 896  
-    uint32_t            numberofmeasures;
-    if (n_el == 8) {
-      numberofmeasures = 32;
-    }  
-    else if (n_el == 16) {
-      numberofmeasures = 192;
-    }
-    else if (n_el == 32) {
-      numberofmeasures = 896;
-    }
+    char                msg[MSG_MAXLEN_M3] = {0};
+    SEQ_AUTOTUNE_CONFIG config = { AUTOTUNE_SAMPLES, AUTOTUNE_MAX_CV_PPM };
+    SEQ_AUTOTUNE_RESULT result;
+    SEQ_TIMING*         timing;
+    uint32_t*           seq;
+    
+    if (mode == 1) {
+      timing = &timeseries_timing;
+      seq    = seq_timeseries;
+    }
+    else if ((mode >= 3) && (mode <= 5)) {
+      timing = &imaging_timing;
+      seq    = seq_imaging;
+      // tune on the first quad of the current electrode pattern. 
+      if (mux_select_pattern(mode == 3 ? 8 : (mode == 4 ? 16 : 32)) > 0) {
+        adg732_Apply(mux_plan[0]);
+      }
+    }
     else {
-      numberofmeasures = 928;
+      PRINT("auto-tune is only available in the 4-wire modes\n");
+      return;
+    }
+    
+    if (!seq_AutoTune(timing, &config, autotune_measure, seq, &result)) {
+      PRINT("auto-tune: timing unchanged, spread too large or measurement failed\n");
+      return;
+    }
+    if (timing == &imaging_timing) {
+      // the multi-frequency sequences share the imaging settling and DFT times. 
+      multifreq_build(multifreq_list, multifreq_count);
+      settle_build();
+    }
+    sprintf(msg, "auto-tune: dft %u us, voltage settle %u us, spread %u ppm after %u steps\n",
+            timing->dftTimeUs, timing->voltageSettleUs, result.cvPpm, result.steps);
+    PRINT(msg);
+}
+
+/* Auto-tuning: run a candidate sequence on the current quad and return its magnitude */
+bool_t autotune_measure(const uint32_t *seq, int32_t *pMagnitude) {
+  
+    int16_t             dft_results[DFT_RESULTS_COUNT] = {0};
+    q15_t               dft_results_q15[DFT_RESULTS_COUNT];
+    q31_t               dft_results_q31[DFT_RESULTS_COUNT];
+    q31_t               magnitude[DFT_RESULTS_COUNT / 2];
+    uint32_t            rtiaAndGain = (uint32_t)((RTIA * 1.5) / INST_AMP_GAIN);
+    
+    if (ADI_AFE_SUCCESS != adi_AFE_RunSequence(hDevice, seq, (uint16_t *)dft_results, DFT_RESULTS_COUNT)) 
+    {
+      return false;
+    }
+    convert_dft_results(dft_results, dft_results_q15, dft_results_q31);
+    arm_cmplx_mag_q31(dft_results_q31, magnitude, DFT_RESULTS_COUNT / 2);
+    *pMagnitude = calculate_magnitude(magnitude[1], magnitude[0], rtiaAndGain).full;
+    return true;
+}
+
+/******************************************************************************
+    Main code for the imaging function with 32 electrodes. 
+  
+*****************************************************************************/
+void multiplex_adg732(ADI_AFE_DEV_HANDLE  hDevice, const uint32_t *const *seqs,
+                      const uint32_t *freqs, uint32_t numFreqs, uint32_t n_el) {
+  
+   // no of measures based on the electrode pattern selected by n_el. 
+   // i.e. n_el if 8, 16, 32 opposition, anything else is 32 adjacent. 
+   //   32, 192, 896, 928  
+    uint32_t            numberofmeasures = mux_select_pattern(n_el);
+    if (numberofmeasures == 0) {
       PRINT("number of measures is 0\n");
+      return;
     }
     
-    uint32_t            rtiaAndGain;
     /* Calculate final magnitude value, calibrated with RTIA the gain of the instrumenation amplifier */
-    rtiaAndGain = (uint32_t)((RTIA * 1.5) / INST_AMP_GAIN);
-      
-    char                msg[MSG_MAXLEN_M3] = {0};
-    //sprintf(msg, "GAIN: %u Magnitudes:", rtiaAndGain);     // Now gain is 33132? 
-    sprintf(msg,"magnitudes: ");
-    PRINT(msg);
-    // 
+    mux_rtiaAndGain = (uint32_t)((RTIA * 1.5) / INST_AMP_GAIN);
+    
+    // q31 frames always carry the raw magnitudes, the complex values are 28.4 pairs. 
+    mux_zconv.rtiaAndGain   = mux_rtiaAndGain;
+    mux_zconv.openThreshold = DFT_RESULTS_OPEN_MAX_THR;
+    mux_value_format        = (OUTPUT_BINARY_Q31 == output_format) ? ZCONV_FORMAT_RAW_Q31
+                                                                   : (ZCONV_FORMAT_TYPE)value_format[mode];
+    mux_frame_count         = 0;
+    
+    // reduced plans only measure the quads that are not equal to an earlier one, the host 
+    // expands the frame with the plan sent before it. QA frames measure the full pattern. 
+    mux_reduced = plan_begin();
+    if (mux_reduced) {
+      numberofmeasures = mux_measured_count;
+    }
+    stream_SetReduced(mux_reduced ? 1u : 0u);
+    mux_values              = numberofmeasures * numFreqs * ZCONV_VALUES(mux_value_format);
+    
+    // averaged frames are only sent every average_frames frames, single frequency frames whose raw results 
+    // fit before the accumulator. QA frames are sent as they are, a frame past the accumulator resets it. 
+    mux_averaging = (average_frames > 1) && (numFreqs == 1) && (numberofmeasures * 2 <= AVERAGE_IMAGING_VALUES) &&
+                    ((PLAN_FULL == plan_mode) || mux_reduced);
+    if (numberofmeasures * numFreqs * 2 > AVERAGE_IMAGING_VALUES) {
+      average_Reset(&mux_average);
+    }
+    
+    // a frame is stamped as its measurement starts, an averaged frame as its first frame does. 
+    // the plan, variance and excitation frames carry the stamp of the frame. 
+    mux_stamp = timestamp_Now();
+    if (mux_averaging) {
+      if ((mux_average.frames == 0) || (mux_average_key != (((uint32_t)mode << 8) | mux_value_format))) {
+        mux_average_stamp = mux_stamp;
+        average_Wrap(&mux_average, 2, (ZCONV_FORMAT_MAG_PHASE == mux_value_format) ? ZCONV_PHASE_PERIOD : 0);
+      }
+      mux_stamp = mux_average_stamp;
+    }
+    stream_SetTime(mux_stamp);
+    if (mux_reduced && !mux_plan_sent) {
+      plan_emit(n_el);
+    }
+    if (!mux_averaging) {
+      mux_frame_begin(freqs, numFreqs, n_el, false);
+    }
+    
+    // one frequency: the quads sharing an injection pair are measured in turn, and the quads 
+    // that only move the sense muxes settle for a shorter time. the values keep the pattern order. 
+    mux_settle = mux_grouped && (numFreqs == 1) && (seqs[0] == seq_imaging);
+    if (mux_settle && (mux_order_key != (((uint32_t)mux_reduced << 16) | numberofmeasures))) {
+      mux_order_key = ((uint32_t)mux_reduced << 16) | numberofmeasures;
+      pattern_Order(mux_plan, mux_reduced ? mux_measured : NULL, numberofmeasures, mux_order);
+    }
+    
+    // ranged quads run a copy of their first sequence led by their amplitude. the levels 
+    // learned from the previous frame are used from the next output frame, so an average 
+    // is measured with one set of levels. 
+    if (mux_ranging) {
+      if (mux_range_key != (((uint32_t)mode << 16) | mux_plan_count)) {
+        mux_range_key = ((uint32_t)mode << 16) | mux_plan_count;
+        ranging_Reset(&mux_range, mux_plan_count);
+      }
+      if (!mux_averaging || (mux_average.frames == 0)) {
+        ranging_Begin(&mux_range);
+      }
+    }
+    if (mux_ranging || mux_settle) {
+      mux_quad_build(seqs, numFreqs);
+      seqs = seq_quad_list[MUX_SETTLE_FULL][0];
+    }
+    
     // NUMBEROFMEASURES is determined by which electrode configuration: 8,16 or 32. 
-    for (uint32_t econf = 0;econf<numberofmeasures;econf++) {    
-                
-      char                tmp[300] = {0};      
-      q31_t               dft_results_q31[DFT_RESULTS_COUNT]      = {0};
-      q15_t               dft_results_q15[DFT_RESULTS_COUNT]      = {0};
-      q31_t               temp_magnitude[DFT_RESULTS_COUNT/2]     = {0};
-      int16_t             temp_dft_results[DFT_RESULTS_COUNT]     = {0};
-      fixed32_t           magnitude_result[DFT_RESULTS_COUNT/2-1] = {0};
+    // The frame engine switches the muxes and captures the previous result 
+    // while the sequencer is measuring the current quad, or block of quads. 
+    FRAME_ENGINE_CONFIG frame = {
+      hDevice, seqs, numFreqs, DFT_RESULTS_COUNT, numberofmeasures,
+      mux_prepare_quad, mux_apply_quad, mux_emit_quad,
+      mux_block_quads, mux_switch_quad,
+      (mux_ranging || mux_settle) ? mux_quad_seqs : NULL
+    };
+    
+    if (ADI_AFE_SUCCESS != frame_Run(&frame)) 
+    {
+      if (OUTPUT_ASCII == output_format) {
+        PRINT("FAILED Impedance Measurement");
+      }
+    }
+    if (mux_ranging) {
+      adi_AFE_RunSequence(hDevice, seq_Commit(&seqobj_range_restore), NULL, 0);
+    }
+    // the whole frame, or what is left of a frame larger than the buffer. 
+    if (mux_frame_count > 0) {
+      mux_emit_frame();
+    }
+    
+    if (mux_averaging) {
+      if (mux_average.frames < average_frames) {
+        return;
+      }
+      // the mean, then the variance, in place of the frame buffer values. 
+      mux_frame_begin(freqs, numFreqs, n_el, false);
+      BENCH_MARK();
+      average_Mean(&mux_average, mux_frame);
+      BENCH_STAGE(BENCH_STAGE_AVERAGE);
+      mux_put_values(mux_frame, mux_values);
+      if (average_variance) {
+        mux_frame_end();
+        mux_frame_begin(freqs, numFreqs, n_el, true);
+        BENCH_MARK();
+        average_Variance(&mux_average, (ZCONV_FORMAT_RAW_Q31 == mux_value_format) ? 31 : 4, mux_frame);
+        BENCH_STAGE(BENCH_STAGE_AVERAGE);
+        mux_put_values(mux_frame, mux_values);
+      }
+      average_Reset(&mux_average);
+    }
+    
+    mux_frame_end();
+    if (mux_ranging) {
+      range_emit(n_el, freqs[0]);
+    }
+    // a QA frame checks the plan on the whole frame, then the plan is sent again. 
+    if ((PLAN_FULL != plan_mode) && !mux_reduced) {
+      if ((OUTPUT_ASCII == output_format) && (numberofmeasures * numFreqs <= MUX_FRAME_CAPACITY)) {
+        plan_check(numFreqs);
+      }
+      mux_plan_sent = false;
+    }
+}
+
+/* Build one 4-wire sequence per frequency, with the imaging settling and DFT times */
+void multifreq_build(const uint32_t *freqs, uint32_t numFreqs) {
+  
+      SEQ_TIMING          timing = imaging_timing;
       
-      // This is where we select the electrode sequence. i.e. 8,16 or 32 adjacent or opposition.  
-      int16_t* e;
+      if (numFreqs > MULTIFREQ_EIT_MAX_COUNT) {
+        numFreqs = MULTIFREQ_EIT_MAX_COUNT;
+      }
+      for (multifreq_count = 0; multifreq_count < numFreqs; multifreq_count++) {
+        multifreq_list[multifreq_count] = freqs[multifreq_count];
+        timing.frequency = freqs[multifreq_count];
+        seq_Build4WireFreq(&timing, seq_multifreq[multifreq_count], SEQ_4WIRE_FREQ_LENGTH);
+        seq_multifreq_list[multifreq_count] = seq_multifreq[multifreq_count];
+      }
+}
+
+/* Compile the electrode pattern of n_el into mux_plan, returns the number of quads */
+uint32_t mux_select_pattern(uint32_t n_el) {
+  
+      // This is where we select the electrode sequence. i.e. 8,16 or 32 opposition, the plan arrays hold no larger one.  
+      const PATTERN_CONFIG* p;
       if (n_el == 8) {
-        e = (int16_t *)electrode_configuration_8_opposition[econf];
+        p = &pattern_8_opposition;
       }  
       else if (n_el == 16) {
-        e = (int16_t *)electrode_configuration_16_opposition[econf];
-      }
-      else if (n_el == 32) {
-        e = (int16_t *)electrode_configuration_32_opposition[econf];
+        p = &pattern_16_opposition;
       }
       else {
-        e = (int16_t *)electrode_configuration_32_adjacent[econf];
+        p = &pattern_32_opposition;
       }
       
-      // M1,M2,M3,M4 = 1,2,4,5 
-      // U4, A-, m1, position 3
-      // U2, V-, m2, position 2 
-      // U1, A+. m3, position 1
-      // U5, V+, m4, position 4
-      // 
-      // e_conf file is written as A+,A-,V+,V-
-      // I've mapped them like this so the e_conf file matches the 
-      // multiplexer assignement i.e. A+ -> A+ etc. 
-      int16_t* mx1_assignment = (int16_t *)truth_table[e[1]];  // A- -> 
-      int16_t* mx2_assignment = (int16_t *)truth_table[e[3]];  // V- ->  
-      int16_t* mx3_assignment = (int16_t *)truth_table[e[0]];  // A+ -> 
-      int16_t* mx4_assignment = (int16_t *)truth_table[e[2]];  // V+ ->   
-        
-      PinMap m1_portpin;  
-      PinMap m2_portpin;  
-      PinMap m3_portpin;  
-      PinMap m4_portpin;      
-      // A4 A3 A2 A1 A0
-      for (int i=0;i<5;i++) {   
-        m1_portpin = m1_configuration[i]; // first one is a4,a3,a2,a1,a0. 
-        m2_portpin = m2_configuration[i]; // second one is        
-        m3_portpin = m3_configuration[i]; // third one is          
-        m4_portpin = m4_configuration[i]; // fourth one is 
-        // set the port pins on each multiplexer. 
-        if (mx1_assignment[i] > 0) { 
-          adi_GPIO_SetHigh(m1_portpin.Port, m1_portpin.Pins);
+      // The plan is only recompiled when the pattern changes. 
+      if ((mux_plan_count == 0) || (memcmp(p, &mux_plan_config, sizeof(PATTERN_CONFIG)) != 0)) {
+        mux_plan_config = *p;
+        mux_plan_count  = pattern_Compile(p, mux_plan, MUX_MAX_QUADS);
+        // the reduced plan and the measurement order follow the pattern. 
+        mux_measured_count = 0;
+        mux_order_key      = 0;
+      }
+      return mux_plan_count;
+}
+
+/* Compare the cost of switching the multiplexers pin by pin and with port masks */
+void mux_benchmark(void) {
+  
+      char                msg[MSG_MAXLEN_M3] = {0};
+      ADG732_BENCHMARK    bench;
+      uint32_t            count = mux_select_pattern(32);
+      
+      if (ADI_METRIC_SUCCESS != adg732_Benchmark(mux_plan, count, &bench)) {
+        PRINT("mux benchmark failed\n");
+        return;
+      }
+      sprintf(msg, "mux switch cycles over %u switches: pins %u (%u per switch), masks %u (%u per switch)\n",
+              bench.switches, bench.pinCycles, bench.pinCycles / bench.switches,
+              bench.maskCycles, bench.maskCycles / bench.switches);
+      PRINT(msg);
+}
+
+/* Measure one frame of the current imaging mode */
+void imaging_frame(void) {
+  
+    if (mode == 3) {  // 8 electrode imaging
+      /* Perform the multiplex adg732 Tetrapolar Impedance measurements */
+      multiplex_adg732(hDevice, seq_imaging_list, &imaging_timing.frequency, 1, 8);
+    }
+    else if (mode == 4) {  // 16 electrode imaging
+      multiplex_adg732(hDevice, seq_imaging_list, &imaging_timing.frequency, 1, 16);
+    }    
+    else if (mode == 5) {  // 32 electrode imaging
+      multiplex_adg732(hDevice, seq_imaging_list, &imaging_timing.frequency, 1, 32);
+    }    
+    else if (mode == 8) {  // multi-frequency imaging
+      /* Every quad is measured at all the frequencies before the muxes switch */
+      multiplex_adg732(hDevice, seq_multifreq_list, multifreq_list, multifreq_count, MULTIFREQ_EIT_ELECTRODES);
+    }    
+}
+
+/* Time the stages of BENCH_FRAMES frames of the current imaging mode, in HFOSC cycles */
+void frame_benchmark(void) {
+  
+      char                msg[MSG_MAXLEN_M3] = {0};
+      BENCH_RESULT        result;
+      FRAME_ENGINE_STATS  frameStats;
+      const BENCH_STAGE_STATS *pStats;
+      uint32_t            i;
+      
+      if (!(((mode >= 3) && (mode <= 5)) || (mode == 8))) {
+        PRINT("benchmark is only available in the imaging modes\n");
+        return;
+      }
+      if (ADI_METRIC_SUCCESS != bench_Begin()) {
+        PRINT("benchmark failed\n");
+        return;
+      }
+      for (i = 0; i < BENCH_FRAMES; i++) {
+        bench_FrameBegin();
+        imaging_frame();
+        bench_FrameEnd();
+      }
+      bench_End(&result);
+      frame_GetStats(&frameStats);
+      
+      // one CSV line per stage between the begin and end lines, the means are per frame. 
+      sprintf(msg, "bench begin mode=%d format=%u frames=%u quads=%u block=%u clock=%u overhead=%u\n",
+              mode, output_format, result.frames, mux_plan_count, frameStats.blockQuads, SEQ_CLOCK_HZ, result.overhead);
+      PRINT(msg);
+      PRINT("stage,calls,min,mean,max\n");
+      for (i = 0; i <= BENCH_STAGE_COUNT; i++) {
+        pStats = (i < BENCH_STAGE_COUNT) ? &result.stages[i] : &result.frame;
+        sprintf(msg, "%s,%u,%u,%u,%u\n", (i < BENCH_STAGE_COUNT) ? bench_StageName((BENCH_STAGE_TYPE)i) : "frame",
+                pStats->calls, pStats->min, (uint32_t)(pStats->sum / result.frames), pStats->max);
+        PRINT(msg);
+      }
+      PRINT("bench end\n");
+}
+
+/* Frame engine: fetch the precompiled mux word of a quad */
+void mux_prepare_quad(uint32_t econf) {
+      mux_word = mux_plan[mux_plan_index(econf)];
+}
+
+/* Frame engine: set the port pins on each multiplexer for the prepared quad */
+void mux_apply_quad(uint32_t econf) {
+      // At most one write per GPIO port for all 4 multiplexers. 
+      BENCH_MARK();
+      adg732_Apply(mux_word);
+      BENCH_STAGE(BENCH_STAGE_MUX);
+}
+
+/* Frame engine, block mode: switch the muxes from the Rx DMA interrupt, outside of the benchmark stages */
+void mux_switch_quad(uint32_t econf) {
+      adg732_Apply(mux_plan[mux_plan_index(econf)]);
+}
+
+/* Place in the frame of the frame engine quad econf */
+uint32_t mux_slot(uint32_t econf) {
+      return mux_settle ? mux_order[econf] : econf;
+}
+
+/* Quad of the pattern measured by the frame engine quad econf */
+uint32_t mux_plan_index(uint32_t econf) {
+      return mux_reduced ? mux_measured[mux_slot(econf)] : mux_slot(econf);
+}
+
+/* Quad of the pattern whose measurement gives the value of a quad of the pattern */
+uint32_t mux_plan_source(uint32_t quad) {
+      return mux_reduced ? mux_measured[PATTERN_PLAN_QUAD(mux_reduced_plan[quad])] : quad;
+}
+
+/* Frame engine: capture the DFT results of a measured quad into the frame buffer */
+void mux_emit_quad(uint32_t econf, uint32_t freq, int16_t *dft_results) {
+  
+      // grouped quads go back to their place in the frame, a single frequency frame fits the buffer. 
+      BENCH_MARK();
+      memcpy(&mux_frame[(mux_settle ? mux_slot(econf) : mux_frame_count) * 2], dft_results, ZCONV_DFT_COUNT * sizeof(int16_t));
+      BENCH_STAGE(BENCH_STAGE_CAPTURE);
+      // the level of the next frame, once all the frequencies of the quad are in. 
+      if (mux_ranging) {
+        ranging_Observe(&mux_range, mux_plan_index(econf), dft_results, ZCONV_DFT_COUNT);
+        if (freq + 1 == mux_range_seqs) {
+          ranging_Learn(&mux_range);
         }
-        else {
-          adi_GPIO_SetLow(m1_portpin.Port, m1_portpin.Pins);
+      }
+      // a frame larger than the buffer is converted in parts. 
+      if (++mux_frame_count == MUX_FRAME_CAPACITY) {
+        mux_emit_frame();
+      }
+}
+
+/* Convert the frame buffer in place, then print or stream its values or add them to the average */
+void mux_emit_frame(void) {
+  
+      uint32_t            count;
+      
+      // thresholding, q15 to q31, magnitudes and the RTIA ratio in one pass. 
+      BENCH_MARK();
+      count = zconv_Batch(&mux_zconv, mux_value_format, (int16_t *)mux_frame, mux_frame_count, mux_frame);
+      mux_frame_count = 0;
+      BENCH_STAGE(BENCH_STAGE_BATCH);
+      
+      if (mux_averaging) {
+        BENCH_MARK();
+        average_collect(&mux_average, &mux_average_key, ((uint32_t)mode << 8) | mux_value_format, mux_frame, count);
+        BENCH_STAGE(BENCH_STAGE_AVERAGE);
+        return;
+      }
+      mux_put_values(mux_frame, count);
+}
+
+/* Print or stream imaging values */
+void mux_put_values(const int32_t *pValues, uint32_t count) {
+  
+      char                msg[MSG_MAXLEN_M3] = {0};
+      char                tmp[MSG_MAXLEN_M1] = {0};
+      fixed32_t           value;
+      uint32_t            length, i;
+      
+      // binary frames are packed, or delta coded, and queued by eit_stream, timed as UART output. 
+      if (OUTPUT_ASCII != output_format) {
+        BENCH_MARK();
+        stream_FrameValues(pValues, (uint16_t)count);
+        BENCH_STAGE(BENCH_STAGE_UART_TX);
+        return;
+      }
+      
+      // the values are printed a line buffer at a time. 
+      length = 0;
+      for (i = 0; i < count; i++) {
+        BENCH_MARK();
+        value.full = pValues[i];
+        sprintf_fixed32(tmp, value);
+        strcat(tmp,",");
+        strcpy(&msg[length], tmp);
+        length += strlen(tmp);
+        BENCH_STAGE(BENCH_STAGE_FORMAT);
+        if ((length + MSG_MAXLEN_M1 > MSG_MAXLEN_M3) || (i + 1 == count)) {
+          BENCH_MARK();
+          mux_print(msg);
+          BENCH_STAGE(BENCH_STAGE_UART_TX);
+          length = 0;
         }
-        if (mx2_assignment[i] > 0) {
-          adi_GPIO_SetHigh(m2_portpin.Port,m2_portpin.Pins);
+      }
+}
+
+/* Start an imaging frame: ASCII label or binary frame header, of the values or of their variances */
+void mux_frame_begin(const uint32_t *freqs, uint32_t numFreqs, uint32_t n_el, bool_t variance) {
+  
+      char                msg[MSG_MAXLEN_M3] = {0};
+      char                tmp[MSG_MAXLEN_M1] = {0};
+      STREAM_FORMAT_TYPE  format = STREAM_FORMAT_Q31;
+      uint32_t            i;
+      
+      if (OUTPUT_ASCII == output_format) {
+        timestamp_prefix(msg, mux_stamp);
+        sprintf(&msg[strlen(msg)], "%s%s%s", variance ? "variance_" : "", mux_reduced ? "reduced_" : "",
+                value_label(mux_value_format));
+        // multi-frequency: the frequencies, then all the frequencies of each quad in turn. 
+        for (i = 0; (numFreqs > 1) && (i < numFreqs); i++) {
+          sprintf(tmp, "%c%u", (i == 0) ? '@' : ',', freqs[i]);
+          strcat(msg, tmp);
         }
-        else {
-          adi_GPIO_SetLow(m2_portpin.Port,m2_portpin.Pins);  
+        strcat(msg, ": ");
+        mux_print(msg);
+        return;
+      }
+      
+      if (OUTPUT_BINARY_FIXED32 == output_format) {
+        format = (ZCONV_FORMAT_MAG_PHASE == mux_value_format) ? STREAM_FORMAT_MAG_PHASE :
+                 ((ZCONV_FORMAT_REAL_IMAG == mux_value_format) ? STREAM_FORMAT_REAL_IMAG : STREAM_FORMAT_FIXED32);
+      }
+      /* q31 frames carry both the current and the voltage magnitude of every quad */
+      if (variance) {
+        stream_FrameBeginVariance((uint8_t)mode, (uint8_t)n_el, format, (uint16_t)mux_values, freqs[0]);
+      }
+      else if (numFreqs > 1) {
+        stream_FrameBeginMulti((uint8_t)mode, (uint8_t)n_el, format, (uint16_t)mux_values, freqs, (uint8_t)numFreqs);
+      }
+      else {
+        stream_FrameBegin((uint8_t)mode, (uint8_t)n_el, format, (uint16_t)mux_values, freqs[0]);
+      }
+}
+
+/* End an imaging frame: ASCII line end or binary frame CRC */
+void mux_frame_end(void) {
+  
+      BENCH_MARK();
+      if (OUTPUT_ASCII == output_format) {
+        mux_print("\r\n"); 
+      }
+      else {
+        stream_FrameEnd();
+      }
+      BENCH_STAGE(BENCH_STAGE_UART_TX);
+}
+
+/* Queue ASCII output of a frame, it drains while the next quads are measured */
+void mux_print(char *pBuffer) {
+  
+      PRINT(pBuffer);
+}
+
+/* Select the impedance values of the current mode, false if it only has magnitudes */
+bool_t value_select(ZCONV_FORMAT_TYPE format) {
+  
+      char                msg[MSG_MAXLEN_M1] = {0};
+      
+      if ((mode <= 0) || (mode >= VALUE_FORMAT_MODES) || (mode == 6) || (mode == 7)) {
+        PRINT("complex values are not available in this mode\n");
+        return false;
+      }
+      // a repeated command only reports a change. 
+      if (value_format[mode] != (uint8_t)format) {
+        value_format[mode] = (uint8_t)format;
+        sprintf(msg, "mode %d: %s\n", mode, value_label(format));
+        PRINT(msg);
+      }
+      return true;
+}
+
+/* Label printed before the ASCII values */
+const char* value_label(ZCONV_FORMAT_TYPE format) {
+  
+      if (ZCONV_FORMAT_MAG_PHASE == format) {
+        return "magnitude_phase";
+      }
+      if (ZCONV_FORMAT_REAL_IMAG == format) {
+        return "real_imag";
+      }
+      return "magnitudes";
+}
+
+/* Set the number of frames averaged per output and the variance output */
+void average_select(uint32_t frames, bool_t variance) {
+  
+      char                msg[MSG_MAXLEN_M1] = {0};
+      
+      // a repeated command only acts on a change. 
+      if ((frames == average_frames) && (variance == average_variance)) {
+        return;
+      }
+      average_frames   = frames;
+      average_variance = variance;
+      average_Reset(&mux_average);
+      average_Reset(&timeseries_average);
+      sprintf(msg, "average %u frames, variance %s\n", average_frames, average_variance ? "on" : "off");
+      PRINT(msg);
+}
+
+/* Select the quads per sequencer program of the imaging modes, 0 for one quad per sequence */
+void block_select(uint32_t quads) {
+  
+      char                msg[MSG_MAXLEN_M1] = {0};
+      
+      // a repeated command only acts on a change. 
+      if (quads == mux_block_quads) {
+        return;
+      }
+      mux_block_quads = quads;
+      if (quads > 0) {
+        sprintf(msg, "long sequences on, %u quads per sequence\n", quads);
+      }
+      else {
+        sprintf(msg, "long sequences off\n");
+      }
+      PRINT(msg);
+}
+
+/* Turn the excitation ranging of the imaging modes on or off */
+void range_select(bool_t enable) {
+  
+      // a repeated command only acts on a change. 
+      if (enable == mux_ranging) {
+        return;
+      }
+      mux_ranging   = enable;
+      mux_range_key = 0;
+      // averages of ranged and unranged raw values do not mix. 
+      average_Reset(&mux_average);
+      PRINT(enable ? "excitation ranging on\n" : "excitation ranging off\n");
+}
+
+/* Build the sequences a quad can run, by settling and excitation level */
+void mux_quad_build(const uint32_t *const *seqs, uint32_t numSeqs) {
+  
+      const uint32_t     *first;
+      uint32_t            settle, level, i;
+      
+      for (settle = 0; settle < (mux_settle ? MUX_SETTLE_KINDS : 1); settle++) {
+        first = (MUX_SETTLE_SENSE == settle) ? seq_imaging_sense : seqs[0];
+        for (level = 0; level < RANGING_LEVELS; level++) {
+          // ranged copies are led by their amplitude, unchanged copies are patched in place and keep their CRC. 
+          if (mux_ranging) {
+            seq_BuildPrefix(&seqobj_range[settle][level],
+                            SEQ_MMR_WRITE(REG_AFE_AFE_WG_AMPLITUDE, ranging_Amplitude(SINE_AMPLITUDE, level)), first);
+            seq_quad_list[settle][level][0] = seq_Commit(&seqobj_range[settle][level]);
+          }
+          else {
+            seq_quad_list[settle][level][0] = first;
+          }
+          for (i = 1; i < numSeqs; i++) {
+            seq_quad_list[settle][level][i] = seqs[i];
+          }
         }
-        if (mx3_assignment[i] > 0) {
-          adi_GPIO_SetHigh(m3_portpin.Port,m3_portpin.Pins);
+      }
+      mux_range_seqs = numSeqs;
+}
+
+/* Frame engine: the sequences of a quad, by the muxes it moves and its excitation level */
+const uint32_t *const *mux_quad_seqs(uint32_t econf) {
+  
+      uint32_t            settle = MUX_SETTLE_FULL;
+      
+      // the first quad of a frame follows the last one of the previous frame. 
+      if (mux_settle && (econf > 0) &&
+          (PATTERN_INJECTION(mux_plan[mux_plan_index(econf)]) == PATTERN_INJECTION(mux_plan[mux_plan_index(econf - 1)]))) {
+        settle = MUX_SETTLE_SENSE;
+      }
+      return seq_quad_list[settle][mux_ranging ? ranging_Level(&mux_range, mux_plan_index(econf)) : 0];
+}
+
+/* Group the quads by injection pair, with the shorter settling of the sense-only quads, or not */
+void settle_select(bool_t enable) {
+  
+      char                msg[MSG_MAXLEN_M1] = {0};
+      
+      // a repeated command only acts on a change. 
+      if (enable == mux_grouped) {
+        return;
+      }
+      mux_grouped = enable;
+      if (enable) {
+        sprintf(msg, "grouped injection on, sense settling %u us\n", IMAGING_SENSE_SETTLE_US);
+      }
+      else {
+        sprintf(msg, "grouped injection off\n");
+      }
+      PRINT(msg);
+}
+
+/* Send the binary frames as residuals against the previous frame, or whole */
+void delta_select(bool_t enable) {
+  
+      char                msg[MSG_MAXLEN_M1] = {0};
+      
+      // a repeated command only acts on a change. 
+      if (enable == delta_frames) {
+        return;
+      }
+      delta_frames = enable;
+      if (enable) {
+        stream_SetDelta(delta_reference, DELTA_MAX_VALUES, DELTA_KEY_FRAMES);
+        sprintf(msg, "delta frames on, key frame every %u frames\n", DELTA_KEY_FRAMES);
+      }
+      else {
+        stream_SetDelta(NULL, 0, 0);
+        sprintf(msg, "delta frames off\n");
+      }
+      PRINT(msg);
+}
+
+/* Stamp the records with the microsecond tick at the start of their acquisition, or not */
+void timestamp_select(bool_t enable) {
+  
+      char                msg[MSG_MAXLEN_M1] = {0};
+      
+      // a repeated command only acts on a change. 
+      if (enable == timestamps) {
+        return;
+      }
+      timestamps = enable;
+      stream_SetTimestamps(enable ? TIME_KEY_RECORDS : 0);
+      stream_TimeInit(&time_coder, enable ? TIME_KEY_RECORDS : 0);
+      if (enable) {
+        sprintf(msg, "timestamps on, whole tick every %u records\n", TIME_KEY_RECORDS);
+      }
+      else {
+        sprintf(msg, "timestamps off\n");
+      }
+      PRINT(msg);
+}
+
+/* Timestamp of an ASCII record, "t=tick;" or "t+d;" / "t-d;" against the previous record, */
+/* empty with timestamps off                                                                 */
+void timestamp_prefix(char *pOut, uint32_t tick) {
+  
+      int32_t             delta;
+      
+      if (!timestamps) {
+        pOut[0] = 0;
+      }
+      else if (stream_TimeCode(&time_coder, tick, &delta)) {
+        sprintf(pOut, "t=%lu;", (unsigned long)tick);
+      }
+      else if (delta < 0) {
+        sprintf(pOut, "t-%lu;", (unsigned long)(0u - (uint32_t)delta));
+      }
+      else {
+        sprintf(pOut, "t+%lu;", (unsigned long)delta);
+      }
+}
+
+/* Set the excitation of the single frequency 4-wire modes, false if out of range: the DFT windows */
+/* must hold SEQ_AUTOTUNE_MIN_PERIODS periods, as the auto-tuning keeps them                        */
+bool_t frequency_select(uint32_t frequency) {
+  
+      char                msg[MSG_MAXLEN_M1] = {0};
+      uint32_t            dftTimeUs = imaging_timing.dftTimeUs;
+      
+      if (timeseries_timing.dftTimeUs < dftTimeUs) {
+        dftTimeUs = timeseries_timing.dftTimeUs;
+      }
+      if ((frequency > FREQ_MAX_HZ) ||
+          ((uint64_t)frequency * dftTimeUs < (uint64_t)SEQ_AUTOTUNE_MIN_PERIODS * 1000000u)) {
+        return false;
+      }
+      // a repeated command only acts on a change. 
+      if (frequency == imaging_timing.frequency) {
+        return true;
+      }
+      imaging_timing.frequency    = frequency;
+      timeseries_timing.frequency = frequency;
+      seq_Build4Wire(&timeseries_timing, seq_timeseries, SEQ_4WIRE_LENGTH);
+      seq_Build4Wire(&imaging_timing, seq_imaging, SEQ_4WIRE_LENGTH);
+      settle_build();
+      average_Reset(&mux_average);
+      average_Reset(&timeseries_average);
+      
+      // a running 4-wire mode changes now, the others at the next switch into one. 
+      mode_switch(mode);
+      sprintf(msg, "excitation %u Hz\n", frequency);
+      PRINT(msg);
+      return true;
+}
+
+/* Build the imaging sequence of the quads that only move the sense muxes */
+void settle_build(void) {
+  
+      SEQ_TIMING          timing = imaging_timing;
+      
+      if (timing.currentSettleUs > IMAGING_SENSE_SETTLE_US) {
+        timing.currentSettleUs = IMAGING_SENSE_SETTLE_US;
+      }
+      seq_Build4Wire(&timing, seq_imaging_sense, SEQ_4WIRE_LENGTH);
+}
+
+/* Send the excitation amplitude of every quad of the frame, in DAC codes, for the host to scale raw values; */
+/* the quads of a reduced frame get the amplitude of the quad they are taken from                          */
+void range_emit(uint32_t n_el, uint32_t frequency) {
+  
+      char                msg[MSG_MAXLEN_M3] = {0};
+      char                tmp[MSG_MAXLEN_M1] = {0};
+      uint32_t            length, i, amplitude;
+      
+      if (OUTPUT_ASCII != output_format) {
+        stream_FrameBeginExcitation((uint8_t)mode, (uint8_t)n_el, (uint16_t)mux_range.count, frequency);
+        for (i = 0; i < mux_range.count; i++) {
+          stream_FramePut((int32_t)ranging_Amplitude(SINE_AMPLITUDE, ranging_Level(&mux_range, mux_plan_source(i))));
         }
-        else {
-          adi_GPIO_SetLow(m3_portpin.Port,m3_portpin.Pins);
-        }        
-        if (mx4_assignment[i] > 0) {
-          adi_GPIO_SetHigh(m4_portpin.Port,m4_portpin.Pins);
+        stream_FrameEnd();
+        return;
+      }
+      
+      strcpy(msg, "excitation: ");
+      length = strlen(msg);
+      for (i = 0; i < mux_range.count; i++) {
+        amplitude = ranging_Amplitude(SINE_AMPLITUDE, ranging_Level(&mux_range, mux_plan_source(i)));
+        sprintf(tmp, "%u,", amplitude);
+        strcpy(&msg[length], tmp);
+        length += strlen(tmp);
+        if ((length + MSG_MAXLEN_M1 > MSG_MAXLEN_M3) || (i + 1 == mux_range.count)) {
+          mux_print(msg);
+          length = 0;
         }
-        else {
-          adi_GPIO_SetLow(m4_portpin.Port,m4_portpin.Pins);
-        }      
-      }  // end of for loop for setting multiplexers. 
+      }
+      mux_print("\r\n");
+}
+
+/* Select the full pattern, the reduced plan, or the reduced plan checked by QA frames */
+void plan_select(uint32_t planMode) {
+  
+      char                msg[MSG_MAXLEN_M1] = {0};
       
-      // Now the multiplexers are set, take a measurement. 
-      // Get a measurement:  
-      // 1. calibrate (only the first time) 
-      // 2. sequence enable
-      // 3. take measurement. 
-      // 4. sequence disable
-      // 5. put result into new results table
-      // adi_AFE_EnableSoftwareCRC(hDevice, true);
-      /* Perform the Impedance measurement */      
+      // a repeated command only acts on a change. 
+      if (planMode == plan_mode) {
+        return;
+      }
+      plan_mode     = planMode;
+      plan_frames   = 0;
+      mux_plan_sent = false;
+      average_Reset(&mux_average);
+      if (PLAN_REDUCED_QA == planMode) {
+        sprintf(msg, "reduced plan on, full QA frame every %u frames\n", PLAN_QA_FRAMES);
+        PRINT(msg);
+      }
+      else {
+        PRINT((PLAN_REDUCED == planMode) ? "reduced plan on\n" : "reduced plan off\n");
+      }
+}
+
+/* Reduce the plan of a new pattern, true when the next frame measures the reduced plan */
+bool_t plan_begin(void) {
+  
+      if (PLAN_FULL == plan_mode) {
+        return false;
+      }
+      // quadratic in the measured quads, only once per pattern. 
+      if (0 == mux_measured_count) {
+        mux_measured_count = pattern_Reduce(mux_plan, mux_plan_count, mux_measured, mux_reduced_plan);
+        mux_plan_sent      = false;
+      }
+      // the first frame, then one in PLAN_QA_FRAMES, measures the full pattern. 
+      if (PLAN_REDUCED_QA == plan_mode) {
+        return ((plan_frames++ % PLAN_QA_FRAMES) != 0) ? true : false;
+      }
+      return true;
+}
+
+/* Send the plan entry of every quad of the pattern, for the host to expand the reduced frames */
+void plan_emit(uint32_t n_el) {
+  
+      char                msg[MSG_MAXLEN_M3] = {0};
+      char                tmp[MSG_MAXLEN_M1] = {0};
+      uint32_t            length, i;
       
-      if (ADI_AFE_SUCCESS != adi_AFE_RunSequence(hDevice, seq, (uint16_t *)temp_dft_results, DFT_RESULTS_COUNT)) 
-      {
-        PRINT("FAILED Impedance Measurement");
-      }   
-                     
-      convert_dft_results(temp_dft_results, dft_results_q15, dft_results_q31);
-      /* Magnitude calculation */
-      //arm_cmplx_mag_q31(dft_results_q31, temp_magnitude, 2);
-            /* Magnitude calculation */
-      /* Use CMSIS function */
-      arm_cmplx_mag_q31(dft_results_q31, temp_magnitude, DFT_RESULTS_COUNT / 2);
+      mux_plan_sent = true;
+      if (OUTPUT_ASCII != output_format) {
+        stream_FrameBeginPlan((uint8_t)mode, (uint8_t)n_el, (uint16_t)mux_plan_count, (uint16_t)mux_measured_count);
+        for (i = 0; i < mux_plan_count; i++) {
+          stream_FramePut((int32_t)mux_reduced_plan[i]);
+        }
+        stream_FrameEnd();
+        return;
+      }
       
-      // magnitude = magnitude_1 / magnitude_2 * res  ,
-      magnitude_result[0] = calculate_magnitude(temp_magnitude[1], temp_magnitude[0], rtiaAndGain);
+      strcpy(msg, "plan: ");
+      length = strlen(msg);
+      for (i = 0; i < mux_plan_count; i++) {
+        sprintf(tmp, "%d,", mux_reduced_plan[i]);
+        strcpy(&msg[length], tmp);
+        length += strlen(tmp);
+        if ((length + MSG_MAXLEN_M1 > MSG_MAXLEN_M3) || (i + 1 == mux_plan_count)) {
+          mux_print(msg);
+          length = 0;
+        }
+      }
+      mux_print("\r\n");
+}
+
+/* QA frame: relative difference between the values the reduced plan takes as equal, max and mean in ppm */
+void plan_check(uint32_t numFreqs) {
+  
+      char                msg[MSG_MAXLEN_M1] = {0};
+      uint32_t            perQuad = numFreqs * ZCONV_VALUES(mux_value_format);
+      uint32_t            maxPpm = 0, checks = 0;
+      uint64_t            sumPpm = 0;
+      uint32_t            quad, f, ppm;
+      const int32_t      *pRef, *pValue;
+      int64_t             sign, re, im;
+      uint64_t            vi, iv;
       
-      /* Print DFT complex results to console 983039, 0 on my board, and  when it works magnitude is 74333772, 274209844) */     
-      //sprintf(tmp, "   magnitudes     = (%u, %u)\r\n", temp_magnitude[0], temp_magnitude[1]);
-      //strcat(msg,tmp);
-        
-      sprintf_fixed32(tmp, magnitude_result[0]);
-      strcat(tmp,",");
-      //strcat(msg," ,"); 
-      PRINT(tmp);
-    } // END  e_config for loop. 
-    
-    //strcat(msg," \r\n"); 
-    PRINT("\r\n"); 
-    adi_UART_BufFlush(hUartDevice);
+      for (quad = 0; quad < mux_plan_count; quad++) {
+        if (PATTERN_PLAN_QUAD(mux_reduced_plan[quad]) >= mux_measured_count) {
+          continue;
+        }
+        if (mux_measured[PATTERN_PLAN_QUAD(mux_reduced_plan[quad])] == quad) {
+          continue;
+        }
+        sign = PATTERN_PLAN_NEGATIVE(mux_reduced_plan[quad]) ? -1 : 1;
+        for (f = 0; f < perQuad; f += ZCONV_VALUES(mux_value_format)) {
+          pRef   = &mux_frame[mux_measured[PATTERN_PLAN_QUAD(mux_reduced_plan[quad])] * perQuad + f];
+          pValue = &mux_frame[quad * perQuad + f];
+          if (ZCONV_FORMAT_REAL_IMAG == mux_value_format) {
+            // the complex value, with its sign. 
+            re  = (int64_t)pValue[0] - sign * pRef[0];
+            im  = (int64_t)pValue[1] - sign * pRef[1];
+            ppm = plan_ppm((uint64_t)((re < 0) ? -re : re) + (uint64_t)((im < 0) ? -im : im),
+                           (uint64_t)((pRef[0] < 0) ? -(int64_t)pRef[0] : pRef[0]) +
+                           (uint64_t)((pRef[1] < 0) ? -(int64_t)pRef[1] : pRef[1]));
+          }
+          else if (ZCONV_FORMAT_RAW_Q31 == mux_value_format) {
+            // raw |I| and |V| follow the loop of each quad, only |V| / |I| is the same. 
+            vi  = (uint64_t)((uint32_t)pValue[1] >> 8) * ((uint32_t)pRef[0] >> 8);
+            iv  = (uint64_t)((uint32_t)pRef[1] >> 8) * ((uint32_t)pValue[0] >> 8);
+            ppm = plan_ppm((vi > iv) ? (vi - iv) : (iv - vi), iv);
+          }
+          else {
+            // magnitudes, the phase of a negated quad is 180 degrees away. 
+            re  = (int64_t)pValue[0] - pRef[0];
+            ppm = plan_ppm((uint64_t)((re < 0) ? -re : re), (uint64_t)((pRef[0] < 0) ? -(int64_t)pRef[0] : pRef[0]));
+          }
+          maxPpm  = (ppm > maxPpm) ? ppm : maxPpm;
+          sumPpm += ppm;
+          checks++;
+        }
+      }
+      sprintf(msg, "reciprocity: max %u ppm, mean %u ppm\r\n", maxPpm, (checks > 0) ? (uint32_t)(sumPpm / checks) : 0u);
+      mux_print(msg);
+}
+
+/* difference / reference in ppm, saturated at 100 % */
+uint32_t plan_ppm(uint64_t difference, uint64_t reference) {
+  
+      if (difference >= reference) {
+        return (0 == difference) ? 0u : 1000000u;
+      }
+      // keep difference * 10^6 within 64 bits. 
+      while (reference >> 43) {
+        difference >>= 1;
+        reference  >>= 1;
+      }
+      return (uint32_t)((difference * 1000000u) / reference);
+}
+
+/* Add values to an average, restarting it when their meaning changes; true once average_frames are summed */
+bool_t average_collect(AVERAGE_ACCUMULATOR *pAcc, uint32_t *pKey, uint32_t key, const int32_t *pValues, uint32_t count) {
+  
+      // a new mode or value format, or a frame of another size. 
+      if ((*pKey != key) || !average_Add(pAcc, pValues, count)) {
+        average_Reset(pAcc);
+        *pKey = key;
+        average_Add(pAcc, pValues, count);
+      }
+      return (pAcc->frames >= average_frames);
 }
 /******************************************************************************
     Main code for the imaging function bipolar measurements(not tetrapolar). 
@@ -965,26 +2301,14 @@ void multiplex_adg732(ADI_AFE_DEV_HANDLE  hDevice, const uint32_t *const seq,uin
 *****************************************************************************/
 void bipolar_adg732(ADI_AFE_DEV_HANDLE  hDevice, const uint32_t *const seq,uint32_t n_el) {
   
-   // int 32 of the sequence, no of measures based on the sequence entered. 
-   // i.e. n_el if 8, 16, 32, we can pick which sequence. 
+   // no of measures based on the electrode pattern selected by n_el. 
    //   32, 192, 896  
-    uint32_t            numberofmeasures;
-    if (n_el == 8) {
-      numberofmeasures = 32;
-    }  
-    else if (n_el == 16) {
-      numberofmeasures = 192;
-    }
-    else if (n_el == 32) {
-      numberofmeasures = 896;
-    }
-    else {
-      numberofmeasures = 0;
-      PRINT("number of measures is 0\n");
-    }
+    uint32_t            numberofmeasures = mux_select_pattern(n_el);
 
     char                msg[MSG_MAXLEN_M3] = {0};
-    sprintf(msg,"magnitudes: ");
+    // the frame is stamped as its first quad is measured. 
+    timestamp_prefix(msg, timestamp_Now());
+    strcat(msg,"magnitudes: ");
     PRINT(msg);
     // NUMBEROFMEASURES is determined by which electrode configuration: 8,16 or 32. 
     for (uint32_t econf = 0;econf<numberofmeasures;econf++) {    
@@ -997,71 +2321,8 @@ void bipolar_adg732(ADI_AFE_DEV_HANDLE  hDevice, const uint32_t *const seq,uint3
       fixed32_t           magnitude_result[DFT_RESULTS_COUNT/2-1] = {0};
       int8_t              i = 0;   
           
-      // This is where we select the electrode sequence. i.e. 8,16 or 32 adjacent or opposition.  
-      int16_t* e;
-      if (n_el == 8) {
-        e = (int16_t *)electrode_configuration_8_opposition[econf];
-      }  
-      else if (n_el == 16) {
-        e = (int16_t *)electrode_configuration_16_opposition[econf];
-      }
-      else if (n_el == 32) {
-        e = (int16_t *)electrode_configuration_32_opposition[econf];
-      }
-      else {
-        e = (int16_t *)electrode_configuration_32_opposition[econf];
-      }
-      
-      // M1,M2,M3,M4 = 1,2,4,5 
-      // U4, A-, m1, position 3
-      // U2, V-, m2, position 2 
-      // U1, A+. m3, position 1
-      // U5, V+, m4, position 4
-      // 
-      // e_conf file is written as A+,A-,V+,V-
-      // I've mapped them like this so the e_conf file matches the 
-      // multiplexer assignement i.e. A+ -> A+ etc. 
-      int16_t* mx1_assignment = (int16_t *)truth_table[e[1]];  // A- -> 
-      int16_t* mx2_assignment = (int16_t *)truth_table[e[3]];  // V- ->  
-      int16_t* mx3_assignment = (int16_t *)truth_table[e[0]];  // A+ -> 
-      int16_t* mx4_assignment = (int16_t *)truth_table[e[2]];  // V+ ->   
-        
-      PinMap m1_portpin;  
-      PinMap m2_portpin;  
-      PinMap m3_portpin;  
-      PinMap m4_portpin;      
-      // A4 A3 A2 A1 A0
-      for (int i=0;i<5;i++) {   
-        m1_portpin = m1_configuration[i]; // first one is a4,a3,a2,a1,a0. 
-        m2_portpin = m2_configuration[i]; // second one is        
-        m3_portpin = m3_configuration[i]; // third one is          
-        m4_portpin = m4_configuration[i]; // fourth one is 
-        // set the port pins on each multiplexer. 
-        if (mx1_assignment[i] > 0) { 
-          adi_GPIO_SetHigh(m1_portpin.Port, m1_portpin.Pins);
-        }
-        else {
-          adi_GPIO_SetLow(m1_portpin.Port, m1_portpin.Pins);
-        }
-        if (mx2_assignment[i] > 0) {
-          adi_GPIO_SetHigh(m2_portpin.Port,m2_portpin.Pins);
-        }
-        else {
-          adi_GPIO_SetLow(m2_portpin.Port,m2_portpin.Pins);  
-        }
-        if (mx3_assignment[i] > 0) {
-          adi_GPIO_SetHigh(m3_portpin.Port,m3_portpin.Pins);
-        }
-        else {
-          adi_GPIO_SetLow(m3_portpin.Port,m3_portpin.Pins);
-        }        
-        if (mx4_assignment[i] > 0) {
-          adi_GPIO_SetHigh(m4_portpin.Port,m4_portpin.Pins);
-        }
-        else {
-          adi_GPIO_SetLow(m4_portpin.Port,m4_portpin.Pins);
-        }      
-      }  // end of for loop for setting multiplexers. 
+      // set the port pins on each multiplexer. 
+      adg732_Apply(mux_plan[econf]);
       
       // Now the multiplexers are set, take a measurement. 
       // Get a measurement:  
@@ -1094,369 +2355,51 @@ void bipolar_adg732(ADI_AFE_DEV_HANDLE  hDevice, const uint32_t *const seq,uint3
     
 
     PRINT("\r\n"); 
-    adi_UART_BufFlush(hUartDevice);
 }
-/***************************
-
-    This initializes bipolar measurement parameters
-
-****************************/
-void init_mode_bipolar(void) {
-  
-        /* Initialize GPIO */
-    if (ADI_GPIO_SUCCESS != adi_GPIO_Init())
-    {
-        PRINT("adi_GPIO_Init");
-    }
-    
-    /* Enable GPIO output drivers */
-    init_GPIO_ports();
-        
-    /* Initialize the AFE API */
-    if (adi_AFE_Init(&hDevice)) 
-    {
-        PRINT("adi_AFE_Init");
-    }
-
-    /* AFE power up */
-    if (adi_AFE_PowerUp(hDevice)) 
-    {
-        PRINT("adi_AFE_PowerUp");
-    }
-
-    /* Excitation Channel Power-Up */
-    if (adi_AFE_ExciteChanPowerUp(hDevice)) 
-    {
-        PRINT("adi_AFE_ExciteChanPowerUp");
-    }
-
-    /* TIA Channel Calibration */
-    if (adi_AFE_TiaChanCal(hDevice)) 
-    {
-        PRINT("adi_AFE_TiaChanCal");
-    }
-
-    /* Excitation Channel Calibration (Attenuation Enabled) */
-    if (adi_AFE_ExciteChanCalAtten(hDevice)) 
-    {
-        PRINT("adi_AFE_ExciteChanCalAtten");
-    }
-
-    /* Update FCW in the sequence */
-     seq_afe_poweritup[3] = SEQ_MMR_WRITE(REG_AFE_AFE_WG_FCW, FCW);
-     /* Update sine amplitude in the sequence */
-     seq_afe_poweritup[4] = SEQ_MMR_WRITE(REG_AFE_AFE_WG_AMPLITUDE, SINE_AMPLITUDE_BIPOLAR);
-
-    /* Recalculate CRC in software for the AC measurement, because we changed   */
-    /* FCW and sine amplitude settings                                          */
-    adi_AFE_EnableSoftwareCRC(hDevice, true);
-    int16_t             dft_results[DFT_RESULTS_COUNT];
-    if (ADI_AFE_SUCCESS != adi_AFE_RunSequence(hDevice, seq_afe_poweritup_bipolar, (uint16_t *)dft_results, DFT_RESULTS_COUNT)) 
-    {
-      PRINT("AFE PROBLEM! ");
-    }          
-    PRINT("FINISHED SET UP \n");
-    
-  
-};
-/***************************
-
-    This initializes bioimpedance spectroscopy parameters. 
-
-****************************/
-void init_mode_bis(void) {
-  
-   uint32_t            offset_code;
-   uint32_t            gain_code;       
-  
-    /* Initialize the AFE API */
-    if (ADI_AFE_SUCCESS != adi_AFE_Init(&hDevice)) 
-    {
-        FAIL("Init");
-    }
-
-    /* Set RCAL and RTIA values */
-    if (ADI_AFE_SUCCESS != adi_AFE_SetRcal(hDevice, RCAL)) 
-    {
-        FAIL("adi_AFE_SetRcal");
-    }
-    if (ADI_AFE_SUCCESS != adi_AFE_SetRtia(hDevice, RTIA)) 
-    {
-        FAIL("adi_AFE_SetTia");
-    }
-
-    /* AFE power up */
-    if (ADI_AFE_SUCCESS != adi_AFE_PowerUp(hDevice)) 
-    {
-        FAIL("adi_AFE_PowerUp");
-    }
-
-    /* Delay to ensure Vbias is stable */
-    delay(2000000);                                                             
-
-    /* Temp Channel Calibration */
-    if (ADI_AFE_SUCCESS != adi_AFE_TempSensChanCal(hDevice)) 
-    {
-        PRINT("adi_AFE_TempSensChanCal");
-    }
-    
-    /* Auxiliary Channel Calibration */
-    if (ADI_AFE_SUCCESS != adi_AFE_AuxChanCal(hDevice)) 
-    {
-        PRINT("adi_AFE_AuxChanCal");
-    }    
-
-    /* Excitation Channel Power-Up */
-    if (ADI_AFE_SUCCESS != adi_AFE_ExciteChanPowerUp(hDevice)) 
-    {
-        FAIL("adi_AFE_ExciteChanPowerUp");
-    }
-
-    /* TempCal results will be used to set the TIA calibration registers. These */
-    /* values will ensure the ratio between current and voltage is exactly 1.5  */
-    if (ADI_AFE_SUCCESS != adi_AFE_ReadCalibrationRegister(hDevice, ADI_AFE_CAL_REG_ADC_GAIN_TEMP_SENS, &gain_code))
-    {
-        FAIL("adi_AFE_ReadCalibrationRegister, gain");
-    }
-    if (ADI_AFE_SUCCESS != adi_AFE_WriteCalibrationRegister(hDevice, ADI_AFE_CAL_REG_ADC_GAIN_TIA, gain_code))
-    {
-        FAIL("adi_AFE_WriteCalibrationRegister, gain");
-    }
-    if (ADI_AFE_SUCCESS != adi_AFE_ReadCalibrationRegister(hDevice, ADI_AFE_CAL_REG_ADC_OFFSET_TEMP_SENS, &offset_code))
-    {
-        FAIL("adi_AFE_ReadCalibrationRegister, offset");
-    }
-    if (ADI_AFE_SUCCESS != adi_AFE_WriteCalibrationRegister(hDevice, ADI_AFE_CAL_REG_ADC_OFFSET_TIA, offset_code))
-    {
-        FAIL("adi_AFE_WriteCalibrationRegister, offset");
-    }    
+/******************************************************************************
+    Mode switch. The AFE stays powered and calibrated, mode_manager only runs 
+    what the new mode needs and the AFE does not hold yet: the calibration 
+    codes of the 2-wire or 4-wire modes, and the excitation of the sequences. 
   
+*****************************************************************************/
+bool_t mode_switch(int16_t newMode) {
   
-}
-/***************************
-    This initializes 32 electrode imaging parameters. 
-
-****************************/
-void init_mode_tetramux(void) {
-
-   uint32_t            offset_code;
-   uint32_t            gain_code;     
-
-    /* Initialize GPIO */
-    if (ADI_GPIO_SUCCESS != adi_GPIO_Init())
-    {
-        PRINT("adi_GPIO_Init");
-    }
-    
-    /* Enable GPIO output drivers */
-    init_GPIO_ports();
-        
-    /* Initialize the AFE API */
-    if (ADI_AFE_SUCCESS != adi_AFE_Init(&hDevice)) 
-    {
-        PRINT("Init");
-    }
-
-    /* Set RCAL and RTIA values */
-    if (ADI_AFE_SUCCESS != adi_AFE_SetRcal(hDevice, RCAL)) 
-    {
-        PRINT("adi_AFE_SetRcal");
-    }
-    if (ADI_AFE_SUCCESS != adi_AFE_SetRtia(hDevice, RTIA)) 
-    {
-        PRINT("adi_AFE_SetTia");
-    }
-
-    /* AFE power up */
-    if (ADI_AFE_SUCCESS != adi_AFE_PowerUp(hDevice)) 
-    {
-        PRINT("adi_AFE_PowerUp");
-    }
-
-    /* Delay to ensure Vbias is stable */
-    delay(2000000);                                                             
-
-    // This writes into some registers // 
-    /* Temp Channel Calibration */
-    if (ADI_AFE_SUCCESS != adi_AFE_TempSensChanCal(hDevice)) 
-    {
-        PRINT("adi_AFE_TempSensChanCal");
-    }
-    
-    /* Auxiliary Channel Calibration */
-    if (ADI_AFE_SUCCESS != adi_AFE_AuxChanCal(hDevice)) 
-    {
-        PRINT("adi_AFE_AuxChanCal");
-    }    
-
-    /* Excitation Channel Power-Up */
-    if (ADI_AFE_SUCCESS != adi_AFE_ExciteChanPowerUp(hDevice)) 
-    {
-        PRINT("adi_AFE_ExciteChanPowerUp");
-    }
+    char                msg[MSG_MAXLEN_M1] = {0};
+    MODEMGR_TARGET      target;
+    uint32_t            failed;
     
-    /* TempCal results will be used to set the TIA calibration registers. These */
-    /* values will ensure the ratio between current and voltage is exactly 1.5  */
-    if (ADI_AFE_SUCCESS != adi_AFE_ReadCalibrationRegister(hDevice, ADI_AFE_CAL_REG_ADC_GAIN_TEMP_SENS, &gain_code))
-    {
-        PRINT("adi_AFE_ReadCalibrationRegister, gain");
-    }
-    if (ADI_AFE_SUCCESS != adi_AFE_WriteCalibrationRegister(hDevice, ADI_AFE_CAL_REG_ADC_GAIN_TIA, gain_code))
-    {
-        PRINT("adi_AFE_WriteCalibrationRegister, gain");
-    }
-    if (ADI_AFE_SUCCESS != adi_AFE_ReadCalibrationRegister(hDevice, ADI_AFE_CAL_REG_ADC_OFFSET_TEMP_SENS, &offset_code))
+    mode = newMode;
+    mode_target(&target);
+    failed = modemgr_Switch(&mode_manager, &target);
+    hDevice = mode_manager.hDevice;
+    if (failed) 
     {
-        PRINT("adi_AFE_ReadCalibrationRegister, offset");
-    }
-    if (ADI_AFE_SUCCESS != adi_AFE_WriteCalibrationRegister(hDevice, ADI_AFE_CAL_REG_ADC_OFFSET_TIA, offset_code))
-    {
-        PRINT("adi_AFE_WriteCalibrationRegister, offset");
+      // the failed step runs again at the next switch. 
+      sprintf(msg, "mode %d: setup step 0x%02x failed\n", newMode, failed);
+      PRINT(msg);
+      return false;
     }
-
-    /* Update FCW in the sequence */
-    seq_afe_poweritup[3] = SEQ_MMR_WRITE(REG_AFE_AFE_WG_FCW, FCW);
-    /* Update sine amplitude in the sequence */
-    seq_afe_poweritup[4] = SEQ_MMR_WRITE(REG_AFE_AFE_WG_AMPLITUDE, SINE_AMPLITUDE);
-      
-    /* Recalculate CRC in software for the AC measurement, because we changed   */
-    /* FCW and sine amplitude settings.                                         */
-    adi_AFE_EnableSoftwareCRC(hDevice, true);
-    int16_t             dft_results[DFT_RESULTS_COUNT]     = {0};
-    if (ADI_AFE_SUCCESS != adi_AFE_RunSequence(hDevice, seq_afe_poweritup, (uint16_t *)dft_results, DFT_RESULTS_COUNT)) 
-    {
-     PRINT("AFE PROBLEM!");
-    }          
-  
+    return true;
 }
 
-void init_GPIO_ports(void) {
+/* What the current mode needs from the AFE */
+void mode_target(MODEMGR_TARGET *pTarget) {
   
-    // Enable all 4 multiplexer ports.  
-    if (ADI_GPIO_SUCCESS != adi_GPIO_SetPullUpEnable (ADI_GPIO_PORT_1,ADI_GPIO_PIN_5, false))
-    {
-      PRINT("adi_GPIO_SetInputEnable (led_DISPLAY)");
+    pTarget->profile   = MODEMGR_PROFILE_TETRAPOLAR;
+    pTarget->fcw       = MODEMGR_FCW_ANY;
+    pTarget->amplitude = SINE_AMPLITUDE;
+    if (mode == 1) {
+      pTarget->fcw = seq_Fcw(timeseries_timing.frequency);
     }
-    if (ADI_GPIO_SUCCESS != adi_GPIO_SetOutputEnable(ADI_GPIO_PORT_1,ADI_GPIO_PIN_5, true))
-    {
-        PRINT("adi_GPIO_SetOutputEnable (1.5) FAILED ");
+    else if ((mode >= 3) && (mode <= 5)) {
+      pTarget->fcw = seq_Fcw(imaging_timing.frequency);
     }
-    if (ADI_GPIO_SUCCESS != adi_GPIO_SetInputEnable(ADI_GPIO_PORT_1,ADI_GPIO_PIN_5, true))
-    {
-      PRINT("adi_GPIO_SetInputEnable (led_DISPLAY)");
-    }    
-
-        
-    if (ADI_GPIO_SUCCESS != adi_GPIO_SetPullUpEnable (ADI_GPIO_PORT_1,ADI_GPIO_PIN_11, false))
-    {
-      PRINT("adi_GPIO_SetInputEnable (led_DISPLAY)");
-    }    
-    if (ADI_GPIO_SUCCESS != adi_GPIO_SetOutputEnable(ADI_GPIO_PORT_1,ADI_GPIO_PIN_11, true))
-    {
-        PRINT("adi_GPIO_SetOutputEnable (1.11) FAILED");
-    }    
-    if (ADI_GPIO_SUCCESS != adi_GPIO_SetInputEnable(ADI_GPIO_PORT_1,ADI_GPIO_PIN_11, true))
-    {
-      PRINT("adi_GPIO_SetInputEnable (led_DISPLAY)");
-    }        
-    
-    
-    if (ADI_GPIO_SUCCESS != adi_GPIO_SetPullUpEnable (ADI_GPIO_PORT_3,ADI_GPIO_PIN_12, false))
-    {
-      PRINT("adi_GPIO_SetInputEnable (led_DISPLAY)");
+    else if ((mode == 6) || (mode == 7)) {
+      pTarget->profile   = MODEMGR_PROFILE_BIPOLAR;
+      pTarget->fcw       = FCW;
+      pTarget->amplitude = SINE_AMPLITUDE_BIPOLAR;
     }
-    if (ADI_GPIO_SUCCESS != adi_GPIO_SetOutputEnable(ADI_GPIO_PORT_3,ADI_GPIO_PIN_12, true))
-    {
-        PRINT("adi_GPIO_SetOutputEnable (3.12) FAILED ");
-    }
-    if (ADI_GPIO_SUCCESS != adi_GPIO_SetInputEnable(ADI_GPIO_PORT_3,ADI_GPIO_PIN_12, true))
-    {
-      PRINT("adi_GPIO_SetInputEnable (led_DISPLAY)");
-    }         
-    
-    if (ADI_GPIO_SUCCESS != adi_GPIO_SetPullUpEnable (ADI_GPIO_PORT_2,ADI_GPIO_PIN_6, false))
-    {
-      PRINT("adi_GPIO_SetInputEnable (led_DISPLAY)");
-    }
-    if (ADI_GPIO_SUCCESS != adi_GPIO_SetOutputEnable(ADI_GPIO_PORT_2,ADI_GPIO_PIN_6, true))
-    {
-        PRINT("adi_GPIO_SetOutputEnable (2.6) FAILED");
-    }        
-    if (ADI_GPIO_SUCCESS != adi_GPIO_SetInputEnable(ADI_GPIO_PORT_2,ADI_GPIO_PIN_6, true))
-    {
-      PRINT("adi_GPIO_SetInputEnable (led_DISPLAY)");
-    }         
-    
-    PinMap m1_portpin;  
-    PinMap m2_portpin;  
-    PinMap m3_portpin;  
-    PinMap m4_portpin;  
-    char                porttest[MSG_MAXLEN_M3] = {0};
-    sprintf(porttest, "%s:", "port test failure list: ");     
-    
-    /* with error messages for every single  GPIO enable */ 
-    for (int i=0;i<5;i++) {   
-      
-        char    ptmp[50]={0};
-        m1_portpin = m1_configuration[i]; // first one is a4,a3,a2,a1,a0. 
-        m2_portpin = m2_configuration[i]; // second one is        
-        m3_portpin = m3_configuration[i]; // third one is          
-        m4_portpin = m4_configuration[i]; // fourth one is 
-        
-        if (ADI_GPIO_SUCCESS != adi_GPIO_SetPullUpEnable (m1_portpin.Port, m1_portpin.Pins, false)) {
-          PRINT ("Problem with setting pull up enable");
-        }
-        if (ADI_GPIO_SUCCESS != adi_GPIO_SetOutputEnable(m1_portpin.Port, m1_portpin.Pins, true))
-        {
-          sprintf(ptmp,"%d . %d, ", m1_portpin.Port, m1_portpin.Pins);
-          strcat(porttest,ptmp);
-        }              
-        if (ADI_GPIO_SUCCESS != adi_GPIO_SetInputEnable(m1_portpin.Port, m1_portpin.Pins, true))
-        {
-          PRINT("adi_GPIO_SetInputEnable (led_DISPLAY)");
-        }
-  
-        if (ADI_GPIO_SUCCESS != adi_GPIO_SetPullUpEnable (m2_portpin.Port, m2_portpin.Pins, false)) {
-          PRINT ("Problem with setting pull up enable");
-        }        
-        if (ADI_GPIO_SUCCESS != adi_GPIO_SetOutputEnable(m2_portpin.Port, m2_portpin.Pins, true))
-        {
-          sprintf(ptmp,"%d . %d, ", m2_portpin.Port, m2_portpin.Pins);
-          strcat(porttest,ptmp);
-        }     
-        if (ADI_GPIO_SUCCESS != adi_GPIO_SetInputEnable(m2_portpin.Port, m2_portpin.Pins, true))
-        {
-          PRINT("adi_GPIO_SetInputEnable (led_DISPLAY)");
-        }        
-        
-        if (ADI_GPIO_SUCCESS != adi_GPIO_SetPullUpEnable (m3_portpin.Port, m3_portpin.Pins, false)) {
-          PRINT ("Problem with setting pull up enable");
-        }
-        if (ADI_GPIO_SUCCESS != adi_GPIO_SetOutputEnable(m3_portpin.Port, m3_portpin.Pins, true))
-        {
-          sprintf(ptmp,"%d . %d, ", m3_portpin.Port, m3_portpin.Pins);
-          strcat(porttest,ptmp);
-        }               
-                if (ADI_GPIO_SUCCESS != adi_GPIO_SetInputEnable(m3_portpin.Port, m3_portpin.Pins, true))
-        {
-          PRINT("adi_GPIO_SetInputEnable (led_DISPLAY)");
-        }
-        
-        if (ADI_GPIO_SUCCESS != adi_GPIO_SetPullUpEnable (m4_portpin.Port, m4_portpin.Pins, false)) {
-          PRINT ("Problem with setting pull up enable");
-        }
-        if (ADI_GPIO_SUCCESS != adi_GPIO_SetOutputEnable(m4_portpin.Port, m4_portpin.Pins, true))
-        {
-          sprintf(ptmp,"%d . %d, ", m4_portpin.Port, m4_portpin.Pins);
-          strcat(porttest,ptmp);
-        }            
-        if (ADI_GPIO_SUCCESS != adi_GPIO_SetInputEnable(m4_portpin.Port, m4_portpin.Pins, true))
-        {
-          PRINT("adi_GPIO_SetInputEnable (led_DISPLAY)");
-        }        
-        
-     }
-     //PRINT(porttest);
+    // modes 2 and 8 program the frequency and amplitude in each of their sequences. 
 }
 
 
@@ -0,0 +1,230 @@
+/*!
+ *****************************************************************************
+ * @file:   adg732.c
+ * @brief:  ADG732 multiplexer addressing through precomputed GPIO port masks
+ *
+ * The mask path writes the port GPTGL registers directly: only the address
+ * pins that change are toggled, so each write is atomic and never touches
+ * the other pins of the port. This relies on the address pins being driven
+ * by this module only; adg732_Init() brings them to a known state.
+ *****************************************************************************/
+
+#include <stddef.h>
+
+#include "adg732.h"
+
+/* Port register writes; the host simulator (tools/AFESim) observes them through the driver */
+#if defined(AFESIM)
+#define ADG732_PORT_CLEAR(port, pins)   adi_GPIO_SetLow((port), (pins))
+#define ADG732_PORT_TOGGLE(port, pins)  adi_GPIO_Toggle((port), (pins))
+#else
+#define ADG732_PORT_CLEAR(port, pins)   (((ADI_GPIO_TypeDef *)(port))->GPCLR = (pins))
+#define ADG732_PORT_TOGGLE(port, pins)  (((ADI_GPIO_TypeDef *)(port))->GPTGL = (pins))
+#endif
+
+/* Address pin of a multiplexer */
+typedef struct {
+    uint8_t                 port;           /*!< Index in adg732_ports          */
+    ADI_GPIO_DATA_TYPE      pin;
+} ADG732_PIN;
+
+/* GPIO ports carrying address pins */
+static const ADI_GPIO_PORT_TYPE adg732_ports[ADG732_PORT_COUNT] = {
+    ADI_GPIO_PORT_1, ADI_GPIO_PORT_2, ADI_GPIO_PORT_3
+};
+
+/* Address pins of each multiplexer, A4 first, as (port index in adg732_ports, pin) pairs */
+/* M1, A- : P1.4, P1.3, P1.2, P1.1, P1.0 */
+#define ADG732_PINS_M1      0, ADI_GPIO_PIN_4,  0, ADI_GPIO_PIN_3,  0, ADI_GPIO_PIN_2,  0, ADI_GPIO_PIN_1,  0, ADI_GPIO_PIN_0
+/* M2, V- : P1.10, P1.9, P1.8, P1.7, P1.6 */
+#define ADG732_PINS_M2      0, ADI_GPIO_PIN_10, 0, ADI_GPIO_PIN_9,  0, ADI_GPIO_PIN_8,  0, ADI_GPIO_PIN_7,  0, ADI_GPIO_PIN_6
+/* M3, A+ : P3.13, P1.15, P1.14, P1.13, P1.12 */
+#define ADG732_PINS_M3      2, ADI_GPIO_PIN_13, 0, ADI_GPIO_PIN_15, 0, ADI_GPIO_PIN_14, 0, ADI_GPIO_PIN_13, 0, ADI_GPIO_PIN_12
+/* M4, V+ : P2.7, P2.8, P2.9, P2.10, P2.11 */
+#define ADG732_PINS_M4      1, ADI_GPIO_PIN_7,  1, ADI_GPIO_PIN_8,  1, ADI_GPIO_PIN_9,  1, ADI_GPIO_PIN_10, 1, ADI_GPIO_PIN_11
+
+/* Row of adg732_pins */
+#define ADG732_PIN_ROW(...)                 ADG732_PIN_ROW_(__VA_ARGS__)
+#define ADG732_PIN_ROW_(p4, b4, p3, b3, p2, b2, p1, b1, p0, b0) \
+    { {p4, b4}, {p3, b3}, {p2, b2}, {p1, b1}, {p0, b0} }
+
+/* Pins of a port driven high for a channel */
+#define ADG732_BIT(ch, n, p, b, port)       (((((ch) >> (n)) & 1) && ((p) == (port))) ? (b) : 0)
+#define ADG732_PORT_BITS(ch, port, p4, b4, p3, b3, p2, b2, p1, b1, p0, b0) \
+    (ADI_GPIO_DATA_TYPE)(ADG732_BIT(ch, 4, p4, b4, port) | ADG732_BIT(ch, 3, p3, b3, port) | \
+                         ADG732_BIT(ch, 2, p2, b2, port) | ADG732_BIT(ch, 1, p1, b1, port) | \
+                         ADG732_BIT(ch, 0, p0, b0, port))
+#define ADG732_CHANNEL(ch, ...) \
+    { ADG732_PORT_BITS(ch, 0, __VA_ARGS__), ADG732_PORT_BITS(ch, 1, __VA_ARGS__), ADG732_PORT_BITS(ch, 2, __VA_ARGS__) }
+#define ADG732_CHANNELS_8(ch, ...) \
+    ADG732_CHANNEL((ch) + 0, __VA_ARGS__), ADG732_CHANNEL((ch) + 1, __VA_ARGS__), \
+    ADG732_CHANNEL((ch) + 2, __VA_ARGS__), ADG732_CHANNEL((ch) + 3, __VA_ARGS__), \
+    ADG732_CHANNEL((ch) + 4, __VA_ARGS__), ADG732_CHANNEL((ch) + 5, __VA_ARGS__), \
+    ADG732_CHANNEL((ch) + 6, __VA_ARGS__), ADG732_CHANNEL((ch) + 7, __VA_ARGS__)
+/* Rows of adg732_setMask of a multiplexer, channels 0 to 31 */
+#define ADG732_MASK_ROWS(...) \
+    { ADG732_CHANNELS_8(0, __VA_ARGS__), ADG732_CHANNELS_8(8, __VA_ARGS__), \
+      ADG732_CHANNELS_8(16, __VA_ARGS__), ADG732_CHANNELS_8(24, __VA_ARGS__) }
+
+/* Address pins of each multiplexer, A4 first, in packed mux word order */
+static const ADG732_PIN adg732_pins[PATTERN_MUX_COUNT][ADG732_ADDRESS_BITS] = {
+    ADG732_PIN_ROW(ADG732_PINS_M1),
+    ADG732_PIN_ROW(ADG732_PINS_M2),
+    ADG732_PIN_ROW(ADG732_PINS_M3),
+    ADG732_PIN_ROW(ADG732_PINS_M4),
+};
+
+/* Pins to drive high on each port to select a channel of a multiplexer, computed by the preprocessor */
+static const ADI_GPIO_DATA_TYPE adg732_setMask[PATTERN_MUX_COUNT][PATTERN_MUX_CHANNELS][ADG732_PORT_COUNT] = {
+    ADG732_MASK_ROWS(ADG732_PINS_M1),
+    ADG732_MASK_ROWS(ADG732_PINS_M2),
+    ADG732_MASK_ROWS(ADG732_PINS_M3),
+    ADG732_MASK_ROWS(ADG732_PINS_M4),
+};
+/* All address pins of each port */
+static ADI_GPIO_DATA_TYPE   adg732_portMask[ADG732_PORT_COUNT];
+/* Address pins currently driven high on each port */
+static ADI_GPIO_DATA_TYPE   adg732_portState[ADG732_PORT_COUNT];
+
+/*!
+ * @brief       Enable the address pins and compute the mask of each port.
+ *
+ * @return      ADI_GPIO_SUCCESS, or the first GPIO driver error.
+ *
+ * @details     Must be called after adi_GPIO_Init(). All the multiplexers are
+ *              switched to channel 0.
+ */
+ADI_GPIO_RESULT_TYPE adg732_Init(void) {
+    ADI_GPIO_RESULT_TYPE    result;
+    uint32_t                mux, bit, port;
+
+    for (port = 0; port < ADG732_PORT_COUNT; port++) {
+        adg732_portMask[port] = 0;
+    }
+
+    for (mux = 0; mux < PATTERN_MUX_COUNT; mux++) {
+        for (bit = 0; bit < ADG732_ADDRESS_BITS; bit++) {
+            adg732_portMask[adg732_pins[mux][bit].port] |= adg732_pins[mux][bit].pin;
+        }
+    }
+
+    for (port = 0; port < ADG732_PORT_COUNT; port++) {
+        if (ADI_GPIO_SUCCESS != (result = adi_GPIO_SetPullUpEnable(adg732_ports[port], adg732_portMask[port], false))) {
+            return result;
+        }
+        if (ADI_GPIO_SUCCESS != (result = adi_GPIO_SetOutputEnable(adg732_ports[port], adg732_portMask[port], true))) {
+            return result;
+        }
+        if (ADI_GPIO_SUCCESS != (result = adi_GPIO_SetInputEnable(adg732_ports[port], adg732_portMask[port], true))) {
+            return result;
+        }
+
+        ADG732_PORT_CLEAR(adg732_ports[port], adg732_portMask[port]);
+        adg732_portState[port] = 0;
+    }
+
+    return ADI_GPIO_SUCCESS;
+}
+
+/*!
+ * @brief       Switch the four multiplexers to a packed mux word.
+ *
+ * @param[in]   word        Packed mux word, see pattern.h.
+ *
+ * @details     At most one GPTGL write per port, ports whose address pins
+ *              do not change are not written.
+ */
+void adg732_Apply(uint32_t word) {
+    ADI_GPIO_DATA_TYPE      set[ADG732_PORT_COUNT] = {0};
+    ADI_GPIO_DATA_TYPE      toggle;
+    const ADI_GPIO_DATA_TYPE *pMask;
+    uint32_t                mux, port;
+
+    for (mux = 0; mux < PATTERN_MUX_COUNT; mux++) {
+        pMask = adg732_setMask[mux][PATTERN_MUX_ADDR(word, mux)];
+        set[0] |= pMask[0];
+        set[1] |= pMask[1];
+        set[2] |= pMask[2];
+    }
+
+    for (port = 0; port < ADG732_PORT_COUNT; port++) {
+        toggle = set[port] ^ adg732_portState[port];
+        if (toggle) {
+            ADG732_PORT_TOGGLE(adg732_ports[port], toggle);
+            adg732_portState[port] = set[port];
+        }
+    }
+}
+
+/*!
+ * @brief       Switch the four multiplexers pin by pin through the GPIO driver.
+ *
+ * @param[in]   word        Packed mux word, see pattern.h.
+ *
+ * @details     Reference path for adg732_Benchmark(), equivalent to adg732_Apply().
+ */
+void adg732_ApplyPins(uint32_t word) {
+    const ADG732_PIN       *pPin;
+    uint32_t                mux, bit, address;
+
+    for (mux = 0; mux < PATTERN_MUX_COUNT; mux++) {
+        address = PATTERN_MUX_ADDR(word, mux);
+        for (bit = 0; bit < ADG732_ADDRESS_BITS; bit++) {
+            pPin = &adg732_pins[mux][bit];
+            if ((address >> (ADG732_ADDRESS_BITS - 1u - bit)) & 1u) {
+                adi_GPIO_SetHigh(adg732_ports[pPin->port], pPin->pin);
+                adg732_portState[pPin->port] |= pPin->pin;
+            }
+            else {
+                adi_GPIO_SetLow(adg732_ports[pPin->port], pPin->pin);
+                adg732_portState[pPin->port] &= (ADI_GPIO_DATA_TYPE)~pPin->pin;
+            }
+        }
+    }
+}
+
+/*!
+ * @brief       Measure the cost of switching the multiplexers with both paths.
+ *
+ * @param[in]   pWords      Mux words to apply, e.g. a compiled pattern.
+ * @param[in]   count       Number of mux words.
+ * @param[out]  pResult     Total metric counts of each path.
+ *
+ * @return      ADI_METRIC_SUCCESS, or ADI_METRIC_ERROR if GP timer 0 is not available.
+ *
+ * @details     The multiplexers are really switched, so this must not run
+ *              during a measurement.
+ */
+ADI_METRIC_RESULT_TYPE adg732_Benchmark(const uint32_t *pWords, uint32_t count, ADG732_BENCHMARK *pResult) {
+    ADI_METRIC_DEV_HANDLE   hMetric;
+    uint32_t                i;
+
+    pResult->switches   = count;
+    pResult->pinCycles  = 0;
+    pResult->maskCycles = 0;
+
+    if (ADI_METRIC_SUCCESS != adi_Metric_Init(ADI_GPT_DEVID_0, &hMetric)) {
+        return ADI_METRIC_ERROR;
+    }
+
+    adi_Metric_Start(hMetric);
+    for (i = 0; i < count; i++) {
+        adg732_ApplyPins(pWords[i]);
+    }
+    adi_Metric_Stop(hMetric);
+    pResult->pinCycles = adi_Metric_GetAccumulate(hMetric);
+
+    adi_Metric_ClearAccumulate(hMetric);
+    adi_Metric_Start(hMetric);
+    for (i = 0; i < count; i++) {
+        adg732_Apply(pWords[i]);
+    }
+    adi_Metric_Stop(hMetric);
+    pResult->maskCycles = adi_Metric_GetAccumulate(hMetric);
+
+    return adi_Metric_UnInit(hMetric);
+}
+
+/*
+** EOF
+*/
@@ -0,0 +1,52 @@
+/*!
+ *****************************************************************************
+ * @file:   adg732.h
+ * @brief:  ADG732 multiplexer addressing through precomputed GPIO port masks
+ *
+ * The address pins of the four multiplexers are spread over GPIO ports 1, 2
+ * and 3. For every multiplexer and channel the pins to drive high on each
+ * port are computed once in adg732_Init(), so switching all four
+ * multiplexers to a packed mux word (see pattern.h) costs at most one
+ * GPTGL write per port instead of 20 adi_GPIO_SetHigh/SetLow calls.
+ *****************************************************************************/
+
+#ifndef __ADG732_H__
+#define __ADG732_H__
+
+#include <stdint.h>
+
+#include "gpio.h"
+#include "metrics.h"
+#include "pattern.h"
+
+/* C++ linkage */
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Address pins of each multiplexer, A4 .. A0 */
+#define ADG732_ADDRESS_BITS         (5u)
+/* GPIO ports carrying address pins: 1, 2 and 3 */
+#define ADG732_PORT_COUNT           (3u)
+
+/* Result of adg732_Benchmark(), in metric counts (HFOSC cycles) */
+typedef struct {
+    uint32_t                switches;       /*!< Mux words applied by each path             */
+    uint32_t                pinCycles;      /*!< adi_GPIO_SetHigh/SetLow per address pin    */
+    uint32_t                maskCycles;     /*!< Precomputed per-port masks                 */
+} ADG732_BENCHMARK;
+
+ADI_GPIO_RESULT_TYPE        adg732_Init             (void);
+void                        adg732_Apply            (uint32_t word);
+void                        adg732_ApplyPins        (uint32_t word);
+ADI_METRIC_RESULT_TYPE      adg732_Benchmark        (const uint32_t *pWords, uint32_t count, ADG732_BENCHMARK *pResult);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __ADG732_H__ */
+
+/*
+** EOF
+*/
@@ -0,0 +1,214 @@
+/*!
+ *****************************************************************************
+ * @file:   average.c
+ * @brief:  Frame averaging: mean and variance of the values of N frames
+ *
+ * With d the deviations from the first frame, S = sum(d) and Q = sum(d^2)
+ * over N frames:
+ *
+ *      mean     = first + S / N
+ *      variance = (Q - S^2 / N) / N
+ *
+ * |d| <= 2^28 and N <= 64 keep Q below 2^62 and |S| below 2^34; S^2 / N is
+ * split as (S / N) * S + (S % N) * S / N so no product exceeds 2^62.
+ *
+ * The deviation d of an angle is wrapped into [-P / 2, P / 2), P its
+ * period, so it is measured along the shorter arc from the first frame.
+ *****************************************************************************/
+
+#include <stddef.h>
+
+#include "average.h"
+
+static int64_t              average_Divide          (int64_t numerator, uint32_t denominator);
+static int32_t              average_Saturate        (int64_t value);
+static int64_t              average_WrapValue       (int64_t value, int32_t period);
+
+/* Division rounded to nearest */
+static int64_t average_Divide(int64_t numerator, uint32_t denominator) {
+    if (numerator < 0) {
+        return -((-numerator + (int64_t)(denominator >> 1)) / (int64_t)denominator);
+    }
+
+    return (numerator + (int64_t)(denominator >> 1)) / (int64_t)denominator;
+}
+
+static int32_t average_Saturate(int64_t value) {
+    if (value > (int64_t)0x7FFFFFFF) {
+        return 0x7FFFFFFF;
+    }
+    if (value < -(int64_t)0x80000000) {
+        return (int32_t)0x80000000;
+    }
+
+    return (int32_t)value;
+}
+
+/* Value wrapped into [-period / 2, period / 2) */
+static int64_t average_WrapValue(int64_t value, int32_t period) {
+    value %= period;
+    if (value >= (period >> 1)) {
+        value -= period;
+    }
+    else if (value < -(period >> 1)) {
+        value += period;
+    }
+
+    return value;
+}
+
+/*!
+ * @brief       Attach the storage of an accumulator and empty it.
+ *
+ * @param[out]  pAcc        Accumulator.
+ * @param[in]   pFirst      capacity values.
+ * @param[in]   pSum        capacity sums.
+ * @param[in]   pSumSq      capacity sums, NULL if the variance is not needed.
+ * @param[in]   capacity    Largest number of values per frame.
+ */
+void average_Init(AVERAGE_ACCUMULATOR *pAcc, int32_t *pFirst, int64_t *pSum, uint64_t *pSumSq, uint32_t capacity) {
+    pAcc->pFirst   = pFirst;
+    pAcc->pSum     = pSum;
+    pAcc->pSumSq   = pSumSq;
+    pAcc->capacity = capacity;
+    average_Wrap(pAcc, 1, 0);
+    average_Reset(pAcc);
+}
+
+/*!
+ * @brief       Average some values as angles. Set it with the first frame,
+ *              the deviations accumulated before are not rewrapped.
+ *
+ * @param[in]   pAcc        Accumulator.
+ * @param[in]   stride      Values i with i % stride == stride - 1 are angles.
+ * @param[in]   period      Period of the angles, 360 degrees in their format,
+ *                          0 for no angles.
+ */
+void average_Wrap(AVERAGE_ACCUMULATOR *pAcc, uint32_t stride, int32_t period) {
+    pAcc->wrapStride = (stride > 0u) ? stride : 1u;
+    pAcc->wrapPeriod = period;
+}
+
+/*!
+ * @brief       Drop the accumulated frames.
+ *
+ * @param[in]   pAcc        Accumulator.
+ */
+void average_Reset(AVERAGE_ACCUMULATOR *pAcc) {
+    pAcc->count  = 0;
+    pAcc->frames = 0;
+}
+
+/*!
+ * @brief       Accumulate a frame.
+ *
+ * @param[in]   pAcc        Accumulator.
+ * @param[in]   pValues     Values of the frame.
+ * @param[in]   count       Number of values.
+ *
+ * @return      true, or false if count exceeds the capacity or differs from
+ *              the first frame, or AVERAGE_MAX_FRAMES frames are accumulated.
+ *              Nothing is accumulated on failure.
+ */
+bool_t average_Add(AVERAGE_ACCUMULATOR *pAcc, const int32_t *pValues, uint32_t count) {
+    int64_t                 d;
+    uint32_t                i;
+
+    if ((count > pAcc->capacity) || (pAcc->frames >= AVERAGE_MAX_FRAMES) ||
+        ((pAcc->frames > 0u) && (count != pAcc->count))) {
+        return false;
+    }
+
+    if (0u == pAcc->frames) {
+        pAcc->count = count;
+        for (i = 0; i < count; i++) {
+            pAcc->pFirst[i] = pValues[i];
+            pAcc->pSum[i]   = 0;
+            if (NULL != pAcc->pSumSq) {
+                pAcc->pSumSq[i] = 0;
+            }
+        }
+    }
+    else {
+        for (i = 0; i < count; i++) {
+            d = (int64_t)pValues[i] - pAcc->pFirst[i];
+            if ((pAcc->wrapPeriod > 0) && ((i % pAcc->wrapStride) == pAcc->wrapStride - 1u)) {
+                d = average_WrapValue(d, pAcc->wrapPeriod);
+            }
+            if (d > AVERAGE_MAX_DEVIATION) {
+                d = AVERAGE_MAX_DEVIATION;
+            }
+            else if (d < -AVERAGE_MAX_DEVIATION) {
+                d = -AVERAGE_MAX_DEVIATION;
+            }
+            pAcc->pSum[i] += d;
+            if (NULL != pAcc->pSumSq) {
+                pAcc->pSumSq[i] += (uint64_t)(d * d);
+            }
+        }
+    }
+    pAcc->frames++;
+
+    return true;
+}
+
+/*!
+ * @brief       Mean of the accumulated frames, rounded to nearest, angles
+ *              wrapped into [-period / 2, period / 2).
+ *
+ * @param[in]   pAcc        Accumulator.
+ * @param[out]  pMean       count values.
+ *
+ * @return      Number of values written, 0 if no frame is accumulated.
+ */
+uint32_t average_Mean(const AVERAGE_ACCUMULATOR *pAcc, int32_t *pMean) {
+    int64_t                 mean;
+    uint32_t                i;
+
+    if (0u == pAcc->frames) {
+        return 0;
+    }
+    for (i = 0; i < pAcc->count; i++) {
+        mean = pAcc->pFirst[i] + average_Divide(pAcc->pSum[i], pAcc->frames);
+        if ((pAcc->wrapPeriod > 0) && ((i % pAcc->wrapStride) == pAcc->wrapStride - 1u)) {
+            mean = average_WrapValue(mean, pAcc->wrapPeriod);
+        }
+        pMean[i] = average_Saturate(mean);
+    }
+
+    return pAcc->count;
+}
+
+/*!
+ * @brief       Population variance of the accumulated frames.
+ *
+ * @param[in]   pAcc        Accumulator, with the squared deviations.
+ * @param[in]   fracBits    Fractional bits of the values, 4 for 28.4, 31 for q31.
+ * @param[out]  pVariance   count values, in the format of the values.
+ *
+ * @return      Number of values written, 0 if no frame is accumulated or
+ *              the accumulator has no squared deviations.
+ */
+uint32_t average_Variance(const AVERAGE_ACCUMULATOR *pAcc, uint32_t fracBits, int32_t *pVariance) {
+    int64_t                 s, spread;
+    uint32_t                n = pAcc->frames;
+    uint32_t                i;
+
+    if ((0u == n) || (NULL == pAcc->pSumSq)) {
+        return 0;
+    }
+    for (i = 0; i < pAcc->count; i++) {
+        s      = pAcc->pSum[i];
+        spread = (int64_t)pAcc->pSumSq[i] - ((s / (int64_t)n) * s + ((s % (int64_t)n) * s) / (int64_t)n);
+        if (spread < 0) {
+            spread = 0;
+        }
+        pVariance[i] = average_Saturate(average_Divide(spread, n) >> fracBits);
+    }
+
+    return pAcc->count;
+}
+
+/*
+** EOF
+*/
@@ -0,0 +1,67 @@
+/*!
+ *****************************************************************************
+ * @file:   average.h
+ * @brief:  Frame averaging: mean and variance of the values of N frames
+ *
+ * Each value of a frame is accumulated as its deviation from the same value
+ * in the first frame, in 64 bits: the sums stay exact over
+ * AVERAGE_MAX_FRAMES frames as long as deviations fit AVERAGE_MAX_DEVIATION,
+ * larger ones are clamped. The values are any fixed point format, 28.4 or
+ * q31; the variance is returned in the same format, i.e. shifted right by
+ * its fractional bits.
+ *
+ * Angles are averaged on the circle: with average_Wrap(), every stride-th
+ * value is an angle of the given period, its deviation is wrapped into
+ * [-period / 2, period / 2) before it is accumulated and its mean is
+ * wrapped into the same range. +179 and -179 degrees average to -180, with
+ * a variance of 1.
+ *
+ * The caller provides the storage, so a frame-sized accumulator and a
+ * single-measurement one can coexist.
+ *****************************************************************************/
+
+#ifndef __AVERAGE_H__
+#define __AVERAGE_H__
+
+#include <stdint.h>
+
+#include "device.h"
+
+/* C++ linkage */
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Largest ensemble, and the largest deviation from the first frame kept exact */
+#define AVERAGE_MAX_FRAMES          (64u)
+#define AVERAGE_MAX_DEVIATION       (0x0FFFFFFF)
+
+/* Accumulator, the arrays hold capacity values each */
+typedef struct {
+    int32_t                *pFirst;         /*!< Values of the first frame                  */
+    int64_t                *pSum;           /*!< Sums of the deviations                     */
+    uint64_t               *pSumSq;         /*!< Sums of the squared deviations, or NULL    */
+    uint32_t                capacity;       /*!< Values per frame the arrays can hold       */
+    uint32_t                count;          /*!< Values per frame, set by the first frame   */
+    uint32_t                frames;         /*!< Frames accumulated                         */
+    uint32_t                wrapStride;     /*!< Values i % stride == stride - 1 are angles */
+    int32_t                 wrapPeriod;     /*!< Period of the angles, 0 for none           */
+} AVERAGE_ACCUMULATOR;
+
+void                        average_Init            (AVERAGE_ACCUMULATOR *pAcc, int32_t *pFirst, int64_t *pSum,
+                                                     uint64_t *pSumSq, uint32_t capacity);
+void                        average_Wrap            (AVERAGE_ACCUMULATOR *pAcc, uint32_t stride, int32_t period);
+void                        average_Reset           (AVERAGE_ACCUMULATOR *pAcc);
+bool_t                      average_Add             (AVERAGE_ACCUMULATOR *pAcc, const int32_t *pValues, uint32_t count);
+uint32_t                    average_Mean            (const AVERAGE_ACCUMULATOR *pAcc, int32_t *pMean);
+uint32_t                    average_Variance        (const AVERAGE_ACCUMULATOR *pAcc, uint32_t fracBits, int32_t *pVariance);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __AVERAGE_H__ */
+
+/*
+** EOF
+*/
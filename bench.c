@@ -0,0 +1,159 @@
+/*!
+ *****************************************************************************
+ * @file:   bench.c
+ * @brief:  Cycle counts of the stages of the imaging frame loop
+ *
+ * The metrics capture is started once by bench_Begin() and keeps running
+ * until bench_End(); the stages read it with adi_Metric_GetCount(). The
+ * overhead of a mark/stage pair is measured at the start of a run and
+ * reported, it is not subtracted from the stages.
+ *****************************************************************************/
+
+#include <stddef.h>
+#include <string.h>
+
+#include "bench.h"
+
+/* Empty stages timed to measure the overhead, the smallest count is kept */
+#define BENCH_OVERHEAD_SAMPLES      (8u)
+
+/* Set while a run is in progress */
+bool_t                      bench_bActive = false;
+
+static ADI_METRIC_DEV_HANDLE benchMetric;
+/* Count at the last mark and at the start of the frame */
+static uint32_t             benchMark;
+static uint32_t             benchFrameStart;
+/* Counts of the current frame */
+static uint32_t             benchFrame[BENCH_STAGE_COUNT];
+static uint32_t             benchCalls[BENCH_STAGE_COUNT];
+static BENCH_RESULT         benchResult;
+
+static const char *const    benchStageNames[BENCH_STAGE_COUNT] = {
+    "mux", "seq_start", "seq_wait", "capture", "batch", "average", "format", "uart_tx", "other"
+};
+
+static void                 bench_Accumulate        (BENCH_STAGE_STATS *pStats, uint32_t counts, uint32_t calls);
+
+/* Fold the sum of a frame into the statistics of the run */
+static void bench_Accumulate(BENCH_STAGE_STATS *pStats, uint32_t counts, uint32_t calls) {
+    if ((0u == benchResult.frames) || (counts < pStats->min)) {
+        pStats->min = counts;
+    }
+    if (counts > pStats->max) {
+        pStats->max = counts;
+    }
+    pStats->sum   += counts;
+    pStats->calls += calls;
+}
+
+/*!
+ * @brief       Start a run.
+ *
+ * @return      ADI_METRIC_SUCCESS, or ADI_METRIC_ERROR if GP timer 0 is not available.
+ *
+ * @details     GP timer 0 is held until bench_End().
+ */
+ADI_METRIC_RESULT_TYPE bench_Begin(void) {
+    uint32_t                i, counts;
+
+    memset(&benchResult, 0, sizeof(benchResult));
+
+    if (ADI_METRIC_SUCCESS != adi_Metric_Init(ADI_GPT_DEVID_0, &benchMetric)) {
+        return ADI_METRIC_ERROR;
+    }
+    adi_Metric_Start(benchMetric);
+
+    bench_bActive        = true;
+    benchResult.overhead = 0xFFFFFFFFu;
+    for (i = 0; i < BENCH_OVERHEAD_SAMPLES; i++) {
+        BENCH_MARK();
+        counts = adi_Metric_GetCount(benchMetric) - benchMark;
+        if (counts < benchResult.overhead) {
+            benchResult.overhead = counts;
+        }
+    }
+    bench_bActive = false;
+
+    return ADI_METRIC_SUCCESS;
+}
+
+/*!
+ * @brief       Start timing a frame, the stages are only timed inside a frame.
+ */
+void bench_FrameBegin(void) {
+    memset(benchFrame, 0, sizeof(benchFrame));
+    memset(benchCalls, 0, sizeof(benchCalls));
+    bench_bActive   = true;
+    benchFrameStart = adi_Metric_GetCount(benchMetric);
+}
+
+/*!
+ * @brief       End a frame and fold its stage sums into the run.
+ */
+void bench_FrameEnd(void) {
+    uint32_t                total = adi_Metric_GetCount(benchMetric) - benchFrameStart;
+    uint32_t                staged = 0;
+    uint32_t                stage;
+
+    bench_bActive = false;
+
+    for (stage = 0; stage < BENCH_STAGE_OTHER; stage++) {
+        staged += benchFrame[stage];
+    }
+    benchFrame[BENCH_STAGE_OTHER] = (total > staged) ? (total - staged) : 0u;
+
+    for (stage = 0; stage < BENCH_STAGE_COUNT; stage++) {
+        bench_Accumulate(&benchResult.stages[stage], benchFrame[stage], benchCalls[stage]);
+    }
+    bench_Accumulate(&benchResult.frame, total, 1u);
+    benchResult.frames++;
+}
+
+/*!
+ * @brief       End a run.
+ *
+ * @param[out]  pResult     Statistics of the frames measured since bench_Begin().
+ *
+ * @return      ADI_METRIC_SUCCESS, or ADI_METRIC_ERROR if GP timer 0 could not be released.
+ */
+ADI_METRIC_RESULT_TYPE bench_End(BENCH_RESULT *pResult) {
+    bench_bActive = false;
+    adi_Metric_Stop(benchMetric);
+
+    *pResult = benchResult;
+
+    return adi_Metric_UnInit(benchMetric);
+}
+
+/*!
+ * @brief       Start timing a stage, use BENCH_MARK().
+ */
+void bench_Mark(void) {
+    benchMark = adi_Metric_GetCount(benchMetric);
+}
+
+/*!
+ * @brief       Charge the counts since the last mark to a stage, use BENCH_STAGE().
+ *
+ * @param[in]   stage       Stage, not BENCH_STAGE_OTHER.
+ */
+void bench_Stage(BENCH_STAGE_TYPE stage) {
+    benchFrame[stage] += adi_Metric_GetCount(benchMetric) - benchMark;
+    benchCalls[stage]++;
+}
+
+/*!
+ * @brief       Name of a stage, as printed in the benchmark report.
+ *
+ * @param[in]   stage       Stage.
+ *
+ * @return      Stage name, "?" if stage is out of range.
+ */
+const char *bench_StageName(BENCH_STAGE_TYPE stage) {
+    return (stage < BENCH_STAGE_COUNT) ? benchStageNames[stage] : "?";
+}
+
+/*
+** EOF
+*/
@@ -0,0 +1,82 @@
+/*!
+ *****************************************************************************
+ * @file:   bench.h
+ * @brief:  Cycle counts of the stages of the imaging frame loop
+ *
+ * All stages are timed with one metrics capture (GP timer 0, HFOSC cycles):
+ * BENCH_MARK() reads the free running count before a stage and
+ * BENCH_STAGE() charges the counts since the mark to the stage, so stages
+ * cannot nest. Counts are summed per frame, and min/mean/max of the frame
+ * sums are kept over a run. Time spent outside the marked stages is charged
+ * to BENCH_STAGE_OTHER, so the stages of a frame add up to the frame.
+ *
+ * The macros only test a flag when no run is in progress.
+ *****************************************************************************/
+
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#include <stdint.h>
+
+#include "metrics.h"
+
+/* C++ linkage */
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Stages of a frame */
+typedef enum {
+    BENCH_STAGE_MUX = 0,                    /*!< Multiplexer GPIO writes                    */
+    BENCH_STAGE_SEQ_START,                  /*!< adi_AFE_RunSequence() until it returns     */
+    BENCH_STAGE_SEQ_WAIT,                   /*!< Waiting for the sequencer and its results  */
+    BENCH_STAGE_CAPTURE,                    /*!< Copying DFT results into the frame buffer  */
+    BENCH_STAGE_BATCH,                      /*!< zconv_Batch() over the frame buffer        */
+    BENCH_STAGE_AVERAGE,                    /*!< Accumulating and averaging frames          */
+    BENCH_STAGE_FORMAT,                     /*!< ASCII formatting of the values             */
+    BENCH_STAGE_UART_TX,                    /*!< Queuing output, and waiting for Tx room    */
+    BENCH_STAGE_OTHER,                      /*!< Everything else in the frame               */
+    BENCH_STAGE_COUNT
+} BENCH_STAGE_TYPE;
+
+/* Statistics of a stage over a run, in HFOSC cycles per frame */
+typedef struct {
+    uint32_t                calls;          /*!< Stage executions over the run              */
+    uint32_t                min;            /*!< Smallest frame sum                         */
+    uint32_t                max;            /*!< Largest frame sum                          */
+    uint64_t                sum;            /*!< Sum over the run, mean = sum / frames      */
+} BENCH_STAGE_STATS;
+
+/* Result of a run */
+typedef struct {
+    uint32_t                frames;         /*!< Frames measured                            */
+    uint32_t                overhead;       /*!< Counts charged to an empty stage           */
+    BENCH_STAGE_STATS       stages[BENCH_STAGE_COUNT];
+    BENCH_STAGE_STATS       frame;          /*!< Whole frames, calls = frames               */
+} BENCH_RESULT;
+
+/* Set while a run is in progress */
+extern bool_t               bench_bActive;
+
+/* Start timing a stage */
+#define BENCH_MARK()                do { if (bench_bActive) { bench_Mark(); } } while (0)
+/* Charge the counts since BENCH_MARK() to a stage */
+#define BENCH_STAGE(stage)          do { if (bench_bActive) { bench_Stage(stage); } } while (0)
+
+ADI_METRIC_RESULT_TYPE      bench_Begin             (void);
+void                        bench_FrameBegin        (void);
+void                        bench_FrameEnd          (void);
+ADI_METRIC_RESULT_TYPE      bench_End               (BENCH_RESULT *pResult);
+void                        bench_Mark              (void);
+void                        bench_Stage             (BENCH_STAGE_TYPE stage);
+const char                 *bench_StageName         (BENCH_STAGE_TYPE stage);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __BENCH_H__ */
+
+/*
+** EOF
+*/
@@ -0,0 +1,201 @@
+/*!
+ *****************************************************************************
+ * @file:   calcache.c
+ * @brief:  AFE calibration cache in the general purpose flash
+ *
+ * The record is written with its validity stamp last, so a store interrupted
+ * by a reset leaves a page that is simply ignored. The temperature used as
+ * the key is measured with the cached temperature sensor codes, which are
+ * restored first.
+ *****************************************************************************/
+
+#include <stddef.h>
+
+#include "calcache.h"
+
+/* Record layout version, to be changed with CALCACHE_RECORD */
+#define CALCACHE_VERSION            (1u)
+/* Validity stamp, "CALC" */
+#define CALCACHE_STAMP              (0x434C4143u)
+/* Calibration registers held by a record */
+#define CALCACHE_REG_COUNT          (7u)
+
+/* Calibration register and the calibration that produces it */
+typedef struct {
+    uint32_t                cal;
+    ADI_AFE_CAL_REG_TYPE    reg;
+} CALCACHE_REG;
+
+/* Flash record */
+typedef struct {
+    uint32_t                version;                    /*!< CALCACHE_VERSION                   */
+    int32_t                 temperature;                /*!< Die temperature at calibration     */
+    uint32_t                cals;                       /*!< Calibrations held by the record    */
+    uint32_t                codes[CALCACHE_REG_COUNT];  /*!< Codes, in calcache_regs order      */
+    uint32_t                check;                      /*!< Complement of the sum of the above */
+    uint32_t                stamp;                      /*!< CALCACHE_STAMP, written last       */
+} CALCACHE_RECORD;
+
+/* Temperature sensor registers first, they are needed to measure the key */
+static const CALCACHE_REG   calcache_regs[CALCACHE_REG_COUNT] = {
+    { CALCACHE_CAL_TEMP_SENS,    ADI_AFE_CAL_REG_ADC_GAIN_TEMP_SENS   },
+    { CALCACHE_CAL_TEMP_SENS,    ADI_AFE_CAL_REG_ADC_OFFSET_TEMP_SENS },
+    { CALCACHE_CAL_AUX,          ADI_AFE_CAL_REG_ADC_GAIN_AUX         },
+    { CALCACHE_CAL_AUX,          ADI_AFE_CAL_REG_ADC_OFFSET_AUX       },
+    { CALCACHE_CAL_TIA,          ADI_AFE_CAL_REG_ADC_GAIN_TIA         },
+    { CALCACHE_CAL_TIA,          ADI_AFE_CAL_REG_ADC_OFFSET_TIA       },
+    { CALCACHE_CAL_EXCITE_ATTEN, ADI_AFE_CAL_REG_DAC_OFFSET_ATTEN     },
+};
+
+static uint32_t             calcache_Check          (const CALCACHE_RECORD *pRecord);
+static const CALCACHE_RECORD *calcache_Record       (void);
+static bool_t               calcache_Drifted        (int32_t cached, int32_t current);
+
+/* Complement of the sum of the record words before the check word */
+static uint32_t calcache_Check(const CALCACHE_RECORD *pRecord) {
+    const uint32_t         *pWord = (const uint32_t *)pRecord;
+    uint32_t                sum   = 0;
+    uint32_t                i;
+
+    for (i = 0; i < (offsetof(CALCACHE_RECORD, check) / sizeof(uint32_t)); i++) {
+        sum += pWord[i];
+    }
+
+    return ~sum;
+}
+
+/* The record in flash, NULL if the page holds no valid record */
+static const CALCACHE_RECORD *calcache_Record(void) {
+    const CALCACHE_RECORD  *pRecord = (const CALCACHE_RECORD *)CALCACHE_ADDRESS;
+
+    if ((CALCACHE_STAMP != pRecord->stamp) || (CALCACHE_VERSION != pRecord->version) ||
+        (calcache_Check(pRecord) != pRecord->check)) {
+        return NULL;
+    }
+
+    return pRecord;
+}
+
+static bool_t calcache_Drifted(int32_t cached, int32_t current) {
+    int32_t                 drift = current - cached;
+
+    return ((drift > CALCACHE_MAX_DRIFT_DEGC) || (drift < -CALCACHE_MAX_DRIFT_DEGC)) ? true : false;
+}
+
+/*!
+ * @brief       Restore cached calibration codes into the AFE.
+ *
+ * @param[in]   hDevice     AFE device handle, powered up.
+ * @param[in]   cals        CALCACHE_CAL_* calibrations needed.
+ *
+ * @return      true if all the calibrations were restored, false if they
+ *              must be run (no record, missing calibrations, temperature
+ *              drift or AFE error). The temperature sensor codes may have
+ *              been written in the latter case.
+ *
+ * @details     Must be called before the calibrations would run, the codes
+ *              are written with adi_AFE_WriteCalibrationRegister().
+ */
+bool_t calcache_Restore(ADI_AFE_DEV_HANDLE hDevice, uint32_t cals) {
+    const CALCACHE_RECORD  *pRecord = calcache_Record();
+    int32_t                 temperature;
+    uint32_t                i;
+
+    cals |= CALCACHE_CAL_TEMP_SENS;
+
+    if ((NULL == pRecord) || ((pRecord->cals & cals) != cals)) {
+        return false;
+    }
+
+    /* The temperature sensor codes are needed to measure the key */
+    for (i = 0; i < CALCACHE_REG_COUNT; i++) {
+        if (CALCACHE_CAL_TEMP_SENS == calcache_regs[i].cal) {
+            if (ADI_AFE_SUCCESS != adi_AFE_WriteCalibrationRegister(hDevice, calcache_regs[i].reg, pRecord->codes[i])) {
+                return false;
+            }
+        }
+    }
+
+    if ((ADI_AFE_SUCCESS != adi_AFE_TempSensMeas(hDevice, &temperature)) ||
+        calcache_Drifted(pRecord->temperature, temperature)) {
+        return false;
+    }
+
+    for (i = 0; i < CALCACHE_REG_COUNT; i++) {
+        if ((calcache_regs[i].cal & cals) && (CALCACHE_CAL_TEMP_SENS != calcache_regs[i].cal)) {
+            if (ADI_AFE_SUCCESS != adi_AFE_WriteCalibrationRegister(hDevice, calcache_regs[i].reg, pRecord->codes[i])) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/*!
+ * @brief       Store the calibration codes currently in the AFE.
+ *
+ * @param[in]   hDevice     AFE device handle.
+ * @param[in]   cals        CALCACHE_CAL_* calibrations that have just been run,
+ *                          the temperature sensor one included.
+ *
+ * @return      false if the AFE or the flash reported an error.
+ *
+ * @details     Calibrations of the previous record that were not run are kept
+ *              when the temperature has not drifted since they were stored,
+ *              so the modes needing different calibrations share the record.
+ */
+bool_t calcache_Store(ADI_AFE_DEV_HANDLE hDevice, uint32_t cals) {
+    const CALCACHE_RECORD  *pPrevious = calcache_Record();
+    CALCACHE_RECORD         record;
+    ADI_FEE_DEV_HANDLE      hFlash;
+    ADI_FEE_RESULT_TYPE     result;
+    uint32_t                i;
+
+    cals |= CALCACHE_CAL_TEMP_SENS;
+
+    record.version = CALCACHE_VERSION;
+    record.cals    = cals;
+    if (ADI_AFE_SUCCESS != adi_AFE_TempSensMeas(hDevice, &record.temperature)) {
+        return false;
+    }
+
+    if ((NULL != pPrevious) && !calcache_Drifted(pPrevious->temperature, record.temperature)) {
+        record.cals |= pPrevious->cals;
+    }
+
+    for (i = 0; i < CALCACHE_REG_COUNT; i++) {
+        record.codes[i] = 0;
+        if (calcache_regs[i].cal & cals) {
+            if (ADI_AFE_SUCCESS != adi_AFE_ReadCalibrationRegister(hDevice, calcache_regs[i].reg, &record.codes[i])) {
+                return false;
+            }
+        }
+        else if (calcache_regs[i].cal & record.cals) {
+            record.codes[i] = pPrevious->codes[i];
+        }
+    }
+    record.check = calcache_Check(&record);
+    record.stamp = CALCACHE_STAMP;
+
+    if (ADI_FEE_SUCCESS != adi_FEE_Init(ADI_FEE_DEVID_GP, true, &hFlash)) {
+        return false;
+    }
+
+    result = adi_FEE_PageErase(hFlash, CALCACHE_PAGE);
+    if (ADI_FEE_SUCCESS == result) {
+        result = adi_FEE_Write(hFlash, CALCACHE_ADDRESS, (const uint8_t *)&record, offsetof(CALCACHE_RECORD, stamp));
+    }
+    if (ADI_FEE_SUCCESS == result) {
+        result = adi_FEE_Write(hFlash, CALCACHE_ADDRESS + offsetof(CALCACHE_RECORD, stamp),
+                               (const uint8_t *)&record.stamp, sizeof(record.stamp));
+    }
+
+    adi_FEE_UnInit(hFlash);
+
+    return (ADI_FEE_SUCCESS == result) ? true : false;
+}
+
+/*
+** EOF
+*/
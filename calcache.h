@@ -0,0 +1,54 @@
+/*!
+ *****************************************************************************
+ * @file:   calcache.h
+ * @brief:  AFE calibration cache in the general purpose flash
+ *
+ * The gain and offset codes produced by the AFE channel calibrations are
+ * kept in the last page of the general purpose flash, together with the die
+ * temperature they were measured at. A mode switch restores them instead of
+ * re-running the calibrations, unless the temperature has drifted by more
+ * than CALCACHE_MAX_DRIFT_DEGC since they were stored.
+ *****************************************************************************/
+
+#ifndef __CALCACHE_H__
+#define __CALCACHE_H__
+
+#include <stdint.h>
+
+#include "afe.h"
+#include "afe_lib.h"
+#include "flash.h"
+
+/* C++ linkage */
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Calibrations held by the cache, the temperature sensor one is always included */
+#define CALCACHE_CAL_TEMP_SENS      (0x01u)     /*!< adi_AFE_TempSensChanCal    */
+#define CALCACHE_CAL_AUX            (0x02u)     /*!< adi_AFE_AuxChanCal         */
+#define CALCACHE_CAL_TIA            (0x04u)     /*!< adi_AFE_TiaChanCal         */
+#define CALCACHE_CAL_EXCITE_ATTEN   (0x08u)     /*!< adi_AFE_ExciteChanCalAtten */
+
+/* Largest temperature change, in degrees Celsius, over which cached codes are reused */
+#ifndef CALCACHE_MAX_DRIFT_DEGC
+#define CALCACHE_MAX_DRIFT_DEGC     (3)
+#endif
+
+/* General purpose flash page holding the cache: the last of the 16k bytes */
+#define CALCACHE_PAGE               (31u)
+#define CALCACHE_PAGE_SIZE          (512u)
+#define CALCACHE_ADDRESS            (0x20080000u + CALCACHE_PAGE * CALCACHE_PAGE_SIZE)
+
+bool_t                      calcache_Restore        (ADI_AFE_DEV_HANDLE hDevice, uint32_t cals);
+bool_t                      calcache_Store          (ADI_AFE_DEV_HANDLE hDevice, uint32_t cals);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __CALCACHE_H__ */
+
+/*
+** EOF
+*/
@@ -0,0 +1,310 @@
+/*!
+ *****************************************************************************
+ * @file:   command.c
+ * @brief:  Framed binary command protocol on the UART receive stream
+ *
+ * The parser keeps no buffer besides the request being received: the header
+ * and payload bytes go straight into it and the CRC is updated on the fly.
+ * Outside of a frame it only counts the characters of the current line, for
+ * the menu keys.
+ *****************************************************************************/
+
+#include <stddef.h>
+#include <string.h>
+
+#include "command.h"
+#include "eit_stream.h"
+
+/* Parser states */
+#define COMMAND_STATE_LINE          (0u)        /* between frames, menu keys    */
+#define COMMAND_STATE_SYNC          (1u)        /* COMMAND_SYNC0 received       */
+#define COMMAND_STATE_HEADER        (2u)        /* version, opcode, tag, length */
+#define COMMAND_STATE_PAYLOAD       (3u)
+#define COMMAND_STATE_CRC           (4u)
+
+/* Header bytes after the sync */
+#define COMMAND_HEADER_SIZE         (4u)
+
+/* Payload length of each opcode, COMMAND_LENGTH_ANY for PING */
+#define COMMAND_LENGTH_ANY          (0xFFu)
+#define COMMAND_OPCODES             (COMMAND_OPCODE_STOP + 1u)
+static const uint8_t        commandLength[COMMAND_OPCODES] = {
+    0u,                     /* unused        */
+    COMMAND_LENGTH_ANY,     /* PING          */
+    0u,                     /* GET_STATUS    */
+    1u,                     /* SET_MODE      */
+    1u,                     /* SET_OUTPUT    */
+    1u,                     /* SET_VALUES    */
+    2u,                     /* SET_AVERAGE   */
+    2u,                     /* SET_OPTION    */
+    4u,                     /* SET_FREQUENCY */
+    0u,                     /* START         */
+    0u,                     /* STOP          */
+};
+
+static COMMAND_EVENT_TYPE   command_Line            (COMMAND_PARSER *pParser, uint8_t byte);
+static COMMAND_EVENT_TYPE   command_End             (COMMAND_PARSER *pParser);
+
+/* A byte between frames: a line of one character is a menu key, '\r' is ignored */
+static COMMAND_EVENT_TYPE command_Line(COMMAND_PARSER *pParser, uint8_t byte) {
+    if ('\n' == byte) {
+        byte = pParser->lineLength;
+        pParser->lineLength = 0;
+        return (1u == byte) ? COMMAND_EVENT_KEY : COMMAND_EVENT_NONE;
+    }
+    if ('\r' != byte) {
+        if (pParser->lineLength < 2u) {
+            pParser->lineLength++;
+        }
+        pParser->key = byte;
+    }
+    return COMMAND_EVENT_NONE;
+}
+
+/* The CRC of a frame is in: a request, or an error to answer */
+static COMMAND_EVENT_TYPE command_End(COMMAND_PARSER *pParser) {
+    uint8_t                 status;
+
+    pParser->state      = COMMAND_STATE_LINE;
+    pParser->lineLength = 0;
+
+    if (pParser->crc != pParser->received) {
+        status = COMMAND_STATUS_BAD_CRC;
+    }
+    else if (COMMAND_VERSION != pParser->request.version) {
+        status = COMMAND_STATUS_BAD_VERSION;
+    }
+    else {
+        status = command_Check(&pParser->request);
+    }
+    if (COMMAND_STATUS_OK == status) {
+        return COMMAND_EVENT_REQUEST;
+    }
+
+    pParser->status = status;
+    pParser->errors++;
+    return COMMAND_EVENT_ERROR;
+}
+
+/*!
+ * @brief       Start parsing at the beginning of a line.
+ *
+ * @param[out]  pParser     Parser.
+ */
+void command_Init(COMMAND_PARSER *pParser) {
+    memset(pParser, 0, sizeof(*pParser));
+    pParser->state = COMMAND_STATE_LINE;
+}
+
+/*!
+ * @brief       Parse one received byte.
+ *
+ * @param[in]   pParser     Parser.
+ * @param[in]   byte        Byte, in order of arrival.
+ *
+ * @return      COMMAND_EVENT_KEY with the key in pParser->key,
+ *              COMMAND_EVENT_REQUEST with a request that passed
+ *              command_Check() in pParser->request, COMMAND_EVENT_ERROR
+ *              with the status to answer in pParser->status, or
+ *              COMMAND_EVENT_NONE. The request stays valid until the
+ *              next byte.
+ */
+COMMAND_EVENT_TYPE command_Parse(COMMAND_PARSER *pParser, uint8_t byte) {
+    COMMAND_REQUEST        *pRequest = &pParser->request;
+    COMMAND_EVENT_TYPE      event;
+
+    switch (pParser->state) {
+    case COMMAND_STATE_SYNC:
+        if (COMMAND_REQUEST_SYNC1 == byte) {
+            pParser->state = COMMAND_STATE_HEADER;
+            pParser->count = 0;
+            pParser->crc   = 0xFFFFu;
+            return COMMAND_EVENT_NONE;
+        }
+        /* Not a frame: the sync byte was a character of the line */
+        pParser->state = COMMAND_STATE_LINE;
+        event = command_Line(pParser, COMMAND_SYNC0);
+        if (COMMAND_SYNC0 == byte) {
+            pParser->state = COMMAND_STATE_SYNC;
+            return event;
+        }
+        return command_Line(pParser, byte);
+
+    case COMMAND_STATE_HEADER:
+        pParser->crc = stream_Crc16(pParser->crc, &byte, 1u);
+        switch (pParser->count++) {
+        case 0:  pRequest->version = byte; break;
+        case 1:  pRequest->opcode  = byte; break;
+        case 2:  pRequest->tag     = byte; break;
+        default: pRequest->length  = byte; break;
+        }
+        if (COMMAND_HEADER_SIZE == pParser->count) {
+            if (pRequest->length > COMMAND_MAX_PAYLOAD) {
+                /* No way to tell where the frame ends, parse on from here */
+                pParser->state      = COMMAND_STATE_LINE;
+                pParser->lineLength = 0;
+                pParser->status     = COMMAND_STATUS_BAD_LENGTH;
+                pParser->errors++;
+                return COMMAND_EVENT_ERROR;
+            }
+            pParser->state = (pRequest->length > 0u) ? COMMAND_STATE_PAYLOAD : COMMAND_STATE_CRC;
+            pParser->count = 0;
+        }
+        return COMMAND_EVENT_NONE;
+
+    case COMMAND_STATE_PAYLOAD:
+        pParser->crc = stream_Crc16(pParser->crc, &byte, 1u);
+        pRequest->payload[pParser->count++] = byte;
+        if (pRequest->length == pParser->count) {
+            pParser->state = COMMAND_STATE_CRC;
+            pParser->count = 0;
+        }
+        return COMMAND_EVENT_NONE;
+
+    case COMMAND_STATE_CRC:
+        if (0u == pParser->count++) {
+            pParser->received = byte;
+            return COMMAND_EVENT_NONE;
+        }
+        pParser->received |= (uint16_t)byte << 8;
+        return command_End(pParser);
+
+    default:
+        if (COMMAND_SYNC0 == byte) {
+            pParser->state = COMMAND_STATE_SYNC;
+            return COMMAND_EVENT_NONE;
+        }
+        return command_Line(pParser, byte);
+    }
+}
+
+/*!
+ * @brief       Whether a frame is being received.
+ *
+ * @param[in]   pParser     Parser.
+ *
+ * @return      1 between the sync and the CRC of a frame, 0 between frames.
+ */
+uint8_t command_Pending(const COMMAND_PARSER *pParser) {
+    return (COMMAND_STATE_LINE == pParser->state) ? 0u : 1u;
+}
+
+/*!
+ * @brief       No byte was received for COMMAND_TIMEOUT_US.
+ *
+ * @param[in]   pParser     Parser.
+ *
+ * @details     A frame cut short is dropped and counted in errors, its
+ *              opcode and tag may be missing so it is not answered. The
+ *              parser starts a new line, ready for the sync of the next
+ *              request.
+ */
+void command_Timeout(COMMAND_PARSER *pParser) {
+    if (COMMAND_STATE_LINE != pParser->state) {
+        pParser->errors++;
+    }
+    pParser->state      = COMMAND_STATE_LINE;
+    pParser->lineLength = 0;
+}
+
+/*!
+ * @brief       Check the opcode and the payload length of a request.
+ *
+ * @param[in]   pRequest    Request.
+ *
+ * @return      COMMAND_STATUS_OK, COMMAND_STATUS_BAD_OPCODE or
+ *              COMMAND_STATUS_BAD_LENGTH. The payload values are checked
+ *              when the request is executed.
+ */
+COMMAND_STATUS_TYPE command_Check(const COMMAND_REQUEST *pRequest) {
+    uint8_t                 length;
+
+    if ((0u == pRequest->opcode) || (pRequest->opcode >= COMMAND_OPCODES)) {
+        return COMMAND_STATUS_BAD_OPCODE;
+    }
+    length = commandLength[pRequest->opcode];
+    if ((COMMAND_LENGTH_ANY != length) && (length != pRequest->length)) {
+        return COMMAND_STATUS_BAD_LENGTH;
+    }
+    return COMMAND_STATUS_OK;
+}
+
+/*!
+ * @brief       Build a request frame, as the host sends it.
+ *
+ * @param[out]  pOut        COMMAND_REQUEST_OVERHEAD + length bytes.
+ * @param[in]   opcode      Opcode.
+ * @param[in]   tag         Tag.
+ * @param[in]   pPayload    Payload, NULL if length is 0.
+ * @param[in]   length      Payload length, at most COMMAND_MAX_PAYLOAD.
+ *
+ * @return      Frame size in bytes.
+ */
+uint16_t command_Request(uint8_t *pOut, uint8_t opcode, uint8_t tag, const uint8_t *pPayload, uint8_t length) {
+    uint16_t                crc;
+
+    pOut[0] = COMMAND_SYNC0;
+    pOut[1] = COMMAND_REQUEST_SYNC1;
+    pOut[2] = COMMAND_VERSION;
+    pOut[3] = opcode;
+    pOut[4] = tag;
+    pOut[5] = length;
+    if (length > 0u) {
+        memcpy(&pOut[6], pPayload, length);
+    }
+    crc = stream_Crc16(0xFFFFu, &pOut[2], (uint16_t)(4u + length));
+    command_PutU16(&pOut[6u + length], crc);
+
+    return (uint16_t)(COMMAND_REQUEST_OVERHEAD + length);
+}
+
+/*!
+ * @brief       Build a response frame.
+ *
+ * @param[out]  pOut        COMMAND_RESPONSE_OVERHEAD + length bytes.
+ * @param[in]   opcode      Opcode of the request.
+ * @param[in]   tag         Tag of the request.
+ * @param[in]   status      COMMAND_STATUS_TYPE.
+ * @param[in]   pPayload    Payload, NULL if length is 0.
+ * @param[in]   length      Payload length, at most COMMAND_MAX_PAYLOAD.
+ *
+ * @return      Frame size in bytes.
+ */
+uint16_t command_Response(uint8_t *pOut, uint8_t opcode, uint8_t tag, uint8_t status,
+                          const uint8_t *pPayload, uint8_t length) {
+    uint16_t                crc;
+
+    pOut[0] = COMMAND_SYNC0;
+    pOut[1] = COMMAND_RESPONSE_SYNC1;
+    pOut[2] = COMMAND_VERSION;
+    pOut[3] = opcode;
+    pOut[4] = tag;
+    pOut[5] = status;
+    pOut[6] = length;
+    if (length > 0u) {
+        memcpy(&pOut[7], pPayload, length);
+    }
+    crc = stream_Crc16(0xFFFFu, &pOut[2], (uint16_t)(5u + length));
+    command_PutU16(&pOut[7u + length], crc);
+
+    return (uint16_t)(COMMAND_RESPONSE_OVERHEAD + length);
+}
+
+/* Little-endian payload fields */
+uint32_t command_GetU32(const uint8_t *pData) {
+    return (uint32_t)pData[0] | ((uint32_t)pData[1] << 8) | ((uint32_t)pData[2] << 16) | ((uint32_t)pData[3] << 24);
+}
+
+void command_PutU16(uint8_t *pData, uint16_t value) {
+    pData[0] = (uint8_t)value;
+    pData[1] = (uint8_t)(value >> 8);
+}
+
+void command_PutU32(uint8_t *pData, uint32_t value) {
+    command_PutU16(&pData[0], (uint16_t)value);
+    command_PutU16(&pData[2], (uint16_t)(value >> 16));
+}
+
+/*
+** EOF
+*/
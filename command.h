@@ -0,0 +1,199 @@
+/*!
+ *****************************************************************************
+ * @file:   command.h
+ * @brief:  Framed binary command protocol on the UART receive stream
+ *
+ * Request frame (all fields little-endian):
+ *
+ *      offset  size    field
+ *      0       2       sync, COMMAND_SYNC0 COMMAND_REQUEST_SYNC1 ("EC")
+ *      2       1       protocol version, COMMAND_VERSION
+ *      3       1       opcode
+ *      4       1       tag, chosen by the host and echoed in the response
+ *      5       1       payload length L, at most COMMAND_MAX_PAYLOAD
+ *      6       L       payload
+ *      6+L     2       CRC-16/CCITT (0x1021, init 0xFFFF) of bytes 2 .. 5+L
+ *
+ * Every request is answered by one response frame, once it is executed:
+ *
+ *      offset  size    field
+ *      0       2       sync, COMMAND_SYNC0 COMMAND_RESPONSE_SYNC1 ("ER")
+ *      2       1       protocol version, COMMAND_VERSION
+ *      3       1       opcode of the request
+ *      4       1       tag of the request
+ *      5       1       status, COMMAND_STATUS_TYPE
+ *      6       1       payload length L
+ *      7       L       payload
+ *      7+L     2       CRC-16/CCITT of bytes 2 .. 6+L
+ *
+ * The CRC is the one of the measurement frames, see eit_stream.h, whose
+ * "EI" sync the host decoder keeps apart from the "ER" of the responses.
+ * The responses go out on the UART between two frames, also when the frames
+ * go to USB.
+ *
+ * Opcodes and payloads:
+ *
+ *      opcode                  request                     response
+ *      PING                    0 .. COMMAND_MAX_PAYLOAD    the request payload
+ *      GET_STATUS              none                        COMMAND_REPORT_SIZE, below
+ *      SET_MODE                u8 mode, 1 .. 8             none
+ *      SET_OUTPUT              u8 COMMAND_OUTPUT_*         none
+ *      SET_VALUES              u8 ZCONV_FORMAT_TYPE        none
+ *      SET_AVERAGE             u8 log2 of the frames 0..6, none
+ *                              u8 variance frames 0 or 1
+ *      SET_OPTION              u8 COMMAND_OPTION_*,        none
+ *                              u8 value
+ *      SET_FREQUENCY           u32 excitation in Hz        none
+ *      START, STOP             none                        none
+ *
+ * The GET_STATUS payload:
+ *
+ *      offset  size    field
+ *      0       1       measurement mode
+ *      1       1       1 while measuring, 0 once stopped
+ *      2       1       output format, COMMAND_OUTPUT_*
+ *      3       1       values of the mode, ZCONV_FORMAT_TYPE
+ *      4       4       excitation frequency of the single frequency 4-wire modes, Hz
+ *      8       2       frames averaged per output
+ *      10      1       options, COMMAND_REPORT_*
+ *      11      1       measurement plan, COMMAND_OPTION_PLAN values
+ *      12      2       receive bytes dropped by the UART driver, modulo 2^16
+ *      14      2       requests answered with an error or dropped, modulo 2^16
+ *      16      2       transmit bytes dropped by the UART driver, modulo 2^16
+ *
+ * The single character menu of the firmware stays available on the same
+ * stream: a line holding one character, "k\n", is a menu key. A frame is
+ * parsed as soon as its sync is seen, its bytes are never menu keys. A
+ * frame that fails its CRC is answered with COMMAND_STATUS_BAD_CRC, with the
+ * opcode and tag as received, and the bytes after it are parsed from a new
+ * line: the host sends its next request once the response is in, and
+ * repeats a request that was not answered. A request cut short, with no
+ * byte for COMMAND_TIMEOUT_US, is dropped unanswered and counted as an
+ * error (command_Timeout()), so the next request parses from its sync. The
+ * firmware reads the stream between frames: the gap is timed from the
+ * last byte read there, and a request that follows the bytes of a cut one
+ * within the same frame still completes it, and is answered with an error.
+ *
+ * While a request runs, the firmware prints no text on the stream: a mode
+ * that cannot be set up is answered with COMMAND_STATUS_BAD_STATE.
+ *****************************************************************************/
+
+#ifndef __COMMAND_H__
+#define __COMMAND_H__
+
+#include <stdint.h>
+
+/* C++ linkage */
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#define COMMAND_SYNC0               (0x45u)     /* 'E' */
+#define COMMAND_REQUEST_SYNC1       (0x43u)     /* 'C' */
+#define COMMAND_RESPONSE_SYNC1      (0x52u)     /* 'R' */
+#define COMMAND_VERSION             (1u)
+#define COMMAND_MAX_PAYLOAD         (32u)
+#define COMMAND_REQUEST_OVERHEAD    (8u)
+#define COMMAND_RESPONSE_OVERHEAD   (9u)
+#define COMMAND_RESPONSE_MAX_SIZE   (COMMAND_RESPONSE_OVERHEAD + COMMAND_MAX_PAYLOAD)
+/* Gap between two bytes of a frame after which the frame is dropped, 115 bytes at 115200 baud */
+#define COMMAND_TIMEOUT_US          (10000u)
+
+typedef enum {
+    COMMAND_OPCODE_PING             = 0x01,     /*!< Echo the payload                           */
+    COMMAND_OPCODE_GET_STATUS       = 0x02,     /*!< Report the acquisition settings            */
+    COMMAND_OPCODE_SET_MODE         = 0x03,     /*!< Switch the measurement mode                */
+    COMMAND_OPCODE_SET_OUTPUT       = 0x04,     /*!< ASCII or binary frames                     */
+    COMMAND_OPCODE_SET_VALUES       = 0x05,     /*!< Values of the current mode                 */
+    COMMAND_OPCODE_SET_AVERAGE      = 0x06,     /*!< Frames averaged per output, variance       */
+    COMMAND_OPCODE_SET_OPTION       = 0x07,     /*!< Turn an imaging option on or off           */
+    COMMAND_OPCODE_SET_FREQUENCY    = 0x08,     /*!< Excitation of the single frequency modes   */
+    COMMAND_OPCODE_START            = 0x09,     /*!< Measure in the current mode                */
+    COMMAND_OPCODE_STOP             = 0x0A,     /*!< Stop measuring, keep the settings          */
+} COMMAND_OPCODE_TYPE;
+
+typedef enum {
+    COMMAND_STATUS_OK               = 0,        /*!< Executed                                   */
+    COMMAND_STATUS_BAD_CRC          = 1,        /*!< CRC mismatch, the request is dropped       */
+    COMMAND_STATUS_BAD_VERSION      = 2,        /*!< Unknown protocol version                   */
+    COMMAND_STATUS_BAD_OPCODE       = 3,        /*!< Unknown opcode                             */
+    COMMAND_STATUS_BAD_LENGTH       = 4,        /*!< Wrong payload length for the opcode        */
+    COMMAND_STATUS_BAD_VALUE        = 5,        /*!< A payload value is out of range            */
+    COMMAND_STATUS_BAD_STATE        = 6,        /*!< Not available in the current mode          */
+} COMMAND_STATUS_TYPE;
+
+/* SET_OUTPUT values */
+#define COMMAND_OUTPUT_ASCII        (0u)        /* sprintf'd values                             */
+#define COMMAND_OUTPUT_FIXED32      (1u)        /* eit_stream frames, 28.4                      */
+#define COMMAND_OUTPUT_Q31          (2u)        /* eit_stream frames, raw q31                   */
+
+/* SET_OPTION options, the value is 0 (off) or 1 (on) unless noted */
+#define COMMAND_OPTION_BLOCKS       (0u)        /* several quads per sequencer program          */
+#define COMMAND_OPTION_RANGING      (1u)        /* excitation amplitude ranged per quad         */
+#define COMMAND_OPTION_GROUPED      (2u)        /* quads grouped by injection pair              */
+#define COMMAND_OPTION_DELTA        (3u)        /* binary frames as residuals                   */
+#define COMMAND_OPTION_PLAN         (4u)        /* 0 full, 1 reduced, 2 reduced with QA frames  */
+#define COMMAND_OPTION_TIMESTAMPS   (5u)        /* records stamped with the microsecond tick    */
+
+/* GET_STATUS payload size and options */
+#define COMMAND_REPORT_SIZE         (18u)
+#define COMMAND_REPORT_VARIANCE     (0x01u)
+#define COMMAND_REPORT_BLOCKS       (0x02u)
+#define COMMAND_REPORT_RANGING      (0x04u)
+#define COMMAND_REPORT_GROUPED      (0x08u)
+#define COMMAND_REPORT_DELTA        (0x10u)
+#define COMMAND_REPORT_USB          (0x20u)
+#define COMMAND_REPORT_TIMESTAMPS   (0x40u)
+
+/* Parser output for one received byte */
+typedef enum {
+    COMMAND_EVENT_NONE              = 0,        /*!< Nothing complete yet                       */
+    COMMAND_EVENT_KEY               = 1,        /*!< A menu key, in key                         */
+    COMMAND_EVENT_REQUEST           = 2,        /*!< A well-formed request, in request          */
+    COMMAND_EVENT_ERROR             = 3,        /*!< A bad request, to answer with status       */
+} COMMAND_EVENT_TYPE;
+
+/* Request of a COMMAND_EVENT_REQUEST or COMMAND_EVENT_ERROR */
+typedef struct {
+    uint8_t                 version;
+    uint8_t                 opcode;
+    uint8_t                 tag;
+    uint8_t                 length;
+    uint8_t                 payload[COMMAND_MAX_PAYLOAD];
+} COMMAND_REQUEST;
+
+/* Parser state, fed one byte at a time */
+typedef struct {
+    uint8_t                 state;          /*!< Field being received                       */
+    uint8_t                 count;          /*!< Bytes received of the frame or field       */
+    uint8_t                 lineLength;     /*!< Characters of the current line, up to 2    */
+    uint8_t                 key;            /*!< Menu key of a COMMAND_EVENT_KEY            */
+    uint8_t                 status;         /*!< Status of a COMMAND_EVENT_ERROR            */
+    uint16_t                crc;            /*!< CRC of the frame so far                    */
+    uint16_t                received;       /*!< CRC sent with the frame                    */
+    uint16_t                errors;         /*!< Bad requests, modulo 2^16                  */
+    COMMAND_REQUEST         request;        /*!< Frame being received, or the last one      */
+} COMMAND_PARSER;
+
+void                        command_Init            (COMMAND_PARSER *pParser);
+COMMAND_EVENT_TYPE          command_Parse           (COMMAND_PARSER *pParser, uint8_t byte);
+uint8_t                     command_Pending         (const COMMAND_PARSER *pParser);
+void                        command_Timeout         (COMMAND_PARSER *pParser);
+COMMAND_STATUS_TYPE         command_Check           (const COMMAND_REQUEST *pRequest);
+uint16_t                    command_Request         (uint8_t *pOut, uint8_t opcode, uint8_t tag,
+                                                     const uint8_t *pPayload, uint8_t length);
+uint16_t                    command_Response        (uint8_t *pOut, uint8_t opcode, uint8_t tag, uint8_t status,
+                                                     const uint8_t *pPayload, uint8_t length);
+uint32_t                    command_GetU32          (const uint8_t *pData);
+void                        command_PutU16          (uint8_t *pData, uint16_t value);
+void                        command_PutU32          (uint8_t *pData, uint32_t value);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __COMMAND_H__ */
+
+/*
+** EOF
+*/
@@ -0,0 +1,546 @@
+/*!
+ *****************************************************************************
+ * @file:   eit_stream.c
+ * @brief:  Binary framed streaming protocol for EIT measurements
+ *
+ * Frames are streamed as the values are produced, so no frame-sized buffer
+ * is needed: the header goes out in stream_FrameBegin(), the values are
+ * batched in a small staging buffer and the CRC is updated on the fly.
+ *
+ * With delta frames on, the header of a frame started by stream_FrameBegin()
+ * waits for its values: stream_FrameValues() measures both encodings of the
+ * residuals in a first pass, then sends the header and the smaller one in a
+ * second pass, updating the reference as it goes. Only the reference is
+ * kept, not the encoded frame.
+ *
+ * With timestamps on, the time field is coded when the header is sent, from
+ * the tick last given to stream_SetTime().
+ *****************************************************************************/
+
+#include <stddef.h>
+
+#include "eit_stream.h"
+
+/* Staging buffer size, a multiple of the 4-byte payload values */
+#define STREAM_STAGING_SIZE         (64u)
+
+static STREAM_WRITE_FN      streamWrite = NULL;
+static uint8_t              staging[STREAM_STAGING_SIZE];
+static uint16_t             stagingCount;
+static uint16_t             frameCrc;
+static uint16_t             frameRemaining;
+static uint32_t             frameSequence;
+static uint8_t              frameReduced;
+
+/* Delta frames: reference frame, its layout and sequence number, see eit_stream.h */
+static int32_t             *pDeltaReference = NULL;
+static uint16_t             deltaCapacity;
+static uint16_t             deltaKeyFrames;
+static uint16_t             deltaSinceKey;
+static uint8_t              deltaValid;
+static uint8_t              deltaFlags;
+static uint8_t              deltaMode;
+static uint8_t              deltaNel;
+static uint16_t             deltaCount;
+static uint32_t             deltaSequence;
+
+/* Header of a frame waiting for its values, to be sent as a key or a delta frame */
+static uint8_t              pendingValid;
+static uint8_t              pendingFlags;
+static uint8_t              pendingMode;
+static uint8_t              pendingNel;
+static uint16_t             pendingCount;
+static uint32_t             pendingFrequency;
+
+/* Timestamps: tick of the next frames and its coder */
+static STREAM_TIME_CODER    frameTime;
+static uint32_t             frameTick;
+
+/* Residual encoder state */
+static uint32_t             payloadBytes;
+static uint64_t             packedBits;
+static uint32_t             packedCount;
+
+static void                 stream_Flush            (void);
+static void                 stream_PutU8            (uint8_t value);
+static void                 stream_PutU16           (uint16_t value);
+static void                 stream_PutU32           (uint32_t value);
+static void                 stream_Header           (uint8_t mode, uint8_t n_el, uint8_t flags,
+                                                     uint16_t count, uint32_t frequency);
+static void                 stream_SendPending      (void);
+static uint32_t             stream_ZigZag           (int32_t value, int32_t reference);
+static void                 stream_PutPayload       (uint8_t value);
+static uint8_t              stream_DeltaFrame       (const int32_t *pValues, uint16_t count);
+
+/*!
+ * @brief       Update a CRC-16/CCITT (0x1021, MSB first) with bytes.
+ *
+ * @param[in]   crc         CRC of the previous bytes, 0xFFFF to start.
+ * @param[in]   pData       Bytes.
+ * @param[in]   size        Number of bytes.
+ *
+ * @return      CRC including the bytes, the CRC of the frames and of the
+ *              command frames of command.h.
+ */
+uint16_t stream_Crc16(uint16_t crc, const uint8_t *pData, uint16_t size) {
+    uint16_t i;
+    uint8_t  bit;
+
+    for (i = 0; i < size; i++) {
+        crc ^= (uint16_t)pData[i] << 8;
+        for (bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000u) ? (uint16_t)((crc << 1) ^ 0x1021u) : (uint16_t)(crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+/* Send the staged bytes */
+static void stream_Flush(void) {
+    if (stagingCount) {
+        streamWrite(staging, stagingCount);
+        stagingCount = 0;
+    }
+}
+
+static void stream_PutU8(uint8_t value) {
+    if (STREAM_STAGING_SIZE == stagingCount) {
+        stream_Flush();
+    }
+    staging[stagingCount++] = value;
+}
+
+static void stream_PutU16(uint16_t value) {
+    stream_PutU8((uint8_t)value);
+    stream_PutU8((uint8_t)(value >> 8));
+}
+
+static void stream_PutU32(uint32_t value) {
+    stream_PutU16((uint16_t)value);
+    stream_PutU16((uint16_t)(value >> 16));
+}
+
+/*!
+ * @brief       Initialize the stream and reset the frame sequence number.
+ *
+ * @param[in]   write       Function used to send the frame bytes.
+ */
+void stream_Init(STREAM_WRITE_FN write) {
+    streamWrite    = write;
+    stagingCount   = 0;
+    frameRemaining = 0;
+    frameSequence  = 0;
+    frameReduced   = 0;
+    pendingValid   = 0;
+    deltaValid     = 0;
+    frameTime.valid = 0;
+}
+
+/* Send a frame header, count values will follow */
+static void stream_Header(uint8_t mode, uint8_t n_el, uint8_t flags, uint16_t count, uint32_t frequency) {
+    uint64_t time;
+    int32_t  delta;
+
+    stagingCount   = 0;
+    frameRemaining = count;
+
+    stream_PutU8(STREAM_SYNC0);
+    stream_PutU8(STREAM_SYNC1);
+    stream_PutU8(frameTime.keyRecords ? STREAM_VERSION_TIME : STREAM_VERSION);
+    stream_PutU8(flags);
+    stream_PutU8(mode);
+    stream_PutU8(n_el);
+    stream_PutU16(count);
+    stream_PutU32(frequency);
+    stream_PutU32(frameSequence);
+
+    /* Time field, a varint of the key or difference flagged in bit 0 */
+    if (frameTime.keyRecords) {
+        if (stream_TimeCode(&frameTime, frameTick, &delta)) {
+            time = ((uint64_t)frameTick << 1) | 1u;
+        }
+        else {
+            time = (uint64_t)stream_ZigZag(delta, 0) << 1;
+        }
+        while (time >= 0x80u) {
+            stream_PutU8((uint8_t)(time | 0x80u));
+            time >>= 7;
+        }
+        stream_PutU8((uint8_t)time);
+    }
+
+    /* The sync bytes are not covered by the CRC */
+    frameCrc = stream_Crc16(0xFFFFu, &staging[2], (uint16_t)(stagingCount - 2u));
+    stream_Flush();
+}
+
+/*!
+ * @brief       Start a frame and send its header, or keep it until the values with delta frames on.
+ *
+ * @param[in]   mode        Measurement mode.
+ * @param[in]   n_el        Number of electrodes.
+ * @param[in]   format      Payload format.
+ * @param[in]   count       Number of values that will be passed to stream_FramePut().
+ * @param[in]   frequency   Excitation frequency in Hz.
+ */
+void stream_FrameBegin(uint8_t mode, uint8_t n_el, STREAM_FORMAT_TYPE format, uint16_t count, uint32_t frequency) {
+    uint8_t flags = ((uint8_t)format & STREAM_FLAG_FORMAT_MASK) | frameReduced;
+
+    /* The values decide between a key and a delta frame */
+    if (NULL != pDeltaReference) {
+        pendingValid     = 1;
+        pendingFlags     = flags;
+        pendingMode      = mode;
+        pendingNel       = n_el;
+        pendingCount     = count;
+        pendingFrequency = frequency;
+        frameRemaining   = count;
+        return;
+    }
+    stream_Header(mode, n_el, flags, count, frequency);
+}
+
+/* Send the waiting header as a key frame header, whose values are not kept as a reference */
+static void stream_SendPending(void) {
+    pendingValid = 0;
+    deltaValid   = 0;
+    stream_Header(pendingMode, pendingNel, pendingFlags, pendingCount, pendingFrequency);
+}
+
+/*!
+ * @brief       Start a multi-frequency frame and send its header and frequency table.
+ *
+ * @param[in]   mode            Measurement mode.
+ * @param[in]   n_el            Number of electrodes.
+ * @param[in]   format          Payload format.
+ * @param[in]   count           Number of values that will be passed to stream_FramePut(),
+ *                              frequency table excluded.
+ * @param[in]   pFrequencies    Excitation frequencies in Hz, in measurement order.
+ * @param[in]   numFrequencies  Number of frequencies.
+ */
+void stream_FrameBeginMulti(uint8_t mode, uint8_t n_el, STREAM_FORMAT_TYPE format,
+                            uint16_t count, const uint32_t *pFrequencies, uint8_t numFrequencies) {
+    uint8_t i;
+
+    stream_Header(mode, n_el, ((uint8_t)format & STREAM_FLAG_FORMAT_MASK) | STREAM_FLAG_MULTIFREQ | frameReduced,
+                  (uint16_t)(count + numFrequencies), numFrequencies);
+
+    for (i = 0; i < numFrequencies; i++) {
+        stream_FramePut((int32_t)pFrequencies[i]);
+    }
+}
+
+/*!
+ * @brief       Start a variance frame and send its header.
+ *
+ * @param[in]   mode        Measurement mode.
+ * @param[in]   n_el        Number of electrodes.
+ * @param[in]   format      Payload format of the averaged frame.
+ * @param[in]   count       Number of values that will be passed to stream_FramePut().
+ * @param[in]   frequency   Excitation frequency in Hz.
+ */
+void stream_FrameBeginVariance(uint8_t mode, uint8_t n_el, STREAM_FORMAT_TYPE format, uint16_t count, uint32_t frequency) {
+    stream_Header(mode, n_el, ((uint8_t)format & STREAM_FLAG_FORMAT_MASK) | STREAM_FLAG_VARIANCE | frameReduced,
+                  count, frequency);
+}
+
+/*!
+ * @brief       Start an excitation frame and send its header.
+ *
+ * @param[in]   mode        Measurement mode.
+ * @param[in]   n_el        Number of electrodes.
+ * @param[in]   count       Number of quads, one amplitude each will be passed to stream_FramePut().
+ * @param[in]   frequency   Excitation frequency in Hz.
+ */
+void stream_FrameBeginExcitation(uint8_t mode, uint8_t n_el, uint16_t count, uint32_t frequency) {
+    stream_Header(mode, n_el, STREAM_FLAG_EXCITATION, count, frequency);
+}
+
+/*!
+ * @brief       Start a plan frame and send its header.
+ *
+ * @param[in]   mode        Measurement mode.
+ * @param[in]   n_el        Number of electrodes.
+ * @param[in]   count       Number of quads of the full pattern, one plan entry each will be passed
+ *                          to stream_FramePut().
+ * @param[in]   measured    Number of quads measured with the plan.
+ */
+void stream_FrameBeginPlan(uint8_t mode, uint8_t n_el, uint16_t count, uint16_t measured) {
+    stream_Header(mode, n_el, STREAM_FLAG_PLAN, count, measured);
+}
+
+/*!
+ * @brief       Mark the measurement frames that follow as reduced, or not.
+ *
+ * @param[in]   reduced     Non-zero when the frames hold the measured quads of a plan only.
+ *
+ * @details     Applies to the frames started by stream_FrameBegin(),
+ *              stream_FrameBeginMulti() and stream_FrameBeginVariance().
+ */
+void stream_SetReduced(uint8_t reduced) {
+    frameReduced = reduced ? STREAM_FLAG_REDUCED : 0u;
+}
+
+/*!
+ * @brief       Append a payload value to the current frame.
+ *
+ * @param[in]   value       fixed32_t or q31_t value, depending on the frame format.
+ *
+ * @details     Values beyond the count announced in the header are dropped, so
+ *              the frame always matches its header.
+ */
+void stream_FramePut(int32_t value) {
+    uint16_t start;
+
+    if (pendingValid) {
+        stream_SendPending();
+    }
+    if (0u == frameRemaining) {
+        return;
+    }
+    frameRemaining--;
+
+    if (STREAM_STAGING_SIZE == stagingCount) {
+        stream_Flush();
+    }
+    start = stagingCount;
+    stream_PutU32((uint32_t)value);
+    frameCrc = stream_Crc16(frameCrc, &staging[start], 4u);
+}
+
+/*!
+ * @brief       Finish the current frame and send its CRC.
+ *
+ * @details     Missing values (e.g. after a failed measurement) are padded
+ *              with zeros.
+ */
+void stream_FrameEnd(void) {
+    if (pendingValid) {
+        stream_SendPending();
+    }
+    while (frameRemaining) {
+        stream_FramePut(0);
+    }
+
+    stream_PutU16(frameCrc);
+    stream_Flush();
+
+    frameSequence++;
+}
+
+/*!
+ * @brief       Append all the values of the current frame.
+ *
+ * @param[in]   pValues     Values of the frame.
+ * @param[in]   count       Number of values.
+ *
+ * @details     With delta frames on, a frame started by stream_FrameBegin()
+ *              whose count values are passed at once is sent as a delta
+ *              frame when it has a reference and is smaller that way, and
+ *              as a key frame otherwise. Any other call is the same as
+ *              stream_FramePut() on each value.
+ */
+void stream_FrameValues(const int32_t *pValues, uint16_t count) {
+    uint16_t i;
+
+    if (pendingValid && (count == pendingCount)) {
+        pendingValid = 0;
+        if (stream_DeltaFrame(pValues, count)) {
+            return;
+        }
+
+        /* Key frame, the reference of the next frames */
+        stream_Header(pendingMode, pendingNel, pendingFlags, pendingCount, pendingFrequency);
+        if (count <= deltaCapacity) {
+            for (i = 0; i < count; i++) {
+                pDeltaReference[i] = pValues[i];
+            }
+            deltaValid    = 1;
+            deltaFlags    = pendingFlags;
+            deltaMode     = pendingMode;
+            deltaNel      = pendingNel;
+            deltaCount    = count;
+            deltaSequence = frameSequence;
+            deltaSinceKey = 0;
+        }
+        else {
+            deltaValid    = 0;
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        stream_FramePut(pValues[i]);
+    }
+}
+
+/*!
+ * @brief       Turn delta frames on or off.
+ *
+ * @param[in]   pReference  Storage of the reference frame, NULL for no delta frames.
+ * @param[in]   capacity    Values pReference can hold, larger frames are always key frames.
+ * @param[in]   keyFrames   One frame in keyFrames is a key frame, at least 1.
+ *
+ * @details     The next measurement frame is a key frame.
+ */
+void stream_SetDelta(int32_t *pReference, uint16_t capacity, uint16_t keyFrames) {
+    pDeltaReference = pReference;
+    deltaCapacity   = (NULL != pReference) ? capacity : 0u;
+    deltaKeyFrames  = (keyFrames > 0u) ? keyFrames : 1u;
+    deltaValid      = 0;
+}
+
+/*!
+ * @brief       Turn the time field of the frames on or off.
+ *
+ * @param[in]   keyFrames   One frame in keyFrames sends the tick whole, 0 for no time field.
+ *
+ * @details     The next frame sends the tick whole.
+ */
+void stream_SetTimestamps(uint16_t keyFrames) {
+    stream_TimeInit(&frameTime, keyFrames);
+}
+
+/*!
+ * @brief       Set the tick sent with the next frames.
+ *
+ * @param[in]   tick        Start of the acquisition of the frame, in timestamp ticks.
+ */
+void stream_SetTime(uint32_t tick) {
+    frameTick = tick;
+}
+
+/*!
+ * @brief       Reset a timestamp coder.
+ *
+ * @param[in]   pCoder      Coder.
+ * @param[in]   keyRecords  One record in keyRecords is a key, 0 when the records are not timestamped.
+ *
+ * @details     The next record is a key.
+ */
+void stream_TimeInit(STREAM_TIME_CODER *pCoder, uint16_t keyRecords) {
+    pCoder->keyRecords = keyRecords;
+    pCoder->sinceKey   = 0;
+    pCoder->valid      = 0;
+}
+
+/*!
+ * @brief       Code the tick of a record.
+ *
+ * @param[in]   pCoder      Coder.
+ * @param[in]   tick        Tick of the record.
+ * @param[out]  pDelta      Difference with the tick of the previous record, when not a key.
+ *
+ * @return      1 when the record sends the tick whole, 0 when it sends *pDelta.
+ *
+ * @details     Ticks wrap modulo 2^32, the difference is taken modulo 2^32 as
+ *              a signed 32-bit value.
+ */
+uint8_t stream_TimeCode(STREAM_TIME_CODER *pCoder, uint32_t tick, int32_t *pDelta) {
+    uint32_t difference = tick - pCoder->previous;
+    uint8_t  key        = !pCoder->valid || ((pCoder->sinceKey + 1u) >= pCoder->keyRecords);
+
+    pCoder->previous = tick;
+    pCoder->valid    = 1;
+    if (key) {
+        pCoder->sinceKey = 0;
+        return 1;
+    }
+    pCoder->sinceKey++;
+    *pDelta = (int32_t)difference;
+
+    return 0;
+}
+
+/* Residual of a value, zig-zag mapped */
+static uint32_t stream_ZigZag(int32_t value, int32_t reference) {
+    uint32_t residual = (uint32_t)value - (uint32_t)reference;
+
+    return (residual << 1) ^ ((residual & 0x80000000u) ? 0xFFFFFFFFu : 0u);
+}
+
+/* Append a payload byte, the CRC is updated a byte at a time */
+static void stream_PutPayload(uint8_t value) {
+    if (STREAM_STAGING_SIZE == stagingCount) {
+        stream_Flush();
+    }
+    staging[stagingCount++] = value;
+    frameCrc = stream_Crc16(frameCrc, &value, 1u);
+    payloadBytes++;
+}
+
+/* Send the pending frame as a delta frame, 0 if it has no reference or a key frame is as small */
+static uint8_t stream_DeltaFrame(const int32_t *pValues, uint16_t count) {
+    uint32_t                varintBytes = 0;
+    uint32_t                maxResidual = 0;
+    uint32_t                back        = frameSequence - deltaSequence;
+    uint32_t                width, packedBytes, bytes, encoding, residual, i;
+
+    if (!deltaValid || (deltaFlags != pendingFlags) || (deltaMode != pendingMode) || (deltaNel != pendingNel) ||
+        (deltaCount != count) || (back > STREAM_DELTA_MAX_BACK) || ((deltaSinceKey + 1u) >= deltaKeyFrames)) {
+        return 0;
+    }
+
+    /* First pass: size of both encodings */
+    for (i = 0; i < count; i++) {
+        residual = stream_ZigZag(pValues[i], pDeltaReference[i]);
+        maxResidual |= residual;
+        do {
+            varintBytes++;
+            residual >>= 7;
+        } while (residual);
+    }
+    for (width = 0; (width < 32u) && (maxResidual >> width); width++) {
+    }
+    packedBytes = (count * width + 7u) / 8u;
+    encoding    = (packedBytes <= varintBytes) ? STREAM_DELTA_PACKED : STREAM_DELTA_VARINT;
+    bytes       = (STREAM_DELTA_PACKED == encoding) ? packedBytes : varintBytes;
+    if ((1u + (bytes + 3u) / 4u) >= count) {
+        return 0;
+    }
+
+    /* Second pass: the residuals, the values become the reference */
+    stream_Header(pendingMode, pendingNel, pendingFlags | STREAM_FLAG_DELTA, (uint16_t)(1u + (bytes + 3u) / 4u),
+                  pendingFrequency);
+    stream_FramePut((int32_t)STREAM_DELTA_DESCRIPTOR(count, back, (STREAM_DELTA_PACKED == encoding) ? width : 0u,
+                                                     encoding));
+    payloadBytes = 0;
+    packedBits   = 0;
+    packedCount  = 0;
+    for (i = 0; i < count; i++) {
+        residual           = stream_ZigZag(pValues[i], pDeltaReference[i]);
+        pDeltaReference[i] = pValues[i];
+        if (STREAM_DELTA_PACKED == encoding) {
+            packedBits  |= (uint64_t)residual << packedCount;
+            packedCount += width;
+            while (packedCount >= 8u) {
+                stream_PutPayload((uint8_t)packedBits);
+                packedBits  >>= 8;
+                packedCount  -= 8u;
+            }
+        }
+        else {
+            while (residual >= 0x80u) {
+                stream_PutPayload((uint8_t)(residual | 0x80u));
+                residual >>= 7;
+            }
+            stream_PutPayload((uint8_t)residual);
+        }
+    }
+    if (packedCount) {
+        stream_PutPayload((uint8_t)packedBits);
+    }
+    while (payloadBytes & 3u) {
+        stream_PutPayload(0);
+    }
+    frameRemaining = 0;
+
+    deltaSequence = frameSequence;
+    deltaSinceKey++;
+
+    return 1;
+}
+
+/*
+** EOF
+*/
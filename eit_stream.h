@@ -0,0 +1,170 @@
+/*!
+ *****************************************************************************
+ * @file:   eit_stream.h
+ * @brief:  Binary framed streaming protocol for EIT measurements
+ *
+ * Frame layout (all fields little-endian):
+ *
+ *      offset  size    field
+ *      0       2       sync, STREAM_SYNC0 STREAM_SYNC1
+ *      2       1       protocol version, STREAM_VERSION
+ *      3       1       flags, payload format in bits [1:0], multi-frequency in bit 2,
+ *                      variance in bit 3, excitation in bit 4, plan in bit 5,
+ *                      reduced in bit 6, delta in bit 7
+ *      4       1       measurement mode
+ *      5       1       number of electrodes
+ *      6       2       number of payload values
+ *      8       4       excitation frequency in Hz
+ *      12      4       frame sequence number
+ *      16      4*N     payload values (fixed32_t 28.4 or q31_t)
+ *      16+4*N  2       CRC-16/CCITT (0x1021, init 0xFFFF) of bytes 2 .. 15+4*N
+ *
+ * Timestamped frames (version STREAM_VERSION_TIME) carry a time field of 1
+ * to STREAM_TIME_MAX_SIZE bytes between the header and the payload, covered
+ * by the CRC. It is a varint, 7 bit groups least significant first with bit
+ * 7 set on all but the last byte, of:
+ *
+ *      bit 0   set     bits [32:1] are the tick, a key
+ *              clear   bits [32:1] are the zig-zag mapped difference between
+ *                      the tick and the tick of the previous frame
+ *
+ * The tick is a free running 32-bit count of microseconds (timestamp.h), the
+ * start of the acquisition of the frame. The first timestamped frame and
+ * one frame in every key period send the tick whole, so a host that lost a
+ * frame knows the time again at the next key. Variance, excitation and plan
+ * frames carry the tick of the frame they belong to.
+ *
+ * Multi-frequency frames (STREAM_FLAG_MULTIFREQ) hold the measurements of F
+ * excitation frequencies: the frequency field is F, and the payload starts
+ * with the F frequencies in Hz. The measurements follow in acquisition order,
+ * all the frequencies of quad 0, then all the frequencies of quad 1, ..., so
+ * the frame is a quads x frequencies x values-per-measurement block.
+ *
+ * When frames are averaged on the device, a variance frame
+ * (STREAM_FLAG_VARIANCE) can follow each averaged frame: same layout and
+ * format, holding the variance of every value over the averaged frames.
+ *
+ * When the excitation is ranged per quad, an excitation frame
+ * (STREAM_FLAG_EXCITATION) follows the frames it applies to: one integer
+ * per quad, the waveform generator amplitude in DAC codes the quad was
+ * measured at. Impedances do not depend on it; raw q31 magnitudes are
+ * scaled to the nominal amplitude by nominal / amplitude.
+ *
+ * When redundant quads are skipped, a plan frame (STREAM_FLAG_PLAN) comes
+ * before the first frame measured with it: the frequency field is the
+ * number of measured quads, and the payload holds one entry per quad of the
+ * full pattern, see pattern.h. The frames measured with the plan, and their
+ * variance frames, carry STREAM_FLAG_REDUCED and hold the measured quads
+ * only; the host expands them with the plan. Excitation frames always hold
+ * every quad of the full pattern.
+ *
+ * Delta frames (STREAM_FLAG_DELTA) compress a single frequency measurement
+ * frame against the previous one of the same layout (flags, mode, number of
+ * electrodes and of values), its reference. The count field is the number
+ * of payload words, and the payload is a descriptor word followed by the
+ * encoded residuals, zero padded to a whole word:
+ *
+ *      bits    field
+ *      [15:0]  number of values N
+ *      [23:16] frames since the reference frame, by sequence number
+ *      [29:24] residual width W of the bit-packed encoding, 0 .. 32
+ *      [31:30] encoding, STREAM_DELTA_VARINT or STREAM_DELTA_PACKED
+ *
+ * Residual i is the value minus the value i of the reference, modulo 2^32,
+ * zig-zag mapped to an unsigned integer (0, -1, 1, -2 ... to 0, 1, 2, 3 ...).
+ * STREAM_DELTA_VARINT sends each residual in 7 bit groups, least significant
+ * first, bit 7 set on all but the last byte of a residual;
+ * STREAM_DELTA_PACKED sends the N residuals as W bit fields, least
+ * significant bit first. The decoded frame, and every measurement frame sent
+ * without the flag (a key frame), is the reference of the next delta frame.
+ * A delta frame whose reference was lost cannot be decoded and is dropped
+ * until the next key frame.
+ *****************************************************************************/
+
+#ifndef __EIT_STREAM_H__
+#define __EIT_STREAM_H__
+
+#include <stdint.h>
+
+/* C++ linkage */
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#define STREAM_SYNC0                (0x45u)     /* 'E' */
+#define STREAM_SYNC1                (0x49u)     /* 'I' */
+#define STREAM_VERSION              (1u)
+#define STREAM_VERSION_TIME         (2u)        /* the header is followed by a time field, see above */
+#define STREAM_HEADER_SIZE          (16u)
+#define STREAM_CRC_SIZE             (2u)
+#define STREAM_TIME_MAX_SIZE        (5u)
+
+/* Payload format, stored in bits [1:0] of the flags field */
+#define STREAM_FLAG_FORMAT_MASK     (0x03u)
+/* The payload starts with a frequency table, see above */
+#define STREAM_FLAG_MULTIFREQ       (0x04u)
+/* The payload holds the variances of the previous frame, see above */
+#define STREAM_FLAG_VARIANCE        (0x08u)
+/* The payload holds the excitation amplitude of every quad of the previous frame, see above */
+#define STREAM_FLAG_EXCITATION      (0x10u)
+/* The payload holds the reduced measurement plan of the following frames, see above */
+#define STREAM_FLAG_PLAN            (0x20u)
+/* The payload holds the measured quads of a reduced plan only, see above */
+#define STREAM_FLAG_REDUCED         (0x40u)
+/* The payload holds the residuals of the frame against its reference, see above */
+#define STREAM_FLAG_DELTA           (0x80u)
+
+/* Delta frame descriptor, see above */
+#define STREAM_DELTA_VARINT         (0u)
+#define STREAM_DELTA_PACKED         (1u)
+#define STREAM_DELTA_MAX_BACK       (255u)
+#define STREAM_DELTA_DESCRIPTOR(count, back, width, encoding) \
+    ((uint32_t)(count) | ((uint32_t)(back) << 16) | ((uint32_t)(width) << 24) | ((uint32_t)(encoding) << 30))
+
+typedef enum {
+    STREAM_FORMAT_FIXED32           = 0,        /*!< One 28.4 magnitude per quad                */
+    STREAM_FORMAT_Q31               = 1,        /*!< Raw q31 magnitudes, current then voltage   */
+    STREAM_FORMAT_MAG_PHASE         = 2,        /*!< 28.4 magnitude, then 28.4 phase in degrees */
+    STREAM_FORMAT_REAL_IMAG         = 3,        /*!< 28.4 real, then 28.4 imaginary part        */
+} STREAM_FORMAT_TYPE;
+
+/* Timestamp coder, the ticks of a record stream as keys and differences */
+typedef struct {
+    uint32_t                previous;       /*!< Tick of the previous record                */
+    uint16_t                keyRecords;     /*!< One record in keyRecords is a key, 0 = off */
+    uint16_t                sinceKey;       /*!< Records since the last key                 */
+    uint8_t                 valid;          /*!< previous holds a tick                      */
+} STREAM_TIME_CODER;
+
+/* Output function used to send the frame bytes */
+typedef void (*STREAM_WRITE_FN)     (uint8_t *pData, uint16_t size);
+
+void                        stream_Init             (STREAM_WRITE_FN write);
+void                        stream_FrameBegin       (uint8_t mode, uint8_t n_el, STREAM_FORMAT_TYPE format,
+                                                     uint16_t count, uint32_t frequency);
+void                        stream_FrameBeginMulti  (uint8_t mode, uint8_t n_el, STREAM_FORMAT_TYPE format,
+                                                     uint16_t count, const uint32_t *pFrequencies, uint8_t numFrequencies);
+void                        stream_FrameBeginVariance (uint8_t mode, uint8_t n_el, STREAM_FORMAT_TYPE format,
+                                                     uint16_t count, uint32_t frequency);
+void                        stream_FrameBeginExcitation (uint8_t mode, uint8_t n_el, uint16_t count, uint32_t frequency);
+void                        stream_FrameBeginPlan   (uint8_t mode, uint8_t n_el, uint16_t count, uint16_t measured);
+void                        stream_SetReduced       (uint8_t reduced);
+void                        stream_FramePut         (int32_t value);
+void                        stream_FrameValues      (const int32_t *pValues, uint16_t count);
+void                        stream_SetDelta         (int32_t *pReference, uint16_t capacity, uint16_t keyFrames);
+void                        stream_FrameEnd         (void);
+void                        stream_SetTimestamps    (uint16_t keyFrames);
+void                        stream_SetTime          (uint32_t tick);
+void                        stream_TimeInit         (STREAM_TIME_CODER *pCoder, uint16_t keyRecords);
+uint8_t                     stream_TimeCode         (STREAM_TIME_CODER *pCoder, uint32_t tick, int32_t *pDelta);
+uint16_t                    stream_Crc16            (uint16_t crc, const uint8_t *pData, uint16_t size);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __EIT_STREAM_H__ */
+
+/*
+** EOF
+*/
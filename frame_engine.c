@@ -0,0 +1,451 @@
+/*!
+ *****************************************************************************
+ * @file:   frame_engine.c
+ * @brief:  Pipelined EIT frame acquisition engine
+ *
+ * Timeline for quad N measured with sequences 0 .. S-1:
+ *
+ *      apply(N) -> start seq 0 -> emit(previous), wait
+ *               -> start seq 1 -> emit(N, 0), wait
+ *               ...
+ *               -> start seq S-1 -> emit(N, S-2), prepare(N+1) -> wait
+ *
+ * The sequencer is run in non-blocking mode, completion is signalled by the
+ * AFE Rx DMA callback and the end of sequence flag. The results of two
+ * consecutive sequences are kept in ping-pong buffers so the previous quad can be
+ * formatted while the DMA writes the current one.
+ *
+ * Block mode timeline for blocks B of K quads:
+ *
+ *      apply(first of B) -> start block B -> emit(all of B-1), prepare(first of B+1)
+ *          DMA interrupt of quad k of B -> copy its results
+ *          custom interrupt after quad k of B -> switch(k+1)
+ *      -> wait -> apply(first of B+1) -> start block B+1 ...
+ *
+ * The DMA writes each quad alternately into the two halves of a small
+ * buffer, the interrupt copies it into the ping-pong block buffer. The
+ * DMA interrupt is not tied to the sequencer commands that follow the last
+ * DFT of a quad, so the muxes are switched from the custom interrupt the
+ * sequencer raises after them, at the start of the switch wait. When the
+ * quads select their own sequences, block B+1 is built into the other block
+ * sequence while block B runs.
+ *****************************************************************************/
+
+#include <stddef.h>
+#include <string.h>
+
+#include "bench.h"
+#include "frame_engine.h"
+#include "seq_builder.h"
+
+/* Ping-pong DFT result buffers */
+static int16_t              rxBuffer[2][FRAME_MAX_RESULTS];
+/* Set by the Rx DMA callback when all results of the running quad are in */
+static volatile bool_t      bRxDone = false;
+/* Statistics of the last frame */
+static FRAME_ENGINE_STATS   frameStats;
+
+/* Block mode: sequences of a full block and of the last one, and their results */
+static uint32_t             blockWords[2][FRAME_BLOCK_MAX_WORDS];
+static SEQ_OBJECT           blockSeq[2];
+static int16_t              blockBuffer[2][FRAME_BLOCK_MAX_RESULTS];
+static int16_t              blockDma[2 * FRAME_BLOCK_MAX_RESULTS];
+/* Block mode: state of the running block, shared with the Rx DMA interrupt */
+static FRAME_SWITCH_FN      blockSwitch;
+static int16_t             *pBlockResults;
+static uint32_t             blockFirst;
+static uint32_t             blockCount;
+static uint32_t             blockPerQuad;
+static volatile uint32_t    blockRxQuads;
+static volatile uint32_t    blockSwitchQuads;
+/* Block mode: sequences of each quad of the block being built */
+static const uint32_t *const *blockQuadSeqs[FRAME_BLOCK_MAX_RESULTS];
+
+static void                 frame_RxDmaCallback     (void *pCBParam, uint32_t Event, void *pArg);
+static void                 frame_BlockRxDmaCallback(void *pCBParam, uint32_t Event, void *pArg);
+static void                 frame_BlockSwitchCallback(void *pCBParam, uint32_t Event, void *pArg);
+static ADI_AFE_RESULT_TYPE  frame_WaitSequence      (ADI_AFE_DEV_HANDLE hDevice, const uint32_t *const seq);
+static uint32_t             frame_BlockQuads        (const FRAME_ENGINE_CONFIG *pConfig);
+static ADI_AFE_RESULT_TYPE  frame_RunBlocks         (const FRAME_ENGINE_CONFIG *pConfig, uint32_t quads);
+static void                 frame_EmitBlock         (const FRAME_ENGINE_CONFIG *pConfig, uint32_t first,
+                                                     uint32_t count, int16_t *pResults);
+static const uint32_t      *frame_BuildBlock        (const FRAME_ENGINE_CONFIG *pConfig, SEQ_OBJECT *pObj,
+                                                     uint32_t first, uint32_t count);
+
+/* AFE Rx DMA callback: the running quad has delivered all its DFT results */
+static void frame_RxDmaCallback(void *pCBParam, uint32_t Event, void *pArg) {
+    bRxDone = true;
+}
+
+/* Block mode Rx DMA callback: one quad of the running block has delivered its results */
+static void frame_BlockRxDmaCallback(void *pCBParam, uint32_t Event, void *pArg) {
+    uint32_t                quad = blockRxQuads;
+
+    if (quad < blockCount) {
+        memcpy(&pBlockResults[quad * blockPerQuad], pArg, blockPerQuad * sizeof(int16_t));
+        blockRxQuads = ++quad;
+    }
+
+    if (quad >= blockCount) {
+        bRxDone = true;
+    }
+}
+
+/* Block mode custom interrupt: the sequencer has stopped the excitation of a quad and waits for the switch */
+static void frame_BlockSwitchCallback(void *pCBParam, uint32_t Event, void *pArg) {
+    uint32_t                quad = blockSwitchQuads + 1u;
+
+    if (quad < blockCount) {
+        blockSwitch(blockFirst + quad);
+        blockSwitchQuads = quad;
+    }
+}
+
+/* Wait for the running sequence to finish, then stop and check it */
+static ADI_AFE_RESULT_TYPE frame_WaitSequence(ADI_AFE_DEV_HANDLE hDevice, const uint32_t *const seq) {
+    ADI_AFE_RESULT_TYPE     result;
+    bool_t                  bFinished = false;
+
+    while (!bFinished) {
+        /* Error raised by the AFE interrupt handlers */
+        if (ADI_AFE_SUCCESS != (result = adi_AFE_GetSeqError(hDevice))) {
+            adi_AFE_SeqAbort(hDevice);
+            adi_AFE_SetSeqState(hDevice, ADI_AFE_SEQ_STATE_IDLE);
+            return result;
+        }
+
+        /* The DFT results arrive before the last sequencer commands execute */
+        if (bRxDone) {
+            adi_AFE_GetSeqFinished(hDevice, &bFinished);
+        }
+
+        frameStats.idlePolls++;
+    }
+
+    adi_AFE_SetSeqState(hDevice, ADI_AFE_SEQ_STATE_FINISHED);
+
+    if (ADI_AFE_SUCCESS != (result = adi_AFE_SeqStop(hDevice))) {
+        adi_AFE_SeqAbort(hDevice);
+        adi_AFE_SetSeqState(hDevice, ADI_AFE_SEQ_STATE_IDLE);
+        return result;
+    }
+
+    adi_AFE_SetSeqState(hDevice, ADI_AFE_SEQ_STATE_IDLE);
+
+    return adi_AFE_SeqCheck(hDevice, seq);
+}
+
+/* Quads per block of a configuration, 0 to run one sequence at a time */
+static uint32_t frame_BlockQuads(const FRAME_ENGINE_CONFIG *pConfig) {
+    uint32_t                perQuad = pConfig->numSeqs * pConfig->numResults;
+    uint32_t                quads   = pConfig->blockQuads;
+
+    if ((0u == quads) || (NULL == pConfig->switchQuad) || (0u == perQuad)) {
+        return 0;
+    }
+
+    if (quads > pConfig->numQuads) {
+        quads = pConfig->numQuads;
+    }
+    if (quads > (FRAME_BLOCK_MAX_RESULTS / perQuad)) {
+        quads = FRAME_BLOCK_MAX_RESULTS / perQuad;
+    }
+    while ((quads > 0u) &&
+           (seq_BlockLength(pConfig->seqs, pConfig->numSeqs, quads, FRAME_BLOCK_SWITCH_US) > FRAME_BLOCK_MAX_WORDS)) {
+        quads--;
+    }
+
+    /* Sequences that cannot be concatenated */
+    if (0u == seq_BlockLength(pConfig->seqs, pConfig->numSeqs, 1, FRAME_BLOCK_SWITCH_US)) {
+        return 0;
+    }
+
+    return quads;
+}
+
+/* Emit the results of a measured block, quad by quad and sequence by sequence */
+static void frame_EmitBlock(const FRAME_ENGINE_CONFIG *pConfig, uint32_t first, uint32_t count, int16_t *pResults) {
+    uint32_t                quad, index;
+
+    for (quad = 0; quad < count; quad++) {
+        for (index = 0; index < pConfig->numSeqs; index++) {
+            pConfig->emit(first + quad, index, pResults);
+            pResults += pConfig->numResults;
+        }
+    }
+}
+
+/* Build the block of count quads from first with the sequences of each quad, NULL if it does not fit */
+static const uint32_t *frame_BuildBlock(const FRAME_ENGINE_CONFIG *pConfig, SEQ_OBJECT *pObj,
+                                        uint32_t first, uint32_t count) {
+    uint32_t                quad;
+
+    for (quad = 0; quad < count; quad++) {
+        blockQuadSeqs[quad] = pConfig->quadSeqs(first + quad);
+    }
+    if (!seq_BuildBlockQuads(pObj, blockQuadSeqs, pConfig->numSeqs, count, FRAME_BLOCK_SWITCH_US)) {
+        return NULL;
+    }
+
+    return seq_Commit(pObj);
+}
+
+/* Measure a frame in blocks of quads, one sequencer program per block */
+static ADI_AFE_RESULT_TYPE frame_RunBlocks(const FRAME_ENGINE_CONFIG *pConfig, uint32_t quads) {
+    ADI_AFE_DEV_HANDLE      hDevice  = pConfig->hDevice;
+    uint32_t                perQuad  = pConfig->numSeqs * pConfig->numResults;
+    uint32_t                blocks   = (pConfig->numQuads + quads - 1u) / quads;
+    uint32_t                last     = pConfig->numQuads - (blocks - 1u) * quads;
+    uint32_t                block, first, count;
+    uint32_t                prevFirst = 0;
+    uint32_t                prevCount = 0;
+    const uint32_t         *seq[2];
+    const uint32_t         *pSeq;
+    ADI_AFE_RESULT_TYPE     result;
+
+    if (NULL == blockSeq[0].pWords) {
+        seq_Attach(&blockSeq[0], blockWords[0], FRAME_BLOCK_MAX_WORDS);
+        seq_Attach(&blockSeq[1], blockWords[1], FRAME_BLOCK_MAX_WORDS);
+    }
+
+    if (NULL != pConfig->quadSeqs) {
+        /* Block by block, the first one now, the others while the previous block runs */
+        seq[0] = frame_BuildBlock(pConfig, &blockSeq[0], 0, (blocks > 1u) ? quads : last);
+        seq[1] = NULL;
+    }
+    else {
+        /* Full blocks, then the last one if it is shorter; unchanged blocks keep their CRC */
+        seq_BuildBlock(&blockSeq[0], pConfig->seqs, pConfig->numSeqs, quads, FRAME_BLOCK_SWITCH_US);
+        seq[0] = seq_Commit(&blockSeq[0]);
+        seq[1] = seq[0];
+        if (last != quads) {
+            seq_BuildBlock(&blockSeq[1], pConfig->seqs, pConfig->numSeqs, last, FRAME_BLOCK_SWITCH_US);
+            seq[1] = seq_Commit(&blockSeq[1]);
+        }
+    }
+
+    if (ADI_AFE_SUCCESS != (result = adi_AFE_RegisterCallbackOnReceiveDMA(hDevice, frame_BlockRxDmaCallback, 0))) {
+        return result;
+    }
+    if ((ADI_AFE_SUCCESS != (result = adi_AFE_RegisterAfeCallback(hDevice, ADI_AFE_INT_GROUP_GENERATE,
+                                                                  frame_BlockSwitchCallback,
+                                                                  BITM_AFE_AFE_ANALOG_GEN_INT_CUSTOM_INT))) ||
+        (ADI_AFE_SUCCESS != (result = adi_AFE_EnableInterruptSource(hDevice, ADI_AFE_INT_GROUP_GENERATE,
+                                                                    BITM_AFE_AFE_ANALOG_GEN_IEN_CUSTOM_INT_IEN, true)))) {
+        adi_AFE_RegisterAfeCallback(hDevice, ADI_AFE_INT_GROUP_GENERATE, NULL, 0);
+        adi_AFE_RegisterCallbackOnReceiveDMA(hDevice, NULL, 0);
+        return result;
+    }
+
+    /* One DMA cycle, and one interrupt, per quad */
+    adi_AFE_SetDmaRxBufferMaxSize(hDevice, (uint16_t)perQuad, (uint16_t)perQuad);
+    adi_AFE_SetRunSequenceBlockingMode(hDevice, false);
+
+    blockSwitch  = pConfig->switchQuad;
+    blockPerQuad = perQuad;
+
+    pConfig->prepare(0);
+    pConfig->apply(0);
+
+    for (block = 0; block < blocks; block++) {
+        first = block * quads;
+        count = ((block + 1u) < blocks) ? quads : last;
+        if (NULL != pConfig->quadSeqs) {
+            pSeq = seq[block & 1u];
+        }
+        else {
+            pSeq = ((block + 1u) < blocks) ? seq[0] : seq[1];
+        }
+
+        pBlockResults    = blockBuffer[block & 1u];
+        memset(pBlockResults, 0, count * perQuad * sizeof(int16_t));
+        blockFirst       = first;
+        blockCount       = count;
+        blockRxQuads     = 0;
+        blockSwitchQuads = 0;
+        bRxDone          = false;
+
+        BENCH_MARK();
+        result = (NULL != pSeq) ? adi_AFE_RunSequence(hDevice, pSeq, (uint16_t *)blockDma, count * perQuad)
+                                : ADI_AFE_ERR_SEQ;
+        BENCH_STAGE(BENCH_STAGE_SEQ_START);
+
+        /* Work overlapped with the whole block */
+        if (block > 0u) {
+            frame_EmitBlock(pConfig, prevFirst, prevCount, blockBuffer[(block - 1u) & 1u]);
+        }
+        if ((block + 1u) < blocks) {
+            pConfig->prepare(first + count);
+            if (NULL != pConfig->quadSeqs) {
+                seq[(block + 1u) & 1u] = frame_BuildBlock(pConfig, &blockSeq[(block + 1u) & 1u], first + count,
+                                                          ((block + 2u) < blocks) ? quads : last);
+            }
+        }
+
+        if (ADI_AFE_SUCCESS == result) {
+            BENCH_MARK();
+            result = frame_WaitSequence(hDevice, pSeq);
+            BENCH_STAGE(BENCH_STAGE_SEQ_WAIT);
+        }
+        if (ADI_AFE_SUCCESS != result) {
+            /* The quads of a failed block may have been measured on the wrong electrodes */
+            memset(pBlockResults, 0, count * perQuad * sizeof(int16_t));
+            frameStats.errors++;
+        }
+
+        if ((block + 1u) < blocks) {
+            pConfig->apply(first + count);
+        }
+
+        prevFirst = first;
+        prevCount = count;
+    }
+
+    frame_EmitBlock(pConfig, prevFirst, prevCount, blockBuffer[(blocks - 1u) & 1u]);
+
+    adi_AFE_SetRunSequenceBlockingMode(hDevice, true);
+    adi_AFE_SetDmaRxBufferMaxSize(hDevice, FRAME_RX_DMA_MAX_SIZE, 0);
+    adi_AFE_EnableInterruptSource(hDevice, ADI_AFE_INT_GROUP_GENERATE, BITM_AFE_AFE_ANALOG_GEN_IEN_CUSTOM_INT_IEN, false);
+    adi_AFE_RegisterAfeCallback(hDevice, ADI_AFE_INT_GROUP_GENERATE, NULL, 0);
+    adi_AFE_RegisterCallbackOnReceiveDMA(hDevice, NULL, 0);
+
+    frameStats.quads      = pConfig->numQuads;
+    frameStats.sequences  = blocks;
+    frameStats.blockQuads = quads;
+
+    return (frameStats.errors ? ADI_AFE_ERR_SEQ : ADI_AFE_SUCCESS);
+}
+
+/*!
+ * @brief       Measure a frame of quads, overlapping CPU work with the sequencer.
+ *
+ * @param[in]   pConfig     Frame configuration.
+ *
+ * @return      ADI_AFE_SUCCESS if every sequence was run, ADI_AFE_ERR_SEQ if one
+ *              or more sequences failed (the frame is still completed, failed
+ *              sequences are emitted with zeroed results).
+ *
+ * @details     Every quad is measured with all the sequences of the
+ *              configuration, in order, before the next quad is applied. The
+ *              AFE is left in blocking mode on exit, as expected by the other
+ *              measurement modes.
+ *
+ *              With blockQuads set, the quads are measured in blocks of at
+ *              most blockQuads quads, fewer if a block would not fit
+ *              FRAME_BLOCK_MAX_WORDS or FRAME_BLOCK_MAX_RESULTS. A failed
+ *              block is emitted with zeroed results. The Rx DMA is left in
+ *              single buffer mode on exit.
+ *
+ *              With quadSeqs set, quad q runs quadSeqs(q) instead of seqs.
+ */
+ADI_AFE_RESULT_TYPE frame_Run(const FRAME_ENGINE_CONFIG *pConfig) {
+    ADI_AFE_DEV_HANDLE      hDevice = pConfig->hDevice;
+    ADI_AFE_RESULT_TYPE     result;
+    uint32_t                quad    = 0;
+    uint32_t                index   = 0;
+    uint32_t                step, steps;
+    uint32_t                prevQuad, prevIndex;
+    uint32_t                blockQuads;
+    bool_t                  bLastOfQuad;
+    int16_t                *pCurrent;
+    const uint32_t *const  *seqs;
+
+    memset(&frameStats, 0, sizeof(frameStats));
+
+    if ((pConfig->numResults > FRAME_MAX_RESULTS) || (0u == pConfig->numSeqs)) {
+        return ADI_AFE_ERR_PARAM_OUT_OF_RANGE;
+    }
+
+    if (0u == pConfig->numQuads) {
+        return ADI_AFE_SUCCESS;
+    }
+
+    if (0u != (blockQuads = frame_BlockQuads(pConfig))) {
+        return frame_RunBlocks(pConfig, blockQuads);
+    }
+
+    if (ADI_AFE_SUCCESS != (result = adi_AFE_RegisterCallbackOnReceiveDMA(hDevice, frame_RxDmaCallback, 0))) {
+        return result;
+    }
+
+    adi_AFE_SetRunSequenceBlockingMode(hDevice, false);
+
+    /* Mux state of the first quad cannot be overlapped with anything */
+    pConfig->prepare(0);
+    pConfig->apply(0);
+
+    steps     = pConfig->numQuads * pConfig->numSeqs;
+    prevQuad  = 0;
+    prevIndex = 0;
+    seqs      = (NULL != pConfig->quadSeqs) ? pConfig->quadSeqs(0) : pConfig->seqs;
+
+    for (step = 0; step < steps; step++) {
+        pCurrent = rxBuffer[step & 1u];
+        memset(pCurrent, 0, sizeof(rxBuffer[0]));
+        bRxDone     = false;
+        bLastOfQuad = ((index + 1u) == pConfig->numSeqs) ? true : false;
+
+        /* Non-blocking: returns as soon as the sequencer is running */
+        BENCH_MARK();
+        result = adi_AFE_RunSequence(hDevice, seqs[index], (uint16_t *)pCurrent, pConfig->numResults);
+        BENCH_STAGE(BENCH_STAGE_SEQ_START);
+
+        /* Work overlapped with the analog settling and DFT of this sequence */
+        if (step > 0u) {
+            pConfig->emit(prevQuad, prevIndex, rxBuffer[(step - 1u) & 1u]);
+        }
+        if (bLastOfQuad && ((quad + 1u) < pConfig->numQuads)) {
+            pConfig->prepare(quad + 1u);
+        }
+
+        if (ADI_AFE_SUCCESS == result) {
+            BENCH_MARK();
+            result = frame_WaitSequence(hDevice, seqs[index]);
+            BENCH_STAGE(BENCH_STAGE_SEQ_WAIT);
+        }
+        if (ADI_AFE_SUCCESS != result) {
+            frameStats.errors++;
+        }
+
+        prevQuad  = quad;
+        prevIndex = index;
+
+        if (bLastOfQuad) {
+            /* Switch the muxes only once the sequencer has released the electrodes */
+            if ((quad + 1u) < pConfig->numQuads) {
+                pConfig->apply(quad + 1u);
+                if (NULL != pConfig->quadSeqs) {
+                    seqs = pConfig->quadSeqs(quad + 1u);
+                }
+            }
+            quad++;
+            index = 0;
+        }
+        else {
+            index++;
+        }
+    }
+
+    pConfig->emit(prevQuad, prevIndex, rxBuffer[(steps - 1u) & 1u]);
+
+    adi_AFE_SetRunSequenceBlockingMode(hDevice, true);
+    adi_AFE_RegisterCallbackOnReceiveDMA(hDevice, NULL, 0);
+
+    frameStats.quads     = pConfig->numQuads;
+    frameStats.sequences = steps;
+
+    return (frameStats.errors ? ADI_AFE_ERR_SEQ : ADI_AFE_SUCCESS);
+}
+
+/*!
+ * @brief       Get the statistics of the last frame measured by frame_Run().
+ *
+ * @param[out]  pStats      Destination of the statistics.
+ */
+void frame_GetStats(FRAME_ENGINE_STATS *pStats) {
+    *pStats = frameStats;
+}
+
+/*
+** EOF
+*/
@@ -0,0 +1,100 @@
+/*!
+ *****************************************************************************
+ * @file:   frame_engine.h
+ * @brief:  Pipelined EIT frame acquisition engine
+ *
+ * The engine runs one AFE sequence per electrode quad in non-blocking mode.
+ * While the sequencer is busy with quad N, the CPU formats the results of
+ * quad N-1 and prepares the multiplexer state for quad N+1, so a frame costs
+ * roughly the analog settling and DFT time of its quads.
+ *
+ * A quad can be measured with several sequences, e.g. one per excitation
+ * frequency: they run back to back before the multiplexers are switched, so
+ * the mux settling is paid once per quad instead of once per sequence.
+ *
+ * In block mode, the sequences of up to blockQuads consecutive quads are
+ * concatenated into one sequencer program (seq_BuildBlock()), so the
+ * sequence start, stop and check are paid once per block instead of the
+ * switch wait on every quad: with a launch of about 25us (framecheck -l),
+ * this saves about 12us of the 39ms of a quad. The Rx DMA runs in dual
+ * buffer mode with one DMA cycle per quad. After the last command of a
+ * quad, the sequencer raises the AFE custom interrupt, which switches the
+ * multiplexers to the next quad while the sequencer waits
+ * FRAME_BLOCK_SWITCH_US with the excitation off.
+ *
+ * With quadSeqs set, every quad runs its own list of sequences, e.g. with
+ * the excitation amplitude of the quad in front: the lists must return the
+ * results of seqs and have the same length, as the block size is chosen
+ * from seqs. In block mode each block is then built while the previous one
+ * runs.
+ *****************************************************************************/
+
+#ifndef __FRAME_ENGINE_H__
+#define __FRAME_ENGINE_H__
+
+#include <stdint.h>
+
+#include "afe.h"
+
+/* C++ linkage */
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Maximum number of DFT result halfwords returned by one quad sequence */
+#define FRAME_MAX_RESULTS           (4)
+/* Block mode: sequencer words and DFT result halfwords of a block */
+#define FRAME_BLOCK_MAX_WORDS       (160)
+#define FRAME_BLOCK_MAX_RESULTS     (32)
+/* Block mode: sequencer wait for the custom interrupt to switch the multiplexers, settling excluded */
+#define FRAME_BLOCK_SWITCH_US       (20u)
+/* Rx DMA cycle size of the AFE driver outside block mode */
+#define FRAME_RX_DMA_MAX_SIZE       (1024u)
+
+/* Called while the sequencer runs, to compute the mux state of the next quad */
+typedef void (*FRAME_PREPARE_FN)    (uint32_t quad);
+/* Called between sequences, to drive the prepared mux state onto the GPIOs */
+typedef void (*FRAME_APPLY_FN)      (uint32_t quad);
+/* Called while the sequencer runs, to process the results of the previous sequence */
+typedef void (*FRAME_EMIT_FN)       (uint32_t quad, uint32_t seqIndex, int16_t *dft_results);
+/* Block mode: called from the AFE custom interrupt to drive the mux state of a quad, without preparation */
+typedef void (*FRAME_SWITCH_FN)     (uint32_t quad);
+/* Called before a quad, or a block, is started, to select the sequences of a quad */
+typedef const uint32_t *const *(*FRAME_SEQS_FN) (uint32_t quad);
+
+/* Frame engine configuration */
+typedef struct {
+    ADI_AFE_DEV_HANDLE      hDevice;        /*!< AFE device handle                          */
+    const uint32_t *const  *seqs;           /*!< Sequences run in turn on every quad        */
+    uint32_t                numSeqs;        /*!< Number of sequences per quad, at least 1   */
+    uint32_t                numResults;     /*!< DFT result halfwords per sequence          */
+    uint32_t                numQuads;       /*!< Number of quads in the frame               */
+    FRAME_PREPARE_FN        prepare;        /*!< Mux state computation for a quad           */
+    FRAME_APPLY_FN          apply;          /*!< Mux state application for a quad           */
+    FRAME_EMIT_FN           emit;           /*!< Result processing for a quad               */
+    uint32_t                blockQuads;     /*!< Quads per block, 0 for no blocks           */
+    FRAME_SWITCH_FN         switchQuad;     /*!< Mux switching inside a block              */
+    FRAME_SEQS_FN           quadSeqs;       /*!< Sequences of a quad, NULL to run seqs     */
+} FRAME_ENGINE_CONFIG;
+
+/* Frame engine statistics, updated by frame_Run() */
+typedef struct {
+    uint32_t                quads;          /*!< Quads measured in the last frame           */
+    uint32_t                sequences;      /*!< Sequences run in the last frame            */
+    uint32_t                blockQuads;     /*!< Quads per block of the last frame          */
+    uint32_t                errors;         /*!< Sequences that failed in the last frame    */
+    uint32_t                idlePolls;      /*!< Polls spent waiting for the sequencer      */
+} FRAME_ENGINE_STATS;
+
+ADI_AFE_RESULT_TYPE         frame_Run               (const FRAME_ENGINE_CONFIG *pConfig);
+void                        frame_GetStats          (FRAME_ENGINE_STATS *pStats);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __FRAME_ENGINE_H__ */
+
+/*
+** EOF
+*/
@@ -203,6 +203,11 @@ typedef struct ADI_AFE_DEV_DATA_TYPE* ADI_AFE_DEV_HANDLE;  /*!< AFE Device insta
 /* - addr[7:2] identifies the MMR for the sequencer,   */
 #define SEQ_MMR_WRITE(addr, data)   (0x80000000 | ((addr & 0xFC) << 23) | data)
 
+/* Helper macro for building wait commands from C code                            */
+/* Parameters:                                                                    */
+/*   - cycles: wait time in ACLK (16MHz) cycles, bits 29..0 of the command        */
+#define SEQ_WAIT(cycles)            ((uint32_t)(cycles) & 0x3FFFFFFF)
+
 extern ADI_AFE_RESULT_TYPE      adi_AFE_Init                            (ADI_AFE_DEV_HANDLE* const      phDevice);
 extern ADI_AFE_RESULT_TYPE      adi_AFE_UnInit                          (ADI_AFE_DEV_HANDLE const       hDevice);
 extern ADI_AFE_RESULT_TYPE      adi_AFE_SetDataFifoSource               (ADI_AFE_DEV_HANDLE const       hDevice,
@@ -302,6 +307,7 @@ extern ADI_AFE_RESULT_TYPE      adi_AFE_RunSequence                     (ADI_AFE
                                                                          uint32_t                       size);
 extern ADI_AFE_RESULT_TYPE      adi_AFE_EnableSoftwareCRC               (ADI_AFE_DEV_HANDLE const       hDevice,
                                                                          const bool_t                   bEnable);
+extern uint8_t                  adi_AFE_CalculateSequenceCRC            (const uint32_t *const          txBuffer);
 extern ADI_AFE_RESULT_TYPE      adi_AFE_GetLowPowerModeFlag             (ADI_AFE_DEV_HANDLE const       hDevice, 
                                                                          bool_t *const                  pbFlag);
 extern ADI_AFE_RESULT_TYPE      adi_AFE_SetLowPowerModeFlag             (ADI_AFE_DEV_HANDLE const       hDevice, 
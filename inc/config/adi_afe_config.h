@@ -50,6 +50,23 @@ License Agreement.
 #error "Invalid configuration"
 #endif
 
+/*!
+   Sequencer CRC8 implementation, used for the software CRC and
+   adi_AFE_CalculateSequenceCRC.
+   2 - Byte lookup table (256 bytes of flash, 4 lookups per command)
+   1 - Nibble lookup table (16 bytes of flash, 8 lookups per command)
+   0 - Bitwise calculation (no table, 32 iterations per command)
+   The CRC engine (crc.c) only computes CRC-32, so it cannot be used for
+   the sequencer CRC8. tools/AFESim crccheck checks the three variants
+   against each other and the sequences of inc/afe_sequences.h, and times
+   them.
+*/
+#define ADI_AFE_CFG_SEQ_CRC_TABLE                               2
+
+#if ( ADI_AFE_CFG_SEQ_CRC_TABLE > 2 )
+#error "Invalid configuration"
+#endif
+
 /************* AFE controller configurations ***************/
 
 /************** Macro validation *****************************/
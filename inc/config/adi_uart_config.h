@@ -23,6 +23,8 @@ License Agreement.
 #define ADI_UART_CFG_POLLED_MODE_SUPPORT        1 /*!< Enable polled mode*/
 #define ADI_UART_CFG_BLOCKING_MODE_SUPPORT      1 /*!< Enable blocking mode*/
 #define ADI_UART_CFG_NONBLOCKING_MODE_SUPPORT   1 /*!< Enable non-blocking mode*/
+#define ADI_UART_CFG_DMA_MODE_SUPPORT           1 /*!< Enable DMA transmit mode (requires interrupt mode)*/
+#define ADI_UART_CFG_RX_OVERFLOW_DROP           1 /*!< Drop and count bytes received into a full rx buffer instead of trapping*/
 
 #define ADI_UART0_BAUD_INITIALIZER    ADI_UART_BAUD_9600              /*!< UART0 Baudrate Divider Register initializer */
 #define ADI_UART0_COMLCR_INITIALIZER  COMLCR_STOP | COMLCR_WLS_8BITS  /*!< UART0 Line Control Register initializer */
@@ -0,0 +1,74 @@
+/*********************************************************************************
+
+Copyright (c) 2010-2014 Analog Devices, Inc. All Rights Reserved.
+
+This software is proprietary to Analog Devices, Inc. and its licensors.  By using 
+this software you agree to the terms of the associated Analog Devices Software 
+License Agreement.
+
+*********************************************************************************/
+
+/*!
+ *****************************************************************************
+ * @file:    metrics.h
+ * @brief:   Metric counter Device Definitions for ADuCxxx
+ *****************************************************************************/
+
+/*! \addtogroup Metric_Driver Metric Driver
+ *  @{
+ */
+
+#ifndef __METRICS_H__
+#define __METRICS_H__
+
+#include "device.h"
+#include "gpt.h"
+
+/* C++ linkage */
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*!
+ *****************************************************************************
+ * \enum ADI_METRIC_RESULT_TYPE
+ *
+ * Metric counter result codes.
+ *****************************************************************************/
+typedef enum
+{
+    ADI_METRIC_SUCCESS = 0,         /*!< Call completed successfully.           */
+    ADI_METRIC_ERROR                /*!< Metrics internal timer has failed.     */
+} ADI_METRIC_RESULT_TYPE;
+
+/*!
+ *****************************************************************************
+ * \typedef ADI_METRIC_DEV_HANDLE
+ *
+ * Metric counter handle, the counts are HFOSC cycles (16 MHz, one count per
+ * core cycle when the core runs from the 16 MHz measurement clock).
+ * The counter is hardwired to GP timer 0.
+ *****************************************************************************/
+typedef struct ADI_METRIC_DEV_DATA_TYPE* ADI_METRIC_DEV_HANDLE;
+
+extern ADI_METRIC_RESULT_TYPE   adi_Metric_Init             (ADI_GPT_DEV_ID_TYPE InstanceNum, ADI_METRIC_DEV_HANDLE* const pHandle);
+extern ADI_METRIC_RESULT_TYPE   adi_Metric_UnInit           (ADI_METRIC_DEV_HANDLE const hDevice);
+extern ADI_METRIC_RESULT_TYPE   adi_Metric_Start            (ADI_METRIC_DEV_HANDLE const hDevice);
+extern ADI_METRIC_RESULT_TYPE   adi_Metric_Stop             (ADI_METRIC_DEV_HANDLE const hDevice);
+extern ADI_METRIC_RESULT_TYPE   adi_Metric_IncIndex         (ADI_METRIC_DEV_HANDLE const hDevice);
+extern ADI_METRIC_RESULT_TYPE   adi_Metric_ClearAccumulate  (ADI_METRIC_DEV_HANDLE const hDevice);
+extern uint32_t                 adi_Metric_GetCount         (ADI_METRIC_DEV_HANDLE const hDevice);
+extern uint32_t                 adi_Metric_GetAccumulate    (ADI_METRIC_DEV_HANDLE const hDevice);
+
+/* C++ linkage */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
+
+/*
+** EOF
+*/
+
+/*@}*/
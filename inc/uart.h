@@ -106,6 +106,9 @@ typedef struct
     uint16_t OverrunErrorCnt;        /*!< overrun error count             */
     uint16_t DataReadyCnt;           /*!< data ready count                */
     uint16_t RxDroppedByteCnt;       /*!< dropped receive bytes           */
+    uint16_t TxOverflowCnt;          /*!< truncated transmit requests     */
+    uint32_t TxDroppedByteCnt;       /*!< dropped transmit bytes          */
+    uint16_t TxBufferMaxUsed;        /*!< tx buffer high-water mark       */
 } ADI_UART_STATS_TYPE;
 #endif /* ADI_DEBUG */
 
@@ -197,6 +200,7 @@ extern ADI_UART_RESULT_TYPE adi_UART_UnInit  (ADI_UART_HANDLE const hDevice);
 extern ADI_UART_RESULT_TYPE adi_UART_BufTx   (ADI_UART_HANDLE const hDevice,const void* const pData,int16_t *pSize);
 extern ADI_UART_RESULT_TYPE adi_UART_BufRx   (ADI_UART_HANDLE const hDevice,const void *pData,int16_t *pSize);
 extern ADI_UART_RESULT_TYPE adi_UART_BufFlush(ADI_UART_HANDLE const hDevice);
+extern ADI_UART_RESULT_TYPE adi_UART_TxFlush (ADI_UART_HANDLE const hDevice);
 
 extern ADI_UART_RESULT_TYPE adi_UART_SetBaudRate(ADI_UART_HANDLE const hDevice,const ADI_UART_BAUDRATE_TYPE BaudRate);
 extern ADI_UART_RESULT_TYPE adi_UART_Enable          (ADI_UART_HANDLE const hDevice,const bool_t bFlag);
@@ -225,6 +229,8 @@ extern bool_t adi_UART_GetBreakBit     (ADI_UART_HANDLE const hDevice);
 extern bool_t adi_UART_GetInterruptMode(ADI_UART_HANDLE const hDevice);
 extern uint16_t adi_UART_GetNumRxBytes (ADI_UART_HANDLE const hDevice);
 extern uint16_t adi_UART_GetNumTxBytes (ADI_UART_HANDLE const hDevice);
+extern uint16_t adi_UART_GetNumRxDropped(ADI_UART_HANDLE const hDevice);
+extern uint16_t adi_UART_GetNumTxDropped(ADI_UART_HANDLE const hDevice);
 extern uint32_t adi_UART_GetBaudRate   (ADI_UART_HANDLE const hDevice);
 extern ADI_UART_RESULT_TYPE adi_UART_GetGenericSettings(ADI_UART_HANDLE const hDevice,
                                                         ADI_UART_GENERIC_SETTINGS_TYPE* const pGenericSettings);
@@ -5,6 +5,8 @@
 #ifndef __LOOKUP_H__
 #define __LOOKUP_H__
 
+#include "pattern.h"
+
 /* C++ linkage */
 #ifdef __cplusplus
 extern "C" {
@@ -12,1154 +14,30 @@ extern "C" {
   
   
 /***************************************************************************/
-/*   Look Up Tables                                     32, 192, 896       */
+/*   Electrode patterns, see pattern.h                                     */
 /***************************************************************************/
-typedef const int16_t e_config[4];   
 
 /****************************************
 This is the opposition sequence for 8 elextrodes where: 
 
 ex_mat = eit_scan_lines(ne=8, dist=4) step = 1
 **********************************************/
-const e_config electrode_configuration_8_opposition[32] = { 
-0,16,8,4,
-0,16,12,8,
-0,16,24,20,
-0,16,28,24,
-4,20,12,8,
-4,20,16,12,
-4,20,28,24,
-4,20,0,28,
-8,24,4,0,
-8,24,16,12,
-8,24,20,16,
-8,24,0,28,
-12,28,4,0,
-12,28,8,4,
-12,28,20,16,
-12,28,24,20,
-16,0,8,4,
-16,0,12,8,
-16,0,24,20,
-16,0,28,24,
-20,4,12,8,
-20,4,16,12,
-20,4,28,24,
-20,4,0,28,
-24,8,4,0,
-24,8,16,12,
-24,8,20,16,
-24,8,0,28,
-28,12,4,0,
-28,12,8,4,
-28,12,20,16,
-28,12,24,20
-};
+const PATTERN_CONFIG pattern_8_opposition  = { 8,  4, 1, PATTERN_FLAG_SKIP_INJECTION };   // 32 quads 
+
 /****************************************
 This is the opposition sequence for 16 elextrodes where: 
 
-ex_mat = eit_scan_lines(ne=16, dist=8) step = 8
+ex_mat = eit_scan_lines(ne=16, dist=8) step = 1
 **********************************************/
-const e_config electrode_configuration_16_opposition[192] = { 
-0,16,4,2,
-0,16,6,4,
-0,16,8,6,
-0,16,10,8,
-0,16,12,10,
-0,16,14,12,
-0,16,20,18,
-0,16,22,20,
-0,16,24,22,
-0,16,26,24,
-0,16,28,26,
-0,16,30,28,
-2,18,6,4,
-2,18,8,6,
-2,18,10,8,
-2,18,12,10,
-2,18,14,12,
-2,18,16,14,
-2,18,22,20,
-2,18,24,22,
-2,18,26,24,
-2,18,28,26,
-2,18,30,28,
-2,18,0,30,
-4,20,2,0,
-4,20,8,6,
-4,20,10,8,
-4,20,12,10,
-4,20,14,12,
-4,20,16,14,
-4,20,18,16,
-4,20,24,22,
-4,20,26,24,
-4,20,28,26,
-4,20,30,28,
-4,20,0,30,
-6,22,2,0,
-6,22,4,2,
-6,22,10,8,
-6,22,12,10,
-6,22,14,12,
-6,22,16,14,
-6,22,18,16,
-6,22,20,18,
-6,22,26,24,
-6,22,28,26,
-6,22,30,28,
-6,22,0,30,
-8,24,2,0,
-8,24,4,2,
-8,24,6,4,
-8,24,12,10,
-8,24,14,12,
-8,24,16,14,
-8,24,18,16,
-8,24,20,18,
-8,24,22,20,
-8,24,28,26,
-8,24,30,28,
-8,24,0,30,
-10,26,2,0,
-10,26,4,2,
-10,26,6,4,
-10,26,8,6,
-10,26,14,12,
-10,26,16,14,
-10,26,18,16,
-10,26,20,18,
-10,26,22,20,
-10,26,24,22,
-10,26,30,28,
-10,26,0,30,
-12,28,2,0,
-12,28,4,2,
-12,28,6,4,
-12,28,8,6,
-12,28,10,8,
-12,28,16,14,
-12,28,18,16,
-12,28,20,18,
-12,28,22,20,
-12,28,24,22,
-12,28,26,24,
-12,28,0,30,
-14,30,2,0,
-14,30,4,2,
-14,30,6,4,
-14,30,8,6,
-14,30,10,8,
-14,30,12,10,
-14,30,18,16,
-14,30,20,18,
-14,30,22,20,
-14,30,24,22,
-14,30,26,24,
-14,30,28,26,
-16,0,4,2,
-16,0,6,4,
-16,0,8,6,
-16,0,10,8,
-16,0,12,10,
-16,0,14,12,
-16,0,20,18,
-16,0,22,20,
-16,0,24,22,
-16,0,26,24,
-16,0,28,26,
-16,0,30,28,
-18,2,6,4,
-18,2,8,6,
-18,2,10,8,
-18,2,12,10,
-18,2,14,12,
-18,2,16,14,
-18,2,22,20,
-18,2,24,22,
-18,2,26,24,
-18,2,28,26,
-18,2,30,28,
-18,2,0,30,
-20,4,2,0,
-20,4,8,6,
-20,4,10,8,
-20,4,12,10,
-20,4,14,12,
-20,4,16,14,
-20,4,18,16,
-20,4,24,22,
-20,4,26,24,
-20,4,28,26,
-20,4,30,28,
-20,4,0,30,
-22,6,2,0,
-22,6,4,2,
-22,6,10,8,
-22,6,12,10,
-22,6,14,12,
-22,6,16,14,
-22,6,18,16,
-22,6,20,18,
-22,6,26,24,
-22,6,28,26,
-22,6,30,28,
-22,6,0,30,
-24,8,2,0,
-24,8,4,2,
-24,8,6,4,
-24,8,12,10,
-24,8,14,12,
-24,8,16,14,
-24,8,18,16,
-24,8,20,18,
-24,8,22,20,
-24,8,28,26,
-24,8,30,28,
-24,8,0,30,
-26,10,2,0,
-26,10,4,2,
-26,10,6,4,
-26,10,8,6,
-26,10,14,12,
-26,10,16,14,
-26,10,18,16,
-26,10,20,18,
-26,10,22,20,
-26,10,24,22,
-26,10,30,28,
-26,10,0,30,
-28,12,2,0,
-28,12,4,2,
-28,12,6,4,
-28,12,8,6,
-28,12,10,8,
-28,12,16,14,
-28,12,18,16,
-28,12,20,18,
-28,12,22,20,
-28,12,24,22,
-28,12,26,24,
-28,12,0,30,
-30,14,2,0,
-30,14,4,2,
-30,14,6,4,
-30,14,8,6,
-30,14,10,8,
-30,14,12,10,
-30,14,18,16,
-30,14,20,18,
-30,14,22,20,
-30,14,24,22,
-30,14,26,24,
-30,14,28,26
-
-};
+const PATTERN_CONFIG pattern_16_opposition = { 16, 8, 1, PATTERN_FLAG_SKIP_INJECTION };   // 192 quads 
 
 /****************************************
 This is the opposition sequence for 32 elextrodes where: 
 
 ex_mat = eit_scan_lines(ne=32, dist=16) step = 1
 **********************************************/
-const e_config electrode_configuration_32_opposition[896] = { 
-0,16,2,1,
-0,16,3,2,
-0,16,4,3,
-0,16,5,4,
-0,16,6,5,
-0,16,7,6,
-0,16,8,7,
-0,16,9,8,
-0,16,10,9,
-0,16,11,10,
-0,16,12,11,
-0,16,13,12,
-0,16,14,13,
-0,16,15,14,
-0,16,18,17,
-0,16,19,18,
-0,16,20,19,
-0,16,21,20,
-0,16,22,21,
-0,16,23,22,
-0,16,24,23,
-0,16,25,24,
-0,16,26,25,
-0,16,27,26,
-0,16,28,27,
-0,16,29,28,
-0,16,30,29,
-0,16,31,30,
-1,17,3,2,
-1,17,4,3,
-1,17,5,4,
-1,17,6,5,
-1,17,7,6,
-1,17,8,7,
-1,17,9,8,
-1,17,10,9,
-1,17,11,10,
-1,17,12,11,
-1,17,13,12,
-1,17,14,13,
-1,17,15,14,
-1,17,16,15,
-1,17,19,18,
-1,17,20,19,
-1,17,21,20,
-1,17,22,21,
-1,17,23,22,
-1,17,24,23,
-1,17,25,24,
-1,17,26,25,
-1,17,27,26,
-1,17,28,27,
-1,17,29,28,
-1,17,30,29,
-1,17,31,30,
-1,17,0,31,
-2,18,1,0,
-2,18,4,3,
-2,18,5,4,
-2,18,6,5,
-2,18,7,6,
-2,18,8,7,
-2,18,9,8,
-2,18,10,9,
-2,18,11,10,
-2,18,12,11,
-2,18,13,12,
-2,18,14,13,
-2,18,15,14,
-2,18,16,15,
-2,18,17,16,
-2,18,20,19,
-2,18,21,20,
-2,18,22,21,
-2,18,23,22,
-2,18,24,23,
-2,18,25,24,
-2,18,26,25,
-2,18,27,26,
-2,18,28,27,
-2,18,29,28,
-2,18,30,29,
-2,18,31,30,
-2,18,0,31,
-3,19,1,0,
-3,19,2,1,
-3,19,5,4,
-3,19,6,5,
-3,19,7,6,
-3,19,8,7,
-3,19,9,8,
-3,19,10,9,
-3,19,11,10,
-3,19,12,11,
-3,19,13,12,
-3,19,14,13,
-3,19,15,14,
-3,19,16,15,
-3,19,17,16,
-3,19,18,17,
-3,19,21,20,
-3,19,22,21,
-3,19,23,22,
-3,19,24,23,
-3,19,25,24,
-3,19,26,25,
-3,19,27,26,
-3,19,28,27,
-3,19,29,28,
-3,19,30,29,
-3,19,31,30,
-3,19,0,31,
-4,20,1,0,
-4,20,2,1,
-4,20,3,2,
-4,20,6,5,
-4,20,7,6,
-4,20,8,7,
-4,20,9,8,
-4,20,10,9,
-4,20,11,10,
-4,20,12,11,
-4,20,13,12,
-4,20,14,13,
-4,20,15,14,
-4,20,16,15,
-4,20,17,16,
-4,20,18,17,
-4,20,19,18,
-4,20,22,21,
-4,20,23,22,
-4,20,24,23,
-4,20,25,24,
-4,20,26,25,
-4,20,27,26,
-4,20,28,27,
-4,20,29,28,
-4,20,30,29,
-4,20,31,30,
-4,20,0,31,
-5,21,1,0,
-5,21,2,1,
-5,21,3,2,
-5,21,4,3,
-5,21,7,6,
-5,21,8,7,
-5,21,9,8,
-5,21,10,9,
-5,21,11,10,
-5,21,12,11,
-5,21,13,12,
-5,21,14,13,
-5,21,15,14,
-5,21,16,15,
-5,21,17,16,
-5,21,18,17,
-5,21,19,18,
-5,21,20,19,
-5,21,23,22,
-5,21,24,23,
-5,21,25,24,
-5,21,26,25,
-5,21,27,26,
-5,21,28,27,
-5,21,29,28,
-5,21,30,29,
-5,21,31,30,
-5,21,0,31,
-6,22,1,0,
-6,22,2,1,
-6,22,3,2,
-6,22,4,3,
-6,22,5,4,
-6,22,8,7,
-6,22,9,8,
-6,22,10,9,
-6,22,11,10,
-6,22,12,11,
-6,22,13,12,
-6,22,14,13,
-6,22,15,14,
-6,22,16,15,
-6,22,17,16,
-6,22,18,17,
-6,22,19,18,
-6,22,20,19,
-6,22,21,20,
-6,22,24,23,
-6,22,25,24,
-6,22,26,25,
-6,22,27,26,
-6,22,28,27,
-6,22,29,28,
-6,22,30,29,
-6,22,31,30,
-6,22,0,31,
-7,23,1,0,
-7,23,2,1,
-7,23,3,2,
-7,23,4,3,
-7,23,5,4,
-7,23,6,5,
-7,23,9,8,
-7,23,10,9,
-7,23,11,10,
-7,23,12,11,
-7,23,13,12,
-7,23,14,13,
-7,23,15,14,
-7,23,16,15,
-7,23,17,16,
-7,23,18,17,
-7,23,19,18,
-7,23,20,19,
-7,23,21,20,
-7,23,22,21,
-7,23,25,24,
-7,23,26,25,
-7,23,27,26,
-7,23,28,27,
-7,23,29,28,
-7,23,30,29,
-7,23,31,30,
-7,23,0,31,
-8,24,1,0,
-8,24,2,1,
-8,24,3,2,
-8,24,4,3,
-8,24,5,4,
-8,24,6,5,
-8,24,7,6,
-8,24,10,9,
-8,24,11,10,
-8,24,12,11,
-8,24,13,12,
-8,24,14,13,
-8,24,15,14,
-8,24,16,15,
-8,24,17,16,
-8,24,18,17,
-8,24,19,18,
-8,24,20,19,
-8,24,21,20,
-8,24,22,21,
-8,24,23,22,
-8,24,26,25,
-8,24,27,26,
-8,24,28,27,
-8,24,29,28,
-8,24,30,29,
-8,24,31,30,
-8,24,0,31,
-9,25,1,0,
-9,25,2,1,
-9,25,3,2,
-9,25,4,3,
-9,25,5,4,
-9,25,6,5,
-9,25,7,6,
-9,25,8,7,
-9,25,11,10,
-9,25,12,11,
-9,25,13,12,
-9,25,14,13,
-9,25,15,14,
-9,25,16,15,
-9,25,17,16,
-9,25,18,17,
-9,25,19,18,
-9,25,20,19,
-9,25,21,20,
-9,25,22,21,
-9,25,23,22,
-9,25,24,23,
-9,25,27,26,
-9,25,28,27,
-9,25,29,28,
-9,25,30,29,
-9,25,31,30,
-9,25,0,31,
-10,26,1,0,
-10,26,2,1,
-10,26,3,2,
-10,26,4,3,
-10,26,5,4,
-10,26,6,5,
-10,26,7,6,
-10,26,8,7,
-10,26,9,8,
-10,26,12,11,
-10,26,13,12,
-10,26,14,13,
-10,26,15,14,
-10,26,16,15,
-10,26,17,16,
-10,26,18,17,
-10,26,19,18,
-10,26,20,19,
-10,26,21,20,
-10,26,22,21,
-10,26,23,22,
-10,26,24,23,
-10,26,25,24,
-10,26,28,27,
-10,26,29,28,
-10,26,30,29,
-10,26,31,30,
-10,26,0,31,
-11,27,1,0,
-11,27,2,1,
-11,27,3,2,
-11,27,4,3,
-11,27,5,4,
-11,27,6,5,
-11,27,7,6,
-11,27,8,7,
-11,27,9,8,
-11,27,10,9,
-11,27,13,12,
-11,27,14,13,
-11,27,15,14,
-11,27,16,15,
-11,27,17,16,
-11,27,18,17,
-11,27,19,18,
-11,27,20,19,
-11,27,21,20,
-11,27,22,21,
-11,27,23,22,
-11,27,24,23,
-11,27,25,24,
-11,27,26,25,
-11,27,29,28,
-11,27,30,29,
-11,27,31,30,
-11,27,0,31,
-12,28,1,0,
-12,28,2,1,
-12,28,3,2,
-12,28,4,3,
-12,28,5,4,
-12,28,6,5,
-12,28,7,6,
-12,28,8,7,
-12,28,9,8,
-12,28,10,9,
-12,28,11,10,
-12,28,14,13,
-12,28,15,14,
-12,28,16,15,
-12,28,17,16,
-12,28,18,17,
-12,28,19,18,
-12,28,20,19,
-12,28,21,20,
-12,28,22,21,
-12,28,23,22,
-12,28,24,23,
-12,28,25,24,
-12,28,26,25,
-12,28,27,26,
-12,28,30,29,
-12,28,31,30,
-12,28,0,31,
-13,29,1,0,
-13,29,2,1,
-13,29,3,2,
-13,29,4,3,
-13,29,5,4,
-13,29,6,5,
-13,29,7,6,
-13,29,8,7,
-13,29,9,8,
-13,29,10,9,
-13,29,11,10,
-13,29,12,11,
-13,29,15,14,
-13,29,16,15,
-13,29,17,16,
-13,29,18,17,
-13,29,19,18,
-13,29,20,19,
-13,29,21,20,
-13,29,22,21,
-13,29,23,22,
-13,29,24,23,
-13,29,25,24,
-13,29,26,25,
-13,29,27,26,
-13,29,28,27,
-13,29,31,30,
-13,29,0,31,
-14,30,1,0,
-14,30,2,1,
-14,30,3,2,
-14,30,4,3,
-14,30,5,4,
-14,30,6,5,
-14,30,7,6,
-14,30,8,7,
-14,30,9,8,
-14,30,10,9,
-14,30,11,10,
-14,30,12,11,
-14,30,13,12,
-14,30,16,15,
-14,30,17,16,
-14,30,18,17,
-14,30,19,18,
-14,30,20,19,
-14,30,21,20,
-14,30,22,21,
-14,30,23,22,
-14,30,24,23,
-14,30,25,24,
-14,30,26,25,
-14,30,27,26,
-14,30,28,27,
-14,30,29,28,
-14,30,0,31,
-15,31,1,0,
-15,31,2,1,
-15,31,3,2,
-15,31,4,3,
-15,31,5,4,
-15,31,6,5,
-15,31,7,6,
-15,31,8,7,
-15,31,9,8,
-15,31,10,9,
-15,31,11,10,
-15,31,12,11,
-15,31,13,12,
-15,31,14,13,
-15,31,17,16,
-15,31,18,17,
-15,31,19,18,
-15,31,20,19,
-15,31,21,20,
-15,31,22,21,
-15,31,23,22,
-15,31,24,23,
-15,31,25,24,
-15,31,26,25,
-15,31,27,26,
-15,31,28,27,
-15,31,29,28,
-15,31,30,29,
-16,0,2,1,
-16,0,3,2,
-16,0,4,3,
-16,0,5,4,
-16,0,6,5,
-16,0,7,6,
-16,0,8,7,
-16,0,9,8,
-16,0,10,9,
-16,0,11,10,
-16,0,12,11,
-16,0,13,12,
-16,0,14,13,
-16,0,15,14,
-16,0,18,17,
-16,0,19,18,
-16,0,20,19,
-16,0,21,20,
-16,0,22,21,
-16,0,23,22,
-16,0,24,23,
-16,0,25,24,
-16,0,26,25,
-16,0,27,26,
-16,0,28,27,
-16,0,29,28,
-16,0,30,29,
-16,0,31,30,
-17,1,3,2,
-17,1,4,3,
-17,1,5,4,
-17,1,6,5,
-17,1,7,6,
-17,1,8,7,
-17,1,9,8,
-17,1,10,9,
-17,1,11,10,
-17,1,12,11,
-17,1,13,12,
-17,1,14,13,
-17,1,15,14,
-17,1,16,15,
-17,1,19,18,
-17,1,20,19,
-17,1,21,20,
-17,1,22,21,
-17,1,23,22,
-17,1,24,23,
-17,1,25,24,
-17,1,26,25,
-17,1,27,26,
-17,1,28,27,
-17,1,29,28,
-17,1,30,29,
-17,1,31,30,
-17,1,0,31,
-18,2,1,0,
-18,2,4,3,
-18,2,5,4,
-18,2,6,5,
-18,2,7,6,
-18,2,8,7,
-18,2,9,8,
-18,2,10,9,
-18,2,11,10,
-18,2,12,11,
-18,2,13,12,
-18,2,14,13,
-18,2,15,14,
-18,2,16,15,
-18,2,17,16,
-18,2,20,19,
-18,2,21,20,
-18,2,22,21,
-18,2,23,22,
-18,2,24,23,
-18,2,25,24,
-18,2,26,25,
-18,2,27,26,
-18,2,28,27,
-18,2,29,28,
-18,2,30,29,
-18,2,31,30,
-18,2,0,31,
-19,3,1,0,
-19,3,2,1,
-19,3,5,4,
-19,3,6,5,
-19,3,7,6,
-19,3,8,7,
-19,3,9,8,
-19,3,10,9,
-19,3,11,10,
-19,3,12,11,
-19,3,13,12,
-19,3,14,13,
-19,3,15,14,
-19,3,16,15,
-19,3,17,16,
-19,3,18,17,
-19,3,21,20,
-19,3,22,21,
-19,3,23,22,
-19,3,24,23,
-19,3,25,24,
-19,3,26,25,
-19,3,27,26,
-19,3,28,27,
-19,3,29,28,
-19,3,30,29,
-19,3,31,30,
-19,3,0,31,
-20,4,1,0,
-20,4,2,1,
-20,4,3,2,
-20,4,6,5,
-20,4,7,6,
-20,4,8,7,
-20,4,9,8,
-20,4,10,9,
-20,4,11,10,
-20,4,12,11,
-20,4,13,12,
-20,4,14,13,
-20,4,15,14,
-20,4,16,15,
-20,4,17,16,
-20,4,18,17,
-20,4,19,18,
-20,4,22,21,
-20,4,23,22,
-20,4,24,23,
-20,4,25,24,
-20,4,26,25,
-20,4,27,26,
-20,4,28,27,
-20,4,29,28,
-20,4,30,29,
-20,4,31,30,
-20,4,0,31,
-21,5,1,0,
-21,5,2,1,
-21,5,3,2,
-21,5,4,3,
-21,5,7,6,
-21,5,8,7,
-21,5,9,8,
-21,5,10,9,
-21,5,11,10,
-21,5,12,11,
-21,5,13,12,
-21,5,14,13,
-21,5,15,14,
-21,5,16,15,
-21,5,17,16,
-21,5,18,17,
-21,5,19,18,
-21,5,20,19,
-21,5,23,22,
-21,5,24,23,
-21,5,25,24,
-21,5,26,25,
-21,5,27,26,
-21,5,28,27,
-21,5,29,28,
-21,5,30,29,
-21,5,31,30,
-21,5,0,31,
-22,6,1,0,
-22,6,2,1,
-22,6,3,2,
-22,6,4,3,
-22,6,5,4,
-22,6,8,7,
-22,6,9,8,
-22,6,10,9,
-22,6,11,10,
-22,6,12,11,
-22,6,13,12,
-22,6,14,13,
-22,6,15,14,
-22,6,16,15,
-22,6,17,16,
-22,6,18,17,
-22,6,19,18,
-22,6,20,19,
-22,6,21,20,
-22,6,24,23,
-22,6,25,24,
-22,6,26,25,
-22,6,27,26,
-22,6,28,27,
-22,6,29,28,
-22,6,30,29,
-22,6,31,30,
-22,6,0,31,
-23,7,1,0,
-23,7,2,1,
-23,7,3,2,
-23,7,4,3,
-23,7,5,4,
-23,7,6,5,
-23,7,9,8,
-23,7,10,9,
-23,7,11,10,
-23,7,12,11,
-23,7,13,12,
-23,7,14,13,
-23,7,15,14,
-23,7,16,15,
-23,7,17,16,
-23,7,18,17,
-23,7,19,18,
-23,7,20,19,
-23,7,21,20,
-23,7,22,21,
-23,7,25,24,
-23,7,26,25,
-23,7,27,26,
-23,7,28,27,
-23,7,29,28,
-23,7,30,29,
-23,7,31,30,
-23,7,0,31,
-24,8,1,0,
-24,8,2,1,
-24,8,3,2,
-24,8,4,3,
-24,8,5,4,
-24,8,6,5,
-24,8,7,6,
-24,8,10,9,
-24,8,11,10,
-24,8,12,11,
-24,8,13,12,
-24,8,14,13,
-24,8,15,14,
-24,8,16,15,
-24,8,17,16,
-24,8,18,17,
-24,8,19,18,
-24,8,20,19,
-24,8,21,20,
-24,8,22,21,
-24,8,23,22,
-24,8,26,25,
-24,8,27,26,
-24,8,28,27,
-24,8,29,28,
-24,8,30,29,
-24,8,31,30,
-24,8,0,31,
-25,9,1,0,
-25,9,2,1,
-25,9,3,2,
-25,9,4,3,
-25,9,5,4,
-25,9,6,5,
-25,9,7,6,
-25,9,8,7,
-25,9,11,10,
-25,9,12,11,
-25,9,13,12,
-25,9,14,13,
-25,9,15,14,
-25,9,16,15,
-25,9,17,16,
-25,9,18,17,
-25,9,19,18,
-25,9,20,19,
-25,9,21,20,
-25,9,22,21,
-25,9,23,22,
-25,9,24,23,
-25,9,27,26,
-25,9,28,27,
-25,9,29,28,
-25,9,30,29,
-25,9,31,30,
-25,9,0,31,
-26,10,1,0,
-26,10,2,1,
-26,10,3,2,
-26,10,4,3,
-26,10,5,4,
-26,10,6,5,
-26,10,7,6,
-26,10,8,7,
-26,10,9,8,
-26,10,12,11,
-26,10,13,12,
-26,10,14,13,
-26,10,15,14,
-26,10,16,15,
-26,10,17,16,
-26,10,18,17,
-26,10,19,18,
-26,10,20,19,
-26,10,21,20,
-26,10,22,21,
-26,10,23,22,
-26,10,24,23,
-26,10,25,24,
-26,10,28,27,
-26,10,29,28,
-26,10,30,29,
-26,10,31,30,
-26,10,0,31,
-27,11,1,0,
-27,11,2,1,
-27,11,3,2,
-27,11,4,3,
-27,11,5,4,
-27,11,6,5,
-27,11,7,6,
-27,11,8,7,
-27,11,9,8,
-27,11,10,9,
-27,11,13,12,
-27,11,14,13,
-27,11,15,14,
-27,11,16,15,
-27,11,17,16,
-27,11,18,17,
-27,11,19,18,
-27,11,20,19,
-27,11,21,20,
-27,11,22,21,
-27,11,23,22,
-27,11,24,23,
-27,11,25,24,
-27,11,26,25,
-27,11,29,28,
-27,11,30,29,
-27,11,31,30,
-27,11,0,31,
-28,12,1,0,
-28,12,2,1,
-28,12,3,2,
-28,12,4,3,
-28,12,5,4,
-28,12,6,5,
-28,12,7,6,
-28,12,8,7,
-28,12,9,8,
-28,12,10,9,
-28,12,11,10,
-28,12,14,13,
-28,12,15,14,
-28,12,16,15,
-28,12,17,16,
-28,12,18,17,
-28,12,19,18,
-28,12,20,19,
-28,12,21,20,
-28,12,22,21,
-28,12,23,22,
-28,12,24,23,
-28,12,25,24,
-28,12,26,25,
-28,12,27,26,
-28,12,30,29,
-28,12,31,30,
-28,12,0,31,
-29,13,1,0,
-29,13,2,1,
-29,13,3,2,
-29,13,4,3,
-29,13,5,4,
-29,13,6,5,
-29,13,7,6,
-29,13,8,7,
-29,13,9,8,
-29,13,10,9,
-29,13,11,10,
-29,13,12,11,
-29,13,15,14,
-29,13,16,15,
-29,13,17,16,
-29,13,18,17,
-29,13,19,18,
-29,13,20,19,
-29,13,21,20,
-29,13,22,21,
-29,13,23,22,
-29,13,24,23,
-29,13,25,24,
-29,13,26,25,
-29,13,27,26,
-29,13,28,27,
-29,13,31,30,
-29,13,0,31,
-30,14,1,0,
-30,14,2,1,
-30,14,3,2,
-30,14,4,3,
-30,14,5,4,
-30,14,6,5,
-30,14,7,6,
-30,14,8,7,
-30,14,9,8,
-30,14,10,9,
-30,14,11,10,
-30,14,12,11,
-30,14,13,12,
-30,14,16,15,
-30,14,17,16,
-30,14,18,17,
-30,14,19,18,
-30,14,20,19,
-30,14,21,20,
-30,14,22,21,
-30,14,23,22,
-30,14,24,23,
-30,14,25,24,
-30,14,26,25,
-30,14,27,26,
-30,14,28,27,
-30,14,29,28,
-30,14,0,31,
-31,15,1,0,
-31,15,2,1,
-31,15,3,2,
-31,15,4,3,
-31,15,5,4,
-31,15,6,5,
-31,15,7,6,
-31,15,8,7,
-31,15,9,8,
-31,15,10,9,
-31,15,11,10,
-31,15,12,11,
-31,15,13,12,
-31,15,14,13,
-31,15,17,16,
-31,15,18,17,
-31,15,19,18,
-31,15,20,19,
-31,15,21,20,
-31,15,22,21,
-31,15,23,22,
-31,15,24,23,
-31,15,25,24,
-31,15,26,25,
-31,15,27,26,
-31,15,28,27,
-31,15,29,28,
-31,15,30,29
-  
-};
+const PATTERN_CONFIG pattern_32_opposition = { 32, 16, 1, PATTERN_FLAG_SKIP_INJECTION };  // 896 quads 
+
 /****************************************
 This is the 928 adjacent sequence where: 
 // In the file the ordering is:
@@ -1172,1033 +50,10 @@ with one pos (A), neg(B) driven pairs.
     B : current sink
     M, N : boundary electrodes, where v_diff = v_n - v_m
 **********************************************/
-  
-const e_config electrode_configuration_32_adjacent[928] = { 
-{0,1,2,3},
-{0,1,3,4},
-{0,1,4,5},
-{0,1,5,6},
-{0,1,6,7},
-{0,1,7,8},
-{0,1,8,9},
-{0,1,9,10},
-{0,1,10,11},
-{0,1,11,12},
-{0,1,12,13},
-{0,1,13,14},
-{0,1,14,15},
-{0,1,15,16},
-{0,1,16,17},
-{0,1,17,18},
-{0,1,18,19},
-{0,1,19,20},
-{0,1,20,21},
-{0,1,21,22},
-{0,1,22,23},
-{0,1,23,24},
-{0,1,24,25},
-{0,1,25,26},
-{0,1,26,27},
-{0,1,27,28},
-{0,1,28,29},
-{0,1,29,30},
-{0,1,30,31},
-{1,2,3,4},
-{1,2,4,5},
-{1,2,5,6},
-{1,2,6,7},
-{1,2,7,8},
-{1,2,8,9},
-{1,2,9,10},
-{1,2,10,11},
-{1,2,11,12},
-{1,2,12,13},
-{1,2,13,14},
-{1,2,14,15},
-{1,2,15,16},
-{1,2,16,17},
-{1,2,17,18},
-{1,2,18,19},
-{1,2,19,20},
-{1,2,20,21},
-{1,2,21,22},
-{1,2,22,23},
-{1,2,23,24},
-{1,2,24,25},
-{1,2,25,26},
-{1,2,26,27},
-{1,2,27,28},
-{1,2,28,29},
-{1,2,29,30},
-{1,2,30,31},
-{1,2,31,0},
-{2,3,0,1},
-{2,3,4,5},
-{2,3,5,6},
-{2,3,6,7},
-{2,3,7,8},
-{2,3,8,9},
-{2,3,9,10},
-{2,3,10,11},
-{2,3,11,12},
-{2,3,12,13},
-{2,3,13,14},
-{2,3,14,15},
-{2,3,15,16},
-{2,3,16,17},
-{2,3,17,18},
-{2,3,18,19},
-{2,3,19,20},
-{2,3,20,21},
-{2,3,21,22},
-{2,3,22,23},
-{2,3,23,24},
-{2,3,24,25},
-{2,3,25,26},
-{2,3,26,27},
-{2,3,27,28},
-{2,3,28,29},
-{2,3,29,30},
-{2,3,30,31},
-{2,3,31,0},
-{3,4,0,1},
-{3,4,1,2},
-{3,4,5,6},
-{3,4,6,7},
-{3,4,7,8},
-{3,4,8,9},
-{3,4,9,10},
-{3,4,10,11},
-{3,4,11,12},
-{3,4,12,13},
-{3,4,13,14},
-{3,4,14,15},
-{3,4,15,16},
-{3,4,16,17},
-{3,4,17,18},
-{3,4,18,19},
-{3,4,19,20},
-{3,4,20,21},
-{3,4,21,22},
-{3,4,22,23},
-{3,4,23,24},
-{3,4,24,25},
-{3,4,25,26},
-{3,4,26,27},
-{3,4,27,28},
-{3,4,28,29},
-{3,4,29,30},
-{3,4,30,31},
-{3,4,31,0},
-{4,5,0,1},
-{4,5,1,2},
-{4,5,2,3},
-{4,5,6,7},
-{4,5,7,8},
-{4,5,8,9},
-{4,5,9,10},
-{4,5,10,11},
-{4,5,11,12},
-{4,5,12,13},
-{4,5,13,14},
-{4,5,14,15},
-{4,5,15,16},
-{4,5,16,17},
-{4,5,17,18},
-{4,5,18,19},
-{4,5,19,20},
-{4,5,20,21},
-{4,5,21,22},
-{4,5,22,23},
-{4,5,23,24},
-{4,5,24,25},
-{4,5,25,26},
-{4,5,26,27},
-{4,5,27,28},
-{4,5,28,29},
-{4,5,29,30},
-{4,5,30,31},
-{4,5,31,0},
-{5,6,0,1},
-{5,6,1,2},
-{5,6,2,3},
-{5,6,3,4},
-{5,6,7,8},
-{5,6,8,9},
-{5,6,9,10},
-{5,6,10,11},
-{5,6,11,12},
-{5,6,12,13},
-{5,6,13,14},
-{5,6,14,15},
-{5,6,15,16},
-{5,6,16,17},
-{5,6,17,18},
-{5,6,18,19},
-{5,6,19,20},
-{5,6,20,21},
-{5,6,21,22},
-{5,6,22,23},
-{5,6,23,24},
-{5,6,24,25},
-{5,6,25,26},
-{5,6,26,27},
-{5,6,27,28},
-{5,6,28,29},
-{5,6,29,30},
-{5,6,30,31},
-{5,6,31,0},
-{6,7,0,1},
-{6,7,1,2},
-{6,7,2,3},
-{6,7,3,4},
-{6,7,4,5},
-{6,7,8,9},
-{6,7,9,10},
-{6,7,10,11},
-{6,7,11,12},
-{6,7,12,13},
-{6,7,13,14},
-{6,7,14,15},
-{6,7,15,16},
-{6,7,16,17},
-{6,7,17,18},
-{6,7,18,19},
-{6,7,19,20},
-{6,7,20,21},
-{6,7,21,22},
-{6,7,22,23},
-{6,7,23,24},
-{6,7,24,25},
-{6,7,25,26},
-{6,7,26,27},
-{6,7,27,28},
-{6,7,28,29},
-{6,7,29,30},
-{6,7,30,31},
-{6,7,31,0},
-{7,8,0,1},
-{7,8,1,2},
-{7,8,2,3},
-{7,8,3,4},
-{7,8,4,5},
-{7,8,5,6},
-{7,8,9,10},
-{7,8,10,11},
-{7,8,11,12},
-{7,8,12,13},
-{7,8,13,14},
-{7,8,14,15},
-{7,8,15,16},
-{7,8,16,17},
-{7,8,17,18},
-{7,8,18,19},
-{7,8,19,20},
-{7,8,20,21},
-{7,8,21,22},
-{7,8,22,23},
-{7,8,23,24},
-{7,8,24,25},
-{7,8,25,26},
-{7,8,26,27},
-{7,8,27,28},
-{7,8,28,29},
-{7,8,29,30},
-{7,8,30,31},
-{7,8,31,0},
-{8,9,0,1},
-{8,9,1,2},
-{8,9,2,3},
-{8,9,3,4},
-{8,9,4,5},
-{8,9,5,6},
-{8,9,6,7},
-{8,9,10,11},
-{8,9,11,12},
-{8,9,12,13},
-{8,9,13,14},
-{8,9,14,15},
-{8,9,15,16},
-{8,9,16,17},
-{8,9,17,18},
-{8,9,18,19},
-{8,9,19,20},
-{8,9,20,21},
-{8,9,21,22},
-{8,9,22,23},
-{8,9,23,24},
-{8,9,24,25},
-{8,9,25,26},
-{8,9,26,27},
-{8,9,27,28},
-{8,9,28,29},
-{8,9,29,30},
-{8,9,30,31},
-{8,9,31,0},
-{9,10,0,1},
-{9,10,1,2},
-{9,10,2,3},
-{9,10,3,4},
-{9,10,4,5},
-{9,10,5,6},
-{9,10,6,7},
-{9,10,7,8},
-{9,10,11,12},
-{9,10,12,13},
-{9,10,13,14},
-{9,10,14,15},
-{9,10,15,16},
-{9,10,16,17},
-{9,10,17,18},
-{9,10,18,19},
-{9,10,19,20},
-{9,10,20,21},
-{9,10,21,22},
-{9,10,22,23},
-{9,10,23,24},
-{9,10,24,25},
-{9,10,25,26},
-{9,10,26,27},
-{9,10,27,28},
-{9,10,28,29},
-{9,10,29,30},
-{9,10,30,31},
-{9,10,31,0},
-{10,11,0,1},
-{10,11,1,2},
-{10,11,2,3},
-{10,11,3,4},
-{10,11,4,5},
-{10,11,5,6},
-{10,11,6,7},
-{10,11,7,8},
-{10,11,8,9},
-{10,11,12,13},
-{10,11,13,14},
-{10,11,14,15},
-{10,11,15,16},
-{10,11,16,17},
-{10,11,17,18},
-{10,11,18,19},
-{10,11,19,20},
-{10,11,20,21},
-{10,11,21,22},
-{10,11,22,23},
-{10,11,23,24},
-{10,11,24,25},
-{10,11,25,26},
-{10,11,26,27},
-{10,11,27,28},
-{10,11,28,29},
-{10,11,29,30},
-{10,11,30,31},
-{10,11,31,0},
-{11,12,0,1},
-{11,12,1,2},
-{11,12,2,3},
-{11,12,3,4},
-{11,12,4,5},
-{11,12,5,6},
-{11,12,6,7},
-{11,12,7,8},
-{11,12,8,9},
-{11,12,9,10},
-{11,12,13,14},
-{11,12,14,15},
-{11,12,15,16},
-{11,12,16,17},
-{11,12,17,18},
-{11,12,18,19},
-{11,12,19,20},
-{11,12,20,21},
-{11,12,21,22},
-{11,12,22,23},
-{11,12,23,24},
-{11,12,24,25},
-{11,12,25,26},
-{11,12,26,27},
-{11,12,27,28},
-{11,12,28,29},
-{11,12,29,30},
-{11,12,30,31},
-{11,12,31,0},
-{12,13,0,1},
-{12,13,1,2},
-{12,13,2,3},
-{12,13,3,4},
-{12,13,4,5},
-{12,13,5,6},
-{12,13,6,7},
-{12,13,7,8},
-{12,13,8,9},
-{12,13,9,10},
-{12,13,10,11},
-{12,13,14,15},
-{12,13,15,16},
-{12,13,16,17},
-{12,13,17,18},
-{12,13,18,19},
-{12,13,19,20},
-{12,13,20,21},
-{12,13,21,22},
-{12,13,22,23},
-{12,13,23,24},
-{12,13,24,25},
-{12,13,25,26},
-{12,13,26,27},
-{12,13,27,28},
-{12,13,28,29},
-{12,13,29,30},
-{12,13,30,31},
-{12,13,31,0},
-{13,14,0,1},
-{13,14,1,2},
-{13,14,2,3},
-{13,14,3,4},
-{13,14,4,5},
-{13,14,5,6},
-{13,14,6,7},
-{13,14,7,8},
-{13,14,8,9},
-{13,14,9,10},
-{13,14,10,11},
-{13,14,11,12},
-{13,14,15,16},
-{13,14,16,17},
-{13,14,17,18},
-{13,14,18,19},
-{13,14,19,20},
-{13,14,20,21},
-{13,14,21,22},
-{13,14,22,23},
-{13,14,23,24},
-{13,14,24,25},
-{13,14,25,26},
-{13,14,26,27},
-{13,14,27,28},
-{13,14,28,29},
-{13,14,29,30},
-{13,14,30,31},
-{13,14,31,0},
-{14,15,0,1},
-{14,15,1,2},
-{14,15,2,3},
-{14,15,3,4},
-{14,15,4,5},
-{14,15,5,6},
-{14,15,6,7},
-{14,15,7,8},
-{14,15,8,9},
-{14,15,9,10},
-{14,15,10,11},
-{14,15,11,12},
-{14,15,12,13},
-{14,15,16,17},
-{14,15,17,18},
-{14,15,18,19},
-{14,15,19,20},
-{14,15,20,21},
-{14,15,21,22},
-{14,15,22,23},
-{14,15,23,24},
-{14,15,24,25},
-{14,15,25,26},
-{14,15,26,27},
-{14,15,27,28},
-{14,15,28,29},
-{14,15,29,30},
-{14,15,30,31},
-{14,15,31,0},
-{15,16,0,1},
-{15,16,1,2},
-{15,16,2,3},
-{15,16,3,4},
-{15,16,4,5},
-{15,16,5,6},
-{15,16,6,7},
-{15,16,7,8},
-{15,16,8,9},
-{15,16,9,10},
-{15,16,10,11},
-{15,16,11,12},
-{15,16,12,13},
-{15,16,13,14},
-{15,16,17,18},
-{15,16,18,19},
-{15,16,19,20},
-{15,16,20,21},
-{15,16,21,22},
-{15,16,22,23},
-{15,16,23,24},
-{15,16,24,25},
-{15,16,25,26},
-{15,16,26,27},
-{15,16,27,28},
-{15,16,28,29},
-{15,16,29,30},
-{15,16,30,31},
-{15,16,31,0},
-{16,17,0,1},
-{16,17,1,2},
-{16,17,2,3},
-{16,17,3,4},
-{16,17,4,5},
-{16,17,5,6},
-{16,17,6,7},
-{16,17,7,8},
-{16,17,8,9},
-{16,17,9,10},
-{16,17,10,11},
-{16,17,11,12},
-{16,17,12,13},
-{16,17,13,14},
-{16,17,14,15},
-{16,17,18,19},
-{16,17,19,20},
-{16,17,20,21},
-{16,17,21,22},
-{16,17,22,23},
-{16,17,23,24},
-{16,17,24,25},
-{16,17,25,26},
-{16,17,26,27},
-{16,17,27,28},
-{16,17,28,29},
-{16,17,29,30},
-{16,17,30,31},
-{16,17,31,0},
-{17,18,0,1},
-{17,18,1,2},
-{17,18,2,3},
-{17,18,3,4},
-{17,18,4,5},
-{17,18,5,6},
-{17,18,6,7},
-{17,18,7,8},
-{17,18,8,9},
-{17,18,9,10},
-{17,18,10,11},
-{17,18,11,12},
-{17,18,12,13},
-{17,18,13,14},
-{17,18,14,15},
-{17,18,15,16},
-{17,18,19,20},
-{17,18,20,21},
-{17,18,21,22},
-{17,18,22,23},
-{17,18,23,24},
-{17,18,24,25},
-{17,18,25,26},
-{17,18,26,27},
-{17,18,27,28},
-{17,18,28,29},
-{17,18,29,30},
-{17,18,30,31},
-{17,18,31,0},
-{18,19,0,1},
-{18,19,1,2},
-{18,19,2,3},
-{18,19,3,4},
-{18,19,4,5},
-{18,19,5,6},
-{18,19,6,7},
-{18,19,7,8},
-{18,19,8,9},
-{18,19,9,10},
-{18,19,10,11},
-{18,19,11,12},
-{18,19,12,13},
-{18,19,13,14},
-{18,19,14,15},
-{18,19,15,16},
-{18,19,16,17},
-{18,19,20,21},
-{18,19,21,22},
-{18,19,22,23},
-{18,19,23,24},
-{18,19,24,25},
-{18,19,25,26},
-{18,19,26,27},
-{18,19,27,28},
-{18,19,28,29},
-{18,19,29,30},
-{18,19,30,31},
-{18,19,31,0},
-{19,20,0,1},
-{19,20,1,2},
-{19,20,2,3},
-{19,20,3,4},
-{19,20,4,5},
-{19,20,5,6},
-{19,20,6,7},
-{19,20,7,8},
-{19,20,8,9},
-{19,20,9,10},
-{19,20,10,11},
-{19,20,11,12},
-{19,20,12,13},
-{19,20,13,14},
-{19,20,14,15},
-{19,20,15,16},
-{19,20,16,17},
-{19,20,17,18},
-{19,20,21,22},
-{19,20,22,23},
-{19,20,23,24},
-{19,20,24,25},
-{19,20,25,26},
-{19,20,26,27},
-{19,20,27,28},
-{19,20,28,29},
-{19,20,29,30},
-{19,20,30,31},
-{19,20,31,0},
-{20,21,0,1},
-{20,21,1,2},
-{20,21,2,3},
-{20,21,3,4},
-{20,21,4,5},
-{20,21,5,6},
-{20,21,6,7},
-{20,21,7,8},
-{20,21,8,9},
-{20,21,9,10},
-{20,21,10,11},
-{20,21,11,12},
-{20,21,12,13},
-{20,21,13,14},
-{20,21,14,15},
-{20,21,15,16},
-{20,21,16,17},
-{20,21,17,18},
-{20,21,18,19},
-{20,21,22,23},
-{20,21,23,24},
-{20,21,24,25},
-{20,21,25,26},
-{20,21,26,27},
-{20,21,27,28},
-{20,21,28,29},
-{20,21,29,30},
-{20,21,30,31},
-{20,21,31,0},
-{21,22,0,1},
-{21,22,1,2},
-{21,22,2,3},
-{21,22,3,4},
-{21,22,4,5},
-{21,22,5,6},
-{21,22,6,7},
-{21,22,7,8},
-{21,22,8,9},
-{21,22,9,10},
-{21,22,10,11},
-{21,22,11,12},
-{21,22,12,13},
-{21,22,13,14},
-{21,22,14,15},
-{21,22,15,16},
-{21,22,16,17},
-{21,22,17,18},
-{21,22,18,19},
-{21,22,19,20},
-{21,22,23,24},
-{21,22,24,25},
-{21,22,25,26},
-{21,22,26,27},
-{21,22,27,28},
-{21,22,28,29},
-{21,22,29,30},
-{21,22,30,31},
-{21,22,31,0},
-{22,23,0,1},
-{22,23,1,2},
-{22,23,2,3},
-{22,23,3,4},
-{22,23,4,5},
-{22,23,5,6},
-{22,23,6,7},
-{22,23,7,8},
-{22,23,8,9},
-{22,23,9,10},
-{22,23,10,11},
-{22,23,11,12},
-{22,23,12,13},
-{22,23,13,14},
-{22,23,14,15},
-{22,23,15,16},
-{22,23,16,17},
-{22,23,17,18},
-{22,23,18,19},
-{22,23,19,20},
-{22,23,20,21},
-{22,23,24,25},
-{22,23,25,26},
-{22,23,26,27},
-{22,23,27,28},
-{22,23,28,29},
-{22,23,29,30},
-{22,23,30,31},
-{22,23,31,0},
-{23,24,0,1},
-{23,24,1,2},
-{23,24,2,3},
-{23,24,3,4},
-{23,24,4,5},
-{23,24,5,6},
-{23,24,6,7},
-{23,24,7,8},
-{23,24,8,9},
-{23,24,9,10},
-{23,24,10,11},
-{23,24,11,12},
-{23,24,12,13},
-{23,24,13,14},
-{23,24,14,15},
-{23,24,15,16},
-{23,24,16,17},
-{23,24,17,18},
-{23,24,18,19},
-{23,24,19,20},
-{23,24,20,21},
-{23,24,21,22},
-{23,24,25,26},
-{23,24,26,27},
-{23,24,27,28},
-{23,24,28,29},
-{23,24,29,30},
-{23,24,30,31},
-{23,24,31,0},
-{24,25,0,1},
-{24,25,1,2},
-{24,25,2,3},
-{24,25,3,4},
-{24,25,4,5},
-{24,25,5,6},
-{24,25,6,7},
-{24,25,7,8},
-{24,25,8,9},
-{24,25,9,10},
-{24,25,10,11},
-{24,25,11,12},
-{24,25,12,13},
-{24,25,13,14},
-{24,25,14,15},
-{24,25,15,16},
-{24,25,16,17},
-{24,25,17,18},
-{24,25,18,19},
-{24,25,19,20},
-{24,25,20,21},
-{24,25,21,22},
-{24,25,22,23},
-{24,25,26,27},
-{24,25,27,28},
-{24,25,28,29},
-{24,25,29,30},
-{24,25,30,31},
-{24,25,31,0},
-{25,26,0,1},
-{25,26,1,2},
-{25,26,2,3},
-{25,26,3,4},
-{25,26,4,5},
-{25,26,5,6},
-{25,26,6,7},
-{25,26,7,8},
-{25,26,8,9},
-{25,26,9,10},
-{25,26,10,11},
-{25,26,11,12},
-{25,26,12,13},
-{25,26,13,14},
-{25,26,14,15},
-{25,26,15,16},
-{25,26,16,17},
-{25,26,17,18},
-{25,26,18,19},
-{25,26,19,20},
-{25,26,20,21},
-{25,26,21,22},
-{25,26,22,23},
-{25,26,23,24},
-{25,26,27,28},
-{25,26,28,29},
-{25,26,29,30},
-{25,26,30,31},
-{25,26,31,0},
-{26,27,0,1},
-{26,27,1,2},
-{26,27,2,3},
-{26,27,3,4},
-{26,27,4,5},
-{26,27,5,6},
-{26,27,6,7},
-{26,27,7,8},
-{26,27,8,9},
-{26,27,9,10},
-{26,27,10,11},
-{26,27,11,12},
-{26,27,12,13},
-{26,27,13,14},
-{26,27,14,15},
-{26,27,15,16},
-{26,27,16,17},
-{26,27,17,18},
-{26,27,18,19},
-{26,27,19,20},
-{26,27,20,21},
-{26,27,21,22},
-{26,27,22,23},
-{26,27,23,24},
-{26,27,24,25},
-{26,27,28,29},
-{26,27,29,30},
-{26,27,30,31},
-{26,27,31,0},
-{27,28,0,1},
-{27,28,1,2},
-{27,28,2,3},
-{27,28,3,4},
-{27,28,4,5},
-{27,28,5,6},
-{27,28,6,7},
-{27,28,7,8},
-{27,28,8,9},
-{27,28,9,10},
-{27,28,10,11},
-{27,28,11,12},
-{27,28,12,13},
-{27,28,13,14},
-{27,28,14,15},
-{27,28,15,16},
-{27,28,16,17},
-{27,28,17,18},
-{27,28,18,19},
-{27,28,19,20},
-{27,28,20,21},
-{27,28,21,22},
-{27,28,22,23},
-{27,28,23,24},
-{27,28,24,25},
-{27,28,25,26},
-{27,28,29,30},
-{27,28,30,31},
-{27,28,31,0},
-{28,29,0,1},
-{28,29,1,2},
-{28,29,2,3},
-{28,29,3,4},
-{28,29,4,5},
-{28,29,5,6},
-{28,29,6,7},
-{28,29,7,8},
-{28,29,8,9},
-{28,29,9,10},
-{28,29,10,11},
-{28,29,11,12},
-{28,29,12,13},
-{28,29,13,14},
-{28,29,14,15},
-{28,29,15,16},
-{28,29,16,17},
-{28,29,17,18},
-{28,29,18,19},
-{28,29,19,20},
-{28,29,20,21},
-{28,29,21,22},
-{28,29,22,23},
-{28,29,23,24},
-{28,29,24,25},
-{28,29,25,26},
-{28,29,26,27},
-{28,29,30,31},
-{28,29,31,0},
-{29,30,0,1},
-{29,30,1,2},
-{29,30,2,3},
-{29,30,3,4},
-{29,30,4,5},
-{29,30,5,6},
-{29,30,6,7},
-{29,30,7,8},
-{29,30,8,9},
-{29,30,9,10},
-{29,30,10,11},
-{29,30,11,12},
-{29,30,12,13},
-{29,30,13,14},
-{29,30,14,15},
-{29,30,15,16},
-{29,30,16,17},
-{29,30,17,18},
-{29,30,18,19},
-{29,30,19,20},
-{29,30,20,21},
-{29,30,21,22},
-{29,30,22,23},
-{29,30,23,24},
-{29,30,24,25},
-{29,30,25,26},
-{29,30,26,27},
-{29,30,27,28},
-{29,30,31,0},
-{30,31,0,1},
-{30,31,1,2},
-{30,31,2,3},
-{30,31,3,4},
-{30,31,4,5},
-{30,31,5,6},
-{30,31,6,7},
-{30,31,7,8},
-{30,31,8,9},
-{30,31,9,10},
-{30,31,10,11},
-{30,31,11,12},
-{30,31,12,13},
-{30,31,13,14},
-{30,31,14,15},
-{30,31,15,16},
-{30,31,16,17},
-{30,31,17,18},
-{30,31,18,19},
-{30,31,19,20},
-{30,31,20,21},
-{30,31,21,22},
-{30,31,22,23},
-{30,31,23,24},
-{30,31,24,25},
-{30,31,25,26},
-{30,31,26,27},
-{30,31,27,28},
-{30,31,28,29},
-{31,0,1,2},
-{31,0,2,3},
-{31,0,3,4},
-{31,0,4,5},
-{31,0,5,6},
-{31,0,6,7},
-{31,0,7,8},
-{31,0,8,9},
-{31,0,9,10},
-{31,0,10,11},
-{31,0,11,12},
-{31,0,12,13},
-{31,0,13,14},
-{31,0,14,15},
-{31,0,15,16},
-{31,0,16,17},
-{31,0,17,18},
-{31,0,18,19},
-{31,0,19,20},
-{31,0,20,21},
-{31,0,21,22},
-{31,0,22,23},
-{31,0,23,24},
-{31,0,24,25},
-{31,0,25,26},
-{31,0,26,27},
-{31,0,27,28},
-{31,0,28,29},
-{31,0,29,30}             
-};
-
-
-// GPIO Mappings
-// 
-// A0, A1, A2, A3, A4, EN
-//
-// Send: V minus, A minus
-// Receiver: V plus, A plus
-// 
-typedef struct {
-    ADI_GPIO_PORT_TYPE Port;
-    ADI_GPIO_DATA_TYPE Pins;
-} PinMap;
-
-
-// 
-PinMap m1_configuration[5] = {
-    {ADI_GPIO_PORT_1,ADI_GPIO_PIN_4},  // 4
-    {ADI_GPIO_PORT_1,ADI_GPIO_PIN_3},  // 3 
-    {ADI_GPIO_PORT_1,ADI_GPIO_PIN_2},  // 2
-    {ADI_GPIO_PORT_1,ADI_GPIO_PIN_1},  // 1
-    {ADI_GPIO_PORT_1,ADI_GPIO_PIN_0}  // 0
-};
-
-// Multiplexer A_plus 
-// P1.6,P1.7,P1.8,P1.9,P1.10,P1.11
-PinMap m2_configuration[5] = {
-    {ADI_GPIO_PORT_1,ADI_GPIO_PIN_10},  // 4
-    {ADI_GPIO_PORT_1,ADI_GPIO_PIN_9},  // 3 
-    {ADI_GPIO_PORT_1,ADI_GPIO_PIN_8},  // 2
-    {ADI_GPIO_PORT_1,ADI_GPIO_PIN_7},  // 1
-    {ADI_GPIO_PORT_1,ADI_GPIO_PIN_6}  // 0
-};
-
-
-// Multiplexer V_minus 
-// P1.12, P1.13, P1.14, P1.15, P3.13, P3.12 
-PinMap m3_configuration[5] = {
-    {ADI_GPIO_PORT_3,ADI_GPIO_PIN_13 }, // 4
-    {ADI_GPIO_PORT_1,ADI_GPIO_PIN_15},  // 3 
-    {ADI_GPIO_PORT_1,ADI_GPIO_PIN_14},  // 2
-    {ADI_GPIO_PORT_1,ADI_GPIO_PIN_13},  // 1
-    {ADI_GPIO_PORT_1,ADI_GPIO_PIN_12}   // 0  
-};
-
-
-// Multiplexer V_plus 
-// P2.11,P2.10,P2.9,P2.8,P2.7,P2.6
-PinMap m4_configuration[5] = {
-    {ADI_GPIO_PORT_2,ADI_GPIO_PIN_7},  // 4
-    {ADI_GPIO_PORT_2,ADI_GPIO_PIN_8},  // 3 
-    {ADI_GPIO_PORT_2,ADI_GPIO_PIN_9},  // 2
-    {ADI_GPIO_PORT_2,ADI_GPIO_PIN_10},  // 1
-    {ADI_GPIO_PORT_2,ADI_GPIO_PIN_11}   // 0    
-};
-
-
-// Multiplexer ADG732 Truth Table. 
-typedef const int16_t truth_logic[6];   
+const PATTERN_CONFIG pattern_32_adjacent   = { 32, 1, 1, PATTERN_FLAG_SKIP_INJECTION | PATTERN_FLAG_SWAP_MEAS };  // 928 quads 
 
-// A4 A3 A2 A1 A0 Switch_Condition
-const truth_logic truth_table[32] = {
-  {0, 0, 0, 0, 0, 0},
-  {0, 0, 0, 0, 1, 1},
-  {0, 0, 0, 1, 0, 2},
-  {0, 0, 0, 1, 1, 3},
-  {0, 0, 1, 0, 0, 4},
-  {0, 0, 1, 0, 1, 5},
-  {0, 0, 1, 1, 0, 6},
-  {0, 0, 1, 1, 1, 7},
-  {0, 1, 0, 0, 0, 8},
-  {0, 1, 0, 0, 1, 9},
-  {0, 1, 0, 1, 0, 10},
-  {0, 1, 0, 1, 1, 11},
-  {0, 1, 1, 0, 0, 12},
-  {0, 1, 1, 0, 1, 13},
-  {0, 1, 1, 1, 0, 14},
-  {0, 1, 1, 1, 1, 15},
-  {1, 0, 0, 0, 0, 16},
-  {1, 0, 0, 0, 1, 17},
-  {1, 0, 0, 1, 0, 18},
-  {1, 0, 0, 1, 1, 19},
-  {1, 0, 1, 0, 0, 20},
-  {1, 0, 1, 0, 1, 21},
-  {1, 0, 1, 1, 0, 22},
-  {1, 0, 1, 1, 1, 23},
-  {1, 1, 0, 0, 0, 24},
-  {1, 1, 0, 0, 1, 25},
-  {1, 1, 0, 1, 0, 26},
-  {1, 1, 0, 1, 1, 27},
-  {1, 1, 1, 0, 0, 28},
-  {1, 1, 1, 0, 1, 29},
-  {1, 1, 1, 1, 0, 30},
-  {1, 1, 1, 1, 1, 31}
-};
 
+// GPIO Mappings of the multiplexer address pins are in adg732.c 
 
 
 /* C++ linkage */
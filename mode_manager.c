@@ -0,0 +1,310 @@
+/*!
+ *****************************************************************************
+ * @file:   mode_manager.c
+ * @brief:  Measurement mode switches without tearing down the AFE and GPIOs
+ *
+ * A switch runs its steps in the order of their bits and stops at the first
+ * one that fails: the state only records the steps that succeeded, so the
+ * next switch plans the failed one again.
+ *****************************************************************************/
+
+#include <stddef.h>
+
+#include "mode_manager.h"
+#include "adg732.h"
+#include "calcache.h"
+#include "gpio.h"
+
+/* Busy loop after the first power up, for Vbias to settle */
+#define MODEMGR_VBIAS_DELAY         (2000000u)
+/* DFT results of the power-it-up sequences, discarded */
+#define MODEMGR_POWERITUP_RESULTS   (4u)
+
+/* Power-it-up sequence words, see sequences.h */
+#define MODEMGR_WORD_FIFO_CFG       (1u)
+#define MODEMGR_WORD_WG_CFG         (2u)
+#define MODEMGR_WORD_FCW            (3u)
+#define MODEMGR_WORD_AMPLITUDE      (4u)
+#define MODEMGR_WORD_DAC_CFG        (5u)
+
+/* Multiplexer enable pins, driven as outputs */
+typedef struct {
+    ADI_GPIO_PORT_TYPE      port;
+    ADI_GPIO_DATA_TYPE      pin;
+} MODEMGR_PIN;
+
+static const MODEMGR_PIN    modemgrEnables[] = {
+    { ADI_GPIO_PORT_1, ADI_GPIO_PIN_5  },
+    { ADI_GPIO_PORT_1, ADI_GPIO_PIN_11 },
+    { ADI_GPIO_PORT_3, ADI_GPIO_PIN_12 },
+    { ADI_GPIO_PORT_2, ADI_GPIO_PIN_6  },
+};
+
+/* Calibration registers written by the calibrations of either profile */
+static const ADI_AFE_CAL_REG_TYPE modemgrCalRegs[MODEMGR_CAL_REGS] = {
+    ADI_AFE_CAL_REG_ADC_GAIN_TEMP_SENS,
+    ADI_AFE_CAL_REG_ADC_OFFSET_TEMP_SENS,
+    ADI_AFE_CAL_REG_ADC_GAIN_AUX,
+    ADI_AFE_CAL_REG_ADC_OFFSET_AUX,
+    ADI_AFE_CAL_REG_ADC_GAIN_TIA,
+    ADI_AFE_CAL_REG_ADC_OFFSET_TIA,
+    ADI_AFE_CAL_REG_DAC_OFFSET_ATTEN,
+};
+
+static void                 modemgr_Delay           (uint32_t count);
+static bool_t               modemgr_Gpio            (void);
+static bool_t               modemgr_Afe             (MODEMGR *pMgr);
+static bool_t               modemgr_Calibrate       (MODEMGR *pMgr, uint8_t profile);
+static bool_t               modemgr_Load            (MODEMGR *pMgr, uint8_t profile);
+static bool_t               modemgr_PowerItUp       (MODEMGR *pMgr, const MODEMGR_TARGET *pTarget);
+static bool_t               modemgr_Waveform        (MODEMGR *pMgr, const MODEMGR_TARGET *pTarget);
+
+static void modemgr_Delay(uint32_t count) {
+    volatile uint32_t       n = count;
+
+    while (n > 0u) {
+        n--;
+    }
+}
+
+/* GPIO driver, multiplexer enable pins and address pins */
+static bool_t modemgr_Gpio(void) {
+    uint32_t                i;
+
+    if (ADI_GPIO_SUCCESS != adi_GPIO_Init()) {
+        return false;
+    }
+    for (i = 0; i < sizeof(modemgrEnables) / sizeof(modemgrEnables[0]); i++) {
+        if ((ADI_GPIO_SUCCESS != adi_GPIO_SetPullUpEnable(modemgrEnables[i].port, modemgrEnables[i].pin, false)) ||
+            (ADI_GPIO_SUCCESS != adi_GPIO_SetOutputEnable(modemgrEnables[i].port, modemgrEnables[i].pin, true)) ||
+            (ADI_GPIO_SUCCESS != adi_GPIO_SetInputEnable(modemgrEnables[i].port, modemgrEnables[i].pin, true))) {
+            return false;
+        }
+    }
+    return (ADI_GPIO_SUCCESS == adg732_Init());
+}
+
+/* AFE driver and power up, with the Vbias settling of the first power up. The driver is only */
+/* initialized once: adi_AFE_Init() clears the handle of an initialized device                */
+static bool_t modemgr_Afe(MODEMGR *pMgr) {
+    if ((NULL == pMgr->hDevice) && (ADI_AFE_SUCCESS != adi_AFE_Init(&pMgr->hDevice))) {
+        pMgr->hDevice = NULL;
+        return false;
+    }
+    if ((ADI_AFE_SUCCESS != adi_AFE_SetRcal(pMgr->hDevice, pMgr->rcal)) ||
+        (ADI_AFE_SUCCESS != adi_AFE_SetRtia(pMgr->hDevice, pMgr->rtia)) ||
+        (ADI_AFE_SUCCESS != adi_AFE_PowerUp(pMgr->hDevice))) {
+        return false;
+    }
+    modemgr_Delay(MODEMGR_VBIAS_DELAY);
+    return true;
+}
+
+/* Calibrations of a profile, restored from the flash cache when the temperature allows, then kept in RAM */
+static bool_t modemgr_Calibrate(MODEMGR *pMgr, uint8_t profile) {
+    const MODEMGR_PROFILE  *pProfile = &pMgr->pProfiles[profile];
+    ADI_AFE_DEV_HANDLE      hDevice  = pMgr->hDevice;
+    uint32_t                cals     = pProfile->cals;
+    uint32_t                code;
+    bool_t                  bRestored;
+    uint32_t                i;
+
+    /* The codes in the AFE are about to change */
+    pMgr->loaded = MODEMGR_PROFILE_NONE;
+
+    bRestored = calcache_Restore(hDevice, cals);
+    if (!bRestored) {
+        /* Temp Channel Calibration, also needed to key the cache */
+        if ((ADI_AFE_SUCCESS != adi_AFE_TempSensChanCal(hDevice)) ||
+            ((cals & CALCACHE_CAL_AUX) && (ADI_AFE_SUCCESS != adi_AFE_AuxChanCal(hDevice)))) {
+            return false;
+        }
+    }
+    if (ADI_AFE_SUCCESS != adi_AFE_ExciteChanPowerUp(hDevice)) {
+        return false;
+    }
+    if (!bRestored) {
+        if (((cals & CALCACHE_CAL_TIA) && (ADI_AFE_SUCCESS != adi_AFE_TiaChanCal(hDevice))) ||
+            ((cals & CALCACHE_CAL_EXCITE_ATTEN) && (ADI_AFE_SUCCESS != adi_AFE_ExciteChanCalAtten(hDevice)))) {
+            return false;
+        }
+        /* Not stored, the calibrations run again at the next reset */
+        (void)calcache_Store(hDevice, cals | CALCACHE_CAL_TEMP_SENS);
+    }
+
+    if (pProfile->bTiaFromTemp) {
+        if ((ADI_AFE_SUCCESS != adi_AFE_ReadCalibrationRegister(hDevice, ADI_AFE_CAL_REG_ADC_GAIN_TEMP_SENS, &code)) ||
+            (ADI_AFE_SUCCESS != adi_AFE_WriteCalibrationRegister(hDevice, ADI_AFE_CAL_REG_ADC_GAIN_TIA, code)) ||
+            (ADI_AFE_SUCCESS != adi_AFE_ReadCalibrationRegister(hDevice, ADI_AFE_CAL_REG_ADC_OFFSET_TEMP_SENS, &code)) ||
+            (ADI_AFE_SUCCESS != adi_AFE_WriteCalibrationRegister(hDevice, ADI_AFE_CAL_REG_ADC_OFFSET_TIA, code))) {
+            return false;
+        }
+    }
+
+    for (i = 0; i < MODEMGR_CAL_REGS; i++) {
+        if (ADI_AFE_SUCCESS != adi_AFE_ReadCalibrationRegister(hDevice, modemgrCalRegs[i], &pMgr->codes[profile][i])) {
+            return false;
+        }
+    }
+    pMgr->calibrated |= (uint8_t)(1u << profile);
+    pMgr->loaded      = profile;
+    return true;
+}
+
+/* Codes of a calibrated profile, from RAM */
+static bool_t modemgr_Load(MODEMGR *pMgr, uint8_t profile) {
+    uint32_t                i;
+
+    pMgr->loaded = MODEMGR_PROFILE_NONE;
+    for (i = 0; i < MODEMGR_CAL_REGS; i++) {
+        if (ADI_AFE_SUCCESS != adi_AFE_WriteCalibrationRegister(pMgr->hDevice, modemgrCalRegs[i], pMgr->codes[profile][i])) {
+            return false;
+        }
+    }
+    pMgr->loaded = profile;
+    return true;
+}
+
+/* Power-it-up sequence of the profile, with the waveform of the target */
+static bool_t modemgr_PowerItUp(MODEMGR *pMgr, const MODEMGR_TARGET *pTarget) {
+    SEQ_OBJECT             *pSeq = pMgr->pProfiles[pTarget->profile].pPowerItUp;
+    uint16_t                results[MODEMGR_POWERITUP_RESULTS];
+
+    pMgr->waveProfile = MODEMGR_PROFILE_NONE;
+    seq_Patch(pSeq, MODEMGR_WORD_FCW, SEQ_MMR_WRITE(REG_AFE_AFE_WG_FCW, pTarget->fcw));
+    seq_Patch(pSeq, MODEMGR_WORD_AMPLITUDE, SEQ_MMR_WRITE(REG_AFE_AFE_WG_AMPLITUDE, pTarget->amplitude));
+    if (ADI_AFE_SUCCESS != adi_AFE_RunSequence(pMgr->hDevice, seq_Commit(pSeq), results, MODEMGR_POWERITUP_RESULTS)) {
+        return false;
+    }
+    pMgr->powered    |= (uint8_t)(1u << pTarget->profile);
+    pMgr->waveProfile = pTarget->profile;
+    pMgr->fcw         = pTarget->fcw;
+    pMgr->amplitude   = pTarget->amplitude;
+    return true;
+}
+
+/* Waveform generator registers of the power-it-up sequence, without its measurements and settling */
+static bool_t modemgr_Waveform(MODEMGR *pMgr, const MODEMGR_TARGET *pTarget) {
+    const uint32_t         *pWords = pMgr->pProfiles[pTarget->profile].pPowerItUp->pWords;
+    SEQ_OBJECT             *pSeq   = &pMgr->seqWaveform;
+
+    pMgr->waveProfile = MODEMGR_PROFILE_NONE;
+    seq_Reset(pSeq);
+    seq_Append(pSeq, pWords[MODEMGR_WORD_FIFO_CFG]);
+    seq_Append(pSeq, pWords[MODEMGR_WORD_WG_CFG]);
+    seq_Append(pSeq, SEQ_MMR_WRITE(REG_AFE_AFE_WG_FCW, pTarget->fcw));
+    seq_Append(pSeq, SEQ_MMR_WRITE(REG_AFE_AFE_WG_AMPLITUDE, pTarget->amplitude));
+    seq_Append(pSeq, pWords[MODEMGR_WORD_DAC_CFG]);
+    seq_Append(pSeq, SEQ_END_COMMAND);
+    if (ADI_AFE_SUCCESS != adi_AFE_RunSequence(pMgr->hDevice, seq_Commit(pSeq), NULL, 0)) {
+        return false;
+    }
+    pMgr->waveProfile = pTarget->profile;
+    pMgr->fcw         = pTarget->fcw;
+    pMgr->amplitude   = pTarget->amplitude;
+    return true;
+}
+
+/*!
+ * @brief       Start from a reset board: nothing initialized or calibrated.
+ *
+ * @param[out]  pMgr        Mode manager.
+ * @param[in]   pProfiles   MODEMGR_PROFILES profiles, kept by reference.
+ * @param[in]   rcal        RCAL of the board, in ohms.
+ * @param[in]   rtia        RTIA of the board, in ohms.
+ */
+void modemgr_Init(MODEMGR *pMgr, const MODEMGR_PROFILE *pProfiles, uint32_t rcal, uint32_t rtia) {
+    pMgr->pProfiles   = pProfiles;
+    pMgr->hDevice     = NULL;
+    pMgr->rcal        = rcal;
+    pMgr->rtia        = rtia;
+    pMgr->ready       = 0;
+    pMgr->calibrated  = 0;
+    pMgr->powered     = 0;
+    pMgr->loaded      = MODEMGR_PROFILE_NONE;
+    pMgr->waveProfile = MODEMGR_PROFILE_NONE;
+    pMgr->fcw         = 0;
+    pMgr->amplitude   = 0;
+    seq_Attach(&pMgr->seqWaveform, pMgr->waveform, MODEMGR_WAVEFORM_WORDS);
+}
+
+/*!
+ * @brief       Steps a switch to a target would run.
+ *
+ * @param[in]   pMgr        Mode manager.
+ * @param[in]   pTarget     Target of the mode switched to.
+ *
+ * @return      MODEMGR_STEP_* bits, 0 if the AFE is already set for the target.
+ */
+uint32_t modemgr_Plan(const MODEMGR *pMgr, const MODEMGR_TARGET *pTarget) {
+    uint32_t                bit   = 1u << pTarget->profile;
+    uint32_t                steps = (MODEMGR_STEP_GPIO | MODEMGR_STEP_AFE) & ~(uint32_t)pMgr->ready;
+
+    if (!(pMgr->calibrated & bit)) {
+        steps |= MODEMGR_STEP_CALIBRATE;
+    }
+    else if (pMgr->loaded != pTarget->profile) {
+        steps |= MODEMGR_STEP_LOAD;
+    }
+
+    if (MODEMGR_FCW_ANY == pTarget->fcw) {
+        return steps;
+    }
+    if (!(pMgr->powered & bit)) {
+        steps |= MODEMGR_STEP_POWERITUP;
+    }
+    else if ((pMgr->waveProfile != pTarget->profile) || (pMgr->fcw != pTarget->fcw) ||
+             (pMgr->amplitude != pTarget->amplitude)) {
+        steps |= MODEMGR_STEP_WAVEFORM;
+    }
+    return steps;
+}
+
+/*!
+ * @brief       Set the AFE for a target, running the planned steps.
+ *
+ * @param[in]   pMgr        Mode manager, pMgr->hDevice is the AFE handle once
+ *                          the first switch got past the AFE step.
+ * @param[in]   pTarget     Target of the mode switched to.
+ *
+ * @return      0, or the MODEMGR_STEP_* bit of the step that failed; the
+ *              steps after it were not run.
+ */
+uint32_t modemgr_Switch(MODEMGR *pMgr, const MODEMGR_TARGET *pTarget) {
+    uint32_t                steps = modemgr_Plan(pMgr, pTarget);
+
+    if (steps & MODEMGR_STEP_GPIO) {
+        if (!modemgr_Gpio()) {
+            return MODEMGR_STEP_GPIO;
+        }
+        pMgr->ready |= MODEMGR_STEP_GPIO;
+    }
+    if (steps & MODEMGR_STEP_AFE) {
+        if (!modemgr_Afe(pMgr)) {
+            return MODEMGR_STEP_AFE;
+        }
+        pMgr->ready |= MODEMGR_STEP_AFE;
+    }
+    if ((steps & MODEMGR_STEP_CALIBRATE) && !modemgr_Calibrate(pMgr, pTarget->profile)) {
+        return MODEMGR_STEP_CALIBRATE;
+    }
+    if ((steps & MODEMGR_STEP_LOAD) && !modemgr_Load(pMgr, pTarget->profile)) {
+        return MODEMGR_STEP_LOAD;
+    }
+    if ((steps & MODEMGR_STEP_POWERITUP) && !modemgr_PowerItUp(pMgr, pTarget)) {
+        return MODEMGR_STEP_POWERITUP;
+    }
+    if ((steps & MODEMGR_STEP_WAVEFORM) && !modemgr_Waveform(pMgr, pTarget)) {
+        return MODEMGR_STEP_WAVEFORM;
+    }
+
+    /* The sequences of the mode program the waveform generator */
+    if (MODEMGR_FCW_ANY == pTarget->fcw) {
+        pMgr->waveProfile = MODEMGR_PROFILE_NONE;
+    }
+    return 0;
+}
+
+/*
+** EOF
+*/
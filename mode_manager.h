@@ -0,0 +1,116 @@
+/*!
+ *****************************************************************************
+ * @file:   mode_manager.h
+ * @brief:  Measurement mode switches without tearing down the AFE and GPIOs
+ *
+ * The GPIO and AFE drivers are initialized, and the AFE powered up, by the
+ * first switch only. A mode asks for a target: a calibration profile and the
+ * waveform generator setting of its sequences. modemgr_Plan() compares it
+ * with what the AFE holds and modemgr_Switch() runs the steps that differ:
+ *
+ *      step        when                                        cost
+ *      GPIO        first switch                                GPIO driver calls
+ *      AFE         first switch                                power up, Vbias settling
+ *      CALIBRATE   first switch into a profile                 calibrations, or the flash
+ *                                                              cache and a temperature
+ *                                                              measurement (calcache.h)
+ *      LOAD        the other profile is in the AFE             7 register writes
+ *      POWERITUP   first switch into a profile with a waveform power-it-up sequence,
+ *                                                              528 ms of switch settling
+ *      WAVEFORM    the waveform generator is set otherwise     sequence of 5 register writes
+ *
+ * The calibration codes of a profile are read back once it is calibrated
+ * and kept in RAM, so going back and forth between the 4-wire and 2-wire
+ * modes costs register writes. They are kept until the next reset, as a
+ * mode ran with its calibration before. A mode whose sequences program the
+ * waveform generator themselves, the spectroscopy and multi-frequency
+ * modes, asks for MODEMGR_FCW_ANY and leaves it unknown to the next switch.
+ *
+ * The board and driver layer is the one of the firmware: the adi_AFE_*,
+ * adi_GPIO_* and adg732_Init() calls, and calcache.c.
+ *****************************************************************************/
+
+#ifndef __MODE_MANAGER_H__
+#define __MODE_MANAGER_H__
+
+#include <stdint.h>
+
+#include "afe.h"
+#include "seq_builder.h"
+
+/* C++ linkage */
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Calibration profiles */
+#define MODEMGR_PROFILE_TETRAPOLAR  (0u)        /* temperature sensor and auxiliary channels, 4-wire modes  */
+#define MODEMGR_PROFILE_BIPOLAR     (1u)        /* TIA and attenuated excitation channels, 2-wire modes     */
+#define MODEMGR_PROFILES            (2u)
+#define MODEMGR_PROFILE_NONE        (0xFFu)
+
+/* Frequency control word of a target whose sequences program the waveform generator */
+#define MODEMGR_FCW_ANY             (0xFFFFFFFFu)
+
+/* Steps of a switch, as planned and as failed */
+#define MODEMGR_STEP_GPIO           (0x01u)     /* GPIO driver, multiplexer enables and address pins        */
+#define MODEMGR_STEP_AFE            (0x02u)     /* AFE driver, RCAL and RTIA, power up                      */
+#define MODEMGR_STEP_CALIBRATE      (0x04u)     /* calibrations of the profile, codes kept in RAM           */
+#define MODEMGR_STEP_LOAD           (0x08u)     /* codes of the profile written from RAM                    */
+#define MODEMGR_STEP_POWERITUP      (0x10u)     /* power-it-up sequence of the profile                      */
+#define MODEMGR_STEP_WAVEFORM       (0x20u)     /* waveform generator registers                             */
+
+/* Calibration registers held per profile */
+#define MODEMGR_CAL_REGS            (7u)
+/* Waveform generator sequence: safety word, FIFO, WG, FCW, amplitude and DAC configuration, end */
+#define MODEMGR_WAVEFORM_WORDS      (7u)
+
+/* Calibrations and power-it-up sequence of a profile */
+typedef struct {
+    uint32_t                cals;           /*!< CALCACHE_CAL_* calibrations to run                     */
+    bool_t                  bTiaFromTemp;   /*!< TIA gain and offset codes copied from the temperature
+                                                 sensor ones, for a current to voltage ratio of 1.5     */
+    SEQ_OBJECT             *pPowerItUp;     /*!< Power-it-up sequence: FIFO, WG configuration, FCW,
+                                                 amplitude and DAC configuration at words 1 to 5, as
+                                                 in sequences.h                                         */
+} MODEMGR_PROFILE;
+
+/* What a mode needs from the AFE */
+typedef struct {
+    uint8_t                 profile;        /*!< MODEMGR_PROFILE_*                                      */
+    uint32_t                fcw;            /*!< Waveform generator FCW, or MODEMGR_FCW_ANY             */
+    uint16_t                amplitude;      /*!< Sine amplitude in DAC codes, unused with FCW_ANY       */
+} MODEMGR_TARGET;
+
+/* State of the AFE and the board, as left by the switches */
+typedef struct {
+    const MODEMGR_PROFILE  *pProfiles;      /*!< MODEMGR_PROFILES profiles                              */
+    ADI_AFE_DEV_HANDLE      hDevice;        /*!< AFE handle, once the AFE step is done                  */
+    uint32_t                rcal;           /*!< RCAL and RTIA of the board, in ohms                    */
+    uint32_t                rtia;
+    uint8_t                 ready;          /*!< MODEMGR_STEP_GPIO and MODEMGR_STEP_AFE done            */
+    uint8_t                 calibrated;     /*!< Profiles with codes in RAM, one bit each               */
+    uint8_t                 powered;        /*!< Profiles whose power-it-up sequence ran, one bit each  */
+    uint8_t                 loaded;         /*!< Profile of the codes in the AFE                        */
+    uint8_t                 waveProfile;    /*!< Profile of the waveform configuration, NONE if unknown */
+    uint16_t                amplitude;      /*!< Waveform generator amplitude, when known               */
+    uint32_t                fcw;            /*!< Waveform generator FCW, when known                     */
+    uint32_t                codes[MODEMGR_PROFILES][MODEMGR_CAL_REGS];
+    uint32_t                waveform[MODEMGR_WAVEFORM_WORDS];
+    SEQ_OBJECT              seqWaveform;
+} MODEMGR;
+
+void                        modemgr_Init            (MODEMGR *pMgr, const MODEMGR_PROFILE *pProfiles,
+                                                     uint32_t rcal, uint32_t rtia);
+uint32_t                    modemgr_Plan            (const MODEMGR *pMgr, const MODEMGR_TARGET *pTarget);
+uint32_t                    modemgr_Switch          (MODEMGR *pMgr, const MODEMGR_TARGET *pTarget);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __MODE_MANAGER_H__ */
+
+/*
+** EOF
+*/
@@ -65,6 +65,17 @@ const uint64_t multifrequency[] = {200,500,800,1000,2000,5000,8000,10000,15000,2
 const char *stringfreqs[MULTIFREQUENCY_ARRAY_SIZE] = {"200","500","800","1000","2000","5000","8000","10000","15000","20000","30000","40000","50000","60000","70000"};  
  
 
+/***************************************************************************/
+/*   Defines for Mode Multi-frequency Imaging                              */
+/***************************************************************************/
+/* Largest frequency list measured on every quad */
+#define MULTIFREQ_EIT_MAX_COUNT     (8)
+/* Electrodes of the multi-frequency imaging mode */
+#define MULTIFREQ_EIT_ELECTRODES    (16)
+/* Default frequency list, all frequencies are measured before the muxes switch */
+#define MULTIFREQ_EIT_COUNT         (4)
+const uint32_t multifreq_eit[MULTIFREQ_EIT_COUNT] = {10000, 25000, 50000, 70000};
+
 /***************************************************************************/
 /*   Defines for Bipolar                                                  */
 /***************************************************************************/
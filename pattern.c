@@ -0,0 +1,331 @@
+/*!
+ *****************************************************************************
+ * @file:   pattern.c
+ * @brief:  Electrode stimulation and measurement pattern generator
+ *
+ * The quads are generated on demand from a PATTERN_CONFIG instead of being
+ * stored as flash tables, so any injection/measurement distance can be used
+ * without rebuilding the firmware.
+ *****************************************************************************/
+
+#include <stddef.h>
+
+#include "pattern.h"
+
+static uint32_t             pattern_Canonical       (uint32_t word, bool_t *pNegative);
+
+/* Key shared by the quads equal up to reciprocity and polarity, and the sign of this quad */
+static uint32_t pattern_Canonical(uint32_t word, bool_t *pNegative) {
+    PATTERN_QUAD            quad;
+    uint32_t                drive, sense;
+    bool_t                  bNegative = false;
+
+    pattern_Unpack(word, &quad);
+
+    /* Each pair in increasing channel order, negating the value for each swap */
+    if (quad.aPlus < quad.aMinus) {
+        drive = ((uint32_t)quad.aPlus << PATTERN_MUX_BITS) | quad.aMinus;
+    }
+    else {
+        drive     = ((uint32_t)quad.aMinus << PATTERN_MUX_BITS) | quad.aPlus;
+        bNegative = !bNegative;
+    }
+    if (quad.vPlus < quad.vMinus) {
+        sense = ((uint32_t)quad.vPlus << PATTERN_MUX_BITS) | quad.vMinus;
+    }
+    else {
+        sense     = ((uint32_t)quad.vMinus << PATTERN_MUX_BITS) | quad.vPlus;
+        bNegative = !bNegative;
+    }
+
+    *pNegative = bNegative;
+
+    /* Drive and sense pairs in increasing order, reciprocity keeps the sign */
+    return (drive < sense) ? ((drive << (2u * PATTERN_MUX_BITS)) | sense)
+                           : ((sense << (2u * PATTERN_MUX_BITS)) | drive);
+}
+
+/*!
+ * @brief       Check a pattern description.
+ *
+ * @param[in]   pConfig     Pattern description.
+ *
+ * @return      true if the electrodes map onto the mux channels and both
+ *              distances are in 1 .. n_el-1.
+ */
+bool_t pattern_IsValid(const PATTERN_CONFIG *pConfig) {
+    if ((0u == pConfig->n_el) || (pConfig->n_el > PATTERN_MUX_CHANNELS)) {
+        return false;
+    }
+    if (0u != (PATTERN_MUX_CHANNELS % pConfig->n_el)) {
+        return false;
+    }
+    if ((0u == pConfig->dist) || (pConfig->dist >= pConfig->n_el)) {
+        return false;
+    }
+    if ((0u == pConfig->step) || (pConfig->step >= pConfig->n_el)) {
+        return false;
+    }
+
+    return true;
+}
+
+/*!
+ * @brief       Count the quads of a pattern.
+ *
+ * @param[in]   pConfig     Pattern description.
+ *
+ * @return      Number of quads, 0 if the description is invalid.
+ */
+uint32_t pattern_Count(const PATTERN_CONFIG *pConfig) {
+    PATTERN_ITERATOR        iter;
+    PATTERN_QUAD            quad;
+    uint32_t                count = 0;
+
+    pattern_Begin(&iter, pConfig);
+    while (pattern_Next(&iter, &quad)) {
+        count++;
+    }
+
+    return count;
+}
+
+/*!
+ * @brief       Start generating the quads of a pattern.
+ *
+ * @param[out]  pIter       Generator state.
+ * @param[in]   pConfig     Pattern description, copied into the generator.
+ *
+ * @details     An invalid description yields no quads.
+ */
+void pattern_Begin(PATTERN_ITERATOR *pIter, const PATTERN_CONFIG *pConfig) {
+    pIter->config     = *pConfig;
+    pIter->excitation = 0;
+    pIter->pair       = 0;
+
+    if (!pattern_IsValid(pConfig)) {
+        pIter->config.n_el = 0;
+    }
+}
+
+/*!
+ * @brief       Generate the next quad of a pattern.
+ *
+ * @param[in]   pIter       Generator state.
+ * @param[out]  pQuad       Next quad, as mux channels.
+ *
+ * @return      false once all the quads have been generated.
+ */
+bool_t pattern_Next(PATTERN_ITERATOR *pIter, PATTERN_QUAD *pQuad) {
+    const PATTERN_CONFIG   *pConfig = &pIter->config;
+    uint8_t                 n_el    = pConfig->n_el;
+    uint8_t                 scale;
+    uint8_t                 a, b, m, n;
+
+    if (0u == n_el) {
+        return false;
+    }
+    scale = (uint8_t)(PATTERN_MUX_CHANNELS / n_el);
+
+    while (pIter->excitation < n_el) {
+        a = pIter->excitation;
+        b = (uint8_t)((a + pConfig->dist) % n_el);
+
+        while (pIter->pair < n_el) {
+            m = pIter->pair++;
+            if (pConfig->flags & PATTERN_FLAG_ROTATE_MEAS) {
+                m = (uint8_t)((m + a) % n_el);
+            }
+            n = (uint8_t)((m + pConfig->step) % n_el);
+
+            if ((pConfig->flags & PATTERN_FLAG_SKIP_INJECTION) &&
+                ((m == a) || (m == b) || (n == a) || (n == b))) {
+                continue;
+            }
+
+            if (pConfig->flags & PATTERN_FLAG_SWAP_MEAS) {
+                uint8_t swap = m;
+                m = n;
+                n = swap;
+            }
+
+            pQuad->aPlus  = (uint8_t)(a * scale);
+            pQuad->aMinus = (uint8_t)(b * scale);
+            pQuad->vPlus  = (uint8_t)(n * scale);
+            pQuad->vMinus = (uint8_t)(m * scale);
+            return true;
+        }
+
+        pIter->excitation++;
+        pIter->pair = 0;
+    }
+
+    return false;
+}
+
+/*!
+ * @brief       Pack a quad into a mux word.
+ *
+ * @param[in]   pQuad       Quad, as mux channels.
+ *
+ * @return      Mux word, see pattern.h for the layout.
+ */
+uint32_t pattern_Pack(const PATTERN_QUAD *pQuad) {
+    return (((uint32_t)pQuad->aMinus & PATTERN_MUX_MASK) << PATTERN_MUX_SHIFT(PATTERN_MUX_A_MINUS))
+         | (((uint32_t)pQuad->vMinus & PATTERN_MUX_MASK) << PATTERN_MUX_SHIFT(PATTERN_MUX_V_MINUS))
+         | (((uint32_t)pQuad->aPlus  & PATTERN_MUX_MASK) << PATTERN_MUX_SHIFT(PATTERN_MUX_A_PLUS))
+         | (((uint32_t)pQuad->vPlus  & PATTERN_MUX_MASK) << PATTERN_MUX_SHIFT(PATTERN_MUX_V_PLUS));
+}
+
+/*!
+ * @brief       Unpack a mux word into a quad.
+ *
+ * @param[in]   word        Mux word.
+ * @param[out]  pQuad       Quad, as mux channels.
+ */
+void pattern_Unpack(uint32_t word, PATTERN_QUAD *pQuad) {
+    pQuad->aMinus = (uint8_t)PATTERN_MUX_ADDR(word, PATTERN_MUX_A_MINUS);
+    pQuad->vMinus = (uint8_t)PATTERN_MUX_ADDR(word, PATTERN_MUX_V_MINUS);
+    pQuad->aPlus  = (uint8_t)PATTERN_MUX_ADDR(word, PATTERN_MUX_A_PLUS);
+    pQuad->vPlus  = (uint8_t)PATTERN_MUX_ADDR(word, PATTERN_MUX_V_PLUS);
+}
+
+/*!
+ * @brief       Compile a pattern into packed mux words.
+ *
+ * @param[in]   pConfig     Pattern description.
+ * @param[out]  pWords      Destination of the mux words, one per quad.
+ * @param[in]   maxWords    Size of pWords.
+ *
+ * @return      Number of quads compiled, 0 if the description is invalid or
+ *              the pattern does not fit in pWords.
+ */
+uint32_t pattern_Compile(const PATTERN_CONFIG *pConfig, uint32_t *pWords, uint32_t maxWords) {
+    PATTERN_ITERATOR        iter;
+    PATTERN_QUAD            quad;
+    uint32_t                count = pattern_Count(pConfig);
+
+    if ((0u == count) || (count > maxWords)) {
+        return 0;
+    }
+
+    pattern_Begin(&iter, pConfig);
+    for (count = 0; pattern_Next(&iter, &quad); count++) {
+        pWords[count] = pattern_Pack(&quad);
+    }
+
+    return count;
+}
+
+/*!
+ * @brief       Reduce a compiled pattern to the quads that are not equal to an earlier one.
+ *
+ * @param[in]   pWords      Mux words of the pattern.
+ * @param[in]   count       Number of quads of the pattern.
+ * @param[out]  pMeasured   Index in pWords of each quad to measure, count entries at most.
+ * @param[out]  pPlan       count plan entries, see pattern.h.
+ *
+ * @return      Number of quads to measure, in pattern order.
+ *
+ * @details     The first quad of each group of equal quads is measured. The
+ *              search is quadratic in the number of measured quads, the
+ *              plan is meant to be reduced once per pattern.
+ */
+uint32_t pattern_Reduce(const uint32_t *pWords, uint32_t count, uint16_t *pMeasured, int16_t *pPlan) {
+    uint32_t                measured = 0;
+    uint32_t                i, k, key;
+    bool_t                  bNegative, bOther;
+
+    for (i = 0; i < count; i++) {
+        key = pattern_Canonical(pWords[i], &bNegative);
+
+        for (k = 0; k < measured; k++) {
+            if (key == pattern_Canonical(pWords[pMeasured[k]], &bOther)) {
+                break;
+            }
+        }
+
+        if (k == measured) {
+            pMeasured[measured++] = (uint16_t)i;
+            pPlan[i] = PATTERN_PLAN_ENTRY(k, false);
+        }
+        else {
+            pPlan[i] = PATTERN_PLAN_ENTRY(k, (bNegative != bOther) ? true : false);
+        }
+    }
+
+    return measured;
+}
+
+/*!
+ * @brief       Order a list of quads so the quads sharing an injection pair follow each other.
+ *
+ * @param[in]   pWords      Mux words of the pattern.
+ * @param[in]   pIndex      Index in pWords of each quad of the list, NULL for the whole pattern.
+ * @param[in]   count       Number of quads of the list.
+ * @param[out]  pOrder      Position in the list of the quad measured in turn, count entries.
+ *
+ * @return      Number of injection changes in the new order, the first quad included.
+ *
+ * @details     The injection pairs keep the order of their first quad, and
+ *              the quads of a pair their order in the list, so a list
+ *              already grouped keeps its order.
+ */
+uint32_t pattern_Order(const uint32_t *pWords, const uint16_t *pIndex, uint32_t count, uint16_t *pOrder) {
+    uint32_t                ordered = 0;
+    uint32_t                groups  = 0;
+    uint32_t                i, k, injection;
+
+    for (i = 0; i < count; i++) {
+        injection = PATTERN_INJECTION(pWords[(NULL != pIndex) ? pIndex[i] : i]);
+
+        /* A pair is ordered from its first quad */
+        for (k = 0; k < i; k++) {
+            if (injection == PATTERN_INJECTION(pWords[(NULL != pIndex) ? pIndex[k] : k])) {
+                break;
+            }
+        }
+        if (k < i) {
+            continue;
+        }
+
+        groups++;
+        for (k = i; k < count; k++) {
+            if (injection == PATTERN_INJECTION(pWords[(NULL != pIndex) ? pIndex[k] : k])) {
+                pOrder[ordered++] = (uint16_t)k;
+            }
+        }
+    }
+
+    return groups;
+}
+
+/*!
+ * @brief       Count the injection changes of a list of quads measured in turn.
+ *
+ * @param[in]   pWords      Mux words of the pattern.
+ * @param[in]   pIndex      Index in pWords of each quad of the list, NULL for the whole pattern.
+ * @param[in]   pOrder      Position in the list of the quad measured in turn, NULL for the list order.
+ * @param[in]   count       Number of quads of the list.
+ *
+ * @return      Number of quads whose injection muxes differ from the previous quad, the first quad included.
+ */
+uint32_t pattern_Injections(const uint32_t *pWords, const uint16_t *pIndex, const uint16_t *pOrder, uint32_t count) {
+    uint32_t                changes = 0;
+    uint32_t                i, k, injection, previous = 0;
+
+    for (i = 0; i < count; i++) {
+        k         = (NULL != pOrder) ? pOrder[i] : i;
+        injection = PATTERN_INJECTION(pWords[(NULL != pIndex) ? pIndex[k] : k]);
+        if ((0u == i) || (injection != previous)) {
+            changes++;
+        }
+        previous = injection;
+    }
+
+    return changes;
+}
+
+/*
+** EOF
+*/
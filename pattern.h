@@ -0,0 +1,132 @@
+/*!
+ *****************************************************************************
+ * @file:   pattern.h
+ * @brief:  Electrode stimulation and measurement pattern generator
+ *
+ * Generates the (A+, A-, V+, V-) quads of an EIT frame in the same order as
+ * pyEIT's eit_scan_lines() and voltage_meter():
+ *
+ *      for every excitation A = 0 .. n_el-1, B = (A + dist) % n_el
+ *          for every k = 0 .. n_el-1
+ *              M = k, N = (k + step) % n_el, V+ = N, V- = M
+ *
+ * Electrodes are numbered 0 .. n_el-1 and spread evenly over the 32 mux
+ * channels, so electrode e of an 8 electrode belt is mux channel 4*e.
+ *
+ * Quads can be compiled into packed mux words, holding the 5-bit ADG732
+ * address of each multiplexer:
+ *
+ *      bits    mux     signal
+ *      [4:0]   M1      A-
+ *      [9:5]   M2      V-
+ *      [14:10] M3      A+
+ *      [19:15] M4      V+
+ *
+ * A pattern can be reduced to the quads that carry new information. For a
+ * linear, passive load the transfer impedance of (A+, A-, V+, V-) equals
+ * the one of (V+, V-, A+, A-) (reciprocity), and swapping A+ and A-, or V+
+ * and V-, negates it. Quads equal to an earlier quad up to these symmetries
+ * are not measured, and a plan entry per quad of the pattern tells where
+ * its value comes from:
+ *
+ *      entry = k + 1       the value of measured quad k
+ *      entry = -(k + 1)    the negated value of measured quad k
+ *
+ * Opposition patterns inject every pair twice, once in each direction, and
+ * reduce to half of their quads; adjacent patterns reduce to half by
+ * reciprocity.
+ *
+ * The current injection settles when an injection mux (A+ or A-) moves,
+ * while a quad that only moves the sense muxes can start sooner. A list of
+ * quads can be ordered so the quads sharing an injection pair follow each
+ * other, and the injection then changes once per pair. The built-in
+ * patterns and their reduced plans are already in that order.
+ *****************************************************************************/
+
+#ifndef __PATTERN_H__
+#define __PATTERN_H__
+
+#include <stdint.h>
+
+#include "device.h"
+
+/* C++ linkage */
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Number of channels of each ADG732 multiplexer */
+#define PATTERN_MUX_CHANNELS        (32u)
+/* Largest pattern: 32 electrodes, adjacent pairs, PATTERN_FLAG_SKIP_INJECTION */
+#define PATTERN_MAX_QUADS           (PATTERN_MUX_CHANNELS * (PATTERN_MUX_CHANNELS - 3u))
+
+/* Pattern flags */
+#define PATTERN_FLAG_SKIP_INJECTION (0x01u)     /* Drop pairs touching A or B (pyEIT 'std' parser)  */
+#define PATTERN_FLAG_ROTATE_MEAS    (0x02u)     /* Start the pairs at k = A (pyEIT 'rotate_meas')   */
+#define PATTERN_FLAG_SWAP_MEAS      (0x04u)     /* V+ = M, V- = N                                   */
+
+/* Packed mux word fields */
+#define PATTERN_MUX_BITS            (5u)
+#define PATTERN_MUX_MASK            (0x1Fu)
+#define PATTERN_MUX_SHIFT(mux)      ((uint32_t)(mux) * PATTERN_MUX_BITS)
+#define PATTERN_MUX_ADDR(word, mux) (((word) >> PATTERN_MUX_SHIFT(mux)) & PATTERN_MUX_MASK)
+#define PATTERN_MUX_A_MINUS         (0u)        /* M1 */
+#define PATTERN_MUX_V_MINUS         (1u)        /* M2 */
+#define PATTERN_MUX_A_PLUS          (2u)        /* M3 */
+#define PATTERN_MUX_V_PLUS          (3u)        /* M4 */
+#define PATTERN_MUX_COUNT           (4u)
+/* Injection muxes of a word, equal for the quads that share an injection pair */
+#define PATTERN_INJECTION(word)     ((word) & ((PATTERN_MUX_MASK << PATTERN_MUX_SHIFT(PATTERN_MUX_A_MINUS)) | \
+                                               (PATTERN_MUX_MASK << PATTERN_MUX_SHIFT(PATTERN_MUX_A_PLUS))))
+
+/* Reduced plan entries, see above */
+#define PATTERN_PLAN_ENTRY(k, neg)  ((int16_t)((neg) ? -(int32_t)((k) + 1u) : (int32_t)((k) + 1u)))
+#define PATTERN_PLAN_QUAD(entry)    ((uint32_t)(((entry) < 0) ? -(int32_t)(entry) : (int32_t)(entry)) - 1u)
+#define PATTERN_PLAN_NEGATIVE(entry) ((entry) < 0)
+
+/* Pattern description */
+typedef struct {
+    uint8_t                 n_el;           /*!< Number of electrodes, divides PATTERN_MUX_CHANNELS */
+    uint8_t                 dist;           /*!< Injection distance, B = A + dist                   */
+    uint8_t                 step;           /*!< Measurement distance, N = M + step                 */
+    uint8_t                 flags;          /*!< PATTERN_FLAG_xxx                                   */
+} PATTERN_CONFIG;
+
+/* One quad, as mux channels */
+typedef struct {
+    uint8_t                 aPlus;
+    uint8_t                 aMinus;
+    uint8_t                 vPlus;
+    uint8_t                 vMinus;
+} PATTERN_QUAD;
+
+/* Quad generator state */
+typedef struct {
+    PATTERN_CONFIG          config;
+    uint8_t                 excitation;     /*!< Current excitation electrode A         */
+    uint8_t                 pair;           /*!< Next measurement pair, 0 .. n_el       */
+} PATTERN_ITERATOR;
+
+bool_t                      pattern_IsValid         (const PATTERN_CONFIG *pConfig);
+uint32_t                    pattern_Count           (const PATTERN_CONFIG *pConfig);
+void                        pattern_Begin           (PATTERN_ITERATOR *pIter, const PATTERN_CONFIG *pConfig);
+bool_t                      pattern_Next            (PATTERN_ITERATOR *pIter, PATTERN_QUAD *pQuad);
+uint32_t                    pattern_Pack            (const PATTERN_QUAD *pQuad);
+void                        pattern_Unpack          (uint32_t word, PATTERN_QUAD *pQuad);
+uint32_t                    pattern_Compile         (const PATTERN_CONFIG *pConfig, uint32_t *pWords, uint32_t maxWords);
+uint32_t                    pattern_Reduce          (const uint32_t *pWords, uint32_t count, uint16_t *pMeasured,
+                                                     int16_t *pPlan);
+uint32_t                    pattern_Order           (const uint32_t *pWords, const uint16_t *pIndex, uint32_t count,
+                                                     uint16_t *pOrder);
+uint32_t                    pattern_Injections      (const uint32_t *pWords, const uint16_t *pIndex,
+                                                     const uint16_t *pOrder, uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __PATTERN_H__ */
+
+/*
+** EOF
+*/
@@ -0,0 +1,162 @@
+/*!
+ *****************************************************************************
+ * @file:   ranging.c
+ * @brief:  Per-quad excitation ranging learned from the previous frame
+ *
+ * A clipped DFT result saturates at the int16 full scale, so the peak of an
+ * attenuated quad only says it was too large: the level moves one step per
+ * frame, and a quad that clips at the nominal amplitude settles within
+ * RANGING_LEVELS frames. Halving the amplitude halves the peak, so the gap
+ * between the two thresholds keeps a quad from toggling between levels.
+ *****************************************************************************/
+
+#include <stddef.h>
+
+#include "ranging.h"
+
+/*!
+ * @brief       Attach the storage of a level table, all quads at the nominal amplitude.
+ *
+ * @param[out]  pTable      Level table.
+ * @param[in]   pLevels     capacity levels.
+ * @param[in]   pNext       capacity levels.
+ * @param[in]   capacity    Largest number of quads per frame.
+ */
+void ranging_Init(RANGING_TABLE *pTable, uint8_t *pLevels, uint8_t *pNext, uint32_t capacity) {
+    pTable->pLevels  = pLevels;
+    pTable->pNext    = pNext;
+    pTable->capacity = capacity;
+    ranging_Reset(pTable, 0);
+}
+
+/*!
+ * @brief       Put every quad of a new frame layout back to the nominal amplitude.
+ *
+ * @param[in]   pTable      Level table.
+ * @param[in]   count       Quads per frame, clamped to the capacity.
+ */
+void ranging_Reset(RANGING_TABLE *pTable, uint32_t count) {
+    uint32_t                i;
+
+    if (count > pTable->capacity) {
+        count = pTable->capacity;
+    }
+    for (i = 0; i < count; i++) {
+        pTable->pLevels[i] = 0;
+        pTable->pNext[i]   = 0;
+    }
+    pTable->count    = count;
+    pTable->peakQuad = 0;
+    pTable->peak     = 0;
+    pTable->changes  = 0;
+}
+
+/*!
+ * @brief       Use the levels learned so far, before the first quad of a frame is measured.
+ *
+ * @param[in]   pTable      Level table.
+ *
+ * @return      Number of quads whose level changed.
+ */
+uint32_t ranging_Begin(RANGING_TABLE *pTable) {
+    uint32_t                i;
+
+    pTable->changes = 0;
+    for (i = 0; i < pTable->count; i++) {
+        if (pTable->pLevels[i] != pTable->pNext[i]) {
+            pTable->pLevels[i] = pTable->pNext[i];
+            pTable->changes++;
+        }
+    }
+    pTable->peak = 0;
+
+    return pTable->changes;
+}
+
+/*!
+ * @brief       Excitation level of a quad in the current frame.
+ *
+ * @param[in]   pTable      Level table.
+ * @param[in]   quad        Quad index.
+ *
+ * @return      The level, 0 (nominal amplitude) for a quad beyond the table.
+ */
+uint32_t ranging_Level(const RANGING_TABLE *pTable, uint32_t quad) {
+    return (quad < pTable->count) ? pTable->pLevels[quad] : 0u;
+}
+
+/*!
+ * @brief       Take the DFT results of one sequence of a quad into account.
+ *
+ * @param[in]   pTable      Level table.
+ * @param[in]   quad        Quad index.
+ * @param[in]   pResults    DFT results, real and imaginary parts.
+ * @param[in]   count       Number of halfwords.
+ *
+ * @details     The results of the sequences of a quad are observed in turn,
+ *              the peak restarts when the quad changes.
+ */
+void ranging_Observe(RANGING_TABLE *pTable, uint32_t quad, const int16_t *pResults, uint32_t count) {
+    uint32_t                i, value;
+
+    if (quad != pTable->peakQuad) {
+        pTable->peakQuad = quad;
+        pTable->peak     = 0;
+    }
+    for (i = 0; i < count; i++) {
+        value = (pResults[i] < 0) ? (uint32_t)(-(int32_t)pResults[i]) : (uint32_t)pResults[i];
+        if (value > pTable->peak) {
+            pTable->peak = value;
+        }
+    }
+}
+
+/*!
+ * @brief       Learn the level of the next frame from the peak of the observed quad.
+ *
+ * @param[in]   pTable      Level table.
+ *
+ * @details     Called once all the sequences of the quad are observed. The
+ *              peak is compared at the level the quad was measured at.
+ */
+void ranging_Learn(RANGING_TABLE *pTable) {
+    uint32_t                quad  = pTable->peakQuad;
+    uint32_t                level;
+
+    if (quad >= pTable->count) {
+        return;
+    }
+
+    level = pTable->pLevels[quad];
+    if ((pTable->peak >= RANGING_HIGH_THR) && ((level + 1u) < RANGING_LEVELS)) {
+        level++;
+    }
+    else if ((pTable->peak < RANGING_LOW_THR) && (level > 0u)) {
+        level--;
+    }
+    pTable->pNext[quad] = (uint8_t)level;
+    pTable->peak        = 0;
+}
+
+/*!
+ * @brief       Waveform generator amplitude of a level.
+ *
+ * @param[in]   nominal     Amplitude of level 0, in DAC codes.
+ * @param[in]   level       Excitation level.
+ *
+ * @return      nominal >> level, rounded to nearest and at least 1.
+ */
+uint16_t ranging_Amplitude(uint16_t nominal, uint32_t level) {
+    uint32_t                amplitude;
+
+    if (0u == level) {
+        return nominal;
+    }
+    amplitude = ((uint32_t)nominal + (1u << (level - 1u))) >> level;
+
+    return (uint16_t)((amplitude > 0u) ? amplitude : 1u);
+}
+
+/*
+** EOF
+*/
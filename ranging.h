@@ -0,0 +1,71 @@
+/*!
+ *****************************************************************************
+ * @file:   ranging.h
+ * @brief:  Per-quad excitation ranging learned from the previous frame
+ *
+ * Every quad of a frame is measured at an excitation level: level L runs the
+ * waveform generator at the nominal amplitude shifted right by L, so the
+ * current and voltage DFT results scale by 2^-L and their ratio, the
+ * impedance, does not change.
+ *
+ * The table keeps the level of every quad. While a frame is emitted, the
+ * largest DFT result of each quad is compared with two thresholds: a quad
+ * close to the int16 full scale is attenuated by one more level in the next
+ * frame, a quad that would still fit at twice its amplitude gets one level
+ * back. Levels learned during a frame only take effect at ranging_Begin(),
+ * so every frame, and every average of frames, is measured with one set of
+ * levels.
+ *
+ * The caller provides the storage, one byte per quad for the levels in use
+ * and one for the learned ones.
+ *****************************************************************************/
+
+#ifndef __RANGING_H__
+#define __RANGING_H__
+
+#include <stdint.h>
+
+#include "device.h"
+
+/* C++ linkage */
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Excitation levels: nominal amplitude, 1/2, 1/4 and 1/8 of it */
+#define RANGING_LEVELS              (4u)
+/* Largest DFT result that gets one more level of attenuation, 75 % of full scale */
+#define RANGING_HIGH_THR            (24576u)
+/* Largest DFT result that gets one level back, its double stays under RANGING_HIGH_THR */
+#define RANGING_LOW_THR             (10240u)
+
+/* Level table, the arrays hold capacity quads each */
+typedef struct {
+    uint8_t                *pLevels;        /*!< Level of each quad in the current frame    */
+    uint8_t                *pNext;          /*!< Level of each quad in the next frame       */
+    uint32_t                capacity;       /*!< Quads the arrays can hold                  */
+    uint32_t                count;          /*!< Quads of the frame                         */
+    uint32_t                peakQuad;       /*!< Quad whose results are being observed      */
+    uint32_t                peak;           /*!< Largest DFT result of peakQuad so far      */
+    uint32_t                changes;        /*!< Levels changed by the last ranging_Begin() */
+} RANGING_TABLE;
+
+void                        ranging_Init            (RANGING_TABLE *pTable, uint8_t *pLevels, uint8_t *pNext,
+                                                     uint32_t capacity);
+void                        ranging_Reset           (RANGING_TABLE *pTable, uint32_t count);
+uint32_t                    ranging_Begin           (RANGING_TABLE *pTable);
+uint32_t                    ranging_Level           (const RANGING_TABLE *pTable, uint32_t quad);
+void                        ranging_Observe         (RANGING_TABLE *pTable, uint32_t quad, const int16_t *pResults,
+                                                     uint32_t count);
+void                        ranging_Learn           (RANGING_TABLE *pTable);
+uint16_t                    ranging_Amplitude       (uint16_t nominal, uint32_t level);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __RANGING_H__ */
+
+/*
+** EOF
+*/
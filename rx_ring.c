@@ -0,0 +1,96 @@
+/*!
+ *****************************************************************************
+ * @file:   rx_ring.c
+ * @brief:  Two-half ring of DFT results filled by the AFE Rx DMA
+ *
+ * Half n of the stream lives in half n % 2 of the buffer. When half n
+ * completes, the DMA starts writing half n + 1 over half n - 1, so the only
+ * completed half that is safe to read is the newest one, filled - 1.
+ *****************************************************************************/
+
+#include <stddef.h>
+
+#include "rx_ring.h"
+
+/*!
+ * @brief       Attach a DMA buffer to a ring.
+ *
+ * @param[out]  pRing       Ring.
+ * @param[in]   pBuffer     Buffer of 2 * halfSize halfwords, given to the Rx DMA.
+ * @param[in]   halfSize    Halfwords per half, the DMA cycle size.
+ */
+void rxring_Init(RX_RING *pRing, int16_t *pBuffer, uint32_t halfSize) {
+    pRing->pBuffer  = pBuffer;
+    pRing->halfSize = halfSize;
+    rxring_Reset(pRing);
+}
+
+/*!
+ * @brief       Empty a ring, before the Rx DMA is restarted at the first half.
+ *
+ * @param[in]   pRing       Ring.
+ */
+void rxring_Reset(RX_RING *pRing) {
+    pRing->filled   = 0;
+    pRing->consumed = 0;
+    pRing->lost     = 0;
+}
+
+/*!
+ * @brief       Count a half completed by the DMA.
+ *
+ * @param[in]   pRing       Ring.
+ *
+ * @details     Called from the Rx DMA callback, the halves complete in order.
+ */
+void rxring_Complete(RX_RING *pRing) {
+    pRing->filled++;
+}
+
+/*!
+ * @brief       Oldest completed half that has not been released.
+ *
+ * @param[in]   pRing       Ring.
+ *
+ * @return      The half, NULL if none has completed since the last release.
+ *
+ * @details     Halves older than the newest completed one are being
+ *              overwritten: they are counted as lost and skipped.
+ */
+const int16_t *rxring_Peek(RX_RING *pRing) {
+    uint32_t                filled = pRing->filled;
+
+    if (pRing->consumed == filled) {
+        return NULL;
+    }
+
+    if ((filled - pRing->consumed) > 1u) {
+        pRing->lost    += (filled - 1u) - pRing->consumed;
+        pRing->consumed = filled - 1u;
+    }
+
+    return &pRing->pBuffer[(pRing->consumed & 1u) * pRing->halfSize];
+}
+
+/*!
+ * @brief       Give back the half returned by rxring_Peek().
+ *
+ * @param[in]   pRing       Ring.
+ *
+ * @return      false if the DMA started overwriting the half before it was
+ *              released, its values are then not reliable.
+ */
+bool_t rxring_Release(RX_RING *pRing) {
+    bool_t                  bIntact = ((pRing->filled - pRing->consumed) > 1u) ? false : true;
+
+    if (!bIntact) {
+        pRing->lost++;
+    }
+    pRing->consumed++;
+
+    return bIntact;
+}
+
+/*
+** EOF
+*/
@@ -0,0 +1,54 @@
+/*!
+ *****************************************************************************
+ * @file:   rx_ring.h
+ * @brief:  Two-half ring of DFT results filled by the AFE Rx DMA
+ *
+ * In dual buffer mode the AFE driver programs the Rx DMA cycles alternately
+ * into the two halves of one buffer and calls the Rx DMA callback with each
+ * completed half. The callback only counts halves (rxring_Complete()); the
+ * main loop takes the oldest completed half with rxring_Peek() and gives it
+ * back with rxring_Release().
+ *
+ * While the main loop reads a half, the DMA fills the other one. A half is
+ * lost if the DMA completes the other half and starts overwriting it
+ * before it is released: rxring_Peek() then skips to the newest half and
+ * rxring_Release() reports the half it returned as overwritten. The DMA
+ * side and the main loop side each write their own counter only.
+ *****************************************************************************/
+
+#ifndef __RX_RING_H__
+#define __RX_RING_H__
+
+#include <stdint.h>
+
+#include "device.h"
+
+/* C++ linkage */
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Ring of two halves of halfSize halfwords each */
+typedef struct {
+    int16_t                *pBuffer;        /*!< 2 * halfSize halfwords, the DMA buffer     */
+    uint32_t                halfSize;       /*!< Halfwords per half, one DMA cycle          */
+    volatile uint32_t       filled;         /*!< Halves completed by the DMA                */
+    uint32_t                consumed;       /*!< Halves released by the main loop           */
+    uint32_t                lost;           /*!< Halves overwritten before being released   */
+} RX_RING;
+
+void                        rxring_Init             (RX_RING *pRing, int16_t *pBuffer, uint32_t halfSize);
+void                        rxring_Reset            (RX_RING *pRing);
+void                        rxring_Complete         (RX_RING *pRing);
+const int16_t              *rxring_Peek             (RX_RING *pRing);
+bool_t                      rxring_Release          (RX_RING *pRing);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __RX_RING_H__ */
+
+/*
+** EOF
+*/
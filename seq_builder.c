@@ -0,0 +1,588 @@
+/*!
+ *****************************************************************************
+ * @file:   seq_builder.c
+ * @brief:  AFE sequence builder with run time settling and DFT times
+ *
+ * The auto-tuning shortens the DFT windows and the voltage settling step by
+ * step, measuring the same quad repeatedly at each step, and keeps the
+ * shortest timing whose magnitude spread stays under the threshold.
+ *
+ * The command count of a SEQ_OBJECT lives in its safety word, so a sequence
+ * declared with a placeholder CRC can be attached as is.
+ *****************************************************************************/
+
+#include <stddef.h>
+
+#include "seq_builder.h"
+
+static uint32_t             seq_Isqrt               (uint64_t value);
+static void                 seq_Append4Wire         (SEQ_OBJECT *pObj, const SEQ_TIMING *pTiming);
+static void                 seq_Put                 (SEQ_OBJECT *pObj, uint32_t *pIndex, uint32_t command, bool_t bAppend);
+static uint32_t             seq_QuadCommands        (const uint32_t *const *seqs, uint32_t numSeqs);
+static bool_t               seq_BuildBlockOf        (SEQ_OBJECT *pObj, const uint32_t *const *seqs,
+                                                     const uint32_t *const *const *quadSeqs, uint32_t numSeqs,
+                                                     uint32_t numQuads, uint32_t switchUs);
+static bool_t               seq_Shorten             (SEQ_TIMING *pTiming);
+static bool_t               seq_MeasureSpread       (const SEQ_TIMING *pTiming, uint32_t samples, SEQ_MEASURE_FN measure,
+                                                     uint32_t *pSeq, uint32_t *pCvPpm);
+
+/* Integer square root */
+static uint32_t seq_Isqrt(uint64_t value) {
+    uint64_t                root = 0;
+    uint64_t                bit  = (uint64_t)1 << 62;
+
+    while (bit > value) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root   = (root >> 1) + bit;
+        }
+        else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return (uint32_t)root;
+}
+
+/* Shorten the DFT windows and the voltage settling by a quarter, false at the limit */
+static bool_t seq_Shorten(SEQ_TIMING *pTiming) {
+    uint32_t                minDftUs = (SEQ_AUTOTUNE_MIN_PERIODS * 1000000u + pTiming->frequency - 1u) / pTiming->frequency;
+    uint32_t                dftUs    = pTiming->dftTimeUs - pTiming->dftTimeUs / 4u;
+    uint32_t                settleUs = pTiming->voltageSettleUs - pTiming->voltageSettleUs / 4u;
+
+    if (dftUs < minDftUs) {
+        return false;
+    }
+    pTiming->dftTimeUs = dftUs;
+
+    /* The voltage settling never goes below the current settling */
+    pTiming->voltageSettleUs = (settleUs > pTiming->currentSettleUs) ? settleUs : pTiming->currentSettleUs;
+
+    return true;
+}
+
+/* Measure a timing repeatedly, returns the std deviation / mean of the magnitudes in ppm */
+static bool_t seq_MeasureSpread(const SEQ_TIMING *pTiming, uint32_t samples, SEQ_MEASURE_FN measure,
+                                uint32_t *pSeq, uint32_t *pCvPpm) {
+    int32_t                 values[32];
+    int64_t                 sum = 0;
+    int64_t                 mean, delta;
+    uint64_t                variance = 0;
+    uint32_t                i;
+
+    if (samples > (sizeof(values) / sizeof(values[0]))) {
+        samples = sizeof(values) / sizeof(values[0]);
+    }
+
+    if (0u == seq_Build4Wire(pTiming, pSeq, SEQ_4WIRE_LENGTH)) {
+        return false;
+    }
+
+    for (i = 0; i < samples; i++) {
+        if (!measure(pSeq, &values[i])) {
+            return false;
+        }
+        sum += values[i];
+    }
+
+    mean = sum / (int64_t)samples;
+    if (mean <= 0) {
+        return false;
+    }
+
+    for (i = 0; i < samples; i++) {
+        delta     = (int64_t)values[i] - mean;
+        variance += (uint64_t)(delta * delta);
+    }
+    variance /= samples;
+
+    *pCvPpm = (uint32_t)(((uint64_t)seq_Isqrt(variance) * 1000000u) / (uint64_t)mean);
+
+    return true;
+}
+
+/* Current through the TIA, then the voltage on AN_A */
+static void seq_Append4Wire(SEQ_OBJECT *pObj, const SEQ_TIMING *pTiming) {
+    uint32_t                dft = SEQ_WAIT(seq_DftCycles(pTiming));
+
+    /* TIA */
+    seq_Append(pObj, 0x86007788);   /* DMUX_STATE = 8, PMUX_STATE = 8, NMUX_STATE = 7, TMUX_STATE = 7     */
+    seq_Append(pObj, 0xA0000002);   /* AFE_ADC_CFG: TIA, no bypass, offset and gain correction.           */
+    seq_Append(pObj, SEQ_WAIT(seq_WaitCycles(pTiming->inputSettleUs)));
+    seq_Append(pObj, 0x80024EF0);   /* AFE_CFG: WAVEGEN_EN = 1                                            */
+    seq_Append(pObj, SEQ_WAIT(seq_WaitCycles(pTiming->currentSettleUs)));
+    seq_Append(pObj, 0x8002CFF0);   /* AFE_CFG: ADC_CONV_EN = 1, DFT_EN = 1                               */
+    seq_Append(pObj, dft);
+    seq_Append(pObj, 0x80020EF0);   /* AFE_CFG: WAVEGEN_EN = 0, ADC_CONV_EN = 0, DFT_EN = 0               */
+
+    /* AN_A */
+    seq_Append(pObj, 0xA0000208);   /* AFE_ADC_CFG: AN_A, Use GAIN and OFFSET AUX                         */
+    seq_Append(pObj, SEQ_WAIT(seq_WaitCycles(pTiming->inputSettleUs)));
+    seq_Append(pObj, 0x80024EF0);   /* AFE_CFG: WAVEGEN_EN = 1                                            */
+    seq_Append(pObj, SEQ_WAIT(seq_WaitCycles(pTiming->voltageSettleUs)));
+    seq_Append(pObj, 0x8002CFF0);   /* AFE_CFG: ADC_CONV_EN = 1, DFT_EN = 1                               */
+    seq_Append(pObj, dft);
+    seq_Append(pObj, 0x80020EF0);   /* AFE_CFG: WAVEGEN_EN = 0, ADC_CONV_EN = 0, DFT_EN = 0               */
+    seq_Append(pObj, 0x86007788);   /* DMUX_STATE = 8, PMUX_STATE = 8, NMUX_STATE = 7, TMUX_STATE = 7     */
+    seq_Append(pObj, SEQ_END_COMMAND);
+}
+
+/* Write the next command of a sequence being rebuilt, appending or patching in place */
+static void seq_Put(SEQ_OBJECT *pObj, uint32_t *pIndex, uint32_t command, bool_t bAppend) {
+    if (bAppend) {
+        seq_Append(pObj, command);
+    }
+    else {
+        seq_Patch(pObj, *pIndex, command);
+    }
+    (*pIndex)++;
+}
+
+/* Commands of one quad of a block, end commands excluded, 0 if a sequence cannot be concatenated */
+static uint32_t seq_QuadCommands(const uint32_t *const *seqs, uint32_t numSeqs) {
+    uint32_t                perQuad = 0;
+    uint32_t                i, count;
+
+    for (i = 0; i < numSeqs; i++) {
+        count = SEQ_COMMAND_COUNT(seqs[i][0]);
+        if ((0u == count) || (SEQ_END_COMMAND != seqs[i][count])) {
+            return 0;
+        }
+        perQuad += count - 1u;
+    }
+
+    return perQuad;
+}
+
+/* Block of numQuads quads running seqs, or quadSeqs[quad] if seqs is NULL */
+static bool_t seq_BuildBlockOf(SEQ_OBJECT *pObj, const uint32_t *const *seqs, const uint32_t *const *const *quadSeqs,
+                               uint32_t numSeqs, uint32_t numQuads, uint32_t switchUs) {
+    const uint32_t *const  *pQuad;
+    uint32_t                length = 0;
+    uint32_t                index  = 1;
+    uint32_t                quad, i, cmd, count, perQuad;
+    bool_t                  bAppend;
+
+    if ((0u == numSeqs) || (0u == numQuads)) {
+        return false;
+    }
+
+    for (quad = 0; quad < numQuads; quad++) {
+        pQuad = (NULL != seqs) ? seqs : quadSeqs[quad];
+        if (0u == (perQuad = seq_QuadCommands(pQuad, numSeqs))) {
+            return false;
+        }
+        length += perQuad;
+    }
+    length += (switchUs ? 2u * (numQuads - 1u) : 0u) + 2u;
+
+    if (length > pObj->maxWords) {
+        return false;
+    }
+
+    bAppend = (SEQ_COMMAND_COUNT(pObj->pWords[0]) != (length - 1u)) ? true : false;
+    if (bAppend) {
+        seq_Reset(pObj);
+    }
+
+    for (quad = 0; quad < numQuads; quad++) {
+        pQuad = (NULL != seqs) ? seqs : quadSeqs[quad];
+        if ((quad > 0u) && (0u != switchUs)) {
+            seq_Put(pObj, &index, SEQ_SWITCH_COMMAND, bAppend);
+            seq_Put(pObj, &index, SEQ_WAIT(seq_WaitCycles(switchUs)), bAppend);
+        }
+        for (i = 0; i < numSeqs; i++) {
+            count = SEQ_COMMAND_COUNT(pQuad[i][0]);
+            for (cmd = 1; cmd < count; cmd++) {
+                seq_Put(pObj, &index, pQuad[i][cmd], bAppend);
+            }
+        }
+    }
+    seq_Put(pObj, &index, SEQ_END_COMMAND, bAppend);
+
+    return true;
+}
+
+/*!
+ * @brief       Wrap a sequence in RAM.
+ *
+ * @param[out]  pObj        Sequence object.
+ * @param[in]   pWords      Sequence, starting with its safety word.
+ * @param[in]   maxWords    Size of pWords, safety word included.
+ *
+ * @details     The command count is taken from the safety word, its CRC is
+ *              not trusted and is recomputed by the first seq_Commit().
+ */
+void seq_Attach(SEQ_OBJECT *pObj, uint32_t *pWords, uint32_t maxWords) {
+    pObj->pWords    = pWords;
+    pObj->maxWords  = maxWords;
+    pObj->bCrcValid = false;
+}
+
+/*!
+ * @brief       Empty a sequence.
+ *
+ * @param[in]   pObj        Sequence object.
+ */
+void seq_Reset(SEQ_OBJECT *pObj) {
+    pObj->pWords[0] = 0;
+    pObj->bCrcValid = false;
+}
+
+/*!
+ * @brief       Add a command at the end of a sequence.
+ *
+ * @param[in]   pObj        Sequence object.
+ * @param[in]   command     Sequencer command.
+ *
+ * @return      false if the sequence is full.
+ */
+bool_t seq_Append(SEQ_OBJECT *pObj, uint32_t command) {
+    uint32_t                count = SEQ_COMMAND_COUNT(pObj->pWords[0]);
+
+    if (count + 1u >= pObj->maxWords) {
+        return false;
+    }
+
+    pObj->pWords[count + 1u] = command;
+    pObj->pWords[0]          = (count + 1u) << 16;
+    pObj->bCrcValid          = false;
+
+    return true;
+}
+
+/*!
+ * @brief       Replace a command of a sequence.
+ *
+ * @param[in]   pObj        Sequence object.
+ * @param[in]   index       Word index of the command, 1 for the first command.
+ * @param[in]   command     Sequencer command.
+ *
+ * @return      false if index is not a command of the sequence.
+ *
+ * @details     Writing the command already in place keeps the CRC valid, so
+ *              patching a sequence with unchanged settings costs no CRC.
+ */
+bool_t seq_Patch(SEQ_OBJECT *pObj, uint32_t index, uint32_t command) {
+    if ((0u == index) || (index > SEQ_COMMAND_COUNT(pObj->pWords[0]))) {
+        return false;
+    }
+
+    if (pObj->pWords[index] != command) {
+        pObj->pWords[index] = command;
+        pObj->bCrcValid     = false;
+    }
+
+    return true;
+}
+
+/*!
+ * @brief       Make the safety word CRC match the commands.
+ *
+ * @param[in]   pObj        Sequence object.
+ *
+ * @return      The sequence, ready for adi_AFE_RunSequence() with the
+ *              software CRC disabled.
+ *
+ * @details     The CRC is only recomputed after the sequence has changed.
+ */
+const uint32_t *seq_Commit(SEQ_OBJECT *pObj) {
+    if (!pObj->bCrcValid) {
+        pObj->pWords[0] &= 0xFFFF0000u;
+        pObj->pWords[0] |= adi_AFE_CalculateSequenceCRC(pObj->pWords);
+        pObj->bCrcValid  = true;
+    }
+
+    return pObj->pWords;
+}
+
+/*!
+ * @brief       Convert a time into sequencer wait cycles.
+ *
+ * @param[in]   us          Time in microseconds.
+ *
+ * @return      Number of ACLK cycles.
+ */
+uint32_t seq_WaitCycles(uint32_t us) {
+    return us * (SEQ_CLOCK_HZ / 1000000u);
+}
+
+/*!
+ * @brief       Length of the DFT windows of a timing.
+ *
+ * @param[in]   pTiming     Sequence timing.
+ *
+ * @return      Number of ACLK cycles covering the whole excitation periods
+ *              closest to dftTimeUs, at least one period.
+ */
+uint32_t seq_DftCycles(const SEQ_TIMING *pTiming) {
+    uint64_t                periods;
+
+    if (0u == pTiming->frequency) {
+        return seq_WaitCycles(pTiming->dftTimeUs);
+    }
+
+    periods = ((uint64_t)pTiming->dftTimeUs * pTiming->frequency + 500000u) / 1000000u;
+    if (0u == periods) {
+        periods = 1;
+    }
+
+    return (uint32_t)((periods * SEQ_CLOCK_HZ + pTiming->frequency / 2u) / pTiming->frequency);
+}
+
+/*!
+ * @brief       Waveform generator frequency control word of a frequency.
+ *
+ * @param[in]   frequency   Excitation frequency in Hz.
+ *
+ * @return      FCW = frequency * 2^26 / ACLK, rounded.
+ */
+uint32_t seq_Fcw(uint32_t frequency) {
+    return (uint32_t)((((uint64_t)frequency << 26) + SEQ_CLOCK_HZ / 2u) / SEQ_CLOCK_HZ);
+}
+
+/*!
+ * @brief       Run time of a sequence.
+ *
+ * @param[in]   seq         Sequence, starting with its safety word.
+ *
+ * @return      Number of ACLK cycles: one per command up to SEQ_END_COMMAND, plus the waits.
+ */
+uint32_t seq_Cycles(const uint32_t *seq) {
+    uint32_t                count  = SEQ_COMMAND_COUNT(seq[0]);
+    uint32_t                cycles = 0;
+    uint32_t                i;
+
+    for (i = 1; i <= count; i++) {
+        cycles++;
+        if (SEQ_END_COMMAND == seq[i]) {
+            break;
+        }
+        /* Waits have bits 31 (write) and 30 (timeout) clear */
+        if (0u == (seq[i] & 0xC0000000u)) {
+            cycles += seq[i];
+        }
+    }
+
+    return cycles;
+}
+
+/*!
+ * @brief       Build the 4-wire magnitude sequence.
+ *
+ * @param[in]   pTiming     Sequence timing.
+ * @param[out]  pSeq        Destination of the sequence.
+ * @param[in]   maxWords    Size of pSeq.
+ *
+ * @return      Number of words written (SEQ_4WIRE_LENGTH), 0 if pSeq is too small.
+ *
+ * @details     The safety word carries the real CRC, so the sequence can be run
+ *              with or without the software CRC. The sequence returns
+ *              SEQ_4WIRE_RESULTS DFT results.
+ */
+uint32_t seq_Build4Wire(const SEQ_TIMING *pTiming, uint32_t *pSeq, uint32_t maxWords) {
+    SEQ_OBJECT              obj;
+
+    if (maxWords < SEQ_4WIRE_LENGTH) {
+        return 0;
+    }
+
+    seq_Attach(&obj, pSeq, maxWords);
+    seq_Reset(&obj);
+    seq_Append4Wire(&obj, pTiming);
+    seq_Commit(&obj);
+
+    return SEQ_COMMAND_COUNT(pSeq[0]) + 1u;
+}
+
+/*!
+ * @brief       Build the 4-wire magnitude sequence at the frequency of its timing.
+ *
+ * @param[in]   pTiming     Sequence timing, pTiming->frequency is programmed
+ *                          into the waveform generator.
+ * @param[out]  pSeq        Destination of the sequence.
+ * @param[in]   maxWords    Size of pSeq.
+ *
+ * @return      Number of words written (SEQ_4WIRE_FREQ_LENGTH), 0 if pSeq is too small.
+ *
+ * @details     Same as seq_Build4Wire(), preceded by the FCW write, so sequences
+ *              of different frequencies can be run back to back on one quad.
+ *              The waveform generator is off when the FCW changes and the
+ *              current settling time covers the new frequency.
+ */
+uint32_t seq_Build4WireFreq(const SEQ_TIMING *pTiming, uint32_t *pSeq, uint32_t maxWords) {
+    SEQ_OBJECT              obj;
+
+    if (maxWords < SEQ_4WIRE_FREQ_LENGTH) {
+        return 0;
+    }
+
+    seq_Attach(&obj, pSeq, maxWords);
+    seq_Reset(&obj);
+    seq_Append(&obj, SEQ_MMR_WRITE(REG_AFE_AFE_WG_FCW, seq_Fcw(pTiming->frequency)));
+    seq_Append4Wire(&obj, pTiming);
+    seq_Commit(&obj);
+
+    return SEQ_COMMAND_COUNT(pSeq[0]) + 1u;
+}
+
+/*!
+ * @brief       Size of the block sequence of numQuads quads.
+ *
+ * @param[in]   seqs        Sequences run in turn on every quad.
+ * @param[in]   numSeqs     Number of sequences.
+ * @param[in]   numQuads    Quads measured by the block, at least 1.
+ * @param[in]   switchUs    Wait between quads, 0 for none.
+ *
+ * @return      Number of words of the block, safety word included, 0 if one
+ *              of the sequences does not end with SEQ_END_COMMAND.
+ */
+uint32_t seq_BlockLength(const uint32_t *const *seqs, uint32_t numSeqs, uint32_t numQuads, uint32_t switchUs) {
+    uint32_t                perQuad = seq_QuadCommands(seqs, numSeqs);
+
+    if ((0u == perQuad) || (0u == numQuads)) {
+        return 0;
+    }
+
+    /* Quad commands, the switch interrupts and waits between quads, the end command and the safety word */
+    return numQuads * perQuad + (switchUs ? 2u * (numQuads - 1u) : 0u) + 2u;
+}
+
+/*!
+ * @brief       Build a sequence measuring several quads in one sequencer program.
+ *
+ * @param[in]   pObj        Destination sequence object.
+ * @param[in]   seqs        Sequences run in turn on every quad.
+ * @param[in]   numSeqs     Number of sequences.
+ * @param[in]   numQuads    Quads measured by the block, at least 1.
+ * @param[in]   switchUs    Wait before each quad but the first, for the
+ *                          multiplexers to be switched, 0 for none.
+ *
+ * @return      false if the block does not fit pObj or a sequence cannot be
+ *              concatenated, see seq_BlockLength().
+ *
+ * @details     Every quad runs the sequences without their end command, the
+ *              block returns numQuads times the results of the sequences. Each
+ *              switch wait is preceded by SEQ_SWITCH_COMMAND: the custom
+ *              interrupt is raised once the previous quad has stopped the
+ *              excitation, and the excitation stays off during the wait. The
+ *              input settling of the first sequence covers the multiplexer
+ *              settling.
+ *
+ *              A block of the same length is patched in place, so rebuilding
+ *              an unchanged block keeps its CRC valid and seq_Commit() free.
+ */
+bool_t seq_BuildBlock(SEQ_OBJECT *pObj, const uint32_t *const *seqs, uint32_t numSeqs,
+                      uint32_t numQuads, uint32_t switchUs) {
+    return seq_BuildBlockOf(pObj, seqs, NULL, numSeqs, numQuads, switchUs);
+}
+
+/*!
+ * @brief       Build a block sequence whose quads each run their own sequences.
+ *
+ * @param[in]   pObj        Destination sequence object.
+ * @param[in]   quadSeqs    Sequences of each quad, numQuads lists of numSeqs.
+ * @param[in]   numSeqs     Number of sequences per quad.
+ * @param[in]   numQuads    Quads measured by the block, at least 1.
+ * @param[in]   switchUs    Wait before each quad but the first, 0 for none.
+ *
+ * @return      false if the block does not fit pObj or a sequence cannot be
+ *              concatenated.
+ *
+ * @details     Same as seq_BuildBlock(), e.g. for quads measured at different
+ *              excitation amplitudes. The quads return the same number of
+ *              results, the CRC is only recomputed if a quad changed.
+ */
+bool_t seq_BuildBlockQuads(SEQ_OBJECT *pObj, const uint32_t *const *const *quadSeqs, uint32_t numSeqs,
+                           uint32_t numQuads, uint32_t switchUs) {
+    return seq_BuildBlockOf(pObj, NULL, quadSeqs, numSeqs, numQuads, switchUs);
+}
+
+/*!
+ * @brief       Build a copy of a sequence preceded by one command.
+ *
+ * @param[in]   pObj        Destination sequence object.
+ * @param[in]   command     Command run before the sequence, e.g. a register write.
+ * @param[in]   seq         Sequence, with a valid command count.
+ *
+ * @return      false if the copy does not fit pObj.
+ *
+ * @details     A copy of the same length is patched in place, so rebuilding
+ *              an unchanged copy keeps its CRC valid and seq_Commit() free.
+ */
+bool_t seq_BuildPrefix(SEQ_OBJECT *pObj, uint32_t command, const uint32_t *seq) {
+    uint32_t                count = SEQ_COMMAND_COUNT(seq[0]);
+    uint32_t                index = 1;
+    uint32_t                cmd;
+    bool_t                  bAppend;
+
+    if ((count + 2u) > pObj->maxWords) {
+        return false;
+    }
+
+    bAppend = (SEQ_COMMAND_COUNT(pObj->pWords[0]) != (count + 1u)) ? true : false;
+    if (bAppend) {
+        seq_Reset(pObj);
+    }
+
+    seq_Put(pObj, &index, command, bAppend);
+    for (cmd = 1; cmd <= count; cmd++) {
+        seq_Put(pObj, &index, seq[cmd], bAppend);
+    }
+
+    return true;
+}
+
+/*!
+ * @brief       Shorten the DFT windows until the magnitude spread crosses a threshold.
+ *
+ * @param[in]   pTiming     Starting timing, replaced by the shortest accepted timing.
+ * @param[in]   pConfig     Auto-tuning parameters.
+ * @param[in]   measure     Runs a sequence on a fixed quad and returns its magnitude.
+ * @param[out]  pSeq        Sequence buffer of SEQ_4WIRE_LENGTH words, holds the
+ *                          sequence of the selected timing on exit.
+ * @param[out]  pResult     Auto-tuning result.
+ *
+ * @return      false if even the starting timing is above the threshold or a
+ *              measurement failed; the starting timing is then kept.
+ *
+ * @details     Each step shortens the DFT windows and the voltage settling by a
+ *              quarter, down to SEQ_AUTOTUNE_MIN_PERIODS excitation periods.
+ */
+bool_t seq_AutoTune(SEQ_TIMING *pTiming, const SEQ_AUTOTUNE_CONFIG *pConfig,
+                    SEQ_MEASURE_FN measure, uint32_t *pSeq, SEQ_AUTOTUNE_RESULT *pResult) {
+    SEQ_TIMING              candidate = *pTiming;
+    uint32_t                accepted  = 0;
+    uint32_t                cvPpm;
+
+    pResult->steps = 0;
+    pResult->cvPpm = 0;
+
+    if ((pConfig->samples >= 2u) && (0u != pTiming->frequency)) {
+        do {
+            if (!seq_MeasureSpread(&candidate, pConfig->samples, measure, pSeq, &cvPpm) ||
+                (cvPpm > pConfig->maxCvPpm)) {
+                break;
+            }
+            *pTiming       = candidate;
+            pResult->cvPpm = cvPpm;
+            accepted++;
+        } while (seq_Shorten(&candidate));
+    }
+
+    if (accepted) {
+        pResult->steps = accepted - 1u;
+    }
+
+    seq_Build4Wire(pTiming, pSeq, SEQ_4WIRE_LENGTH);
+
+    return (accepted ? true : false);
+}
+
+/*
+** EOF
+*/
@@ -0,0 +1,120 @@
+/*!
+ *****************************************************************************
+ * @file:   seq_builder.h
+ * @brief:  AFE sequence builder with run time settling and DFT times
+ *
+ * Builds the 4-wire magnitude sequence (current through the TIA, then the
+ * voltage on AN_A) from a SEQ_TIMING instead of hard-coded wait words, so
+ * every mode can trade SNR for measurement rate. The DFT windows are
+ * rounded to a whole number of excitation periods.
+ *
+ * A SEQ_OBJECT wraps a sequence in RAM and keeps its safety word CRC valid:
+ * patching a command only marks the CRC stale, and seq_Commit() recomputes it
+ * once before the next run, so the sequences can be run with the hardware
+ * CRC check instead of the software CRC.
+ *
+ * A block sequence measures several quads in one sequencer program: the
+ * quad sequences are concatenated without their end command, separated by
+ * a custom interrupt and a wait during which the CPU switches the
+ * multiplexers. Without the wait,
+ * a block repeats the measurement of one quad at an even sample rate. The
+ * quads of a block can also run different sequences, e.g. copies of one
+ * sequence preceded by different waveform generator amplitudes
+ * (seq_BuildPrefix()).
+ *****************************************************************************/
+
+#ifndef __SEQ_BUILDER_H__
+#define __SEQ_BUILDER_H__
+
+#include <stdint.h>
+
+#include "afe.h"
+
+/* C++ linkage */
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Sequencer clock (ACLK) */
+#define SEQ_CLOCK_HZ                (16000000u)
+/* Words of the 4-wire magnitude sequence, safety word included */
+#define SEQ_4WIRE_LENGTH            (18u)
+/* Words of the 4-wire magnitude sequence that also programs the excitation frequency */
+#define SEQ_4WIRE_FREQ_LENGTH       (SEQ_4WIRE_LENGTH + 1u)
+/* DFT results of the 4-wire magnitude sequence: current then voltage, real and imaginary */
+#define SEQ_4WIRE_RESULTS           (4u)
+/* Last command of every sequence: AFE_SEQ_CFG, SEQ_EN = 0 */
+#define SEQ_END_COMMAND             (0x82000002u)
+/* Block quad switch: AFE_ANALOG_GEN_INT, CUSTOM_INT = 1, raises the AFE generate interrupt */
+#define SEQ_SWITCH_COMMAND          (0xD2000008u)
+
+/* Shortest DFT window used by the auto-tuning, in excitation periods */
+#define SEQ_AUTOTUNE_MIN_PERIODS    (4u)
+
+/* Waits and DFT windows of a sequence */
+typedef struct {
+    uint32_t                frequency;          /*!< Excitation frequency in Hz                         */
+    uint32_t                dftTimeUs;          /*!< DFT window of each measurement                     */
+    uint32_t                inputSettleUs;      /*!< Settling after switching the ADC input             */
+    uint32_t                currentSettleUs;    /*!< Excitation settling before the current DFT         */
+    uint32_t                voltageSettleUs;    /*!< Excitation settling before the voltage DFT         */
+} SEQ_TIMING;
+
+/* Sequence in RAM whose safety word CRC is computed once per change */
+typedef struct {
+    uint32_t               *pWords;             /*!< Safety word followed by the commands               */
+    uint32_t                maxWords;           /*!< Size of pWords, safety word included               */
+    bool_t                  bCrcValid;          /*!< The safety word CRC matches the commands           */
+} SEQ_OBJECT;
+
+/* Command count of a safety word */
+#define SEQ_COMMAND_COUNT(safety)   (((uint32_t)(safety) & 0xFFFF0000u) >> 16)
+
+/* Timing of the original seq_afe_fast_meas_4wire */
+#define SEQ_TIMING_4WIRE_DEFAULT(freq)  { (freq), 12852u, 100u, 200u, 12852u }
+
+/* Runs a sequence and returns the measured magnitude, false on failure */
+typedef bool_t (*SEQ_MEASURE_FN)    (const uint32_t *seq, int32_t *pMagnitude);
+
+/* Auto-tuning parameters */
+typedef struct {
+    uint32_t                samples;            /*!< Measurements per candidate timing, at least 2      */
+    uint32_t                maxCvPpm;           /*!< Largest accepted std deviation / mean, in ppm      */
+} SEQ_AUTOTUNE_CONFIG;
+
+/* Auto-tuning result */
+typedef struct {
+    uint32_t                steps;              /*!< Number of times the windows were shortened         */
+    uint32_t                cvPpm;              /*!< std deviation / mean of the selected timing, ppm   */
+} SEQ_AUTOTUNE_RESULT;
+
+void                        seq_Attach              (SEQ_OBJECT *pObj, uint32_t *pWords, uint32_t maxWords);
+void                        seq_Reset               (SEQ_OBJECT *pObj);
+bool_t                      seq_Append              (SEQ_OBJECT *pObj, uint32_t command);
+bool_t                      seq_Patch               (SEQ_OBJECT *pObj, uint32_t index, uint32_t command);
+const uint32_t             *seq_Commit              (SEQ_OBJECT *pObj);
+uint32_t                    seq_WaitCycles          (uint32_t us);
+uint32_t                    seq_DftCycles           (const SEQ_TIMING *pTiming);
+uint32_t                    seq_Fcw                 (uint32_t frequency);
+uint32_t                    seq_Cycles              (const uint32_t *seq);
+uint32_t                    seq_Build4Wire          (const SEQ_TIMING *pTiming, uint32_t *pSeq, uint32_t maxWords);
+uint32_t                    seq_Build4WireFreq      (const SEQ_TIMING *pTiming, uint32_t *pSeq, uint32_t maxWords);
+uint32_t                    seq_BlockLength         (const uint32_t *const *seqs, uint32_t numSeqs, uint32_t numQuads,
+                                                     uint32_t switchUs);
+bool_t                      seq_BuildBlock          (SEQ_OBJECT *pObj, const uint32_t *const *seqs, uint32_t numSeqs,
+                                                     uint32_t numQuads, uint32_t switchUs);
+bool_t                      seq_BuildBlockQuads     (SEQ_OBJECT *pObj, const uint32_t *const *const *quadSeqs,
+                                                     uint32_t numSeqs, uint32_t numQuads, uint32_t switchUs);
+bool_t                      seq_BuildPrefix         (SEQ_OBJECT *pObj, uint32_t command, const uint32_t *seq);
+bool_t                      seq_AutoTune            (SEQ_TIMING *pTiming, const SEQ_AUTOTUNE_CONFIG *pConfig,
+                                                     SEQ_MEASURE_FN measure, uint32_t *pSeq, SEQ_AUTOTUNE_RESULT *pResult);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __SEQ_BUILDER_H__ */
+
+/*
+** EOF
+*/
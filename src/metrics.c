@@ -30,7 +30,8 @@ typedef struct ADI_METRIC_DEV_DATA_TYPE
 {
     /* device attributes */
     uint16_t                Count;          /* timer count value                                                */
-    uint32_t                OverflowIndex;  /* number of times timer count overflows between start and stop     */
+    uint16_t                StartCount;     /* timer count value when the capture was started                   */
+    volatile uint32_t       OverflowIndex;  /* number of times timer count overflows between start and stop     */
     uint32_t                Accumulate;     /* running accumulation of the timer count between starts and stops */
     uint32_t                TestIndex;      /* general test index, used to count maybe the no. of ISR entries   */
     ADI_GPT_HANDLE          hGpTimer;       /* handle to timer                                                  */
@@ -73,6 +74,7 @@ ADI_METRIC_RESULT_TYPE adi_Metric_Init(ADI_GPT_DEV_ID_TYPE InstanceNum, ADI_METR
     hDevice->OverflowIndex = 0;
     hDevice->TestIndex = 0;
     hDevice->Count = 0;
+    hDevice->StartCount = 0;
     hDevice->Accumulate = 0;
 
     /* open timer instance */
@@ -96,11 +98,13 @@ ADI_METRIC_RESULT_TYPE adi_Metric_Init(ADI_GPT_DEV_ID_TYPE InstanceNum, ADI_METR
     {
     	return ADI_METRIC_ERROR;
     }
-    if(adi_GPT_SetPrescaler(hDevice->hGpTimer, ADI_GPT_PRESCALER_16)!= ADI_GPT_SUCCESS)
+    /* count every HFOSC cycle */
+    if(adi_GPT_SetPrescaler(hDevice->hGpTimer, ADI_GPT_PRESCALER_1)!= ADI_GPT_SUCCESS)
     {
     	return ADI_METRIC_ERROR;
     }
-    if(adi_GPT_RegisterCallback(hDevice->hGpTimer, GPTimerCallback, hDevice->hGpTimer)!= ADI_GPT_SUCCESS)
+    /* the callback counts the overflows of this metric instance */
+    if(adi_GPT_RegisterCallback(hDevice->hGpTimer, GPTimerCallback, hDevice)!= ADI_GPT_SUCCESS)
     {
     	return ADI_METRIC_ERROR;
     }
@@ -148,6 +152,10 @@ ADI_METRIC_RESULT_TYPE adi_Metric_UnInit(ADI_METRIC_DEV_HANDLE const hDevice)
 ADI_METRIC_RESULT_TYPE adi_Metric_Start(ADI_METRIC_DEV_HANDLE const hDevice)
 {
     ADI_METRIC_RESULT_TYPE result = ADI_METRIC_SUCCESS;
+
+    /* the timer is free running, remember where this capture starts */
+    adi_GPT_GetTxVal(hDevice->hGpTimer, &hDevice->StartCount);
+    hDevice->OverflowIndex = 0;
 #if defined (USE_ENABLE_API)
     /* this API call can consume considerable cycle counts when RTOS is enabled */
     if(adi_GPT_SetTimerEnable(hDevice->hGpTimer, true) != ADI_GPT_SUCCESS)
@@ -185,7 +193,8 @@ ADI_METRIC_RESULT_TYPE adi_Metric_Stop(ADI_METRIC_DEV_HANDLE const hDevice)
 #else
     pADI_GPT0->GPTCON &= ~TCON_ENABLE;
 #endif
-    hDevice->Accumulate += ((hDevice->OverflowIndex * 0xFFFF) + hDevice->Count);
+    adi_GPT_GetTxVal(hDevice->hGpTimer, &hDevice->Count);
+    hDevice->Accumulate += ((hDevice->OverflowIndex * 0x10000) + hDevice->Count - hDevice->StartCount);
     hDevice->OverflowIndex = 0;
     hDevice->Count = 0;
 
@@ -212,21 +221,58 @@ ADI_METRIC_RESULT_TYPE adi_Metric_IncIndex(ADI_METRIC_DEV_HANDLE const hDevice)
     return result;
 }
 /*!
- * @brief  Returns the accumulated count value between successive starts and stops.
+ * @brief  Returns the count since adi_Metric_Start(), without stopping the timer.
+ *
+ * @param[in]   hDevice    Device handle
+ *
+ * @return            Timer counts since the capture was started, overflows included.
+ *
+ * Differences of successive calls time consecutive sections of code with a single
+ * capture.
+ *
+ * Also correct with the timer interrupt masked, or from a higher priority handler:
+ * an overflow whose interrupt is still pending is taken from the timeout flag.
+ *
+ */
+uint32_t adi_Metric_GetCount(ADI_METRIC_DEV_HANDLE const hDevice)
+{
+    uint32_t overflows;
+    uint32_t pending;
+
+    /* read again if the timer overflowed while the count was being read */
+    do
+    {
+        overflows = hDevice->OverflowIndex;
+        adi_GPT_GetTxVal(hDevice->hGpTimer, &hDevice->Count);
+        pending = 0;
+        /* the count wrapped and the interrupt has not counted it yet: read the count
+           again, it is now past the wrap whenever the first read was before it */
+        if (adi_GPT_GetTimeOutEventStatus(hDevice->hGpTimer))
+        {
+            adi_GPT_GetTxVal(hDevice->hGpTimer, &hDevice->Count);
+            pending = 1;
+        }
+    } while (overflows != hDevice->OverflowIndex);
+
+    return (((overflows + pending) * 0x10000) + hDevice->Count - hDevice->StartCount);
+}
+
+/*!
+ * @brief  Clears the accumulated count value.
  *
  * @param[in]   hDevice    Device handle
  *
  * @return            Status.
- *                    - #ADI_METRIC_ERROR                       Metrics internal timer has failed.
  *                    - #ADI_METRIC_SUCCESS                     Call completed successfully.
  *
- * Uninitialize and release an allocated metrics instance.
+ * Starts a new accumulation, for instance before measuring another code path.
  *
  */
-uint32_t adi_Metric_GetCount(ADI_METRIC_DEV_HANDLE const hDevice)
+ADI_METRIC_RESULT_TYPE adi_Metric_ClearAccumulate(ADI_METRIC_DEV_HANDLE const hDevice)
 {
-    adi_GPT_GetTxVal(hDevice->hGpTimer, &hDevice->Count);
-    return ((hDevice->OverflowIndex * 0xFFFF) + hDevice->Count);
+    hDevice->Accumulate = 0;
+
+    return ADI_METRIC_SUCCESS;
 }
 
 uint32_t adi_Metric_GetAccumulate(ADI_METRIC_DEV_HANDLE const hDevice)
@@ -27,6 +27,9 @@ License Agreement.
 #include <string.h>                /* for memcpy */
 #include "uart.h"
 #include "gpio.h"      /* GPIO configuration */
+#if (1 == ADI_UART_CFG_DMA_MODE_SUPPORT)
+#include "dma.h"       /* DMA transmit */
+#endif /* (1 == ADI_UART_CFG_DMA_MODE_SUPPORT) */
 
 #if (0 == ADI_UART_CFG_INTERRUPT_MODE_SUPPORT) && (0 == ADI_UART_CFG_POLLED_MODE_SUPPORT)
 #error Neither interrupt-mode nor polled-mode are enabled
@@ -36,6 +39,16 @@ License Agreement.
 #error Neither blocking nor non-blocking modes are enabled
 #endif
 
+#if (1 == ADI_UART_CFG_DMA_MODE_SUPPORT) && (0 == ADI_UART_CFG_INTERRUPT_MODE_SUPPORT)
+#error DMA mode uses the interrupt-mode transmit buffer, enable interrupt mode
+#endif
+
+#if (1 == ADI_UART_CFG_DMA_MODE_SUPPORT)
+#define IS_DMA_MODE(hDevice) ((hDevice)->bDMAMode)
+#else
+#define IS_DMA_MODE(hDevice) false
+#endif
+
 #if (0 == ADI_UART_CFG_INTERRUPT_MODE_SUPPORT)
 #define IS_INTERRUPT_MODE(hDevice) false
 #elif (0 == ADI_UART_CFG_POLLED_MODE_SUPPORT)
@@ -139,8 +152,15 @@ typedef struct ADI_UART_DEV_DATA_TYPE
 
     ADI_UART_CIRC_BUFFER_TYPE    RxBuffer;              /*!< receive buffer             */
     ADI_UART_CIRC_BUFFER_TYPE    TxBuffer;              /*!< transmit buffer            */
+    volatile uint16_t            RxDroppedCount;        /*!< bytes received into a full rx buffer */
+    uint16_t                     TxDroppedCount;        /*!< bytes of non-blocking writes that did not fit */
 #endif /* (1 == ADI_UART_CFG_INTERRUPT_MODE_SUPPORT) */
 
+#if (1 == ADI_UART_CFG_DMA_MODE_SUPPORT)
+    volatile bool_t              bTxDmaActive;          /*!< tx dma transfer in flight  */
+    uint16_t                     TxDmaCount;            /*!< bytes in the tx dma transfer */
+#endif /* (1 == ADI_UART_CFG_DMA_MODE_SUPPORT) */
+
 #if defined(ADI_DEBUG)
     ADI_UART_STATS_TYPE          Stats;                 /*!< uart statistics            */
 #endif /* defined(ADI_DEBUG) */
@@ -186,13 +206,25 @@ static ADI_UART_DEV_DATA_TYPE UART_DevData[] =
            NULL,                                        /*!< tx buffer size             */
            NULL,                                        /*!< number of free elements    */
        },
+       0,                                               /*!< no dropped receive bytes   */
 #endif /* (1 == ADI_UART_CFG_INTERRUPT_MODE_SUPPORT) */
+#if (1 == ADI_UART_CFG_DMA_MODE_SUPPORT)
+       false,                                           /*!< no tx dma transfer         */
+       0,                                               /*!< tx dma transfer size       */
+#endif /* (1 == ADI_UART_CFG_DMA_MODE_SUPPORT) */
 #if defined(ADI_DEBUG)
        {0}                                              /*!< uart statistics            */
 #endif /* defined(ADI_DEBUG) */
    }
 };
 
+#if (1 == ADI_UART_CFG_DMA_MODE_SUPPORT)
+/*!----------------------------------------------------------------------------
+ *   UART transmit DMA descriptor
+ *----------------------------------------------------------------------------*/
+static ADI_DMA_TRANSFER_TYPE gDmaDescriptorForUARTTx;
+#endif /* (1 == ADI_UART_CFG_DMA_MODE_SUPPORT) */
+
 /*!----------------------------------------------------------------------------
   UART Driver internal macros
 *----------------------------------------------------------------------------*/
@@ -235,6 +267,13 @@ static void UART_RX_Status_Handler(ADI_UART_HANDLE hDevice, const uint8_t uLineS
 ADI_INT_HANDLER(UART_Int_Handler);
 #endif
 
+#if (1 == ADI_UART_CFG_DMA_MODE_SUPPORT)
+/* starts a dma transfer of the pending transmit buffer contents */
+static void StartTxDma(ADI_UART_HANDLE const hDevice);
+
+ADI_INT_HANDLER(DMA_UART_TX_Int_Handler);
+#endif
+
 
 /*!----------------------------------------------------------------------------
    UART internal functions
@@ -339,6 +378,13 @@ ADI_INT_HANDLER(UART_Int_Handler)
             {
                 ADI_UART_STAT_INC(hDevice->Stats.RxDroppedByteCnt);
 
+#if (1 == ADI_UART_CFG_RX_OVERFLOW_DROP)
+                /* drop the byte: the reader finds out from adi_UART_GetNumRxDropped() */
+                data = pUART_Regs->COMRX;
+                hDevice->RxDroppedCount++;
+                break;
+#else /* (0 == ADI_UART_CFG_RX_OVERFLOW_DROP) */
+
                /* trap receive buffer overflow condition. This condition occurs when
                 * internal driver buffer is full and more data is received.
                 *
@@ -347,6 +393,7 @@ ADI_INT_HANDLER(UART_Int_Handler)
                 * depending on the application requirements.
                 */
                 while(1); /* internal driver buffer overflow */
+#endif /* (0 == ADI_UART_CFG_RX_OVERFLOW_DROP) */
             }
 
             /* adjust the write index if reaches the end */
@@ -409,6 +456,94 @@ ADI_INT_HANDLER(UART_Int_Handler)
 }
 #endif /* (1 == ADI_UART_CFG_INTERRUPT_MODE_SUPPORT) */
 
+#if (1 == ADI_UART_CFG_DMA_MODE_SUPPORT)
+/*!
+* @brief            Starts a transmit DMA transfer
+*
+* @param[in]  hDevice   Handle to the device which is returned through adi_UART_Init()
+*
+* @return           none
+*
+* @details          Transfers the contiguous part of the pending transmit buffer data,
+*                   i.e. up to the end of the buffer. Data that wrapped around to the
+*                   start of the buffer is sent by the next transfer, started from the
+*                   DMA done interrupt. Must be called with the tx dma interrupt masked.
+*/
+static void StartTxDma(ADI_UART_HANDLE const hDevice)
+{
+    ADI_UART_CIRC_BUFFER_TYPE *pBuf = &hDevice->TxBuffer;
+    ADI_DMA_TRANSFER_TYPE     *pD   = &gDmaDescriptorForUARTTx;
+    uint16_t Pending = pBuf->BufSize - pBuf->NumAvailable;
+    uint16_t Count;
+
+    if( pBuf->RdIndx >= pBuf->BufSize )
+        pBuf->RdIndx = 0;
+
+    Count = pBuf->BufSize - pBuf->RdIndx;
+    if( Count > Pending )
+        Count = Pending;
+    if( Count > ADI_DMA_MAX_TRANSFER_SIZE )
+        Count = ADI_DMA_MAX_TRANSFER_SIZE;
+
+    if( Count == 0 )
+    {
+        /* nothing left to send, stop the dma requests */
+        hDevice->bTxDmaActive = false;
+        hDevice->pUartRegs->COMIEN &= ~(COMIEN_EDMAT);
+        return;
+    }
+
+    pD->pSrcData   = &pBuf->Buffer[pBuf->RdIndx];
+    pD->DataLength = Count;
+
+    hDevice->TxDmaCount   = Count;
+    hDevice->bTxDmaActive = true;
+
+    adi_DMA_SubmitTransfer(pD);
+
+    /* enable DMA done interrupt, then the uart dma requests */
+    ADI_ENABLE_INT(DMA_UART_TX_IRQn);
+    hDevice->pUartRegs->COMIEN |= COMIEN_EDMAT;
+}
+
+
+/*!
+* @brief            UART transmit DMA done interrupt handler
+*
+* @return           none
+*
+* @details          Releases the transmitted bytes to the transmit buffer and chains
+*                   the next transfer if more data was queued in the meantime.
+*/
+ADI_INT_HANDLER(DMA_UART_TX_Int_Handler)
+{
+    ADI_UART_HANDLE            hDevice = &UART_DevData[ADI_UART_DEVID_0];
+    ADI_UART_CIRC_BUFFER_TYPE *pBuf    = &hDevice->TxBuffer;
+
+    /* Disable DMA done interrupt, re-enabled by the next transfer */
+    ADI_DISABLE_INT(DMA_UART_TX_IRQn);
+
+    ADI_UART_STAT_INC(hDevice->Stats.TxDmaIrqCnt);
+
+    pBuf->RdIndx += hDevice->TxDmaCount;
+    if( pBuf->RdIndx >= pBuf->BufSize )
+        pBuf->RdIndx = 0;
+
+    ADI_DISABLE_INT(hDevice->UARTIRQn);
+    pBuf->NumAvailable += hDevice->TxDmaCount;
+    ADI_ENABLE_INT(hDevice->UARTIRQn);
+
+    StartTxDma(hDevice);
+
+#if (1 == ADI_CFG_ENABLE_RTOS_SUPPORT)
+    adi_osal_SemPost(hDevice->hSem);
+#else /* (0 == ADI_CFG_ENABLE_RTOS_SUPPORT) */
+    /* Blocking writes may be waiting for space in the transmit buffer */
+    SystemExitLowPowerMode(&hDevice->bInterruptFlag);
+#endif  /* (0 == ADI_CFG_ENABLE_RTOS_SUPPORT) */
+}
+#endif /* (1 == ADI_UART_CFG_DMA_MODE_SUPPORT) */
+
 /*!
 * @brief            Reads data to user buffer
 *
@@ -532,13 +667,34 @@ static ADI_UART_RESULT_TYPE do_write(ADI_UART_HANDLE const hDevice, uint8_t *pTx
                pBuf->Buffer[pBuf->WrIndx++] = *pTxData++;
         }
 
-        /* atomically adjust the NumAvailable */
-        ADI_DISABLE_INT(hDevice->UARTIRQn);
-        pBuf->NumAvailable -= Size;
+#if (1 == ADI_UART_CFG_DMA_MODE_SUPPORT)
+        if(IS_DMA_MODE(hDevice))
+        {
+            /* atomically adjust the NumAvailable and kick the dma if it is idle */
+            ADI_ENTER_CRITICAL_REGION();
+            pBuf->NumAvailable -= Size;
 
-        /* and enable tx empty interrupt */
-        hDevice->pUartRegs->COMIEN |= COMIEN_ETBEI;
-        ADI_ENABLE_INT(hDevice->UARTIRQn);
+            if(!hDevice->bTxDmaActive)
+                StartTxDma(hDevice);
+            ADI_EXIT_CRITICAL_REGION();
+        }
+        else
+#endif /* (1 == ADI_UART_CFG_DMA_MODE_SUPPORT) */
+        {
+            /* atomically adjust the NumAvailable */
+            ADI_DISABLE_INT(hDevice->UARTIRQn);
+            pBuf->NumAvailable -= Size;
+
+            /* and enable tx empty interrupt */
+            hDevice->pUartRegs->COMIEN |= COMIEN_ETBEI;
+            ADI_ENABLE_INT(hDevice->UARTIRQn);
+        }
+
+#if defined(ADI_DEBUG)
+        /* track the transmit buffer high-water mark to help size it */
+        if( (pBuf->BufSize - pBuf->NumAvailable) > hDevice->Stats.TxBufferMaxUsed )
+            hDevice->Stats.TxBufferMaxUsed = pBuf->BufSize - pBuf->NumAvailable;
+#endif /* defined(ADI_DEBUG) */
     }
 #endif /* (1 == ADI_UART_CFG_INTERRUPT_MODE_SUPPORT) */
 
@@ -628,6 +784,21 @@ static ADI_UART_RESULT_TYPE ProcessRequest(ADI_UART_HANDLE const hDevice,
            /* Adjust transfer size */
            int16_t BytesAvailable = pCircBuffer->NumAvailable;
 
+#if defined(ADI_DEBUG)
+           /* transmit data that does not fit in the buffer is dropped */
+           if( !bIsRxBuffer && (*pSize > BytesAvailable) )
+           {
+               ADI_UART_STAT_INC(hDevice->Stats.TxOverflowCnt);
+               hDevice->Stats.TxDroppedByteCnt += (uint32_t)(*pSize - BytesAvailable);
+           }
+#endif /* defined(ADI_DEBUG) */
+
+           /* counted in any build: the writer finds out from adi_UART_GetNumTxDropped() */
+           if( !bIsRxBuffer && (*pSize > BytesAvailable) )
+           {
+               hDevice->TxDroppedCount += (uint16_t)(*pSize - BytesAvailable);
+           }
+
            *pSize = (*pSize > BytesAvailable) ? BytesAvailable : *pSize;
             result = ADI_UART_SUCCESS;
         }
@@ -790,6 +961,9 @@ ADI_UART_RESULT_TYPE adi_UART_Init(const ADI_UART_DEV_ID_TYPE devID, ADI_UART_HA
         hDevice->TxBuffer.Buffer     = pInitData->pTxBufferData;
         hDevice->TxBuffer.BufSize    = pInitData->TxBufferSize;
 
+        hDevice->RxDroppedCount      = 0u;
+        hDevice->TxDroppedCount      = 0u;
+
         /* enable interrupt mode if internal buffering is enabled */
         hDevice->bInterruptMode = true;
         ADI_INSTALL_HANDLER(hDevice->UARTIRQn, UART_Int_Handler);
@@ -853,6 +1027,11 @@ ADI_UART_RESULT_TYPE adi_UART_UnInit(ADI_UART_HANDLE const hDevice)
         return ADI_UART_ERR_NOT_INITIALIZED;
 #endif /* defined(ADI_DEBUG) */
 
+#if (1 == ADI_UART_CFG_DMA_MODE_SUPPORT)
+    if(IS_DMA_MODE(hDevice))
+        adi_UART_SetDmaMode(hDevice, false);
+#endif /* (1 == ADI_UART_CFG_DMA_MODE_SUPPORT) */
+
 #if (1 == ADI_UART_CFG_INTERRUPT_MODE_SUPPORT)
     ADI_UNINSTALL_HANDLER(hDevice->UARTIRQn);  /* uninstall handler */
     ADI_DISABLE_INT(hDevice->UARTIRQn);        /* disable uart interrupt */
@@ -1167,6 +1346,11 @@ ADI_UART_RESULT_TYPE adi_UART_BufFlush(ADI_UART_HANDLE const hDevice)
     if( UART_RX_FULL(hDevice) )
         hDevice->pUartRegs->COMRX;
 
+#if (1 == ADI_UART_CFG_DMA_MODE_SUPPORT)
+    /* let the dma drain the transmit buffer before resetting it */
+    while (( !(hDevice->pUartRegs->COMCON & COMCON_DISABLE)) && hDevice->bTxDmaActive);
+#endif /* (1 == ADI_UART_CFG_DMA_MODE_SUPPORT) */
+
     /* wait until transmit empty bit set
      * if UART is not enabled then TEMT will never be set which will block
      * this API infinitely so only check Tx FIFO only if UART is enabled.
@@ -1180,6 +1364,50 @@ ADI_UART_RESULT_TYPE adi_UART_BufFlush(ADI_UART_HANDLE const hDevice)
 }
 
 
+/*!
+* @brief                 Wait for the pending transmit data to be sent
+*
+* @param[in]  hDevice    Handle to the device which is returned through adi_UART_Init()
+*
+* @return     Status
+*                        - #ADI_UART_SUCCESS                  upon success
+*                        - #ADI_UART_ERR_INVALID_INSTANCE [D] if invalid instance handle is passed
+*                        - #ADI_UART_ERR_NOT_INITIALIZED  [D] if driver is not initialized
+* @details
+*                        Waits until the transmit buffer is drained, by the interrupt handler or by the
+*                        dma, and the transmitter is empty. Unlike adi_UART_BufFlush, the received data
+*                        is kept.
+*
+* @sa                    adi_UART_BufFlush
+*/
+ADI_UART_RESULT_TYPE adi_UART_TxFlush(ADI_UART_HANDLE const hDevice)
+{
+#if defined(ADI_DEBUG)
+    /* check the instance */
+    if( hDevice != &UART_DevData[ADI_UART_DEVID_0] )
+        return(ADI_UART_ERR_INVALID_INSTANCE);
+
+    if( hDevice->DrvState != ADI_UART_DRV_STATE_INITIALIZED )
+        return ADI_UART_ERR_NOT_INITIALIZED;
+#endif /* defined(ADI_DEBUG) */
+
+#if (1 == ADI_UART_CFG_INTERRUPT_MODE_SUPPORT)
+    /* the interrupt handler or the dma releases the sent bytes */
+    if( IS_INTERRUPT_MODE(hDevice) )
+    {
+        while (( !(hDevice->pUartRegs->COMCON & COMCON_DISABLE)) &&
+               ( hDevice->TxBuffer.NumAvailable != hDevice->TxBuffer.BufSize ));
+    }
+#endif /* (1 == ADI_UART_CFG_INTERRUPT_MODE_SUPPORT) */
+
+    /* wait until transmit empty bit set, only if the UART is enabled */
+    while (( !(hDevice->pUartRegs->COMCON & COMCON_DISABLE)) &&
+           ( !(hDevice->pUartRegs->COMLSR & COMLSR_TEMT) ));
+
+    return(ADI_UART_SUCCESS);
+}
+
+
 /*!
 * @brief                 Set Baud Rate
 *
@@ -1389,6 +1617,8 @@ ADI_UART_RESULT_TYPE adi_UART_SetGenericSettings( ADI_UART_HANDLE const hDevice,
 
     adi_UART_SetInterruptMode(hDevice,pSettings->bInterruptMode);
 
+    Result = adi_UART_SetDmaMode(hDevice,pSettings->bDmaMode);
+
     return(Result);
 }
 
@@ -1776,12 +2006,26 @@ ADI_UART_WLS_TYPE adi_UART_GetWordLength(const ADI_UART_HANDLE hDevice)
 * @return     Status
 *                        - #ADI_UART_SUCCESS                  upon success
 *                        - #ADI_UART_ERR_INVALID_INSTANCE [D] if invalid instance handle is passed
+*                        - #ADI_UART_ERR_INVALID_BUFFER   [D] if buffers are not supplied in #adi_UART_Init
+*                        - #ADI_UART_ERR_NOT_SUPPORTED        if dma mode is not enabled in the configuration
+*                        - #ADI_UART_ERR_UNKNOWN              if the dma channel could not be initialized
 *
 * @details
-*                        Enables DMA with in the driver
+*                        Enables DMA with in the driver. DMA is used for transmit only: the transmit
+*                        buffer supplied to adi_UART_Init becomes a ring that adi_UART_BufTx fills and
+*                        the DMA drains in the background, one contiguous chunk per transfer. Receive
+*                        keeps using the interrupt mode.
+*
+*                        Combined with the non-blocking mode, adi_UART_BufTx never waits: data that does
+*                        not fit in the ring is dropped and accounted for in the TxOverflowCnt and
+*                        TxDroppedByteCnt statistics.
+*
+* @note                  Applications has to disable UART before changing the dma mode and re-enable
+*                        it after changing.
 *
 * @sa                    adi_UART_GetDmaMode
 * @sa                    adi_UART_Enable
+* @sa                    adi_UART_GetStatistics
 */
 ADI_UART_RESULT_TYPE adi_UART_SetDmaMode(ADI_UART_HANDLE const hDevice, const bool_t bFlag)
 {
@@ -1791,8 +2035,55 @@ ADI_UART_RESULT_TYPE adi_UART_SetDmaMode(ADI_UART_HANDLE const hDevice, const bo
         return(ADI_UART_ERR_INVALID_INSTANCE);
 #endif /* defined(ADI_DEBUG) */
 
+#if (1 == ADI_UART_CFG_DMA_MODE_SUPPORT)
+    ADI_DMA_TRANSFER_TYPE *pD = &gDmaDescriptorForUARTTx;
+
+    if( bFlag == hDevice->bDMAMode )
+        return(ADI_UART_SUCCESS);
+
+    if(bFlag)
+    {
+#if defined(ADI_DEBUG)
+        /* the transmit buffer is used as the dma ring */
+        if( hDevice->TxBuffer.Buffer == NULL )
+            return(ADI_UART_ERR_INVALID_BUFFER);
+#endif /* defined(ADI_DEBUG) */
+
+        /* static part of the transmit descriptor (BUFFER ==> COMTX) */
+        pD->Chan       = UART_TX_CHANn;
+        pD->CCD        = ADI_DMA_CCD_PRIMARY;
+        pD->DataWidth  = ADI_DMA_WIDTH_BYTE;
+        pD->SrcInc     = ADI_DMA_INCR_BYTE;
+        pD->pDstData   = (void*) &hDevice->pUartRegs->COMTX;
+        pD->DstInc     = ADI_DMA_INCR_NONE;
+        pD->Protection = ADI_DMA_HPROT_NONE;
+        pD->ArbitRate  = ADI_DMA_RPOWER_1;
+        pD->Mode       = ADI_DMA_MODE_BASIC;
+
+        if (ADI_DMA_SUCCESS != adi_DMA_Init(UART_TX_CHANn, ADI_DMA_PRIORITY_RESET))
+            return(ADI_UART_ERR_UNKNOWN);
+
+        hDevice->bTxDmaActive = false;
+        ADI_INSTALL_HANDLER(DMA_UART_TX_IRQn, DMA_UART_TX_Int_Handler);
+    }
+    else
+    {
+        ADI_DISABLE_INT(DMA_UART_TX_IRQn);
+        hDevice->pUartRegs->COMIEN &= ~(COMIEN_EDMAT);
+        ADI_UNINSTALL_HANDLER(DMA_UART_TX_IRQn);
+
+        adi_DMA_UnInit(UART_TX_CHANn);
+        hDevice->bTxDmaActive = false;
+    }
+
+    hDevice->bDMAMode = bFlag;
+
+    return(ADI_UART_SUCCESS);
+#else /* (0 == ADI_UART_CFG_DMA_MODE_SUPPORT) */
+
     /* dma is not supported */
-    return(ADI_UART_ERR_NOT_SUPPORTED);
+    return(bFlag ? ADI_UART_ERR_NOT_SUPPORTED : ADI_UART_SUCCESS);
+#endif /* (0 == ADI_UART_CFG_DMA_MODE_SUPPORT) */
 }
 
 
@@ -2108,6 +2399,55 @@ uint16_t adi_UART_GetNumRxBytes(const ADI_UART_HANDLE hDevice)
 }
 
 
+/*!
+* @brief                 Returns the number of bytes dropped by the receiver
+*
+* @param[in]  hDevice    Handle to the device which is returned through adi_UART_Init()
+*
+* @return                Bytes received while the rx buffer was full, since adi_UART_Init(),
+*                        modulo 2^16
+*
+* @details               With ADI_UART_CFG_RX_OVERFLOW_DROP set, the interrupt handler drops
+*                        the bytes that do not fit in the rx buffer instead of trapping. The
+*                        reader can tell a gap in the received data from a change of this count.
+*
+* @sa                    adi_UART_GetNumRxBytes
+*/
+uint16_t adi_UART_GetNumRxDropped(const ADI_UART_HANDLE hDevice)
+{
+#if (1 == ADI_UART_CFG_INTERRUPT_MODE_SUPPORT)
+    return(hDevice->RxDroppedCount);
+#else /* (0 == ADI_UART_CFG_INTERRUPT_MODE_SUPPORT) */
+    return(0u);
+#endif /* (0 == ADI_UART_CFG_INTERRUPT_MODE_SUPPORT) */
+}
+
+
+/*!
+* @brief                 Returns the number of bytes dropped by the transmitter
+*
+* @param[in]  hDevice    Handle to the device which is returned through adi_UART_Init()
+*
+* @return                Bytes of non-blocking adi_UART_BufTx() calls that did not fit in the
+*                        tx buffer, since adi_UART_Init(), modulo 2^16
+*
+* @details               A non-blocking write is cut to the free space of the tx buffer. The
+*                        debug statistics count the truncated writes too, this count is kept
+*                        in any build so the writer can tell that output was lost.
+*
+* @sa                    adi_UART_GetNumTxBytes
+* @sa                    adi_UART_GetNumRxDropped
+*/
+uint16_t adi_UART_GetNumTxDropped(const ADI_UART_HANDLE hDevice)
+{
+#if (1 == ADI_UART_CFG_INTERRUPT_MODE_SUPPORT)
+    return(hDevice->TxDroppedCount);
+#else /* (0 == ADI_UART_CFG_INTERRUPT_MODE_SUPPORT) */
+    return(0u);
+#endif /* (0 == ADI_UART_CFG_INTERRUPT_MODE_SUPPORT) */
+}
+
+
 /*!
 * @brief                 Returns number of bytes that can be transmitted
 *
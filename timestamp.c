@@ -0,0 +1,88 @@
+/*!
+ *****************************************************************************
+ * @file:   timestamp.c
+ * @brief:  Free running microsecond tick for timestamping measurement records
+ *
+ * The overflow count is only written by the timer interrupt; timestamp_Now()
+ * reads it around the timer count and reads again when an overflow came in
+ * between, as the metrics captures do. An overflow whose interrupt is still
+ * pending, with interrupts masked or from a higher priority handler, is
+ * taken from the timeout flag.
+ *****************************************************************************/
+
+#include <stddef.h>
+
+#include "timestamp.h"
+
+static ADI_GPT_HANDLE       hTimestampTimer = NULL;
+/* Overflows of the 16-bit count, the upper 16 bits of the tick */
+static volatile uint32_t    timestampOverflows;
+
+static void                 timestamp_Callback      (void *pCBParam, uint32_t nEvent, void *pArg);
+
+/* Timer interrupt: the count wrapped */
+static void timestamp_Callback(void *pCBParam, uint32_t nEvent, void *pArg) {
+    if (ADI_GPT_EVENT_TIMEOUT == nEvent) {
+        timestampOverflows++;
+    }
+}
+
+/*!
+ * @brief       Start the tick.
+ *
+ * @return      true when GP timer 1 runs, false if it could not be set up.
+ *
+ * @details     The tick starts at 0 and runs until the next reset.
+ */
+bool_t timestamp_Init(void) {
+    timestampOverflows = 0;
+
+    if ((ADI_GPT_SUCCESS != adi_GPT_Init(ADI_GPT_DEVID_1, &hTimestampTimer)) ||
+        (ADI_GPT_SUCCESS != adi_GPT_SetClockSelect(hTimestampTimer, ADI_GPT_CLOCK_SELECT_HFOSC)) ||
+        (ADI_GPT_SUCCESS != adi_GPT_SetCountMode(hTimestampTimer, ADI_GPT_COUNT_UP)) ||
+        (ADI_GPT_SUCCESS != adi_GPT_SetPeriodicMode(hTimestampTimer, false, 0)) ||
+        (ADI_GPT_SUCCESS != adi_GPT_SetLdVal(hTimestampTimer, 0)) ||
+        (ADI_GPT_SUCCESS != adi_GPT_SetPrescaler(hTimestampTimer, ADI_GPT_PRESCALER_16)) ||
+        (ADI_GPT_SUCCESS != adi_GPT_RegisterCallback(hTimestampTimer, timestamp_Callback, NULL)) ||
+        (ADI_GPT_SUCCESS != adi_GPT_SetTimerEnable(hTimestampTimer, true))) {
+        hTimestampTimer = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+/*!
+ * @brief       Read the tick.
+ *
+ * @return      Microseconds since timestamp_Init(), modulo 2^32, or 0 if the
+ *              timer is not running.
+ *
+ * @details     Can also be called with interrupts masked and from interrupt
+ *              handlers.
+ */
+uint32_t timestamp_Now(void) {
+    uint32_t                overflows;
+    uint32_t                pending;
+    uint16_t                count;
+
+    if (NULL == hTimestampTimer) {
+        return 0;
+    }
+    do {
+        overflows = timestampOverflows;
+        adi_GPT_GetTxVal(hTimestampTimer, &count);
+        pending   = 0;
+        /* Wrapped, not counted yet: the count read again is past the wrap */
+        if (adi_GPT_GetTimeOutEventStatus(hTimestampTimer)) {
+            adi_GPT_GetTxVal(hTimestampTimer, &count);
+            pending = 1;
+        }
+    } while (overflows != timestampOverflows);
+
+    return ((overflows + pending) << 16) | count;
+}
+
+/*
+** EOF
+*/
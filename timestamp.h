@@ -0,0 +1,46 @@
+/*!
+ *****************************************************************************
+ * @file:   timestamp.h
+ * @brief:  Free running microsecond tick for timestamping measurement records
+ *
+ * GP timer 1 counts the HFOSC divided by 16, 1 MHz, free running over its
+ * 16 bits, and its timeout interrupt counts the overflows, once every
+ * 65.536 ms. timestamp_Now() cascades the two into a 32-bit tick, which
+ * wraps after 71.6 minutes; hosts unwrap it (tools/EITStream).
+ *
+ * The RTC count would keep running through a reset, but its 32.768 kHz
+ * clock gives 30.5 us at best and its count is read through the slow clock
+ * domain, while the sequencer and the measurements run from the HFOSC, so
+ * the ticks and the sequencer cycles of seq_builder.h are the same clock.
+ *
+ * GP timer 0 is left to the metrics captures of bench.c and adg732.c.
+ *****************************************************************************/
+
+#ifndef __TIMESTAMP_H__
+#define __TIMESTAMP_H__
+
+#include <stdint.h>
+
+#include "gpt.h"
+
+/* C++ linkage */
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#define TIMESTAMP_TICK_HZ           (1000000u)
+/* HFOSC, and sequencer, cycles per tick */
+#define TIMESTAMP_CYCLES_PER_TICK   (16u)
+
+bool_t                      timestamp_Init          (void);
+uint32_t                    timestamp_Now           (void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __TIMESTAMP_H__ */
+
+/*
+** EOF
+*/
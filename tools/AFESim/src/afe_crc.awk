@@ -0,0 +1,10 @@
+# Cuts the sequencer CRC8 out of src/afe.c for src/afe_crc.c: the CRC8
+# polynomial, the crc8() variants of ADI_AFE_CFG_SEQ_CRC_TABLE,
+# sequenceCRC() and adi_AFE_CalculateSequenceCRC(), as they are.
+
+/^#define ADI_AFE_SEQ_CRC8_POLYNOMIAL/        { print }
+/^#if \(ADI_AFE_CFG_SEQ_CRC_TABLE == 2\)/   { copy = 1 }
+/^uint8_t adi_AFE_CalculateSequenceCRC\(/   { copy = 1; last = 1 }
+/^static uint8_t sequenceCRC\(/             { last = 1 }
+copy                                        { print }
+copy && last && /^}/                        { copy = 0; last = 0; print "" }
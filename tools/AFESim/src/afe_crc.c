@@ -0,0 +1,22 @@
+/*!
+ *****************************************************************************
+ * @file:   afe_crc.c
+ * @brief:  Sequencer CRC8 of the AFE driver for the host checks
+ *
+ * obj/afe_crc.inc is cut out of src/afe.c by src/afe_crc.awk, so the checks
+ * run the CRC of the driver itself rather than the one of afesim_afe.c.
+ * Built with the ADI_AFE_CFG_SEQ_CRC_TABLE of adi_afe_config.h unless it is
+ * set on the command line.
+ *****************************************************************************/
+
+#include <stdint.h>
+
+#ifndef ADI_AFE_CFG_SEQ_CRC_TABLE
+#include "adi_afe_config.h"
+#endif
+
+#include "afe_crc.inc"
+
+/*
+** EOF
+*/
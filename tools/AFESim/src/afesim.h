@@ -0,0 +1,112 @@
+/*!
+ *****************************************************************************
+ * @file:   afesim.h
+ * @brief:  Host simulation of the ADuCM350 AFE, sequencer and board drivers
+ *
+ * The firmware sources are built unchanged for the host and linked against
+ * these modules instead of the ADI drivers. Simulated time is counted in
+ * ACLK cycles (16 MHz): it advances when the firmware waits for the
+ * sequencer, for the UART transmit buffer to drain or for a USB transfer
+ * to complete. CPU time is not
+ * modelled, code between two waits takes no simulated time.
+ *****************************************************************************/
+
+#ifndef __AFESIM_H__
+#define __AFESIM_H__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <complex.h>
+
+/* C++ linkage */
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Simulated clock, the sequencer ACLK */
+#define AFESIM_CLOCK_HZ             (16000000u)
+/* Electrodes, node i of the network is on multiplexer channel i */
+#define AFESIM_ELECTRODES           (32u)
+/* Network nodes, electrodes first */
+#define AFESIM_MAX_NODES            (64u)
+/* Network branches */
+#define AFESIM_MAX_EDGES            (256u)
+/* Scheduled UART receive bytes */
+#define AFESIM_MAX_KEYS             (1024u)
+
+/* Simulation settings, from the command line */
+typedef struct {
+    double                  timeLimit;      /*!< Simulated seconds before exiting, 0 for none     */
+    uint32_t                seqLimit;       /*!< Sequences before exiting, 0 for none             */
+    uint64_t                seed;           /*!< Noise generator seed                             */
+    double                  noise;          /*!< DFT noise in codes rms, for a 1 ms DFT window    */
+    int32_t                 temperature;    /*!< Die temperature in degrees C                     */
+    FILE                   *pOutput;        /*!< UART transmit sink                               */
+    FILE                   *pUsbOutput;     /*!< USB bulk IN sink, NULL for no host               */
+    const char             *pFlashImage;    /*!< General purpose flash image, NULL for none       */
+} AFESIM_CONFIG;
+
+/* Simulation statistics, reported at exit */
+typedef struct {
+    uint64_t                now;            /*!< Simulated time in ACLK cycles                    */
+    uint64_t                seqCycles;      /*!< Time spent waiting for the sequencer             */
+    uint64_t                uartCycles;     /*!< Time spent waiting for the UART to drain         */
+    uint32_t                sequences;      /*!< Sequences run by the firmware                    */
+    uint32_t                calSequences;   /*!< Sequences run by the calibration library         */
+    uint32_t                dfts;           /*!< DFT results produced                             */
+    uint32_t                crcErrors;      /*!< Sequences failing adi_AFE_SeqCheck()             */
+    uint32_t                resultMismatches; /*!< Sequences producing more results than read   */
+    uint32_t                muxWrites;      /*!< GPIO writes changing a multiplexer address       */
+    uint32_t                muxWritesBusy;  /*!< ... while the sequencer was running              */
+    uint32_t                muxWritesLive;  /*!< ... with the excitation or the DFT running       */
+    uint64_t                txBytes;        /*!< UART bytes queued                                */
+    uint64_t                txDropped;      /*!< UART bytes dropped on a full transmit buffer     */
+    uint32_t                txOverflows;    /*!< Truncated transmit requests                      */
+    uint32_t                rxDropped;      /*!< UART bytes received into a full receive buffer   */
+    uint64_t                usbCycles;      /*!< Time spent sleeping for a USB transfer           */
+    uint64_t                usbBytes;       /*!< USB bulk IN bytes                                */
+    uint32_t                usbTransfers;   /*!< USB bulk IN transfers                            */
+} AFESIM_STATS;
+
+extern AFESIM_CONFIG        afesimConfig;
+extern AFESIM_STATS         afesimStats;
+
+/* afesim_main.c */
+void                        afesim_Advance          (uint64_t cycles);
+void                        afesim_WaitUntil        (uint64_t time, uint64_t *pWaitCycles);
+void                        afesim_Exit             (void);
+void                        afesim_Fatal            (const char *pFormat, ...);
+void                        afesim_Wfi              (void);
+
+/* afesim_afe.c */
+int                         afesim_SeqBusy          (void);
+int                         afesim_SeqLive          (void);
+
+/* afesim_network.c */
+int                         afesim_NetworkLoad      (const char *pPath);
+double complex              afesim_NetworkTransfer  (uint32_t a, uint32_t b, uint32_t m, uint32_t n,
+                                                     double freq, double complex *pLoop);
+double                      afesim_NetworkScale     (void);
+double                      afesim_NetworkPhase     (void);
+
+/* afesim_usb.c */
+void                        afesim_UsbService       (void);
+uint64_t                    afesim_UsbEventTime     (void);
+
+/* afesim_board.c */
+void                        afesim_MuxChannels      (uint32_t channels[4]);
+int                         afesim_KeyAdd           (double seconds, const char *pText);
+void                        afesim_UartService      (void);
+int                         afesim_MemoryMap        (void);
+void                        afesim_FlashSave        (void);
+double                      afesim_Gaussian         (void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __AFESIM_H__ */
+
+/*
+** EOF
+*/
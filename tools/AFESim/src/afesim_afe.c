@@ -0,0 +1,734 @@
+/*!
+ *****************************************************************************
+ * @file:   afesim_afe.c
+ * @brief:  Simulated AFE driver and calibration library (afe.c, afe_lib.c)
+ *
+ * A sequence is decoded command by command into a private copy of the AFE
+ * registers: MMR writes update the registers, waits advance the sequence
+ * time, and a DFT result is produced each time DFT_EN is cleared. The
+ * result is computed from the switch matrix, ADC mux, waveform generator
+ * and calibration registers at that point, the multiplexer channels and
+ * the impedance network.
+ *
+ * adi_AFE_RunSequence() checks and times the whole sequence, its commands
+ * then run as simulated time passes: up to the end of the sequence when
+ * the firmware waits for it (adi_AFE_GetSeqFinished(), adi_AFE_SeqStop()),
+ * up to the next Rx DMA interrupt when it polls adi_AFE_GetSeqError(). The
+ * Rx DMA callback is called at the command completing a DMA cycle, so GPIO
+ * writes made by the callback are seen by the DFTs that follow. A write of
+ * CUSTOM_INT to AFE_ANALOG_GEN_INT calls the generate callback the same way
+ * when the custom interrupt is enabled.
+ *
+ * DMA cycles follow the dual buffer mode of afe.c: the first cycle fills
+ * the start of the buffer, the next ones alternate between the two halves
+ * set by adi_AFE_SetDmaRxBufferMaxSize().
+ *****************************************************************************/
+
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "afe.h"
+#include "afe_lib.h"
+#include "afe_sequences.h"
+
+#include "afesim.h"
+
+/* Sequencer command fields */
+#define SEQ_CMD_WRITE               (0x80000000u)
+#define SEQ_CMD_TIMEOUT             (0x40000000u)
+#define SEQ_CMD_WAIT_MASK           (0x3FFFFFFFu)
+#define SEQ_CMD_DATA_MASK           (0x01FFFFFFu)
+#define SEQ_CMD_OFFSET(cmd)         (((cmd) >> 23) & 0xFCu)
+
+/* Registers decoded by the simulation, offsets in the AFE block */
+#define AFE_CFG                     (0x00u)
+#define AFE_SEQ_CFG                 (0x04u)
+#define AFE_SW_CFG                  (0x0Cu)
+#define AFE_DAC_CFG                 (0x10u)
+#define AFE_WG_FCW                  (0x30u)
+#define AFE_WG_AMPLITUDE            (0x3Cu)
+#define AFE_ADC_CFG                 (0x40u)
+#define AFE_REG_COUNT               (0x80u / 4u)
+#define AFE_ANALOG_GEN_INT          (0xA4u)
+
+#define AFE_CFG_DFT_EN              (0x8000u)
+#define AFE_CFG_WAVEGEN_EN          (0x4000u)
+#define AFE_SEQ_CFG_SEQ_EN          (0x0001u)
+#define AFE_DAC_CFG_ATTEN_EN        (0x0001u)
+#define AFE_ADC_MUX_SEL_MASK        (0x001Fu)
+#define AFE_ADC_MUX_SEL_TIA         (0x0002u)
+#define AFE_ADC_MUX_SEL_AN_A        (0x0008u)
+#define AFE_GEN_INT_CUSTOM          (0x0008u)
+
+/* Switch matrix: excitation on AFE8 (M3, A+) returning into the TIA on AFE7 (M1, A-) */
+#define AFE_SW_DMUX(sw)             ((sw) & 0xFu)
+#define AFE_SW_TMUX(sw)             (((sw) >> 12) & 0xFu)
+#define AFE_SW_EXCITE_PIN           (8u)
+#define AFE_SW_TIA_PIN              (7u)
+/* Switch matrix: excitation through RCAL */
+#define AFE_SW_RCAL_DMUX            (1u)
+#define AFE_SW_RCAL_TMUX            (8u)
+
+/* Calibration registers, from ADI_AFE_CAL_REG_ADC_GAIN_TIA */
+#define AFE_CAL_BASE                (0x40080100u)
+#define AFE_CAL_COUNT               (32u)
+#define AFE_CAL_INDEX(reg)          (((uint32_t)(reg) - AFE_CAL_BASE) / 4u)
+/* Unity ADC gain code */
+#define AFE_CAL_GAIN_UNITY          (0x4000u)
+/* Temperature sensor channel gain, also copied into the TIA channel */
+#define AFE_CAL_GAIN_TEMP_SENS      (0x6000u)
+
+/* Waveform generator: DAC LSB in mV, attenuator ratio */
+#define AFE_DAC_LSB_MV              (0.39072)
+#define AFE_DAC_ATTEN               (40.0)
+/* Instrumentation amplifier gain of the AN_A channel */
+#define AFE_INAMP_GAIN              (1.494)
+/* DFT window the noise setting is given for, 1 ms */
+#define AFE_NOISE_WINDOW            (16000.0)
+
+/* Simulated AFE device */
+struct ADI_AFE_DEV_DATA_TYPE {
+    bool_t                  bInitialized;
+    bool_t                  bBlocking;
+    bool_t                  bSoftwareCRC;
+    ADI_CALLBACK            cbRxDma;
+    ADI_CALLBACK            cbGenerate;
+    uint32_t                cbGenerateWatch;
+    uint32_t                genIen;         /*!< Enabled generate interrupt sources     */
+    uint32_t                rcal;
+    uint32_t                rtia;
+    uint32_t                regs[AFE_REG_COUNT];
+    uint32_t                cal[AFE_CAL_COUNT];
+    ADI_AFE_SEQ_STATE_TYPE  seqState;
+    uint64_t                seqEnd;         /*!< Simulated time the sequence finishes   */
+    bool_t                  bSeqRunning;    /*!< Started and not yet waited for         */
+    uint8_t                 seqCrc;         /*!< CRC computed by the sequencer          */
+    uint16_t                seqCount;       /*!< Commands executed by the sequencer     */
+    bool_t                  bExecuting;     /*!< Commands of the sequence are left      */
+    const uint32_t         *pSeq;           /*!< Running sequence                       */
+    uint32_t                seqNext;        /*!< Index of its next command              */
+    uint32_t                seqLast;        /*!< Index of its last command              */
+    uint64_t                seqStart;       /*!< Simulated time it started              */
+    uint64_t                seqCycles;      /*!< Cycles executed since then             */
+    uint64_t                dftStart;       /*!< seqCycles when the DFT window opened   */
+    uint16_t                dmaMaxSize[2];  /*!< Dual buffer DMA cycle sizes            */
+    uint16_t               *pRxBuffer;      /*!< Rx DMA destination                     */
+    uint32_t                rxRemaining;    /*!< Halfwords not yet transferred          */
+    uint32_t                rxCycleStart;   /*!< Offset of the running DMA cycle        */
+    uint32_t                rxCycleLength;  /*!< Halfwords of the running DMA cycle     */
+    uint32_t                rxCycleCount;   /*!< Halfwords done in the running cycle    */
+    uint32_t                rxCycles;       /*!< DMA cycles completed                   */
+    bool_t                  bRxCycleDone;   /*!< A cycle completed, callback pending    */
+};
+
+static struct ADI_AFE_DEV_DATA_TYPE afeDevice;
+
+static uint8_t              afe_Crc8                (uint8_t crc, uint32_t word);
+static int16_t              afe_Code                (double value);
+static void                 afe_Dft                 (ADI_AFE_DEV_HANDLE hDevice, uint64_t window,
+                                                     int16_t *pReal, int16_t *pImag);
+static ADI_AFE_RESULT_TYPE  afe_Execute             (ADI_AFE_DEV_HANDLE hDevice, const uint32_t *seq,
+                                                     uint16_t *rxBuffer, uint32_t size, bool_t bLibrary);
+static ADI_AFE_RESULT_TYPE  afe_RunLibrary          (ADI_AFE_DEV_HANDLE hDevice, const uint32_t *seq);
+static uint64_t             afe_Step                (ADI_AFE_DEV_HANDLE hDevice, uint64_t until, bool_t bStopAtDma);
+static void                 afe_Wait                (ADI_AFE_DEV_HANDLE hDevice);
+static void                 afe_Poll                (ADI_AFE_DEV_HANDLE hDevice);
+static void                 afe_RxStart             (ADI_AFE_DEV_HANDLE hDevice, uint16_t *rxBuffer, uint32_t size);
+static void                 afe_RxCycle             (ADI_AFE_DEV_HANDLE hDevice);
+static bool_t               afe_RxWrite             (ADI_AFE_DEV_HANDLE hDevice, uint16_t value);
+
+/* Sequencer CRC-8, polynomial x^8 + x^2 + x + 1, bit by bit as the hardware does */
+static uint8_t afe_Crc8(uint8_t crc, uint32_t word) {
+    uint32_t                i;
+
+    for (i = 0; i < 32u; i++) {
+        if ((crc ^ (uint8_t)(word >> 24)) & 0x80u) {
+            crc = (uint8_t)((crc << 1) ^ 0x07u);
+        }
+        else {
+            crc = (uint8_t)(crc << 1);
+        }
+        word <<= 1;
+    }
+
+    return crc;
+}
+
+static int16_t afe_Code(double value) {
+    if (value > 32767.0) {
+        return 32767;
+    }
+    if (value < -32768.0) {
+        return -32768;
+    }
+
+    return (int16_t)lrint(value);
+}
+
+/* DFT of the ADC channel selected at the end of a window */
+static void afe_Dft(ADI_AFE_DEV_HANDLE hDevice, uint64_t window, int16_t *pReal, int16_t *pImag) {
+    uint32_t                sw     = hDevice->regs[AFE_SW_CFG / 4u];
+    uint32_t                muxSel = hDevice->regs[AFE_ADC_CFG / 4u] & AFE_ADC_MUX_SEL_MASK;
+    double complex          current = 0.0;
+    double complex          transfer = 0.0;
+    double complex          loop;
+    double complex          value;
+    double                  freq, vexc, gain, sigma;
+    uint32_t                channels[4];
+
+    freq = (double)(hDevice->regs[AFE_WG_FCW / 4u] & 0xFFFFFFu) * (double)AFESIM_CLOCK_HZ / 67108864.0;
+    vexc = 0.0;
+    if (hDevice->regs[AFE_CFG / 4u] & AFE_CFG_WAVEGEN_EN) {
+        vexc = (double)(hDevice->regs[AFE_WG_AMPLITUDE / 4u] & 0x7FFu) * AFE_DAC_LSB_MV;
+        if (hDevice->regs[AFE_DAC_CFG / 4u] & AFE_DAC_CFG_ATTEN_EN) {
+            vexc /= AFE_DAC_ATTEN;
+        }
+    }
+
+    afesim_MuxChannels(channels);
+    if ((AFE_SW_EXCITE_PIN == AFE_SW_DMUX(sw)) && (AFE_SW_TIA_PIN == AFE_SW_TMUX(sw))) {
+        /* A+ through M3, A- through M1, V+ through M4, V- through M2 */
+        transfer = afesim_NetworkTransfer(channels[2], channels[0], channels[3], channels[1], freq, &loop);
+        current  = vexc / loop;
+    }
+    else if ((AFE_SW_RCAL_DMUX == AFE_SW_DMUX(sw)) && (AFE_SW_RCAL_TMUX == AFE_SW_TMUX(sw))) {
+        current  = vexc / (double)hDevice->rcal;
+    }
+
+    /* Voltages in mV, the channel gain follows the calibration codes */
+    if (AFE_ADC_MUX_SEL_TIA == muxSel) {
+        gain  = (double)hDevice->cal[AFE_CAL_INDEX(ADI_AFE_CAL_REG_ADC_GAIN_TIA)] / AFE_CAL_GAIN_UNITY;
+        value = current * (double)hDevice->rtia * gain;
+    }
+    else if (AFE_ADC_MUX_SEL_AN_A == muxSel) {
+        gain  = (double)hDevice->cal[AFE_CAL_INDEX(ADI_AFE_CAL_REG_ADC_GAIN_AUX)] / AFE_CAL_GAIN_UNITY;
+        value = current * transfer * AFE_INAMP_GAIN * gain;
+    }
+    else {
+        value = 0.0;
+    }
+
+    value *= afesim_NetworkScale() * cexp(I * afesim_NetworkPhase() * M_PI / 180.0);
+    sigma  = afesimConfig.noise * sqrt(AFE_NOISE_WINDOW / (double)((window > 0u) ? window : 1u));
+
+    *pReal = afe_Code(creal(value) + sigma * afesim_Gaussian());
+    *pImag = afe_Code(cimag(value) + sigma * afesim_Gaussian());
+    afesimStats.dfts++;
+}
+
+/* Program the Rx DMA for a sequence */
+static void afe_RxStart(ADI_AFE_DEV_HANDLE hDevice, uint16_t *rxBuffer, uint32_t size) {
+    hDevice->pRxBuffer     = rxBuffer;
+    hDevice->rxRemaining   = size;
+    hDevice->rxCycleStart  = 0;
+    hDevice->rxCycles      = 0;
+    hDevice->bRxCycleDone  = false;
+    afe_RxCycle(hDevice);
+}
+
+/* Start the next DMA cycle, in the half of the buffer the driver would use */
+static void afe_RxCycle(ADI_AFE_DEV_HANDLE hDevice) {
+    uint32_t                half = hDevice->rxCycles & 1u;
+    uint32_t                max  = hDevice->dmaMaxSize[half];
+
+    if ((0u == max) || (0u == hDevice->dmaMaxSize[1])) {
+        /* Single buffer mode */
+        max = hDevice->rxRemaining;
+    }
+
+    hDevice->rxCycleStart  = half ? hDevice->dmaMaxSize[0] : 0u;
+    hDevice->rxCycleLength = (hDevice->rxRemaining < max) ? hDevice->rxRemaining : max;
+    hDevice->rxCycleCount  = 0;
+}
+
+/* DMA one result halfword, true while the transfer expects more */
+static bool_t afe_RxWrite(ADI_AFE_DEV_HANDLE hDevice, uint16_t value) {
+    if (0u == hDevice->rxRemaining) {
+        return false;
+    }
+
+    hDevice->pRxBuffer[hDevice->rxCycleStart + hDevice->rxCycleCount] = value;
+    hDevice->rxCycleCount++;
+    hDevice->rxRemaining--;
+
+    if (hDevice->rxCycleCount == hDevice->rxCycleLength) {
+        hDevice->bRxCycleDone = true;
+    }
+
+    return true;
+}
+
+/*
+ * Check and time a sequence, then start it. The sequencer CRC and command
+ * count are kept for adi_AFE_SeqCheck(), the commands are run by afe_Step()
+ * as simulated time passes.
+ */
+static ADI_AFE_RESULT_TYPE afe_Execute(ADI_AFE_DEV_HANDLE hDevice, const uint32_t *seq,
+                                       uint16_t *rxBuffer, uint32_t size, bool_t bLibrary) {
+    uint32_t                count = (seq[0] & 0xFFFF0000u) >> 16;
+    uint32_t                afeCfg = hDevice->regs[AFE_CFG / 4u];
+    uint32_t                produced = 0;
+    uint64_t                cycles = 0;
+    uint32_t                i, cmd, offset;
+    uint8_t                 crc = 0x01u;
+    bool_t                  bEnded = false;
+
+    /* Dry run: length, CRC and number of DFT results */
+    for (i = 1; (i <= count) && !bEnded; i++) {
+        cmd = seq[i];
+        crc = afe_Crc8(crc, cmd);
+        cycles++;
+
+        if (cmd & SEQ_CMD_WRITE) {
+            offset = SEQ_CMD_OFFSET(cmd);
+            if (AFE_CFG == offset) {
+                if ((afeCfg & AFE_CFG_DFT_EN) && !(cmd & AFE_CFG_DFT_EN)) {
+                    produced += 2u;
+                }
+                afeCfg = cmd & SEQ_CMD_DATA_MASK;
+            }
+            else if ((AFE_SEQ_CFG == offset) && !(cmd & AFE_SEQ_CFG_SEQ_EN)) {
+                bEnded = true;
+            }
+        }
+        else if (!(cmd & SEQ_CMD_TIMEOUT)) {
+            cycles += cmd & SEQ_CMD_WAIT_MASK;
+        }
+    }
+
+    if (!bEnded) {
+        afesim_Fatal("sequence of %u commands does not clear SEQ_EN, the sequencer would never finish", count);
+    }
+    /* The library sequences also return raw ADC samples, which are not simulated */
+    if (!bLibrary && (produced < size)) {
+        afesim_Fatal("sequence produced %u of the %u results read, the Rx DMA would never complete", produced, size);
+    }
+    if (!bLibrary && (produced > size)) {
+        afesimStats.resultMismatches++;
+    }
+
+    hDevice->seqCrc      = crc;
+    hDevice->seqCount    = (uint16_t)(i - 1u);
+    hDevice->pSeq        = seq;
+    hDevice->seqNext     = 1;
+    hDevice->seqLast     = i - 1u;
+    hDevice->seqStart    = afesimStats.now;
+    hDevice->seqCycles   = 0;
+    hDevice->dftStart    = 0;
+    hDevice->seqEnd      = afesimStats.now + cycles;
+    hDevice->bSeqRunning = true;
+    hDevice->bExecuting  = true;
+    hDevice->regs[AFE_SEQ_CFG / 4u] |= AFE_SEQ_CFG_SEQ_EN;
+    afe_RxStart(hDevice, rxBuffer, size);
+
+    if (bLibrary) {
+        afesimStats.calSequences++;
+    }
+    else {
+        afesimStats.sequences++;
+        if (afesimConfig.seqLimit && (afesimStats.sequences > afesimConfig.seqLimit)) {
+            afesim_Exit();
+        }
+    }
+
+    return ADI_AFE_SUCCESS;
+}
+
+/*
+ * Run the commands of the started sequence that execute by the given time.
+ * The Rx DMA callback is called when a DMA cycle completes, with the
+ * simulated time of the command that produced the last result; with
+ * bStopAtDma, the step ends there. Returns the time reached.
+ */
+static uint64_t afe_Step(ADI_AFE_DEV_HANDLE hDevice, uint64_t until, bool_t bStopAtDma) {
+    uint32_t                cmd, offset, previous;
+    uint32_t                cycleStart, cycleLength;
+    uint64_t                time;
+    int16_t                 re, im;
+
+    while (hDevice->bExecuting) {
+        time = hDevice->seqStart + hDevice->seqCycles + 1u;
+        if (time > until) {
+            return until;
+        }
+
+        cmd = hDevice->pSeq[hDevice->seqNext];
+        hDevice->seqCycles++;
+
+        if (cmd & SEQ_CMD_WRITE) {
+            offset   = SEQ_CMD_OFFSET(cmd);
+            previous = (offset < (AFE_REG_COUNT * 4u)) ? hDevice->regs[offset / 4u] : 0u;
+
+            /* The DFT sees the configuration of its window, before the write */
+            if (AFE_CFG == offset) {
+                if (!(previous & AFE_CFG_DFT_EN) && (cmd & AFE_CFG_DFT_EN)) {
+                    hDevice->dftStart = hDevice->seqCycles;
+                }
+                else if ((previous & AFE_CFG_DFT_EN) && !(cmd & AFE_CFG_DFT_EN)) {
+                    afe_Dft(hDevice, hDevice->seqCycles - hDevice->dftStart, &re, &im);
+                    afe_RxWrite(hDevice, (uint16_t)re);
+                    afe_RxWrite(hDevice, (uint16_t)im);
+                }
+            }
+            if (AFE_ANALOG_GEN_INT == offset) {
+                /* Custom interrupt, taken once the command has executed */
+                if ((cmd & hDevice->genIen & AFE_GEN_INT_CUSTOM) && (NULL != hDevice->cbGenerate) &&
+                    (cmd & hDevice->cbGenerateWatch)) {
+                    hDevice->cbGenerate(hDevice, 0, NULL);
+                }
+            }
+            else if (offset < (AFE_REG_COUNT * 4u)) {
+                hDevice->regs[offset / 4u] = cmd & SEQ_CMD_DATA_MASK;
+            }
+        }
+        else if (!(cmd & SEQ_CMD_TIMEOUT)) {
+            hDevice->seqCycles += cmd & SEQ_CMD_WAIT_MASK;
+        }
+
+        if (++hDevice->seqNext > hDevice->seqLast) {
+            hDevice->bExecuting = false;
+        }
+
+        /* DMA interrupt, once the command that produced the result has executed */
+        if (hDevice->bRxCycleDone) {
+            hDevice->bRxCycleDone = false;
+            hDevice->rxCycles++;
+            cycleStart  = hDevice->rxCycleStart;
+            cycleLength = hDevice->rxCycleLength;
+            if (hDevice->rxRemaining) {
+                afe_RxCycle(hDevice);
+            }
+            if (NULL != hDevice->cbRxDma) {
+                hDevice->cbRxDma(hDevice, cycleLength, &hDevice->pRxBuffer[cycleStart]);
+            }
+            if (bStopAtDma) {
+                return time;
+            }
+        }
+    }
+
+    return hDevice->seqEnd;
+}
+
+/* Calibration library sequences: run for their timing, the codes are nominal */
+static ADI_AFE_RESULT_TYPE afe_RunLibrary(ADI_AFE_DEV_HANDLE hDevice, const uint32_t *seq) {
+    afe_Execute(hDevice, seq, NULL, 0, true);
+    afe_Wait(hDevice);
+
+    return ADI_AFE_SUCCESS;
+}
+
+/* CPU waits for the sequencer */
+static void afe_Wait(ADI_AFE_DEV_HANDLE hDevice) {
+    if (hDevice->bSeqRunning) {
+        afe_Step(hDevice, hDevice->seqEnd, false);
+        afesim_WaitUntil(hDevice->seqEnd, &afesimStats.seqCycles);
+        hDevice->bSeqRunning = false;
+    }
+}
+
+/* CPU polls the sequencer: it runs up to its next DMA interrupt, or to its end */
+static void afe_Poll(ADI_AFE_DEV_HANDLE hDevice) {
+    if (hDevice->bSeqRunning) {
+        afesim_WaitUntil(afe_Step(hDevice, hDevice->seqEnd, true), &afesimStats.seqCycles);
+    }
+}
+
+/* Non-zero while a sequence started in non-blocking mode has not been waited for */
+int afesim_SeqBusy(void) {
+    return (afeDevice.bSeqRunning && (afesimStats.now < afeDevice.seqEnd)) ? 1 : 0;
+}
+
+/* Non-zero while a running sequence drives the excitation or converts */
+int afesim_SeqLive(void) {
+    return (afeDevice.bExecuting &&
+            (afeDevice.regs[AFE_CFG / 4u] & (AFE_CFG_WAVEGEN_EN | AFE_CFG_DFT_EN))) ? 1 : 0;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_Init(ADI_AFE_DEV_HANDLE* const phDevice) {
+    ADI_AFE_DEV_HANDLE      hDevice = &afeDevice;
+    uint32_t                i;
+
+    if (hDevice->bInitialized) {
+        return ADI_AFE_ERR_ALREADY_INITIALIZED;
+    }
+
+    /* The calibration registers keep their values, as in hardware */
+    if (0u == hDevice->cal[AFE_CAL_INDEX(ADI_AFE_CAL_REG_ADC_GAIN_TIA)]) {
+        for (i = 0; i < AFE_CAL_COUNT; i++) {
+            hDevice->cal[i] = 0;
+        }
+        hDevice->cal[AFE_CAL_INDEX(ADI_AFE_CAL_REG_ADC_GAIN_TIA)]       = AFE_CAL_GAIN_UNITY;
+        hDevice->cal[AFE_CAL_INDEX(ADI_AFE_CAL_REG_ADC_GAIN_TEMP_SENS)] = AFE_CAL_GAIN_UNITY;
+        hDevice->cal[AFE_CAL_INDEX(ADI_AFE_CAL_REG_ADC_GAIN_AUX)]       = AFE_CAL_GAIN_UNITY;
+        hDevice->cal[AFE_CAL_INDEX(ADI_AFE_CAL_REG_DAC_GAIN)]           = AFE_CAL_GAIN_UNITY;
+    }
+
+    memset(hDevice->regs, 0, sizeof(hDevice->regs));
+    hDevice->bInitialized = true;
+    hDevice->bBlocking    = true;
+    hDevice->bSoftwareCRC = false;
+    hDevice->cbRxDma      = NULL;
+    hDevice->rcal         = 1000u;
+    hDevice->rtia         = 33000u;
+    hDevice->seqState     = ADI_AFE_SEQ_STATE_IDLE;
+    hDevice->bSeqRunning  = false;
+    hDevice->bExecuting   = false;
+    hDevice->dmaMaxSize[0] = 1024u;
+    hDevice->dmaMaxSize[1] = 0;
+
+    *phDevice = hDevice;
+
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_UnInit(ADI_AFE_DEV_HANDLE const hDevice) {
+    if (!hDevice->bInitialized) {
+        return ADI_AFE_ERR_NOT_INITIALIZED;
+    }
+
+    afe_Wait(hDevice);
+    hDevice->bInitialized = false;
+
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_SetRcal(ADI_AFE_DEV_HANDLE const hDevice, uint32_t rcal) {
+    hDevice->rcal = rcal;
+
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_SetRtia(ADI_AFE_DEV_HANDLE const hDevice, uint32_t rtia) {
+    hDevice->rtia = rtia;
+
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_WriteCalibrationRegister(ADI_AFE_DEV_HANDLE const hDevice, ADI_AFE_CAL_REG_TYPE Reg, uint32_t Val) {
+    if (AFE_CAL_INDEX(Reg) >= AFE_CAL_COUNT) {
+        return ADI_AFE_ERR_PARAM_OUT_OF_RANGE;
+    }
+
+    hDevice->cal[AFE_CAL_INDEX(Reg)] = Val;
+
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_ReadCalibrationRegister(ADI_AFE_DEV_HANDLE const hDevice, ADI_AFE_CAL_REG_TYPE Reg, uint32_t *const pVal) {
+    if (AFE_CAL_INDEX(Reg) >= AFE_CAL_COUNT) {
+        return ADI_AFE_ERR_PARAM_OUT_OF_RANGE;
+    }
+
+    *pVal = hDevice->cal[AFE_CAL_INDEX(Reg)];
+
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_RegisterCallbackOnReceiveDMA(ADI_AFE_DEV_HANDLE const hDevice, ADI_CALLBACK const cbFunc, uint32_t cbWatch) {
+    hDevice->cbRxDma = cbFunc;
+
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_RegisterAfeCallback(ADI_AFE_DEV_HANDLE hDevice, ADI_AFE_INT_GROUP_TYPE group, ADI_CALLBACK cbFunc, uint32_t cbWatch) {
+    /* Only the generate interrupts are raised by the simulated sequencer */
+    if (ADI_AFE_INT_GROUP_GENERATE == group) {
+        hDevice->cbGenerate      = cbFunc;
+        hDevice->cbGenerateWatch = cbWatch;
+    }
+
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_EnableInterruptSource(ADI_AFE_DEV_HANDLE const hDevice, ADI_AFE_INT_GROUP_TYPE group, uint32_t mask, bool_t bFlag) {
+    if (ADI_AFE_INT_GROUP_GENERATE == group) {
+        hDevice->genIen = bFlag ? (hDevice->genIen | mask) : (hDevice->genIen & ~mask);
+    }
+
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_SetDmaRxBufferMaxSize(ADI_AFE_DEV_HANDLE const hDevice, uint16_t maxSizeFirst, uint16_t maxSizeSecond) {
+    if ((maxSizeFirst > 1024u) || (maxSizeSecond > 1024u) || (0u == maxSizeFirst)) {
+        return ADI_AFE_ERR_PARAM_OUT_OF_RANGE;
+    }
+
+    hDevice->dmaMaxSize[0] = maxSizeFirst;
+    hDevice->dmaMaxSize[1] = maxSizeSecond;
+
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_GetDmaRxBufferMaxSize(ADI_AFE_DEV_HANDLE const hDevice, uint16_t *const maxSizeFirst, uint16_t *const maxSizeSecond) {
+    *maxSizeFirst  = hDevice->dmaMaxSize[0];
+    *maxSizeSecond = hDevice->dmaMaxSize[1];
+
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_SetRunSequenceBlockingMode(ADI_AFE_DEV_HANDLE const hDevice, const bool_t bFlag) {
+    hDevice->bBlocking = bFlag;
+
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_EnableSoftwareCRC(ADI_AFE_DEV_HANDLE const hDevice, const bool_t bEnable) {
+    hDevice->bSoftwareCRC = bEnable;
+
+    return ADI_AFE_SUCCESS;
+}
+
+uint8_t adi_AFE_CalculateSequenceCRC(const uint32_t *const txBuffer) {
+    uint32_t                count = (txBuffer[0] & 0xFFFF0000u) >> 16;
+    uint32_t                i;
+    uint8_t                 crc = 0x01u;
+
+    for (i = 1; i <= count; i++) {
+        crc = afe_Crc8(crc, txBuffer[i]);
+    }
+
+    return crc;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_GetSeqError(ADI_AFE_DEV_HANDLE const hDevice) {
+    /* Polled while waiting for the sequencer, CPU time is not simulated */
+    afe_Poll(hDevice);
+
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_SetSeqState(ADI_AFE_DEV_HANDLE const hDevice, ADI_AFE_SEQ_STATE_TYPE seqState) {
+    hDevice->seqState = seqState;
+
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_GetSeqFinished(ADI_AFE_DEV_HANDLE const hDevice, bool_t *const pbFlag) {
+    afe_Wait(hDevice);
+    *pbFlag = true;
+
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_SeqStop(ADI_AFE_DEV_HANDLE const hDevice) {
+    afe_Wait(hDevice);
+    hDevice->regs[AFE_SEQ_CFG / 4u] &= ~AFE_SEQ_CFG_SEQ_EN;
+
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_SeqAbort(ADI_AFE_DEV_HANDLE const hDevice) {
+    hDevice->bSeqRunning = false;
+    hDevice->bExecuting  = false;
+    hDevice->regs[AFE_SEQ_CFG / 4u] &= ~AFE_SEQ_CFG_SEQ_EN;
+
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_SeqCheck(ADI_AFE_DEV_HANDLE const hDevice, const uint32_t *const txBuffer) {
+    uint32_t                count = (txBuffer[0] & 0xFFFF0000u) >> 16;
+    uint8_t                 crc;
+
+    crc = hDevice->bSoftwareCRC ? adi_AFE_CalculateSequenceCRC(txBuffer) : (uint8_t)(txBuffer[0] & 0xFFu);
+
+    if ((hDevice->seqCrc != crc) || (hDevice->seqCount != count)) {
+        afesimStats.crcErrors++;
+        return ADI_AFE_ERR_SEQ_CHECK;
+    }
+
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_RunSequence(ADI_AFE_DEV_HANDLE const hDevice, const uint32_t *const txBuffer, uint16_t *const rxBuffer, uint32_t size) {
+    ADI_AFE_RESULT_TYPE     result;
+
+    if (!hDevice->bInitialized) {
+        return ADI_AFE_ERR_NOT_INITIALIZED;
+    }
+
+    /* A new sequence cannot start before the previous one has finished */
+    afe_Wait(hDevice);
+
+    if (ADI_AFE_SUCCESS != (result = afe_Execute(hDevice, txBuffer, rxBuffer, size, false))) {
+        return result;
+    }
+
+    if (!hDevice->bBlocking) {
+        hDevice->seqState = ADI_AFE_SEQ_STATE_RUNNING;
+        return ADI_AFE_SUCCESS;
+    }
+
+    afe_Wait(hDevice);
+    hDevice->seqState = ADI_AFE_SEQ_STATE_IDLE;
+
+    return adi_AFE_SeqCheck(hDevice, txBuffer);
+}
+
+/* Calibration library */
+
+ADI_AFE_RESULT_TYPE adi_AFE_PowerUp(ADI_AFE_DEV_HANDLE const hDevice) {
+    return afe_RunLibrary(hDevice, seq_afe_powerup);
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_PowerDown(ADI_AFE_DEV_HANDLE const hDevice) {
+    afe_Wait(hDevice);
+    memset(hDevice->regs, 0, sizeof(hDevice->regs));
+
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_TempSensChanCal(ADI_AFE_DEV_HANDLE const hDevice) {
+    afe_RunLibrary(hDevice, seq_afe_tempsenschancal);
+    hDevice->cal[AFE_CAL_INDEX(ADI_AFE_CAL_REG_ADC_GAIN_TEMP_SENS)]   = AFE_CAL_GAIN_TEMP_SENS;
+    hDevice->cal[AFE_CAL_INDEX(ADI_AFE_CAL_REG_ADC_OFFSET_TEMP_SENS)] = 0;
+
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_AuxChanCal(ADI_AFE_DEV_HANDLE const hDevice) {
+    afe_RunLibrary(hDevice, seq_afe_auxchancal);
+    hDevice->cal[AFE_CAL_INDEX(ADI_AFE_CAL_REG_ADC_GAIN_AUX)]   = AFE_CAL_GAIN_UNITY;
+    hDevice->cal[AFE_CAL_INDEX(ADI_AFE_CAL_REG_ADC_OFFSET_AUX)] = 0;
+
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_TempSensMeas(ADI_AFE_DEV_HANDLE const hDevice, int32_t *const measResult) {
+    afe_RunLibrary(hDevice, seq_afe_tempsensmeas);
+    *measResult = afesimConfig.temperature;
+
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_ExciteChanPowerUp(ADI_AFE_DEV_HANDLE const hDevice) {
+    return afe_RunLibrary(hDevice, seq_afe_excitechanpowerup);
+}
+
+/* The TIA channel uses the temperature sensor channel codes, as in afe_lib.c */
+ADI_AFE_RESULT_TYPE adi_AFE_TiaChanCal(ADI_AFE_DEV_HANDLE const hDevice) {
+    afe_RunLibrary(hDevice, seq_afe_tiachancal1);
+    afe_RunLibrary(hDevice, seq_afe_tiachancal2);
+    afe_RunLibrary(hDevice, seq_afe_tiachancal3);
+    afe_RunLibrary(hDevice, seq_afe_tiachancal4);
+    afe_RunLibrary(hDevice, seq_afe_tiachancal5);
+    hDevice->cal[AFE_CAL_INDEX(ADI_AFE_CAL_REG_ADC_GAIN_TIA)] =
+        hDevice->cal[AFE_CAL_INDEX(ADI_AFE_CAL_REG_ADC_GAIN_TEMP_SENS)];
+    hDevice->cal[AFE_CAL_INDEX(ADI_AFE_CAL_REG_ADC_OFFSET_TIA)] =
+        hDevice->cal[AFE_CAL_INDEX(ADI_AFE_CAL_REG_ADC_OFFSET_TEMP_SENS)];
+
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_ExciteChanCalAtten(ADI_AFE_DEV_HANDLE const hDevice) {
+    afe_RunLibrary(hDevice, seq_afe_excitechancalatten1);
+    afe_RunLibrary(hDevice, seq_afe_excitechancalatten2);
+    hDevice->cal[AFE_CAL_INDEX(ADI_AFE_CAL_REG_DAC_OFFSET_ATTEN)] = 0;
+
+    return ADI_AFE_SUCCESS;
+}
+
+/*
+** EOF
+*/
@@ -0,0 +1,765 @@
+/*!
+ *****************************************************************************
+ * @file:   afesim_board.c
+ * @brief:  Simulated board drivers: GPIO, UART, flash, watchdog, metrics, GP timers
+ *
+ * GPIO:    the port data is decoded into the channels of the four ADG732
+ *          multiplexers with the address wiring of adg732.c.
+ * UART:    transmitted bytes go to the output file at once, and leave the
+ *          driver buffer at the baud rate in simulated time, so a transmit
+ *          that does not fit is truncated as by the real driver. Received
+ *          bytes are written into the firmware receive buffer at their
+ *          scheduled time, as by the driver interrupt handler.
+ * Flash:   the general purpose flash is mapped at its real address.
+ * Metrics: simulated time plus the host CPU time, scaled to 16 MHz cycles,
+ *          so waits for the sequencer and the UART count as on the board.
+ * GP timers: free running up counters of the simulated time through the
+ *          prescaler; the timeout callback runs once per overflow when the
+ *          count is read, before the read returns.
+ *****************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <ctype.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/mman.h>
+
+#include "arm_math.h"
+#include "flash.h"
+#include "gpio.h"
+#include "gpt.h"
+#include "metrics.h"
+#include "system.h"
+#include "uart.h"
+#include "wdt.h"
+
+#include "afesim.h"
+
+/* Memory the firmware accesses directly, mapped at the device addresses */
+#define BOARD_GP_FLASH_ADDRESS      (0x20080000u)
+#define BOARD_GP_FLASH_SIZE         (0x4000u)
+#define BOARD_GP_FLASH_PAGE_SIZE    (0x200u)
+#define BOARD_GPIO_ADDRESS          (0x40020000u)
+#define BOARD_SCS_ADDRESS           (0xE000E000u)
+#define BOARD_PAGE_SIZE             (0x1000u)
+
+/* GPIO ports, 0x40 apart from ADI_GPIO_PORT_0 */
+#define BOARD_GPIO_PORTS            (5u)
+#define BOARD_GPIO_INDEX(port)      (((uint32_t)(port) - ADI_GPIO_PORT_0) / 0x40u)
+
+/* Multiplexers and address bits, as in adg732.c */
+#define BOARD_MUX_COUNT             (4u)
+#define BOARD_MUX_BITS              (5u)
+
+/* Address pin of a multiplexer */
+typedef struct {
+    uint8_t                 port;
+    uint8_t                 bit;
+} BOARD_MUX_PIN;
+
+/* Address pins of each multiplexer, A4 first: M1 (A-), M2 (V-), M3 (A+), M4 (V+) */
+static const BOARD_MUX_PIN  boardMuxPins[BOARD_MUX_COUNT][BOARD_MUX_BITS] = {
+    { {1, 4},  {1, 3},  {1, 2},  {1, 1},  {1, 0}  },
+    { {1, 10}, {1, 9},  {1, 8},  {1, 7},  {1, 6}  },
+    { {3, 13}, {1, 15}, {1, 14}, {1, 13}, {1, 12} },
+    { {2, 7},  {2, 8},  {2, 9},  {2, 10}, {2, 11} },
+};
+
+/* Scheduled receive byte */
+typedef struct {
+    uint64_t                time;
+    uint8_t                 data;
+} BOARD_KEY;
+
+/* Simulated UART device */
+struct ADI_UART_DEV_DATA_TYPE {
+    bool_t                  bInitialized;
+    bool_t                  bBlocking;
+    uint8_t                *pRxBuffer;
+    uint16_t                rxSize;
+    uint16_t                rxWrite;
+    uint16_t                rxRead;
+    uint16_t                rxAvailable;
+    uint16_t                rxDropped;
+    uint16_t                txDropped;
+    uint16_t                txSize;
+    uint32_t                byteCycles;     /*!< ACLK cycles per byte at the baud rate  */
+    uint64_t                txBusyUntil;    /*!< Time the transmit buffer is empty      */
+};
+
+/* Simulated metric device */
+struct ADI_METRIC_DEV_DATA_TYPE {
+    uint64_t                start;
+    uint64_t                accumulate;
+};
+
+/* Simulated GP timer device */
+struct ADI_GPT_DEV_DATA_TYPE {
+    bool_t                  bEnabled;
+    uint32_t                divider;        /*!< Source clocks per count                */
+    uint64_t                start;          /*!< Time the timer was enabled             */
+    uint64_t                overflows;      /*!< Overflows signalled to the callback    */
+    ADI_CALLBACK            pfCallback;
+    void                   *pCBParam;
+};
+
+/* Simulated watchdog and flash devices */
+struct ADI_WDT_DEV_DATA_TYPE {
+    bool_t                  bEnabled;
+};
+struct ADI_FEE_DEV_DATA_TYPE {
+    bool_t                  bInitialized;
+};
+
+static ADI_GPIO_DATA_TYPE   gpioData[BOARD_GPIO_PORTS];
+static uint32_t             muxChannels[BOARD_MUX_COUNT];
+
+static struct ADI_UART_DEV_DATA_TYPE   uartDevice;
+static struct ADI_METRIC_DEV_DATA_TYPE metricDevice;
+static struct ADI_GPT_DEV_DATA_TYPE    gptDevices[3];
+static struct ADI_WDT_DEV_DATA_TYPE    wdtDevice;
+static struct ADI_FEE_DEV_DATA_TYPE    feeDevice;
+
+static BOARD_KEY            keys[AFESIM_MAX_KEYS];
+static uint32_t             keyCount;
+static uint32_t             keyNext;
+
+static uint64_t             rngState = 0x9E3779B97F4A7C15ull;
+
+static const uint32_t       baudRates[ADI_UART_BAUD_MAX_ENTRIES] = {
+    9600, 19200, 38400, 57600, 115200, 230400, 460800
+};
+
+static void                 board_GpioUpdate        (void);
+static uint64_t             board_Random            (void);
+static uint32_t             board_TxPending         (ADI_UART_HANDLE hDevice);
+static void                 board_Tx                (ADI_UART_HANDLE hDevice, const uint8_t *pData, uint32_t size);
+static uint64_t             board_MetricNow         (void);
+
+/* Decode the multiplexer channels after a GPIO write */
+static void board_GpioUpdate(void) {
+    uint32_t                mux, bit, channel;
+    bool_t                  bChanged = false;
+    const BOARD_MUX_PIN    *pPin;
+
+    for (mux = 0; mux < BOARD_MUX_COUNT; mux++) {
+        channel = 0;
+        for (bit = 0; bit < BOARD_MUX_BITS; bit++) {
+            pPin    = &boardMuxPins[mux][bit];
+            channel = (channel << 1) | ((gpioData[pPin->port] >> pPin->bit) & 1u);
+        }
+        if (channel != muxChannels[mux]) {
+            muxChannels[mux] = channel;
+            bChanged = true;
+        }
+    }
+
+    if (bChanged) {
+        afesimStats.muxWrites++;
+        if (afesim_SeqBusy()) {
+            afesimStats.muxWritesBusy++;
+        }
+        if (afesim_SeqLive()) {
+            afesimStats.muxWritesLive++;
+        }
+    }
+}
+
+/* xorshift64* */
+static uint64_t board_Random(void) {
+    rngState ^= rngState >> 12;
+    rngState ^= rngState << 25;
+    rngState ^= rngState >> 27;
+
+    return rngState * 0x2545F4914F6CDD1Dull;
+}
+
+/* Bytes still in the transmit buffer */
+static uint32_t board_TxPending(ADI_UART_HANDLE hDevice) {
+    if (hDevice->txBusyUntil <= afesimStats.now) {
+        return 0;
+    }
+
+    return (uint32_t)((hDevice->txBusyUntil - afesimStats.now + hDevice->byteCycles - 1u) / hDevice->byteCycles);
+}
+
+static void board_Tx(ADI_UART_HANDLE hDevice, const uint8_t *pData, uint32_t size) {
+    if (hDevice->txBusyUntil < afesimStats.now) {
+        hDevice->txBusyUntil = afesimStats.now;
+    }
+    hDevice->txBusyUntil += (uint64_t)size * hDevice->byteCycles;
+    afesimStats.txBytes  += size;
+
+    fwrite(pData, 1, size, afesimConfig.pOutput);
+}
+
+/*!
+ * @brief       Current channel of each multiplexer.
+ *
+ * @param[out]  channels    M1 (A-), M2 (V-), M3 (A+) and M4 (V+) channels.
+ */
+void afesim_MuxChannels(uint32_t channels[4]) {
+    memcpy(channels, muxChannels, sizeof(muxChannels));
+}
+
+/*!
+ * @brief       Schedule bytes for the UART receiver.
+ *
+ * @param[in]   seconds     Simulated time of the first byte.
+ * @param[in]   pText       Bytes, "\n" is a newline and "\xNN" the byte of hex
+ *                          value NN. The following bytes arrive one character
+ *                          time apart at 115200 baud.
+ *
+ * @return      0, or -1 if there are too many bytes or they are out of order.
+ */
+int afesim_KeyAdd(double seconds, const char *pText) {
+    uint64_t                time = (uint64_t)(seconds * AFESIM_CLOCK_HZ);
+    uint8_t                 data;
+
+    if ((keyCount > 0u) && (time < keys[keyCount - 1u].time)) {
+        return -1;
+    }
+
+    while ('\0' != *pText) {
+        data = (uint8_t)*pText++;
+        if (('\\' == data) && ('n' == *pText)) {
+            data = '\n';
+            pText++;
+        }
+        else if (('\\' == data) && ('x' == pText[0]) && isxdigit((unsigned char)pText[1]) &&
+                 isxdigit((unsigned char)pText[2])) {
+            char            hex[3] = { pText[1], pText[2], '\0' };
+
+            data   = (uint8_t)strtoul(hex, NULL, 16);
+            pText += 3;
+        }
+        if (keyCount >= AFESIM_MAX_KEYS) {
+            return -1;
+        }
+        keys[keyCount].time = time;
+        keys[keyCount].data = data;
+        keyCount++;
+        time += AFESIM_CLOCK_HZ * 10u / 115200u;
+    }
+
+    return 0;
+}
+
+/*!
+ * @brief       Deliver the received bytes that are due, as the UART interrupt does.
+ *
+ * @details     A byte received into a full buffer is dropped and counted, as by
+ *              the driver with ADI_UART_CFG_RX_OVERFLOW_DROP set.
+ */
+void afesim_UartService(void) {
+    ADI_UART_HANDLE         hDevice = &uartDevice;
+
+    while ((keyNext < keyCount) && (keys[keyNext].time <= afesimStats.now)) {
+        if (hDevice->bInitialized && (NULL != hDevice->pRxBuffer)) {
+            if (hDevice->rxAvailable == hDevice->rxSize) {
+                hDevice->rxDropped++;
+                afesimStats.rxDropped++;
+                keyNext++;
+                continue;
+            }
+            if (hDevice->rxWrite == hDevice->rxSize) {
+                hDevice->rxWrite = 0;
+            }
+            hDevice->pRxBuffer[hDevice->rxWrite++] = keys[keyNext].data;
+            hDevice->rxAvailable++;
+        }
+        keyNext++;
+    }
+}
+
+/*!
+ * @brief       Map the memory the firmware accesses directly.
+ *
+ * @return      0, or -1 if an address range is not available to the process.
+ */
+int afesim_MemoryMap(void) {
+    FILE                   *pFile;
+    void                   *pFlash;
+
+    pFlash = mmap((void *)(uintptr_t)BOARD_GP_FLASH_ADDRESS, BOARD_GP_FLASH_SIZE, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if ((void *)(uintptr_t)BOARD_GP_FLASH_ADDRESS != pFlash) {
+        return -1;
+    }
+    /* PinMux.c writes the port configuration, NVIC_SetPriorityGrouping() the SCB */
+    if (((void *)(uintptr_t)BOARD_GPIO_ADDRESS != mmap((void *)(uintptr_t)BOARD_GPIO_ADDRESS, BOARD_PAGE_SIZE,
+                                                       PROT_READ | PROT_WRITE,
+                                                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0)) ||
+        ((void *)(uintptr_t)BOARD_SCS_ADDRESS != mmap((void *)(uintptr_t)BOARD_SCS_ADDRESS, BOARD_PAGE_SIZE,
+                                                      PROT_READ | PROT_WRITE,
+                                                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0))) {
+        return -1;
+    }
+
+    memset(pFlash, 0xFF, BOARD_GP_FLASH_SIZE);
+    if ((NULL != afesimConfig.pFlashImage) && (NULL != (pFile = fopen(afesimConfig.pFlashImage, "rb")))) {
+        if (BOARD_GP_FLASH_SIZE != fread(pFlash, 1, BOARD_GP_FLASH_SIZE, pFile)) {
+            memset(pFlash, 0xFF, BOARD_GP_FLASH_SIZE);
+        }
+        fclose(pFile);
+    }
+
+    return 0;
+}
+
+/* Write the general purpose flash back to its image */
+void afesim_FlashSave(void) {
+    FILE                   *pFile;
+
+    if ((NULL != afesimConfig.pFlashImage) && (NULL != (pFile = fopen(afesimConfig.pFlashImage, "wb")))) {
+        fwrite((void *)(uintptr_t)BOARD_GP_FLASH_ADDRESS, 1, BOARD_GP_FLASH_SIZE, pFile);
+        fclose(pFile);
+    }
+}
+
+/* Standard normal deviate */
+double afesim_Gaussian(void) {
+    double                  u1, u2;
+
+    if (0u != afesimConfig.seed) {
+        rngState = afesimConfig.seed;
+        afesimConfig.seed = 0;
+    }
+
+    u1 = ((double)(board_Random() >> 11) + 1.0) / 9007199254740993.0;
+    u2 = (double)(board_Random() >> 11) / 9007199254740992.0;
+
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+/* System */
+
+void SystemInit(void) {
+}
+
+ADI_SYS_RESULT_TYPE SetSystemClockDivider(ADI_SYS_CLOCK_ID id, uint8_t div) {
+    return ADI_SYS_SUCCESS;
+}
+
+ADI_SYS_RESULT_TYPE SystemTransitionClocks(ADI_SYS_CLOCK_TRIGGER_TYPE transitionEvent) {
+    return ADI_SYS_SUCCESS;
+}
+
+/* GPIO */
+
+ADI_GPIO_RESULT_TYPE adi_GPIO_Init(void) {
+    return ADI_GPIO_SUCCESS;
+}
+
+ADI_GPIO_RESULT_TYPE adi_GPIO_UnInit(void) {
+    return ADI_GPIO_SUCCESS;
+}
+
+ADI_GPIO_RESULT_TYPE adi_GPIO_ResetToPowerUp(void) {
+    memset(gpioData, 0, sizeof(gpioData));
+    board_GpioUpdate();
+
+    return ADI_GPIO_SUCCESS;
+}
+
+ADI_GPIO_RESULT_TYPE adi_GPIO_SetOutputEnable(const ADI_GPIO_PORT_TYPE Port, const ADI_GPIO_DATA_TYPE Pins, const bool_t bFlag) {
+    return ADI_GPIO_SUCCESS;
+}
+
+ADI_GPIO_RESULT_TYPE adi_GPIO_SetInputEnable(const ADI_GPIO_PORT_TYPE Port, const ADI_GPIO_DATA_TYPE Pins, const bool_t bFlag) {
+    return ADI_GPIO_SUCCESS;
+}
+
+ADI_GPIO_RESULT_TYPE adi_GPIO_SetPullUpEnable(const ADI_GPIO_PORT_TYPE Port, const ADI_GPIO_DATA_TYPE Pins, const bool_t bFlag) {
+    return ADI_GPIO_SUCCESS;
+}
+
+ADI_GPIO_RESULT_TYPE adi_GPIO_SetHigh(const ADI_GPIO_PORT_TYPE Port, const ADI_GPIO_DATA_TYPE Pins) {
+    gpioData[BOARD_GPIO_INDEX(Port)] |= Pins;
+    board_GpioUpdate();
+
+    return ADI_GPIO_SUCCESS;
+}
+
+ADI_GPIO_RESULT_TYPE adi_GPIO_SetLow(const ADI_GPIO_PORT_TYPE Port, const ADI_GPIO_DATA_TYPE Pins) {
+    gpioData[BOARD_GPIO_INDEX(Port)] &= (ADI_GPIO_DATA_TYPE)~Pins;
+    board_GpioUpdate();
+
+    return ADI_GPIO_SUCCESS;
+}
+
+ADI_GPIO_RESULT_TYPE adi_GPIO_Toggle(const ADI_GPIO_PORT_TYPE Port, const ADI_GPIO_DATA_TYPE Pins) {
+    gpioData[BOARD_GPIO_INDEX(Port)] ^= Pins;
+    board_GpioUpdate();
+
+    return ADI_GPIO_SUCCESS;
+}
+
+/* UART */
+
+ADI_UART_RESULT_TYPE adi_UART_Init(const ADI_UART_DEV_ID_TYPE devID, ADI_UART_HANDLE* const pHandle, ADI_UART_INIT_DATA* const pInitData) {
+    ADI_UART_HANDLE         hDevice = &uartDevice;
+
+    if (hDevice->bInitialized) {
+        return ADI_UART_ERR_ALREADY_INITIALIZED;
+    }
+
+    memset(hDevice, 0, sizeof(*hDevice));
+    hDevice->bInitialized = true;
+    hDevice->bBlocking    = true;
+    hDevice->byteCycles   = AFESIM_CLOCK_HZ * 10u / 9600u;
+    if (NULL != pInitData) {
+        hDevice->pRxBuffer = pInitData->pRxBufferData;
+        hDevice->rxSize    = pInitData->RxBufferSize;
+        hDevice->txSize    = pInitData->TxBufferSize;
+    }
+
+    *pHandle = hDevice;
+
+    return ADI_UART_SUCCESS;
+}
+
+/* The transmit buffer keeps draining after the driver is closed */
+ADI_UART_RESULT_TYPE adi_UART_UnInit(ADI_UART_HANDLE const hDevice) {
+    if (!hDevice->bInitialized) {
+        return ADI_UART_ERR_NOT_INITIALIZED;
+    }
+
+    hDevice->bInitialized = false;
+
+    return ADI_UART_SUCCESS;
+}
+
+ADI_UART_RESULT_TYPE adi_UART_SetBaudRate(ADI_UART_HANDLE const hDevice, const ADI_UART_BAUDRATE_TYPE BaudRate) {
+    if (BaudRate >= ADI_UART_BAUD_MAX_ENTRIES) {
+        return ADI_UART_ERR_INVALID_PARAMS;
+    }
+
+    hDevice->byteCycles = AFESIM_CLOCK_HZ * 10u / baudRates[BaudRate];
+
+    return ADI_UART_SUCCESS;
+}
+
+ADI_UART_RESULT_TYPE adi_UART_SetGenericSettings(ADI_UART_HANDLE const hDevice, ADI_UART_GENERIC_SETTINGS_TYPE* const pGenericSettings) {
+    hDevice->bBlocking = pGenericSettings->bBlockingMode;
+
+    return adi_UART_SetBaudRate(hDevice, pGenericSettings->BaudRate);
+}
+
+ADI_UART_RESULT_TYPE adi_UART_Enable(ADI_UART_HANDLE const hDevice, const bool_t bFlag) {
+    return ADI_UART_SUCCESS;
+}
+
+ADI_UART_RESULT_TYPE adi_UART_BufTx(ADI_UART_HANDLE const hDevice, const void* const pData, int16_t *pSize) {
+    uint32_t                space;
+
+    if (!hDevice->bInitialized) {
+        return ADI_UART_ERR_NOT_INITIALIZED;
+    }
+    if ((NULL == pData) || (NULL == pSize) || (*pSize <= 0)) {
+        return ADI_UART_ERR_INVALID_PARAMS;
+    }
+
+    /* Polled mode: the call returns once the bytes are sent */
+    if (0u == hDevice->txSize) {
+        board_Tx(hDevice, pData, (uint32_t)*pSize);
+        afesim_WaitUntil(hDevice->txBusyUntil, &afesimStats.uartCycles);
+        return ADI_UART_SUCCESS;
+    }
+
+    /* Blocking: wait for the bytes to fit */
+    if (hDevice->bBlocking) {
+        if ((uint32_t)*pSize > hDevice->txSize) {
+            return ADI_UART_ERR_INVALID_BUFFER;
+        }
+        while ((board_TxPending(hDevice) + (uint32_t)*pSize) > hDevice->txSize) {
+            afesim_WaitUntil(afesimStats.now + hDevice->byteCycles, &afesimStats.uartCycles);
+        }
+        board_Tx(hDevice, pData, (uint32_t)*pSize);
+        return ADI_UART_SUCCESS;
+    }
+
+    /* Non-blocking: the bytes that do not fit are dropped */
+    space = hDevice->txSize - board_TxPending(hDevice);
+    if ((uint32_t)*pSize > space) {
+        afesimStats.txOverflows++;
+        afesimStats.txDropped += (uint32_t)*pSize - space;
+        hDevice->txDropped    += (uint16_t)((uint32_t)*pSize - space);
+        *pSize = (int16_t)space;
+    }
+    if (*pSize > 0) {
+        board_Tx(hDevice, pData, (uint32_t)*pSize);
+    }
+
+    return ADI_UART_SUCCESS;
+}
+
+ADI_UART_RESULT_TYPE adi_UART_BufRx(ADI_UART_HANDLE const hDevice, const void *pData, int16_t *pSize) {
+    uint8_t                *pDst = (uint8_t *)pData;
+    int16_t                 count = 0;
+
+    if (!hDevice->bInitialized) {
+        return ADI_UART_ERR_NOT_INITIALIZED;
+    }
+    if ((NULL == pData) || (NULL == pSize) || (*pSize <= 0)) {
+        return ADI_UART_ERR_INVALID_PARAMS;
+    }
+
+    while ((count < *pSize) && (hDevice->rxAvailable > 0u)) {
+        if (hDevice->rxRead == hDevice->rxSize) {
+            hDevice->rxRead = 0;
+        }
+        pDst[count++] = hDevice->pRxBuffer[hDevice->rxRead++];
+        hDevice->rxAvailable--;
+    }
+    *pSize = count;
+
+    return ADI_UART_SUCCESS;
+}
+
+/* Waits for the transmit buffer to drain, then discards the received bytes */
+ADI_UART_RESULT_TYPE adi_UART_BufFlush(ADI_UART_HANDLE const hDevice) {
+    if (!hDevice->bInitialized) {
+        return ADI_UART_ERR_NOT_INITIALIZED;
+    }
+
+    afesim_WaitUntil(hDevice->txBusyUntil, &afesimStats.uartCycles);
+
+    hDevice->rxWrite     = 0;
+    hDevice->rxRead      = 0;
+    hDevice->rxAvailable = 0;
+
+    return ADI_UART_SUCCESS;
+}
+
+/* Waits for the transmit buffer to drain, the received bytes are kept */
+ADI_UART_RESULT_TYPE adi_UART_TxFlush(ADI_UART_HANDLE const hDevice) {
+    if (!hDevice->bInitialized) {
+        return ADI_UART_ERR_NOT_INITIALIZED;
+    }
+
+    afesim_WaitUntil(hDevice->txBusyUntil, &afesimStats.uartCycles);
+
+    return ADI_UART_SUCCESS;
+}
+
+uint16_t adi_UART_GetNumRxDropped(ADI_UART_HANDLE const hDevice) {
+    return hDevice->rxDropped;
+}
+
+uint16_t adi_UART_GetNumTxDropped(ADI_UART_HANDLE const hDevice) {
+    return hDevice->txDropped;
+}
+
+/* A poll of a full ring waits a byte time, so a firmware loop waiting for room makes progress */
+uint16_t adi_UART_GetNumTxBytes(ADI_UART_HANDLE const hDevice) {
+    if ((0u != hDevice->txSize) && (board_TxPending(hDevice) >= hDevice->txSize)) {
+        afesim_WaitUntil(afesimStats.now + hDevice->byteCycles, &afesimStats.uartCycles);
+    }
+
+    return (uint16_t)(hDevice->txSize - board_TxPending(hDevice));
+}
+
+/* Each poll costs a microsecond, so a firmware loop polling for input makes progress */
+uint16_t adi_UART_GetNumRxBytes(ADI_UART_HANDLE const hDevice) {
+    afesim_Advance(AFESIM_CLOCK_HZ / 1000000u);
+
+    return hDevice->rxAvailable;
+}
+
+/* Watchdog */
+
+ADI_WDT_RESULT_TYPE adi_WDT_Init(const ADI_WDT_DEV_ID_TYPE DevID, ADI_WDT_DEV_HANDLE * const pHandle) {
+    *pHandle = &wdtDevice;
+
+    return ADI_WDT_SUCCESS;
+}
+
+ADI_WDT_RESULT_TYPE adi_WDT_UnInit(ADI_WDT_DEV_HANDLE const hDevice) {
+    return ADI_WDT_SUCCESS;
+}
+
+ADI_WDT_RESULT_TYPE adi_WDT_SetEnable(ADI_WDT_DEV_HANDLE const hDevice, const bool_t bEnable) {
+    hDevice->bEnabled = bEnable;
+
+    return ADI_WDT_SUCCESS;
+}
+
+/* Metrics */
+
+static uint64_t board_MetricNow(void) {
+    struct timespec         cpu;
+
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu);
+
+    return afesimStats.now + ((uint64_t)cpu.tv_sec * AFESIM_CLOCK_HZ)
+         + ((uint64_t)cpu.tv_nsec * (AFESIM_CLOCK_HZ / 1000000u) / 1000u);
+}
+
+ADI_METRIC_RESULT_TYPE adi_Metric_Init(ADI_GPT_DEV_ID_TYPE InstanceNum, ADI_METRIC_DEV_HANDLE* const pHandle) {
+    metricDevice.accumulate = 0;
+    *pHandle = &metricDevice;
+
+    return ADI_METRIC_SUCCESS;
+}
+
+ADI_METRIC_RESULT_TYPE adi_Metric_UnInit(ADI_METRIC_DEV_HANDLE const hDevice) {
+    return ADI_METRIC_SUCCESS;
+}
+
+ADI_METRIC_RESULT_TYPE adi_Metric_Start(ADI_METRIC_DEV_HANDLE const hDevice) {
+    hDevice->start = board_MetricNow();
+
+    return ADI_METRIC_SUCCESS;
+}
+
+ADI_METRIC_RESULT_TYPE adi_Metric_Stop(ADI_METRIC_DEV_HANDLE const hDevice) {
+    hDevice->accumulate += board_MetricNow() - hDevice->start;
+
+    return ADI_METRIC_SUCCESS;
+}
+
+uint32_t adi_Metric_GetCount(ADI_METRIC_DEV_HANDLE const hDevice) {
+    return (uint32_t)(board_MetricNow() - hDevice->start);
+}
+
+ADI_METRIC_RESULT_TYPE adi_Metric_ClearAccumulate(ADI_METRIC_DEV_HANDLE const hDevice) {
+    hDevice->accumulate = 0;
+
+    return ADI_METRIC_SUCCESS;
+}
+
+uint32_t adi_Metric_GetAccumulate(ADI_METRIC_DEV_HANDLE const hDevice) {
+    return (uint32_t)hDevice->accumulate;
+}
+
+/* GP timers, counting up from 0 on the HFOSC, the only source and mode the firmware uses */
+
+ADI_GPT_RESULT_TYPE adi_GPT_Init(ADI_GPT_DEV_ID_TYPE InstanceNum, ADI_GPT_HANDLE* const phDevice) {
+    if ((uint32_t)InstanceNum >= sizeof(gptDevices) / sizeof(gptDevices[0])) {
+        return ADI_GPT_ERR_BAD_INSTANCE;
+    }
+    memset(&gptDevices[InstanceNum], 0, sizeof(gptDevices[InstanceNum]));
+    gptDevices[InstanceNum].divider = 1;
+    *phDevice = &gptDevices[InstanceNum];
+
+    return ADI_GPT_SUCCESS;
+}
+
+ADI_GPT_RESULT_TYPE adi_GPT_SetClockSelect(ADI_GPT_HANDLE hDevice, ADI_GPT_CLOCK_SELECT_TYPE ClockSelect) {
+    return (ADI_GPT_CLOCK_SELECT_HFOSC == ClockSelect) ? ADI_GPT_SUCCESS : ADI_GPT_ERR_PARAM_OUT_OF_RANGE;
+}
+
+ADI_GPT_RESULT_TYPE adi_GPT_SetCountMode(ADI_GPT_HANDLE hDevice, ADI_GPT_COUNT_MODE_TYPE Mode) {
+    return (ADI_GPT_COUNT_UP == Mode) ? ADI_GPT_SUCCESS : ADI_GPT_ERR_PARAM_OUT_OF_RANGE;
+}
+
+ADI_GPT_RESULT_TYPE adi_GPT_SetPeriodicMode(ADI_GPT_HANDLE hDevice, bool_t bMod, uint16_t reloadValue) {
+    return bMod ? ADI_GPT_ERR_PARAM_OUT_OF_RANGE : ADI_GPT_SUCCESS;
+}
+
+ADI_GPT_RESULT_TYPE adi_GPT_SetLdVal(ADI_GPT_HANDLE hDevice, const uint16_t TimerLdVal) {
+    return ADI_GPT_SUCCESS;
+}
+
+ADI_GPT_RESULT_TYPE adi_GPT_SetPrescaler(ADI_GPT_HANDLE hDevice, ADI_GPT_PRESCALER_TYPE Prescaler) {
+    hDevice->divider = (ADI_GPT_PRESCALER_16 == Prescaler) ? 16u :
+                       (ADI_GPT_PRESCALER_256 == Prescaler) ? 256u :
+                       (ADI_GPT_PRESCALER_32768 == Prescaler) ? 32768u : 1u;
+
+    return ADI_GPT_SUCCESS;
+}
+
+ADI_GPT_RESULT_TYPE adi_GPT_RegisterCallback(ADI_GPT_HANDLE hDevice, ADI_CALLBACK pfCallback, void *pCBParam) {
+    hDevice->pfCallback = pfCallback;
+    hDevice->pCBParam   = pCBParam;
+
+    return ADI_GPT_SUCCESS;
+}
+
+ADI_GPT_RESULT_TYPE adi_GPT_SetTimerEnable(ADI_GPT_HANDLE hDevice, bool_t bEnable) {
+    if (bEnable && !hDevice->bEnabled) {
+        hDevice->start     = afesimStats.now;
+        hDevice->overflows = 0;
+    }
+    hDevice->bEnabled = bEnable;
+
+    return ADI_GPT_SUCCESS;
+}
+
+ADI_GPT_RESULT_TYPE adi_GPT_GetTxVal(ADI_GPT_HANDLE hDevice, uint16_t *pTimerValue) {
+    uint64_t                counts = hDevice->bEnabled ? (afesimStats.now - hDevice->start) / hDevice->divider : 0u;
+
+    /* The interrupts of the overflows since the last read */
+    while (hDevice->overflows < (counts >> 16)) {
+        hDevice->overflows++;
+        if (NULL != hDevice->pfCallback) {
+            hDevice->pfCallback(hDevice->pCBParam, ADI_GPT_EVENT_TIMEOUT, NULL);
+        }
+    }
+    *pTimerValue = (uint16_t)counts;
+
+    return ADI_GPT_SUCCESS;
+}
+
+bool_t adi_GPT_GetTimeOutEventStatus(ADI_GPT_HANDLE hDevice) {
+    uint64_t                counts = hDevice->bEnabled ? (afesimStats.now - hDevice->start) / hDevice->divider : 0u;
+
+    /* An overflow not yet signalled to the callback */
+    return (hDevice->overflows < (counts >> 16)) ? true : false;
+}
+
+/* Flash */
+
+ADI_FEE_RESULT_TYPE adi_FEE_Init(ADI_FEE_DEV_ID_TYPE const devID, bool_t bRetryAborts, ADI_FEE_DEV_HANDLE* const pHandle) {
+    if (ADI_FEE_DEVID_GP != devID) {
+        return ADI_FEE_ERR_BAD_DEV_ID;
+    }
+    if (feeDevice.bInitialized) {
+        return ADI_FEE_ERR_ALREADY_INITIALIZED;
+    }
+
+    feeDevice.bInitialized = true;
+    *pHandle = &feeDevice;
+
+    return ADI_FEE_SUCCESS;
+}
+
+ADI_FEE_RESULT_TYPE adi_FEE_UnInit(ADI_FEE_DEV_HANDLE const hDevice) {
+    hDevice->bInitialized = false;
+
+    return ADI_FEE_SUCCESS;
+}
+
+ADI_FEE_RESULT_TYPE adi_FEE_PageErase(ADI_FEE_DEV_HANDLE const hDevice, const uint32_t PageNum) {
+    if (PageNum >= (BOARD_GP_FLASH_SIZE / BOARD_GP_FLASH_PAGE_SIZE)) {
+        return ADI_FEE_ERR_INVALID_PARAMETER;
+    }
+
+    memset((void *)(uintptr_t)(BOARD_GP_FLASH_ADDRESS + PageNum * BOARD_GP_FLASH_PAGE_SIZE), 0xFF, BOARD_GP_FLASH_PAGE_SIZE);
+
+    return ADI_FEE_SUCCESS;
+}
+
+/* Programming can only clear bits */
+ADI_FEE_RESULT_TYPE adi_FEE_Write(ADI_FEE_DEV_HANDLE const hDevice, const uint32_t nAddress, const uint8_t *pData, const uint32_t nBytes) {
+    uint8_t                *pFlash = (uint8_t *)(uintptr_t)nAddress;
+    uint32_t                i;
+
+    if ((nAddress < BOARD_GP_FLASH_ADDRESS) || ((nAddress + nBytes) > (BOARD_GP_FLASH_ADDRESS + BOARD_GP_FLASH_SIZE))) {
+        return ADI_FEE_ERR_INVALID_ADDRESS;
+    }
+
+    for (i = 0; i < nBytes; i++) {
+        pFlash[i] &= pData[i];
+    }
+
+    return ADI_FEE_SUCCESS;
+}
+
+/*
+** EOF
+*/
@@ -0,0 +1,41 @@
+/*!
+ *****************************************************************************
+ * @file:   afesim_dsp.c
+ * @brief:  Reference versions of the CMSIS-DSP functions used by the firmware
+ *
+ * The results follow the library, the speed does not: the magnitude is
+ * computed with the host FPU, so host timings are not Cortex-M3 cycles.
+ *****************************************************************************/
+
+#include <math.h>
+
+#include "arm_math.h"
+
+void arm_cmplx_mag_q31(q31_t * pSrc, q31_t * pDst, uint32_t numSamples) {
+    q31_t                   acc;
+
+    while (numSamples-- > 0u) {
+        acc = (q31_t)((((q63_t)pSrc[0] * pSrc[0]) >> 33) + (((q63_t)pSrc[1] * pSrc[1]) >> 33));
+        *pDst++ = (q31_t)(sqrt((double)acc / 2147483648.0) * 2147483648.0);
+        pSrc += 2;
+    }
+}
+
+void arm_q15_to_q31(q15_t * pSrc, q31_t * pDst, uint32_t blockSize) {
+    while (blockSize-- > 0u) {
+        *pDst++ = (q31_t)*pSrc++ << 16;
+    }
+}
+
+void arm_mult_q15(q15_t * pSrcA, q15_t * pSrcB, q15_t * pDst, uint32_t blockSize) {
+    q31_t                   product;
+
+    while (blockSize-- > 0u) {
+        product = ((q31_t)*pSrcA++ * *pSrcB++) >> 15;
+        *pDst++ = (q15_t)((product > 32767) ? 32767 : ((product < -32768) ? -32768 : product));
+    }
+}
+
+/*
+** EOF
+*/
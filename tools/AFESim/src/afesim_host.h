@@ -0,0 +1,18 @@
+/*!
+ *****************************************************************************
+ * @file:   afesim_host.h
+ * @brief:  IAR keywords for the host build, included before every source
+ *****************************************************************************/
+
+#ifndef __AFESIM_HOST_H__
+#define __AFESIM_HOST_H__
+
+#define __weak                      __attribute__((weak))
+#define __root
+#define __no_init
+
+#endif /* __AFESIM_HOST_H__ */
+
+/*
+** EOF
+*/
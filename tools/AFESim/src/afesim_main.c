@@ -0,0 +1,212 @@
+/*!
+ *****************************************************************************
+ * @file:   afesim_main.c
+ * @brief:  Host simulator entry point, simulated time and report
+ *
+ * Usage: afesim [options]
+ *   -k sec:text    send text to the UART at a simulated time, "\n" for a
+ *                  newline and "\xNN" for a byte, e.g. -k 0.5:h\n -k 1:c\n
+ *                  (repeatable); cmdcheck -e prints command frames this way
+ *   -t sec         simulated seconds to run, 0 for no limit (default 10)
+ *   -n count       firmware sequences to run, 0 for no limit (default 0)
+ *   -z file        impedance network file, see afesim_network.c
+ *   -v codes       DFT noise in codes rms for a 1 ms window (default 0.1)
+ *   -s seed        noise generator seed
+ *   -T degc        die temperature (default 25)
+ *   -f file        general purpose flash image, read at start, written at exit
+ *   -o file        UART output (default stdout)
+ *   -u file        USB bulk IN output, a host reads the frames over USB
+ *                  (firmware built with USE_USB_FOR_DATA), see afesim_usb.c
+ *
+ * The firmware runs until a limit is reached; the simulated time, the time
+ * waiting for the sequencer, the UART and USB, and the sequencer, UART and
+ * USB statistics are then reported on stderr.
+ *****************************************************************************/
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "afesim.h"
+
+/* The firmware main(), renamed by the build */
+extern int                  openeit_main            (void);
+
+AFESIM_CONFIG               afesimConfig = {
+    10.0,                   /* timeLimit    */
+    0,                      /* seqLimit     */
+    0,                      /* seed         */
+    0.1,                    /* noise        */
+    25,                     /* temperature  */
+    NULL,                   /* pOutput      */
+    NULL,                   /* pUsbOutput   */
+    NULL,                   /* pFlashImage  */
+};
+
+AFESIM_STATS                afesimStats;
+
+static uint64_t             timeLimit;
+
+static void                 main_Report             (void);
+static void                 main_Usage              (void);
+
+static void main_Report(void) {
+    double                  seconds = (double)afesimStats.now / AFESIM_CLOCK_HZ;
+
+    fflush(afesimConfig.pOutput);
+    if (NULL != afesimConfig.pUsbOutput) {
+        fflush(afesimConfig.pUsbOutput);
+    }
+    afesim_FlashSave();
+
+    fprintf(stderr, "afesim: %.6f s simulated\n", seconds);
+    fprintf(stderr, "  sequencer wait   %.6f s\n", (double)afesimStats.seqCycles / AFESIM_CLOCK_HZ);
+    fprintf(stderr, "  UART wait        %.6f s\n", (double)afesimStats.uartCycles / AFESIM_CLOCK_HZ);
+    fprintf(stderr, "  USB wait         %.6f s\n", (double)afesimStats.usbCycles / AFESIM_CLOCK_HZ);
+    fprintf(stderr, "  sequences        %u (%.1f/s), %u calibration\n", afesimStats.sequences,
+            (seconds > 0.0) ? afesimStats.sequences / seconds : 0.0, afesimStats.calSequences);
+    fprintf(stderr, "  DFT results      %u\n", afesimStats.dfts);
+    fprintf(stderr, "  CRC errors       %u\n", afesimStats.crcErrors);
+    fprintf(stderr, "  extra results    %u sequences\n", afesimStats.resultMismatches);
+    fprintf(stderr, "  mux writes       %u, %u while the sequencer ran, %u during a measurement\n",
+            afesimStats.muxWrites, afesimStats.muxWritesBusy, afesimStats.muxWritesLive);
+    fprintf(stderr, "  UART bytes       %llu (%.0f/s), %llu dropped in %u truncated writes\n",
+            (unsigned long long)afesimStats.txBytes, (seconds > 0.0) ? afesimStats.txBytes / seconds : 0.0,
+            (unsigned long long)afesimStats.txDropped, afesimStats.txOverflows);
+    fprintf(stderr, "  UART received    %u bytes dropped on a full receive buffer\n", afesimStats.rxDropped);
+    fprintf(stderr, "  USB bytes        %llu (%.0f/s) in %u transfers\n", (unsigned long long)afesimStats.usbBytes,
+            (seconds > 0.0) ? afesimStats.usbBytes / seconds : 0.0, afesimStats.usbTransfers);
+}
+
+static void main_Usage(void) {
+    fprintf(stderr, "usage: afesim [-k sec:text] [-t sec] [-n count] [-z network] [-v noise] [-s seed]\n"
+                    "              [-T degc] [-f flash image] [-o output] [-u usb output]\n");
+    exit(2);
+}
+
+/*!
+ * @brief       Advance simulated time, delivering the UART input and USB completions that become due.
+ *
+ * @param[in]   cycles      ACLK cycles.
+ */
+void afesim_Advance(uint64_t cycles) {
+    afesimStats.now += cycles;
+    afesim_UartService();
+    afesim_UsbService();
+
+    if (timeLimit && (afesimStats.now >= timeLimit)) {
+        afesim_Exit();
+    }
+}
+
+/*!
+ * @brief       Wait until a simulated time.
+ *
+ * @param[in]   time        Time to wait for, nothing is done if it has passed.
+ * @param[out]  pWaitCycles Statistic the waiting time is added to.
+ */
+void afesim_WaitUntil(uint64_t time, uint64_t *pWaitCycles) {
+    if (time > afesimStats.now) {
+        *pWaitCycles += time - afesimStats.now;
+        afesim_Advance(time - afesimStats.now);
+    }
+}
+
+/* Sleep until the next interrupt, the only one the firmware sleeps for is the end of a USB transfer */
+void afesim_Wfi(void) {
+    uint64_t                time = afesim_UsbEventTime();
+
+    if (0u == time) {
+        afesim_Fatal("WFI with no interrupt to come, the firmware would sleep forever");
+    }
+    afesim_WaitUntil(time, &afesimStats.usbCycles);
+}
+
+/* Stop the simulation at a limit */
+void afesim_Exit(void) {
+    exit(0);
+}
+
+/* Stop the simulation on a condition that would hang or crash the firmware */
+void afesim_Fatal(const char *pFormat, ...) {
+    va_list                 args;
+
+    fprintf(stderr, "afesim: at %.6f s: ", (double)afesimStats.now / AFESIM_CLOCK_HZ);
+    va_start(args, pFormat);
+    vfprintf(stderr, pFormat, args);
+    va_end(args);
+    fprintf(stderr, "\n");
+
+    exit(1);
+}
+
+int main(int argc, char *argv[]) {
+    const char             *pNetwork = NULL;
+    char                   *pText;
+    int                     option;
+
+    afesimConfig.pOutput = stdout;
+
+    while (-1 != (option = getopt(argc, argv, "k:t:n:z:v:s:T:f:o:u:"))) {
+        switch (option) {
+        case 'k':
+            if ((NULL == (pText = strchr(optarg, ':'))) || (0 != afesim_KeyAdd(atof(optarg), pText + 1))) {
+                main_Usage();
+            }
+            break;
+        case 't':
+            afesimConfig.timeLimit = atof(optarg);
+            break;
+        case 'n':
+            afesimConfig.seqLimit = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'z':
+            pNetwork = optarg;
+            break;
+        case 'v':
+            afesimConfig.noise = atof(optarg);
+            break;
+        case 's':
+            afesimConfig.seed = strtoull(optarg, NULL, 0);
+            break;
+        case 'T':
+            afesimConfig.temperature = atoi(optarg);
+            break;
+        case 'f':
+            afesimConfig.pFlashImage = optarg;
+            break;
+        case 'o':
+            if (NULL == (afesimConfig.pOutput = fopen(optarg, "wb"))) {
+                perror(optarg);
+                return 2;
+            }
+            break;
+        case 'u':
+            if (NULL == (afesimConfig.pUsbOutput = fopen(optarg, "wb"))) {
+                perror(optarg);
+                return 2;
+            }
+            break;
+        default:
+            main_Usage();
+        }
+    }
+
+    if (0 != afesim_NetworkLoad(pNetwork)) {
+        return 2;
+    }
+    if (0 != afesim_MemoryMap()) {
+        fprintf(stderr, "afesim: cannot map the device memory\n");
+        return 2;
+    }
+
+    timeLimit = (uint64_t)(afesimConfig.timeLimit * AFESIM_CLOCK_HZ);
+    atexit(main_Report);
+
+    return openeit_main();
+}
+
+/*
+** EOF
+*/
@@ -0,0 +1,261 @@
+/*!
+ *****************************************************************************
+ * @file:   afesim_network.c
+ * @brief:  Impedance network seen through the electrode multiplexers
+ *
+ * Nodes 0 to 31 are the electrodes, node i being on channel i of every
+ * multiplexer; higher nodes are internal. Each electrode connects to its
+ * multiplexer channels through the same contact impedance. The network is
+ * solved for a unit current from the A+ to the A- electrode, and the result
+ * of the last solve is kept since consecutive DFTs share their quad.
+ *
+ * Network file, one item per line, '#' starts a comment:
+ *   edge a b R [C]     R ohms in parallel with C farads between nodes a, b
+ *   contact R [C]      electrode contact impedance
+ *   scale K            DFT codes per mV at the ADC input
+ *   phase P            system phase shift added to the DFT, in degrees
+ *****************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "afesim.h"
+
+/* Branch of the network */
+typedef struct {
+    uint32_t                a;
+    uint32_t                b;
+    double                  r;
+    double                  c;
+} NETWORK_EDGE;
+
+/* Default network: a ring of 1k segments with 4k spokes to a centre node */
+#define NETWORK_RING_R              (1000.0)
+#define NETWORK_SPOKE_R             (4000.0)
+#define NETWORK_CONTACT_R           (1000.0)
+#define NETWORK_CONTACT_C           (100e-9)
+#define NETWORK_SCALE               (1.0)
+#define NETWORK_PHASE               (30.0)
+/* Leakage of every node to the return electrode, so floating nodes stay solvable */
+#define NETWORK_LEAK_S              (1e-12)
+
+static NETWORK_EDGE         networkEdges[AFESIM_MAX_EDGES];
+static uint32_t             networkEdgeCount;
+static uint32_t             networkNodeCount;
+static double               networkContactR = NETWORK_CONTACT_R;
+static double               networkContactC = NETWORK_CONTACT_C;
+static double               networkScale    = NETWORK_SCALE;
+static double               networkPhase    = NETWORK_PHASE;
+
+/* Last solve */
+static uint32_t             solvedA = AFESIM_MAX_NODES;
+static uint32_t             solvedB;
+static double               solvedFreq;
+static double complex       solvedV[AFESIM_MAX_NODES];
+
+static int                  network_Add             (uint32_t a, uint32_t b, double r, double c);
+static void                 network_Default         (void);
+static double complex       network_Admittance      (double r, double c, double freq);
+static void                 network_Solve           (uint32_t a, uint32_t b, double freq);
+
+static int network_Add(uint32_t a, uint32_t b, double r, double c) {
+    if ((networkEdgeCount >= AFESIM_MAX_EDGES) || (a >= AFESIM_MAX_NODES) || (b >= AFESIM_MAX_NODES) ||
+        (a == b) || (r <= 0.0)) {
+        return -1;
+    }
+
+    networkEdges[networkEdgeCount].a = a;
+    networkEdges[networkEdgeCount].b = b;
+    networkEdges[networkEdgeCount].r = r;
+    networkEdges[networkEdgeCount].c = c;
+    networkEdgeCount++;
+
+    if (a >= networkNodeCount) {
+        networkNodeCount = a + 1u;
+    }
+    if (b >= networkNodeCount) {
+        networkNodeCount = b + 1u;
+    }
+
+    return 0;
+}
+
+static void network_Default(void) {
+    uint32_t                i;
+
+    for (i = 0; i < AFESIM_ELECTRODES; i++) {
+        network_Add(i, (i + 1u) % AFESIM_ELECTRODES, NETWORK_RING_R, 0.0);
+        network_Add(i, AFESIM_ELECTRODES, NETWORK_SPOKE_R, 0.0);
+    }
+}
+
+static double complex network_Admittance(double r, double c, double freq) {
+    return (1.0 / r) + I * 2.0 * M_PI * freq * c;
+}
+
+/* Node voltages for a unit current into a and out of b, b grounded */
+static void network_Solve(uint32_t a, uint32_t b, double freq) {
+    static double complex   y[AFESIM_MAX_NODES][AFESIM_MAX_NODES + 1u];
+    double complex          factor, swap;
+    uint32_t                n = networkNodeCount;
+    uint32_t                i, j, k, pivot;
+
+    if ((a == solvedA) && (b == solvedB) && (freq == solvedFreq)) {
+        return;
+    }
+
+    memset(y, 0, sizeof(y));
+    for (i = 0; i < networkEdgeCount; i++) {
+        factor = network_Admittance(networkEdges[i].r, networkEdges[i].c, freq);
+        y[networkEdges[i].a][networkEdges[i].a] += factor;
+        y[networkEdges[i].b][networkEdges[i].b] += factor;
+        y[networkEdges[i].a][networkEdges[i].b] -= factor;
+        y[networkEdges[i].b][networkEdges[i].a] -= factor;
+    }
+    for (i = 0; i < n; i++) {
+        y[i][i] += NETWORK_LEAK_S;
+        y[i][n]  = 0.0;
+    }
+    /* Ground b, inject into a */
+    for (j = 0; j <= n; j++) {
+        y[b][j] = 0.0;
+    }
+    y[b][b] = 1.0;
+    y[a][n] = (a != b) ? 1.0 : 0.0;
+
+    /* Gaussian elimination with partial pivoting */
+    for (k = 0; k < n; k++) {
+        pivot = k;
+        for (i = k + 1u; i < n; i++) {
+            if (cabs(y[i][k]) > cabs(y[pivot][k])) {
+                pivot = i;
+            }
+        }
+        for (j = k; j <= n; j++) {
+            swap = y[k][j]; y[k][j] = y[pivot][j]; y[pivot][j] = swap;
+        }
+        for (i = k + 1u; i < n; i++) {
+            factor = y[i][k] / y[k][k];
+            for (j = k; j <= n; j++) {
+                y[i][j] -= factor * y[k][j];
+            }
+        }
+    }
+    for (i = n; i-- > 0u;) {
+        factor = y[i][n];
+        for (j = i + 1u; j < n; j++) {
+            factor -= y[i][j] * solvedV[j];
+        }
+        solvedV[i] = factor / y[i][i];
+    }
+
+    solvedA    = a;
+    solvedB    = b;
+    solvedFreq = freq;
+}
+
+/*!
+ * @brief       Load the network from a file, or the default network.
+ *
+ * @param[in]   pPath       Network file, NULL for the default network.
+ *
+ * @return      0, or -1 after printing the offending line.
+ */
+int afesim_NetworkLoad(const char *pPath) {
+    FILE                   *pFile;
+    char                    line[256];
+    char                    keyword[16];
+    unsigned                a, b;
+    double                  r, c;
+    int                     fields;
+    uint32_t                lineNumber = 0;
+
+    networkEdgeCount = 0;
+    networkNodeCount = AFESIM_ELECTRODES;
+    solvedA          = AFESIM_MAX_NODES;
+
+    if (NULL == pPath) {
+        network_Default();
+        return 0;
+    }
+
+    if (NULL == (pFile = fopen(pPath, "r"))) {
+        perror(pPath);
+        return -1;
+    }
+
+    while (NULL != fgets(line, sizeof(line), pFile)) {
+        lineNumber++;
+        line[strcspn(line, "#")] = '\0';
+        if (1 != sscanf(line, "%15s", keyword)) {
+            continue;
+        }
+
+        c = 0.0;
+        if (0 == strcmp(keyword, "edge")) {
+            fields = sscanf(line, "%*s %u %u %lf %lf", &a, &b, &r, &c);
+            if ((fields >= 3) && (0 == network_Add(a, b, r, c))) {
+                continue;
+            }
+        }
+        else if (0 == strcmp(keyword, "contact")) {
+            fields = sscanf(line, "%*s %lf %lf", &r, &c);
+            if ((fields >= 1) && (r > 0.0)) {
+                networkContactR = r;
+                networkContactC = c;
+                continue;
+            }
+        }
+        else if (0 == strcmp(keyword, "scale")) {
+            if (1 == sscanf(line, "%*s %lf", &networkScale)) {
+                continue;
+            }
+        }
+        else if (0 == strcmp(keyword, "phase")) {
+            if (1 == sscanf(line, "%*s %lf", &networkPhase)) {
+                continue;
+            }
+        }
+
+        fprintf(stderr, "%s:%u: invalid line\n", pPath, lineNumber);
+        fclose(pFile);
+        return -1;
+    }
+
+    fclose(pFile);
+
+    return 0;
+}
+
+/*!
+ * @brief       Transfer impedance of a quad.
+ *
+ * @param[in]   a, b        A+ and A- channels.
+ * @param[in]   m, n        V+ and V- channels.
+ * @param[in]   freq        Excitation frequency in Hz.
+ * @param[out]  pLoop       Impedance of the excitation loop, both contacts included.
+ *
+ * @return      Voltage between m and n for a unit current from a to b.
+ */
+double complex afesim_NetworkTransfer(uint32_t a, uint32_t b, uint32_t m, uint32_t n,
+                                      double freq, double complex *pLoop) {
+    double complex          contact = 1.0 / network_Admittance(networkContactR, networkContactC, freq);
+
+    network_Solve(a, b, freq);
+    *pLoop = (2.0 * contact) + (solvedV[a] - solvedV[b]);
+
+    return solvedV[m] - solvedV[n];
+}
+
+double afesim_NetworkScale(void) {
+    return networkScale;
+}
+
+double afesim_NetworkPhase(void) {
+    return networkPhase;
+}
+
+/*
+** EOF
+*/
@@ -0,0 +1,148 @@
+/*!
+ *****************************************************************************
+ * @file:   afesim_usb.c
+ * @brief:  Simulated uC/USB-Device stack with the vendor function of usb_stream.c
+ *
+ * With -u, a host configures the function as soon as the device starts and
+ * reads its bulk IN endpoint into the file. A transfer is written to the
+ * file at once and completes after its full speed packets, 64 bytes each
+ * and at most 19 per 1 ms frame, plus a zero length packet when it ends on
+ * a packet boundary. The completion callback runs as the interrupt would,
+ * when simulated time passes it. As with the ADuCM350 port, which does not
+ * queue transfers, one transfer at a time can be on the endpoint. Without
+ * -u no host is attached.
+ *****************************************************************************/
+
+#include <stddef.h>
+
+#include "usbd_vendor.h"
+#include "usbd_drv_adi.h"
+#include "usbd_bsp_dev.h"
+
+#include "afesim.h"
+
+/* Full speed bulk packets */
+#define USB_PACKET_SIZE             (64u)
+#define USB_PACKET_CYCLES           (AFESIM_CLOCK_HZ / 19000u)
+
+/* Transfer on the bulk IN endpoint */
+typedef struct {
+    int                     bBusy;
+    uint64_t                done;           /*!< Time the last packet is sent           */
+    CPU_INT08U              classNbr;
+    void                   *pBuf;
+    CPU_INT32U              bufLen;
+    USBD_VENDOR_ASYNC_FNCT  asyncFnct;
+    void                   *pAsyncArg;
+} USB_TRANSFER;
+
+const USBD_DRV_API          USBD_DrvAPI_ADI = { NULL };
+const USBD_DRV_BSP_API      USBD_DrvBSP_ADI = { NULL };
+const USBD_DRV_EP_INFO      USBD_DrvEP_InfoTbl_MUSBMHDRC[] = {
+    {0u, 0u, 0u},
+};
+
+static int                  usbStarted;
+static USB_TRANSFER         usbTransfer;
+
+/*!
+ * @brief       Complete the bulk IN transfer once its last packet is sent, as the interrupt does.
+ */
+void afesim_UsbService(void) {
+    USB_TRANSFER            xfer = usbTransfer;
+
+    if (usbTransfer.bBusy && (usbTransfer.done <= afesimStats.now)) {
+        usbTransfer.bBusy = 0;
+        if (NULL != xfer.asyncFnct) {
+            xfer.asyncFnct(xfer.classNbr, xfer.pBuf, xfer.bufLen, xfer.bufLen, xfer.pAsyncArg, USBD_ERR_NONE);
+        }
+    }
+}
+
+/*!
+ * @brief       Time of the next USB interrupt.
+ *
+ * @return      The end of the transfer on the bulk IN endpoint, 0 if there is none.
+ */
+uint64_t afesim_UsbEventTime(void) {
+    return usbTransfer.bBusy ? usbTransfer.done : 0u;
+}
+
+/* Core */
+
+void USBD_Init(USBD_ERR *p_err) {
+    *p_err = USBD_ERR_NONE;
+}
+
+CPU_INT08U USBD_DevAdd(USBD_DEV_CFG *p_dev_cfg, USBD_BUS_FNCTS *p_bus_fnct, USBD_DRV_API *p_drv_api,
+                       USBD_DRV_CFG *p_drv_cfg, USBD_DRV_BSP_API *p_bsp_api, USBD_ERR *p_err) {
+    *p_err = ((NULL == p_dev_cfg) || (NULL == p_drv_cfg) || (USBD_DEV_SPD_FULL != p_drv_cfg->Spd))
+           ? USBD_ERR_INVALID_ARG : USBD_ERR_NONE;
+    return 0;
+}
+
+CPU_INT08U USBD_CfgAdd(CPU_INT08U dev_nbr, CPU_INT08U attrib, CPU_INT16U max_pwr, USBD_DEV_SPD spd,
+                       const CPU_CHAR *p_name, USBD_ERR *p_err) {
+    *p_err = (USBD_DEV_SPD_FULL == spd) ? USBD_ERR_NONE : USBD_ERR_INVALID_ARG;
+    return 0;
+}
+
+void USBD_DevStart(CPU_INT08U dev_nbr, USBD_ERR *p_err) {
+    usbStarted = 1;
+    *p_err     = USBD_ERR_NONE;
+}
+
+/* Vendor class */
+
+void USBD_Vendor_Init(USBD_ERR *p_err) {
+    *p_err = USBD_ERR_NONE;
+}
+
+CPU_INT08U USBD_Vendor_Add(CPU_BOOLEAN intr_en, CPU_INT16U interval, USBD_VENDOR_REQ_FNCT req_callback,
+                           USBD_ERR *p_err) {
+    *p_err = USBD_ERR_NONE;
+    return 0;
+}
+
+CPU_BOOLEAN USBD_Vendor_CfgAdd(CPU_INT08U class_nbr, CPU_INT08U dev_nbr, CPU_INT08U cfg_nbr, USBD_ERR *p_err) {
+    *p_err = USBD_ERR_NONE;
+    return DEF_YES;
+}
+
+CPU_BOOLEAN USBD_Vendor_IsConn(CPU_INT08U class_nbr) {
+    return (usbStarted && (NULL != afesimConfig.pUsbOutput)) ? DEF_YES : DEF_NO;
+}
+
+void USBD_Vendor_WrAsync(CPU_INT08U class_nbr, void *p_buf, CPU_INT32U buf_len, USBD_VENDOR_ASYNC_FNCT async_fnct,
+                         void *p_async_arg, CPU_BOOLEAN end, USBD_ERR *p_err) {
+    uint32_t                packets;
+
+    if (DEF_YES != USBD_Vendor_IsConn(class_nbr)) {
+        *p_err = USBD_ERR_DEV_INVALID_STATE;
+        return;
+    }
+    if (usbTransfer.bBusy) {
+        afesim_Fatal("USB transfer queued on a busy endpoint, the ADuCM350 port does not queue transfers");
+    }
+
+    packets = (buf_len + USB_PACKET_SIZE - 1u) / USB_PACKET_SIZE;
+    if (end && (0u == (buf_len % USB_PACKET_SIZE))) {
+        packets++;
+    }
+    usbTransfer.bBusy     = 1;
+    usbTransfer.done      = afesimStats.now + (uint64_t)packets * USB_PACKET_CYCLES;
+    usbTransfer.classNbr  = class_nbr;
+    usbTransfer.pBuf      = p_buf;
+    usbTransfer.bufLen    = buf_len;
+    usbTransfer.asyncFnct = async_fnct;
+    usbTransfer.pAsyncArg = p_async_arg;
+    afesimStats.usbBytes += buf_len;
+    afesimStats.usbTransfers++;
+
+    fwrite(p_buf, 1, buf_len, afesimConfig.pUsbOutput);
+    *p_err = USBD_ERR_NONE;
+}
+
+/*
+** EOF
+*/
@@ -0,0 +1,19 @@
+/*!
+ *****************************************************************************
+ * @file:   arm_math.h
+ * @brief:  CMSIS DSP header of inc/, with its 32-bit pointer casts allowed
+ *
+ * The SIMD helpers of the CMSIS header cast pointers to 32-bit integers and
+ * back, which gcc warns about on a 64-bit host. The firmware does not call
+ * them; the warnings are allowed for this one header only.
+ *****************************************************************************/
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpointer-to-int-cast"
+#pragma GCC diagnostic ignored "-Wint-to-pointer-cast"
+#include_next <arm_math.h>
+#pragma GCC diagnostic pop
+
+/*
+** EOF
+*/
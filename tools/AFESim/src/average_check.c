@@ -0,0 +1,448 @@
+/*!
+ *****************************************************************************
+ * @file:   average_check.c
+ * @brief:  Checks of the frame averaging of average.c against long double references
+ *
+ * Usage: averagecheck [options]
+ *   -n runs        random ensembles (default 20000)
+ *   -s seed        random generator seed
+ *
+ * Ensembles of 1 to AVERAGE_MAX_FRAMES random frames, of small deviations,
+ * deviations up to AVERAGE_MAX_DEVIATION, any values and values at the
+ * clamp, are accumulated with average_Add(). Checks that:
+ *   - average_Mean() is the mean of the values, deviations from the first
+ *     frame clamped to AVERAGE_MAX_DEVIATION, within 0.5 LSB
+ *   - average_Variance() is their population variance, computed in two
+ *     passes, shifted right by the fractional bits of 28.4 or q31 and
+ *     saturated, within the truncations of S^2 / N and the shift
+ *   - a deviation past AVERAGE_MAX_DEVIATION counts as AVERAGE_MAX_DEVIATION,
+ *     and AVERAGE_MAX_FRAMES frames at the clamp, alternating in sign, are
+ *     still exact
+ *   - a frame past AVERAGE_MAX_FRAMES, past the capacity or of another count
+ *     than the first is rejected and accumulates nothing, and
+ *     average_Reset() starts a new ensemble
+ *   - without squared deviations, or without frames, nothing is returned
+ *   - with average_Wrap(), +179 and -179 degrees average to -180 with a
+ *     variance of 1, and phases spread up to 90 degrees around any centre
+ *     average to the centre plus their mean offset, wrapped into [-180, 180),
+ *     with the variance of the offsets, while the magnitudes between them,
+ *     deviating by more than a turn, are not wrapped
+ * Prints the largest errors, or the first failure and exits with 1.
+ *****************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "average.h"
+
+#define CHECK_CAPACITY              (64u)
+#define CHECK_KINDS                 (4u)
+#define CHECK_HALF_TURN             (180 * 16)      /* degrees in 28.4 */
+
+/* Largest errors seen, in LSB of the output */
+typedef struct {
+    long double             mean;
+    long double             variance28_4;
+    long double             varianceQ31;
+} CHECK_ERRORS;
+
+static int32_t              checkFrames[AVERAGE_MAX_FRAMES + 1u][CHECK_CAPACITY + 1u];
+static int32_t              checkFirst[CHECK_CAPACITY];
+static int64_t              checkSum[CHECK_CAPACITY];
+static uint64_t             checkSumSq[CHECK_CAPACITY];
+static int32_t              checkMean[CHECK_CAPACITY];
+static int32_t              checkVariance[CHECK_CAPACITY];
+static int32_t              checkOffsets[AVERAGE_MAX_FRAMES][CHECK_CAPACITY];
+static int32_t              checkCentres[CHECK_CAPACITY];
+static CHECK_ERRORS         checkErrors;
+
+static int32_t              check_Value             (uint32_t kind, int32_t first);
+static void                 check_Reference         (uint32_t frames, uint32_t column, long double *pMean,
+                                                     long double *pVariance);
+static int                  check_Ensemble          (const char *pName, uint32_t frames, uint32_t count,
+                                                     uint32_t fracBits, bool_t bSumSq);
+static int                  check_Random            (uint32_t runs);
+static int                  check_Clamp             (void);
+static int                  check_Limits            (void);
+static int32_t              check_Angle             (int64_t angle);
+static int                  check_Wrap              (uint32_t runs);
+
+/* A value of a frame after the first, of a kind of deviation */
+static int32_t check_Value(uint32_t kind, int32_t first) {
+    int64_t                 value;
+
+    if (0u == kind) {
+        value = (int64_t)first + mrand48() % 1000;
+    }
+    else if (1u == kind) {
+        value = (int64_t)first + (int64_t)(drand48() * 2.0 * AVERAGE_MAX_DEVIATION) - AVERAGE_MAX_DEVIATION;
+    }
+    else if (2u == kind) {
+        value = mrand48();
+    }
+    else {
+        /* At the clamp or one past it */
+        value = (int64_t)first + ((mrand48() & 1) ? 1 : -1) * (AVERAGE_MAX_DEVIATION + (mrand48() & 1));
+    }
+    if (value > INT32_MAX) {
+        value = INT32_MAX;
+    }
+    else if (value < INT32_MIN) {
+        value = INT32_MIN;
+    }
+
+    return (int32_t)value;
+}
+
+/* Two-pass mean and population variance of a column, deviations clamped */
+static void check_Reference(uint32_t frames, uint32_t column, long double *pMean, long double *pVariance) {
+    long double             x, sum = 0.0L, spread = 0.0L;
+    int64_t                 d;
+    uint32_t                k;
+
+    for (k = 0; k < frames; k++) {
+        d    = (int64_t)checkFrames[k][column] - checkFrames[0][column];
+        d    = (d > AVERAGE_MAX_DEVIATION) ? AVERAGE_MAX_DEVIATION : (d < -AVERAGE_MAX_DEVIATION) ?
+               -AVERAGE_MAX_DEVIATION : d;
+        sum += (long double)checkFrames[0][column] + (long double)d;
+    }
+    *pMean = sum / frames;
+    for (k = 0; k < frames; k++) {
+        d       = (int64_t)checkFrames[k][column] - checkFrames[0][column];
+        d       = (d > AVERAGE_MAX_DEVIATION) ? AVERAGE_MAX_DEVIATION : (d < -AVERAGE_MAX_DEVIATION) ?
+                  -AVERAGE_MAX_DEVIATION : d;
+        x       = (long double)checkFrames[0][column] + (long double)d - *pMean;
+        spread += x * x;
+    }
+    *pVariance = spread / frames;
+}
+
+/* Accumulate the first frames of checkFrames and compare with the references */
+static int check_Ensemble(const char *pName, uint32_t frames, uint32_t count, uint32_t fracBits, bool_t bSumSq) {
+    AVERAGE_ACCUMULATOR     acc;
+    long double             mean, variance, expect, error, bound;
+    uint32_t                k, i;
+
+    average_Init(&acc, checkFirst, checkSum, bSumSq ? checkSumSq : NULL, CHECK_CAPACITY);
+    for (k = 0; k < frames; k++) {
+        if (!average_Add(&acc, checkFrames[k], count)) {
+            fprintf(stderr, "%s: frame %u of %u values rejected\n", pName, k, count);
+            return 1;
+        }
+    }
+    if ((average_Mean(&acc, checkMean) != count) ||
+        (average_Variance(&acc, fracBits, checkVariance) != (bSumSq ? count : 0u))) {
+        fprintf(stderr, "%s: wrong number of means or variances\n", pName);
+        return 1;
+    }
+
+    /* The variance is (S^2 / N truncated, 1 LSB, then rounded by N) shifted, then floored */
+    bound = 1.5L / ldexpl(1.0L, (int)fracBits) + ((fracBits > 0u) ? 1.0L : 0.0L);
+    for (i = 0; i < count; i++) {
+        check_Reference(frames, i, &mean, &variance);
+        error = fabsl(checkMean[i] - mean);
+        if (error > 0.5L) {
+            fprintf(stderr, "%s, value %u of %u frames: mean %d, %.3Lf expected\n", pName, i, frames,
+                    checkMean[i], mean);
+            return 1;
+        }
+        checkErrors.mean = fmaxl(checkErrors.mean, error);
+        if (!bSumSq) {
+            continue;
+        }
+        expect = fminl(variance / ldexpl(1.0L, (int)fracBits), (long double)INT32_MAX);
+        error  = fabsl(checkVariance[i] - expect);
+        if (error > bound) {
+            fprintf(stderr, "%s, value %u of %u frames: variance %d, %.3Lf expected within %.3Lf\n", pName, i,
+                    frames, checkVariance[i], expect, bound);
+            return 1;
+        }
+        if (31u == fracBits) {
+            checkErrors.varianceQ31 = fmaxl(checkErrors.varianceQ31, error);
+        }
+        else if (4u == fracBits) {
+            checkErrors.variance28_4 = fmaxl(checkErrors.variance28_4, error);
+        }
+    }
+
+    return 0;
+}
+
+/* Random ensembles, of every size and kind of deviation */
+static int check_Random(uint32_t runs) {
+    uint32_t                run, frames, count, kind, k, i;
+    char                    name[48];
+
+    for (run = 0; run < runs; run++) {
+        frames = 1u + (uint32_t)lrand48() % AVERAGE_MAX_FRAMES;
+        count  = 1u + (uint32_t)lrand48() % CHECK_CAPACITY;
+        kind   = run % CHECK_KINDS;
+        for (i = 0; i < count; i++) {
+            checkFrames[0][i] = (kind < 2u) ? (int32_t)(mrand48() >> (lrand48() % 32)) : mrand48();
+            for (k = 1; k < frames; k++) {
+                checkFrames[k][i] = check_Value(kind, checkFrames[0][i]);
+            }
+        }
+        snprintf(name, sizeof(name), "random ensemble %u", run);
+        if (check_Ensemble(name, frames, count, ((run / CHECK_KINDS) & 1u) ? 31u : 4u, (run % 7u) != 0u)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* Deviations past the clamp, and the largest sums of squares */
+static int check_Clamp(void) {
+    AVERAGE_ACCUMULATOR     acc;
+    int32_t                 means[2][4];
+    uint32_t                j, k;
+
+    /* Deviations of AVERAGE_MAX_DEVIATION and one more average alike */
+    for (j = 0; j < 2u; j++) {
+        checkFrames[0][0] = 0;
+        checkFrames[0][1] = 0;
+        checkFrames[0][2] = INT32_MIN;
+        checkFrames[0][3] = INT32_MAX;
+        checkFrames[1][0] = AVERAGE_MAX_DEVIATION + (int32_t)j;
+        checkFrames[1][1] = -AVERAGE_MAX_DEVIATION - (int32_t)j;
+        checkFrames[1][2] = INT32_MIN + AVERAGE_MAX_DEVIATION + (int32_t)j;
+        checkFrames[1][3] = j ? INT32_MIN : (INT32_MAX - AVERAGE_MAX_DEVIATION);
+        average_Init(&acc, checkFirst, checkSum, checkSumSq, CHECK_CAPACITY);
+        if (!average_Add(&acc, checkFrames[0], 4) || !average_Add(&acc, checkFrames[1], 4) ||
+            (average_Mean(&acc, means[j]) != 4u)) {
+            fprintf(stderr, "clamp: frames rejected\n");
+            return 1;
+        }
+        if (check_Ensemble("clamp", 2, 4, 31, true)) {
+            return 1;
+        }
+    }
+    for (k = 0; k < 4u; k++) {
+        if (means[0][k] != means[1][k]) {
+            fprintf(stderr, "clamp, value %u: mean %d past the clamp, %d at it\n", k, means[1][k], means[0][k]);
+            return 1;
+        }
+    }
+
+    /* AVERAGE_MAX_FRAMES frames at the clamp, alternating, in both formats */
+    for (k = 0; k < AVERAGE_MAX_FRAMES; k++) {
+        for (j = 0; j < CHECK_CAPACITY; j++) {
+            checkFrames[k][j] = (0u == k) ? (int32_t)(j * 0x04000000u) :
+                                ((k + j) & 1u) ? INT32_MAX : INT32_MIN;
+        }
+    }
+    if (check_Ensemble("largest sums, 28.4", AVERAGE_MAX_FRAMES, CHECK_CAPACITY, 4, true) ||
+        check_Ensemble("largest sums, q31", AVERAGE_MAX_FRAMES, CHECK_CAPACITY, 31, true) ||
+        check_Ensemble("largest sums, integer", AVERAGE_MAX_FRAMES, CHECK_CAPACITY, 0, true)) {
+        return 1;
+    }
+
+    return 0;
+}
+
+/* Rejected frames accumulate nothing */
+static int check_Limits(void) {
+    AVERAGE_ACCUMULATOR     acc;
+    int32_t                 mean[CHECK_CAPACITY], variance[CHECK_CAPACITY];
+    uint32_t                k, i;
+
+    for (k = 0; k <= AVERAGE_MAX_FRAMES; k++) {
+        for (i = 0; i <= CHECK_CAPACITY; i++) {
+            checkFrames[k][i] = mrand48() >> 8;
+        }
+    }
+
+    average_Init(&acc, checkFirst, checkSum, checkSumSq, CHECK_CAPACITY);
+    if ((average_Mean(&acc, mean) != 0u) || (average_Variance(&acc, 4, variance) != 0u)) {
+        fprintf(stderr, "limits: values returned without frames\n");
+        return 1;
+    }
+    if (average_Add(&acc, checkFrames[0], CHECK_CAPACITY + 1u) || (acc.frames != 0u)) {
+        fprintf(stderr, "limits: a frame past the capacity is accepted\n");
+        return 1;
+    }
+
+    /* Frames of another count than the first, then the rest of the ensemble */
+    if (!average_Add(&acc, checkFrames[0], 8)) {
+        fprintf(stderr, "limits: first frame rejected\n");
+        return 1;
+    }
+    if (average_Add(&acc, checkFrames[AVERAGE_MAX_FRAMES], 7) ||
+        average_Add(&acc, checkFrames[AVERAGE_MAX_FRAMES], 9) || (acc.frames != 1u)) {
+        fprintf(stderr, "limits: a frame of another count is accepted\n");
+        return 1;
+    }
+    for (k = 1; k < AVERAGE_MAX_FRAMES; k++) {
+        if (!average_Add(&acc, checkFrames[k], 8)) {
+            fprintf(stderr, "limits: frame %u rejected\n", k);
+            return 1;
+        }
+    }
+
+    /* One frame too many, the mean and variance must not move */
+    average_Mean(&acc, mean);
+    average_Variance(&acc, 4, variance);
+    if (average_Add(&acc, checkFrames[AVERAGE_MAX_FRAMES], 8) || (acc.frames != AVERAGE_MAX_FRAMES)) {
+        fprintf(stderr, "limits: frame %u accepted\n", AVERAGE_MAX_FRAMES + 1u);
+        return 1;
+    }
+    if ((average_Mean(&acc, checkMean) != 8u) || (average_Variance(&acc, 4, checkVariance) != 8u)) {
+        fprintf(stderr, "limits: wrong number of means or variances\n");
+        return 1;
+    }
+    for (i = 0; i < 8u; i++) {
+        if ((mean[i] != checkMean[i]) || (variance[i] != checkVariance[i])) {
+            fprintf(stderr, "limits, value %u: a rejected frame was accumulated\n", i);
+            return 1;
+        }
+    }
+    if (check_Ensemble("limits", AVERAGE_MAX_FRAMES, 8, 4, true)) {
+        return 1;
+    }
+
+    /* After a reset, another count starts a new ensemble */
+    average_Reset(&acc);
+    if (!average_Add(&acc, checkFrames[1], 3) || (average_Mean(&acc, checkMean) != 3u) ||
+        (checkMean[0] != checkFrames[1][0]) || (checkMean[2] != checkFrames[1][2])) {
+        fprintf(stderr, "limits: no new ensemble after a reset\n");
+        return 1;
+    }
+
+    /* Without squared deviations, the mean only */
+    average_Init(&acc, checkFirst, checkSum, NULL, CHECK_CAPACITY);
+    if (!average_Add(&acc, checkFrames[0], 8) || (average_Variance(&acc, 4, checkVariance) != 0u)) {
+        fprintf(stderr, "limits: a variance without squared deviations\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+/* Angle wrapped into [-180, 180) degrees */
+static int32_t check_Angle(int64_t angle) {
+    angle %= 2 * CHECK_HALF_TURN;
+    if (angle >= CHECK_HALF_TURN) {
+        angle -= 2 * CHECK_HALF_TURN;
+    }
+    else if (angle < -CHECK_HALF_TURN) {
+        angle += 2 * CHECK_HALF_TURN;
+    }
+
+    return (int32_t)angle;
+}
+
+/* Phases averaged across the wrap at 180 degrees, magnitudes between them left alone */
+static int check_Wrap(uint32_t runs) {
+    AVERAGE_ACCUMULATOR     acc;
+    long double             mean, variance, error;
+    uint32_t                run, frames, k, i;
+
+    /* +179 and -179 degrees: -180, with a variance of 1 */
+    checkFrames[0][0] = 1000 * 16;
+    checkFrames[0][1] = 179 * 16;
+    checkFrames[1][0] = 1002 * 16;
+    checkFrames[1][1] = -179 * 16;
+    average_Init(&acc, checkFirst, checkSum, checkSumSq, CHECK_CAPACITY);
+    average_Wrap(&acc, 2, 2 * CHECK_HALF_TURN);
+    if (!average_Add(&acc, checkFrames[0], 2) || !average_Add(&acc, checkFrames[1], 2) ||
+        (average_Mean(&acc, checkMean) != 2u) || (average_Variance(&acc, 4, checkVariance) != 2u)) {
+        fprintf(stderr, "wrap: frames rejected\n");
+        return 1;
+    }
+    if ((checkMean[0] != 1001 * 16) || (checkMean[1] != -CHECK_HALF_TURN) || (checkVariance[0] != 16) ||
+        (checkVariance[1] != 16)) {
+        fprintf(stderr, "wrap: +179 and -179 degrees average to %d with a variance of %d, magnitude %d, "
+                "variance %d\n", checkMean[1], checkVariance[1], checkMean[0], checkVariance[0]);
+        return 1;
+    }
+
+    /* Random centres, phases within 90 degrees of them, magnitudes deviating by up to four turns */
+    for (run = 0; run < runs; run++) {
+        frames = 1u + (uint32_t)lrand48() % AVERAGE_MAX_FRAMES;
+        for (i = 0; i < CHECK_CAPACITY; i += 2u) {
+            checkCentres[i] = check_Angle(mrand48());
+            for (k = 0; k < frames; k++) {
+                checkOffsets[k][i]     = (int32_t)(mrand48() % (CHECK_HALF_TURN / 2));
+                checkFrames[k][i]      = 100000 + (int32_t)(lrand48() % (8 * CHECK_HALF_TURN));
+                checkFrames[k][i + 1u] = check_Angle((int64_t)checkCentres[i] + checkOffsets[k][i]);
+            }
+        }
+        average_Init(&acc, checkFirst, checkSum, checkSumSq, CHECK_CAPACITY);
+        average_Wrap(&acc, 2, 2 * CHECK_HALF_TURN);
+        for (k = 0; k < frames; k++) {
+            if (!average_Add(&acc, checkFrames[k], CHECK_CAPACITY)) {
+                fprintf(stderr, "wrap, run %u: frame %u rejected\n", run, k);
+                return 1;
+            }
+        }
+        average_Mean(&acc, checkMean);
+        average_Variance(&acc, 4, checkVariance);
+
+        for (i = 0; i < CHECK_CAPACITY; i += 2u) {
+            /* Magnitudes as without wrapping */
+            check_Reference(frames, i, &mean, &variance);
+            if ((fabsl(checkMean[i] - mean) > 0.5L) || (fabsl(checkVariance[i] - variance / 16.0L) > 1.5L / 16.0L + 1.0L)) {
+                fprintf(stderr, "wrap, run %u, value %u: magnitude %d, variance %d, %.3Lf and %.3Lf expected\n",
+                        run, i, checkMean[i], checkVariance[i], mean, variance / 16.0L);
+                return 1;
+            }
+
+            /* Phases: the centre plus the mean offset, wrapped, and the variance of the offsets */
+            mean = 0.0L;
+            for (k = 0; k < frames; k++) {
+                mean += checkOffsets[k][i];
+            }
+            mean    /= frames;
+            variance = 0.0L;
+            for (k = 0; k < frames; k++) {
+                variance += (checkOffsets[k][i] - mean) * (checkOffsets[k][i] - mean);
+            }
+            variance /= frames;
+            error     = fabsl((long double)check_Angle((int64_t)checkMean[i + 1u] - checkCentres[i]) - mean);
+            if ((error > 0.5L) || (fabsl(checkVariance[i + 1u] - variance / 16.0L) > 1.5L / 16.0L + 1.0L) ||
+                (checkMean[i + 1u] < -CHECK_HALF_TURN) || (checkMean[i + 1u] >= CHECK_HALF_TURN)) {
+                fprintf(stderr, "wrap, run %u, value %u of %u frames: phase %d, variance %d, centre %d plus "
+                        "%.3Lf and %.3Lf expected\n", run, i + 1u, frames, checkMean[i + 1u],
+                        checkVariance[i + 1u], checkCentres[i], mean, variance / 16.0L);
+                return 1;
+            }
+            checkErrors.mean = fmaxl(checkErrors.mean, error);
+        }
+    }
+
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    uint32_t                runs = 20000;
+    long                    seed = 1;
+    int                     opt;
+
+    while ((opt = getopt(argc, argv, "n:s:")) != -1) {
+        switch (opt) {
+        case 'n': runs = (uint32_t)strtoul(optarg, NULL, 0);        break;
+        case 's': seed = strtol(optarg, NULL, 0);                   break;
+        default:
+            fprintf(stderr, "usage: averagecheck [-n runs] [-s seed]\n");
+            return 1;
+        }
+    }
+    srand48(seed);
+
+    if (check_Clamp() || check_Limits() || check_Wrap(runs / 10u) || check_Random(runs)) {
+        return 1;
+    }
+    printf("%u ensembles, largest errors: mean %.3Lf LSB, variance %.3Lf LSB in 28.4, %.3Lf LSB in q31\n", runs,
+           checkErrors.mean, checkErrors.variance28_4, checkErrors.varianceQ31);
+    printf("frame averaging: clamp, frame and count limits, phase wrap and %u random ensembles passed\n", runs);
+    return 0;
+}
+
+/*
+** EOF
+*/
@@ -0,0 +1,16 @@
+/*!
+ *****************************************************************************
+ * @file:   cmsis_iar.h
+ * @brief:  Host stand-in for the IAR CMSIS header, see intrinsics.h
+ *****************************************************************************/
+
+#ifndef __CMSIS_IAR_H__
+#define __CMSIS_IAR_H__
+
+#include "intrinsics.h"
+
+#endif /* __CMSIS_IAR_H__ */
+
+/*
+** EOF
+*/
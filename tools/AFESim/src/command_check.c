@@ -0,0 +1,550 @@
+/*!
+ *****************************************************************************
+ * @file:   command_check.c
+ * @brief:  Checks of the command frame parser of command.c, and host side frames
+ *
+ * Usage: cmdcheck [options]
+ *   -n streams     random streams of the fuzz pass (default 2000)
+ *   -s seed        random generator seed
+ *   -v             print the fuzz statistics
+ *   -e frame       print the request opcode:tag[:hex payload], all hex,
+ *                  as afesim -k text, e.g. -e 8:1:20a10700, and exit
+ *   -r file        print the responses found in a UART output file, and exit
+ *
+ * The checks run the parser of command.c, as on the device, on fixed byte
+ * streams with the expected events: menu key lines, requests, and the
+ * requests answered with an error (CRC, version, length, opcode), each
+ * followed by a key or a request that must still be seen, and a request
+ * cut short, dropped by command_Timeout() so that the next one parses. The
+ * fuzz pass
+ * then parses random streams of menu keys, requests and requests with one
+ * byte changed, where every event must come out as sent, and random bytes
+ * followed by repeats of one request, which must be answered within
+ * CHECK_MAX_REPEATS repeats. Exits with 1 on the first failure.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "command.h"
+#include "eit_stream.h"
+
+#define CHECK_MAX_BYTES             (4096u)
+#define CHECK_MAX_EVENTS            (256u)
+#define CHECK_MAX_REPEATS           (6u)
+
+/* An event as the parser reports it, or as expected */
+typedef struct {
+    COMMAND_EVENT_TYPE      type;
+    uint8_t                 key;
+    uint8_t                 opcode;
+    uint8_t                 tag;
+    uint8_t                 status;
+    uint8_t                 length;
+    uint8_t                 payload[COMMAND_MAX_PAYLOAD];
+} CHECK_EVENT;
+
+/* A byte stream and the events expected from it */
+typedef struct {
+    uint8_t                 bytes[CHECK_MAX_BYTES];
+    uint32_t                size;
+    CHECK_EVENT             events[CHECK_MAX_EVENTS];
+    uint32_t                count;
+} CHECK_STREAM;
+
+static CHECK_STREAM         stream;
+static CHECK_EVENT          parsed[CHECK_MAX_EVENTS];
+
+static uint32_t             check_Random            (void);
+static void                 check_Key               (uint8_t key, int expected);
+static uint32_t             check_Request           (uint8_t opcode, uint8_t tag, const uint8_t *pPayload,
+                                                     uint8_t length, int expected);
+static void                 check_Error             (uint8_t status, uint8_t opcode, uint8_t tag);
+static void                 check_Bytes             (const char *pText);
+static uint32_t             check_Parse             (const uint8_t *pBytes, uint32_t size, CHECK_EVENT *pEvents);
+static int                  check_Compare           (const char *pName);
+static int                  check_Fixed             (void);
+static int                  check_Timeout           (void);
+static int                  check_Fuzz              (uint32_t streams, int verbose);
+static int                  check_Encode            (const char *pText);
+static int                  check_Responses         (const char *pPath);
+
+/* Random 32 bits */
+static uint32_t check_Random(void) {
+    return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+/* Append a menu key line, and its event if expected */
+static void check_Key(uint8_t key, int expected) {
+    stream.bytes[stream.size++] = key;
+    stream.bytes[stream.size++] = '\n';
+    if (expected) {
+        memset(&stream.events[stream.count], 0, sizeof(CHECK_EVENT));
+        stream.events[stream.count].type = COMMAND_EVENT_KEY;
+        stream.events[stream.count].key  = key;
+        stream.count++;
+    }
+}
+
+/* Append a request, and its event if expected; returns the offset of the frame */
+static uint32_t check_Request(uint8_t opcode, uint8_t tag, const uint8_t *pPayload, uint8_t length, int expected) {
+    uint32_t                offset = stream.size;
+    CHECK_EVENT            *pEvent = &stream.events[stream.count];
+
+    stream.size += command_Request(&stream.bytes[offset], opcode, tag, pPayload, length);
+    if (expected) {
+        memset(pEvent, 0, sizeof(*pEvent));
+        pEvent->type   = COMMAND_EVENT_REQUEST;
+        pEvent->opcode = opcode;
+        pEvent->tag    = tag;
+        pEvent->length = length;
+        if (length > 0u) {
+            memcpy(pEvent->payload, pPayload, length);
+        }
+        stream.count++;
+    }
+    return offset;
+}
+
+/* Expect an error event */
+static void check_Error(uint8_t status, uint8_t opcode, uint8_t tag) {
+    CHECK_EVENT            *pEvent = &stream.events[stream.count++];
+
+    memset(pEvent, 0, sizeof(*pEvent));
+    pEvent->type   = COMMAND_EVENT_ERROR;
+    pEvent->status = status;
+    pEvent->opcode = opcode;
+    pEvent->tag    = tag;
+}
+
+/* Append text bytes */
+static void check_Bytes(const char *pText) {
+    while ('\0' != *pText) {
+        stream.bytes[stream.size++] = (uint8_t)*pText++;
+    }
+}
+
+/* Run the parser over a byte stream, returns the number of events */
+static uint32_t check_Parse(const uint8_t *pBytes, uint32_t size, CHECK_EVENT *pEvents) {
+    COMMAND_PARSER          parser;
+    COMMAND_EVENT_TYPE      type;
+    uint32_t                i, count = 0;
+
+    command_Init(&parser);
+    for (i = 0; i < size; i++) {
+        type = command_Parse(&parser, pBytes[i]);
+        if ((COMMAND_EVENT_NONE == type) || (count == CHECK_MAX_EVENTS)) {
+            continue;
+        }
+        memset(&pEvents[count], 0, sizeof(CHECK_EVENT));
+        pEvents[count].type = type;
+        if (COMMAND_EVENT_KEY == type) {
+            pEvents[count].key = parser.key;
+        }
+        else {
+            pEvents[count].opcode = parser.request.opcode;
+            pEvents[count].tag    = parser.request.tag;
+        }
+        if (COMMAND_EVENT_REQUEST == type) {
+            pEvents[count].length = parser.request.length;
+            memcpy(pEvents[count].payload, parser.request.payload, parser.request.length);
+        }
+        if (COMMAND_EVENT_ERROR == type) {
+            pEvents[count].status = parser.status;
+        }
+        count++;
+    }
+    return count;
+}
+
+/* Parse the stream and compare the events with the expected ones, 0 if equal */
+static int check_Compare(const char *pName) {
+    uint32_t                count = check_Parse(stream.bytes, stream.size, parsed);
+    uint32_t                i;
+
+    if (count != stream.count) {
+        fprintf(stderr, "%s: %u events, %u expected\n", pName, count, stream.count);
+        return 1;
+    }
+    for (i = 0; i < count; i++) {
+        if (0 != memcmp(&parsed[i], &stream.events[i], sizeof(CHECK_EVENT))) {
+            fprintf(stderr, "%s: event %u is type %d key 0x%02x opcode %u tag %u status %u length %u,"
+                    " expected type %d key 0x%02x opcode %u tag %u status %u length %u\n", pName, i,
+                    parsed[i].type, parsed[i].key, parsed[i].opcode, parsed[i].tag, parsed[i].status,
+                    parsed[i].length, stream.events[i].type, stream.events[i].key, stream.events[i].opcode,
+                    stream.events[i].tag, stream.events[i].status, stream.events[i].length);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Fixed streams, 0 when all pass */
+static int check_Fixed(void) {
+    static const uint8_t    golden[] = { 0x45, 0x43, 0x01, 0x08, 0x2A, 0x04, 0x20, 0xA1, 0x07, 0x00 };
+    static const uint8_t    ping[]   = { '\n', 'E', 'C', '\n', 0x00, 0xFF };
+    uint8_t                 frame[COMMAND_RESPONSE_MAX_SIZE];
+    uint8_t                 payload[COMMAND_MAX_PAYLOAD];
+    uint16_t                size, crc;
+    uint32_t                offset;
+
+    /* The CRC is CRC-16/CCITT-FALSE: check value of "123456789" */
+    if (0x29B1u != stream_Crc16(0xFFFFu, (const uint8_t *)"123456789", 9u)) {
+        fprintf(stderr, "crc: check value 0x%04x\n", stream_Crc16(0xFFFFu, (const uint8_t *)"123456789", 9u));
+        return 1;
+    }
+
+    /* Request layout: SET_FREQUENCY 500000 Hz, tag 42 */
+    command_PutU32(payload, 500000u);
+    size = command_Request(frame, COMMAND_OPCODE_SET_FREQUENCY, 42u, payload, 4u);
+    crc  = stream_Crc16(0xFFFFu, &golden[2], sizeof(golden) - 2u);
+    if ((sizeof(golden) + 2u != size) || memcmp(frame, golden, sizeof(golden)) ||
+        (frame[10] != (uint8_t)crc) || (frame[11] != (uint8_t)(crc >> 8))) {
+        fprintf(stderr, "request: layout\n");
+        return 1;
+    }
+    if (500000u != command_GetU32(payload)) {
+        fprintf(stderr, "request: u32 field\n");
+        return 1;
+    }
+
+    /* Response layout: GET_STATUS answered with two bytes */
+    size = command_Response(frame, COMMAND_OPCODE_GET_STATUS, 7u, COMMAND_STATUS_OK, (const uint8_t *)"ok", 2u);
+    crc  = stream_Crc16(0xFFFFu, &frame[2], 7u);
+    if ((COMMAND_RESPONSE_OVERHEAD + 2u != size) || (COMMAND_SYNC0 != frame[0]) ||
+        (COMMAND_RESPONSE_SYNC1 != frame[1]) || (COMMAND_VERSION != frame[2]) ||
+        (COMMAND_OPCODE_GET_STATUS != frame[3]) || (7u != frame[4]) || (COMMAND_STATUS_OK != frame[5]) ||
+        (2u != frame[6]) || memcmp(&frame[7], "ok", 2u) ||
+        (frame[9] != (uint8_t)crc) || (frame[10] != (uint8_t)(crc >> 8))) {
+        fprintf(stderr, "response: layout\n");
+        return 1;
+    }
+
+    /* Menu keys: one character lines, '\r' ignored, longer lines ignored */
+    memset(&stream, 0, sizeof(stream));
+    check_Key('h', 1);
+    check_Bytes("d\r\n");
+    stream.events[stream.count].type  = COMMAND_EVENT_KEY;
+    stream.events[stream.count++].key = 'd';
+    check_Bytes("ab\n\n\r\n");
+    check_Key('E', 1);
+    check_Key('7', 1);
+    if (check_Compare("keys")) {
+        return 1;
+    }
+
+    /* Requests between keys, payload bytes that look like key lines and syncs */
+    memset(&stream, 0, sizeof(stream));
+    check_Key('h', 1);
+    check_Request(COMMAND_OPCODE_PING, 1u, ping, sizeof(ping), 1);
+    check_Key('j', 1);
+    check_Bytes("E");
+    check_Request(COMMAND_OPCODE_GET_STATUS, 2u, NULL, 0u, 1);
+    check_Request(COMMAND_OPCODE_STOP, 3u, NULL, 0u, 1);
+    memset(payload, '\n', COMMAND_MAX_PAYLOAD);
+    check_Request(COMMAND_OPCODE_PING, 4u, payload, COMMAND_MAX_PAYLOAD, 1);
+    check_Key('D', 1);
+    if (check_Compare("requests")) {
+        return 1;
+    }
+
+    /* Bad requests, each followed by one that must still be parsed */
+    memset(&stream, 0, sizeof(stream));
+    offset = check_Request(COMMAND_OPCODE_SET_MODE, 5u, (const uint8_t *)"\x03", 1u, 0);
+    stream.bytes[offset + 6u] ^= 0x01u;
+    check_Error(COMMAND_STATUS_BAD_CRC, COMMAND_OPCODE_SET_MODE, 5u);
+    check_Key('c', 1);
+    offset = check_Request(COMMAND_OPCODE_START, 6u, NULL, 0u, 0);
+    stream.bytes[offset + 2u] = 2u;
+    crc = stream_Crc16(0xFFFFu, &stream.bytes[offset + 2u], 4u);
+    stream.bytes[offset + 6u] = (uint8_t)crc;
+    stream.bytes[offset + 7u] = (uint8_t)(crc >> 8);
+    check_Error(COMMAND_STATUS_BAD_VERSION, COMMAND_OPCODE_START, 6u);
+    check_Request(COMMAND_OPCODE_START, 7u, NULL, 0u, 1);
+    check_Request(0x7Fu, 8u, NULL, 0u, 0);
+    check_Error(COMMAND_STATUS_BAD_OPCODE, 0x7Fu, 8u);
+    check_Request(0u, 9u, NULL, 0u, 0);
+    check_Error(COMMAND_STATUS_BAD_OPCODE, 0u, 9u);
+    check_Request(COMMAND_OPCODE_SET_OPTION, 10u, (const uint8_t *)"\x03", 1u, 0);
+    check_Error(COMMAND_STATUS_BAD_LENGTH, COMMAND_OPCODE_SET_OPTION, 10u);
+    check_Request(COMMAND_OPCODE_GET_STATUS, 11u, (const uint8_t *)"\x00", 1u, 0);
+    check_Error(COMMAND_STATUS_BAD_LENGTH, COMMAND_OPCODE_GET_STATUS, 11u);
+    /* A length beyond COMMAND_MAX_PAYLOAD ends the frame at the length byte */
+    stream.bytes[stream.size++] = COMMAND_SYNC0;
+    stream.bytes[stream.size++] = COMMAND_REQUEST_SYNC1;
+    stream.bytes[stream.size++] = COMMAND_VERSION;
+    stream.bytes[stream.size++] = COMMAND_OPCODE_PING;
+    stream.bytes[stream.size++] = 12u;
+    stream.bytes[stream.size++] = COMMAND_MAX_PAYLOAD + 1u;
+    check_Error(COMMAND_STATUS_BAD_LENGTH, COMMAND_OPCODE_PING, 12u);
+    check_Key('x', 1);
+    check_Request(COMMAND_OPCODE_SET_AVERAGE, 13u, (const uint8_t *)"\x02\x01", 2u, 1);
+    if (check_Compare("errors")) {
+        return 1;
+    }
+
+    /* A request cut short is completed by the next one and fails its CRC */
+    memset(&stream, 0, sizeof(stream));
+    check_Request(COMMAND_OPCODE_PING, 14u, (const uint8_t *)"abcd", 4u, 0);
+    stream.size -= 3u;
+    check_Request(COMMAND_OPCODE_GET_STATUS, 15u, NULL, 0u, 0);
+    check_Error(COMMAND_STATUS_BAD_CRC, COMMAND_OPCODE_PING, 14u);
+    check_Request(COMMAND_OPCODE_GET_STATUS, 16u, NULL, 0u, 1);
+    if (check_Compare("truncated")) {
+        return 1;
+    }
+
+    /* Unless the gap after it times out: it is dropped and the next one parses */
+    if (check_Timeout()) {
+        return 1;
+    }
+
+    return 0;
+}
+
+/* A request cut short at every byte, then a timeout, then a request, 0 when all pass */
+static int check_Timeout(void) {
+    COMMAND_PARSER          parser;
+    COMMAND_EVENT_TYPE      event = COMMAND_EVENT_NONE;
+    uint8_t                 frame[COMMAND_RESPONSE_MAX_SIZE];
+    uint16_t                size, next;
+    uint32_t                cut, i;
+
+    size = command_Request(frame, COMMAND_OPCODE_PING, 17u, (const uint8_t *)"abcd", 4u);
+    for (cut = 1; cut < size; cut++) {
+        command_Init(&parser);
+        for (i = 0; i < cut; i++) {
+            if (COMMAND_EVENT_NONE != command_Parse(&parser, frame[i])) {
+                fprintf(stderr, "timeout: an event after %u bytes of %u\n", i + 1u, size);
+                return 1;
+            }
+        }
+        if (!command_Pending(&parser)) {
+            fprintf(stderr, "timeout: no frame pending after %u bytes of %u\n", cut, size);
+            return 1;
+        }
+        command_Timeout(&parser);
+        if (command_Pending(&parser) || (1u != parser.errors)) {
+            fprintf(stderr, "timeout: frame cut at %u bytes of %u still pending, %u errors\n", cut, size,
+                    parser.errors);
+            return 1;
+        }
+        next = command_Request(frame, COMMAND_OPCODE_GET_STATUS, 18u, NULL, 0u);
+        for (i = 0; i < next; i++) {
+            if (COMMAND_EVENT_NONE != (event = command_Parse(&parser, frame[i]))) {
+                break;
+            }
+        }
+        if ((i + 1u != next) || (COMMAND_EVENT_REQUEST != event) || (COMMAND_OPCODE_GET_STATUS != parser.request.opcode) ||
+            (18u != parser.request.tag)) {
+            fprintf(stderr, "timeout: request after a frame cut at %u bytes of %u not parsed\n", cut, size);
+            return 1;
+        }
+        command_Timeout(&parser);
+        if (1u != parser.errors) {
+            fprintf(stderr, "timeout: a timeout between frames counted as an error\n");
+            return 1;
+        }
+        size = command_Request(frame, COMMAND_OPCODE_PING, 17u, (const uint8_t *)"abcd", 4u);
+    }
+
+    return 0;
+}
+
+/* Random streams, 0 when all pass */
+static int check_Fuzz(uint32_t streams, int verbose) {
+    static const uint8_t    keys[] = "abcdefghijklmnopqrstuvwxyz0123456789DF";
+    uint8_t                 payload[COMMAND_MAX_PAYLOAD];
+    COMMAND_PARSER          parser;
+    uint32_t                requests = 0, corrupted = 0, resyncs = 0, worst = 0;
+    uint32_t                n, i, k, kind, offset, size, length, repeats;
+    uint8_t                 opcode;
+
+    for (n = 0; n < streams; n++) {
+        /* Keys, requests, and requests with one byte after the sync changed, except the length */
+        memset(&stream, 0, sizeof(stream));
+        while ((stream.size + 2u * (COMMAND_REQUEST_OVERHEAD + COMMAND_MAX_PAYLOAD) < CHECK_MAX_BYTES) &&
+               (stream.count + 1u < CHECK_MAX_EVENTS)) {
+            kind = check_Random() % 10u;
+            if (kind < 3u) {
+                check_Key(keys[check_Random() % (sizeof(keys) - 1u)], 1);
+                continue;
+            }
+            opcode = (uint8_t)(1u + check_Random() % COMMAND_OPCODE_STOP);
+            length = (COMMAND_OPCODE_PING == opcode) ? check_Random() % (COMMAND_MAX_PAYLOAD + 1u)
+                   : (COMMAND_OPCODE_SET_FREQUENCY == opcode) ? 4u
+                   : ((COMMAND_OPCODE_SET_AVERAGE == opcode) || (COMMAND_OPCODE_SET_OPTION == opcode)) ? 2u
+                   : ((COMMAND_OPCODE_SET_MODE <= opcode) && (opcode <= COMMAND_OPCODE_SET_VALUES)) ? 1u : 0u;
+            for (i = 0; i < length; i++) {
+                payload[i] = (uint8_t)check_Random();
+            }
+            offset = check_Request(opcode, (uint8_t)check_Random(), payload, (uint8_t)length, kind >= 5u);
+            requests++;
+            if (kind < 5u) {
+                /* One byte changed: version, opcode, tag, payload or CRC */
+                size = COMMAND_REQUEST_OVERHEAD + length;
+                do {
+                    i = 2u + check_Random() % (size - 2u);
+                } while (5u == i);
+                stream.bytes[offset + i] ^= (uint8_t)(1u + check_Random() % 255u);
+                check_Error(COMMAND_STATUS_BAD_CRC, stream.bytes[offset + 3u], stream.bytes[offset + 4u]);
+                corrupted++;
+            }
+        }
+        if (check_Compare("fuzz")) {
+            return 1;
+        }
+
+        /* Random bytes, then one request repeated until it is parsed */
+        command_Init(&parser);
+        size = check_Random() % 64u;
+        for (i = 0; i < size; i++) {
+            command_Parse(&parser, (i % 7u) ? (uint8_t)check_Random() : COMMAND_SYNC0);
+        }
+        memset(&stream, 0, sizeof(stream));
+        check_Request(COMMAND_OPCODE_GET_STATUS, 0x5Au, NULL, 0u, 0);
+        for (repeats = 1; repeats <= CHECK_MAX_REPEATS; repeats++) {
+            for (k = 0, kind = COMMAND_EVENT_NONE; k < stream.size; k++) {
+                if (COMMAND_EVENT_REQUEST == command_Parse(&parser, stream.bytes[k])) {
+                    kind = COMMAND_EVENT_REQUEST;
+                }
+            }
+            if (COMMAND_EVENT_REQUEST == kind) {
+                break;
+            }
+        }
+        if (repeats > CHECK_MAX_REPEATS) {
+            fprintf(stderr, "fuzz: stream %u, no request parsed after %u repeats\n", n, CHECK_MAX_REPEATS);
+            return 1;
+        }
+        resyncs += repeats;
+        if (repeats > worst) {
+            worst = repeats;
+        }
+    }
+
+    if (verbose) {
+        printf("fuzz: %u streams, %u requests, %u changed, %.2f sends per request after noise, %u at most\n",
+               streams, requests, corrupted, (double)resyncs / streams, worst);
+    }
+    return 0;
+}
+
+/* Print a request as afesim -k text */
+static int check_Encode(const char *pText) {
+    uint8_t                 frame[COMMAND_REQUEST_OVERHEAD + COMMAND_MAX_PAYLOAD];
+    uint8_t                 payload[COMMAND_MAX_PAYLOAD];
+    unsigned                opcode, tag, byte;
+    uint32_t                length = 0, size, i;
+    const char             *pHex;
+    int                     used;
+
+    if (2 != sscanf(pText, "%x:%x", &opcode, &tag)) {
+        return 1;
+    }
+    pHex = strchr(strchr(pText, ':') + 1, ':');
+    if (NULL != pHex) {
+        pHex++;
+        while (('\0' != *pHex) && (1 == sscanf(pHex, "%2x%n", &byte, &used)) && (2 == used)) {
+            if (length == COMMAND_MAX_PAYLOAD) {
+                return 1;
+            }
+            payload[length++] = (uint8_t)byte;
+            pHex += 2;
+        }
+        if ('\0' != *pHex) {
+            return 1;
+        }
+    }
+
+    size = command_Request(frame, (uint8_t)opcode, (uint8_t)tag, payload, (uint8_t)length);
+    for (i = 0; i < size; i++) {
+        printf("\\x%02x", frame[i]);
+    }
+    printf("\n");
+    return 0;
+}
+
+/* Print the responses of a UART output file */
+static int check_Responses(const char *pPath) {
+    static uint8_t          data[1u << 22];
+    FILE                   *pFile = fopen(pPath, "rb");
+    size_t                  size, i, k;
+    uint16_t                crc;
+    uint32_t                length, found = 0, bad = 0;
+
+    if (NULL == pFile) {
+        perror(pPath);
+        return 1;
+    }
+    size = fread(data, 1, sizeof(data), pFile);
+    fclose(pFile);
+
+    for (i = 0; i + COMMAND_RESPONSE_OVERHEAD <= size; i++) {
+        if ((COMMAND_SYNC0 != data[i]) || (COMMAND_RESPONSE_SYNC1 != data[i + 1u]) ||
+            (COMMAND_VERSION != data[i + 2u])) {
+            continue;
+        }
+        length = data[i + 6u];
+        if ((length > COMMAND_MAX_PAYLOAD) || (i + COMMAND_RESPONSE_OVERHEAD + length > size)) {
+            continue;
+        }
+        crc = stream_Crc16(0xFFFFu, &data[i + 2u], (uint16_t)(5u + length));
+        if ((data[i + 7u + length] != (uint8_t)crc) || (data[i + 8u + length] != (uint8_t)(crc >> 8))) {
+            bad++;
+            continue;
+        }
+        printf("offset %zu: opcode %u tag %u status %u payload", i, data[i + 3u], data[i + 4u], data[i + 5u]);
+        for (k = 0; k < length; k++) {
+            printf(" %02x", data[i + 7u + k]);
+        }
+        printf("\n");
+        found++;
+        i += COMMAND_RESPONSE_OVERHEAD + length - 1u;
+    }
+    printf("%u responses, %u with a bad CRC\n", found, bad);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    uint32_t                streams = 2000;
+    unsigned                seed    = 1;
+    int                     verbose = 0;
+    int                     opt;
+
+    while ((opt = getopt(argc, argv, "n:s:ve:r:")) != -1) {
+        switch (opt) {
+        case 'n': streams = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 's': seed    = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'v': verbose = 1;                                  break;
+        case 'e':
+            if (check_Encode(optarg)) {
+                fprintf(stderr, "cmdcheck: bad frame %s, opcode:tag[:payload] in hex\n", optarg);
+                return 1;
+            }
+            return 0;
+        case 'r':
+            return check_Responses(optarg);
+        default:
+            fprintf(stderr, "usage: cmdcheck [-n streams] [-s seed] [-v] [-e opcode:tag[:payload]] [-r file]\n");
+            return 1;
+        }
+    }
+
+    srand(seed);
+    if (check_Fixed()) {
+        return 1;
+    }
+    if (check_Fuzz(streams, verbose)) {
+        return 1;
+    }
+    printf("command parser: fixed streams and %u random streams passed\n", streams);
+
+    return 0;
+}
+
+/*
+** EOF
+*/
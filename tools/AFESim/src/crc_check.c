@@ -0,0 +1,215 @@
+/*!
+ *****************************************************************************
+ * @file:   crc_check.c
+ * @brief:  Checks of the sequencer CRC8 variants of src/afe.c
+ *
+ * Usage: crccheck [options]
+ *   -n runs        timed passes over the sequences (default 20000)
+ *   -s seed        random generator seed
+ *
+ * adi_AFE_CalculateSequenceCRC() of src/afe.c is built once per
+ * ADI_AFE_CFG_SEQ_CRC_TABLE: 0 bitwise, 1 nibble table and 2 byte table
+ * (afe_crc.c). Checks that:
+ *   - the three give the same CRC for every sequence of sequences.h and
+ *     inc/afe_sequences.h, and for random sequences of up to 1024 commands
+ *   - they give the CRC in the safety word of every sequence of
+ *     inc/afe_sequences.h, worked out by Analog Devices
+ * Then prints the time per command of each on the host. The safety words of
+ * sequences.h mostly hold placeholder CRCs, as they are run with the
+ * software CRC; how many match is printed. The CRC engine of the ADuCM350
+ * only computes CRC-32 and is not one of the variants. Prints the first
+ * failure and exits with 1.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "afe.h"
+#include "sequences.h"
+#include "afe_sequences.h"
+
+#define CHECK_MAX_WORDS             (1025u)
+#define CHECK_RANDOM_RUNS           (1000u)
+#define CHECK_VARIANTS              (3u)
+
+/* adi_AFE_CalculateSequenceCRC() of each ADI_AFE_CFG_SEQ_CRC_TABLE */
+uint8_t                     afe_SequenceCrcBitwise  (const uint32_t *const txBuffer);
+uint8_t                     afe_SequenceCrcNibble   (const uint32_t *const txBuffer);
+uint8_t                     afe_SequenceCrcByte     (const uint32_t *const txBuffer);
+
+typedef uint8_t (*CHECK_CRC_FN)(const uint32_t *const txBuffer);
+
+/* A sequence and where it comes from */
+typedef struct {
+    const char             *pName;
+    const uint32_t         *pWords;
+    uint32_t                size;
+    bool_t                  bVendor;            /*!< inc/afe_sequences.h, with a real CRC               */
+} CHECK_SEQUENCE;
+
+#define CHECK_SEQ(seq, vendor)      { #seq, seq, sizeof(seq) / sizeof(seq[0]), vendor }
+
+static const CHECK_SEQUENCE checkSequences[] = {
+    CHECK_SEQ(seq_fast_2wire_bipolar,           false),
+    CHECK_SEQ(seq_afe_poweritup_bipolar,        false),
+    CHECK_SEQ(afe_powerup,                      false),
+    CHECK_SEQ(seq_afe_acmeas2wire,              false),
+    CHECK_SEQ(test_sequence1,                   false),
+    CHECK_SEQ(seq_afe_mux1,                     false),
+    CHECK_SEQ(seq_afe_poweritup,                false),
+    CHECK_SEQ(seq_afe_fast_meas_4wire,          false),
+    CHECK_SEQ(seq_afe_fast_acmeasBioZ_4wire,    false),
+    CHECK_SEQ(seq_afe_powerup,                  true),
+    CHECK_SEQ(seq_afe_auxchancal,               true),
+    CHECK_SEQ(seq_afe_auxchanmeas2,             true),
+    CHECK_SEQ(seq_afe_auxchanmeas1,             true),
+    CHECK_SEQ(seq_afe_tempsenschancal,          true),
+    CHECK_SEQ(seq_afe_tempsensmeas,             true),
+    CHECK_SEQ(seq_afe_excitechanpowerup,        true),
+    CHECK_SEQ(seq_afe_tiachancal1,              true),
+    CHECK_SEQ(seq_afe_tiachancal2,              true),
+    CHECK_SEQ(seq_afe_tiachancal3,              true),
+    CHECK_SEQ(seq_afe_tiachancal4,              true),
+    CHECK_SEQ(seq_afe_tiachancal5,              true),
+    CHECK_SEQ(seq_afe_excitechancalatten1,      true),
+    CHECK_SEQ(seq_afe_excitechancalatten2,      true),
+    CHECK_SEQ(seq_afe_excitechancalnoatten1,    true),
+    CHECK_SEQ(seq_afe_excitechancalnoatten2,    true),
+    CHECK_SEQ(seq_afe_acmeas10khz,              true),
+    CHECK_SEQ(seq_afe_dcmeas,                   true),
+};
+
+static const char          *checkNames[CHECK_VARIANTS]  = { "bitwise", "nibble table", "byte table" };
+static const CHECK_CRC_FN   checkCrcs[CHECK_VARIANTS]   = { afe_SequenceCrcBitwise, afe_SequenceCrcNibble,
+                                                            afe_SequenceCrcByte };
+static uint32_t             checkWords[CHECK_MAX_WORDS];
+static volatile uint8_t     checkSink;
+
+static int                  check_Agree             (const char *pName, const uint32_t *pWords, uint8_t *pCrc);
+static int                  check_Sequences         (void);
+static int                  check_Random            (void);
+static double               check_Time              (CHECK_CRC_FN crc, uint32_t runs);
+
+/* The three variants give the same CRC */
+static int check_Agree(const char *pName, const uint32_t *pWords, uint8_t *pCrc) {
+    uint8_t                 crcs[CHECK_VARIANTS];
+    uint32_t                i;
+
+    for (i = 0; i < CHECK_VARIANTS; i++) {
+        crcs[i] = checkCrcs[i](pWords);
+    }
+    if ((crcs[0] != crcs[1]) || (crcs[0] != crcs[2])) {
+        fprintf(stderr, "%s: %s 0x%02X, %s 0x%02X, %s 0x%02X\n", pName, checkNames[0], crcs[0], checkNames[1],
+                crcs[1], checkNames[2], crcs[2]);
+        return 1;
+    }
+    *pCrc = crcs[0];
+
+    return 0;
+}
+
+/* The sequences of the firmware and of the driver library */
+static int check_Sequences(void) {
+    const CHECK_SEQUENCE   *pSeq;
+    uint32_t                i, count, matched = 0, own = 0;
+    uint8_t                 crc;
+
+    for (i = 0; i < sizeof(checkSequences) / sizeof(checkSequences[0]); i++) {
+        pSeq  = &checkSequences[i];
+        count = (pSeq->pWords[0] & 0xFFFF0000u) >> 16;
+        if ((0u == count) || (count >= pSeq->size)) {
+            fprintf(stderr, "%s: %u commands in the safety word, %u words\n", pSeq->pName, count, pSeq->size);
+            return 1;
+        }
+        if (check_Agree(pSeq->pName, pSeq->pWords, &crc)) {
+            return 1;
+        }
+        if (pSeq->bVendor && (crc != (pSeq->pWords[0] & 0xFFu))) {
+            fprintf(stderr, "%s: CRC 0x%02X, the safety word holds 0x%02X\n", pSeq->pName, crc,
+                    pSeq->pWords[0] & 0xFFu);
+            return 1;
+        }
+        if (!pSeq->bVendor) {
+            own++;
+            matched += (crc == (pSeq->pWords[0] & 0xFFu)) ? 1u : 0u;
+        }
+    }
+    printf("%u sequences, the CRCs of inc/afe_sequences.h are reproduced, %u of %u of sequences.h match\n", i,
+           matched, own);
+
+    return 0;
+}
+
+/* Random sequences of every length */
+static int check_Random(void) {
+    uint32_t                run, i, count;
+    uint8_t                 crc;
+    char                    name[32];
+
+    for (run = 0; run < CHECK_RANDOM_RUNS; run++) {
+        count         = 1u + (uint32_t)rand() % (CHECK_MAX_WORDS - 1u);
+        checkWords[0] = count << 16;
+        for (i = 1; i <= count; i++) {
+            checkWords[i] = ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+        }
+        snprintf(name, sizeof(name), "random sequence %u", run);
+        if (check_Agree(name, checkWords, &crc)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* Nanoseconds per command of a variant over the sequences */
+static double check_Time(CHECK_CRC_FN crc, uint32_t runs) {
+    struct timespec         start, end;
+    uint64_t                commands = 0;
+    uint32_t                run, i;
+    uint8_t                 sum = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (run = 0; run < runs; run++) {
+        for (i = 0; i < sizeof(checkSequences) / sizeof(checkSequences[0]); i++) {
+            sum      ^= crc(checkSequences[i].pWords);
+            commands += (checkSequences[i].pWords[0] & 0xFFFF0000u) >> 16;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    checkSink = sum;
+
+    return ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / (commands ? commands : 1u);
+}
+
+int main(int argc, char *argv[]) {
+    uint32_t                runs = 20000;
+    uint32_t                i;
+    int                     opt;
+
+    srand(1);
+    while ((opt = getopt(argc, argv, "n:s:")) != -1) {
+        switch (opt) {
+        case 'n': runs = (uint32_t)strtoul(optarg, NULL, 0);        break;
+        case 's': srand((unsigned)strtoul(optarg, NULL, 0));        break;
+        default:
+            fprintf(stderr, "usage: crccheck [-n runs] [-s seed]\n");
+            return 1;
+        }
+    }
+
+    if (check_Sequences() || check_Random()) {
+        return 1;
+    }
+    for (i = 0; i < CHECK_VARIANTS; i++) {
+        printf("%-14s %6.2f ns per command\n", checkNames[i], check_Time(checkCrcs[i], runs));
+    }
+    printf("sequence CRC: the 3 variants agree on %u sequences and %u random ones\n",
+           (uint32_t)(sizeof(checkSequences) / sizeof(checkSequences[0])), CHECK_RANDOM_RUNS);
+    return 0;
+}
+
+/*
+** EOF
+*/
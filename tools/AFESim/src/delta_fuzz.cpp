@@ -0,0 +1,298 @@
+/*!
+ *****************************************************************************
+ * @file:   delta_fuzz.cpp
+ * @brief:  Round trip of the delta frames of eit_stream.c through the host decoder
+ *
+ * Usage: deltafuzz [options]
+ *   -n frames      frames per run (default 20000)
+ *   -s seed        random generator seed
+ *   -v             print every run
+ *
+ * Random frame streams are encoded by eit_stream.c, as on the device, and
+ * decoded by EitFrameDecoder of tools/EITStream. The values walk by random
+ * steps of 0 to 32 bits, jump, hit the int32 extremes or repeat; the frame
+ * layouts change, variance, excitation and multi-frequency frames come in
+ * between, some frames are put a value at a time, and delta frames are
+ * turned off and on. Every run uses its own key frame interval and
+ * reference capacity, and one run in two drops whole frames on the way.
+ * Two runs in four timestamp the frames, with their own key interval, by a
+ * tick that walks by random steps, backwards at times and across the 32-bit
+ * wrap; a key is unwrapped to the nearest of the last time, so the steps
+ * stay far below the 2^31 ticks a host can tell apart.
+ *
+ * Every decoded frame must hold the values it was sent with. Without drops
+ * every frame must be decoded; with drops, only delta frames may be lost,
+ * and only until the next key frame. A timestamped frame must decode to its
+ * tick, unwrapped as it was sent, or to no time after a dropped frame until
+ * the next key tick. Exits with 1 on the first mismatch.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <map>
+#include <vector>
+
+extern "C" {
+#include "eit_stream.h"
+}
+#include "EitFrame.h"
+
+using namespace std;
+
+#define FUZZ_RUNS                   (64)
+#define FUZZ_MAX_VALUES             (1024)
+
+/* A frame as it was sent */
+struct SentFrame
+{
+  uint8_t              flags;
+  vector<int32_t>      values;
+};
+
+static vector<uint8_t>      wire;
+static map<uint32_t, SentFrame> sent;
+static uint64_t             rawBytes;
+static uint64_t             wireBytes;
+
+static uint32_t             fuzz_Random             (void);
+static int32_t              fuzz_Step               (int32_t value);
+static void                 fuzz_Write              (uint8_t *pData, uint16_t size);
+static int                  fuzz_Run                (uint32_t run, uint32_t frames, bool verbose);
+
+/* Random 32 bits */
+static uint32_t fuzz_Random(void) {
+  return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+/* Next value of a walk: a step of 0 to 32 bits, mostly small ones */
+static int32_t fuzz_Step(int32_t value) {
+  uint32_t bits = fuzz_Random() % 33u;
+
+  if (fuzz_Random() % 4u) {
+    bits = bits % 8u;
+  }
+  if (0u == bits) {
+    return value;
+  }
+  return (int32_t)((uint32_t)value + (fuzz_Random() & (0xFFFFFFFFu >> (32u - bits))) - (1u << (bits - 1u)));
+}
+
+/* Stream output, one whole frame at a time by the end of stream_FrameEnd() */
+static void fuzz_Write(uint8_t *pData, uint16_t size) {
+  wire.insert(wire.end(), pData, pData + size);
+}
+
+/* One stream of frames, 0 when every frame decoded as sent */
+static int fuzz_Run(uint32_t run, uint32_t frames, bool verbose) {
+  static const uint16_t counts[]     = {1, 2, 3, 32, 64, 192, 384, 448, 896};
+  static const uint16_t capacities[] = {0, 64, 512, FUZZ_MAX_VALUES};
+  static int32_t        reference[FUZZ_MAX_VALUES];
+  static int32_t        values[FUZZ_MAX_VALUES];
+  static const uint32_t freqs[]      = {1000, 25000, 100000};
+
+  EitFrameDecoder       decoder;
+  EitFrame              frame;
+  uint16_t              keyFrames  = (uint16_t)(1u + fuzz_Random() % 24u);
+  uint16_t              capacity   = capacities[fuzz_Random() % 4u];
+  bool                  drops      = (run & 1u) != 0;
+  uint16_t              keyTicks   = (run & 2u) ? (uint16_t)(1u + fuzz_Random() % 24u) : 0u;
+  uint32_t              tick       = fuzz_Random();
+  uint64_t              time       = tick;
+  bool                  timeLost   = false;
+  bool                  delta      = true;
+  uint16_t              count      = counts[fuzz_Random() % 9u];
+  uint8_t               mode       = 4;
+  STREAM_FORMAT_TYPE    format     = STREAM_FORMAT_FIXED32;
+  uint32_t              decoded    = 0, dropped = 0, measurements = 0;
+  bool                  lost       = false;
+  uint32_t              i, k, kind, sequence = 0;
+
+  wire.clear();
+  sent.clear();
+  stream_Init(fuzz_Write);
+  stream_SetDelta(reference, capacity, keyFrames);
+  stream_SetTimestamps(keyTicks);
+  for (i = 0; i < count; i++) {
+    values[i] = (int32_t)fuzz_Random();
+  }
+
+  for (k = 0; k < frames; k++) {
+    SentFrame   expect;
+    bool        isDelta;
+    int32_t     step;
+    uint32_t    timeSize = 0;
+
+    // the tick of the frame, mostly forwards
+    kind = fuzz_Random() % 100u;
+    step = (kind < 2u) ? (int32_t)(fuzz_Random() >> 4) : ((kind < 5u) ? -(int32_t)(fuzz_Random() % 100000u)
+                                                                      : (int32_t)(fuzz_Random() % 2000000u));
+    tick += (uint32_t)step;
+    time += (uint64_t)(int64_t)step;
+    stream_SetTime(tick);
+
+    kind = fuzz_Random() % 100u;
+    if (kind < 2u) {
+      // a new layout
+      count  = counts[fuzz_Random() % 9u];
+      mode   = (uint8_t)(4u + fuzz_Random() % 3u);
+      format = (STREAM_FORMAT_TYPE)(fuzz_Random() % 4u);
+      stream_SetReduced((uint8_t)(fuzz_Random() % 2u));
+      for (i = 0; i < count; i++) {
+        values[i] = (int32_t)fuzz_Random();
+      }
+    }
+    else if (kind < 3u) {
+      delta = !delta;
+      stream_SetDelta(delta ? reference : NULL, capacity, keyFrames);
+    }
+
+    kind = fuzz_Random() % 100u;
+    if (kind < 5u) {
+      // variance, excitation or multi-frequency frame, never delta coded
+      vector<int32_t> other(1u + fuzz_Random() % 64u);
+      for (i = 0; i < other.size(); i++) {
+        other[i] = (int32_t)fuzz_Random();
+      }
+      if (kind < 2u) {
+        stream_FrameBeginVariance(mode, 16, format, (uint16_t)other.size(), freqs[0]);
+        expect.flags = STREAM_FLAG_VARIANCE;
+      }
+      else if (kind < 4u) {
+        stream_FrameBeginExcitation(mode, 16, (uint16_t)other.size(), freqs[1]);
+        expect.flags = STREAM_FLAG_EXCITATION;
+      }
+      else {
+        stream_FrameBeginMulti(mode, 16, format, (uint16_t)other.size(), freqs, 3);
+        expect.flags = STREAM_FLAG_MULTIFREQ;
+      }
+      for (i = 0; i < other.size(); i++) {
+        stream_FramePut(other[i]);
+      }
+      expect.values = other;
+    }
+    else {
+      // a measurement frame
+      kind = fuzz_Random() % 100u;
+      for (i = 0; i < count; i++) {
+        if (kind < 3u) {
+          values[i] = (fuzz_Random() & 1u) ? INT32_MAX : INT32_MIN;
+        }
+        else if (kind < 6u) {
+          values[i] = (int32_t)fuzz_Random();
+        }
+        else if (kind >= 20u) {
+          values[i] = fuzz_Step(values[i]);
+        }
+      }
+      stream_FrameBegin(mode, 16, format, count, freqs[1]);
+      if (fuzz_Random() % 50u) {
+        stream_FrameValues(values, count);
+      }
+      else {
+        for (i = 0; i < count; i++) {
+          stream_FramePut(values[i]);
+        }
+      }
+      expect.flags  = 0;
+      expect.values.assign(values, values + count);
+      measurements++;
+    }
+    stream_FrameEnd();
+
+    isDelta   = (wire.size() > 3u) && (wire[3] & STREAM_FLAG_DELTA);
+    if ((wire.size() > 2u) && (EitFrameDecoder::kVersionTime == wire[2])) {
+      while (wire[EitFrameDecoder::kHeaderSize + timeSize++] & 0x80u) {
+      }
+    }
+    rawBytes += EitFrameDecoder::kHeaderSize + timeSize + 4u * expect.values.size() + EitFrameDecoder::kCrcSize
+              + ((expect.flags & STREAM_FLAG_MULTIFREQ) ? 12u : 0u);
+    wireBytes += wire.size();
+    sent[sequence++] = expect;
+
+    // a dropped frame loses its delta frames until the next key frame
+    if (drops && (0u == fuzz_Random() % 40u)) {
+      dropped++;
+      lost     = true;
+      timeLost = true;
+      wire.clear();
+      continue;
+    }
+    if (timeSize && (wire[EitFrameDecoder::kHeaderSize] & 1u)) {
+      timeLost = false;
+    }
+    if (!isDelta && (0u == expect.flags)) {
+      lost = false;
+    }
+    decoder.Feed(&wire[0], wire.size());
+    wire.clear();
+    if (!decoder.Next(frame)) {
+      if (isDelta && lost) {
+        continue;
+      }
+      fprintf(stderr, "run %u: frame %u not decoded, delta %d\n", run, sequence - 1u, isDelta ? 1 : 0);
+      return 1;
+    }
+    if ((frame.sequence != sequence - 1u) ||
+        ((frame.flags & ~(STREAM_FLAG_FORMAT_MASK | STREAM_FLAG_REDUCED)) != expect.flags) ||
+        (frame.values != sent[frame.sequence].values)) {
+      fprintf(stderr, "run %u: frame %u decoded with other values, delta %d\n", run, frame.sequence,
+              isDelta ? 1 : 0);
+      return 1;
+    }
+    if ((keyTicks > 0u) != (frame.version == EitFrameDecoder::kVersionTime) ||
+        (frame.timeValid ? (frame.time != time) : (keyTicks && !timeLost))) {
+      fprintf(stderr, "run %u: frame %u decoded with time %llu, %s, sent at %llu\n", run, frame.sequence,
+              (unsigned long long)frame.time, frame.timeValid ? "valid" : "invalid", (unsigned long long)time);
+      return 1;
+    }
+    decoded++;
+  }
+  if (decoder.GetCrcErrors() || (!drops && (decoded != frames))) {
+    fprintf(stderr, "run %u: %lu crc errors, %u of %u frames decoded\n", run, decoder.GetCrcErrors(), decoded,
+            frames);
+    return 1;
+  }
+  if (verbose) {
+    printf("run %2u: key every %2u, capacity %4u, %u measurement frames, %u dropped, %lu delta errors, "
+           "key tick every %2u, %lu time errors\n", run, keyFrames, capacity, measurements, dropped,
+           decoder.GetDeltaErrors(), keyTicks, decoder.GetTimeErrors());
+  }
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  uint32_t              frames  = 20000;
+  unsigned              seed    = 1;
+  bool                  verbose = false;
+  uint32_t              run;
+  int                   opt;
+
+  while ((opt = getopt(argc, argv, "n:s:v")) != -1) {
+    switch (opt) {
+    case 'n': frames  = (uint32_t)strtoul(optarg, NULL, 0); break;
+    case 's': seed    = (unsigned)strtoul(optarg, NULL, 0); break;
+    case 'v': verbose = true;                               break;
+    default:
+      fprintf(stderr, "usage: deltafuzz [-n frames] [-s seed] [-v]\n");
+      return 1;
+    }
+  }
+
+  srand(seed);
+  for (run = 0; run < FUZZ_RUNS; run++) {
+    if (fuzz_Run(run, frames / FUZZ_RUNS + 1u, verbose)) {
+      return 1;
+    }
+  }
+  printf("%u runs, %llu bytes sent for %llu bytes of whole frames, %.1f %%\n", FUZZ_RUNS,
+         (unsigned long long)wireBytes, (unsigned long long)rawBytes, 100.0 * wireBytes / rawBytes);
+
+  return 0;
+}
+
+/*
+** EOF
+*/
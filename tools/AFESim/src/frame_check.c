@@ -0,0 +1,548 @@
+/*!
+ *****************************************************************************
+ * @file:   frame_check.c
+ * @brief:  Checks of the pipeline of frame_engine.c on a mock AFE driver
+ *
+ * Usage: framecheck [options]
+ *   -q quads       quads per frame (default 208, the 16 electrode plan)
+ *   -p us          CPU time of prepare(), the mux state of a quad (default 15)
+ *   -a us          CPU time of apply(), the mux GPIO writes (default 10)
+ *   -e us          CPU time of emit(), per sequence of a quad (default 40)
+ *   -l us          CPU time of starting, stopping and checking a sequence
+ *                  in the driver (default 25)
+ *   -v             print the frame times of each configuration
+ *
+ * frame_Run() runs on a mock of the AFE driver with a simulated clock: a
+ * sequence started with adi_AFE_RunSequence() starts once the launch time
+ * has passed and takes the seq_Cycles() of its words. Its commands are
+ * decoded for their interrupts: a DFT result comes at the command clearing
+ * DFT_EN, the Rx DMA callback at the result completing a DMA cycle, once
+ * per quad in block mode, and the generate callback at a CUSTOM_INT write
+ * when it is enabled. A firmware loop polling the sequencer advances the
+ * clock to its next event. The prepare, apply and emit callbacks advance
+ * the clock by their CPU time, the interrupt callbacks preempt them. The
+ * DFT results encode the quad the muxes were switched to and the sequence
+ * that measured them.
+ *
+ * For one sequence per quad, three per quad and blocks of quads:
+ *   - every sequence of every quad is emitted once, in order, with the
+ *     results measured on its own quad
+ *   - the muxes are never applied while the sequencer is running, and
+ *     never switched while it excites or converts
+ *   - the frame takes exactly the time of the pipeline: each sequence, or
+ *     block, lasts its launch plus the longer of its run and the CPU work
+ *     overlapped with it, plus the apply() that follows it
+ * The overlap printed is the part of the CPU time hidden behind the
+ * sequencer, and the blocks line the time saved, or lost, against one
+ * sequence per quad. Exits with 1 on the first failure.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "frame_engine.h"
+#include "modes.h"
+#include "seq_builder.h"
+#include "sequences.h"
+
+#define CHECK_CYCLES_PER_US         (SEQ_CLOCK_HZ / 1000000u)
+#define CHECK_MAX_SEQS              (3u)
+#define CHECK_MAX_QUADS             (512u)
+#define CHECK_SEQ_WORDS             (sizeof(seq_afe_fast_meas_4wire) / sizeof(seq_afe_fast_meas_4wire[0]))
+/* Interrupts of a running sequence: Rx DMA cycles and custom interrupts */
+#define CHECK_MAX_EVENTS            (2u * FRAME_BLOCK_MAX_RESULTS)
+
+/* Sequencer commands decoded by the mock */
+#define CHECK_CMD_WRITE             (0x80000000u)
+#define CHECK_CMD_OFFSET(cmd)       (((cmd) >> 23) & 0xFCu)
+#define CHECK_AFE_CFG               (0x00u)
+#define CHECK_AFE_CFG_LIVE          (0xC000u)               /* DFT_EN, WAVEGEN_EN */
+#define CHECK_AFE_CFG_DFT_EN        (0x8000u)
+#define CHECK_ANALOG_GEN_INT        (0xA4u)
+#define CHECK_GEN_INT_CUSTOM        (0x0008u)
+
+/* Interrupt raised by a command of the running sequence */
+typedef struct {
+    uint64_t                at;             /*!< Time the command executes                              */
+    bool_t                  bSwitch;        /*!< Custom interrupt, otherwise end of an Rx DMA cycle     */
+    bool_t                  bLive;          /*!< The excitation or a DFT is on after the command        */
+} CHECK_EVENT;
+
+/* Mock driver state: the simulated clock, the running sequence and the muxes */
+typedef struct {
+    uint64_t                now;            /*!< Simulated time, sequencer cycles                       */
+    bool_t                  bRunning;       /*!< A sequence was started and is not finished             */
+    uint64_t                end;            /*!< End of the running sequence                            */
+    uint64_t                seqTime;        /*!< Sequencer time of the frame                            */
+    uint32_t                rxCount;        /*!< Rx DMA cycles of the running sequence                  */
+    uint32_t                rxDone;         /*!< ... delivered                                          */
+    uint32_t                rxSize;         /*!< Results per Rx DMA cycle                               */
+    CHECK_EVENT             events[CHECK_MAX_EVENTS];   /*!< Interrupts of the running sequence         */
+    uint32_t                numEvents;
+    uint32_t                nextEvent;
+    bool_t                  bLive;          /*!< The interrupt being taken found the excitation on      */
+    uint64_t                start;          /*!< Start of the running sequence                          */
+    int16_t                *pRx;            /*!< Rx buffer of the running sequence                      */
+    uint32_t                seqIndex;       /*!< Sequence of the quad being run, non-block mode         */
+    ADI_CALLBACK            pfRxDma;
+    ADI_CALLBACK            pfGenerate;
+    uint32_t                genWatch;
+    uint32_t                genIen;
+    bool_t                  bBlocking;
+    bool_t                  bBlockDma;      /*!< Rx DMA in ping-pong mode, one cycle per quad           */
+    uint32_t                dmaSize;        /*!< Results per Rx DMA cycle in ping-pong mode             */
+    uint32_t                mux;            /*!< Quad the muxes are switched to                         */
+    uint32_t                firstQuad;      /*!< Quad the muxes were on when the sequence started       */
+    uint32_t                prepared;       /*!< Quad whose mux state was prepared last                 */
+    uint32_t                runs;           /*!< Sequences run in the frame                             */
+    uint32_t                runQuads[CHECK_MAX_QUADS * CHECK_MAX_SEQS];   /*!< Rx DMA cycles of each run   */
+    uint64_t                runCycles[CHECK_MAX_QUADS * CHECK_MAX_SEQS];  /*!< Sequencer cycles of each run */
+    uint32_t                errors;
+} CHECK_AFE;
+
+/* Expected pipeline of the frame being run */
+typedef struct {
+    uint32_t                numSeqs;
+    uint32_t                numQuads;
+    uint64_t                cpuTime;        /*!< CPU time of the callbacks                              */
+    uint64_t                launchTime;     /*!< CPU time of the driver starting the sequences          */
+    uint32_t                nextQuad;       /*!< Next quad and sequence to be emitted                   */
+    uint32_t                nextSeq;
+} CHECK_FRAME;
+
+static CHECK_AFE            afe;
+static CHECK_FRAME          frame;
+static uint8_t              afeDevice;
+static uint32_t             checkSeqWords[CHECK_MAX_SEQS][CHECK_SEQ_WORDS];
+static const uint32_t      *checkSeqs[CHECK_MAX_SEQS];
+static uint64_t             costPrepare, costApply, costEmit, costLaunch;
+static uint32_t             checkMaxFailures = 1;
+
+bool_t                      bench_bActive = false;
+
+static void                 check_Fail              (const char *pMessage, uint32_t quad, uint32_t seqIndex);
+static void                 check_Decode            (const uint32_t *seq, uint32_t size);
+static void                 check_Advance           (uint64_t until);
+static void                 check_Prepare           (uint32_t quad);
+static void                 check_Apply             (uint32_t quad);
+static void                 check_Switch            (uint32_t quad);
+static void                 check_Emit              (uint32_t quad, uint32_t seqIndex, int16_t *dft_results);
+static uint64_t             check_Expected          (uint32_t numSeqs, uint32_t numQuads, uint32_t blockQuads);
+static int                  check_Frame             (const char *pName, uint32_t numSeqs, uint32_t numQuads,
+                                                     uint32_t blockQuads, bool_t bVerbose, uint64_t *pTime);
+
+void bench_Mark(void) {
+}
+
+void bench_Stage(BENCH_STAGE_TYPE stage) {
+}
+
+/* seq_Commit() signs the block sequences, the mock does not check the CRC */
+uint8_t adi_AFE_CalculateSequenceCRC(const uint32_t *const txBuffer) {
+    return 0;
+}
+
+static void check_Fail(const char *pMessage, uint32_t quad, uint32_t seqIndex) {
+    if (afe.errors++ < checkMaxFailures) {
+        fprintf(stderr, "quad %u, sequence %u: %s\n", quad, seqIndex, pMessage);
+    }
+}
+
+/* Interrupts of a sequence started now: the ends of the Rx DMA cycles and the custom interrupts */
+static void check_Decode(const uint32_t *seq, uint32_t size) {
+    uint32_t                count = SEQ_COMMAND_COUNT(seq[0]);
+    uint32_t                afeCfg = 0;
+    uint32_t                results = 0;
+    uint64_t                at = afe.now;
+    uint32_t                i, cmd, offset;
+    CHECK_EVENT            *pEvent;
+
+    afe.numEvents = 0;
+    afe.nextEvent = 0;
+    for (i = 1; (i <= count) && (afe.numEvents < CHECK_MAX_EVENTS); i++) {
+        /* One cycle per command, plus the length of the waits, as seq_Cycles() */
+        cmd = seq[i];
+        at++;
+        if (SEQ_END_COMMAND == cmd) {
+            break;
+        }
+        if (0u == (cmd & 0xC0000000u)) {
+            at += cmd;
+            continue;
+        }
+        if (!(cmd & CHECK_CMD_WRITE)) {
+            continue;
+        }
+
+        pEvent = &afe.events[afe.numEvents];
+        offset = CHECK_CMD_OFFSET(cmd);
+        if (CHECK_AFE_CFG == offset) {
+            if ((afeCfg & CHECK_AFE_CFG_DFT_EN) && !(cmd & CHECK_AFE_CFG_DFT_EN) &&
+                (results < size) && (0u == ((results += 2u) % afe.rxSize))) {
+                pEvent->at      = at;
+                pEvent->bSwitch = false;
+                pEvent->bLive   = (cmd & CHECK_AFE_CFG_LIVE) ? true : false;
+                afe.numEvents++;
+            }
+            afeCfg = cmd;
+        }
+        else if ((CHECK_ANALOG_GEN_INT == offset) && (cmd & afe.genIen & afe.genWatch & CHECK_GEN_INT_CUSTOM) &&
+                 (NULL != afe.pfGenerate)) {
+            pEvent->at      = at;
+            pEvent->bSwitch = true;
+            pEvent->bLive   = (afeCfg & CHECK_AFE_CFG_LIVE) ? true : false;
+            afe.numEvents++;
+        }
+    }
+}
+
+/* Let the simulated time pass, the interrupts of the running sequence firing on the way */
+static void check_Advance(uint64_t until) {
+    const CHECK_EVENT      *pEvent;
+    uint32_t                i, cycle;
+    int16_t                *pRx;
+
+    while (afe.bRunning && (afe.nextEvent < afe.numEvents)) {
+        pEvent = &afe.events[afe.nextEvent];
+        if (pEvent->at > until) {
+            break;
+        }
+        if (pEvent->at > afe.now) {
+            afe.now = pEvent->at;
+        }
+        afe.nextEvent++;
+
+        if (pEvent->bSwitch) {
+            afe.bLive = pEvent->bLive;
+            afe.pfGenerate(NULL, 0, NULL);
+            afe.bLive = false;
+            continue;
+        }
+
+        /* Results measured on the muxes as they are now */
+        cycle = afe.rxDone;
+        pRx   = afe.bBlockDma ? &afe.pRx[(cycle & 1u) * afe.rxSize] : afe.pRx;
+        for (i = 0; i < afe.rxSize; i++) {
+            pRx[i] = (int16_t)((afe.mux << 6) | (afe.seqIndex * afe.rxSize + i));
+        }
+        afe.rxDone++;
+        if (NULL != afe.pfRxDma) {
+            afe.pfRxDma(NULL, 0, pRx);
+        }
+    }
+    if (until > afe.now) {
+        afe.now = until;
+    }
+}
+
+static void check_Prepare(uint32_t quad) {
+    afe.prepared = quad;
+    frame.cpuTime += costPrepare;
+    check_Advance(afe.now + costPrepare);
+}
+
+static void check_Apply(uint32_t quad) {
+    if (afe.bRunning) {
+        check_Fail("muxes applied while the sequencer is running", quad, 0);
+    }
+    if (afe.prepared != quad) {
+        check_Fail("muxes applied before their state was prepared", quad, 0);
+    }
+    afe.mux = quad;
+    frame.cpuTime += costApply;
+    check_Advance(afe.now + costApply);
+}
+
+/* Called from the custom interrupt while the sequencer waits for the switch */
+static void check_Switch(uint32_t quad) {
+    if (afe.bLive) {
+        check_Fail("muxes switched while the sequencer excites or converts", quad, 0);
+    }
+    if (afe.rxDone != (quad - afe.firstQuad)) {
+        check_Fail("muxes switched before the results of the previous quad", quad, 0);
+    }
+    afe.mux = quad;
+}
+
+static void check_Emit(uint32_t quad, uint32_t seqIndex, int16_t *dft_results) {
+    uint32_t                i;
+
+    if ((quad != frame.nextQuad) || (seqIndex != frame.nextSeq)) {
+        check_Fail("emitted out of order", quad, seqIndex);
+    }
+    for (i = 0; i < DFT_RESULTS_COUNT; i++) {
+        if (dft_results[i] != (int16_t)((quad << 6) | (seqIndex * DFT_RESULTS_COUNT + i))) {
+            check_Fail("results not measured on the quad", quad, seqIndex);
+            break;
+        }
+    }
+    if (++frame.nextSeq == frame.numSeqs) {
+        frame.nextSeq = 0;
+        frame.nextQuad++;
+    }
+    frame.cpuTime += costEmit;
+    check_Advance(afe.now + costEmit);
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_RegisterCallbackOnReceiveDMA(ADI_AFE_DEV_HANDLE const hDevice, ADI_CALLBACK const cbFunc,
+                                                         uint32_t cbWatch) {
+    afe.pfRxDma = cbFunc;
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_RegisterAfeCallback(ADI_AFE_DEV_HANDLE hDevice, ADI_AFE_INT_GROUP_TYPE group, ADI_CALLBACK cbFunc,
+                                                uint32_t cbWatch) {
+    if (ADI_AFE_INT_GROUP_GENERATE == group) {
+        afe.pfGenerate = cbFunc;
+        afe.genWatch   = cbWatch;
+    }
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_EnableInterruptSource(ADI_AFE_DEV_HANDLE const hDevice, ADI_AFE_INT_GROUP_TYPE group,
+                                                  uint32_t mask, bool_t bFlag) {
+    if (ADI_AFE_INT_GROUP_GENERATE == group) {
+        afe.genIen = bFlag ? (afe.genIen | mask) : (afe.genIen & ~mask);
+    }
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_SetRunSequenceBlockingMode(ADI_AFE_DEV_HANDLE const hDevice, const bool_t bFlag) {
+    afe.bBlocking = bFlag;
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_SetDmaRxBufferMaxSize(ADI_AFE_DEV_HANDLE const hDevice, uint16_t maxSizeFirst,
+                                                  uint16_t maxSizeSecond) {
+    afe.bBlockDma = (0u != maxSizeSecond) ? true : false;
+    afe.dmaSize   = maxSizeFirst;
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_RunSequence(ADI_AFE_DEV_HANDLE const hDevice, const uint32_t *const txBuffer,
+                                        uint16_t *const rxBuffer, uint32_t size) {
+    uint32_t                i;
+
+    if (afe.bBlocking || afe.bRunning) {
+        check_Fail("sequence started in blocking mode or over a running one", afe.mux, 0);
+        return ADI_AFE_ERR_SEQ;
+    }
+
+    afe.seqIndex = 0;
+    for (i = 0; i < CHECK_MAX_SEQS; i++) {
+        if (txBuffer == checkSeqs[i]) {
+            afe.seqIndex = i;
+        }
+    }
+
+    /* Driver time before the sequencer starts, the stop and check are counted with it */
+    frame.launchTime += costLaunch;
+    check_Advance(afe.now + costLaunch);
+
+    afe.bRunning  = true;
+    afe.start     = afe.now;
+    afe.end       = afe.now + seq_Cycles(txBuffer);
+    afe.pRx       = (int16_t *)rxBuffer;
+    afe.rxSize    = (afe.bBlockDma && (0u != afe.dmaSize)) ? afe.dmaSize : size;
+    afe.rxCount   = size / afe.rxSize;
+    afe.rxDone    = 0;
+    afe.firstQuad = afe.mux;
+    check_Decode(txBuffer, size);
+    afe.seqTime += afe.end - afe.start;
+    afe.runQuads[afe.runs]  = afe.rxCount;
+    afe.runCycles[afe.runs] = afe.end - afe.start;
+    afe.runs++;
+    return ADI_AFE_SUCCESS;
+}
+
+/* Polled by frame_WaitSequence(): the loop spins until the next event of the sequencer */
+ADI_AFE_RESULT_TYPE adi_AFE_GetSeqError(ADI_AFE_DEV_HANDLE const hDevice) {
+    uint64_t                next;
+
+    if (afe.bRunning) {
+        next = (afe.nextEvent < afe.numEvents) ? afe.events[afe.nextEvent].at : afe.end;
+        check_Advance(next);
+    }
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_GetSeqFinished(ADI_AFE_DEV_HANDLE const hDevice, bool_t *const pbFlag) {
+    *pbFlag = (afe.now >= afe.end) ? true : false;
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_SetSeqState(ADI_AFE_DEV_HANDLE const hDevice, ADI_AFE_SEQ_STATE_TYPE seqState) {
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_SeqStop(ADI_AFE_DEV_HANDLE const hDevice) {
+    if (!afe.bRunning || (afe.now < afe.end) || (afe.rxDone != afe.rxCount)) {
+        check_Fail("sequence stopped before its end or its results", afe.mux, afe.seqIndex);
+    }
+    afe.bRunning = false;
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_SeqAbort(ADI_AFE_DEV_HANDLE const hDevice) {
+    afe.bRunning = false;
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_SeqCheck(ADI_AFE_DEV_HANDLE const hDevice, const uint32_t *const txBuffer) {
+    return ADI_AFE_SUCCESS;
+}
+
+/* Frame time of the pipeline drawn in frame_engine.c, from the runs of the sequencer */
+static uint64_t check_Expected(uint32_t numSeqs, uint32_t numQuads, uint32_t blockQuads) {
+    uint64_t                total, work;
+    uint32_t                run, quads;
+    bool_t                  bNext;
+
+    /* The first mux state is not overlapped */
+    total = costPrepare + costApply;
+    quads = 0;
+
+    for (run = 0; run < afe.runs; run++) {
+        /* Emit of the previous sequence or block, and the mux state of the next quad */
+        work  = (run > 0u) ? (uint64_t)afe.runQuads[run - 1u] * ((0u != blockQuads) ? numSeqs : 1u) * costEmit : 0u;
+        quads += (0u != blockQuads) ? afe.runQuads[run] : (((run + 1u) % numSeqs) == 0u);
+        bNext  = (((0u != blockQuads) || (((run + 1u) % numSeqs) == 0u)) && (quads < numQuads)) ? true : false;
+        if (bNext) {
+            work += costPrepare;
+        }
+        total += costLaunch + ((work > afe.runCycles[run]) ? work : afe.runCycles[run]);
+        if (bNext) {
+            total += costApply;
+        }
+    }
+
+    return total + (uint64_t)afe.runQuads[afe.runs - 1u] * ((0u != blockQuads) ? numSeqs : 1u) * costEmit;
+}
+
+/* Run one frame on the mock and check it */
+static int check_Frame(const char *pName, uint32_t numSeqs, uint32_t numQuads, uint32_t blockQuads, bool_t bVerbose,
+                       uint64_t *pTime) {
+    FRAME_ENGINE_CONFIG     config = {
+        (ADI_AFE_DEV_HANDLE)&afeDevice, checkSeqs, numSeqs, DFT_RESULTS_COUNT, numQuads,
+        check_Prepare, check_Apply, check_Emit,
+        blockQuads, check_Switch, NULL
+    };
+    FRAME_ENGINE_STATS      stats;
+    ADI_AFE_RESULT_TYPE     result;
+    uint64_t                expected, serial, hidden;
+    double                  overlap;
+
+    memset(&afe, 0, sizeof(afe));
+    memset(&frame, 0, sizeof(frame));
+    afe.bBlocking  = true;
+    afe.mux        = ~0u;
+    afe.prepared   = ~0u;
+    frame.numSeqs  = numSeqs;
+    frame.numQuads = numQuads;
+
+    result = frame_Run(&config);
+    frame_GetStats(&stats);
+    if (ADI_AFE_SUCCESS != result) {
+        check_Fail("frame_Run() failed", frame.nextQuad, frame.nextSeq);
+    }
+    if ((frame.nextQuad != numQuads) || (0u != frame.nextSeq)) {
+        check_Fail("frame not emitted to its end", frame.nextQuad, frame.nextSeq);
+    }
+    if (afe.bRunning || !afe.bBlocking || afe.bBlockDma || (NULL != afe.pfRxDma) || (NULL != afe.pfGenerate) ||
+        (0u != afe.genIen)) {
+        check_Fail("driver not restored at the end of the frame", frame.nextQuad, frame.nextSeq);
+    }
+    if ((0u != blockQuads) && ((0u == stats.blockQuads) || (stats.blockQuads > blockQuads) ||
+                               (afe.runs != ((numQuads + stats.blockQuads - 1u) / stats.blockQuads)))) {
+        check_Fail("frame not measured in blocks", 0, 0);
+    }
+    if (0u != afe.errors) {
+        return 1;
+    }
+
+    expected = check_Expected(numSeqs, numQuads, blockQuads);
+    serial   = afe.seqTime + frame.cpuTime + frame.launchTime;
+    hidden   = serial - afe.now;
+    overlap  = (0u != frame.cpuTime) ? 100.0 * hidden / frame.cpuTime : 100.0;
+    if (afe.now != expected) {
+        fprintf(stderr, "%s: frame of %.1f us, the pipeline takes %.1f us\n", pName,
+                (double)afe.now / CHECK_CYCLES_PER_US, (double)expected / CHECK_CYCLES_PER_US);
+        return 1;
+    }
+
+    if (bVerbose) {
+        printf("%-22s %u runs, frame %.2f ms, sequencer %.2f ms, CPU %.2f ms, %.2f ms of it overlapped (%.1f %%)\n",
+               pName, afe.runs, (double)afe.now / (CHECK_CYCLES_PER_US * 1000u),
+               (double)afe.seqTime / (CHECK_CYCLES_PER_US * 1000u), (double)frame.cpuTime / (CHECK_CYCLES_PER_US * 1000u),
+               (double)hidden / (CHECK_CYCLES_PER_US * 1000u), overlap);
+    }
+    else {
+        printf("%-22s frame %.2f ms, %.1f %% of the CPU time overlapped\n", pName,
+               (double)afe.now / (CHECK_CYCLES_PER_US * 1000u), overlap);
+    }
+    *pTime = afe.now;
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    uint32_t                quads    = 208;
+    bool_t                  bVerbose = false;
+    uint64_t                single, multi, blocks;
+    double                  saved;
+    uint32_t                i;
+    int                     opt;
+
+    costPrepare = 15;
+    costApply   = 10;
+    costEmit    = 40;
+    costLaunch  = 25;
+    while ((opt = getopt(argc, argv, "q:p:a:e:l:v")) != -1) {
+        switch (opt) {
+        case 'q': quads       = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'p': costPrepare = strtoull(optarg, NULL, 0);          break;
+        case 'a': costApply   = strtoull(optarg, NULL, 0);          break;
+        case 'e': costEmit    = strtoull(optarg, NULL, 0);          break;
+        case 'l': costLaunch  = strtoull(optarg, NULL, 0);          break;
+        case 'v': bVerbose    = true;                               break;
+        default:
+            fprintf(stderr, "usage: framecheck [-q quads] [-p us] [-a us] [-e us] [-l us] [-v]\n");
+            return 1;
+        }
+    }
+    if ((0u == quads) || (quads > CHECK_MAX_QUADS)) {
+        fprintf(stderr, "framecheck: 1 to %u quads\n", CHECK_MAX_QUADS);
+        return 1;
+    }
+    costPrepare *= CHECK_CYCLES_PER_US;
+    costApply   *= CHECK_CYCLES_PER_US;
+    costEmit    *= CHECK_CYCLES_PER_US;
+    costLaunch  *= CHECK_CYCLES_PER_US;
+
+    /* Copies of one sequence, told apart by their address */
+    for (i = 0; i < CHECK_MAX_SEQS; i++) {
+        memcpy(checkSeqWords[i], seq_afe_fast_meas_4wire, sizeof(checkSeqWords[i]));
+        checkSeqs[i] = checkSeqWords[i];
+    }
+
+    if (check_Frame("1 sequence per quad:", 1, quads, 0, bVerbose, &single) ||
+        check_Frame("3 sequences per quad:", 3, quads, 0, bVerbose, &multi) ||
+        check_Frame("blocks of 8 quads:", 1, quads, 8, bVerbose, &blocks)) {
+        return 1;
+    }
+    saved = ((double)single - (double)blocks) / (CHECK_CYCLES_PER_US * 1000u);
+    if (saved < 0.0) {
+        saved = -saved;
+    }
+    printf("blocks: %.2f ms %s than one sequence per quad, %.2f us per quad with a %llu us launch\n",
+           saved, (blocks <= single) ? "faster" : "slower", 1000.0 * saved / quads,
+           (unsigned long long)(costLaunch / CHECK_CYCLES_PER_US));
+    printf("frame engine: %u quads in 3 configurations passed\n", quads);
+    return 0;
+}
+
+/*
+** EOF
+*/
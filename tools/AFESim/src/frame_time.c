@@ -0,0 +1,193 @@
+/*!
+ *****************************************************************************
+ * @file:   frame_time.c
+ * @brief:  Expected imaging frame time of a measurement plan
+ *
+ * Usage: frametime [options]
+ *   -e n_el        electrodes, as the imaging modes: 8, 16 or 32 opposition,
+ *                  anything else 32 adjacent (default 16)
+ *   -r             reduced plan, see pattern_Reduce()
+ *   -g             quads grouped by injection pair, sense-only quads run
+ *                  the shorter current settling
+ *   -b quads       quads per sequencer program, 0 for one per sequence
+ *   -f hz          excitation frequency (default 25000, FREQ of modes.h)
+ *   -d us          DFT window (default 12852)
+ *   -i us          ADC input settling (default 100)
+ *   -c us          current settling after an injection change (default 200)
+ *   -s us          current settling after a sense-only move (default 50)
+ *   -v us          voltage settling (default 12852)
+ *   -o us          CPU time per sequencer start, see the n) benchmark
+ *   -p             print the measurement order, one quad per line
+ *
+ * The sequences are built by seq_builder.c and timed by seq_Cycles(), one
+ * ACLK cycle per command plus the waits, as on the sequencer; the order and
+ * the reduced plan come from pattern.c, as on the device. The time does not
+ * include the UART output of the frame.
+ *****************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "frame_engine.h"
+#include "lookup.h"
+#include "pattern.h"
+#include "seq_builder.h"
+
+/* As modes.h and OpenEIT.c */
+#define TIME_FREQ                   (25000u)
+#define TIME_SENSE_SETTLE_US        (50u)
+
+static uint32_t             words[PATTERN_MAX_QUADS];
+static uint16_t             measured[PATTERN_MAX_QUADS];
+static int16_t              plan[PATTERN_MAX_QUADS];
+static uint16_t             order[PATTERN_MAX_QUADS];
+static uint32_t             seqFull[SEQ_4WIRE_LENGTH];
+static uint32_t             seqSense[SEQ_4WIRE_LENGTH];
+
+static const PATTERN_CONFIG *time_Pattern           (uint32_t n_el);
+static double               time_Frame              (uint32_t count, const uint16_t *pIndex, const uint16_t *pOrder,
+                                                     bool_t bGrouped, uint32_t blockQuads, double overheadUs);
+
+/* seq_Commit() signs the sequences, the CRC does not change their run time */
+uint8_t adi_AFE_CalculateSequenceCRC(const uint32_t *const txBuffer) {
+    return 0;
+}
+
+/* Pattern of the imaging modes, as mux_select_pattern() */
+static const PATTERN_CONFIG *time_Pattern(uint32_t n_el) {
+    if (8u == n_el) {
+        return &pattern_8_opposition;
+    }
+    if (16u == n_el) {
+        return &pattern_16_opposition;
+    }
+    if (32u == n_el) {
+        return &pattern_32_opposition;
+    }
+    return &pattern_32_adjacent;
+}
+
+/* Frame time in us of count quads measured in turn */
+static double time_Frame(uint32_t count, const uint16_t *pIndex, const uint16_t *pOrder,
+                         bool_t bGrouped, uint32_t blockQuads, double overheadUs) {
+    uint64_t                cycles = 0;
+    uint32_t                starts = 0;
+    uint32_t                i, k, word, previous = 0;
+
+    for (i = 0; i < count; i++) {
+        k    = (NULL != pOrder) ? pOrder[i] : i;
+        word = words[(NULL != pIndex) ? pIndex[k] : k];
+
+        if (bGrouped && (i > 0u) && (PATTERN_INJECTION(word) == PATTERN_INJECTION(previous))) {
+            cycles += seq_Cycles(seqSense);
+        }
+        else {
+            cycles += seq_Cycles(seqFull);
+        }
+        if ((0u == blockQuads) || (0u == (i % blockQuads))) {
+            starts++;
+        }
+        else {
+            /* The switch wait of a block takes the place of the end command of the previous quad */
+            cycles += seq_WaitCycles(FRAME_BLOCK_SWITCH_US);
+        }
+        previous = word;
+    }
+
+    return (double)cycles * 1e6 / SEQ_CLOCK_HZ + starts * overheadUs;
+}
+
+int main(int argc, char *argv[]) {
+    SEQ_TIMING              timing      = SEQ_TIMING_4WIRE_DEFAULT(TIME_FREQ);
+    SEQ_TIMING              sense;
+    uint32_t                n_el        = 16;
+    uint32_t                blockQuads  = 0;
+    uint32_t                senseUs     = TIME_SENSE_SETTLE_US;
+    double                  overheadUs  = 0.0;
+    bool_t                  bReduced    = false;
+    bool_t                  bGrouped    = false;
+    bool_t                  bPrint      = false;
+    const uint16_t         *pIndex      = NULL;
+    PATTERN_QUAD            quad;
+    uint32_t                count, total, i, k;
+    double                  baseUs, frameUs;
+    int                     opt;
+
+    while ((opt = getopt(argc, argv, "e:rgb:f:d:i:c:s:v:o:p")) != -1) {
+        switch (opt) {
+        case 'e': n_el                   = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'r': bReduced               = true;                               break;
+        case 'g': bGrouped               = true;                               break;
+        case 'b': blockQuads             = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'f': timing.frequency       = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'd': timing.dftTimeUs       = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'i': timing.inputSettleUs   = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'c': timing.currentSettleUs = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 's': senseUs                = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'v': timing.voltageSettleUs = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'o': overheadUs             = strtod(optarg, NULL);               break;
+        case 'p': bPrint                 = true;                               break;
+        default:
+            fprintf(stderr, "usage: frametime [-e n_el] [-r] [-g] [-b quads] [-f hz] [-d us] [-i us] [-c us] [-s us]"
+                            " [-v us] [-o us] [-p]\n");
+            return 1;
+        }
+    }
+    if (blockQuads > FRAME_BLOCK_MAX_RESULTS / SEQ_4WIRE_RESULTS) {
+        fprintf(stderr, "at most %u quads per sequence\n", FRAME_BLOCK_MAX_RESULTS / SEQ_4WIRE_RESULTS);
+        return 1;
+    }
+
+    /* The sense-only sequence, as settle_build() */
+    sense = timing;
+    if (sense.currentSettleUs > senseUs) {
+        sense.currentSettleUs = senseUs;
+    }
+    seq_Build4Wire(&timing, seqFull, SEQ_4WIRE_LENGTH);
+    seq_Build4Wire(&sense, seqSense, SEQ_4WIRE_LENGTH);
+
+    total = count = pattern_Compile(time_Pattern(n_el), words, PATTERN_MAX_QUADS);
+    if (0u == count) {
+        fprintf(stderr, "invalid pattern\n");
+        return 1;
+    }
+    if (bReduced) {
+        count  = pattern_Reduce(words, total, measured, plan);
+        pIndex = measured;
+    }
+    for (i = 0; i < count; i++) {
+        order[i] = (uint16_t)i;
+    }
+    if (bGrouped) {
+        pattern_Order(words, pIndex, count, order);
+    }
+
+    baseUs  = time_Frame(total, NULL, NULL, false, blockQuads, overheadUs);
+    frameUs = time_Frame(count, pIndex, order, bGrouped, blockQuads, overheadUs);
+
+    printf("pattern          %u electrodes, %u quads, %u measured\n", n_el, total, count);
+    printf("injections       %u in pattern order, %u measured\n",
+           pattern_Injections(words, pIndex, NULL, count), pattern_Injections(words, pIndex, order, count));
+    printf("quad sequence    %.1f us, %.1f us sense-only\n",
+           seq_Cycles(seqFull) * 1e6 / SEQ_CLOCK_HZ, seq_Cycles(seqSense) * 1e6 / SEQ_CLOCK_HZ);
+    printf("full frame       %.3f ms, %.2f frames/s\n", baseUs / 1000.0, 1e6 / baseUs);
+    printf("this plan        %.3f ms, %.2f frames/s, %.1f %% of the full frame\n",
+           frameUs / 1000.0, 1e6 / frameUs, 100.0 * frameUs / baseUs);
+
+    if (bPrint) {
+        for (i = 0; i < count; i++) {
+            k = (NULL != pIndex) ? pIndex[order[i]] : order[i];
+            pattern_Unpack(words[k], &quad);
+            printf("%u,%u,%u,%u,%u\n", k, quad.aPlus, quad.aMinus, quad.vPlus, quad.vMinus);
+        }
+    }
+
+    return 0;
+}
+
+/*
+** EOF
+*/
@@ -0,0 +1,36 @@
+/*!
+ *****************************************************************************
+ * @file:   intrinsics.h
+ * @brief:  Host stand-ins for the IAR compiler intrinsics
+ *****************************************************************************/
+
+#ifndef __INTRINSICS_H__
+#define __INTRINSICS_H__
+
+/* Sleep until the next simulated interrupt, afesim_main.c */
+void                        afesim_Wfi              (void);
+
+#define __enable_irq()              ((void)0)
+#define __disable_irq()             ((void)0)
+#define __get_PRIMASK()             (0u)
+#define __set_PRIMASK(x)            ((void)(x))
+#define __NOP()                     ((void)0)
+#define __WFI()                     afesim_Wfi()
+#define __DSB()                     ((void)0)
+#define __ISB()                     ((void)0)
+
+static inline unsigned char __CLZ(unsigned long x) {
+    return (unsigned char)((0u == x) ? 32 : __builtin_clz((unsigned int)x));
+}
+
+static inline long __SSAT(long x, unsigned int bits) {
+    long                    max = (1L << (bits - 1u)) - 1;
+
+    return (x > max) ? max : ((x < (-max - 1)) ? (-max - 1) : x);
+}
+
+#endif /* __INTRINSICS_H__ */
+
+/*
+** EOF
+*/
@@ -0,0 +1,558 @@
+/*!
+ *****************************************************************************
+ * @file:   mode_check.c
+ * @brief:  Checks of the mode switches of mode_manager.c on a stubbed driver layer
+ *
+ * Usage: modecheck [options]
+ *   -n switches    random switches per boot (default 500)
+ *   -b boots       resets of the board, the flash cache is kept (default 50)
+ *   -s seed        random generator seed
+ *   -v             print every switch: mode, planned steps, sequencer time
+ *
+ * The switches run mode_manager.c, as on the device, against stubs of the
+ * AFE and GPIO drivers, adg732_Init() and calcache.c. The stubs count the
+ * driver calls, keep the calibration registers and decode the register
+ * writes of the sequences into the waveform generator registers. Each boot
+ * walks the modes at random, as the menu and the SET_MODE requests, with
+ * a random excitation frequency; the spectroscopy and multi-frequency modes
+ * leave their own frequency and amplitude in the waveform generator. The
+ * first switch of a boot and one in four of the others get a driver call
+ * failed on purpose, and the switch to the same mode repeated without the
+ * failure must then succeed.
+ *
+ * After every switch that succeeded:
+ *   - the drivers were initialized once in the boot and never uninitialized
+ *   - nothing is left to plan for the same target
+ *   - the calibration registers hold the codes of the first switch into the
+ *     profile, with the 4-wire TIA codes equal to the temperature sensor ones
+ *   - the waveform generator registers hold the target FCW and amplitude and
+ *     the FIFO, WG and DAC configuration of the power-it-up sequence
+ *   - calibrations and the power-it-up sequence ran in the first switch into
+ *     the profile only
+ *   - a hot switch, with the profile calibrated and powered, made no driver
+ *     library call and ran less than CHECK_HOT_MAX_US of sequences
+ * Exits with 1 on the first failure. The times printed are sequencer time,
+ * the calibrations themselves are not timed.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "mode_manager.h"
+#include "adg732.h"
+#include "calcache.h"
+#include "gpio.h"
+#include "modes.h"
+#include "sequences.h"
+
+#define CHECK_HOT_MAX_US            (1000u)
+#define CHECK_MAX_CALLS             (40u)       /* driver calls of a first switch, about */
+#define CHECK_MODES                 (8u)
+
+/* Calibration registers, by word offset from REG_AFE_AFE_CAL_DATA_LOCK */
+#define CHECK_CAL_REGS              (20u)
+#define CHECK_CAL_INDEX(reg)        (((uint32_t)(reg) - REG_AFE_AFE_CAL_DATA_LOCK) / 4u)
+
+/* Waveform generator registers, by the address byte of SEQ_MMR_WRITE() */
+#define CHECK_ADDR_FIFO_CFG         (0x08u)
+#define CHECK_ADDR_DAC_CFG          (0x10u)
+#define CHECK_ADDR_WG_CFG           (0x14u)
+#define CHECK_ADDR_WG_FCW           (0x30u)
+#define CHECK_ADDR_WG_AMPLITUDE     (0x3Cu)
+
+/* Excitation frequencies of the frequency menu and SET_FREQUENCY */
+static const uint32_t       checkFrequencies[] = { 1000, 10000, 25000, 50000, 70000 };
+
+/* Stubbed driver state of one boot, and the flash page of calcache.c */
+typedef struct {
+    uint32_t                calls;          /*!< Driver calls made                                      */
+    uint32_t                failAt;         /*!< Call to fail, 0 for none                               */
+    bool_t                  bFailed;        /*!< The call was failed                                    */
+    bool_t                  bFailedRestore; /*!< ... and it was calcache_Restore(), not an error        */
+    uint32_t                libCalls;       /*!< Driver calls other than registers and sequences        */
+    uint32_t                calCalls;       /*!< Channel calibrations run                               */
+    uint32_t                gpioInits;
+    uint32_t                afeInits;
+    bool_t                  bAfeInit;
+    bool_t                  bPowered;
+    uint32_t                seqCycles;      /*!< Sequencer cycles of the sequences run                  */
+    uint32_t                boot;
+    uint32_t                regs[CHECK_CAL_REGS];
+    uint32_t                wg[0x40u / 4u];
+    bool_t                  bCacheValid;
+    uint32_t                cacheCals;
+    uint32_t                cache[CHECK_CAL_REGS];
+} CHECK_DRIVER;
+
+static CHECK_DRIVER         drv;
+static uint32_t             checkFailures, checkHot, checkMaxHotCycles, checkMaxFirstCycles;
+static uint8_t              afeDevice;
+static SEQ_OBJECT           seqobj_poweritup;
+static SEQ_OBJECT           seqobj_poweritup_bipolar;
+static const MODEMGR_PROFILE checkProfiles[MODEMGR_PROFILES] = {
+    { CALCACHE_CAL_TEMP_SENS | CALCACHE_CAL_AUX,   true,  &seqobj_poweritup         },
+    { CALCACHE_CAL_TIA | CALCACHE_CAL_EXCITE_ATTEN, false, &seqobj_poweritup_bipolar },
+};
+
+/* Registers written by each calibration, gain then offset */
+static const uint32_t       checkCalTemp[2]  = { REG_AFE_AFE_ADC_GAIN_TEMP_SENS, REG_AFE_AFE_ADC_OFFSET_TEMP_SENS };
+static const uint32_t       checkCalAux[2]   = { REG_AFE_AFE_ADC_GAIN_AUX, REG_AFE_AFE_ADC_OFFSET_AUX };
+static const uint32_t       checkCalTia[2]   = { REG_AFE_AFE_ADC_GAIN_TIA, REG_AFE_AFE_ADC_OFFSET_TIA };
+static const uint32_t       checkCalAtten[1] = { REG_AFE_AFE_DAC_OFFSET_ATTEN };
+
+static uint32_t             check_Rand              (void);
+static bool_t               check_Fail              (bool_t bLibrary);
+static ADI_AFE_RESULT_TYPE  check_Cal               (ADI_AFE_DEV_HANDLE hDevice, const uint32_t *pRegs,
+                                                     uint32_t count, uint32_t seed);
+static void                 check_Cache             (uint32_t cals, bool_t bStore);
+static void                 check_Target            (uint32_t mode, uint32_t frequency, MODEMGR_TARGET *pTarget);
+static int                  check_Boot              (MODEMGR *pMgr, uint32_t switches, bool_t bVerbose);
+
+/* seq_Commit() signs the sequences, the stubs do not check the CRC */
+uint8_t adi_AFE_CalculateSequenceCRC(const uint32_t *const txBuffer) {
+    return 0;
+}
+
+static uint32_t check_Rand(void) {
+    return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+/* Counts a driver call, true for the one to fail */
+static bool_t check_Fail(bool_t bLibrary) {
+    drv.calls++;
+    if (bLibrary) {
+        drv.libCalls++;
+    }
+    if (drv.calls == drv.failAt) {
+        drv.bFailed = true;
+        return true;
+    }
+    return false;
+}
+
+/* A channel calibration, whose codes depend on the boot as on the die temperature */
+static ADI_AFE_RESULT_TYPE check_Cal(ADI_AFE_DEV_HANDLE hDevice, const uint32_t *pRegs, uint32_t count, uint32_t seed) {
+    uint32_t                i;
+
+    if (check_Fail(true)) {
+        return ADI_AFE_ERR_UNKNOWN;
+    }
+    if (!drv.bPowered || ((ADI_AFE_DEV_HANDLE)&afeDevice != hDevice)) {
+        return ADI_AFE_ERR_NOT_INITIALIZED;
+    }
+    drv.calCalls++;
+    for (i = 0; i < count; i++) {
+        drv.regs[CHECK_CAL_INDEX(pRegs[i])] = 0x4000u + (seed << 8) + (i << 4) + drv.boot;
+    }
+    return ADI_AFE_SUCCESS;
+}
+
+/* Cached or cache the registers of a set of calibrations */
+static void check_Cache(uint32_t cals, bool_t bStore) {
+    const uint32_t         *groups[4] = { checkCalTemp, checkCalAux, checkCalTia, checkCalAtten };
+    const uint32_t          counts[4] = { 2, 2, 2, 1 };
+    uint32_t                g, i, k;
+
+    for (g = 0; g < 4u; g++) {
+        if (cals & (1u << g)) {
+            for (i = 0; i < counts[g]; i++) {
+                k = CHECK_CAL_INDEX(groups[g][i]);
+                if (bStore) {
+                    drv.cache[k] = drv.regs[k];
+                }
+                else {
+                    drv.regs[k] = drv.cache[k];
+                }
+            }
+        }
+    }
+}
+
+ADI_GPIO_RESULT_TYPE adi_GPIO_Init(void) {
+    if (check_Fail(true)) {
+        return ADI_GPIO_ERR_UNKNOWN_ERROR;
+    }
+    drv.gpioInits++;
+    return ADI_GPIO_SUCCESS;
+}
+
+ADI_GPIO_RESULT_TYPE adi_GPIO_SetPullUpEnable(const ADI_GPIO_PORT_TYPE Port, const ADI_GPIO_DATA_TYPE Pins, const bool_t bFlag) {
+    return check_Fail(true) ? ADI_GPIO_ERR_UNKNOWN_ERROR : ADI_GPIO_SUCCESS;
+}
+
+ADI_GPIO_RESULT_TYPE adi_GPIO_SetOutputEnable(const ADI_GPIO_PORT_TYPE Port, const ADI_GPIO_DATA_TYPE Pins, const bool_t bFlag) {
+    return check_Fail(true) ? ADI_GPIO_ERR_UNKNOWN_ERROR : ADI_GPIO_SUCCESS;
+}
+
+ADI_GPIO_RESULT_TYPE adi_GPIO_SetInputEnable(const ADI_GPIO_PORT_TYPE Port, const ADI_GPIO_DATA_TYPE Pins, const bool_t bFlag) {
+    return check_Fail(true) ? ADI_GPIO_ERR_UNKNOWN_ERROR : ADI_GPIO_SUCCESS;
+}
+
+ADI_GPIO_RESULT_TYPE adg732_Init(void) {
+    if (check_Fail(true)) {
+        return ADI_GPIO_ERR_UNKNOWN_ERROR;
+    }
+    return (0u == drv.gpioInits) ? ADI_GPIO_ERR_NOT_INITIALIZED : ADI_GPIO_SUCCESS;
+}
+
+/* As the driver: a second initialization clears the handle */
+ADI_AFE_RESULT_TYPE adi_AFE_Init(ADI_AFE_DEV_HANDLE *const phDevice) {
+    if (check_Fail(true)) {
+        return ADI_AFE_ERR_UNKNOWN;
+    }
+    if (drv.bAfeInit) {
+        *phDevice = NULL;
+        return ADI_AFE_ERR_ALREADY_INITIALIZED;
+    }
+    drv.bAfeInit = true;
+    drv.afeInits++;
+    *phDevice = (ADI_AFE_DEV_HANDLE)&afeDevice;
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_UnInit(ADI_AFE_DEV_HANDLE const hDevice) {
+    fprintf(stderr, "adi_AFE_UnInit called\n");
+    exit(1);
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_SetRcal(ADI_AFE_DEV_HANDLE const hDevice, uint32_t rcal) {
+    if (check_Fail(true)) {
+        return ADI_AFE_ERR_UNKNOWN;
+    }
+    return ((ADI_AFE_DEV_HANDLE)&afeDevice == hDevice) ? ADI_AFE_SUCCESS : ADI_AFE_ERR_BAD_DEV_HANDLE;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_SetRtia(ADI_AFE_DEV_HANDLE const hDevice, uint32_t rtia) {
+    if (check_Fail(true)) {
+        return ADI_AFE_ERR_UNKNOWN;
+    }
+    return ((ADI_AFE_DEV_HANDLE)&afeDevice == hDevice) ? ADI_AFE_SUCCESS : ADI_AFE_ERR_BAD_DEV_HANDLE;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_PowerUp(ADI_AFE_DEV_HANDLE const hDevice) {
+    if (check_Fail(true)) {
+        return ADI_AFE_ERR_UNKNOWN;
+    }
+    if ((ADI_AFE_DEV_HANDLE)&afeDevice != hDevice) {
+        return ADI_AFE_ERR_BAD_DEV_HANDLE;
+    }
+    drv.bPowered = true;
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_TempSensChanCal(ADI_AFE_DEV_HANDLE const hDevice) {
+    return check_Cal(hDevice, checkCalTemp, 2u, 1u);
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_AuxChanCal(ADI_AFE_DEV_HANDLE const hDevice) {
+    return check_Cal(hDevice, checkCalAux, 2u, 2u);
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_TiaChanCal(ADI_AFE_DEV_HANDLE const hDevice) {
+    return check_Cal(hDevice, checkCalTia, 2u, 3u);
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_ExciteChanCalAtten(ADI_AFE_DEV_HANDLE const hDevice) {
+    return check_Cal(hDevice, checkCalAtten, 1u, 4u);
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_ExciteChanPowerUp(ADI_AFE_DEV_HANDLE const hDevice) {
+    if (check_Fail(true)) {
+        return ADI_AFE_ERR_UNKNOWN;
+    }
+    return drv.bPowered ? ADI_AFE_SUCCESS : ADI_AFE_ERR_NOT_INITIALIZED;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_ReadCalibrationRegister(ADI_AFE_DEV_HANDLE const hDevice, ADI_AFE_CAL_REG_TYPE Reg,
+                                                    uint32_t *const pVal) {
+    if (check_Fail(false)) {
+        return ADI_AFE_ERR_UNKNOWN;
+    }
+    *pVal = drv.regs[CHECK_CAL_INDEX(Reg)];
+    return ADI_AFE_SUCCESS;
+}
+
+ADI_AFE_RESULT_TYPE adi_AFE_WriteCalibrationRegister(ADI_AFE_DEV_HANDLE const hDevice, ADI_AFE_CAL_REG_TYPE Reg,
+                                                     uint32_t Val) {
+    if (check_Fail(false)) {
+        return ADI_AFE_ERR_UNKNOWN;
+    }
+    drv.regs[CHECK_CAL_INDEX(Reg)] = Val;
+    return ADI_AFE_SUCCESS;
+}
+
+/* Register writes of the waveform generator kept, the run timed */
+ADI_AFE_RESULT_TYPE adi_AFE_RunSequence(ADI_AFE_DEV_HANDLE const hDevice, const uint32_t *const txBuffer,
+                                        uint16_t *const rxBuffer, uint32_t size) {
+    uint32_t                i, word, addr;
+
+    if (check_Fail(false)) {
+        return ADI_AFE_ERR_UNKNOWN;
+    }
+    if (!drv.bPowered || ((ADI_AFE_DEV_HANDLE)&afeDevice != hDevice)) {
+        return ADI_AFE_ERR_NOT_INITIALIZED;
+    }
+    for (i = 1; SEQ_END_COMMAND != (word = txBuffer[i]); i++) {
+        if (word & 0x80000000u) {
+            addr = (word >> 23) & 0xFCu;
+            if (addr < sizeof(drv.wg)) {
+                drv.wg[addr / 4u] = word & 0x01FFFFFFu;
+            }
+        }
+    }
+    for (i = 0; i < size; i++) {
+        rxBuffer[i] = 0;
+    }
+    drv.seqCycles += seq_Cycles(txBuffer);
+    return ADI_AFE_SUCCESS;
+}
+
+/* As calcache.c: one record, restored while the temperature holds, here for the boot it was stored in */
+bool_t calcache_Restore(ADI_AFE_DEV_HANDLE hDevice, uint32_t cals) {
+    cals |= CALCACHE_CAL_TEMP_SENS;
+    if (check_Fail(true)) {
+        drv.bFailedRestore = true;
+        return false;
+    }
+    if (!drv.bCacheValid || ((drv.cacheCals & cals) != cals)) {
+        return false;
+    }
+    check_Cache(cals, false);
+    return true;
+}
+
+bool_t calcache_Store(ADI_AFE_DEV_HANDLE hDevice, uint32_t cals) {
+    drv.bCacheValid = true;
+    drv.cacheCals   = cals;
+    check_Cache(cals, true);
+    return true;
+}
+
+/* Target of a mode, as mode_target() of OpenEIT.c */
+static void check_Target(uint32_t mode, uint32_t frequency, MODEMGR_TARGET *pTarget) {
+    pTarget->profile   = MODEMGR_PROFILE_TETRAPOLAR;
+    pTarget->fcw       = MODEMGR_FCW_ANY;
+    pTarget->amplitude = SINE_AMPLITUDE;
+    if ((1u == mode) || ((mode >= 3u) && (mode <= 5u))) {
+        pTarget->fcw = seq_Fcw(frequency);
+    }
+    else if ((6u == mode) || (7u == mode)) {
+        pTarget->profile   = MODEMGR_PROFILE_BIPOLAR;
+        pTarget->fcw       = FCW;
+        pTarget->amplitude = SINE_AMPLITUDE_BIPOLAR;
+    }
+}
+
+/* One boot: a random walk of switches, each checked */
+static int check_Boot(MODEMGR *pMgr, uint32_t switches, bool_t bVerbose) {
+    static const uint32_t   calRegs[MODEMGR_CAL_REGS] = {
+        REG_AFE_AFE_ADC_GAIN_TEMP_SENS, REG_AFE_AFE_ADC_OFFSET_TEMP_SENS, REG_AFE_AFE_ADC_GAIN_AUX,
+        REG_AFE_AFE_ADC_OFFSET_AUX, REG_AFE_AFE_ADC_GAIN_TIA, REG_AFE_AFE_ADC_OFFSET_TIA, REG_AFE_AFE_DAC_OFFSET_ATTEN,
+    };
+    uint32_t                reference[MODEMGR_PROFILES][MODEMGR_CAL_REGS];
+    uint32_t                entered  = 0;
+    uint32_t                poweredUp = 0;
+    uint32_t                hot = 0, failures = 0, maxHotCycles = 0, firstCycles = 0;
+    uint32_t                n, i, mode, frequency, plan, failed, bit, calCalls, libCalls, cycles, limit;
+    bool_t                  bRetried;
+    const uint32_t         *pWords;
+    MODEMGR_TARGET          target;
+
+    frequency = checkFrequencies[2];
+    for (n = 0; n < switches; n++) {
+        mode = 1u + check_Rand() % CHECK_MODES;
+        if (0u == check_Rand() % 8u) {
+            frequency = checkFrequencies[check_Rand() % (sizeof(checkFrequencies) / sizeof(checkFrequencies[0]))];
+        }
+        check_Target(mode, frequency, &target);
+        bit  = 1u << target.profile;
+        plan = modemgr_Plan(pMgr, &target);
+
+        drv.calls          = 0;
+        drv.bFailed        = false;
+        drv.bFailedRestore = false;
+        limit              = (plan & (MODEMGR_STEP_GPIO | MODEMGR_STEP_CALIBRATE)) ? CHECK_MAX_CALLS : CHECK_MAX_CALLS / 4u;
+        drv.failAt         = ((0u == n) || (0u == check_Rand() % 4u)) ? 1u + check_Rand() % limit : 0u;
+        bRetried           = false;
+        calCalls           = drv.calCalls;
+        libCalls           = drv.libCalls;
+        cycles             = drv.seqCycles;
+
+        failed = modemgr_Switch(pMgr, &target);
+        if (failed) {
+            if (!drv.bFailed || drv.bFailedRestore || !(failed & plan)) {
+                fprintf(stderr, "switch %u: mode %u, plan 0x%02x, step 0x%02x failed without a failed call\n",
+                        n, mode, plan, failed);
+                return 1;
+            }
+            failures++;
+            bRetried   = true;
+            drv.failAt = 0;
+            if (0u != (failed = modemgr_Switch(pMgr, &target))) {
+                fprintf(stderr, "switch %u: mode %u, retry failed at step 0x%02x\n", n, mode, failed);
+                return 1;
+            }
+        }
+        else if (drv.bFailed && !drv.bFailedRestore) {
+            fprintf(stderr, "switch %u: mode %u, a failed call went unnoticed\n", n, mode);
+            return 1;
+        }
+        calCalls = drv.calCalls - calCalls;
+        libCalls = drv.libCalls - libCalls;
+        cycles   = drv.seqCycles - cycles;
+        if (bVerbose) {
+            printf("switch %u: mode %u, plan 0x%02x%s, %.3f ms of sequences\n", n, mode, plan,
+                   bRetried ? " (retried)" : "", cycles * 1e3 / SEQ_CLOCK_HZ);
+        }
+
+        /* Drivers, once */
+        if ((1u != drv.afeInits) || (0u == drv.gpioInits) || (pMgr->hDevice != (ADI_AFE_DEV_HANDLE)&afeDevice)) {
+            fprintf(stderr, "switch %u: %u AFE inits, %u GPIO inits, handle %p\n", n, drv.afeInits, drv.gpioInits,
+                    (void *)pMgr->hDevice);
+            return 1;
+        }
+        if (0u != modemgr_Plan(pMgr, &target)) {
+            fprintf(stderr, "switch %u: mode %u, 0x%02x still planned\n", n, mode, modemgr_Plan(pMgr, &target));
+            return 1;
+        }
+
+        /* Calibration codes */
+        if (!(entered & bit)) {
+            for (i = 0; i < MODEMGR_CAL_REGS; i++) {
+                reference[target.profile][i] = drv.regs[CHECK_CAL_INDEX(calRegs[i])];
+            }
+            if (0u == n) {
+                firstCycles = cycles;
+            }
+        }
+        else if (0u != calCalls) {
+            fprintf(stderr, "switch %u: mode %u, %u calibrations in a later switch into the profile\n", n, mode, calCalls);
+            return 1;
+        }
+        for (i = 0; i < MODEMGR_CAL_REGS; i++) {
+            if (drv.regs[CHECK_CAL_INDEX(calRegs[i])] != reference[target.profile][i]) {
+                fprintf(stderr, "switch %u: mode %u, calibration register 0x%08x is 0x%x, 0x%x expected\n", n, mode,
+                        calRegs[i], drv.regs[CHECK_CAL_INDEX(calRegs[i])], reference[target.profile][i]);
+                return 1;
+            }
+        }
+        if (checkProfiles[target.profile].bTiaFromTemp &&
+            ((drv.regs[CHECK_CAL_INDEX(REG_AFE_AFE_ADC_GAIN_TIA)] !=
+              drv.regs[CHECK_CAL_INDEX(REG_AFE_AFE_ADC_GAIN_TEMP_SENS)]) ||
+             (drv.regs[CHECK_CAL_INDEX(REG_AFE_AFE_ADC_OFFSET_TIA)] !=
+              drv.regs[CHECK_CAL_INDEX(REG_AFE_AFE_ADC_OFFSET_TEMP_SENS)]))) {
+            fprintf(stderr, "switch %u: mode %u, TIA codes differ from the temperature sensor ones\n", n, mode);
+            return 1;
+        }
+        entered |= bit;
+
+        /* Waveform generator */
+        if (MODEMGR_FCW_ANY == target.fcw) {
+            /* The spectroscopy and multi-frequency sequences leave a frequency of their own */
+            drv.wg[CHECK_ADDR_WG_FCW / 4u]       = seq_Fcw(1000u + check_Rand() % 70000u);
+            drv.wg[CHECK_ADDR_WG_AMPLITUDE / 4u] = check_Rand() % 0x800u;
+            continue;
+        }
+        pWords = checkProfiles[target.profile].pPowerItUp->pWords;
+        if ((drv.wg[CHECK_ADDR_WG_FCW / 4u] != target.fcw) ||
+            (drv.wg[CHECK_ADDR_WG_AMPLITUDE / 4u] != target.amplitude) ||
+            (drv.wg[CHECK_ADDR_FIFO_CFG / 4u] != (pWords[1] & 0x01FFFFFFu)) ||
+            (drv.wg[CHECK_ADDR_WG_CFG / 4u] != (pWords[2] & 0x01FFFFFFu)) ||
+            (drv.wg[CHECK_ADDR_DAC_CFG / 4u] != (pWords[5] & 0x01FFFFFFu))) {
+            fprintf(stderr, "switch %u: mode %u, waveform FCW 0x%x amplitude %u DAC 0x%x, FCW 0x%x amplitude %u expected\n",
+                    n, mode, drv.wg[CHECK_ADDR_WG_FCW / 4u], drv.wg[CHECK_ADDR_WG_AMPLITUDE / 4u],
+                    drv.wg[CHECK_ADDR_DAC_CFG / 4u], target.fcw, target.amplitude);
+            return 1;
+        }
+        if (plan & MODEMGR_STEP_POWERITUP) {
+            if (poweredUp & bit) {
+                fprintf(stderr, "switch %u: mode %u, power-it-up sequence run again\n", n, mode);
+                return 1;
+            }
+            poweredUp |= bit;
+        }
+
+        /* Hot switches */
+        if (!(plan & (MODEMGR_STEP_GPIO | MODEMGR_STEP_AFE | MODEMGR_STEP_CALIBRATE | MODEMGR_STEP_POWERITUP)) &&
+            !bRetried) {
+            if ((0u != libCalls) || (cycles * 1e6 / SEQ_CLOCK_HZ >= CHECK_HOT_MAX_US)) {
+                fprintf(stderr, "switch %u: mode %u, hot switch with %u library calls and %u cycles\n",
+                        n, mode, libCalls, cycles);
+                return 1;
+            }
+            hot++;
+            if (cycles > maxHotCycles) {
+                maxHotCycles = cycles;
+            }
+        }
+    }
+
+    if (bVerbose) {
+        printf("boot %u: %u switches, %u with a failed call, %u hot, %u calibrations\n",
+               drv.boot, switches, failures, hot, drv.calCalls);
+    }
+    checkFailures += failures;
+    checkHot      += hot;
+    if (maxHotCycles > checkMaxHotCycles) {
+        checkMaxHotCycles = maxHotCycles;
+    }
+    if (firstCycles > checkMaxFirstCycles) {
+        checkMaxFirstCycles = firstCycles;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    MODEMGR                 mgr;
+    uint32_t                switches = 500;
+    uint32_t                boots    = 50;
+    unsigned                seed     = 1;
+    bool_t                  bVerbose = false;
+    uint32_t                b;
+    int                     opt;
+
+    while ((opt = getopt(argc, argv, "n:b:s:v")) != -1) {
+        switch (opt) {
+        case 'n': switches = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'b': boots    = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 's': seed     = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'v': bVerbose = true;                               break;
+        default:
+            fprintf(stderr, "usage: modecheck [-n switches] [-b boots] [-s seed] [-v]\n");
+            return 1;
+        }
+    }
+    srand(seed);
+
+    /* As main() of OpenEIT.c */
+    seq_Attach(&seqobj_poweritup, seq_afe_poweritup, sizeof(seq_afe_poweritup) / sizeof(seq_afe_poweritup[0]));
+    seq_Attach(&seqobj_poweritup_bipolar, seq_afe_poweritup_bipolar,
+               sizeof(seq_afe_poweritup_bipolar) / sizeof(seq_afe_poweritup_bipolar[0]));
+
+    memset(&drv, 0, sizeof(drv));
+    for (b = 0; b < boots; b++) {
+        /* A reset clears the drivers and the AFE, not the flash */
+        drv.boot      = b;
+        drv.gpioInits = 0;
+        drv.afeInits  = 0;
+        drv.bAfeInit  = false;
+        drv.bPowered  = false;
+        drv.calCalls  = 0;
+        memset(drv.regs, 0, sizeof(drv.regs));
+        memset(drv.wg, 0, sizeof(drv.wg));
+        modemgr_Init(&mgr, checkProfiles, RCAL, RTIA);
+        if (check_Boot(&mgr, switches, bVerbose)) {
+            return 1;
+        }
+    }
+    printf("switches: %u with a failed call, %u hot of at most %.2f us of sequences, first at most %.1f ms\n",
+           checkFailures, checkHot, checkMaxHotCycles * 1e6 / SEQ_CLOCK_HZ, checkMaxFirstCycles * 1e3 / SEQ_CLOCK_HZ);
+    printf("mode manager: %u boots of %u random switches passed\n", boots, switches);
+    return 0;
+}
+
+/*
+** EOF
+*/
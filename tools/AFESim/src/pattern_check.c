@@ -0,0 +1,117 @@
+/*!
+ *****************************************************************************
+ * @file:   pattern_check.c
+ * @brief:  Checks of the patterns of pattern.c against the old lookup tables
+ *
+ * Usage: patterncheck
+ *
+ * The 8, 16 and 32 electrode opposition patterns and the 32 electrode
+ * adjacent pattern of lookup.h are generated by pattern.c and compared,
+ * quad by quad, with the tables lookup.h held before, kept in
+ * pattern_tables.h. For each pattern:
+ *   - pattern_Count() is the size of the table
+ *   - pattern_Next() gives the (A+, A-, V+, V-) of each entry, in order
+ *   - pattern_Compile() gives one mux word per entry, and pattern_Unpack()
+ *     gives back the entry, as the imaging modes apply them
+ * Prints the first differing quad and exits with 1 on a mismatch.
+ *****************************************************************************/
+
+#include <stdio.h>
+
+#include "lookup.h"
+#include "pattern.h"
+#include "pattern_tables.h"
+
+/* A pattern and the table it replaced */
+typedef struct {
+    const char             *pName;
+    const PATTERN_CONFIG   *pConfig;
+    const e_config         *pTable;
+    uint32_t                count;
+} CHECK_PATTERN;
+
+static const CHECK_PATTERN  checkPatterns[] = {
+    { "8 electrode opposition",  &pattern_8_opposition,  electrode_configuration_8_opposition,
+      sizeof(electrode_configuration_8_opposition) / sizeof(electrode_configuration_8_opposition[0]) },
+    { "16 electrode opposition", &pattern_16_opposition, electrode_configuration_16_opposition,
+      sizeof(electrode_configuration_16_opposition) / sizeof(electrode_configuration_16_opposition[0]) },
+    { "32 electrode opposition", &pattern_32_opposition, electrode_configuration_32_opposition,
+      sizeof(electrode_configuration_32_opposition) / sizeof(electrode_configuration_32_opposition[0]) },
+    { "32 electrode adjacent",   &pattern_32_adjacent,   electrode_configuration_32_adjacent,
+      sizeof(electrode_configuration_32_adjacent) / sizeof(electrode_configuration_32_adjacent[0]) },
+};
+
+static uint32_t             checkWords[PATTERN_MAX_QUADS];
+
+static bool_t               check_Quad              (const CHECK_PATTERN *pPattern, const char *pWhat, uint32_t k,
+                                                     const PATTERN_QUAD *pQuad);
+static int                  check_Pattern           (const CHECK_PATTERN *pPattern);
+
+/* True if a quad is entry k of the table, otherwise prints both */
+static bool_t check_Quad(const CHECK_PATTERN *pPattern, const char *pWhat, uint32_t k, const PATTERN_QUAD *pQuad) {
+    const int16_t          *e = pPattern->pTable[k];
+
+    if ((pQuad->aPlus == e[0]) && (pQuad->aMinus == e[1]) && (pQuad->vPlus == e[2]) && (pQuad->vMinus == e[3])) {
+        return true;
+    }
+    fprintf(stderr, "%s, %s quad %u: %u,%u,%u,%u, the table has %d,%d,%d,%d\n", pPattern->pName, pWhat, k,
+            pQuad->aPlus, pQuad->aMinus, pQuad->vPlus, pQuad->vMinus, e[0], e[1], e[2], e[3]);
+    return false;
+}
+
+static int check_Pattern(const CHECK_PATTERN *pPattern) {
+    PATTERN_ITERATOR        iter;
+    PATTERN_QUAD            quad;
+    uint32_t                k, count;
+
+    if (!pattern_IsValid(pPattern->pConfig) || (pattern_Count(pPattern->pConfig) != pPattern->count)) {
+        fprintf(stderr, "%s: %u quads, the table has %u\n", pPattern->pName, pattern_Count(pPattern->pConfig),
+                pPattern->count);
+        return 1;
+    }
+
+    pattern_Begin(&iter, pPattern->pConfig);
+    for (k = 0; pattern_Next(&iter, &quad); k++) {
+        if ((k >= pPattern->count) || !check_Quad(pPattern, "generated", k, &quad)) {
+            if (k >= pPattern->count) {
+                fprintf(stderr, "%s: more quads generated than the table has\n", pPattern->pName);
+            }
+            return 1;
+        }
+    }
+    if (k != pPattern->count) {
+        fprintf(stderr, "%s: %u quads generated, the table has %u\n", pPattern->pName, k, pPattern->count);
+        return 1;
+    }
+
+    count = pattern_Compile(pPattern->pConfig, checkWords, PATTERN_MAX_QUADS);
+    if (count != pPattern->count) {
+        fprintf(stderr, "%s: %u words compiled, the table has %u quads\n", pPattern->pName, count, pPattern->count);
+        return 1;
+    }
+    for (k = 0; k < count; k++) {
+        pattern_Unpack(checkWords[k], &quad);
+        if (!check_Quad(pPattern, "compiled", k, &quad)) {
+            return 1;
+        }
+    }
+
+    printf("%-24s %4u quads match\n", pPattern->pName, pPattern->count);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    uint32_t                i;
+
+    for (i = 0; i < sizeof(checkPatterns) / sizeof(checkPatterns[0]); i++) {
+        if (check_Pattern(&checkPatterns[i])) {
+            return 1;
+        }
+    }
+    printf("patterns: the %u tables of the old lookup.h are reproduced\n", i);
+    return 0;
+}
+
+/*
+** EOF
+*/
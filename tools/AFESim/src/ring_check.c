@@ -0,0 +1,290 @@
+/*!
+ *****************************************************************************
+ * @file:   ring_check.c
+ * @brief:  Checks of the Rx DMA half handoff of rx_ring.c
+ *
+ * Usage: ringcheck [options]
+ *   -n steps       random steps (default 100000)
+ *   -s seed        random generator seed
+ *
+ * A model of the Rx DMA writes half n of the stream, stamped with n, into
+ * half n % 2 of the buffer and calls rxring_Complete(), then starts writing
+ * half n + 1 over half n - 1. Checks that:
+ *   - in order, each half is returned once by rxring_Peek(), with its
+ *     stamp, and released intact, and rxring_Peek() returns NULL when no
+ *     half has completed
+ *   - a half held while the DMA completes the next one is overwritten and
+ *     rxring_Release() reports it, and counts it as lost
+ *   - a consumer late by k halves is given the newest, filled - 1, and the
+ *     k - 1 before it are counted as lost
+ *   - random steps of the DMA and the consumer lose no half silently:
+ *     every half is released intact or counted as lost, and a half
+ *     released intact still holds its stamp
+ * from counters of 0 and across their wrap at 2^32. Prints the first
+ * failure and exits with 1.
+ *****************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "rx_ring.h"
+
+#define CHECK_HALF_SIZE             (8u)
+#define CHECK_WRAP_BASE             (0xFFFFFFF8u)   /* the counters wrap within the first halves */
+
+static int16_t              checkBuffer[2u * CHECK_HALF_SIZE];
+static RX_RING              checkRing;
+static uint32_t             checkBase;          /* counters at the start */
+static uint32_t             checkDmaHalf;       /* half the DMA is writing */
+static uint32_t             checkLost;          /* halves the model has lost */
+static uint32_t             checkIntact;        /* halves released intact */
+
+static int16_t              check_Stamp             (uint32_t half, uint32_t k);
+static void                 check_Fill              (uint32_t half, uint32_t words);
+static bool_t               check_Holds             (const int16_t *pHalf, uint32_t half);
+static void                 check_Start             (uint32_t base);
+static void                 check_Dma               (uint32_t halves);
+static int                  check_Consume           (const char *pName, uint32_t dmaWhileHeld);
+static int                  check_Lost              (const char *pName, uint32_t lost);
+static int                  check_InOrder           (uint32_t base);
+static int                  check_Overrun           (uint32_t base);
+static int                  check_Late              (uint32_t base);
+static int                  check_Random            (uint32_t base, uint32_t steps);
+
+/* Value k of half n of the stream */
+static int16_t check_Stamp(uint32_t half, uint32_t k) {
+    return (int16_t)((half * 31u + k) & 0x7FFFu);
+}
+
+/* The DMA writes the first words of a half */
+static void check_Fill(uint32_t half, uint32_t words) {
+    uint32_t                k;
+
+    for (k = 0; k < words; k++) {
+        checkBuffer[(half & 1u) * CHECK_HALF_SIZE + k] = check_Stamp(half, k);
+    }
+}
+
+/* True if a half of the buffer holds half n of the stream */
+static bool_t check_Holds(const int16_t *pHalf, uint32_t half) {
+    uint32_t                k;
+
+    for (k = 0; k < CHECK_HALF_SIZE; k++) {
+        if (pHalf[k] != check_Stamp(half, k)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* An empty ring, counters at base, the DMA writing the first half */
+static void check_Start(uint32_t base) {
+    uint32_t                k;
+
+    for (k = 0; k < 2u * CHECK_HALF_SIZE; k++) {
+        checkBuffer[k] = -1;
+    }
+    rxring_Init(&checkRing, checkBuffer, CHECK_HALF_SIZE);
+    checkRing.filled   = base;
+    checkRing.consumed = base;
+    checkBase          = base;
+    checkDmaHalf       = base;
+    checkLost          = 0;
+    checkIntact        = 0;
+    check_Fill(checkDmaHalf, 1);
+}
+
+/* The DMA completes halves, and starts writing each next one over the half before */
+static void check_Dma(uint32_t halves) {
+    while (halves-- > 0u) {
+        check_Fill(checkDmaHalf, CHECK_HALF_SIZE);
+        rxring_Complete(&checkRing);
+        checkDmaHalf++;
+        check_Fill(checkDmaHalf, 1);
+    }
+}
+
+/* Peek, let the DMA complete halves, then release, checking each step against the model */
+static int check_Consume(const char *pName, uint32_t dmaWhileHeld) {
+    const int16_t          *pHalf;
+    uint32_t                before = checkRing.consumed;
+    uint32_t                filled = checkRing.filled;
+    uint32_t                half;
+    bool_t                  bIntact, bReleased;
+
+    pHalf = rxring_Peek(&checkRing);
+    if (filled == before) {
+        if ((NULL != pHalf) || (checkRing.consumed != before)) {
+            fprintf(stderr, "%s: a half returned with none completed, consumed %u\n", pName, before - checkBase);
+            return 1;
+        }
+        return 0;
+    }
+
+    /* The oldest half, or the newest one if the DMA is overwriting the others */
+    half       = ((filled - before) > 1u) ? (filled - 1u) : before;
+    checkLost += half - before;
+    if ((NULL == pHalf) || (checkRing.consumed != half) || (checkRing.lost != checkLost) ||
+        (pHalf != &checkBuffer[(half & 1u) * CHECK_HALF_SIZE]) || !check_Holds(pHalf, half)) {
+        fprintf(stderr, "%s: peek of half %u of %u completed, consumed %u and lost %u, %u expected\n", pName,
+                half - checkBase, filled - checkBase, checkRing.consumed - checkBase, checkRing.lost, checkLost);
+        return 1;
+    }
+
+    check_Dma(dmaWhileHeld);
+    bIntact   = check_Holds(pHalf, half);
+    bReleased = rxring_Release(&checkRing);
+    checkLost   += bIntact ? 0u : 1u;
+    checkIntact += bIntact ? 1u : 0u;
+    if ((bReleased != bIntact) || (bIntact != (0u == dmaWhileHeld)) || (checkRing.consumed != half + 1u) ||
+        (checkRing.lost != checkLost)) {
+        fprintf(stderr, "%s: half %u released %s, %s with %u halves completed while held, lost %u, %u expected\n",
+                pName, half - checkBase, bReleased ? "intact" : "overwritten", bIntact ? "intact" : "overwritten",
+                dmaWhileHeld, checkRing.lost, checkLost);
+        return 1;
+    }
+
+    return 0;
+}
+
+/* Halves lost since the start */
+static int check_Lost(const char *pName, uint32_t lost) {
+    if (checkRing.lost != lost) {
+        fprintf(stderr, "%s: %u halves lost, %u expected\n", pName, checkRing.lost, lost);
+        return 1;
+    }
+
+    return 0;
+}
+
+/* One half completed, then consumed, at a time */
+static int check_InOrder(uint32_t base) {
+    uint32_t                n;
+
+    check_Start(base);
+    for (n = 0; n < 64u; n++) {
+        if (check_Consume("in order, nothing completed", 0)) {
+            return 1;
+        }
+        check_Dma(1);
+        if (check_Consume("in order", 0)) {
+            return 1;
+        }
+    }
+
+    if (checkIntact != 64u) {
+        fprintf(stderr, "in order: %u of 64 halves released intact\n", checkIntact);
+        return 1;
+    }
+
+    return check_Lost("in order", 0);
+}
+
+/* 1 to 3 halves completed while a half is held */
+static int check_Overrun(uint32_t base) {
+    uint32_t                held, lost = 0;
+
+    check_Start(base);
+    for (held = 1; held <= 3u; held++) {
+        check_Dma(1);
+        if (check_Consume("overrun", 0) || check_Consume("overrun", 0)) {
+            return 1;
+        }
+
+        /* The held half is overwritten, the next peek skips the held - 1 halves before the newest */
+        check_Dma(1);
+        if (check_Consume("overrun, held", held) || check_Lost("overrun, held", lost + 1u)) {
+            return 1;
+        }
+        lost += held;
+        if (check_Consume("overrun, after", 0) || check_Consume("overrun, after", 0) ||
+            check_Lost("overrun, after", lost)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* 2 to 10 halves completed before the consumer looks */
+static int check_Late(uint32_t base) {
+    uint32_t                late, lost = 0;
+
+    check_Start(base);
+    for (late = 2; late <= 10u; late++) {
+        check_Dma(late);
+        if (check_Consume("late consumer", 0)) {
+            return 1;
+        }
+        lost += late - 1u;
+        if (check_Lost("late consumer", lost) || check_Consume("late consumer, after", 0)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* Random DMA completions and consumer steps, then the ring drained */
+static int check_Random(uint32_t base, uint32_t steps) {
+    uint32_t                step;
+
+    check_Start(base);
+    for (step = 0; step < steps; step++) {
+        check_Dma((lrand48() % 4u) ? 0u : (uint32_t)lrand48() % 4u);
+        if (check_Consume("random", (lrand48() % 8u) ? 0u : 1u + (uint32_t)lrand48() % 2u)) {
+            return 1;
+        }
+    }
+    while (checkRing.consumed != checkRing.filled) {
+        if (check_Consume("random, drained", 0)) {
+            return 1;
+        }
+    }
+    if ((checkRing.filled != checkDmaHalf) || (checkIntact + checkRing.lost != checkRing.filled - base)) {
+        fprintf(stderr, "random: %u halves completed, %u released intact and %u lost\n", checkRing.filled - base,
+                checkIntact, checkRing.lost);
+        return 1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    static const uint32_t   bases[] = { 0u, CHECK_WRAP_BASE };
+    uint32_t                steps = 100000;
+    long                    seed  = 1;
+    uint32_t                i;
+    int                     opt;
+
+    while ((opt = getopt(argc, argv, "n:s:")) != -1) {
+        switch (opt) {
+        case 'n': steps = (uint32_t)strtoul(optarg, NULL, 0);       break;
+        case 's': seed  = strtol(optarg, NULL, 0);                  break;
+        default:
+            fprintf(stderr, "usage: ringcheck [-n steps] [-s seed]\n");
+            return 1;
+        }
+    }
+    srand48(seed);
+
+    for (i = 0; i < sizeof(bases) / sizeof(bases[0]); i++) {
+        if (check_InOrder(bases[i]) || check_Overrun(bases[i]) || check_Late(bases[i]) ||
+            check_Random(bases[i], steps)) {
+            return 1;
+        }
+        printf("from 0x%08X: %u halves completed, %u released intact, %u lost\n", bases[i],
+               checkRing.filled - bases[i], checkIntact, checkRing.lost);
+    }
+    printf("rx ring: in order, overrun while held, late consumer and %u random steps passed, across the wrap\n",
+           steps);
+    return 0;
+}
+
+/*
+** EOF
+*/
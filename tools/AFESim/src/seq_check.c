@@ -0,0 +1,414 @@
+/*!
+ *****************************************************************************
+ * @file:   seq_check.c
+ * @brief:  Checks of the sequences of seq_builder.c
+ *
+ * Usage: seqcheck
+ *
+ * seq_builder.c is linked with the sequencer CRC of src/afe.c (afe_crc.c),
+ * so the safety words are checked against the driver. Checks that:
+ *   - seq_Build4Wire() at the default timing, without a frequency, gives
+ *     the command count and the commands of seq_afe_fast_meas_4wire of
+ *     sequences.h word for word; its CRC, 0x43, is left over from an older
+ *     version of the sequence, which is run with the software CRC
+ *   - at an excitation frequency only the two DFT waits change, to a whole
+ *     number of periods
+ *   - seq_WaitCycles() and seq_DftCycles() match a double precision
+ *     reference over a range of times and frequencies
+ *   - the safety word CRC of the built sequences is the one of
+ *     adi_AFE_CalculateSequenceCRC(), 0x1B at the default timing, and
+ *     changes with any command
+ *   - a SEQ_OBJECT keeps its CRC valid when seq_Patch(), seq_BuildPrefix()
+ *     or seq_BuildBlock() write the commands already in place, marks it
+ *     stale on any change, and seq_Commit() then gives the driver CRC
+ *   - seq_AutoTune() with a synthetic measurement, whose spread grows as the
+ *     DFT window shortens, stops at the last step under the threshold, fails
+ *     when the first step is over it and stops at the shortest window when
+ *     the threshold is never reached
+ * Prints the first failure and exits with 1.
+ *****************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "seq_builder.h"
+#include "sequences.h"
+
+#define CHECK_WORDS                 (sizeof(seq_afe_fast_meas_4wire) / sizeof(seq_afe_fast_meas_4wire[0]))
+#define CHECK_DFT_INDEX_1           (7u)    /* DFT wait of the current */
+#define CHECK_DFT_INDEX_2           (14u)   /* DFT wait of the voltage */
+#define CHECK_4WIRE_CRC             (0x1Bu) /* CRC8 of the commands of seq_afe_fast_meas_4wire, bit by bit */
+#define CHECK_TUNE_MEAN             (1000000)
+#define CHECK_TUNE_SAMPLES          (8u)
+#define CHECK_TUNE_MAX_STEPS        (32u)
+
+static uint32_t             checkSeq[SEQ_4WIRE_LENGTH];
+static uint32_t             tuneBaseCycles;         /* DFT wait of the starting timing */
+static uint32_t             tuneBasePpm;            /* spread at the starting timing */
+static uint32_t             tuneCalls;
+
+static int                  check_Default           (void);
+static int                  check_Frequency         (void);
+static int                  check_Cycles            (void);
+static int                  check_Crc               (void);
+static int                  check_Committed         (const SEQ_OBJECT *pObj, const char *pWhat);
+static int                  check_CrcCache          (void);
+static uint32_t             check_TuneSpread        (uint32_t dftCycles);
+static bool_t               check_TuneMeasure       (const uint32_t *seq, int32_t *pMagnitude);
+static int                  check_AutoTune          (void);
+
+/* The default timing is the original sequence */
+static int check_Default(void) {
+    SEQ_TIMING              timing = SEQ_TIMING_4WIRE_DEFAULT(0);
+    uint32_t                i;
+
+    if (seq_Build4Wire(&timing, checkSeq, SEQ_4WIRE_LENGTH - 1u) != 0u) {
+        fprintf(stderr, "seq_Build4Wire() wrote into a buffer too small\n");
+        return 1;
+    }
+    if ((CHECK_WORDS != SEQ_4WIRE_LENGTH) || (seq_Build4Wire(&timing, checkSeq, SEQ_4WIRE_LENGTH) != CHECK_WORDS)) {
+        fprintf(stderr, "seq_Build4Wire(): not the %u words of seq_afe_fast_meas_4wire\n", (uint32_t)CHECK_WORDS);
+        return 1;
+    }
+    if (SEQ_COMMAND_COUNT(checkSeq[0]) != SEQ_COMMAND_COUNT(seq_afe_fast_meas_4wire[0])) {
+        fprintf(stderr, "default timing: %u commands, seq_afe_fast_meas_4wire has %u\n",
+                SEQ_COMMAND_COUNT(checkSeq[0]), SEQ_COMMAND_COUNT(seq_afe_fast_meas_4wire[0]));
+        return 1;
+    }
+    for (i = 1; i < CHECK_WORDS; i++) {
+        if (checkSeq[i] != seq_afe_fast_meas_4wire[i]) {
+            fprintf(stderr, "default timing, word %u: 0x%08X, seq_afe_fast_meas_4wire has 0x%08X\n",
+                    i, checkSeq[i], seq_afe_fast_meas_4wire[i]);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* At a frequency, only the DFT windows change, to whole periods */
+static int check_Frequency(void) {
+    static const uint32_t   frequencies[] = { 1000, 10000, 25000, 33333, 50000, 80000 };
+    uint32_t                i, k, cycles;
+    double                  periods;
+
+    for (k = 0; k < sizeof(frequencies) / sizeof(frequencies[0]); k++) {
+        SEQ_TIMING          timing = SEQ_TIMING_4WIRE_DEFAULT(frequencies[k]);
+
+        seq_Build4Wire(&timing, checkSeq, SEQ_4WIRE_LENGTH);
+        cycles  = checkSeq[CHECK_DFT_INDEX_1];
+        periods = (double)cycles * frequencies[k] / SEQ_CLOCK_HZ;
+        if ((cycles != checkSeq[CHECK_DFT_INDEX_2]) || (fabs(periods - floor(periods + 0.5)) * SEQ_CLOCK_HZ >
+                                                         0.5 * frequencies[k])) {
+            fprintf(stderr, "%u Hz: DFT waits of %u and %u cycles, %.3f periods\n", frequencies[k], cycles,
+                    checkSeq[CHECK_DFT_INDEX_2], periods);
+            return 1;
+        }
+        for (i = 1; i < CHECK_WORDS; i++) {
+            if ((i != CHECK_DFT_INDEX_1) && (i != CHECK_DFT_INDEX_2) && (checkSeq[i] != seq_afe_fast_meas_4wire[i])) {
+                fprintf(stderr, "%u Hz, word %u: 0x%08X, seq_afe_fast_meas_4wire has 0x%08X\n", frequencies[k],
+                        i, checkSeq[i], seq_afe_fast_meas_4wire[i]);
+                return 1;
+            }
+        }
+    }
+
+    /* 321 periods of 25 kHz are the closest to the 12852 us of the original */
+    if (seq_DftCycles(&(SEQ_TIMING)SEQ_TIMING_4WIRE_DEFAULT(25000)) != 205440u) {
+        fprintf(stderr, "25 kHz: %u DFT cycles, 205440 expected\n",
+                seq_DftCycles(&(SEQ_TIMING)SEQ_TIMING_4WIRE_DEFAULT(25000)));
+        return 1;
+    }
+
+    return 0;
+}
+
+/* Waits and DFT windows against a double precision reference */
+static int check_Cycles(void) {
+    static const uint32_t   times[]       = { 0, 1, 7, 100, 200, 1000, 12852, 40000, 1000000 };
+    static const uint32_t   frequencies[] = { 0, 80, 1000, 4999, 10000, 25000, 33333, 50000, 80000, 100000, 200000 };
+    SEQ_TIMING              timing        = SEQ_TIMING_4WIRE_DEFAULT(0);
+    uint32_t                t, k, expect;
+    double                  periods;
+
+    for (t = 0; t < sizeof(times) / sizeof(times[0]); t++) {
+        if (seq_WaitCycles(times[t]) != (uint32_t)(times[t] * 1e-6 * SEQ_CLOCK_HZ + 0.5)) {
+            fprintf(stderr, "seq_WaitCycles(%u) = %u\n", times[t], seq_WaitCycles(times[t]));
+            return 1;
+        }
+        for (k = 0; k < sizeof(frequencies) / sizeof(frequencies[0]); k++) {
+            timing.frequency = frequencies[k];
+            timing.dftTimeUs = times[t];
+            if (0u == frequencies[k]) {
+                expect = seq_WaitCycles(times[t]);
+            }
+            else {
+                periods = floor(times[t] * 1e-6 * frequencies[k] + 0.5);
+                expect  = (uint32_t)floor(fmax(periods, 1.0) * SEQ_CLOCK_HZ / frequencies[k] + 0.5);
+            }
+            if (seq_DftCycles(&timing) != expect) {
+                fprintf(stderr, "seq_DftCycles(): %u cycles for %u us at %u Hz, %u expected\n",
+                        seq_DftCycles(&timing), times[t], frequencies[k], expect);
+                return 1;
+            }
+        }
+    }
+
+    /* The waits of the original sequence */
+    if ((seq_WaitCycles(100) != 0x640u) || (seq_WaitCycles(200) != 0xC80u) || (seq_WaitCycles(12852) != 0x32340u)) {
+        fprintf(stderr, "seq_WaitCycles(): not the waits of seq_afe_fast_meas_4wire\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+/* The safety word carries the CRC of the driver */
+static int check_Crc(void) {
+    static const uint32_t   frequencies[] = { 0, 1000, 25000, 50000 };
+    uint32_t                k, i;
+    uint8_t                 crc;
+
+    for (k = 0; k < sizeof(frequencies) / sizeof(frequencies[0]); k++) {
+        SEQ_TIMING          timing = SEQ_TIMING_4WIRE_DEFAULT(frequencies[k]);
+
+        seq_Build4Wire(&timing, checkSeq, SEQ_4WIRE_LENGTH);
+        crc = adi_AFE_CalculateSequenceCRC(checkSeq);
+        if ((checkSeq[0] & 0xFFu) != crc) {
+            fprintf(stderr, "%u Hz: safety word CRC 0x%02X, adi_AFE_CalculateSequenceCRC() gives 0x%02X\n",
+                    frequencies[k], checkSeq[0] & 0xFFu, crc);
+            return 1;
+        }
+        if ((0u == frequencies[k]) && (CHECK_4WIRE_CRC != crc)) {
+            fprintf(stderr, "default timing: CRC 0x%02X, 0x%02X expected\n", crc, CHECK_4WIRE_CRC);
+            return 1;
+        }
+
+        /* Any bit of any command changes the CRC */
+        for (i = 1; i < SEQ_4WIRE_LENGTH; i++) {
+            checkSeq[i] ^= 1u << ((i * 7u) & 31u);
+            if (adi_AFE_CalculateSequenceCRC(checkSeq) == crc) {
+                fprintf(stderr, "%u Hz: a bit of word %u does not change the CRC\n", frequencies[k], i);
+                return 1;
+            }
+            checkSeq[i] ^= 1u << ((i * 7u) & 31u);
+        }
+    }
+
+    return 0;
+}
+
+/* seq_Commit() made the safety word CRC valid and the one of the driver */
+static int check_Committed(const SEQ_OBJECT *pObj, const char *pWhat) {
+    if (!pObj->bCrcValid || ((pObj->pWords[0] & 0xFFu) != adi_AFE_CalculateSequenceCRC(pObj->pWords))) {
+        fprintf(stderr, "%s: seq_Commit() left CRC 0x%02X, %s, adi_AFE_CalculateSequenceCRC() gives 0x%02X\n", pWhat,
+                pObj->pWords[0] & 0xFFu, pObj->bCrcValid ? "valid" : "stale",
+                adi_AFE_CalculateSequenceCRC(pObj->pWords));
+        return 1;
+    }
+
+    return 0;
+}
+
+/* The CRC is kept valid by unchanged writes and made stale by any change */
+static int check_CrcCache(void) {
+    static uint32_t         words[2u * SEQ_4WIRE_LENGTH + 2u];
+    SEQ_TIMING              timing = SEQ_TIMING_4WIRE_DEFAULT(25000);
+    const uint32_t         *seqs[1];
+    SEQ_OBJECT              obj;
+    uint32_t                i, word;
+
+    /* seq_Patch() */
+    seq_Build4Wire(&timing, checkSeq, SEQ_4WIRE_LENGTH);
+    memcpy(words, checkSeq, sizeof(checkSeq));
+    seq_Attach(&obj, words, sizeof(words) / sizeof(words[0]));
+    if (obj.bCrcValid) {
+        fprintf(stderr, "seq_Attach(): the CRC of an attached sequence is trusted\n");
+        return 1;
+    }
+    seq_Commit(&obj);
+    if (check_Committed(&obj, "attached sequence")) {
+        return 1;
+    }
+    for (i = 1; i < SEQ_4WIRE_LENGTH; i++) {
+        word = words[0];
+        if (!seq_Patch(&obj, i, words[i]) || !obj.bCrcValid || (words[0] != word)) {
+            fprintf(stderr, "seq_Patch() of the command in place, word %u: the CRC is no longer valid\n", i);
+            return 1;
+        }
+        if (!seq_Patch(&obj, i, words[i] ^ 0x10u) || obj.bCrcValid) {
+            fprintf(stderr, "seq_Patch() of a new command, word %u: the CRC is still valid\n", i);
+            return 1;
+        }
+        seq_Commit(&obj);
+        if (check_Committed(&obj, "patched sequence")) {
+            return 1;
+        }
+        seq_Patch(&obj, i, words[i] ^ 0x10u);
+        seq_Commit(&obj);
+        if ((words[0] != word) || check_Committed(&obj, "restored sequence")) {
+            fprintf(stderr, "seq_Patch(): word %u restored, the safety word is 0x%08X, not 0x%08X\n", i, words[0],
+                    word);
+            return 1;
+        }
+    }
+    if (seq_Patch(&obj, 0, words[0]) || seq_Patch(&obj, SEQ_4WIRE_LENGTH, 0) || !obj.bCrcValid) {
+        fprintf(stderr, "seq_Patch() outside the commands: accepted, or the CRC made stale\n");
+        return 1;
+    }
+
+    /* seq_BuildPrefix(): in place when the length is the same */
+    seq_Reset(&obj);
+    if (!seq_BuildPrefix(&obj, 0x80024EF0u, checkSeq) || obj.bCrcValid) {
+        fprintf(stderr, "seq_BuildPrefix() into an empty sequence: failed, or the CRC is valid\n");
+        return 1;
+    }
+    seq_Commit(&obj);
+    if (check_Committed(&obj, "prefixed sequence") || (words[1] != 0x80024EF0u) ||
+        (memcmp(&words[2], &checkSeq[1], (SEQ_4WIRE_LENGTH - 1u) * sizeof(uint32_t)) != 0)) {
+        fprintf(stderr, "seq_BuildPrefix(): not the command followed by the sequence\n");
+        return 1;
+    }
+    if (!seq_BuildPrefix(&obj, 0x80024EF0u, checkSeq) || !obj.bCrcValid) {
+        fprintf(stderr, "seq_BuildPrefix() of the same copy: the CRC is no longer valid\n");
+        return 1;
+    }
+    if (!seq_BuildPrefix(&obj, 0x80024EF1u, checkSeq) || obj.bCrcValid) {
+        fprintf(stderr, "seq_BuildPrefix() of another command: the CRC is still valid\n");
+        return 1;
+    }
+    seq_Commit(&obj);
+    if (check_Committed(&obj, "prefix changed")) {
+        return 1;
+    }
+    checkSeq[CHECK_DFT_INDEX_1]++;
+    if (!seq_BuildPrefix(&obj, 0x80024EF1u, checkSeq) || obj.bCrcValid) {
+        fprintf(stderr, "seq_BuildPrefix() of a changed sequence: the CRC is still valid\n");
+        return 1;
+    }
+    checkSeq[CHECK_DFT_INDEX_1]--;
+    seq_Commit(&obj);
+    if (check_Committed(&obj, "sequence changed")) {
+        return 1;
+    }
+
+    /* seq_BuildBlock(): in place when the length is the same, rebuilt otherwise */
+    seqs[0] = checkSeq;
+    if (!seq_BuildBlock(&obj, seqs, 1, 2, 100) || obj.bCrcValid) {
+        fprintf(stderr, "seq_BuildBlock() of a new length: failed, or the CRC is valid\n");
+        return 1;
+    }
+    seq_Commit(&obj);
+    if (check_Committed(&obj, "block")) {
+        return 1;
+    }
+    if (!seq_BuildBlock(&obj, seqs, 1, 2, 100) || !obj.bCrcValid) {
+        fprintf(stderr, "seq_BuildBlock() of the same block: the CRC is no longer valid\n");
+        return 1;
+    }
+    if (!seq_BuildBlock(&obj, seqs, 1, 2, 101) || obj.bCrcValid) {
+        fprintf(stderr, "seq_BuildBlock() with another switch wait: the CRC is still valid\n");
+        return 1;
+    }
+    seq_Commit(&obj);
+
+    return check_Committed(&obj, "block changed");
+}
+
+/* Spread of the synthetic measurement, in ppm: the noise falls as the square root of the DFT window */
+static uint32_t check_TuneSpread(uint32_t dftCycles) {
+    return (uint32_t)(tuneBasePpm * sqrt((double)tuneBaseCycles / dftCycles));
+}
+
+/* Alternates around CHECK_TUNE_MEAN by the spread of the DFT window of the sequence */
+static bool_t check_TuneMeasure(const uint32_t *seq, int32_t *pMagnitude) {
+    int32_t                 noise = (int32_t)check_TuneSpread(seq[CHECK_DFT_INDEX_1]) * (CHECK_TUNE_MEAN / 1000000);
+
+    *pMagnitude = CHECK_TUNE_MEAN + ((tuneCalls++ & 1u) ? -noise : noise);
+
+    return true;
+}
+
+/* Stops at the last step under the threshold */
+static int check_AutoTune(void) {
+    SEQ_AUTOTUNE_CONFIG     config = { CHECK_TUNE_SAMPLES, 0 };
+    SEQ_TIMING              steps[CHECK_TUNE_MAX_STEPS];
+    uint32_t                spreads[CHECK_TUNE_MAX_STEPS];
+    SEQ_TIMING              timing;
+    SEQ_AUTOTUNE_RESULT     result;
+    uint32_t                count, n, expectCalls, minDftUs;
+
+    /* The windows expected at each step: a quarter shorter, down to SEQ_AUTOTUNE_MIN_PERIODS */
+    steps[0]       = (SEQ_TIMING)SEQ_TIMING_4WIRE_DEFAULT(25000);
+    tuneBaseCycles = seq_DftCycles(&steps[0]);
+    tuneBasePpm    = 200;
+    minDftUs       = (uint32_t)ceil(SEQ_AUTOTUNE_MIN_PERIODS * 1e6 / steps[0].frequency);
+    for (count = 1; count < CHECK_TUNE_MAX_STEPS; count++) {
+        steps[count]                 = steps[count - 1u];
+        steps[count].dftTimeUs       = (uint32_t)ceil(steps[count - 1u].dftTimeUs * 0.75);
+        steps[count].voltageSettleUs = (uint32_t)fmax(ceil(steps[count - 1u].voltageSettleUs * 0.75),
+                                                      steps[count].currentSettleUs);
+        if (steps[count].dftTimeUs < minDftUs) {
+            break;
+        }
+    }
+    for (n = 0; n < count; n++) {
+        spreads[n] = check_TuneSpread(seq_DftCycles(&steps[n]));
+    }
+
+    /* A threshold between each step and the next */
+    for (n = 0; n + 1u < count; n++) {
+        config.maxCvPpm = (spreads[n] + spreads[n + 1u]) / 2u;
+        timing          = steps[0];
+        tuneCalls       = 0;
+        expectCalls     = (n + 2u) * CHECK_TUNE_SAMPLES;
+        if (!seq_AutoTune(&timing, &config, check_TuneMeasure, checkSeq, &result) || (result.steps != n) ||
+            (memcmp(&timing, &steps[n], sizeof(timing)) != 0) || (result.cvPpm != spreads[n]) ||
+            (tuneCalls != expectCalls)) {
+            fprintf(stderr, "seq_AutoTune(), threshold %u ppm: %u steps to %u us at %u ppm in %u measurements, "
+                    "%u steps to %u us at %u ppm in %u expected\n", config.maxCvPpm, result.steps, timing.dftTimeUs,
+                    result.cvPpm, tuneCalls, n, steps[n].dftTimeUs, spreads[n], expectCalls);
+            return 1;
+        }
+        if (checkSeq[CHECK_DFT_INDEX_1] != seq_DftCycles(&steps[n])) {
+            fprintf(stderr, "seq_AutoTune(): the sequence left is not the one of the timing selected\n");
+            return 1;
+        }
+    }
+
+    /* Never reached: the shortest window */
+    config.maxCvPpm = spreads[count - 1u];
+    timing          = steps[0];
+    if (!seq_AutoTune(&timing, &config, check_TuneMeasure, checkSeq, &result) || (result.steps != count - 1u) ||
+        (timing.dftTimeUs != steps[count - 1u].dftTimeUs)) {
+        fprintf(stderr, "seq_AutoTune(): %u steps to %u us, the shortest window is %u steps to %u us\n",
+                result.steps, timing.dftTimeUs, count - 1u, steps[count - 1u].dftTimeUs);
+        return 1;
+    }
+
+    /* Over at the first step: fails and keeps the starting timing */
+    config.maxCvPpm = spreads[0] - 1u;
+    timing          = steps[0];
+    if (seq_AutoTune(&timing, &config, check_TuneMeasure, checkSeq, &result) || (result.steps != 0u) ||
+        (memcmp(&timing, &steps[0], sizeof(timing)) != 0) || (checkSeq[CHECK_DFT_INDEX_1] != tuneBaseCycles)) {
+        fprintf(stderr, "seq_AutoTune(): the starting timing over the threshold was not kept\n");
+        return 1;
+    }
+
+    printf("auto-tuning: %u steps from %u us to %u us, %u to %u ppm\n", count - 1u, steps[0].dftTimeUs,
+           steps[count - 1u].dftTimeUs, spreads[0], spreads[count - 1u]);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (check_Default() || check_Frequency() || check_Cycles() || check_Crc() || check_CrcCache() || check_AutoTune()) {
+        return 1;
+    }
+    printf("sequences: default sequence, DFT windows, CRC, CRC caching and auto-tuning passed\n");
+    return 0;
+}
+
+/*
+** EOF
+*/
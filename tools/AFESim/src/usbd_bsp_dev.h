@@ -0,0 +1,19 @@
+/*!
+ *****************************************************************************
+ * @file:   usbd_bsp_dev.h
+ * @brief:  Host stand-in for the ADuCM350 board support of uC/USB-Device, see usbd_core.h
+ *****************************************************************************/
+
+#ifndef __USBD_BSP_DEV_H__
+#define __USBD_BSP_DEV_H__
+
+#include "usbd_core.h"
+
+extern const USBD_DRV_EP_INFO       USBD_DrvEP_InfoTbl_MUSBMHDRC[];
+extern const USBD_DRV_BSP_API       USBD_DrvBSP_ADI;
+
+#endif /* __USBD_BSP_DEV_H__ */
+
+/*
+** EOF
+*/
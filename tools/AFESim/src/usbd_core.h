@@ -0,0 +1,88 @@
+/*!
+ *****************************************************************************
+ * @file:   usbd_core.h
+ * @brief:  Host stand-in for the uC/USB-Device core, the part usb_stream.c uses
+ *
+ * The device stack is simulated by afesim_usb.c: a host that configures the
+ * function when it starts and reads the bulk IN endpoint at the full speed
+ * bulk rate.
+ *****************************************************************************/
+
+#ifndef __USBD_CORE_H__
+#define __USBD_CORE_H__
+
+#include <stdint.h>
+
+/* uC/CPU types */
+typedef uint8_t                     CPU_INT08U;
+typedef uint16_t                    CPU_INT16U;
+typedef uint32_t                    CPU_INT32U;
+typedef uint32_t                    CPU_ADDR;
+typedef uint8_t                     CPU_BOOLEAN;
+typedef char                        CPU_CHAR;
+
+#define DEF_NO                      (0u)
+#define DEF_YES                     (1u)
+#define DEF_FALSE                   (0u)
+#define DEF_TRUE                    (1u)
+
+typedef enum {
+    USBD_ERR_NONE                   = 0,
+    USBD_ERR_FAIL,
+    USBD_ERR_INVALID_ARG,
+    USBD_ERR_DEV_INVALID_STATE,
+    USBD_ERR_EP_ABORT,
+} USBD_ERR;
+
+typedef enum {
+    USBD_DEV_SPD_INVALID            = 0,
+    USBD_DEV_SPD_LOW,
+    USBD_DEV_SPD_FULL,
+    USBD_DEV_SPD_HIGH,
+} USBD_DEV_SPD;
+
+#define USBD_DEV_ATTRIB_SELF_POWERED    (0x01u)
+#define USBD_LANG_ID_ENGLISH_US         (0x0409u)
+
+typedef struct {
+    CPU_INT16U                      VendorID;
+    CPU_INT16U                      ProductID;
+    CPU_INT16U                      DeviceBCD;
+    const CPU_CHAR                 *ManufacturerStrPtr;
+    const CPU_CHAR                 *ProductStrPtr;
+    const CPU_CHAR                 *SerialNbrStrPtr;
+    CPU_INT16U                      LangID;
+} USBD_DEV_CFG;
+
+typedef struct {
+    CPU_INT08U                      Attrib;
+    CPU_INT08U                      Nbr;
+    CPU_INT16U                      MaxPktSize;
+} USBD_DRV_EP_INFO;
+
+typedef struct {
+    CPU_ADDR                        BaseAddr;
+    CPU_ADDR                        MemAddr;
+    CPU_ADDR                        MemSize;
+    USBD_DEV_SPD                    Spd;
+    const USBD_DRV_EP_INFO         *EP_InfoTbl;
+} USBD_DRV_CFG;
+
+/* Driver and bus interfaces, not used by the simulation */
+typedef struct {
+    void                           *pUnused;
+} USBD_DRV_API, USBD_DRV_BSP_API, USBD_BUS_FNCTS;
+
+void                        USBD_Init               (USBD_ERR *p_err);
+CPU_INT08U                  USBD_DevAdd             (USBD_DEV_CFG *p_dev_cfg, USBD_BUS_FNCTS *p_bus_fnct,
+                                                     USBD_DRV_API *p_drv_api, USBD_DRV_CFG *p_drv_cfg,
+                                                     USBD_DRV_BSP_API *p_bsp_api, USBD_ERR *p_err);
+CPU_INT08U                  USBD_CfgAdd             (CPU_INT08U dev_nbr, CPU_INT08U attrib, CPU_INT16U max_pwr,
+                                                     USBD_DEV_SPD spd, const CPU_CHAR *p_name, USBD_ERR *p_err);
+void                        USBD_DevStart           (CPU_INT08U dev_nbr, USBD_ERR *p_err);
+
+#endif /* __USBD_CORE_H__ */
+
+/*
+** EOF
+*/
@@ -0,0 +1,18 @@
+/*!
+ *****************************************************************************
+ * @file:   usbd_drv_adi.h
+ * @brief:  Host stand-in for the ADI port of uC/USB-Device, see usbd_core.h
+ *****************************************************************************/
+
+#ifndef __USBD_DRV_ADI_H__
+#define __USBD_DRV_ADI_H__
+
+#include "usbd_core.h"
+
+extern const USBD_DRV_API           USBD_DrvAPI_ADI;
+
+#endif /* __USBD_DRV_ADI_H__ */
+
+/*
+** EOF
+*/
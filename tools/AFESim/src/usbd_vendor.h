@@ -0,0 +1,30 @@
+/*!
+ *****************************************************************************
+ * @file:   usbd_vendor.h
+ * @brief:  Host stand-in for the uC/USB-Device vendor class, see usbd_core.h
+ *****************************************************************************/
+
+#ifndef __USBD_VENDOR_H__
+#define __USBD_VENDOR_H__
+
+#include "usbd_core.h"
+
+typedef CPU_BOOLEAN (*USBD_VENDOR_REQ_FNCT)   (CPU_INT08U class_nbr, CPU_INT08U dev_nbr, const void *p_setup_req);
+typedef void        (*USBD_VENDOR_ASYNC_FNCT) (CPU_INT08U class_nbr, void *p_buf, CPU_INT32U buf_len,
+                                               CPU_INT32U xfer_len, void *p_callback_arg, USBD_ERR err);
+
+void                        USBD_Vendor_Init        (USBD_ERR *p_err);
+CPU_INT08U                  USBD_Vendor_Add         (CPU_BOOLEAN intr_en, CPU_INT16U interval,
+                                                     USBD_VENDOR_REQ_FNCT req_callback, USBD_ERR *p_err);
+CPU_BOOLEAN                 USBD_Vendor_CfgAdd      (CPU_INT08U class_nbr, CPU_INT08U dev_nbr, CPU_INT08U cfg_nbr,
+                                                     USBD_ERR *p_err);
+CPU_BOOLEAN                 USBD_Vendor_IsConn      (CPU_INT08U class_nbr);
+void                        USBD_Vendor_WrAsync     (CPU_INT08U class_nbr, void *p_buf, CPU_INT32U buf_len,
+                                                     USBD_VENDOR_ASYNC_FNCT async_fnct, void *p_async_arg,
+                                                     CPU_BOOLEAN end, USBD_ERR *p_err);
+
+#endif /* __USBD_VENDOR_H__ */
+
+/*
+** EOF
+*/
@@ -0,0 +1,182 @@
+/*!
+ *****************************************************************************
+ * @file:   zconv_bench.c
+ * @brief:  Host benchmark of the frame buffer conversion against the per-quad path
+ *
+ * Usage: zconvbench [options]
+ *   -q quads       quads per frame (default PATTERN_MAX_QUADS)
+ *   -r repeats     conversions of the frame, the fastest is kept (default 50)
+ *   -s seed        random generator seed
+ *
+ * A frame of random DFT results, with some open channels, is converted by
+ * one in place zconv_Batch() call and by the per-quad path of the imaging
+ * modes before the frame buffer: open circuit check, q15 to q31 and CMSIS
+ * magnitude on the 4 results of one quad, then the RTIA ratio. Both must
+ * give the same magnitudes. The CMSIS functions are the host references of
+ * afesim_dsp.c, so the times show the per-call overhead saved by the batch,
+ * not Cortex-M3 cycles; the n) benchmark measures those on the board.
+ *****************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "pattern.h"
+#include "zconv.h"
+
+/* As modes.h: RTIA 33k, instrumentation amplifier gain 1.494 */
+#define BENCH_RTIA_AND_GAIN         ((uint32_t)((33000 * 1.5) / 1.494))
+#define BENCH_OPEN_THRESHOLD        (1)
+/* One quad in BENCH_OPEN_EVERY has an open voltage channel */
+#define BENCH_OPEN_EVERY            (37u)
+
+static int16_t             *pRaw;
+static int32_t             *pFrame;
+static int32_t             *pReference;
+
+static double               bench_Now               (void);
+static void                 bench_Generate          (uint32_t quads);
+static void                 bench_PerQuad           (const int16_t *pDft, uint32_t quads, int32_t *pOut);
+static int32_t              bench_Magnitude         (q31_t magnitude_1, q31_t magnitude_2, uint32_t res);
+
+static double bench_Now(void) {
+    struct timespec         now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+/* Current of 2000 to 30000 codes, voltage 1/8 to 1x of it, random phases */
+static void bench_Generate(uint32_t quads) {
+    double                  current, voltage, a, b;
+    uint32_t                i;
+
+    for (i = 0; i < quads; i++) {
+        current = 2000.0 + 28000.0 * drand48();
+        voltage = current * (0.125 + 0.875 * drand48());
+        a       = 2.0 * 3.14159265358979 * drand48();
+        b       = a + 0.5 * (drand48() - 0.25);
+        pRaw[4u * i]      = (int16_t)(current * cos(a));
+        pRaw[4u * i + 1u] = (int16_t)(current * sin(a));
+        pRaw[4u * i + 2u] = (int16_t)(voltage * cos(b));
+        pRaw[4u * i + 3u] = (int16_t)(voltage * sin(b));
+        if (0u == (i % BENCH_OPEN_EVERY)) {
+            pRaw[4u * i + 2u] = 0;
+            pRaw[4u * i + 3u] = 0;
+        }
+    }
+}
+
+/* calculate_magnitude() of OpenEIT.c */
+static int32_t bench_Magnitude(q31_t magnitude_1, q31_t magnitude_2, uint32_t res) {
+    q63_t                   magnitude = 0;
+
+    if ((q63_t)0 != magnitude_2) {
+        magnitude = (q63_t)magnitude_1 * (q63_t)res;
+        magnitude = ((magnitude << 5) / (q63_t)magnitude_2 + 1) >> 1;
+    }
+
+    return (magnitude & 0xFFFFFFFF00000000LL) ? 0x7FFFFFFF : (int32_t)magnitude;
+}
+
+/* The per-quad path: 4 values per CMSIS call */
+static void bench_PerQuad(const int16_t *pDft, uint32_t quads, int32_t *pOut) {
+    int16_t                 dft[ZCONV_DFT_COUNT];
+    q15_t                   dft_q15[ZCONV_DFT_COUNT];
+    q31_t                   dft_q31[ZCONV_DFT_COUNT];
+    q31_t                   magnitude[ZCONV_DFT_COUNT / 2u];
+    uint32_t                i, k;
+
+    for (i = 0; i < quads; i++, pDft += ZCONV_DFT_COUNT) {
+        memcpy(dft, pDft, sizeof(dft));
+        for (k = 0; k < ZCONV_DFT_COUNT; k += 2u) {
+            if ((dft[k] < BENCH_OPEN_THRESHOLD) && (dft[k] > -BENCH_OPEN_THRESHOLD) &&
+                (dft[k + 1u] < BENCH_OPEN_THRESHOLD) && (dft[k + 1u] > -BENCH_OPEN_THRESHOLD)) {
+                dft[k]      = 0;
+                dft[k + 1u] = 0;
+            }
+        }
+        for (k = 0; k < ZCONV_DFT_COUNT; k++) {
+            dft_q15[k] = (q15_t)dft[k];
+        }
+        arm_q15_to_q31(dft_q15, dft_q31, ZCONV_DFT_COUNT);
+        arm_cmplx_mag_q31(dft_q31, magnitude, ZCONV_DFT_COUNT / 2u);
+        pOut[i] = bench_Magnitude(magnitude[1], magnitude[0], BENCH_RTIA_AND_GAIN);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    ZCONV_CONFIG            config = { BENCH_RTIA_AND_GAIN, BENCH_OPEN_THRESHOLD };
+    uint32_t                quads = PATTERN_MAX_QUADS;
+    uint32_t                repeats = 50;
+    long                    seed = 1;
+    double                  start, perQuad = 1e9, batch = 1e9;
+    uint32_t                r, i, mismatches = 0;
+    int                     option;
+
+    while (-1 != (option = getopt(argc, argv, "q:r:s:"))) {
+        switch (option) {
+        case 'q':
+            quads = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'r':
+            repeats = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 's':
+            seed = strtol(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr, "usage: zconvbench [-q quads] [-r repeats] [-s seed]\n");
+            return 2;
+        }
+    }
+    if ((0u == quads) || (0u == repeats)) {
+        fprintf(stderr, "zconvbench: quads and repeats must be positive\n");
+        return 2;
+    }
+
+    pRaw       = malloc(quads * ZCONV_DFT_COUNT * sizeof(int16_t));
+    pFrame     = malloc(quads * 2u * sizeof(int32_t));
+    pReference = malloc(quads * sizeof(int32_t));
+    if ((NULL == pRaw) || (NULL == pFrame) || (NULL == pReference)) {
+        fprintf(stderr, "zconvbench: out of memory\n");
+        return 2;
+    }
+    srand48(seed);
+    bench_Generate(quads);
+
+    for (r = 0; r < repeats; r++) {
+        start = bench_Now();
+        bench_PerQuad(pRaw, quads, pReference);
+        start = bench_Now() - start;
+        perQuad = (start < perQuad) ? start : perQuad;
+
+        /* The capture into the frame buffer is not timed */
+        memcpy(pFrame, pRaw, quads * ZCONV_DFT_COUNT * sizeof(int16_t));
+        start = bench_Now();
+        zconv_Batch(&config, ZCONV_FORMAT_MAGNITUDE, (int16_t *)pFrame, quads, pFrame);
+        start = bench_Now() - start;
+        batch = (start < batch) ? start : batch;
+    }
+
+    for (i = 0; i < quads; i++) {
+        mismatches += (pFrame[i] != pReference[i]) ? 1u : 0u;
+    }
+
+    printf("zconvbench: %u quads, fastest of %u repeats\n", quads, repeats);
+    printf("  per quad      %8.1f ns/quad\n", perQuad * 1e9 / quads);
+    printf("  frame batch   %8.1f ns/quad (%.2fx)\n", batch * 1e9 / quads, perQuad / batch);
+    printf("  mismatches    %u\n", mismatches);
+
+    return (0u == mismatches) ? 0 : 1;
+}
+
+/*
+** EOF
+*/
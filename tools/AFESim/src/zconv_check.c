@@ -0,0 +1,430 @@
+/*!
+ *****************************************************************************
+ * @file:   zconv_check.c
+ * @brief:  Checks of the impedance conversions of zconv.c against double references
+ *
+ * Usage: zconvcheck [options]
+ *   -n count       random measurements (default 200000)
+ *   -s seed        random generator seed
+ *
+ * zconv.c runs on the CMSIS host references of afesim_dsp.c. Checks that:
+ *   - zconv_Arctan() is within CHECK_ARCTAN_LSB of atan2() for every angle,
+ *     and for the full scale and -32768 inputs
+ *   - zconv_Batch() of random measurements, in batches of random sizes and
+ *     in place, gives in every format:
+ *       magnitude     |V| / |I| * rtiaAndGain in 28.4, within the error of
+ *                     the q31 magnitudes, about 1 / |z|^2, plus 1 LSB
+ *       phase         arg(V) - arg(I) in 28.4 degrees, in [-180, 180),
+ *                     within CHECK_PHASE_LSB
+ *       real, imag    V * conj(I) / |I|^2 * rtiaAndGain in 28.4, rounded
+ *       q31           |I| and |V| in q31 of the DFT codes, 2^15 per code,
+ *                     within the truncations of the magnitude kernel: its
+ *                     squares lose up to 1 of 2^31 and its output 1 LSB
+ *     saturated to the 28.4 range, for rtiaAndGain up to 2^24
+ *   - an open channel, an open circuit or a zero current give 0 in every
+ *     format, and large ratios saturate to 0x7FFFFFFF and 0x80000000
+ * A channel of at most 1 code on both parts has a q31 magnitude of 0, its
+ * magnitude and phase are then 0 as for an open channel.
+ * Prints the largest errors, of the magnitudes for channels of more than
+ * CHECK_REPORT_CODES and magnitudes over 2^20, or the first failure and
+ * exits with 1.
+ *****************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "device.h"
+#include "modes.h"
+#include "zconv.h"
+
+#define CHECK_ARCTAN_LSB            (5.0)   /* 1.15 of PI, 0.027 degrees */
+#define CHECK_PHASE_LSB             (2.0)   /* 28.4 degrees, two angles and the rounding */
+#define CHECK_MAX_BATCH             (100u)
+#define CHECK_OPEN_EVERY            (16u)   /* one measurement in 16 has an open channel */
+#define CHECK_FORMATS               (4u)
+#define CHECK_REPORT_CODES          (1000.0L)   /* errors printed for channels of more codes */
+
+/* Reference values of a measurement, long double */
+typedef struct {
+    long double             magI;           /*!< |I| after the open check, DFT codes        */
+    long double             magV;
+    long double             magnitude;      /*!< 28.4 ohms, not saturated                   */
+    long double             phase;          /*!< 28.4 degrees in [-180, 180)                */
+    long double             real;           /*!< 28.4 ohms, not saturated                   */
+    long double             imag;
+} CHECK_REFERENCE;
+
+/* Largest errors seen */
+typedef struct {
+    double                  magnitudePpm;
+    double                  phaseLsb;
+    double                  realImagLsb;
+    double                  q31Lsb;
+} CHECK_ERRORS;
+
+static const uint32_t       checkRtias[]  = { 1, 1000, (uint32_t)((RTIA * 1.5) / INST_AMP_GAIN), 1000000, 1u << 24 };
+static const int16_t        checkOpens[]  = { 0, DFT_RESULTS_OPEN_MAX_THR, 16 };
+static const char          *checkFormats[CHECK_FORMATS] = { "magnitude", "magnitude and phase", "real and imaginary",
+                                                            "q31" };
+static int16_t              checkDft[CHECK_MAX_BATCH * ZCONV_DFT_COUNT];
+static int32_t              checkOut[CHECK_MAX_BATCH * 2u];
+static int32_t              checkInPlace[CHECK_MAX_BATCH * 2u];
+static CHECK_ERRORS         checkErrors;
+
+static long double          check_Saturate          (long double value);
+static long double          check_Q31Error          (long double magnitude);
+static void                 check_Reference         (const ZCONV_CONFIG *pConfig, const int16_t *pDft,
+                                                     CHECK_REFERENCE *pRef);
+static bool_t               check_Value             (const char *pWhat, uint32_t k, int32_t value, long double expect,
+                                                     long double tolerance, double *pMaxError);
+static bool_t               check_Measurement       (const ZCONV_CONFIG *pConfig, ZCONV_FORMAT_TYPE format,
+                                                     const int16_t *pDft, const int32_t *pOut, uint32_t k);
+static int                  check_Arctan            (void);
+static void                 check_Generate          (int16_t *pDft, uint32_t count);
+static int                  check_Batch             (const ZCONV_CONFIG *pConfig, uint32_t count);
+static int                  check_Random            (uint32_t count);
+static int                  check_Edges             (void);
+
+/* Clamp to the 28.4 range, as zconv_Saturate() */
+static long double check_Saturate(long double value) {
+    if (value > 2147483647.0L) {
+        return 2147483647.0L;
+    }
+    if (value < -2147483648.0L) {
+        return -2147483648.0L;
+    }
+
+    return value;
+}
+
+/* Largest error of the q31 magnitude of a channel, in LSB */
+static long double check_Q31Error(long double magnitude) {
+    long double             q31 = magnitude * 32768.0L;
+    long double             square = q31 * q31 - 2147483648.0L;
+
+    return (0.0L == magnitude) ? 0.0L : q31 - ((square > 0.0L) ? sqrtl(square) : 0.0L) + 1.0L;
+}
+
+/* Impedance of a measurement, from its DFT codes */
+static void check_Reference(const ZCONV_CONFIG *pConfig, const int16_t *pDft, CHECK_REFERENCE *pRef) {
+    long double             dft[ZCONV_DFT_COUNT];
+    long double             scale = (long double)pConfig->rtiaAndGain * 16.0L;
+    long double             power, phase;
+    bool_t                  bZero[2];
+    uint32_t                k;
+
+    for (k = 0; k < ZCONV_DFT_COUNT; k += 2u) {
+        dft[k]      = pDft[k];
+        dft[k + 1u] = pDft[k + 1u];
+        if ((abs(pDft[k]) < pConfig->openThreshold) && (abs(pDft[k + 1u]) < pConfig->openThreshold)) {
+            dft[k]      = 0;
+            dft[k + 1u] = 0;
+        }
+        bZero[k / 2u] = ((fabsl(dft[k]) <= 1.0L) && (fabsl(dft[k + 1u]) <= 1.0L)) ? true : false;
+    }
+
+    pRef->magI      = hypotl(dft[0], dft[1]);
+    pRef->magV      = hypotl(dft[2], dft[3]);
+    pRef->magnitude = 0;
+    pRef->phase     = 0;
+    pRef->real      = 0;
+    pRef->imag      = 0;
+    if (0.0L == pRef->magI) {
+        return;
+    }
+
+    power      = dft[0] * dft[0] + dft[1] * dft[1];
+    pRef->real = (dft[2] * dft[0] + dft[3] * dft[1]) / power * scale;
+    pRef->imag = (dft[3] * dft[0] - dft[2] * dft[1]) / power * scale;
+    if (bZero[0]) {
+        return;
+    }
+    pRef->magnitude = bZero[1] ? 0.0L : pRef->magV / pRef->magI * scale;
+    if (!bZero[1]) {
+        phase = (atan2l(dft[3], dft[2]) - atan2l(dft[1], dft[0])) * 180.0L / M_PI;
+        phase = (phase >= 180.0L) ? phase - 360.0L : ((phase < -180.0L) ? phase + 360.0L : phase);
+        pRef->phase = phase * 16.0L;
+    }
+}
+
+/* A value within tolerance of its reference */
+static bool_t check_Value(const char *pWhat, uint32_t k, int32_t value, long double expect, long double tolerance,
+                          double *pMaxError) {
+    long double             error = fabsl((long double)value - expect);
+
+    if (error > tolerance) {
+        fprintf(stderr, "measurement %u, %s: %d, %.3Lf expected within %.3Lf\n", k, pWhat, value, expect, tolerance);
+        return false;
+    }
+    if ((NULL != pMaxError) && (error > *pMaxError)) {
+        *pMaxError = (double)error;
+    }
+
+    return true;
+}
+
+/* The values of measurement k against the reference */
+static bool_t check_Measurement(const ZCONV_CONFIG *pConfig, ZCONV_FORMAT_TYPE format, const int16_t *pDft,
+                                const int32_t *pOut, uint32_t k) {
+    CHECK_REFERENCE         ref;
+    long double             expect, tolerance, error, errorI, errorV;
+    double                  ppm;
+
+    check_Reference(pConfig, pDft, &ref);
+
+    switch (format) {
+    case ZCONV_FORMAT_MAGNITUDE:
+    case ZCONV_FORMAT_MAG_PHASE:
+        expect    = check_Saturate(ref.magnitude);
+        tolerance = 1.0L;
+        if (0.0L != ref.magnitude) {
+            /* Relative errors of the q31 magnitudes, |V| low or |I| low */
+            errorI     = check_Q31Error(ref.magI) / (ref.magI * 32768.0L);
+            errorV     = check_Q31Error(ref.magV) / (ref.magV * 32768.0L);
+            tolerance += ref.magnitude * (errorV + errorI / (1.0L - errorI));
+        }
+        ppm = 0;
+        if (!check_Value("magnitude", k, pOut[0], expect, tolerance, &ppm)) {
+            return false;
+        }
+        if ((ref.magI > CHECK_REPORT_CODES) && (ref.magV > CHECK_REPORT_CODES) &&
+            (expect > 1048576.0L) && (expect < 2147483647.0L)) {
+            ppm = ppm * 1e6 / expect;
+            checkErrors.magnitudePpm = (ppm > checkErrors.magnitudePpm) ? ppm : checkErrors.magnitudePpm;
+        }
+        if (ZCONV_FORMAT_MAG_PHASE == format) {
+            /* Around +-180 the phase can wrap to the other end */
+            error = fabsl((long double)pOut[1] - ref.phase);
+            error = (error > 2880.0L) ? 5760.0L - error : error;
+            /* +180 rounds to 2880, the same angle as -180 */
+            if ((error > CHECK_PHASE_LSB) || (pOut[1] < -2880) || (pOut[1] > 2880)) {
+                fprintf(stderr, "measurement %u, phase: %d, %.3Lf expected\n", k, pOut[1], ref.phase);
+                return false;
+            }
+            checkErrors.phaseLsb = ((double)error > checkErrors.phaseLsb) ? (double)error : checkErrors.phaseLsb;
+        }
+        return true;
+
+    case ZCONV_FORMAT_REAL_IMAG:
+        return check_Value("real part", k, pOut[0], check_Saturate(ref.real), 0.5L + 1e-9L,
+                           &checkErrors.realImagLsb) &&
+               check_Value("imaginary part", k, pOut[1], check_Saturate(ref.imag), 0.5L + 1e-9L,
+                           &checkErrors.realImagLsb);
+
+    default:
+        return check_Value("q31 |I|", k, pOut[0], ref.magI * 32768.0L, check_Q31Error(ref.magI),
+                           (ref.magI > CHECK_REPORT_CODES) ? &checkErrors.q31Lsb : NULL) &&
+               check_Value("q31 |V|", k, pOut[1], ref.magV * 32768.0L, check_Q31Error(ref.magV),
+                           (ref.magV > CHECK_REPORT_CODES) ? &checkErrors.q31Lsb : NULL);
+    }
+}
+
+/* Every angle, at several radii, and the extreme codes */
+static int check_Arctan(void) {
+    static const int32_t    radii[] = { 16, 100, 1000, 20000, 32767 };
+    static const int16_t    edges[] = { -32768, -32767, -1, 0, 1, 32767 };
+    int32_t                 re, im;
+    uint32_t                r, a, i, j;
+    double                  angle, error, maxError = 0;
+
+    for (r = 0; r < sizeof(radii) / sizeof(radii[0]); r++) {
+        for (a = 0; a < 65536u; a++) {
+            angle = (a - 32768.0) * M_PI / 32768.0;
+            re    = (int32_t)lrint(radii[r] * cos(angle));
+            im    = (int32_t)lrint(radii[r] * sin(angle));
+            re    = (re > 32767) ? 32767 : re;
+            im    = (im > 32767) ? 32767 : im;
+            if ((0 == re) && (0 == im)) {
+                continue;
+            }
+            error = fabs(zconv_Arctan((q15_t)im, (q15_t)re) - atan2(im, re) * 32768.0 / M_PI);
+            error = (error > 32768.0) ? 65536.0 - error : error;
+            if (error > CHECK_ARCTAN_LSB) {
+                fprintf(stderr, "zconv_Arctan(%d, %d) = %d, %.1f expected\n", im, re,
+                        zconv_Arctan((q15_t)im, (q15_t)re), atan2(im, re) * 32768.0 / M_PI);
+                return 1;
+            }
+            maxError = (error > maxError) ? error : maxError;
+        }
+    }
+
+    for (i = 0; i < sizeof(edges) / sizeof(edges[0]); i++) {
+        for (j = 0; j < sizeof(edges) / sizeof(edges[0]); j++) {
+            if ((0 == edges[i]) && (0 == edges[j])) {
+                continue;
+            }
+            error = fabs(zconv_Arctan(edges[i], edges[j]) - atan2(edges[i], edges[j]) * 32768.0 / M_PI);
+            error = (error > 32768.0) ? 65536.0 - error : error;
+            if (error > CHECK_ARCTAN_LSB) {
+                fprintf(stderr, "zconv_Arctan(%d, %d) = %d, %.1f expected\n", edges[i], edges[j],
+                        zconv_Arctan(edges[i], edges[j]), atan2(edges[i], edges[j]) * 32768.0 / M_PI);
+                return 1;
+            }
+        }
+    }
+    printf("arctan: %.2f LSB of 1.15 at most, %.4f degrees\n", maxError, maxError * 180.0 / 32768.0);
+
+    return 0;
+}
+
+/* Currents of 16 codes to full scale, any voltage up to full scale, any phases */
+static void check_Generate(int16_t *pDft, uint32_t count) {
+    double                  current, voltage, a, b;
+    uint32_t                i, k;
+
+    for (i = 0; i < count; i++, pDft += ZCONV_DFT_COUNT) {
+        current = 16.0 * pow(32767.0 / 16.0, drand48());
+        voltage = 16.0 * pow(32767.0 / 16.0, drand48());
+        a       = 2.0 * M_PI * drand48();
+        b       = 2.0 * M_PI * drand48();
+        pDft[0] = (int16_t)lrint(current * cos(a));
+        pDft[1] = (int16_t)lrint(current * sin(a));
+        pDft[2] = (int16_t)lrint(voltage * cos(b));
+        pDft[3] = (int16_t)lrint(voltage * sin(b));
+        if (0u == (lrand48() % CHECK_OPEN_EVERY)) {
+            k           = (lrand48() & 1) ? 0u : 2u;
+            pDft[k]      = (int16_t)(lrand48() % 3) - 1;
+            pDft[k + 1u] = (int16_t)(lrand48() % 3) - 1;
+        }
+    }
+}
+
+/* One batch in every format, into a buffer and in place */
+static int check_Batch(const ZCONV_CONFIG *pConfig, uint32_t count) {
+    ZCONV_FORMAT_TYPE       format;
+    uint32_t                i, values;
+
+    for (format = ZCONV_FORMAT_MAGNITUDE; format <= ZCONV_FORMAT_RAW_Q31; format++) {
+        values = ZCONV_VALUES(format);
+        if (zconv_Batch(pConfig, format, checkDft, count, checkOut) != count * values) {
+            fprintf(stderr, "zconv_Batch(), %s: not %u values\n", checkFormats[format], count * values);
+            return 1;
+        }
+        for (i = 0; i < count; i++) {
+            if (!check_Measurement(pConfig, format, &checkDft[i * ZCONV_DFT_COUNT], &checkOut[i * values], i)) {
+                fprintf(stderr, "zconv_Batch(), %s, rtiaAndGain %u, open threshold %d: %d %d %d %d\n",
+                        checkFormats[format], pConfig->rtiaAndGain, pConfig->openThreshold,
+                        checkDft[i * ZCONV_DFT_COUNT], checkDft[i * ZCONV_DFT_COUNT + 1u],
+                        checkDft[i * ZCONV_DFT_COUNT + 2u], checkDft[i * ZCONV_DFT_COUNT + 3u]);
+                return 1;
+            }
+        }
+
+        memcpy(checkInPlace, checkDft, count * ZCONV_DFT_COUNT * sizeof(int16_t));
+        zconv_Batch(pConfig, format, (const int16_t *)checkInPlace, count, checkInPlace);
+        if (memcmp(checkInPlace, checkOut, count * values * sizeof(int32_t)) != 0) {
+            fprintf(stderr, "zconv_Batch(), %s: %u measurements converted in place differ\n", checkFormats[format],
+                    count);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* Random measurements in batches of random sizes */
+static int check_Random(uint32_t count) {
+    ZCONV_CONFIG            config;
+    uint32_t                done, n;
+
+    for (done = 0; done < count; done += n) {
+        n = 1u + (uint32_t)lrand48() % CHECK_MAX_BATCH;
+        n = (n > count - done) ? count - done : n;
+        config.rtiaAndGain   = checkRtias[lrand48() % (sizeof(checkRtias) / sizeof(checkRtias[0]))];
+        config.openThreshold = checkOpens[lrand48() % (sizeof(checkOpens) / sizeof(checkOpens[0]))];
+        check_Generate(checkDft, n);
+        if (check_Batch(&config, n)) {
+            return 1;
+        }
+    }
+    printf("%u measurements, largest errors: phase %.2f LSB, real and imaginary %.3f LSB, above %.0Lf codes: "
+           "magnitude %.2f ppm, q31 %.0f LSB\n", count, checkErrors.phaseLsb, checkErrors.realImagLsb,
+           CHECK_REPORT_CODES, checkErrors.magnitudePpm, checkErrors.q31Lsb);
+
+    return 0;
+}
+
+/* Open channels, zero current, saturation and -32768 codes */
+static int check_Edges(void) {
+    static const int16_t    edges[][ZCONV_DFT_COUNT] = {
+        { 0, 0, 1000, -2000 },              /* open current: 0 in every format                  */
+        { 1, -1, 1000, -2000 },             /* ... below the threshold                          */
+        { 1000, -2000, 0, 1 },              /* open voltage                                     */
+        { 0, 0, 0, 0 },                     /* open circuit                                     */
+        { 2, 0, 32767, 0 },                 /* saturates to 0x7FFFFFFF, real positive           */
+        { 2, 0, -32767, 0 },                /* ... real negative, 0x80000000                    */
+        { 0, 2, 0, 32767 },                 /* ... real positive, imaginary 0                   */
+        { 2, 0, 0, -32767 },                /* ... imaginary negative                           */
+        { -32768, -32768, -32768, 0 },      /* full scale negative codes                        */
+        { -32768, 0, 0, -32768 },
+        { 32767, 32767, -32768, -32768 },
+        { 3, 0, -3, 0 },                    /* phase of -180 degrees, wraps to [-180, 180)      */
+    };
+    static const int32_t    saturated[][2] = {
+        { 0x7FFFFFFF, 0 }, { (int32_t)0x80000000, 0 }, { 0x7FFFFFFF, 0 }, { 0, (int32_t)0x80000000 },
+    };
+    ZCONV_CONFIG            config = { 1000000, 2 };
+    ZCONV_FORMAT_TYPE       format;
+    uint32_t                i, n = sizeof(edges) / sizeof(edges[0]);
+
+    memcpy(checkDft, edges, sizeof(edges));
+    if (check_Batch(&config, n)) {
+        return 1;
+    }
+
+    /* Open and zero channels give exact zeros, large ratios the ends of the range */
+    for (format = ZCONV_FORMAT_MAGNITUDE; format <= ZCONV_FORMAT_RAW_Q31; format++) {
+        zconv_Batch(&config, format, checkDft, n, checkOut);
+        for (i = 0; i < 4u * ZCONV_VALUES(format); i++) {
+            /* q31: |I| of the first two cases, |V| of the last two */
+            if (((ZCONV_FORMAT_RAW_Q31 != format) || (i == 0u) || (i == 2u) || (i >= 5u)) && (0 != checkOut[i])) {
+                fprintf(stderr, "%s: edge case %u, an open channel gives %d\n", checkFormats[format],
+                        i / ZCONV_VALUES(format), checkOut[i]);
+                return 1;
+            }
+        }
+        for (i = 0; i < 4u; i++) {
+            if (((ZCONV_FORMAT_MAGNITUDE == format) && (0x7FFFFFFF != checkOut[4u + i])) ||
+                ((ZCONV_FORMAT_REAL_IMAG == format) && ((saturated[i][0] != checkOut[8u + 2u * i]) ||
+                                                        (saturated[i][1] != checkOut[9u + 2u * i])))) {
+                fprintf(stderr, "%s: edge case %u is not saturated\n", checkFormats[format], 4u + i);
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    uint32_t                count = 200000;
+    long                    seed  = 1;
+    int                     opt;
+
+    while ((opt = getopt(argc, argv, "n:s:")) != -1) {
+        switch (opt) {
+        case 'n': count = (uint32_t)strtoul(optarg, NULL, 0);       break;
+        case 's': seed  = strtol(optarg, NULL, 0);                  break;
+        default:
+            fprintf(stderr, "usage: zconvcheck [-n count] [-s seed]\n");
+            return 1;
+        }
+    }
+    srand48(seed);
+
+    if (check_Arctan() || check_Edges() || check_Random(count)) {
+        return 1;
+    }
+    printf("impedance conversion: arctan, open channels, saturation and %u measurements in 4 formats passed\n",
+           count);
+    return 0;
+}
+
+/*
+** EOF
+*/
@@ -0,0 +1,345 @@
+/*
+ * EIT binary stream decoder.
+ */
+
+#include "EitFrame.h"
+
+using namespace std;
+
+namespace
+{
+  uint32_t
+  GetU32(deque<uint8_t> const & buf, size_t offset)
+  {
+    return  static_cast<uint32_t>(buf[offset])
+         | (static_cast<uint32_t>(buf[offset + 1]) << 8)
+         | (static_cast<uint32_t>(buf[offset + 2]) << 16)
+         | (static_cast<uint32_t>(buf[offset + 3]) << 24);
+  }
+
+  uint16_t
+  GetU16(deque<uint8_t> const & buf, size_t offset)
+  {
+    return static_cast<uint16_t>(buf[offset] | (buf[offset + 1] << 8));
+  }
+}
+
+double
+EitFrame::Value(size_t i) const
+{
+  if (Excitation() || Plan() || Format() == kEitFormatQ31)
+    return values[i];
+  // 28.4 fixed point
+  return values[i] / 16.0;
+}
+
+size_t
+EitFrame::QuadCount() const
+{
+  if (frequencies.empty())
+    return 0;
+  return values.size() / (frequencies.size() * ValuesPerMeasurement());
+}
+
+double
+EitFrame::Value(size_t quad, size_t f, size_t k) const
+{
+  return Value((quad * frequencies.size() + f) * ValuesPerMeasurement() + k);
+}
+
+bool
+EitFrame::Expand(EitFrame const & plan)
+{
+  if (!Reduced() || !plan.Plan() || frequencies.empty())
+    return false;
+
+  size_t perQuad  = frequencies.size() * ValuesPerMeasurement();
+  size_t measured = QuadCount();
+  if (plan.frequency != measured)
+    return false;
+
+  vector<int32_t> full(plan.values.size() * perQuad);
+  for (size_t q = 0; q < plan.values.size(); ++q)
+  {
+    int32_t entry = plan.values[q];
+    size_t  k     = static_cast<size_t>(entry < 0 ? -entry : entry) - 1;
+    if (entry == 0 || k >= measured)
+      return false;
+
+    for (size_t i = 0; i < perQuad; ++i)
+    {
+      int32_t value = values[k * perQuad + i];
+      if (entry < 0 && !Variance())
+      {
+        if (Format() == kEitFormatRealImag)
+          value = -value;
+        // 180 degrees in 28.4, the phase stays within +-180
+        else if (Format() == kEitFormatMagPhase && (i % 2) == 1)
+          value += (value > 0) ? -2880 : 2880;
+      }
+      full[q * perQuad + i] = value;
+    }
+  }
+
+  values.swap(full);
+  flags &= static_cast<uint8_t>(~kEitFlagReduced);
+  return true;
+}
+
+EitFrameDecoder::EitFrameDecoder()
+  : mHaveSequence(false),
+    mNextSequence(0),
+    mCrcErrors(0),
+    mSkippedBytes(0),
+    mLostFrames(0),
+    mDeltaErrors(0),
+    mTimeErrors(0),
+    mHaveReference(false),
+    mReference(),
+    mHaveTime(false),
+    mTimeValid(false),
+    mTime(0)
+{
+}
+
+uint16_t
+EitFrameDecoder::Crc16(uint16_t crc, uint8_t const * data, size_t size)
+{
+  for (size_t i = 0; i < size; ++i)
+  {
+    crc ^= static_cast<uint16_t>(data[i] << 8);
+    for (int bit = 0; bit < 8; ++bit)
+      crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021)
+                           : static_cast<uint16_t>(crc << 1);
+  }
+  return crc;
+}
+
+void
+EitFrameDecoder::Feed(uint8_t const * data, size_t size)
+{
+  mBuf.insert(mBuf.end(), data, data + size);
+}
+
+void
+EitFrameDecoder::KeepReference(EitFrame const & frame)
+{
+  // Only single frequency measurement frames are references
+  uint8_t other = kEitFlagMultiFreq | kEitFlagVariance | kEitFlagExcitation | kEitFlagPlan;
+  if ((frame.flags & other) == 0)
+  {
+    mReference     = frame;
+    mHaveReference = true;
+  }
+}
+
+bool
+EitFrameDecoder::DecodeDelta(EitFrame & frame)
+{
+  // The payload words hold the descriptor, then the encoded residuals
+  if (frame.values.empty() || !mHaveReference)
+    return false;
+  uint32_t descriptor = static_cast<uint32_t>(frame.values[0]);
+  size_t   count      = descriptor & 0xFFFF;
+  uint32_t back       = (descriptor >> 16) & 0xFF;
+  unsigned width      = (descriptor >> 24) & 0x3F;
+  unsigned encoding   = descriptor >> 30;
+  if (frame.sequence - mReference.sequence != back
+      || (frame.flags & ~kEitFlagDelta) != mReference.flags
+      || frame.mode != mReference.mode || frame.nEl != mReference.nEl
+      || count != mReference.values.size() || encoding > 1 || width > 32)
+    return false;
+
+  vector<uint8_t> bytes;
+  for (size_t i = 1; i < frame.values.size(); ++i)
+    for (int b = 0; b < 4; ++b)
+      bytes.push_back(static_cast<uint8_t>(static_cast<uint32_t>(frame.values[i]) >> (8 * b)));
+
+  vector<int32_t> values(count);
+  size_t   pos  = 0;
+  uint64_t bits = 0;
+  unsigned have = 0;
+  for (size_t i = 0; i < count; ++i)
+  {
+    uint32_t residual = 0;
+    if (encoding == 1)
+    {
+      while (have < width)
+      {
+        if (pos >= bytes.size())
+          return false;
+        bits |= static_cast<uint64_t>(bytes[pos++]) << have;
+        have += 8;
+      }
+      residual = static_cast<uint32_t>(bits & ((static_cast<uint64_t>(1) << width) - 1));
+      bits >>= width;
+      have  -= width;
+    }
+    else
+    {
+      for (unsigned shift = 0;; shift += 7)
+      {
+        if (pos >= bytes.size() || shift > 28)
+          return false;
+        uint8_t byte = bytes[pos++];
+        residual |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+          break;
+      }
+    }
+    // Zig-zag back to the difference, modulo 2^32
+    uint32_t difference = (residual >> 1) ^ (0u - (residual & 1));
+    values[i] = static_cast<int32_t>(static_cast<uint32_t>(mReference.values[i]) + difference);
+  }
+
+  frame.values.swap(values);
+  frame.flags &= static_cast<uint8_t>(~kEitFlagDelta);
+  return true;
+}
+
+void
+EitFrameDecoder::DecodeTime(EitFrame & frame, uint64_t field)
+{
+  frame.timeValid = false;
+  frame.time      = 0;
+  if (frame.version != kVersionTime)
+    return;
+
+  uint32_t value = static_cast<uint32_t>(field >> 1);
+  if (field & 1)
+  {
+    // A key: the tick modulo 2^32, unwrapped to the nearest of the last time
+    if (mHaveTime)
+      mTime += static_cast<int64_t>(static_cast<int32_t>(value - static_cast<uint32_t>(mTime)));
+    else
+      mTime = value;
+    mHaveTime  = true;
+    mTimeValid = true;
+  }
+  else if (mTimeValid)
+  {
+    // Zig-zag back to the difference with the previous frame
+    mTime += static_cast<int64_t>(static_cast<int32_t>((value >> 1) ^ (0u - (value & 1))));
+  }
+  else
+  {
+    ++mTimeErrors;
+    return;
+  }
+  frame.timeValid = true;
+  frame.time      = mTime;
+}
+
+void
+EitFrameDecoder::Skip(size_t n)
+{
+  mBuf.erase(mBuf.begin(), mBuf.begin() + n);
+  mSkippedBytes += n;
+}
+
+bool
+EitFrameDecoder::Next(EitFrame & frame)
+{
+  for (;;)
+  {
+    // Hunt for the sync bytes
+    while (mBuf.size() >= 2 && (mBuf[0] != kSync0 || mBuf[1] != kSync1))
+      Skip(1);
+
+    if (mBuf.size() < kHeaderSize)
+      return false;
+
+    if (mBuf[2] != kVersion && mBuf[2] != kVersionTime)
+    {
+      Skip(1);
+      continue;
+    }
+
+    // The time field, a varint between the header and the payload
+    uint64_t field    = 0;
+    size_t   timeSize = 0;
+    if (mBuf[2] == kVersionTime)
+    {
+      bool more = true;
+      while (more && timeSize < kTimeMaxSize)
+      {
+        if (mBuf.size() <= kHeaderSize + timeSize)
+          return false;
+        uint8_t byte = mBuf[kHeaderSize + timeSize];
+        field |= static_cast<uint64_t>(byte & 0x7F) << (7 * timeSize);
+        more   = (byte & 0x80) != 0;
+        ++timeSize;
+      }
+      if (more)
+      {
+        Skip(1);
+        continue;
+      }
+    }
+    size_t payload = kHeaderSize + timeSize;
+
+    size_t count = GetU16(mBuf, 6);
+    size_t total = payload + 4 * count + kCrcSize;
+    if (mBuf.size() < total)
+      return false;
+
+    vector<uint8_t> body(mBuf.begin() + 2, mBuf.begin() + (total - kCrcSize));
+    if (Crc16(0xFFFF, &body[0], body.size()) != GetU16(mBuf, total - kCrcSize))
+    {
+      // Corrupted or false sync, resynchronize on the next byte
+      ++mCrcErrors;
+      Skip(1);
+      continue;
+    }
+
+    frame.version   = mBuf[2];
+    frame.flags     = mBuf[3];
+    frame.mode      = mBuf[4];
+    frame.nEl       = mBuf[5];
+    frame.frequency = GetU32(mBuf, 8);
+    frame.sequence  = GetU32(mBuf, 12);
+
+    // Multi-frequency frames start with their frequency table
+    size_t nFreq = 1;
+    if (frame.flags & kEitFlagMultiFreq)
+      nFreq = frame.frequency < count ? frame.frequency : count;
+    frame.frequencies.resize(nFreq);
+    if (frame.flags & kEitFlagMultiFreq)
+    {
+      for (size_t i = 0; i < nFreq; ++i)
+        frame.frequencies[i] = GetU32(mBuf, payload + 4 * i);
+    }
+    else
+    {
+      frame.frequencies[0] = frame.frequency;
+      nFreq = 0;
+    }
+
+    frame.values.resize(count - nFreq);
+    for (size_t i = 0; i < count - nFreq; ++i)
+      frame.values[i] = static_cast<int32_t>(GetU32(mBuf, payload + 4 * (nFreq + i)));
+
+    if (mHaveSequence && frame.sequence != mNextSequence)
+    {
+      // The time of the next frames is coded against the lost ones
+      mLostFrames += frame.sequence - mNextSequence;
+      mTimeValid   = false;
+    }
+    mHaveSequence = true;
+    mNextSequence = frame.sequence + 1;
+    DecodeTime(frame, field);
+
+    mBuf.erase(mBuf.begin(), mBuf.begin() + total);
+
+    if ((frame.flags & kEitFlagDelta) && !DecodeDelta(frame))
+    {
+      // Its reference was lost, the next delta frames cannot be decoded
+      // either until a key frame
+      ++mDeltaErrors;
+      mHaveReference = false;
+      continue;
+    }
+    KeepReference(frame);
+    return true;
+  }
+}
@@ -0,0 +1,150 @@
+/*
+ * EIT binary stream decoder.
+ *
+ * Decodes the frames produced by eit_stream.c on the ADuCM350 firmware.
+ * See eit_stream.h in the firmware tree for the frame layout.
+ */
+
+#ifndef EIT_FRAME_H
+#define EIT_FRAME_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <deque>
+#include <vector>
+
+// Payload formats, bits [1:0] of the flags field
+enum EitFormat
+{
+  kEitFormatFixed32   = 0,
+  kEitFormatQ31       = 1,
+  kEitFormatMagPhase  = 2,
+  kEitFormatRealImag  = 3
+};
+
+// Multi-frequency frame, bit 2 of the flags field
+static const uint8_t kEitFlagMultiFreq = 0x04;
+// Variances of the previous, averaged frame, bit 3 of the flags field
+static const uint8_t kEitFlagVariance  = 0x08;
+// Excitation amplitude of every quad of the previous frame, bit 4 of the
+// flags field
+static const uint8_t kEitFlagExcitation = 0x10;
+// Reduced measurement plan of the following frames, bit 5 of the flags
+// field: one entry per quad of the full pattern, k + 1 for the value of
+// measured quad k, -(k + 1) for its negated value
+static const uint8_t kEitFlagPlan      = 0x20;
+// Measured quads of a reduced plan only, bit 6 of the flags field
+static const uint8_t kEitFlagReduced   = 0x40;
+// Residuals against the previous frame of the same layout, bit 7 of the
+// flags field; decoded by EitFrameDecoder::Next(), which clears the flag
+static const uint8_t kEitFlagDelta     = 0x80;
+
+// Ticks of the timestamps, microseconds
+static const double kEitTickHz = 1e6;
+
+struct EitFrame
+{
+  uint8_t              version;
+  uint8_t              flags;
+  uint8_t              mode;
+  uint8_t              nEl;
+  uint32_t             frequency;
+  uint32_t             sequence;
+  // Excitation frequencies, in measurement order (one entry for single
+  // frequency frames)
+  std::vector<uint32_t> frequencies;
+  // Measurements, frequency table excluded. Multi-frequency frames hold all
+  // the frequencies of quad 0, then all the frequencies of quad 1, ...
+  std::vector<int32_t> values;
+  // Start of the acquisition, in ticks since the first timestamp of the
+  // stream (the device tick, unwrapped past its 32 bits). Only frames of
+  // the timestamped version carry it, and a frame coded against the tick
+  // of a lost frame has no time until the next key
+  bool                 timeValid;
+  uint64_t             time;
+
+  EitFormat Format() const {return static_cast<EitFormat>(flags & 0x03);};
+  bool MultiFrequency() const {return (flags & kEitFlagMultiFreq) != 0;};
+  bool Variance() const {return (flags & kEitFlagVariance) != 0;};
+  bool Excitation() const {return (flags & kEitFlagExcitation) != 0;};
+  bool Plan() const {return (flags & kEitFlagPlan) != 0;};
+  bool Reduced() const {return (flags & kEitFlagReduced) != 0;};
+
+  // Values per measurement: one 28.4 magnitude, q31 current and voltage,
+  // 28.4 magnitude and phase, or 28.4 real and imaginary parts; one DAC
+  // amplitude per quad in excitation frames, one entry in plan frames
+  size_t ValuesPerMeasurement() const
+  {return (Excitation() || Plan() || Format() == kEitFormatFixed32) ? 1 : 2;};
+  size_t QuadCount() const;
+
+  // Value in engineering units: ohms or degrees for 28.4 values, raw for q31
+  // and for excitation amplitudes
+  double Value(size_t i) const;
+  // Value k of a quad measured at frequency index f
+  double Value(size_t quad, size_t f, size_t k) const;
+
+  // Expand a reduced frame to every quad of the full pattern with the last
+  // plan frame; false, and the frame left as it is, if the plan does not
+  // match. Negated complex values get the opposite sign, or the opposite
+  // phase; variances and magnitudes are copied.
+  bool Expand(EitFrame const & plan);
+};
+
+class EitFrameDecoder
+{
+public:
+  static const uint8_t  kSync0      = 0x45;
+  static const uint8_t  kSync1      = 0x49;
+  static const uint8_t  kVersion    = 1;
+  // Header followed by a time field
+  static const uint8_t  kVersionTime = 2;
+  static const size_t   kTimeMaxSize = 5;
+  static const size_t   kHeaderSize = 16;
+  static const size_t   kCrcSize    = 2;
+
+  EitFrameDecoder();
+
+  // Append received bytes
+  void Feed(uint8_t const * data, size_t size);
+
+  // Extract the next complete frame, false if none is available yet
+  bool Next(EitFrame & frame);
+
+  unsigned long GetCrcErrors()    const {return mCrcErrors;};
+  unsigned long GetSkippedBytes() const {return mSkippedBytes;};
+  unsigned long GetLostFrames()   const {return mLostFrames;};
+  // Delta frames dropped for want of their reference frame
+  unsigned long GetDeltaErrors()  const {return mDeltaErrors;};
+  // Timestamped frames without a time, coded against a lost frame
+  unsigned long GetTimeErrors()   const {return mTimeErrors;};
+
+  static uint16_t Crc16(uint16_t crc, uint8_t const * data, size_t size);
+
+private:
+  void Skip(size_t n);
+  bool DecodeDelta(EitFrame & frame);
+  void KeepReference(EitFrame const & frame);
+  void DecodeTime(EitFrame & frame, uint64_t field);
+
+  std::deque<uint8_t> mBuf;
+  bool                mHaveSequence;
+  uint32_t            mNextSequence;
+  unsigned long       mCrcErrors;
+  unsigned long       mSkippedBytes;
+  unsigned long       mLostFrames;
+  unsigned long       mDeltaErrors;
+  unsigned long       mTimeErrors;
+
+  // Reference of the next delta frame: the last measurement frame
+  bool                mHaveReference;
+  EitFrame            mReference;
+
+  // Tick of the last timestamped frame, unwrapped, and whether the next
+  // difference applies to it
+  bool                mHaveTime;
+  bool                mTimeValid;
+  uint64_t            mTime;
+};
+
+#endif // EIT_FRAME_H
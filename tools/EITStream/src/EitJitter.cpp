@@ -0,0 +1,246 @@
+/*
+ * EIT record timing.
+ *
+ * Usage: eitjitter [-a] [-c] [-n interval] [capture file]
+ *
+ * Reads a capture of the firmware output with timestamps on (or stdin),
+ * binary frames, or ASCII lines with -a, and prints the statistics of the
+ * intervals between the measurement records by their device timestamps:
+ * count, mean, standard deviation, min, max, median, 1st and 99th
+ * percentiles, the largest deviation from the median and the gaps longer
+ * than 1.5 median intervals. With -n, the nominal interval in microseconds,
+ * the mean is also given as a clock error in ppm and the jitter as the RMS
+ * deviation from the nominal. With -c, one CSV line per record goes to
+ * stdout, record, mode, time and interval in microseconds, for aligning the
+ * frames with other recordings, and the statistics go to stderr.
+ *
+ * In binary, the records are the measurement frames; variance, excitation
+ * and plan frames carry the time of their frame and are skipped. In ASCII,
+ * the records are the lines starting with a "t=tick;", "t+d;" or "t-d;"
+ * timestamp, variance lines excepted, and the mode is not known. An
+ * interval is only taken between two consecutive records with a time, of
+ * the same mode: a lost frame, or a line that does not parse, restarts the
+ * intervals at the next key.
+ */
+
+#include "EitFrame.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+  struct Timing
+  {
+    bool             csv;
+    unsigned long    records;
+    unsigned long    untimed;
+    bool             havePrevious;
+    int              previousMode;
+    uint64_t         previous;
+    vector<double>   intervals;
+  };
+
+  // Add a record, time in ticks, or none
+  void
+  Record(Timing & timing, int mode, bool timeValid, uint64_t time)
+  {
+    double interval = 0;
+    bool   haveInterval = timing.havePrevious && timeValid && mode == timing.previousMode;
+
+    if (haveInterval)
+    {
+      interval = (static_cast<double>(time) - static_cast<double>(timing.previous)) * 1e6 / kEitTickHz;
+      timing.intervals.push_back(interval);
+    }
+    if (timing.csv)
+    {
+      if (timeValid)
+        printf("%lu,%d,%.0f,", timing.records, mode, time * 1e6 / kEitTickHz);
+      else
+        printf("%lu,%d,,", timing.records, mode);
+      if (haveInterval)
+        printf("%.0f", interval);
+      printf("\n");
+    }
+    if (!timeValid)
+      ++timing.untimed;
+    ++timing.records;
+    timing.havePrevious = timeValid;
+    timing.previousMode = mode;
+    timing.previous     = time;
+  }
+
+  // ASCII capture: the timestamps of the record lines, unwrapped as by the
+  // binary decoder
+  void
+  ReadAscii(FILE * in, Timing & timing)
+  {
+    string   line;
+    bool     haveTime  = false;
+    bool     timeValid = false;
+    uint64_t time      = 0;
+    int      c;
+
+    do
+    {
+      c = fgetc(in);
+      if (c != EOF && c != '\n')
+      {
+        line += static_cast<char>(c);
+        continue;
+      }
+      if (line.size() > 2 && line[0] == 't' && (line[1] == '=' || line[1] == '+' || line[1] == '-'))
+      {
+        char *        end   = NULL;
+        unsigned long value = strtoul(line.c_str() + 2, &end, 10);
+        bool          valid = end != line.c_str() + 2 && *end == ';' && value <= 0xFFFFFFFFul;
+        if (!valid)
+          timeValid = false;
+        else if (line[1] == '=')
+        {
+          uint32_t tick = static_cast<uint32_t>(value);
+          time      = haveTime ? time + static_cast<int64_t>(static_cast<int32_t>(tick - static_cast<uint32_t>(time)))
+                               : tick;
+          haveTime  = true;
+          timeValid = true;
+        }
+        else if (timeValid)
+          time += (line[1] == '+') ? static_cast<int64_t>(value) : -static_cast<int64_t>(value);
+
+        if (!valid || strncmp(end + 1, "variance_", 9) != 0)
+          Record(timing, -1, valid && timeValid, time);
+      }
+      line.clear();
+    } while (c != EOF);
+  }
+
+  // Binary capture: the times of the measurement frames
+  void
+  ReadBinary(FILE * in, Timing & timing, EitFrameDecoder & decoder)
+  {
+    EitFrame frame;
+    uint8_t  buf[4096];
+    size_t   n;
+    uint32_t nextSequence = 0;
+    bool     haveSequence = false;
+
+    while ((n = fread(buf, 1, sizeof(buf), in)) > 0)
+    {
+      decoder.Feed(buf, n);
+      while (decoder.Next(frame))
+      {
+        // A lost frame breaks the intervals, as a record without a time
+        if (haveSequence && frame.sequence != nextSequence)
+          timing.havePrevious = false;
+        haveSequence = true;
+        nextSequence = frame.sequence + 1;
+
+        if (frame.Variance() || frame.Excitation() || frame.Plan())
+          continue;
+        Record(timing, frame.mode, frame.timeValid, frame.time);
+      }
+    }
+  }
+
+  double
+  Percentile(vector<double> const & sorted, double p)
+  {
+    double pos  = p * (sorted.size() - 1);
+    size_t i    = static_cast<size_t>(pos);
+    if (i + 1 >= sorted.size())
+      return sorted.back();
+    return sorted[i] + (pos - i) * (sorted[i + 1] - sorted[i]);
+  }
+}
+
+int
+main(int argc, char * argv[])
+{
+  bool   ascii   = false;
+  double nominal = 0;
+  Timing timing  = Timing();
+  int    i;
+
+  for (i = 1; i < argc && argv[i][0] == '-' && argv[i][1] != '\0'; ++i)
+  {
+    if (strcmp(argv[i], "-a") == 0)
+      ascii = true;
+    else if (strcmp(argv[i], "-c") == 0)
+      timing.csv = true;
+    else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+      nominal = atof(argv[++i]);
+    else
+    {
+      fprintf(stderr, "Usage: eitjitter [-a] [-c] [-n interval] [capture file]\n");
+      return 1;
+    }
+  }
+
+  FILE * in = stdin;
+  if (i < argc)
+  {
+    in = fopen(argv[i], "rb");
+    if (!in)
+    {
+      fprintf(stderr, "Cannot open %s\n", argv[i]);
+      return 1;
+    }
+  }
+
+  EitFrameDecoder decoder;
+  if (ascii)
+    ReadAscii(in, timing);
+  else
+    ReadBinary(in, timing, decoder);
+  if (in != stdin)
+    fclose(in);
+
+  FILE * out = timing.csv ? stderr : stdout;
+  fprintf(out, "records: %lu, without time: %lu\n", timing.records, timing.untimed);
+  if (!ascii)
+    fprintf(out, "crc errors: %lu, lost frames: %lu, time errors: %lu\n",
+            decoder.GetCrcErrors(), decoder.GetLostFrames(), decoder.GetTimeErrors());
+  if (timing.intervals.empty())
+  {
+    fprintf(out, "no intervals\n");
+    return 0;
+  }
+
+  vector<double> sorted(timing.intervals);
+  sort(sorted.begin(), sorted.end());
+  double sum = 0, sumSq = 0;
+  for (size_t k = 0; k < sorted.size(); ++k)
+    sum += sorted[k];
+  double mean = sum / sorted.size();
+  for (size_t k = 0; k < sorted.size(); ++k)
+    sumSq += (sorted[k] - mean) * (sorted[k] - mean);
+  double median = Percentile(sorted, 0.5);
+  double peak   = max(median - sorted.front(), sorted.back() - median);
+  unsigned long gaps = 0;
+  for (size_t k = 0; k < sorted.size(); ++k)
+    if (sorted[k] > 1.5 * median)
+      ++gaps;
+
+  fprintf(out, "intervals: %lu, mean %.1f us, std %.1f us, min %.0f us, max %.0f us\n",
+          (unsigned long)sorted.size(), mean, sqrt(sumSq / sorted.size()), sorted.front(), sorted.back());
+  fprintf(out, "median %.0f us, p1 %.0f us, p99 %.0f us, peak deviation from the median %.0f us, "
+          "gaps over 1.5 medians: %lu\n", median, Percentile(sorted, 0.01), Percentile(sorted, 0.99), peak, gaps);
+  if (nominal > 0)
+  {
+    double rms = 0;
+    for (size_t k = 0; k < sorted.size(); ++k)
+      rms += (sorted[k] - nominal) * (sorted[k] - nominal);
+    fprintf(out, "nominal %.1f us: mean %+.0f ppm, RMS deviation %.1f us\n",
+            nominal, (mean - nominal) * 1e6 / nominal, sqrt(rms / sorted.size()));
+  }
+  return 0;
+}
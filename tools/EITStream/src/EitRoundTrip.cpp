@@ -0,0 +1,271 @@
+/*
+ * EIT binary stream round trip.
+ *
+ * Usage: eitroundtrip [-s seed]
+ *
+ * Encodes frames with eit_stream.c of the firmware and decodes them with
+ * EitFrameDecoder, and checks that each frame decodes to its header and
+ * values: 28.4 magnitudes, 28.4 magnitudes and phases and raw q31 current
+ * and voltage magnitudes, fed whole and a few bytes at a time. Then, in a
+ * stream of such frames:
+ *   - a frame with a payload byte, or its CRC, flipped is dropped as a CRC
+ *     error and counted as lost, and the frames around it decode
+ *   - random bytes, and a false sync header, before a frame are skipped,
+ *     byte for byte, and the frame decodes
+ * Prints the first failure and exits with 1.
+ */
+
+#include "EitFrame.h"
+
+extern "C" {
+#include "eit_stream.h"
+}
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+  const uint8_t  kMode      = 4;
+  const uint8_t  kElectrodes = 16;
+  const uint32_t kFrequency = 25000;
+
+  // A frame as it was sent
+  struct Sent
+  {
+    STREAM_FORMAT_TYPE format;
+    vector<int32_t>    values;
+  };
+
+  vector<uint8_t> wire;
+  vector<size_t>  starts;
+  int             failures;
+
+  void
+  Write(uint8_t * data, uint16_t size)
+  {
+    wire.insert(wire.end(), data, data + size);
+  }
+
+  uint32_t
+  Random()
+  {
+    return (static_cast<uint32_t>(rand()) << 16) ^ static_cast<uint32_t>(rand());
+  }
+
+  void
+  Fail(char const * what, unsigned long index)
+  {
+    if (failures++ == 0)
+      fprintf(stderr, "%s, frame %lu\n", what, index);
+  }
+
+  // Encode one frame of random values in a format, as the imaging modes do
+  Sent
+  Encode(STREAM_FORMAT_TYPE format, uint16_t quads)
+  {
+    Sent sent;
+    sent.format = format;
+    uint16_t count = (format == STREAM_FORMAT_FIXED32) ? quads : static_cast<uint16_t>(2 * quads);
+    for (uint16_t i = 0; i < count; ++i)
+    {
+      int32_t value = static_cast<int32_t>(Random());
+      // Phases in 28.4 degrees, within +-180
+      if (format == STREAM_FORMAT_MAG_PHASE && (i % 2) == 1)
+        value = static_cast<int32_t>(Random() % 5761) - 2880;
+      sent.values.push_back(value);
+    }
+    starts.push_back(wire.size());
+    stream_FrameBegin(kMode, kElectrodes, format, count, kFrequency);
+    stream_FrameValues(&sent.values[0], count);
+    stream_FrameEnd();
+    return sent;
+  }
+
+  // Compare a decoded frame with the frame sent
+  void
+  Check(EitFrame const & frame, Sent const & sent, unsigned long sequence)
+  {
+    if (frame.version != EitFrameDecoder::kVersion || frame.Format() != static_cast<EitFormat>(sent.format)
+        || frame.mode != kMode || frame.nEl != kElectrodes || frame.frequency != kFrequency
+        || frame.sequence != sequence || frame.timeValid)
+    {
+      Fail("header does not match", sequence);
+      return;
+    }
+    if (frame.values != sent.values)
+    {
+      Fail("values do not match", sequence);
+      return;
+    }
+    size_t perQuad = (sent.format == STREAM_FORMAT_FIXED32) ? 1 : 2;
+    if (frame.ValuesPerMeasurement() != perQuad || frame.QuadCount() != sent.values.size() / perQuad)
+    {
+      Fail("quad count does not match", sequence);
+      return;
+    }
+    for (size_t i = 0; i < sent.values.size(); ++i)
+    {
+      double expect = (sent.format == STREAM_FORMAT_Q31) ? sent.values[i] : sent.values[i] / 16.0;
+      if (frame.Value(i) != expect)
+      {
+        Fail("engineering value does not match", sequence);
+        return;
+      }
+    }
+  }
+
+  // Decode a capture in chunks of 1 to chunk bytes, the sequences of the frames decoded
+  vector<unsigned long>
+  Decode(vector<uint8_t> const & bytes, size_t chunk, vector<Sent> const & sent, EitFrameDecoder & decoder)
+  {
+    vector<unsigned long> decoded;
+    EitFrame              frame;
+
+    for (size_t pos = 0; pos < bytes.size();)
+    {
+      size_t n = 1 + Random() % chunk;
+      if (n > bytes.size() - pos)
+        n = bytes.size() - pos;
+      decoder.Feed(&bytes[pos], n);
+      pos += n;
+      while (decoder.Next(frame))
+      {
+        if (frame.sequence >= sent.size())
+          Fail("unknown sequence", frame.sequence);
+        else
+          Check(frame, sent[frame.sequence], frame.sequence);
+        decoded.push_back(frame.sequence);
+      }
+    }
+    return decoded;
+  }
+
+  // Every format, whole and in small chunks
+  void
+  RoundTrip()
+  {
+    static const STREAM_FORMAT_TYPE formats[] = {STREAM_FORMAT_FIXED32, STREAM_FORMAT_MAG_PHASE, STREAM_FORMAT_Q31};
+    static const uint16_t           quads[]   = {1, 40, 208, 896};
+    vector<Sent>                    sent;
+
+    wire.clear();
+    starts.clear();
+    stream_Init(Write);
+    for (size_t f = 0; f < 3; ++f)
+      for (size_t q = 0; q < 4; ++q)
+        sent.push_back(Encode(formats[f], (formats[f] == STREAM_FORMAT_FIXED32) ? quads[q] : quads[q] / 2 + 1));
+
+    for (size_t chunk = 1; chunk <= 4096; chunk *= 64)
+    {
+      EitFrameDecoder       decoder;
+      vector<unsigned long> decoded = Decode(wire, chunk, sent, decoder);
+      if (decoded.size() != sent.size() || decoder.GetCrcErrors() || decoder.GetSkippedBytes()
+          || decoder.GetLostFrames())
+        Fail("frames lost in a clean stream", decoded.size());
+    }
+  }
+
+  // A frame corrupted in its payload or its CRC, between good frames
+  void
+  Corruption()
+  {
+    for (unsigned long run = 0; run < 200; ++run)
+    {
+      vector<Sent> sent;
+      wire.clear();
+      starts.clear();
+      stream_Init(Write);
+      for (int i = 0; i < 3; ++i)
+        sent.push_back(Encode((run & 1) ? STREAM_FORMAT_Q31 : STREAM_FORMAT_FIXED32, 8 + Random() % 64));
+
+      // Frame 1, a payload byte or a CRC byte
+      size_t end = starts[2];
+      size_t pos = (run % 4 < 2) ? starts[1] + EitFrameDecoder::kHeaderSize + Random() % (end - starts[1]
+                                   - EitFrameDecoder::kHeaderSize - EitFrameDecoder::kCrcSize)
+                                 : end - 1 - Random() % EitFrameDecoder::kCrcSize;
+      wire[pos] ^= static_cast<uint8_t>(1u << (Random() % 8));
+
+      EitFrameDecoder       decoder;
+      vector<unsigned long> decoded = Decode(wire, 1 + Random() % 128, sent, decoder);
+      if (decoded.size() != 2 || decoded[0] != 0 || decoded[1] != 2)
+        Fail("corrupted frame not dropped alone", run);
+      else if (decoder.GetCrcErrors() == 0 || decoder.GetLostFrames() != 1)
+        Fail("corrupted frame not counted", run);
+    }
+  }
+
+  // Garbage, and a false sync header, before a frame
+  void
+  Resync()
+  {
+    for (unsigned long run = 0; run < 200; ++run)
+    {
+      vector<Sent> sent;
+      wire.clear();
+      starts.clear();
+      stream_Init(Write);
+      for (int i = 0; i < 2; ++i)
+        sent.push_back(Encode((run & 1) ? STREAM_FORMAT_MAG_PHASE : STREAM_FORMAT_FIXED32, 4 + Random() % 64));
+
+      // Random bytes, with a sync, version and a short count now and then
+      vector<uint8_t> garbage(Random() % 300);
+      for (size_t i = 0; i < garbage.size(); ++i)
+        garbage[i] = static_cast<uint8_t>(Random());
+      if (garbage.size() > EitFrameDecoder::kHeaderSize && (run & 2))
+      {
+        size_t at = Random() % (garbage.size() - EitFrameDecoder::kHeaderSize);
+        garbage[at]     = EitFrameDecoder::kSync0;
+        garbage[at + 1] = EitFrameDecoder::kSync1;
+        garbage[at + 2] = EitFrameDecoder::kVersion;
+        garbage[at + 6] = static_cast<uint8_t>(Random() % 8);
+        garbage[at + 7] = 0;
+      }
+
+      // Between the two frames, or before both
+      size_t at = (run & 4) ? starts[1] : 0;
+      wire.insert(wire.begin() + at, garbage.begin(), garbage.end());
+
+      EitFrameDecoder       decoder;
+      vector<unsigned long> decoded = Decode(wire, 1 + Random() % 128, sent, decoder);
+      if (decoded.size() != 2 || decoded[0] != 0 || decoded[1] != 1)
+        Fail("frames lost after garbage", run);
+      else if (decoder.GetSkippedBytes() != garbage.size() || decoder.GetLostFrames() != 0)
+        Fail("garbage not skipped byte for byte", run);
+    }
+  }
+}
+
+int
+main(int argc, char * argv[])
+{
+  unsigned seed = 1;
+  int      opt;
+
+  while ((opt = getopt(argc, argv, "s:")) != -1)
+  {
+    if (opt != 's')
+    {
+      fprintf(stderr, "usage: eitroundtrip [-s seed]\n");
+      return 1;
+    }
+    seed = static_cast<unsigned>(strtoul(optarg, NULL, 0));
+  }
+  srand(seed);
+
+  RoundTrip();
+  if (!failures)
+    Corruption();
+  if (!failures)
+    Resync();
+  if (failures)
+    return 1;
+
+  printf("eit stream: 28.4, magnitude and phase and q31 frames, corrupted frames and garbage passed\n");
+  return 0;
+}
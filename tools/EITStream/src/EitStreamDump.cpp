@@ -0,0 +1,69 @@
+/*
+ * EIT binary stream dump.
+ *
+ * Usage: eitstreamdump [capture file]
+ *
+ * Reads a binary capture of the firmware UART output (or stdin) and prints
+ * one CSV line per frame: sequence, mode, electrodes, frequency, values...
+ * Multi-frequency frames are printed as one line per frequency, and the
+ * variance frames that follow averaged frames start with "var,", the
+ * excitation amplitudes of ranged frames with "exc,". Reduced frames are
+ * expanded with the last plan, printed as a "plan," line; those that cannot
+ * be expanded start with "red,". Delta frames are printed decoded.
+ */
+
+#include "EitFrame.h"
+
+#include <stdio.h>
+
+int
+main(int argc, char * argv[])
+{
+  FILE * in = stdin;
+  if (argc > 1)
+  {
+    in = fopen(argv[1], "rb");
+    if (!in)
+    {
+      fprintf(stderr, "Cannot open %s\n", argv[1]);
+      return 1;
+    }
+  }
+
+  EitFrameDecoder decoder;
+  EitFrame        frame;
+  EitFrame        plan = EitFrame();
+  uint8_t         buf[4096];
+  size_t          n;
+
+  while ((n = fread(buf, 1, sizeof(buf), in)) > 0)
+  {
+    decoder.Feed(buf, n);
+    while (decoder.Next(frame))
+    {
+      if (frame.Plan())
+        plan = frame;
+      else if (frame.Reduced())
+        frame.Expand(plan);
+
+      const char * prefix = frame.Plan() ? "plan," : (frame.Reduced() ? "red," : "");
+      size_t quads = frame.QuadCount();
+      for (size_t f = 0; f < frame.frequencies.size(); ++f)
+      {
+        printf("%s%s%lu,%u,%u,%lu", frame.Variance() ? "var," : (frame.Excitation() ? "exc," : ""), prefix,
+               (unsigned long)frame.sequence, frame.mode, frame.nEl, (unsigned long)frame.frequencies[f]);
+        for (size_t q = 0; q < quads; ++q)
+          for (size_t k = 0; k < frame.ValuesPerMeasurement(); ++k)
+            printf(",%.4f", frame.Value(q, f, k));
+        printf("\n");
+      }
+    }
+  }
+
+  fprintf(stderr, "crc errors: %lu, skipped bytes: %lu, lost frames: %lu, delta errors: %lu\n",
+          decoder.GetCrcErrors(), decoder.GetSkippedBytes(), decoder.GetLostFrames(), decoder.GetDeltaErrors());
+
+  if (in != stdin)
+    fclose(in);
+  return 0;
+}
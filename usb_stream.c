@@ -0,0 +1,195 @@
+/*!
+ *****************************************************************************
+ * @file:   usb_stream.c
+ * @brief:  Binary frames over a USB full speed vendor bulk IN endpoint
+ *
+ * Buffer usbFill is the one being written to; the other one is on the bus
+ * while usbBusy is set. The completion callback puts the bytes written
+ * meanwhile on the bus at once, so the copy into the buffer and the
+ * submission run with interrupts disabled.
+ *****************************************************************************/
+
+#include <stddef.h>
+#include <string.h>
+
+#include "usb_stream.h"
+
+#if (1 == USE_USB_FOR_DATA)
+
+#include "usbd_vendor.h"
+#include "usbd_drv_adi.h"
+#include "usbd_bsp_dev.h"
+
+static USBD_DEV_CFG         usbDevCfg = {
+    USB_STREAM_VENDOR_ID,
+    USB_STREAM_PRODUCT_ID,
+    USB_STREAM_DEVICE_BCD,
+    "Analog Devices",
+    "OpenEIT",
+    "0001",
+    USBD_LANG_ID_ENGLISH_US,
+};
+
+static USBD_DRV_CFG         usbDrvCfg = {
+    0u,                                             /* base address, not used by the ADI driver */
+    0u,                                             /* dedicated memory, none                   */
+    0u,
+    USBD_DEV_SPD_FULL,
+    USBD_DrvEP_InfoTbl_MUSBMHDRC,
+};
+
+static uint8_t              usbBuffer[2][USB_STREAM_BUFFER_SIZE];
+static volatile uint16_t    usbCount[2];
+static volatile uint8_t     usbFill;
+static volatile uint8_t     usbBusy;
+static volatile uint32_t    usbDropped;
+static CPU_INT08U           usbClass;
+static bool_t               usbStarted = false;
+
+static void                 usb_Submit              (void);
+static void                 usb_Complete            (CPU_INT08U classNbr, void *pBuf, CPU_INT32U bufLen,
+                                                     CPU_INT32U xferLen, void *pArg, USBD_ERR err);
+
+/* Put the buffer being filled on the bus, with interrupts disabled and the endpoint idle */
+static void usb_Submit(void) {
+    uint8_t                 sent = usbFill;
+    USBD_ERR                err;
+
+    usbBusy           = 1;
+    usbFill           = sent ^ 1u;
+    usbCount[usbFill] = 0;
+
+    USBD_Vendor_WrAsync(usbClass, usbBuffer[sent], usbCount[sent], usb_Complete, NULL, DEF_YES, &err);
+    if (USBD_ERR_NONE != err) {
+        usbDropped += usbCount[sent];
+        usbBusy     = 0;
+    }
+}
+
+/* Bulk IN transfer done, or aborted by a bus reset or a disconnection */
+static void usb_Complete(CPU_INT08U classNbr, void *pBuf, CPU_INT32U bufLen,
+                         CPU_INT32U xferLen, void *pArg, USBD_ERR err) {
+    if (xferLen < bufLen) {
+        usbDropped += bufLen - xferLen;
+    }
+    usbBusy = 0;
+    if (usbCount[usbFill]) {
+        usb_Submit();
+    }
+}
+
+/*!
+ * @brief       Add the vendor function to the USB device and start it.
+ *
+ * @return      true once the device is attached to the bus, false if the
+ *              stack could not be set up.
+ */
+bool_t usb_stream_Init(void) {
+    USBD_ERR                err;
+    CPU_INT08U              devNbr, cfgNbr;
+
+    USBD_Init(&err);
+    if (USBD_ERR_NONE != err) {
+        return false;
+    }
+    devNbr = USBD_DevAdd(&usbDevCfg, NULL, (USBD_DRV_API *)&USBD_DrvAPI_ADI, &usbDrvCfg,
+                         (USBD_DRV_BSP_API *)&USBD_DrvBSP_ADI, &err);
+    if (USBD_ERR_NONE != err) {
+        return false;
+    }
+    cfgNbr = USBD_CfgAdd(devNbr, USBD_DEV_ATTRIB_SELF_POWERED, 100u, USBD_DEV_SPD_FULL, "OpenEIT frames", &err);
+    if (USBD_ERR_NONE != err) {
+        return false;
+    }
+
+    /* One bulk IN and one bulk OUT endpoint, no interrupt endpoint and no vendor requests */
+    USBD_Vendor_Init(&err);
+    if (USBD_ERR_NONE != err) {
+        return false;
+    }
+    usbClass = USBD_Vendor_Add(DEF_FALSE, 0u, NULL, &err);
+    if (USBD_ERR_NONE != err) {
+        return false;
+    }
+    if (!USBD_Vendor_CfgAdd(usbClass, devNbr, cfgNbr, &err)) {
+        return false;
+    }
+
+    usbCount[0] = 0;
+    usbCount[1] = 0;
+    usbFill     = 0;
+    usbBusy     = 0;
+    usbDropped  = 0;
+    USBD_DevStart(devNbr, &err);
+    usbStarted  = (USBD_ERR_NONE == err);
+
+    return usbStarted;
+}
+
+/*!
+ * @brief       Whether a host has the function configured.
+ *
+ * @return      true if the frames written now reach the host.
+ */
+bool_t usb_stream_IsConnected(void) {
+    return usbStarted && (DEF_YES == USBD_Vendor_IsConn(usbClass));
+}
+
+/*!
+ * @brief       Queue bytes for the bulk IN endpoint.
+ *
+ * @param[in]   pData       Bytes, copied before the call returns.
+ * @param[in]   size        Number of bytes.
+ *
+ * @details     Sleeps while both buffers are taken. The bytes are dropped
+ *              if the host is not connected.
+ */
+void usb_stream_Write(uint8_t *pData, uint16_t size) {
+    uint16_t                n;
+
+    while (size > 0u) {
+        /* The buffer being filled is full and the other one is on the bus: sleep until it */
+        /* is sent, WFI wakes up on the pending interrupt and it is taken once enabled       */
+        __disable_irq();
+        while ((USB_STREAM_BUFFER_SIZE == usbCount[usbFill]) && usbBusy) {
+            __WFI();
+            __enable_irq();
+            __disable_irq();
+        }
+        __enable_irq();
+        if (!usb_stream_IsConnected()) {
+            usbDropped += size;
+            return;
+        }
+
+        __disable_irq();
+        n = (uint16_t)(USB_STREAM_BUFFER_SIZE - usbCount[usbFill]);
+        if (n > size) {
+            n = size;
+        }
+        memcpy(&usbBuffer[usbFill][usbCount[usbFill]], pData, n);
+        usbCount[usbFill] += n;
+        if (!usbBusy) {
+            usb_Submit();
+        }
+        __enable_irq();
+
+        pData += n;
+        size  -= n;
+    }
+}
+
+/*!
+ * @brief       Bytes lost since usb_stream_Init().
+ *
+ * @return      Bytes written while no host was connected, or aborted on the bus.
+ */
+uint32_t usb_stream_Dropped(void) {
+    return usbDropped;
+}
+
+#endif /* USE_USB_FOR_DATA */
+
+/*
+** EOF
+*/
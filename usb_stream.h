@@ -0,0 +1,63 @@
+/*!
+ *****************************************************************************
+ * @file:   usb_stream.h
+ * @brief:  Binary frames over a USB full speed vendor bulk IN endpoint
+ *
+ * The device enumerates as a vendor class function (uC/USB-Device) with one
+ * bulk IN endpoint, read on the host with libusb or WinUSB; the bytes are
+ * the eit_stream frames, as on the UART. usb_stream_Write() has the
+ * signature of STREAM_WRITE_FN.
+ *
+ * Two buffers of USB_STREAM_BUFFER_SIZE bytes take turns: one is on the bus
+ * while the frame bytes are copied into the other. A buffer goes on the bus
+ * as soon as the endpoint is idle, so a frame is not held back waiting for
+ * a full buffer, and the bytes written while a transfer runs go out in one
+ * transfer after it. The writer only waits when the second buffer fills
+ * up before the first one is sent. Bytes written while no host has the
+ * function configured are dropped and counted.
+ *
+ * The function needs the uC/USB-Device core and vendor class, which are not
+ * part of this tree, with the ADI port of usb/. Build with USE_USB_FOR_DATA
+ * set to 1 once they are added to the project; with 0, this module compiles
+ * to nothing and the frames stay on the UART.
+ *****************************************************************************/
+
+#ifndef __USB_STREAM_H__
+#define __USB_STREAM_H__
+
+#include <stdint.h>
+
+#include "device.h"
+
+/* C++ linkage */
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Binary frames on USB when a host has the function open (1), or always on the UART (0) */
+#ifndef USE_USB_FOR_DATA
+#define USE_USB_FOR_DATA            (0)
+#endif
+
+/* Bytes per bulk IN transfer, 8 full speed packets */
+#define USB_STREAM_BUFFER_SIZE      (512u)
+
+/* Device identity: the ADI vendor ID, the product ID is a placeholder for an assigned one */
+#define USB_STREAM_VENDOR_ID        (0x064Bu)
+#define USB_STREAM_PRODUCT_ID       (0x7823u)
+#define USB_STREAM_DEVICE_BCD       (0x0100u)
+
+bool_t                      usb_stream_Init         (void);
+bool_t                      usb_stream_IsConnected  (void);
+void                        usb_stream_Write        (uint8_t *pData, uint16_t size);
+uint32_t                    usb_stream_Dropped      (void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __USB_STREAM_H__ */
+
+/*
+** EOF
+*/
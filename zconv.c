@@ -0,0 +1,251 @@
+/*!
+ *****************************************************************************
+ * @file:   zconv.c
+ * @brief:  Conversion of raw DFT results into calibrated complex impedances
+ *
+ * Magnitudes are computed as by calculate_magnitude() in OpenEIT.c, from the
+ * CMSIS magnitudes of both channels, so they match the magnitude-only
+ * output. The phase is the difference of the channel angles, wrapped in the
+ * 1.15 domain. Real and imaginary parts come from an exact integer complex
+ * division of the raw results.
+ *****************************************************************************/
+
+#include <stddef.h>
+
+#include "zconv.h"
+
+static int32_t              zconv_Saturate          (q63_t value);
+static q63_t                zconv_Divide            (q63_t numerator, q63_t denominator);
+static int32_t              zconv_Magnitude         (q31_t magnitude_v, q31_t magnitude_i, uint32_t rtiaAndGain);
+
+/* Arctan Implementation                                                                                    */
+/* =====================                                                                                    */
+/* Arctan is calculated using the formula:                                                                  */
+/*                                                                                                          */
+/*      y = arctan(x) = 0.318253 * x + 0.003314 * x^2 - 0.130908 * x^3 + 0.068542 * x^4 - 0.009159 * x^5    */
+/*                                                                                                          */
+/* The angle in radians is given by (y * pi)                                                                */
+/*                                                                                                          */
+/* For the fixed-point implementation below, the coefficients are quantized to 16-bit and                   */
+/* represented as 1.15                                                                                      */
+/* The input vector is rotated until positioned between 0 and pi/4. After the arctan                        */
+/* is calculated for the rotated vector, the initial angle is restored.                                     */
+/* The format of the output is 1.15 and scaled by PI. To find the angle value in radians from the output    */
+/* of this function, a multiplication by PI is needed.                                                      */
+
+static const q15_t zconvArctanCoeff[5] = {
+    (q15_t)0x28BD,     /*  0.318253 */
+    (q15_t)0x006D,     /*  0.003314 */
+    (q15_t)0xEF3E,     /* -0.130908 */
+    (q15_t)0x08C6,     /*  0.068542 */
+    (q15_t)0xFED4,     /* -0.009159 */
+};
+
+/*!
+ * @brief       Angle of a complex value.
+ *
+ * @param[in]   imag        Imaginary part.
+ * @param[in]   real        Real part.
+ *
+ * @return      Angle in 1.15 format, scaled by PI.
+ *
+ * @details     -32768 is taken as -32767, so the rotations below can negate
+ *              every input.
+ */
+q15_t zconv_Arctan(q15_t imag, q15_t real) {
+    q15_t       t;
+    q15_t       out;
+    uint8_t     rotation; /* Clockwise, multiples of PI/4 */
+    int8_t      i;
+
+    imag = (imag < -32767) ? -32767 : imag;
+    real = (real < -32767) ? -32767 : real;
+
+    if ((q15_t)0 == imag) {
+        /* Check the sign*/
+        if (real & (q15_t)0x8000) {
+            /* Negative, return -PI */
+            return (q15_t)0x8000;
+        }
+        else {
+            return (q15_t)0;
+        }
+    }
+    else {
+
+        rotation = 0;
+        /* Rotate the vector until it's placed in the first octant (0..PI/4) */
+        if (imag < 0) {
+            imag      = -imag;
+            real      = -real;
+            rotation += 4;
+        }
+        if (real <= 0) {
+            /* Using 't' as temporary storage before its normal usage */
+            t         = real;
+            real      = imag;
+            imag      = -t;
+            rotation += 2;
+        }
+        if (real <= imag) {
+            /* The addition below may overflow, drop 1 LSB precision if needed. */
+            /* The subtraction cannot underflow.                                */
+            t = real + imag;
+            if (t < 0) {
+                /* Overflow */
+                t         = imag - real;
+                real      = (q15_t)(((q31_t)real + (q31_t)imag) >> 1);
+                imag      = t >> 1;
+            }
+            else {
+                t         = imag - real;
+                real      = (real + imag);
+                imag      = t;              
+            }
+            rotation += 1;
+        }
+
+        /* Calculate tangent value */
+        t = (q15_t)((q31_t)(imag << 15) / real);
+
+        out = (q15_t)0;
+
+        for (i = 4; i >=0; i--) {
+            out += zconvArctanCoeff[i];
+            arm_mult_q15(&out, &t, &out, 1);
+        }
+        
+        /* Rotate back to original position, in multiples of pi/4 */
+        /* We're using 1.15 representation, scaled by pi, so pi/4 = 0x2000 */
+        out += (rotation << 13);
+
+        return out;
+    }
+}
+
+/* Clamp to the 28.4 range */
+static int32_t zconv_Saturate(q63_t value) {
+    if (value > (q63_t)0x7FFFFFFF) {
+        return 0x7FFFFFFF;
+    }
+    if (value < -(q63_t)0x80000000) {
+        return (int32_t)0x80000000;
+    }
+
+    return (int32_t)value;
+}
+
+/* Division rounded to nearest, denominator positive */
+static q63_t zconv_Divide(q63_t numerator, q63_t denominator) {
+    if (numerator < 0) {
+        return -((-numerator + (denominator >> 1)) / denominator);
+    }
+
+    return (numerator + (denominator >> 1)) / denominator;
+}
+
+/* magnitude = magnitude_v / magnitude_i * rtiaAndGain, as calculate_magnitude() */
+static int32_t zconv_Magnitude(q31_t magnitude_v, q31_t magnitude_i, uint32_t rtiaAndGain) {
+    q63_t                   magnitude = 0;
+
+    if ((q31_t)0 != magnitude_i) {
+        magnitude = (q63_t)magnitude_v * (q63_t)rtiaAndGain;
+        /* Shift up for additional precision and rounding */
+        magnitude = ((magnitude << 5) / (q63_t)magnitude_i + 1) >> 1;
+    }
+
+    return zconv_Saturate(magnitude);
+}
+
+/*!
+ * @brief       Convert raw 4-wire DFT results into impedances.
+ *
+ * @param[in]   pConfig     Conversion settings.
+ * @param[in]   format      Values produced per measurement.
+ * @param[in]   pDft        count measurements of ZCONV_DFT_COUNT halfwords.
+ * @param[in]   count       Number of measurements.
+ * @param[out]  pOut        28.4 or q31 values, ZCONV_VALUES(format) per measurement.
+ *                          May be (int32_t *)pDft to convert in place.
+ *
+ * @return      Number of values written to pOut.
+ *
+ * @details     A channel whose real and imaginary parts are both below the
+ *              open threshold reads as 0, and an impedance measured with no
+ *              current is 0 in every format. Each chunk is copied before its
+ *              values are written, and the values of a measurement take no
+ *              more room than its raw results, so in place conversion never
+ *              overwrites results still to be read.
+ */
+uint32_t zconv_Batch(const ZCONV_CONFIG *pConfig, ZCONV_FORMAT_TYPE format,
+                     const int16_t *pDft, uint32_t count, int32_t *pOut) {
+    q15_t                   dft[ZCONV_CHUNK * ZCONV_DFT_COUNT];
+    q31_t                   dft_q31[ZCONV_CHUNK * ZCONV_DFT_COUNT];
+    q31_t                   magnitude[ZCONV_CHUNK * 2u];
+    const q63_t             scale = (q63_t)pConfig->rtiaAndGain << 4;
+    const int32_t           open  = pConfig->openThreshold;
+    const q15_t            *pI, *pV;
+    q63_t                   power;
+    q15_t                   phase;
+    uint32_t                done, n, i;
+
+    for (done = 0; done < count; done += n) {
+        n = ((count - done) < ZCONV_CHUNK) ? (count - done) : ZCONV_CHUNK;
+
+        /* Open circuit check, one channel at a time */
+        for (i = 0; i < n * 2u; i++) {
+            dft[2u * i]      = pDft[2u * i];
+            dft[2u * i + 1u] = pDft[2u * i + 1u];
+            if ((dft[2u * i] < open) && (dft[2u * i] > -open) &&
+                (dft[2u * i + 1u] < open) && (dft[2u * i + 1u] > -open)) {
+                dft[2u * i]      = 0;
+                dft[2u * i + 1u] = 0;
+            }
+        }
+        pDft += n * ZCONV_DFT_COUNT;
+
+        arm_q15_to_q31(dft, dft_q31, n * ZCONV_DFT_COUNT);
+        arm_cmplx_mag_q31(dft_q31, magnitude, n * 2u);
+
+        for (i = 0; i < n; i++) {
+            pI = &dft[i * ZCONV_DFT_COUNT];
+            pV = pI + 2;
+
+            if (ZCONV_FORMAT_RAW_Q31 == format) {
+                *pOut++ = magnitude[2u * i];
+                *pOut++ = magnitude[2u * i + 1u];
+                continue;
+            }
+
+            if (ZCONV_FORMAT_REAL_IMAG == format) {
+                power = (q63_t)pI[0] * pI[0] + (q63_t)pI[1] * pI[1];
+                if ((q63_t)0 == power) {
+                    *pOut++ = 0;
+                    *pOut++ = 0;
+                }
+                else {
+                    *pOut++ = zconv_Saturate(zconv_Divide(((q63_t)pV[0] * pI[0] + (q63_t)pV[1] * pI[1]) * scale, power));
+                    *pOut++ = zconv_Saturate(zconv_Divide(((q63_t)pV[1] * pI[0] - (q63_t)pV[0] * pI[1]) * scale, power));
+                }
+                continue;
+            }
+
+            *pOut++ = zconv_Magnitude(magnitude[2u * i + 1u], magnitude[2u * i], pConfig->rtiaAndGain);
+
+            if (ZCONV_FORMAT_MAG_PHASE == format) {
+                phase = 0;
+                if (((q31_t)0 != magnitude[2u * i]) && ((q31_t)0 != magnitude[2u * i + 1u])) {
+                    /* Wraps to [-PI, PI) */
+                    phase = (q15_t)(zconv_Arctan(pV[1], pV[0]) - zconv_Arctan(pI[1], pI[0]));
+                }
+                /* Degrees, 28.4: phase * 180 * 16 / 32768 */
+                *pOut++ = ((int32_t)phase * 180 + 0x400) >> 11;
+            }
+        }
+    }
+
+    return count * ZCONV_VALUES(format);
+}
+
+/*
+** EOF
+*/
@@ -0,0 +1,68 @@
+/*!
+ *****************************************************************************
+ * @file:   zconv.h
+ * @brief:  Conversion of raw DFT results into calibrated complex impedances
+ *
+ * A 4-wire measurement returns the DFT of the current (TIA channel) and of
+ * the voltage (AN_A channel). The impedance is their ratio scaled by the
+ * TIA resistance over the instrumentation amplifier gain:
+ *
+ *      Z = V / I * rtiaAndGain = V * conj(I) / |I|^2 * rtiaAndGain
+ *
+ * All values are produced in the 28.4 fixed point format of the firmware
+ * output: ohms for magnitudes, real and imaginary parts, degrees in
+ * [-180, 180) for phases. Measurements are converted in batches, so the
+ * CMSIS magnitude kernel runs over many values per call; a whole frame
+ * can be converted in place, its values overwriting its raw results.
+ *****************************************************************************/
+
+#ifndef __ZCONV_H__
+#define __ZCONV_H__
+
+#include <stdint.h>
+
+#include "arm_math.h"
+
+/* C++ linkage */
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* DFT result halfwords per measurement: current real, imaginary, voltage real, imaginary */
+#define ZCONV_DFT_COUNT             (4u)
+/* Measurements converted per call of the CMSIS kernels */
+#define ZCONV_CHUNK                 (16u)
+
+/* Full turn of a phase, degrees in 28.4 */
+#define ZCONV_PHASE_PERIOD          (360 * 16)
+
+/* Values produced per measurement */
+typedef enum {
+    ZCONV_FORMAT_MAGNITUDE          = 0,    /*!< |Z|                                        */
+    ZCONV_FORMAT_MAG_PHASE          = 1,    /*!< |Z|, then the phase of Z                   */
+    ZCONV_FORMAT_REAL_IMAG          = 2,    /*!< Re(Z), then Im(Z)                          */
+    ZCONV_FORMAT_RAW_Q31            = 3,    /*!< q31 |I|, then q31 |V|, not calibrated      */
+} ZCONV_FORMAT_TYPE;
+
+/* Number of values produced per measurement, never more than its raw results take */
+#define ZCONV_VALUES(format)        ((ZCONV_FORMAT_MAGNITUDE == (format)) ? 1u : 2u)
+
+/* Conversion settings */
+typedef struct {
+    uint32_t                rtiaAndGain;    /*!< Ohms per unit of the V/I ratio                     */
+    int16_t                 openThreshold;  /*!< |re| and |im| below it on a channel: open circuit  */
+} ZCONV_CONFIG;
+
+uint32_t                    zconv_Batch             (const ZCONV_CONFIG *pConfig, ZCONV_FORMAT_TYPE format,
+                                                     const int16_t *pDft, uint32_t count, int32_t *pOut);
+q15_t                       zconv_Arctan            (q15_t imag, q15_t real);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __ZCONV_H__ */
+
+/*
+** EOF
+*/